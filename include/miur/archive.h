@@ -0,0 +1,141 @@
+/* =====================
+ * include/miur/archive.h
+ * 10/18/2026
+ * Packed asset archives.
+ * ====================
+ */
+
+/*
+ * An archive packs many files into one, laid out as
+ *
+ *   ArchiveHeader
+ *   uint32_t buckets[bucket_count]    open addressed index into entries
+ *   ArchiveEntry entries[entry_count]
+ *   char names[]                      entry names, not NUL terminated
+ *   blobs                             each aligned to ARCHIVE_ALIGNMENT
+ *
+ * All fields are little endian.  An archive is mapped once and files are
+ * found with one hash and one probe in the common case, returned as views
+ * straight into the mapping.
+ *
+ * Compressed entries are split into independent blocks of block_size bytes,
+ * each compressed with lz.h.  Their blob starts with a uint32_t stored size
+ * per block, ARCHIVE_BLOCK_RAW marking blocks kept as is, followed by the
+ * blocks back to back.  Blocks decode straight into the destination, spread
+ * over a job system when one is given.
+ *
+ * Runtime loaders read through archive_load_file and archive_map_file, which
+ * consult the mounted archives before the file system.  Tools that work on
+ * loose sources use membuf.h directly.
+ */
+
+#ifndef MIUR_ARCHIVE_H
+#define MIUR_ARCHIVE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <miur/job.h>
+#include <miur/membuf.h>
+
+#define ARCHIVE_MAGIC "MIURPAK"
+#define ARCHIVE_VERSION 2
+#define ARCHIVE_ALIGNMENT 64
+#define ARCHIVE_BLOCK_SIZE (128 * 1024)
+#define ARCHIVE_BLOCK_RAW 0x80000000u
+#define ARCHIVE_EMPTY_BUCKET UINT32_MAX
+#define ARCHIVE_MAX_MOUNTS 8
+
+typedef struct
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t bucket_count;       /* Power of two. */
+  uint32_t names_size;
+  uint64_t buckets_offset;
+  uint64_t entries_offset;
+  uint64_t names_offset;
+  uint64_t file_size;
+} ArchiveHeader;
+
+typedef enum
+{
+  ARCHIVE_ENTRY_COMPRESSED = 1 << 0,
+} ArchiveEntryFlags;
+
+typedef struct
+{
+  uint64_t hash;
+  uint64_t offset;
+  uint64_t size;               /* Decompressed size. */
+  uint64_t stored_size;        /* Size of the blob at offset. */
+  uint32_t name_offset;
+  uint32_t name_size;
+  uint32_t flags;
+  uint32_t block_size;         /* Compressed entries only. */
+} ArchiveEntry;
+
+typedef struct
+{
+  Membuf file;
+  const ArchiveHeader *header;
+  const uint32_t *buckets;
+  const ArchiveEntry *entries;
+  const char *names;
+} Archive;
+
+typedef struct
+{
+  const char *name;
+  Membuf data;
+  /* Entries that don't shrink are stored uncompressed regardless. */
+  bool compress;
+} ArchiveInput;
+
+bool archive_open(Archive *archive_out, const char *filename);
+void archive_close(Archive *archive);
+
+const ArchiveEntry *archive_find_entry(const Archive *archive,
+                                       const char *name, size_t name_size);
+
+/* Reads entry->size bytes into `dst`, `jobs` may be NULL. */
+bool archive_read(const Archive *archive, const ArchiveEntry *entry,
+                  void *dst, JobSystem *jobs);
+
+/*
+ * Finds `name`.  Uncompressed entries are views into the archive, valid
+ * until it is closed, compressed ones are decompressed into a heap Membuf.
+ */
+bool archive_find(const Archive *archive, const char *name, size_t name_size,
+                  Membuf *out, JobSystem *jobs);
+
+/*
+ * Makes the files of an archive visible under `mount_point`, e.g. an archive
+ * holding "assets/cube.gltf" mounted at "../" resolves "../assets/cube.gltf".
+ * Mount at startup, before loading starts on other threads.
+ */
+bool archive_mount(const char *filename, const char *mount_point);
+void archive_unmount_all(void);
+
+/* Job system used to decompress files resolved from mounted archives. */
+void archive_set_job_system(JobSystem *jobs);
+
+/* Looks `path` up in the mounted archives, newest mount first. */
+bool archive_resolve(const char *path, Membuf *out);
+
+/*
+ * Like membuf_load_file and membuf_map_file, but files found in a mounted
+ * archive are returned from it, usually as views, instead of from disk.
+ */
+bool archive_load_file(Membuf *out, const char *path);
+bool archive_map_file(Membuf *out, const char *path, MembufMapFlags flags);
+
+/* Hash of a normalized name, backslashes hash as forward slashes. */
+uint64_t archive_hash_name(const char *name, size_t name_size);
+
+bool archive_write(const char *filename, const ArchiveInput *inputs,
+                   size_t count);
+
+#endif
@@ -0,0 +1,29 @@
+/* =====================
+ * include/miur/arena.h
+ * 10/18/2026
+ * Bump allocator for short lived data.
+ * ====================
+ */
+
+#ifndef MIUR_ARENA_H
+#define MIUR_ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct
+{
+  ArenaBlock *head;
+  size_t block_size;
+} Arena;
+
+void arena_create(Arena *arena_out, size_t block_size);
+void arena_destroy(Arena *arena);
+
+/* Returns 16 byte aligned memory, or NULL when out of memory. */
+void *arena_alloc(Arena *arena, size_t size);
+
+#endif
@@ -0,0 +1,126 @@
+/* =====================
+ * include/miur/asset_db.h
+ * 10/18/2026
+ * Cooked asset database.
+ * ====================
+ */
+
+/*
+ * Records what every cooked artifact was built from, so a cook only redoes
+ * the artifacts whose inputs changed.  Each artifact is keyed by name and
+ * keeps the hash of its inputs and the paths of the files they came from,
+ * e.g. a glTF file and its buffers, or a shader and its includes.  An
+ * artifact is current while those files still hash to what it recorded,
+ * which can be checked without parsing any of them.
+ *
+ * The database is a single flat file laid out as
+ *
+ *   AssetDbHeader
+ *   AssetDbEntry entries[capacity]  open addressed by key, 0 is empty
+ *   char strings[]                  NUL terminated names and dependencies
+ *
+ * Opening maps it and lookups read the mapping in place.  The first change
+ * copies it to the heap, and asset_db_save writes it back whole to a
+ * temporary file that replaces the old one, so a cook that is interrupted
+ * never leaves a database that is half written.  All fields are little
+ * endian.
+ */
+
+#ifndef MIUR_ASSET_DB_H
+#define MIUR_ASSET_DB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <miur/job.h>
+#include <miur/membuf.h>
+
+#define ASSET_DB_MAGIC "MIURADB"
+#define ASSET_DB_VERSION 1
+#define ASSET_DB_ALIGNMENT 64
+#define ASSET_DB_EXTENSION ".miurdb"
+
+typedef struct
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t capacity;           /* Entry slots, a power of two. */
+  uint32_t count;
+  uint32_t strings_size;
+  uint64_t entries_offset;
+  uint64_t strings_offset;
+  uint64_t file_size;
+} AssetDbHeader;
+
+typedef struct
+{
+  uint64_t key;                /* hash3 of the name, never 0. */
+  uint64_t input_hash;         /* As asset_db_input_hash gave it. */
+  uint32_t name_offset;        /* Into the strings. */
+  uint32_t dependencies_offset;
+  uint32_t dependencies_size;
+  uint32_t dependency_count;
+  uint32_t cook_time_us;       /* How long the last cook took. */
+  uint32_t reserved;
+} AssetDbEntry;
+
+typedef struct
+{
+  char *filename;
+  Membuf file;                 /* Until the first change. */
+  AssetDbEntry *entries;
+  uint32_t capacity;
+  uint32_t count;
+  char *strings;
+  uint32_t strings_size;
+  uint32_t strings_capacity;
+  bool owned;                  /* Entries and strings are heap copies. */
+  bool dirty;
+} AssetDb;
+
+/*
+ * Maps the database at `filename`.  A database that is missing or invalid,
+ * e.g. written by another version, opens empty and is replaced on save.
+ */
+bool asset_db_open(AssetDb *db_out, const char *filename);
+/* Discards unsaved changes. */
+void asset_db_close(AssetDb *db);
+/* Writes the database back if it changed. */
+bool asset_db_save(AssetDb *db);
+
+/* The entry recorded for `name`, valid until the next change, or NULL. */
+const AssetDbEntry *asset_db_find(const AssetDb *db, const char *name);
+const char *asset_db_entry_name(const AssetDb *db,
+                                const AssetDbEntry *entry);
+/* Walks an entry's dependencies in the order recorded, NULL at the end. */
+const char *asset_db_next_dependency(const AssetDb *db,
+                                     const AssetDbEntry *entry,
+                                     const char *prev);
+
+/*
+ * Records what `name` was cooked from, replacing what was recorded before.
+ * `dependencies` are copied.
+ */
+bool asset_db_record(AssetDb *db, const char *name, uint64_t input_hash,
+                     const char *const *dependencies, size_t dependency_count,
+                     uint32_t cook_time_us);
+
+/*
+ * Content hashes every file in `paths`, one job per file on `jobs`, or
+ * inline when `jobs` is NULL.  A file that can't be read hashes to 0 and
+ * makes this return false, the others are still hashed.
+ */
+bool asset_db_hash_files(JobSystem *jobs, const char *const *paths,
+                         size_t count, uint64_t *hashes_out);
+
+/*
+ * Combines the content hashes of an artifact's dependencies, with their
+ * paths, into its input hash.  `seed` covers anything else the output
+ * depends on, e.g. the cook settings and the version of the format.
+ */
+uint64_t asset_db_input_hash(const char *const *paths,
+                             const uint64_t *hashes, size_t count,
+                             uint64_t seed);
+
+#endif
@@ -0,0 +1,98 @@
+/* =====================
+ * include/miur/asset_stream.h
+ * 10/18/2026
+ * Prioritized background loading of models into the renderer.
+ * ====================
+ */
+
+/*
+ * Requests move through QUEUED -> LOADING -> UPLOADING -> READY, or end up
+ * FAILED.  Loads decode on the job system with gltf_load_async, uploads are
+ * staged copies on the graphics queue tracked by fences, and nothing on the
+ * calling thread waits for either, so asset_streamer_update can run every
+ * frame without a hitch.
+ *
+ * Work is picked highest priority first.  A load starts only while the bytes
+ * of all loading and uploading assets stay under byte_budget, one still
+ * starts when nothing is in flight so an oversized asset can't stall the
+ * queue.  A model's size isn't known until it is decoded, until then it is
+ * charged load_estimate bytes.  Each update submits upload_bytes_per_frame of
+ * meshes and then images at most, but always at least one.
+ */
+
+#ifndef MIUR_ASSET_STREAM_H
+#define MIUR_ASSET_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <miur/io.h>
+#include <miur/job.h>
+#include <miur/model.h>
+#include <miur/render.h>
+
+#define ASSET_STREAM_DEFAULT_BUDGET (64ull << 20)
+#define ASSET_STREAM_DEFAULT_ESTIMATE (4ull << 20)
+#define ASSET_STREAM_DEFAULT_UPLOAD_BYTES (8ull << 20)
+
+typedef struct AssetStreamer AssetStreamer;
+typedef struct StreamAsset StreamAsset;
+
+typedef enum
+{
+  STREAM_QUEUED,
+  STREAM_LOADING,
+  STREAM_UPLOADING,
+  STREAM_READY,
+  STREAM_FAILED,
+} StreamState;
+
+/* Zeroes pick the defaults above. */
+typedef struct
+{
+  uint64_t byte_budget;
+  uint64_t load_estimate;
+  uint64_t upload_bytes_per_frame;
+} AssetStreamerDesc;
+
+typedef struct
+{
+  uint32_t queued;        /* Queue depth, requests not started yet. */
+  uint32_t loading;
+  uint32_t uploading;
+  uint32_t ready;
+  uint32_t failed;
+  uint64_t bytes_in_flight;
+  /* From request to the first frame that can draw it, in nanoseconds. */
+  uint64_t last_time_to_ready;
+  uint64_t max_time_to_ready;
+} AssetStreamerStats;
+
+/* `io` may be NULL, see gltf_load_async. */
+AssetStreamer *asset_streamer_create(Renderer *render, JobSystem *jobs,
+                                     IoService *io,
+                                     const AssetStreamerDesc *desc);
+
+/* Waits for everything in flight, then frees every asset and its buffers. */
+void asset_streamer_destroy(AssetStreamer *streamer);
+
+/* Higher priorities go first, equal ones in request order. */
+StreamAsset *asset_streamer_request(AssetStreamer *streamer,
+                                    const char *filename, int32_t priority);
+void asset_streamer_set_priority(AssetStreamer *streamer, StreamAsset *asset,
+                                 int32_t priority);
+
+/* Advances every request without blocking, call once per frame. */
+void asset_streamer_update(AssetStreamer *streamer);
+
+void asset_streamer_stats(const AssetStreamer *streamer,
+                          AssetStreamerStats *stats_out);
+
+StreamState stream_asset_state(const StreamAsset *asset);
+
+/* The loaded model, NULL until the asset is READY. */
+StaticModel *stream_asset_model(StreamAsset *asset);
+/* The model's images on the GPU, one per image, NULL until READY. */
+const GPUTexture *stream_asset_textures(const StreamAsset *asset);
+
+#endif
@@ -0,0 +1,46 @@
+/* =====================
+ * include/miur/bounds.h
+ * 10/18/2026
+ * Bounding boxes and spheres.
+ * ====================
+ */
+
+#ifndef MIUR_BOUNDS_H
+#define MIUR_BOUNDS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct
+{
+  float min[3];
+  float max[3];
+} Aabb;
+
+typedef struct
+{
+  float center[3];
+  float radius;
+} BoundingSphere;
+
+/* The inverted box, anything united with it is left as is. */
+void aabb_empty(Aabb *out);
+bool aabb_is_empty(const Aabb *box);
+
+/* Bounds `count` packed xyz positions, empty for none. */
+void aabb_from_points(Aabb *out, const float *positions, size_t count);
+
+void aabb_union(Aabb *out, const Aabb *a, const Aabb *b);
+
+/*
+ * Bounds `box` moved by an affine matrix as in transform.h.  Rotated boxes
+ * grow, the result holds every corner.
+ */
+void aabb_transform(Aabb *out, const Aabb *box, const float *matrix);
+
+/* Ritter's sphere, within a few percent of the smallest one. */
+void sphere_from_points(BoundingSphere *out, const float *positions,
+                        size_t count);
+
+#endif
@@ -0,0 +1,104 @@
+/* =====================
+ * include/miur/bvh.h
+ * 10/18/2026
+ * Bounding volume hierarchy over instances.
+ * ====================
+ */
+
+/*
+ * A binary tree of boxes over caller numbered items, typically the world
+ * bounds of a model's instances, for culling, picking and spatial queries.
+ * It is built top down with the surface area heuristic over binned
+ * centroids, subtrees fanned out to the job system.
+ *
+ * When items move, refitting recomputes the boxes and keeps the tree, which
+ * stays correct but loosens as items stray from where they were built, so
+ * rebuild once queries slow down.  Children always come after their parent.
+ */
+
+#ifndef MIUR_BVH_H
+#define MIUR_BVH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <miur/bounds.h>
+#include <miur/job.h>
+
+#define BVH_NO_NODE UINT32_MAX
+
+typedef struct
+{
+  float min[3];
+  uint32_t first;              /* A leaf's first item, else the left child. */
+  float max[3];
+  uint32_t count;              /* A leaf's items, 0 for inner nodes. */
+} BvhNode;
+
+typedef struct
+{
+  BvhNode *nodes;              /* The root first, the right child follows. */
+  uint32_t *parents;           /* By node, BVH_NO_NODE for the root. */
+  uint32_t node_count;
+
+  /* Leaves index these, item ids and their bounds in leaf order. */
+  uint32_t *items;
+  Aabb *item_bounds;
+  /* By item id. */
+  uint32_t *item_slots;
+  uint32_t *item_leaves;
+  uint32_t item_count;
+} Bvh;
+
+typedef struct
+{
+  uint32_t item;
+  float t;
+} BvhHit;
+
+/*
+ * Tests the ray against `item` exactly, e.g. its triangles.  On a hit
+ * nearer than `*t_inout`, stores the distance and returns true.
+ */
+typedef bool (*BvhRayFunc)(void *ud, uint32_t item, const float *origin,
+                           const float *dir, float *t_inout);
+
+/* Builds over `count` items, `jobs` may be NULL to build on this thread. */
+bool bvh_build(Bvh *bvh_out, const Aabb *bounds, uint32_t count,
+               JobSystem *jobs);
+void bvh_destroy(Bvh *bvh);
+
+/* Takes every item's bounds from `bounds`, indexed by item id. */
+void bvh_refit(Bvh *bvh, const Aabb *bounds);
+
+/*
+ * Takes the bounds of only the `count` listed items and refits their
+ * ancestors, stopping where a box no longer changes.
+ */
+void bvh_refit_items(Bvh *bvh, const Aabb *bounds, const uint32_t *items,
+                     uint32_t count);
+
+/*
+ * The queries write up to `capacity` item ids to `out` and return how many
+ * there are in all, so a larger buffer can be retried with.
+ */
+uint32_t bvh_query_aabb(const Bvh *bvh, const Aabb *box, uint32_t *out,
+                        uint32_t capacity);
+
+/*
+ * Items whose box is at least partly on the positive side of every plane,
+ * each (x, y, z, w) with dot(xyz, p) + w >= 0 inside, at most 32 of them.
+ */
+uint32_t bvh_query_frustum(const Bvh *bvh, const float *planes,
+                           uint32_t plane_count, uint32_t *out,
+                           uint32_t capacity);
+
+/*
+ * Finds the nearest item along the ray within `max_t`, visiting nearer
+ * boxes first.  `hit` refines each box hit, NULL takes the boxes as they
+ * are.  Returns false if there is none.
+ */
+bool bvh_raycast(const Bvh *bvh, const float *origin, const float *dir,
+                 float max_t, BvhRayFunc hit, void *ud, BvhHit *hit_out);
+
+#endif
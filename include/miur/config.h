@@ -10,6 +10,8 @@
 
 #ifdef _WIN32
 #define MIUR_PLATFORM_WINDOWS
+#elif defined(__unix__) || defined(__APPLE__)
+#define MIUR_PLATFORM_POSIX
 #else
 #error Unkown platform
 #endif
@@ -0,0 +1,47 @@
+/* =====================
+ * include/miur/convert.h
+ * 10/18/2026
+ * Vertex and index component conversion.
+ * ====================
+ */
+
+#ifndef MIUR_CONVERT_H
+#define MIUR_CONVERT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef enum
+{
+  COMPONENT_I8,
+  COMPONENT_U8,
+  COMPONENT_I16,
+  COMPONENT_U16,
+  COMPONENT_U32,
+  COMPONENT_FLOAT,
+} ComponentType;
+
+size_t component_size(ComponentType type);
+
+/*
+ * Converts `count` elements of `components` values each, `stride` bytes
+ * apart, into tightly packed floats.  With `normalized` integers map to
+ * [0, 1] or [-1, 1] as in Vulkan's UNORM/SNORM formats, otherwise they
+ * convert by value.  Sources need no alignment.
+ */
+void convert_to_float(float *dst, const uint8_t *src, size_t stride,
+                      size_t count, uint32_t components, ComponentType type,
+                      bool normalized);
+
+/*
+ * Convert tightly packed unsigned indices.  Both return the largest index seen
+ * so callers can check it against the vertex count.  The u16 variant
+ * saturates, an index above 65535 still shows up in the result.
+ */
+uint32_t convert_indices_u16(uint16_t *dst, const uint8_t *src, size_t count,
+                             ComponentType type);
+uint32_t convert_indices_u32(uint32_t *dst, const uint8_t *src, size_t count,
+                             ComponentType type);
+
+#endif
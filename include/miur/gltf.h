@@ -8,9 +8,39 @@
 #ifndef MIUR_GLTF_H
 #define MIUR_GLTF_H
 
+#include <miur/io.h>
+#include <miur/job.h>
 #include <miur/model.h>
 #include <miur/membuf.h>
 
+typedef struct GLTFLoad GLTFLoad;
+
+/*
+ * Loads `filename` into `out` on the calling thread.  Both this and
+ * gltf_load_async keep a cooked copy next to the file, see mesh_cache.h, and
+ * map it instead of parsing while the sources are unchanged.
+ */
 bool gltf_parse(StaticModel *out, const char *filename);
 
+/*
+ * Starts loading `filename` into `out` on `jobs`.  External buffers are read
+ * through `io` when given and mapped by jobs otherwise, then accessors
+ * decode in parallel chunks and each primitive is finalized as soon as its
+ * data is in.  Each image decodes, builds its mips and is compressed in a
+ * job of its own, the compression itself split across `jobs`.
+ * `out` must stay untouched until the load is waited on.
+ */
+GLTFLoad *gltf_load_async(StaticModel *out, const char *filename,
+                          JobSystem *jobs, IoService *io);
+bool gltf_load_done(GLTFLoad *load);
+
+/*
+ * Runs jobs until the load completes, then frees it.  Returns whether it
+ * succeeded, `out` is left empty if not.
+ */
+bool gltf_load_wait(GLTFLoad *load);
+
+/* Frees a loaded model, whether it was parsed or read from its cache. */
+void gltf_model_destroy(StaticModel *model);
+
 #endif
@@ -0,0 +1,49 @@
+/* =====================
+ * include/miur/image.h
+ * 10/18/2026
+ * PNG and JPEG decoding.
+ * ====================
+ */
+
+/*
+ * Images always decode to 8 bit RGBA, rows packed top to bottom.  PNG is
+ * read in every color type, bit depth and interlacing, 16 bit channels keep
+ * their high byte and chunk CRCs aren't checked, the zlib Adler-32 is.  JPEG
+ * is read baseline and progressive, grayscale or YCbCr, upsampled and
+ * converted the way libjpeg does by default.  Gamma, ICC and EXIF metadata
+ * are ignored.
+ */
+
+#ifndef MIUR_IMAGE_H
+#define MIUR_IMAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Larger images are rejected rather than allocated. */
+#define IMAGE_MAX_DIMENSION 16384
+
+typedef enum
+{
+  IMAGE_FORMAT_UNKNOWN,
+  IMAGE_FORMAT_PNG,
+  IMAGE_FORMAT_JPEG,
+} ImageFormat;
+
+typedef struct
+{
+  uint8_t *pixels;
+  uint32_t width;
+  uint32_t height;
+} Image;
+
+/* Sniffs the signature, file extensions and MIME types aren't trusted. */
+ImageFormat image_detect(const uint8_t *data, size_t size);
+
+/* `out` is left empty on failure. */
+bool image_decode(Image *out, const uint8_t *data, size_t size);
+
+void image_destroy(Image *image);
+
+#endif
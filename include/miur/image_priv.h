@@ -0,0 +1,19 @@
+/* =====================
+ * include/miur/image_priv.h
+ * 10/18/2026
+ * PNG and JPEG decoding internals.
+ * ====================
+ */
+
+#ifndef MIUR_IMAGE_PRIV_H
+#define MIUR_IMAGE_PRIV_H
+
+#include <miur/image.h>
+
+/* Allocates the pixels of a width by height image, NULL if it's too large. */
+bool image_alloc(Image *image, uint32_t width, uint32_t height);
+
+bool png_decode(Image *out, const uint8_t *data, size_t size);
+bool jpeg_decode(Image *out, const uint8_t *data, size_t size);
+
+#endif
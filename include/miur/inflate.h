@@ -0,0 +1,31 @@
+/* =====================
+ * include/miur/inflate.h
+ * 10/18/2026
+ * DEFLATE decompression.
+ * ====================
+ */
+
+/*
+ * Decodes RFC 1951 streams, bare or in the RFC 1950 zlib wrapper PNG and
+ * KTX2 use.  Like lz_decompress, the output size has to be known up front,
+ * the decoder never writes outside of [dst, dst + dst_size) and fails on
+ * anything that doesn't fill it exactly.  There is no compressor, streams
+ * come from other tools.
+ */
+
+#ifndef MIUR_INFLATE_H
+#define MIUR_INFLATE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Fails unless `src` decodes to exactly `dst_size` bytes. */
+bool inflate_raw(const uint8_t *src, size_t size, uint8_t *dst,
+                 size_t dst_size);
+
+/* As inflate_raw, also checking the wrapper and its Adler-32. */
+bool inflate_zlib(const uint8_t *src, size_t size, uint8_t *dst,
+                  size_t dst_size);
+
+#endif
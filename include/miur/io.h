@@ -0,0 +1,130 @@
+/* =====================
+ * include/miur/io.h
+ * 10/18/2026
+ * Asynchronous file loading.
+ * ====================
+ */
+
+/*
+ * Reads are described by caller owned IoRequests, which stay untouched by
+ * the caller until they complete.  Completion runs the request's callback on
+ * an I/O thread and then signals its JobCounter, so a loader can either chain
+ * work from the callback or submit a batch and job_wait on it.
+ *
+ * Backends, picked by io_service_create:
+ *   IO_BACKEND_URING     Linux io_uring, one ring thread keeps up to
+ *                        queue_depth reads in flight.
+ *   IO_BACKEND_IOCP      Windows overlapped reads on a completion port.
+ *   IO_BACKEND_THREADS   Blocking reads on a small thread pool, used when
+ *                        neither of the above is available.
+ */
+
+#ifndef MIUR_IO_H
+#define MIUR_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <miur/config.h>
+#include <miur/job.h>
+
+/* Alignment of offsets, sizes and buffers for IO_READ_DIRECT. */
+#define IO_DIRECT_ALIGNMENT 4096
+
+typedef struct IoService IoService;
+typedef struct IoRequest IoRequest;
+
+typedef void (*IoCallback)(IoRequest *req);
+
+typedef enum
+{
+  IO_BACKEND_AUTO,
+  IO_BACKEND_THREADS,
+  IO_BACKEND_URING,
+  IO_BACKEND_IOCP,
+} IoBackend;
+
+typedef enum
+{
+  /*
+   * Bypass the page cache (O_DIRECT, FILE_FLAG_NO_BUFFERING).  For large
+   * files read once, e.g. into upload staging memory.  Requests that can't
+   * be read directly fall back to buffered reads.
+   */
+  IO_READ_DIRECT = 1 << 0,
+} IoFlags;
+
+typedef enum
+{
+  IO_PENDING,
+  IO_DONE,
+  IO_FAILED,
+} IoStatus;
+
+struct IoRequest
+{
+  /* Set by the caller. */
+  const char *path;
+  uint64_t offset;
+  size_t size;           /* 0 reads to the end of the file. */
+  void *dst;             /* NULL allocates, see io_request_release. */
+  int buffer_index;      /* Registered buffer containing dst, or -1. */
+  IoFlags flags;
+  IoCallback callback;   /* May be NULL. */
+  JobCounter *counter;   /* Signalled after the callback, may be NULL. */
+  void *ud;
+
+  /* Results, valid once complete. */
+  IoStatus status;
+  uint8_t *data;
+  size_t bytes_read;
+
+  /* Internal. */
+  IoRequest *next;
+  intptr_t file;
+  uint8_t *buffer;
+  uint64_t read_offset;
+  size_t read_size, read_needed, read_done;
+#ifdef MIUR_PLATFORM_WINDOWS
+  OVERLAPPED overlapped;
+#endif
+};
+
+typedef struct
+{
+  IoBackend backend;
+  /* Counters are signalled through this, may be NULL if none are used. */
+  JobSystem *jobs;
+  uint32_t queue_depth;      /* 0 picks a default. */
+  uint32_t thread_count;     /* Thread pool size, 0 picks a default. */
+} IoServiceDesc;
+
+typedef struct
+{
+  void *data;
+  size_t size;
+} IoBuffer;
+
+IoService *io_service_create(const IoServiceDesc *desc);
+/* Waits for outstanding requests. */
+void io_service_destroy(IoService *io);
+IoBackend io_service_backend(IoService *io);
+
+/*
+ * Registers long lived destination buffers, e.g. staging memory, so the
+ * kernel can skip pinning them per read.  Replaces earlier registrations and
+ * must not race with requests that use buffer indices.
+ */
+bool io_service_register_buffers(IoService *io, const IoBuffer *buffers,
+                                 size_t count);
+
+/* Fills in the request defaults, callers then set path and what they need. */
+void io_request_init(IoRequest *req, const char *path);
+
+void io_submit(IoService *io, IoRequest *reqs, size_t count);
+
+/* Frees the buffer allocated for a request submitted without dst. */
+void io_request_release(IoRequest *req);
+
+#endif
@@ -0,0 +1,75 @@
+/* =====================
+ * include/miur/io_priv.h
+ * 10/18/2026
+ * Asynchronous file loading internals.
+ * ====================
+ */
+
+#ifndef MIUR_IO_PRIV_H
+#define MIUR_IO_PRIV_H
+
+#include <miur/io.h>
+#include <miur/thread.h>
+
+#ifdef __linux__
+#define MIUR_IO_HAVE_URING
+#endif
+
+#define IO_DEFAULT_QUEUE_DEPTH 256
+#define IO_DEFAULT_THREAD_COUNT 4
+/* Largest single read, Windows takes a DWORD and Linux caps reads anyway. */
+#define IO_MAX_READ_CHUNK ((size_t) 1 << 30)
+
+struct IoService
+{
+  IoBackend backend;
+  JobSystem *jobs;
+  uint32_t queue_depth;
+
+  Mutex mutex;
+  /* Signalled when requests are queued and when the service goes idle. */
+  CondVar cond;
+  IoRequest *pending_head, *pending_tail;
+  AtomicI32 outstanding;
+  bool should_quit;
+
+  Thread *threads;
+  uint32_t thread_count;
+
+  IoBuffer *buffers;
+  size_t buffer_count;
+
+  void *backend_data;
+};
+
+/* Pops up to `max` queued requests as a list, NULL if there are none. */
+IoRequest *io_take_pending(IoService *io, size_t max);
+
+/*
+ * Opens the file and works out the byte range and destination.  Returns
+ * false if the request failed, in which case it has already completed.
+ * Requests that need no reads (empty files) also complete here and return
+ * false with status IO_DONE.
+ */
+bool io_prepare_request(IoService *io, IoRequest *req, bool overlapped);
+
+void io_complete_request(IoService *io, IoRequest *req, bool success);
+
+uint8_t *io_read_target(IoRequest *req);
+
+/* Backends, each defined only on platforms that have it. */
+#ifdef MIUR_IO_HAVE_URING
+bool io_uring_backend_create(IoService *io);
+void io_uring_backend_destroy(IoService *io);
+void io_uring_backend_wake(IoService *io);
+bool io_uring_backend_register(IoService *io, const IoBuffer *buffers,
+                               size_t count);
+#endif
+
+#ifdef MIUR_PLATFORM_WINDOWS
+bool io_iocp_backend_create(IoService *io);
+void io_iocp_backend_destroy(IoService *io);
+void io_iocp_backend_wake(IoService *io);
+#endif
+
+#endif
@@ -0,0 +1,57 @@
+/* =====================
+ * include/miur/job.h
+ * 10/18/2026
+ * Job system.
+ * ====================
+ */
+
+#ifndef MIUR_JOB_H
+#define MIUR_JOB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <miur/thread.h>
+
+typedef struct JobSystem JobSystem;
+
+typedef void (*JobFunction)(void *ud);
+
+typedef struct
+{
+  JobFunction function;
+  void *ud;
+} Job;
+
+/*
+ * Counts unfinished jobs.  A counter is incremented when jobs are submitted
+ * against it and decremented as each finishes, so one counter can track
+ * any number of batches, and other subsystems (e.g. I/O) can signal it too.
+ * Zero initialize before first use.
+ */
+typedef struct
+{
+  AtomicI32 value;
+} JobCounter;
+
+/* A worker_count of 0 uses one thread per processor, minus the caller's. */
+JobSystem *job_system_create(uint32_t worker_count);
+void job_system_destroy(JobSystem *jobs);
+
+/* Threads that run jobs, including the one calling job_wait. */
+uint32_t job_system_thread_count(JobSystem *jobs);
+
+/* Queues jobs, `counter` may be NULL. */
+void job_run(JobSystem *jobs, const Job *desc, size_t count,
+             JobCounter *counter);
+
+/* Runs queued jobs on the calling thread until `counter` reaches zero. */
+void job_wait(JobSystem *jobs, JobCounter *counter);
+
+void job_counter_add(JobCounter *counter, int32_t count);
+/* Marks one unit of work done, wakes waiters when the counter hits zero. */
+void job_counter_signal(JobSystem *jobs, JobCounter *counter);
+bool job_counter_done(JobCounter *counter);
+
+#endif
@@ -17,6 +17,8 @@
 
 #include <miur/membuf.h>
 #include <miur/string.h>
+#include <miur/arena.h>
+#include <miur/utils.h>
 
 /**
  * JSON type identifier. Basic types are:
@@ -52,12 +54,15 @@ enum JsonErr {
  * type		type (object, array, string etc.)
  * start	start position in JSON data string
  * end		end position in JSON data string
+ * size		number of direct children
+ * skip		index of the first token after this token's subtree
  */
 typedef struct {
   JsonType type;
   int start;
   int end;
   int size;
+  int skip;
 } JsonTok;
 
 typedef struct
@@ -69,9 +74,13 @@ typedef struct
   JsonTok eof;
 } JsonStream;
 
-void json_stream_init(JsonStream *stream, Membuf buf);
+/* Returns false if `buf` is not well formed JSON. */
+bool json_stream_init(JsonStream *stream, Membuf buf);
 void json_stream_deinit(JsonStream *stream);
 
+/* Skips the value at the cursor, including all of its children. */
+void json_skip_value(JsonStream *stream);
+
 #define JSON_NEXT(_stream) ((_stream)->cur < ((_stream)->toks_size) ?          \
                             ((_stream)->toks[(_stream)->cur++]) :              \
                             ((_stream)->eof))
@@ -108,9 +117,28 @@ void json_print(JsonStream *stream, JsonTok tok);
 
 double json_get_number(JsonStream *stream, JsonTok tok);
 String json_get_string(JsonStream *stream, JsonTok tok);
+
+/*
+ * Decodes the escape sequences in a string token and validates it as UTF-8.
+ * Strings without escapes are returned as a view into the stream's buffer,
+ * anything else is decoded into `arena`.
+ */
+bool json_decode_string(JsonStream *stream, JsonTok tok, Arena *arena,
+                        String *out);
+
+/*
+ * Decodes the raw bytes between a pair of quotes.  `dst` must have room for
+ * `size` bytes, decoding never grows a string.
+ */
+bool json_unescape(const uint8_t *src, size_t size, uint8_t *dst,
+                   size_t *dst_size);
+
 bool json_streq(JsonStream *stream, JsonTok tok, const char *str);
 
 void json_get_position_info(JsonStream *stream, JsonTok tok, int *line,
                             int *col);
 
+void json_parse_error(JsonStream *stream, JsonTok bad_tok, ParseError *error,
+                      const char *fmt, ...);
+
 #endif
@@ -0,0 +1,190 @@
+/* =====================
+ * include/miur/json_schema.h
+ * 10/18/2026
+ * Table driven JSON decoding.
+ * ====================
+ */
+
+/*
+ * A schema is a table of fields mapping JSON keys to offsets inside a C
+ * struct.  Tables are written as X-macro lists and expanded by
+ * JSON_SCHEMA_DEFINE, so a struct is described once next to its definition:
+ *
+ *   #define BUFFER_FIELDS(X, S)                                             \
+ *     X(S, CSTRING, "uri",        uri,         ,     )                      \
+ *     X(S, INT,     "byteLength", byte_length, ,     )
+ *
+ *   JSON_SCHEMA_DEFINE(buffer_schema, Buffer, BUFFER_FIELDS, 0, NULL, NULL);
+ *
+ * The entries are X(struct, kind, key, member, count_member, extra), with the
+ * last two left empty when a kind does not use them.  Counts are size_t.
+ *
+ *   INT, FLOAT, BOOL      int, float and bool members.
+ *   STRING                String, a view into the JSON or a decoded copy.
+ *   CSTRING               NUL terminated const char *.
+ *   FLOAT_ARRAY           Fixed size float array, the size is the capacity.
+ *   INT_ARRAY             int * with the element count in `count_member`.
+ *   ENUM                  int, the index of the string in the NULL terminated
+ *                         name list `extra`.
+ *   OBJECT                Nested struct described by the schema `extra`.
+ *   OBJECT_ARRAY          Array of structs described by the schema `extra`,
+ *                         with the element count in `count_member`.
+ *   CUSTOM                Decoded by the JsonCustomDecoder `extra`.
+ *
+ * Keys are found with one hash and one comparison.  Unknown keys are skipped
+ * in constant time unless the schema is strict or has an `unknown` handler.
+ * Everything allocated while decoding lives in the decoder's arena.
+ */
+
+#ifndef MIUR_JSON_SCHEMA_H
+#define MIUR_JSON_SCHEMA_H
+
+#include <stddef.h>
+
+#include <miur/json.h>
+#include <miur/thread.h>
+
+typedef enum
+{
+  JSON_FIELD_INT,
+  JSON_FIELD_FLOAT,
+  JSON_FIELD_BOOL,
+  JSON_FIELD_STRING,
+  JSON_FIELD_CSTRING,
+  JSON_FIELD_FLOAT_ARRAY,
+  JSON_FIELD_INT_ARRAY,
+  JSON_FIELD_ENUM,
+  JSON_FIELD_OBJECT,
+  JSON_FIELD_OBJECT_ARRAY,
+  JSON_FIELD_CUSTOM,
+} JsonFieldKind;
+
+typedef struct
+{
+  JsonStream *stream;
+  Arena *arena;
+  ParseError *error;
+} JsonDecoder;
+
+typedef struct JsonSchema JsonSchema;
+
+/* Decodes the value at the cursor into `out`, consuming it. */
+typedef bool (*JsonCustomDecoder)(JsonDecoder *dec, void *out);
+
+/* Called for keys not in the schema with the value at the cursor. */
+typedef bool (*JsonUnknownHandler)(JsonDecoder *dec, JsonTok key, void *out);
+
+typedef struct
+{
+  const char *key;
+  JsonFieldKind kind;
+  size_t offset;
+  size_t count_offset;           /* INT_ARRAY, OBJECT_ARRAY */
+  size_t capacity;               /* FLOAT_ARRAY */
+  const char *const *names;      /* ENUM */
+  JsonSchema *schema;            /* OBJECT, OBJECT_ARRAY */
+  JsonCustomDecoder custom;      /* CUSTOM */
+} JsonField;
+
+typedef enum
+{
+  /* Unknown keys are an error rather than being skipped. */
+  JSON_SCHEMA_STRICT = 1 << 0,
+} JsonSchemaFlags;
+
+#define JSON_SCHEMA_MAX_FIELDS 32
+#define JSON_SCHEMA_BUCKETS (JSON_SCHEMA_MAX_FIELDS * 2)
+
+struct JsonSchema
+{
+  const char *name;
+  const JsonField *fields;
+  size_t field_count;
+  size_t struct_size;
+  JsonSchemaFlags flags;
+  /* Sets defaults before an object is decoded, may be NULL. */
+  void (*init)(void *out);
+  JsonUnknownHandler unknown;
+
+  /* Key index, built once by json_schema_prepare. */
+  AtomicI32 state;
+  uint32_t hashes[JSON_SCHEMA_BUCKETS];
+  uint8_t slots[JSON_SCHEMA_BUCKETS];
+};
+
+void json_decoder_init(JsonDecoder *dec, JsonStream *stream, Arena *arena,
+                       ParseError *error);
+
+/* Decodes the object at the cursor into `out`, `schema` must be prepared. */
+bool json_decode_object(JsonDecoder *dec, JsonSchema *schema, void *out);
+
+/* Decodes an array of objects at the cursor into arena memory. */
+bool json_decode_object_array(JsonDecoder *dec, JsonSchema *schema,
+                              void **out, size_t *count);
+
+bool json_decode_int(JsonDecoder *dec, int *out);
+bool json_decode_float(JsonDecoder *dec, float *out);
+
+/* Reports an error at `tok` through the decoder's ParseError, returns false. */
+bool json_decode_error(JsonDecoder *dec, JsonTok tok, const char *fmt, ...);
+
+/*
+ * Builds the key index of `schema` and of the schemas its fields nest.
+ * Loaders call it before they decode or dispatch jobs that do.  The first
+ * call builds the index, calls racing it wait until it's done and later
+ * ones return at once.
+ */
+void json_schema_prepare(JsonSchema *schema);
+
+/* === TABLE GENERATION === */
+
+#define JSON_MEMBER_SIZE(_s, _m) sizeof(((_s *) 0)->_m)
+
+#define JSON_SCHEMA_FIELD_INT(_s, _key, _m, _count, _extra)                    \
+  { .key = _key, .kind = JSON_FIELD_INT, .offset = offsetof(_s, _m) },
+#define JSON_SCHEMA_FIELD_FLOAT(_s, _key, _m, _count, _extra)                  \
+  { .key = _key, .kind = JSON_FIELD_FLOAT, .offset = offsetof(_s, _m) },
+#define JSON_SCHEMA_FIELD_BOOL(_s, _key, _m, _count, _extra)                   \
+  { .key = _key, .kind = JSON_FIELD_BOOL, .offset = offsetof(_s, _m) },
+#define JSON_SCHEMA_FIELD_STRING(_s, _key, _m, _count, _extra)                 \
+  { .key = _key, .kind = JSON_FIELD_STRING, .offset = offsetof(_s, _m) },
+#define JSON_SCHEMA_FIELD_CSTRING(_s, _key, _m, _count, _extra)                \
+  { .key = _key, .kind = JSON_FIELD_CSTRING, .offset = offsetof(_s, _m) },
+#define JSON_SCHEMA_FIELD_FLOAT_ARRAY(_s, _key, _m, _count, _extra)            \
+  { .key = _key, .kind = JSON_FIELD_FLOAT_ARRAY, .offset = offsetof(_s, _m),  \
+    .capacity = JSON_MEMBER_SIZE(_s, _m) / sizeof(float) },
+#define JSON_SCHEMA_FIELD_INT_ARRAY(_s, _key, _m, _count, _extra)              \
+  { .key = _key, .kind = JSON_FIELD_INT_ARRAY, .offset = offsetof(_s, _m),    \
+    .count_offset = offsetof(_s, _count) },
+#define JSON_SCHEMA_FIELD_ENUM(_s, _key, _m, _count, _extra)                   \
+  { .key = _key, .kind = JSON_FIELD_ENUM, .offset = offsetof(_s, _m),         \
+    .names = _extra },
+#define JSON_SCHEMA_FIELD_OBJECT(_s, _key, _m, _count, _extra)                 \
+  { .key = _key, .kind = JSON_FIELD_OBJECT, .offset = offsetof(_s, _m),       \
+    .schema = _extra },
+#define JSON_SCHEMA_FIELD_OBJECT_ARRAY(_s, _key, _m, _count, _extra)           \
+  { .key = _key, .kind = JSON_FIELD_OBJECT_ARRAY,                              \
+    .offset = offsetof(_s, _m), .count_offset = offsetof(_s, _count),          \
+    .schema = _extra },
+#define JSON_SCHEMA_FIELD_CUSTOM(_s, _key, _m, _count, _extra)                 \
+  { .key = _key, .kind = JSON_FIELD_CUSTOM, .offset = offsetof(_s, _m),       \
+    .custom = _extra },
+
+#define JSON_SCHEMA_FIELD(_s, _kind, _key, _m, _count, _extra)                 \
+  JSON_SCHEMA_FIELD_##_kind(_s, _key, _m, _count, _extra)
+
+#define JSON_SCHEMA_DEFINE(_name, _struct, _fields, _flags, _init, _unknown)   \
+  static const JsonField _name##_fields[] = {                                 \
+    _fields(JSON_SCHEMA_FIELD, _struct)                                        \
+  };                                                                           \
+  static JsonSchema _name = {                                                  \
+    .name = #_struct,                                                          \
+    .fields = _name##_fields,                                                  \
+    .field_count = sizeof(_name##_fields) / sizeof(JsonField),                 \
+    .struct_size = sizeof(_struct),                                            \
+    .flags = _flags,                                                           \
+    .init = _init,                                                             \
+    .unknown = _unknown,                                                       \
+  }
+
+#endif
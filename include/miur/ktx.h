@@ -0,0 +1,67 @@
+/* =====================
+ * include/miur/ktx.h
+ * 10/18/2026
+ * KTX2 texture containers.
+ * ====================
+ */
+
+/*
+ * Reads and writes 2D textures as KTX2, the Khronos container that stores
+ * a mip chain the way a GPU copy wants it.  An opened file is used in
+ * place: the texture's data points into the mapping and each mip keeps the
+ * offset the file gives it, so the whole chain goes into a staging buffer
+ * with one copy and into the image with one copy command, without a texel
+ * being touched on the way.
+ *
+ * Levels supercompressed with ZLIB are inflated on open into a texture of
+ * their own, Zstandard and BasisLZ aren't supported.  Only the formats
+ * TextureFormat has are read, cube maps, arrays and 3D textures are not.
+ * The data format descriptor is written for other tools but not read, the
+ * Vulkan format alone decides the layout.
+ */
+
+#ifndef MIUR_KTX_H
+#define MIUR_KTX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <miur/membuf.h>
+#include <miur/texture.h>
+
+#define KTX_EXTENSION ".ktx2"
+
+/*
+ * A KTX2 file and its texture.  While `file` holds the mapping the
+ * texture's data is inside it and must not be written or destroyed.
+ */
+typedef struct
+{
+  Membuf file;
+  Texture texture;
+} KtxTexture;
+
+/* Whether `data` starts with the KTX2 identifier. */
+bool ktx_is_ktx2(const uint8_t *data, size_t size);
+
+/*
+ * Maps `filename` and points `out->texture` at its mips, or inflates them
+ * if they're supercompressed.  Fails on anything malformed or unsupported.
+ */
+bool ktx_open(KtxTexture *out, const char *filename);
+void ktx_close(KtxTexture *ktx);
+
+/*
+ * Copies the mips of a KTX2 file in memory, e.g. an image inside a glTF
+ * buffer, into a texture of its own laid out as texture_layout gives it.
+ */
+bool ktx_decode(Texture *out, const uint8_t *data, size_t size);
+
+/*
+ * Writes every mip of `texture` uncompressed, smallest level first.  The
+ * file is replaced atomically, so textures ktx_open mapped stay intact.
+ */
+bool ktx_write(const Texture *texture, const char *filename);
+
+#endif
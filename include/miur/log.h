@@ -15,14 +15,18 @@ typedef enum {
     LOG_LEVEL_FATAL,
 } Log_Level;
 
-#define MIUR_LOG_INFO(msg, ...)                                                \
-    _miur_log(LOG_LEVEL_INFO, __LINE__, __FILE__, msg, __VA_ARGS__)
-#define MIUR_LOG_WARN(msg, ...)                                                \
-    _miur_log(LOG_LEVEL_WARN, __LINE__, __FILE__, msg, __VA_ARGS__)
-#define MIUR_LOG_ERR(msg, ...)                                                 \
-    _miur_log(LOG_LEVEL_ERR, __LINE__, __FILE__, msg, __VA_ARGS__)
-#define MIUR_LOG_FATAL(msg, ...)                                               \
-    _miur_log(LOG_LEVEL_FATAL, __LINE__, __FILE__, msg, __VA_ARGS__)
+/*
+ * The format is part of the variadic arguments, so messages without any
+ * arguments expand to valid C as well.
+ */
+#define MIUR_LOG_INFO(...)                                                     \
+    _miur_log(LOG_LEVEL_INFO, __LINE__, __FILE__, __VA_ARGS__)
+#define MIUR_LOG_WARN(...)                                                     \
+    _miur_log(LOG_LEVEL_WARN, __LINE__, __FILE__, __VA_ARGS__)
+#define MIUR_LOG_ERR(...)                                                      \
+    _miur_log(LOG_LEVEL_ERR, __LINE__, __FILE__, __VA_ARGS__)
+#define MIUR_LOG_FATAL(...)                                                    \
+    _miur_log(LOG_LEVEL_FATAL, __LINE__, __FILE__, __VA_ARGS__)
 
 /* === PRIVATE === */
 
@@ -0,0 +1,34 @@
+/* =====================
+ * include/miur/lz.h
+ * 10/18/2026
+ * LZ77 block compression.
+ * ====================
+ */
+
+/*
+ * Blocks use the LZ4 sequence format: a token with 4 bit literal and match
+ * lengths, extended by 255 runs, the literals, then a 16 bit little endian
+ * match offset.  Blocks are independent, the output size is always known up
+ * front and the decoder never writes outside of [dst, dst + dst_size), so
+ * neighbouring blocks can be decoded into one buffer concurrently.
+ */
+
+#ifndef MIUR_LZ_H
+#define MIUR_LZ_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Largest possible compressed size of `size` bytes. */
+size_t lz_compress_bound(size_t size);
+
+/* Returns the compressed size, 0 if it doesn't fit in `capacity`. */
+size_t lz_compress(const uint8_t *src, size_t size, uint8_t *dst,
+                   size_t capacity);
+
+/* Fails unless `src` decodes to exactly `dst_size` bytes. */
+bool lz_decompress(const uint8_t *src, size_t size, uint8_t *dst,
+                   size_t dst_size);
+
+#endif
@@ -8,9 +8,11 @@
 #ifndef MIUR_MATERIAL_H
 #define MIUR_MATERIAL_H
 
+#include <miur/material_table.h>
 #include <miur/shader.h>
 #include <miur/utils.h>
 #include <miur/string.h>
+#include <miur/vertex_format.h>
 
 #define PASS_COUNT 1
 
@@ -31,11 +33,23 @@ typedef struct
     ShaderModule *frag;
   } shaders;
 
+  VertexFormat vertex_format;
+  VertexLayout vertex_layout;
   VkPipeline pipeline;
   VkPipelineLayout layout;
   bool mark;
 } Technique;
 
+/*
+ * Vertex stage push constants, the instance's world matrix as transform.h
+ * lays it out and, for quantized techniques only, the mesh's quantization.
+ */
+typedef struct
+{
+  float model[16];
+  VertexQuantization quantization;
+} DrawConstants;
+
 typedef struct
 {
   PER_PASS_DATA(Technique *, techniques);
@@ -60,6 +74,11 @@ bool technique_cache_load_file(VkDevice dev, VkExtent2D present_extent,
                                VkFormat present_format,
                                TechniqueCache *cache, ShaderCache *shaders, 
                                Membuf file, ParseError *error);
+/* As technique_cache_load_file, from a cooked table with no parsing. */
+bool technique_cache_load_table(VkDevice dev, VkExtent2D present_extent,
+                                VkFormat present_format,
+                                TechniqueCache *cache, ShaderCache *shaders,
+                                const MaterialTable *table);
 Technique *technique_cache_lookup(TechniqueCache *cache, String *name);
 
 void technique_cache_destroy(TechniqueCache *cache);
@@ -81,6 +100,8 @@ void effect_cache_destroy(EffectCache *cache);
 bool effect_cache_load_file(VkDevice dev, EffectCache *cache,
                             TechniqueCache *techs, Membuf file,
                             ParseError *error);
+bool effect_cache_load_table(EffectCache *cache, TechniqueCache *techs,
+                             const MaterialTable *table);
 Effect *effect_cache_lookup(EffectCache *cache, String *name);
 
 typedef struct
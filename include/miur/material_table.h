@@ -0,0 +1,174 @@
+/* =====================
+ * include/miur/material_table.h
+ * 10/18/2026
+ * Technique and effect descriptions and their cooked tables.
+ * ====================
+ */
+
+/*
+ * Techniques and effects are written as JSON, which the parse functions
+ * below read into descriptions.  miur-cook turns each file into a table the
+ * renderer loads without parsing JSON or compiling GLSL, laid out as
+ *
+ *   MaterialTableHeader
+ *   MaterialTableShader shaders[shader_count]
+ *   MaterialTableTechnique techniques[technique_count]
+ *   MaterialTableEffect effects[effect_count]
+ *   char dependencies[]             NUL terminated source paths
+ *   char strings[]                  NUL terminated names and shader paths
+ *   SPIR-V                          each blob aligned to
+ *                                   MATERIAL_TABLE_ALIGNMENT
+ *
+ * A table is written next to its JSON file, named as mesh caches are with
+ * MATERIAL_TABLE_EXTENSION appended.  source_hash covers the JSON file and
+ * then every dependency, in order: the GLSL of each shader, as the JSON
+ * names it.  A table can be checked against its sources without parsing
+ * them, as mesh caches are.  All fields are little endian.
+ */
+
+#ifndef MIUR_MATERIAL_TABLE_H
+#define MIUR_MATERIAL_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <miur/arena.h>
+#include <miur/membuf.h>
+#include <miur/string.h>
+#include <miur/utils.h>
+#include <miur/vertex_format.h>
+
+#define MATERIAL_TABLE_MAGIC "MIURMAT"
+#define MATERIAL_TABLE_VERSION 1
+#define MATERIAL_TABLE_ALIGNMENT 64
+#define MATERIAL_TABLE_EXTENSION ".miurmat"
+/* An effect without a technique for the pass. */
+#define MATERIAL_TABLE_NONE UINT32_MAX
+
+typedef struct
+{
+  String name;
+  String vert;
+  String frag;
+  int vertex_format;
+  int vertex_layout;
+  int line, col;               /* Of the name, for errors after parsing. */
+} TechniqueDesc;
+
+typedef struct
+{
+  String name;
+  String forward;              /* Empty for none. */
+  int line, col;
+} EffectDesc;
+
+typedef struct
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t shader_count;
+  uint64_t source_hash;
+  uint32_t dependency_count;
+  uint32_t dependencies_size;
+  uint32_t technique_count;
+  uint32_t effect_count;
+  uint32_t strings_size;
+  uint32_t reserved;
+  uint64_t shaders_offset;
+  uint64_t techniques_offset;
+  uint64_t effects_offset;
+  uint64_t dependencies_offset;
+  uint64_t strings_offset;
+  uint64_t file_size;
+} MaterialTableHeader;
+
+typedef struct
+{
+  uint32_t path_offset;        /* Into the strings, as techniques name it. */
+  uint32_t stage;              /* VkShaderStageFlagBits. */
+  uint64_t code_offset;
+  uint64_t code_size;
+} MaterialTableShader;
+
+typedef struct
+{
+  uint32_t name_offset;
+  uint32_t vert;               /* Into the shaders. */
+  uint32_t frag;
+  uint32_t vertex_format;      /* VertexFormat. */
+  uint32_t vertex_layout;      /* VertexLayout. */
+} MaterialTableTechnique;
+
+typedef struct
+{
+  uint32_t name_offset;
+  uint32_t forward_offset;     /* Technique name or MATERIAL_TABLE_NONE. */
+} MaterialTableEffect;
+
+typedef struct
+{
+  Membuf file;
+  const MaterialTableHeader *header;
+  const MaterialTableShader *shaders;
+  const MaterialTableTechnique *techniques;
+  const MaterialTableEffect *effects;
+  const char *dependencies;
+  const char *strings;
+} MaterialTable;
+
+/* Compiled code for a shader a technique names, for material_table_write. */
+typedef struct
+{
+  String path;
+  uint32_t stage;              /* VkShaderStageFlagBits. */
+  const void *code;
+  size_t size;
+} MaterialTableShaderCode;
+
+/*
+ * Parse a technique or effect file into descriptions allocated in `arena`.
+ * Strings point into `file` or `arena`, so both must outlive them.  Shader
+ * paths aren't checked, only that a technique has both.
+ */
+bool technique_file_parse(Membuf file, Arena *arena, TechniqueDesc **out,
+                          size_t *count_out, ParseError *error);
+bool effect_file_parse(Membuf file, Arena *arena, EffectDesc **out,
+                       size_t *count_out, ParseError *error);
+
+/* The stage a shader's extension, .vert or .frag, gives it, or 0. */
+uint32_t material_shader_stage(String path);
+
+/*
+ * The table cooked from the JSON file `source_filename`, as a new string to
+ * be freed with MIUR_FREE.
+ */
+char *material_table_path(const char *source_filename);
+
+/*
+ * Maps the table cooked from `source_filename` if it is valid and its
+ * sources still hash to what it recorded.
+ */
+bool material_table_open_current(MaterialTable *table_out,
+                                 const char *source_filename);
+void material_table_close(MaterialTable *table);
+
+/* A string of the table, from one of its offsets. */
+String material_table_string(const MaterialTable *table, uint32_t offset);
+const void *material_table_shader_code(const MaterialTable *table,
+                                       const MaterialTableShader *shader);
+
+/*
+ * Writes the table for the JSON file `source_filename`, from what it
+ * parsed to.  `shaders` needs code for every shader the techniques name, in
+ * the order they are stored and then recorded as dependencies.  The table
+ * is replaced atomically, so ones material_table_open mapped stay intact.
+ */
+bool material_table_write(const char *source_filename,
+                          const TechniqueDesc *techniques,
+                          size_t technique_count, const EffectDesc *effects,
+                          size_t effect_count,
+                          const MaterialTableShaderCode *shaders,
+                          size_t shader_count);
+
+#endif
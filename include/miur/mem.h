@@ -13,6 +13,8 @@
 #define MIUR_NEW(type) ((type *) calloc(1, sizeof(type)))
 #define MIUR_FREE(ptr) (free((void*) ptr))
 #define MIUR_ARR(type, size) ((type *) calloc(size, sizeof(type)))
+/* Like MIUR_ARR but not zeroed, for buffers that are overwritten at once. */
+#define MIUR_ARR_UNINIT(type, size) ((type *) malloc(sizeof(type) * (size)))
 #define MIUR_REALLOC(type, ptr, size) ((type *) realloc(ptr, sizeof(type) * size))
 
 #endif
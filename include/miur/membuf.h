@@ -12,15 +12,47 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+typedef enum
+{
+  MEMBUF_HEAP = 0,  /* Owned heap allocation, freed on destroy. */
+  MEMBUF_MAPPED,    /* Read only file mapping, unmapped on destroy. */
+  MEMBUF_VIEW,      /* Borrowed memory, e.g. inside a mounted archive. */
+} MembufKind;
+
+typedef enum
+{
+  /* The file will be read front to back once, e.g. JSON. */
+  MEMBUF_MAP_SEQUENTIAL = 1 << 0,
+  /* Start paging the whole file in now, e.g. vertex buffers. */
+  MEMBUF_MAP_WILLNEED   = 1 << 1,
+} MembufMapFlags;
+
 typedef struct
 {
   const uint8_t *data;
   size_t size;
+  MembufKind kind;
 } Membuf;
 
+/* Reads the whole file into a heap copy. */
 bool membuf_load_file(Membuf *membuf, const char *filename);
+
+/*
+ * Maps the file read only without copying it.  The contents are only valid
+ * until membuf_destroy and must not be used for files that may be truncated
+ * while mapped, hot reloaded sources should use membuf_load_file.
+ */
+bool membuf_map_file(Membuf *membuf, const char *filename,
+                     MembufMapFlags flags);
+
 bool membuf_write_file(Membuf membuf, const char *filename);
 
+/*
+ * Writes to "<filename>.tmp" and renames it over `filename`, so readers,
+ * including ones that mapped the old file, never see a partial write.
+ */
+bool membuf_replace_file(Membuf membuf, const char *filename);
+
 void membuf_destroy(Membuf *membuf);
 
 #endif
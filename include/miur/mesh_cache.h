@@ -0,0 +1,164 @@
+/* =====================
+ * include/miur/mesh_cache.h
+ * 10/18/2026
+ * Cooked mesh cache files.
+ * ====================
+ */
+
+/*
+ * A cooked model is laid out as
+ *
+ *   MeshCacheHeader
+ *   MeshCacheEntry meshes[mesh_count]
+ *   char dependencies[]             NUL terminated source paths
+ *   int32_t node_parents[]          as in StaticModel, from here on each
+ *   float node_local[][16]          array is aligned to MESH_CACHE_ALIGNMENT
+ *   MeshInstance instances[]
+ *   MeshCacheImage images[]
+ *   MeshCacheTexture textures[]
+ *   streams
+ *   image data
+ *
+ * Each mesh's streams are back to back in the order positions, normals,
+ * texture coordinates, indices of every level of detail and the meshlet
+ * block.  The vertex and index streams are compressed with mesh_codec.h,
+ * the entry records their encoded sizes, the meshlet block is stored as
+ * MeshletBuffer lays it out.  A load decodes every stream into a single
+ * allocation in the formats StaticMesh uses.
+ *
+ * Vertices are stored as floats, losslessly, not quantized.  Each technique
+ * picks the format its meshes are uploaded in, see vertex_format.h, and
+ * the quantized ones fit their bounds and encode then, so techniques that
+ * draw with floats never see rounded vertices.
+ *
+ * Images are stored cooked, each as the whole allocation of a Texture with
+ * its mips, usually BC compressed.  The mips are laid out as texture_layout
+ * gives them, so a load copies the block as is.
+ *
+ * source_hash covers the model file and every dependency, in order.  The
+ * dependencies are stored relative to the model file so a cache can be
+ * checked against its sources without parsing them.  All fields are little
+ * endian.
+ */
+
+#ifndef MIUR_MESH_CACHE_H
+#define MIUR_MESH_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <miur/membuf.h>
+#include <miur/model.h>
+
+#define MESH_CACHE_MAGIC "MIURMSH"
+#define MESH_CACHE_VERSION 9
+#define MESH_CACHE_ALIGNMENT 64
+#define MESH_CACHE_EXTENSION ".miurmesh"
+
+typedef struct
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t mesh_count;
+  uint64_t source_hash;
+  uint32_t dependency_count;
+  uint32_t dependencies_size;
+  uint64_t meshes_offset;
+  uint64_t dependencies_offset;
+  uint64_t file_size;
+  uint32_t node_count;
+  uint32_t instance_count;
+  uint64_t parents_offset;
+  uint64_t locals_offset;
+  uint64_t instances_offset;
+  uint32_t image_count;
+  uint32_t texture_count;
+  uint64_t images_offset;
+  uint64_t textures_offset;
+} MeshCacheHeader;
+
+typedef enum
+{
+  MESH_CACHE_HAS_UV = 1 << 0,
+} MeshCacheFlags;
+
+typedef struct
+{
+  uint32_t vert_count;
+  uint32_t index_count;
+  uint32_t flags;
+  uint32_t meshlet_count;
+  uint64_t pos_offset;
+  uint64_t norm_offset;
+  uint64_t uv_offset;
+  uint64_t index_offset;
+  uint64_t pos_size;           /* Encoded sizes of the streams above. */
+  uint64_t norm_size;
+  uint64_t uv_size;
+  uint64_t index_size;
+  Aabb bounds;
+  BoundingSphere sphere;
+  uint64_t meshlet_offset;
+  uint32_t meshlet_vertex_count;
+  uint32_t meshlet_triangle_size;
+  uint32_t lod_count;
+  uint32_t lod_index_count;    /* Past index_count, for every lod. */
+  MeshLod lods[MESH_MAX_LODS];
+} MeshCacheEntry;
+
+typedef struct
+{
+  uint32_t format;             /* TextureFormat. */
+  uint32_t width;              /* 0 for an image that failed to cook. */
+  uint32_t height;
+  uint32_t mip_count;
+  uint64_t offset;
+  uint64_t size;               /* Texture.size, of every mip. */
+} MeshCacheImage;
+
+typedef enum
+{
+  MESH_CACHE_SAMPLER_MAG_LINEAR = 1 << 0,
+  MESH_CACHE_SAMPLER_MIN_LINEAR = 1 << 1,
+  MESH_CACHE_SAMPLER_MIP_LINEAR = 1 << 2,
+  MESH_CACHE_SAMPLER_MIPMAPPED = 1 << 3,
+} MeshCacheSamplerFlags;
+
+typedef struct
+{
+  uint32_t image;
+  uint32_t sampler_flags;
+  uint32_t wrap_u;             /* TextureWrap. */
+  uint32_t wrap_v;
+} MeshCacheTexture;
+
+typedef struct
+{
+  Membuf file;
+  const MeshCacheHeader *header;
+  const MeshCacheEntry *meshes;
+  const char *dependencies;
+} MeshCache;
+
+/* Maps `filename` and validates its layout, not its sources. */
+bool mesh_cache_open(MeshCache *cache_out, const char *filename);
+void mesh_cache_close(MeshCache *cache);
+
+/* Iterates the dependency paths, returns NULL after the last one. */
+const char *mesh_cache_next_dependency(const MeshCache *cache,
+                                       const char *prev);
+
+/*
+ * Decodes the meshes into `out` and closes `cache`, whether or not it
+ * succeeds.  The arrays share one allocation, release them with
+ * gltf_model_destroy, the images' data is part of it.  Fails if a stream
+ * is corrupt or memory runs out.
+ */
+bool mesh_cache_to_model(MeshCache *cache, StaticModel *out);
+
+bool mesh_cache_write(const char *filename, const StaticModel *model,
+                      uint64_t source_hash, const char *const *dependencies,
+                      size_t dependency_count);
+
+#endif
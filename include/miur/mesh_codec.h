@@ -0,0 +1,65 @@
+/* =====================
+ * include/miur/mesh_codec.h
+ * 10/18/2026
+ * Index and vertex compression for cooked meshes.
+ * ====================
+ */
+
+/*
+ * Both codecs are built to decode faster than the disk can deliver and
+ * trade some ratio for that.
+ *
+ * Indices are coded a triangle at a time against a FIFO of the last 16
+ * edges and one of the last 16 vertices.  A code byte holds the edge's
+ * position in its FIFO, or 15 for none, and how to get the remaining vertex:
+ * 0 for the next vertex not seen yet, 1 to 14 for a position in the vertex
+ * FIFO plus one, 15 for a zigzag varint delta from the last explicit one in
+ * the data stream.  Triangles without a known edge code their first vertex
+ * in the code byte and the other two in a data byte.  Triangles come back
+ * rotated to start at the shared edge, winding and order are kept.
+ *
+ * Vertices are coded in blocks of 256, one stream per byte of the vertex,
+ * so `stride` must be a multiple of 4 of at most 256 bytes.  Each byte is
+ * the zigzag of its difference to the same byte of the vertex before, in
+ * groups of 16 packed to 0, 2, 4 or 8 bits as their largest value needs.
+ * A stream starts with the 2 bit widths of its groups, four to a byte.
+ * This suits quantized data best, floats still lose their constant and
+ * slowly changing bytes.
+ */
+
+#ifndef MIUR_MESH_CODEC_H
+#define MIUR_MESH_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Largest possible encoded size of `index_count` indices. */
+size_t mesh_index_encode_bound(size_t index_count);
+
+/*
+ * Encodes a triangle list, `index_count` a multiple of 3.  Returns the
+ * encoded size, 0 if it doesn't fit in `capacity`.
+ */
+size_t mesh_index_encode(const uint32_t *indices, size_t index_count,
+                         uint8_t *dst, size_t capacity);
+
+/*
+ * Fails unless `src` holds exactly `index_count` indices, each below
+ * `vertex_count`.
+ */
+bool mesh_index_decode(const uint8_t *src, size_t size, uint32_t *dst,
+                       size_t index_count, size_t vertex_count);
+
+/* Largest possible encoded size of `vertex_count` vertices. */
+size_t mesh_vertex_encode_bound(size_t vertex_count, size_t stride);
+
+/* Returns the encoded size, 0 if it doesn't fit in `capacity`. */
+size_t mesh_vertex_encode(const void *vertices, size_t vertex_count,
+                          size_t stride, uint8_t *dst, size_t capacity);
+
+/* Fails unless `src` holds exactly `vertex_count` vertices of `stride`. */
+bool mesh_vertex_decode(const uint8_t *src, size_t size, void *dst,
+                        size_t vertex_count, size_t stride);
+
+#endif
@@ -0,0 +1,118 @@
+/* =====================
+ * include/miur/mesh_opt.h
+ * 10/18/2026
+ * Mesh optimization passes.
+ * ====================
+ */
+
+/*
+ * Passes meant to run once when a mesh is cooked, in this order:
+ *
+ *   mesh_optimize_vertex_cache     Tipsify triangle order, which keeps
+ *                                  recently transformed vertices hot in the
+ *                                  post-transform cache.
+ *   mesh_optimize_overdraw         Splits that order into clusters and sorts
+ *                                  them so outward facing ones draw first,
+ *                                  giving up a bounded amount of cache
+ *                                  efficiency for less overdraw.
+ *   mesh_optimize_vertex_fetch     Renumbers vertices in first use order so
+ *                                  vertex fetch streams through memory.
+ *
+ * Index arrays are uint32_t, as StaticMesh keeps them.  The passes return
+ * false only if they run out of memory.
+ */
+
+#ifndef MIUR_MESH_OPT_H
+#define MIUR_MESH_OPT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <miur/model.h>
+
+/* FIFO size assumed for the post-transform cache. */
+#define MESH_OPT_CACHE_SIZE 16
+/* Largest ACMR increase mesh_optimize_overdraw may cost, as a ratio. */
+#define MESH_OPT_OVERDRAW_THRESHOLD 1.05f
+/* Each level of detail aims for this fraction of the one before. */
+#define MESH_LOD_RATIO 0.5f
+/* Deviation a level may add, relative to the mesh's extent. */
+#define MESH_LOD_MAX_ERROR 0.05f
+/* Meshes this small, in triangles, get no further levels. */
+#define MESH_LOD_MIN_TRIANGLES 64
+
+typedef struct
+{
+  uint32_t misses;             /* Vertex shader invocations. */
+  uint32_t triangles;
+  uint32_t vertices;           /* Distinct vertices referenced. */
+  float acmr;                  /* Misses per triangle, 0.5 at best. */
+  float atvr;                  /* Misses per vertex, 1.0 at best. */
+} VertexCacheStats;
+
+typedef struct
+{
+  VertexCacheStats before;
+  VertexCacheStats after;
+} MeshOptReport;
+
+/* Simulates a FIFO cache of `cache_size` entries over `indices`. */
+VertexCacheStats mesh_analyze_vertex_cache(const uint32_t *indices,
+                                           size_t index_count,
+                                           size_t vertex_count,
+                                           uint32_t cache_size);
+
+/*
+ * Writes the reordered triangles to `dst`, which must not alias `indices`.
+ * When `clusters` is given, sized index_count / 3, it receives the first
+ * triangle of every run where the fan order broke off, and `cluster_count`
+ * how many there are.
+ */
+bool mesh_optimize_vertex_cache(uint32_t *dst, const uint32_t *indices,
+                                size_t index_count, size_t vertex_count,
+                                uint32_t cache_size, uint32_t *clusters,
+                                size_t *cluster_count);
+
+/*
+ * Reorders the clusters found by mesh_optimize_vertex_cache, split further
+ * where that keeps each within `threshold` of its ACMR.  `positions` holds 3
+ * floats per vertex and `dst` must not alias `indices`.
+ */
+bool mesh_optimize_overdraw(uint32_t *dst, const uint32_t *indices,
+                            size_t index_count, const float *positions,
+                            size_t vertex_count, const uint32_t *clusters,
+                            size_t cluster_count, uint32_t cache_size,
+                            float threshold);
+
+/*
+ * Fills `remap` with the new index of every vertex, UINT32_MAX for unused
+ * ones, and returns how many vertices remain.
+ */
+size_t mesh_optimize_vertex_fetch(uint32_t *remap, const uint32_t *indices,
+                                  size_t index_count, size_t vertex_count);
+
+/* Moves `vertex_count` elements of `size` bytes to their remapped slots. */
+void mesh_remap_vertices(void *dst, const void *src, size_t vertex_count,
+                         size_t size, const uint32_t *remap);
+
+/*
+ * Runs every pass on `mesh`, whose arrays must be heap allocated, and swaps
+ * in new ones.  Vertices no triangle uses are dropped.
+ */
+bool static_mesh_optimize(StaticMesh *mesh, MeshOptReport *report);
+
+/* Replaces the meshlets of `mesh` with ones built from its indices. */
+bool static_mesh_build_meshlets(StaticMesh *mesh);
+
+/*
+ * Appends simplified levels of detail to the indices of `mesh`, each from
+ * the one before, until one fails to get meaningfully smaller.  See
+ * simplify.h.
+ */
+bool static_mesh_build_lods(StaticMesh *mesh);
+
+/* Indices in `mesh`, the full level and every lod. */
+uint32_t static_mesh_index_total(const StaticMesh *mesh);
+
+#endif
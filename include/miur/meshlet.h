@@ -0,0 +1,100 @@
+/* =====================
+ * include/miur/meshlet.h
+ * 10/18/2026
+ * Meshlet generation.
+ * ====================
+ */
+
+/*
+ * Meshlets are small clusters of a mesh's triangles, each with a bounding
+ * sphere and a normal cone so whole clusters can be culled at once.  All of
+ * a mesh's meshlets live in one block, uploaded as is:
+ *
+ *   Meshlet meshlets[meshlet_count]
+ *   uint32_t vertices[vertex_count]      mesh vertex indices
+ *   uint8_t triangles[triangle_size]     3 meshlet local vertex indices per
+ *                                        triangle
+ *
+ * A meshlet's vertices start at vertex_offset and its triangles at byte
+ * triangle_offset of their arrays, which is a multiple of 4 so shaders can
+ * read them as words.  The block holds no pointers, the mesh cache stores it
+ * verbatim.
+ */
+
+#ifndef MIUR_MESHLET_H
+#define MIUR_MESHLET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+
+/*
+ * Laid out for std430.  A meshlet can be skipped when
+ *
+ *   dot(normalize(cone_apex - camera), cone_axis) >= cone_cutoff
+ *
+ * since every triangle in it is then back facing.  A cutoff of 1 means
+ * the normals spread too far for that.
+ */
+typedef struct
+{
+  float center[3];
+  float radius;
+  float cone_apex[3];
+  float cone_cutoff;
+  float cone_axis[3];
+  uint32_t vertex_offset;
+  uint32_t triangle_offset;
+  uint32_t vertex_count;
+  uint32_t triangle_count;
+  uint32_t reserved;
+} Meshlet;
+
+typedef struct
+{
+  Meshlet *meshlets;
+  uint32_t *vertices;
+  uint8_t *triangles;
+  uint32_t meshlet_count;
+  uint32_t vertex_count;
+  uint32_t triangle_size;
+  /* The block the arrays point into, NULL if there are no meshlets. */
+  void *data;
+  size_t size;
+} MeshletBuffer;
+
+/* Bytes taken by a block with the given counts. */
+size_t meshlet_buffer_size(uint32_t meshlet_count, uint32_t vertex_count,
+                           uint32_t triangle_size);
+
+/* Points the arrays of `buf` into `data`, which must be 4 byte aligned. */
+void meshlet_buffer_bind(MeshletBuffer *buf, void *data,
+                         uint32_t meshlet_count, uint32_t vertex_count,
+                         uint32_t triangle_size);
+
+/* Frees a block allocated by meshlet_build. */
+void meshlet_buffer_destroy(MeshletBuffer *buf);
+
+/*
+ * Groups the triangles of `indices` into meshlets, growing each one across
+ * shared vertices and preferring triangles that add few vertices and stay
+ * close to its center and normal.  When no triangle shares a vertex with it
+ * the nearest one left is taken, so flat shaded meshes fill meshlets too.
+ * A new meshlet starts next to the last one, or at the first triangle left.
+ * `positions` holds 3 floats per vertex.
+ */
+bool meshlet_build(MeshletBuffer *out, const uint32_t *indices,
+                   size_t index_count, const float *positions,
+                   size_t vertex_count);
+
+/*
+ * Checks the limits and that the meshlets cover every triangle of
+ * `indices` exactly once, with the same winding.  Slow, for debug builds.
+ */
+bool meshlet_validate(const MeshletBuffer *buf, const uint32_t *indices,
+                      size_t index_count, size_t vertex_count);
+
+#endif
@@ -12,7 +12,26 @@
 
 #include <stdint.h>
 
+#include <miur/bounds.h>
 #include <miur/material.h>
+#include <miur/membuf.h>
+#include <miur/meshlet.h>
+#include <miur/texture.h>
+#include <miur/vertex_format.h>
+
+#define MESH_MAX_LODS 8
+
+/*
+ * A coarser level of detail, drawn from the mesh's own vertices.  `error` is
+ * how far it may stray from the full mesh in object space, project it to
+ * pick the coarsest level that stays under a pixel.
+ */
+typedef struct
+{
+  uint32_t first_index;
+  uint32_t index_count;
+  float error;
+} MeshLod;
 
 typedef struct
 {
@@ -20,23 +39,78 @@ typedef struct
   float *verts_norm;   /* (x,y,z). 3 per vert_count. */
   float *verts_uv;     /* (x,y). 2 per vert_count. */
   uint32_t vert_count; /* Number of vertices in the mesh. */
+  Aabb bounds;         /* Object space, of verts_pos. */
+  BoundingSphere sphere;
 
-  uint16_t *indices;
-  uint32_t index_count;
+  uint32_t *indices;    /* The full level, then each of lods. */
+  uint32_t index_count; /* Of the full level. */
+  MeshLod lods[MESH_MAX_LODS];
+  uint32_t lod_count;
 
-  VkBuffer vert_bufs[3];
+  /* Clusters for culling, empty if the mesh has none. */
+  MeshletBuffer meshlets;
+
+  /* One per VertexAttribute, in the format of the material's technique. */
+  VkBuffer vert_bufs[VERTEX_ATTRIBUTE_COUNT];
   VkBuffer index_buf;
-  VkDeviceMemory norm_memory;
-  VkDeviceMemory pos_memory;
+  /* The narrowest that fits vert_count, picked at upload. */
+  VkIndexType index_type;
+  VkDeviceMemory vert_memory[VERTEX_ATTRIBUTE_COUNT];
   VkDeviceMemory index_memory;
+  VertexQuantization quantization;
 
   Material *material;
 } StaticMesh;
 
+/*
+ * A placement of one of the model's meshes at a node.  Meshes are shared,
+ * one used by several nodes is stored and uploaded once.
+ */
+typedef struct
+{
+  uint32_t mesh;
+  uint32_t node;
+} MeshInstance;
+
+/* A glTF texture, one of the model's images and how to sample it. */
+typedef struct
+{
+  uint32_t image;
+  TextureSampler sampler;
+} ModelTexture;
+
 typedef struct
 {
   StaticMesh *meshes;
   uint32_t mesh_count;
+
+  /*
+   * The node hierarchy flattened so parents come before their children,
+   * matrices as in transform.h.  node_world is derived from the rest when
+   * the model is loaded.
+   */
+  int32_t *node_parents;       /* -1 for roots. */
+  float *node_local;           /* 16 per node, relative to the parent. */
+  float *node_world;           /* 16 per node. */
+  uint32_t node_count;
+  MeshInstance *instances;
+  uint32_t instance_count;
+  /* World space bounds of each instance, derived along with node_world. */
+  Aabb *instance_bounds;
+
+  /*
+   * Cooked with their mips: base and emissive color to BC7 sRGB, normal
+   * maps to BC5 and the rest to BC7, KTX2 images as they are.  An image
+   * that fails to decode is left empty, one that fails to compress stays
+   * RGBA8.
+   */
+  Texture *images;
+  uint32_t image_count;
+  ModelTexture *textures;
+  uint32_t texture_count;
+
+  /* Decoded cache backing the other arrays, empty if they are allocated. */
+  Membuf storage;
 } StaticModel;
 
 #endif
@@ -31,6 +31,29 @@ typedef struct
 
 typedef uint64_t GPUTechnique;
 
+/* A sampled image with every mip of a texture, and a view of them. */
+typedef struct
+{
+  VkImage image;
+  VkDeviceMemory memory;
+  VkImageView view;
+} GPUTexture;
+
+/*
+ * A mesh or texture copy in flight on the graphics queue.  The staging side
+ * is freed once its fence signals, the mesh keeps its device local buffers
+ * and the texture its image.
+ */
+typedef struct
+{
+  StaticMesh *mesh;            /* NULL for a texture. */
+  VkBuffer staging;
+  VkDeviceMemory staging_memory;
+  VkCommandBuffer commands;
+  VkFence fence;
+  VkDeviceSize size;
+} RendererUpload;
+
 Renderer *renderer_create(RendererBuilder *builder);
 void renderer_destroy(Renderer *render);
 bool renderer_draw(Renderer *render);
@@ -39,4 +62,31 @@ void renderer_configure(Renderer *render, RendererConfigure *cofigure);
 bool renderer_init_static_mesh(Renderer *render, StaticMesh *mesh);
 void renderer_deinit_static_mesh(Renderer *render, StaticMesh *mesh);
 
+/*
+ * Stages the mesh and submits copies into device local buffers without
+ * waiting on them.  The mesh can't be drawn until the upload is done, on
+ * failure it holds no buffers.
+ */
+bool renderer_upload_static_mesh(Renderer *render, StaticMesh *mesh,
+                                 RendererUpload *upload_out);
+/* Whether the device can sample `format`, BC needs textureCompressionBC. */
+bool renderer_can_sample(Renderer *render, TextureFormat format);
+/*
+ * Copies `texture` into one staging buffer as it's laid out, then into a
+ * new image with a single copy command covering every mip.  Nothing is
+ * converted, fails if the device can't sample the format, where
+ * texture_decompress can stand in.  The texture can be freed on return.
+ */
+bool renderer_upload_texture(Renderer *render, const Texture *texture,
+                             GPUTexture *gpu_out, RendererUpload *upload_out);
+void renderer_deinit_texture(Renderer *render, GPUTexture *texture);
+/* Returns true and frees the staging side once the copies have finished. */
+bool renderer_upload_poll(Renderer *render, RendererUpload *upload);
+void renderer_upload_wait(Renderer *render, RendererUpload *upload);
+/*
+ * Draws every instance of `model` at its node's world matrix from the next
+ * frame on, NULL for nothing.  Its meshes must have been uploaded.
+ */
+void renderer_show_static_model(Renderer *render, StaticModel *model);
+
 #endif
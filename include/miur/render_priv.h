@@ -35,7 +35,7 @@ struct Renderer
   VkDebugUtilsMessengerEXT vk_messenger;
   Swapchain swapchain;
 
-  StaticMesh *mesh;
+  StaticModel *model;
 
   ShaderCache shader_cache;
   TechniqueCache technique_cache;
@@ -0,0 +1,88 @@
+/* =====================
+ * include/miur/scene.h
+ * 10/18/2026
+ * Scene graph with incremental transform updates.
+ * ====================
+ */
+
+/*
+ * Nodes are kept as arrays ordered breadth first, by depth and with each
+ * node's children next to each other.  Parents come before their children
+ * and a node's children are one range of slots, so an update walks the
+ * dirty bits in slot order, marking the child range of every node it
+ * recomputes, and touches only the subtrees under nodes that changed.
+ *
+ * Adding nodes moves slots around on the next update, SceneNode handles
+ * stay.  World matrices are packed in slot order, ready to upload.
+ */
+
+#ifndef MIUR_SCENE_H
+#define MIUR_SCENE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <miur/model.h>
+
+#define SCENE_NO_NODE UINT32_MAX
+
+typedef uint32_t SceneNode;
+
+typedef struct
+{
+  /* By slot. */
+  uint32_t *parents;           /* SCENE_NO_NODE for roots. */
+  uint32_t *first_child;       /* Children are first_child + [0, count). */
+  uint32_t *child_count;
+  SceneNode *handles;
+  float *local;                /* 16 floats each, see transform.h. */
+  float *world;
+  uint64_t *dirty;
+
+  /* By handle, only used to rebuild the order. */
+  uint32_t *slots;
+  SceneNode *links;            /* Parent, first child, last child, next. */
+  SceneNode first_root;
+  SceneNode last_root;
+
+  uint32_t count;
+  uint32_t capacity;
+  bool unordered;              /* Nodes were added since the last update. */
+} Scene;
+
+/* The slots whose world matrix changed are in [first, end). */
+typedef struct
+{
+  uint32_t first;
+  uint32_t end;
+  uint32_t updated;
+} SceneUpdate;
+
+bool scene_create(Scene *scene_out, uint32_t capacity);
+void scene_destroy(Scene *scene);
+
+/*
+ * Adds a node under `parent`, or as a root for SCENE_NO_NODE.  `local` may
+ * be NULL for identity.  Returns SCENE_NO_NODE when out of memory.
+ */
+SceneNode scene_add(Scene *scene, SceneNode parent, const float *local);
+
+/*
+ * Adds every node of `model` under `parent`, their handles `*first_out`
+ * plus the model's node index.
+ */
+bool scene_add_model(Scene *scene, const StaticModel *model, SceneNode parent,
+                     SceneNode *first_out);
+
+void scene_set_local(Scene *scene, SceneNode node, const float *local);
+
+/* Valid from the next scene_update after the node was added or changed. */
+const float *scene_world(const Scene *scene, SceneNode node);
+
+/* Where the node's matrices are, changes when nodes are added. */
+uint32_t scene_slot(const Scene *scene, SceneNode node);
+
+/* Recomputes the world matrices of changed nodes and everything below. */
+bool scene_update(Scene *scene, SceneUpdate *update_out);
+
+#endif
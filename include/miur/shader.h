@@ -41,4 +41,12 @@ bool shader_cache_reload_shader(VkDevice dev, ShaderCache *cache,
     ShaderModule *module, const char *path);
 ShaderModule *shader_cache_load(VkDevice dev, ShaderCache *cache,
                                 String *str);
+/*
+ * As shader_cache_load, from SPIR-V compiled ahead of time.  `code` is
+ * copied, `str` is the path of its source for hot reload to find.
+ */
+ShaderModule *shader_cache_load_spirv(VkDevice dev, ShaderCache *cache,
+                                      String *str,
+                                      VkShaderStageFlagBits stage,
+                                      const void *code, size_t size);
 #endif
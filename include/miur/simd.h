@@ -0,0 +1,49 @@
+/* =====================
+ * include/miur/simd.h
+ * 10/18/2026
+ * SIMD feature detection.
+ * ====================
+ */
+
+#ifndef MIUR_SIMD_H
+#define MIUR_SIMD_H
+
+/*
+ * SSE2 is part of the x86-64 baseline, so every 64 bit build gets it.  AVX2
+ * is only used when the compiler is explicitly told it may emit it
+ * (-mavx2, /arch:AVX2), there is no runtime dispatch.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIUR_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define MIUR_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MIUR_CTZ32(x) _miur_ctz32(x)
+#define MIUR_CTZ64(x) _miur_ctz64(x)
+static __inline unsigned _miur_ctz32(unsigned x)
+{
+  unsigned long idx;
+  _BitScanForward(&idx, x);
+  return (unsigned) idx;
+}
+static __inline unsigned _miur_ctz64(unsigned long long x)
+{
+  unsigned long idx;
+  _BitScanForward64(&idx, x);
+  return (unsigned) idx;
+}
+#else
+#define MIUR_CTZ32(x) ((unsigned) __builtin_ctz(x))
+#define MIUR_CTZ64(x) ((unsigned) __builtin_ctzll(x))
+#endif
+
+#endif
@@ -0,0 +1,54 @@
+/* =====================
+ * include/miur/simplify.h
+ * 10/18/2026
+ * Quadric error mesh simplification.
+ * ====================
+ */
+
+/*
+ * Simplifies by collapsing edges, each vertex onto a neighbour, in the order
+ * of Garland and Heckbert's quadric error.  Vertices are never moved or
+ * created, so every simplified level indexes the original vertex buffer.
+ *
+ * Vertices that share a position but not attributes, i.e. UV or normal
+ * seams, and those on non-manifold edges stay put.  Open borders only
+ * collapse along themselves, or stay put with MESH_SIMPLIFY_LOCK_BORDER,
+ * which keeps separately simplified pieces watertight.
+ */
+
+#ifndef MIUR_SIMPLIFY_H
+#define MIUR_SIMPLIFY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef enum
+{
+  MESH_SIMPLIFY_LOCK_BORDER = 1 << 0,
+} MeshSimplifyFlags;
+
+typedef struct
+{
+  size_t target_index_count;
+  /* Largest deviation allowed, relative to the mesh's extent. */
+  float target_error;
+  /* Optional, `attribute_count` floats per vertex and a weight for each. */
+  const float *attributes;
+  const float *attribute_weights;
+  size_t attribute_count;
+  uint32_t flags;
+} MeshSimplifyDesc;
+
+/*
+ * Writes the simplified triangles to `dst`, sized for `index_count`, and
+ * stops at the target count or error, whichever comes first.  `error_out`
+ * gets the deviation reached in object space units.  Fails only if out of
+ * memory.
+ */
+bool mesh_simplify(uint32_t *dst, size_t *index_count_out, float *error_out,
+                   const uint32_t *indices, size_t index_count,
+                   const float *positions, size_t vertex_count,
+                   const MeshSimplifyDesc *desc);
+
+#endif
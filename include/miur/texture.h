@@ -0,0 +1,124 @@
+/* =====================
+ * include/miur/texture.h
+ * 10/18/2026
+ * Mipmapped textures.
+ * ====================
+ */
+
+/*
+ * A texture holds every mip level of an image in one allocation, largest
+ * first, each level's rows packed and its offset aligned to
+ * TEXTURE_MIP_ALIGNMENT.  Compressed levels are packed rows of blocks.  The
+ * whole block can be copied into a staging buffer as is and each level
+ * copied out with its offset.
+ *
+ * Levels halve down to 1x1 and are filtered from the level above.  sRGB
+ * textures are filtered in linear light, alpha always is.  Color isn't
+ * weighted by alpha.
+ */
+
+#ifndef MIUR_TEXTURE_H
+#define MIUR_TEXTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <miur/image.h>
+
+/* Enough for IMAGE_MAX_DIMENSION down to 1x1. */
+#define TEXTURE_MAX_MIPS 15
+/* A multiple of the texel block size of every format. */
+#define TEXTURE_MIP_ALIGNMENT 16
+
+/* The BC formats store 4x4 texel blocks, see texture_compress.h. */
+typedef enum
+{
+  TEXTURE_FORMAT_RGBA8,
+  TEXTURE_FORMAT_RGBA8_SRGB,
+  TEXTURE_FORMAT_BC1,
+  TEXTURE_FORMAT_BC1_SRGB,
+  TEXTURE_FORMAT_BC3,
+  TEXTURE_FORMAT_BC3_SRGB,
+  TEXTURE_FORMAT_BC5,
+  TEXTURE_FORMAT_BC7,
+  TEXTURE_FORMAT_BC7_SRGB,
+  TEXTURE_FORMAT_COUNT,
+} TextureFormat;
+
+typedef enum
+{
+  /* The average of the texels under each texel, fast and a little soft. */
+  MIP_FILTER_BOX,
+  /* A windowed sinc, sharper at about three times the cost. */
+  MIP_FILTER_KAISER,
+} MipFilter;
+
+typedef enum
+{
+  TEXTURE_WRAP_REPEAT,
+  TEXTURE_WRAP_MIRRORED_REPEAT,
+  TEXTURE_WRAP_CLAMP_TO_EDGE,
+} TextureWrap;
+
+/* How a texture is sampled, nearest wherever a flag is false. */
+typedef struct
+{
+  bool mag_linear;
+  bool min_linear;
+  bool mip_linear;
+  bool mipmapped;
+  TextureWrap wrap_u;
+  TextureWrap wrap_v;
+} TextureSampler;
+
+typedef struct
+{
+  uint32_t width;
+  uint32_t height;
+  size_t offset;               /* Into Texture.data. */
+  size_t size;
+} TextureMip;
+
+typedef struct
+{
+  TextureFormat format;
+  uint32_t width;
+  uint32_t height;
+  TextureMip mips[TEXTURE_MAX_MIPS];
+  uint32_t mip_count;
+  uint8_t *data;
+  size_t size;
+} Texture;
+
+/* glTF's default, linear filtering that repeats. */
+extern const TextureSampler texture_sampler_default;
+
+/*
+ * Decodes a PNG or JPEG and builds its mips.  `srgb` is whether the image
+ * holds color, rather than e.g. normals.  `out` is left empty on failure.
+ */
+bool texture_decode(Texture *out, const uint8_t *data, size_t size,
+                    bool srgb, MipFilter filter);
+
+/* As texture_decode, taking over the pixels of a decoded image. */
+bool texture_from_image(Texture *out, Image *image, bool srgb,
+                        MipFilter filter);
+
+void texture_destroy(Texture *texture);
+
+/*
+ * Fills in the size, mips and total size of a `width` x `height` texture
+ * in `format`, without allocating.  Fails if the size is out of range.
+ */
+bool texture_layout(Texture *texture, TextureFormat format, uint32_t width,
+                    uint32_t height);
+
+/* Keeps the first `mip_count` levels of a layout, e.g. a partial chain. */
+void texture_truncate_mips(Texture *texture, uint32_t mip_count);
+
+/* Bytes per 4x4 block, or 0 for the uncompressed formats. */
+uint32_t texture_format_block_size(TextureFormat format);
+bool texture_format_is_srgb(TextureFormat format);
+
+#endif
@@ -0,0 +1,62 @@
+/* =====================
+ * include/miur/texture_compress.h
+ * 10/18/2026
+ * BC block compression.
+ * ====================
+ */
+
+/*
+ * Encodes RGBA8 textures into the BC formats GPUs sample directly, for the
+ * cook step: BC1 for opaque color at 4 bits per texel, BC3 for color with
+ * alpha, BC5 for two channel data such as normal maps and BC7 for
+ * everything else at 8 bits per texel and the best quality.  sRGB formats
+ * are encoded on the sRGB values, as they're stored.
+ *
+ * Encoding fits each 4x4 block's endpoints along its principal axis, picks
+ * each texel's nearest palette entry and refines the endpoints by least
+ * squares.  BC7 tries a subset of its modes and partitions according to
+ * the quality.  Every block is encoded independently, so a texture is
+ * split into runs of blocks across the job system.
+ */
+
+#ifndef MIUR_TEXTURE_COMPRESS_H
+#define MIUR_TEXTURE_COMPRESS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <miur/job.h>
+#include <miur/texture.h>
+
+typedef enum
+{
+  /* A single fit, BC7 only uses mode 6. */
+  TEXTURE_QUALITY_FAST,
+  /* One refinement, BC7 also tries the best estimated partitions. */
+  TEXTURE_QUALITY_NORMAL,
+  /* More refinement and every BC7 mode, several times slower. */
+  TEXTURE_QUALITY_HIGH,
+} TextureQuality;
+
+/*
+ * Compresses every mip of an RGBA8 or RGBA8_SRGB texture into the BC
+ * `format`.  Runs on `jobs` and waits for them, or inline when `jobs` is
+ * NULL.  `out` is left empty on failure.
+ */
+bool texture_compress(Texture *out, const Texture *src, TextureFormat format,
+                      TextureQuality quality, JobSystem *jobs);
+
+/*
+ * Encodes and decodes a single block of 4x4 RGBA8 texels, in rows.  BC5
+ * takes its channels from red and green and decodes with blue 0 and alpha
+ * 255, BC1 drops alpha.
+ */
+void texture_encode_block(TextureFormat format, TextureQuality quality,
+                          const uint8_t texels[64], uint8_t *block);
+void texture_decode_block(TextureFormat format, const uint8_t *block,
+                          uint8_t texels[64]);
+
+/* Decodes every mip into RGBA8, e.g. where a GPU lacks the format. */
+bool texture_decompress(Texture *out, const Texture *src);
+
+#endif
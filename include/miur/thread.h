@@ -21,8 +21,24 @@ typedef uintptr_t Thread;
 
 typedef CRITICAL_SECTION Mutex;
 
+typedef CONDITION_VARIABLE CondVar;
+
+typedef volatile LONG AtomicI32;
+
+#elif defined(MIUR_PLATFORM_POSIX)
+
+#include <pthread.h>
+
+typedef pthread_t Thread;
+
+typedef pthread_mutex_t Mutex;
+
+typedef pthread_cond_t CondVar;
+
+typedef volatile int32_t AtomicI32;
+
 #else
-#error Threads only support windows.
+#error Threads only support windows and posix.
 #endif
 
 
@@ -31,6 +47,13 @@ typedef void (*ThreadStartFunction)(void *ud);
 bool thread_create(Thread *thread_out, ThreadStartFunction function, void *ud);
 void thread_join(Thread *thread);
 void thread_destroy(Thread *thread);
+void thread_yield(void);
+
+/* Number of logical processors, at least 1. */
+uint32_t thread_cpu_count(void);
+
+/* Monotonic clock in nanoseconds, from an arbitrary start. */
+uint64_t thread_time_ns(void);
 
 typedef enum
 {
@@ -45,4 +68,17 @@ bool mutex_try_lock(Mutex *mutex);
 void mutex_lock(Mutex *mutex);
 void mutex_unlock(Mutex *mutex);
 
+void cond_create(CondVar *cond_out);
+void cond_destroy(CondVar *cond);
+/* Releases `mutex` while waiting, wakeups may be spurious. */
+void cond_wait(CondVar *cond, Mutex *mutex);
+void cond_signal(CondVar *cond);
+void cond_broadcast(CondVar *cond);
+
+/* Sequentially consistent atomics, atomic_i32_add returns the new value. */
+int32_t atomic_i32_load(AtomicI32 *atomic);
+void atomic_i32_store(AtomicI32 *atomic, int32_t value);
+int32_t atomic_i32_add(AtomicI32 *atomic, int32_t value);
+bool atomic_i32_cas(AtomicI32 *atomic, int32_t expected, int32_t desired);
+
 #endif
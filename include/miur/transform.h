@@ -0,0 +1,40 @@
+/* =====================
+ * include/miur/transform.h
+ * 10/18/2026
+ * 4x4 transforms and node hierarchies.
+ * ====================
+ */
+
+/*
+ * Matrices are 16 floats in column major order, as glTF and GLSL store
+ * them, and transform column vectors, so a child's world matrix is
+ * `parent_world * local`.  Nothing needs to be aligned.
+ */
+
+#ifndef MIUR_TRANSFORM_H
+#define MIUR_TRANSFORM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+void mat4_identity(float *out);
+
+/*
+ * Builds translation * rotation * scale, `rotation` a unit quaternion as
+ * (x, y, z, w).
+ */
+void mat4_from_trs(float *out, const float *translation,
+                   const float *rotation, const float *scale);
+
+/* out = a * b, `out` may alias either. */
+void mat4_mul(float *out, const float *a, const float *b);
+
+/*
+ * Fills the world matrices of `count` nodes from their local ones.  Nodes
+ * are ordered so every parent comes before its children, `parents` holds
+ * each one's parent index or -1 for roots.
+ */
+void transform_compute_world(float *world, const float *local,
+                             const int32_t *parents, size_t count);
+
+#endif
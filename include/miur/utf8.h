@@ -0,0 +1,24 @@
+/* =====================
+ * include/miur/utf8.h
+ * 10/18/2026
+ * UTF-8 validation and encoding.
+ * ====================
+ */
+
+#ifndef MIUR_UTF8_H
+#define MIUR_UTF8_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define UTF8_MAX_ENCODED_LENGTH 4
+
+/* Rejects overlong encodings, surrogates and code points above U+10FFFF. */
+bool utf8_validate(const uint8_t *data, size_t size);
+
+/* Returns the number of bytes written to `out`, 0 if `codepoint` is not a
+ * valid scalar value. */
+size_t utf8_encode(uint32_t codepoint, uint8_t out[UTF8_MAX_ENCODED_LENGTH]);
+
+#endif
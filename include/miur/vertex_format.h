@@ -0,0 +1,115 @@
+/* =====================
+ * include/miur/vertex_format.h
+ * 10/18/2026
+ * GPU vertex formats.
+ * ====================
+ */
+
+/*
+ * Meshes keep their vertices as floats, a technique picks the format and
+ * layout they are uploaded in.  The formats are:
+ *
+ *                 FLOAT               QUANTIZED
+ *   position      3 x f32 (12 bytes)  4 x snorm16 (8 bytes), xyz relative
+ *                                     to the mesh bounds, w unused
+ *   normal        3 x f32 (12 bytes)  2 x snorm16 (4 bytes), octahedral
+ *   uv            2 x f32 (8 bytes)   2 x f16 (4 bytes)
+ *
+ * Quantized techniques get the mesh's VertexQuantization as vertex stage
+ * push constants and undo it with `position * scale + offset`.
+ *
+ * Round trips stay within half a step for positions, scale / 65534 per
+ * axis plus float rounding, 1e-4 radians for normals, and for uvs within
+ * |uv| / 2048, or 2^-25 below the smallest normal half.
+ *
+ * The separate layout puts each attribute in its own buffer and binding,
+ * the interleaved one puts whole vertices, the attributes in the order
+ * above, in a single buffer and binding.
+ */
+
+#ifndef MIUR_VERTEX_FORMAT_H
+#define MIUR_VERTEX_FORMAT_H
+
+#include <vulkan/vulkan.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum
+{
+  VERTEX_FORMAT_FLOAT,
+  VERTEX_FORMAT_QUANTIZED,
+  VERTEX_FORMAT_COUNT,
+} VertexFormat;
+
+typedef enum
+{
+  VERTEX_ATTRIBUTE_POSITION,
+  VERTEX_ATTRIBUTE_NORMAL,
+  VERTEX_ATTRIBUTE_UV,
+  VERTEX_ATTRIBUTE_COUNT,
+} VertexAttribute;
+
+typedef enum
+{
+  VERTEX_LAYOUT_SEPARATE,
+  VERTEX_LAYOUT_INTERLEAVED,
+  VERTEX_LAYOUT_COUNT,
+} VertexLayout;
+
+/* Names as written in technique files, NULL terminated. */
+extern const char *const vertex_format_names[];
+extern const char *const vertex_layout_names[];
+
+typedef struct
+{
+  float offset[4];
+  float scale[4];
+} VertexQuantization;
+
+/* Largest round trip errors, in object space units, radians and UV units. */
+typedef struct
+{
+  float position;
+  float normal;
+  float uv;
+} VertexQuantizationError;
+
+VkFormat vertex_attribute_format(VertexFormat format, VertexAttribute attr);
+uint32_t vertex_attribute_size(VertexFormat format, VertexAttribute attr);
+/* Offset of `attr` inside an interleaved vertex. */
+uint32_t vertex_attribute_offset(VertexFormat format, VertexAttribute attr);
+/* Size of an interleaved vertex. */
+uint32_t vertex_stride(VertexFormat format);
+uint32_t vertex_layout_binding_count(VertexLayout layout);
+uint32_t vertex_binding_stride(VertexFormat format, VertexLayout layout,
+                               uint32_t binding);
+
+/* Fits the quantization to the bounds of `count` xyz positions. */
+void vertex_quantization_fit(VertexQuantization *quant,
+                             const float *positions, size_t count);
+
+/*
+ * Writes `count` values of `attr` in `format` to `dst`, `stride` bytes
+ * apart.  `src` holds the floats as StaticMesh stores them, or is NULL to
+ * write zeros.  `quant` is only read for quantized positions.
+ */
+void vertex_attribute_write(void *dst, size_t stride, VertexFormat format,
+                            VertexAttribute attr, const float *src,
+                            size_t count, const VertexQuantization *quant);
+
+/*
+ * Writes `count` interleaved vertices to `dst`.  `sources` holds each
+ * attribute's floats, or NULL, as vertex_attribute_write takes them.
+ */
+void vertex_interleave(void *dst, VertexFormat format,
+                       const float *const sources[VERTEX_ATTRIBUTE_COUNT],
+                       size_t count, const VertexQuantization *quant);
+
+/* Measures what quantizing the given attributes loses, `uvs` may be NULL. */
+void vertex_quantization_measure(VertexQuantizationError *error,
+                                 const VertexQuantization *quant,
+                                 const float *positions, const float *normals,
+                                 const float *uvs, size_t count);
+
+#endif
@@ -1,11 +1,21 @@
 #version 450
 
+layout(push_constant) uniform Draw {
+    mat4 model;
+} draw;
+
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 
 layout(location = 0) out vec3 fragColor;
 
+/* The inverse transpose up to scale, normals are renormalized anyway. */
+mat3 cofactor(mat3 m) {
+    return mat3(cross(m[1], m[2]), cross(m[2], m[0]), cross(m[0], m[1]));
+}
+
 void main() {
-    gl_Position = vec4(inPosition, 1.0);
-    fragColor = (inNormal + vec3(0.9, 0.6, 0.3)) * 0.8;
-}
\ No newline at end of file
+    gl_Position = draw.model * vec4(inPosition, 1.0);
+    vec3 normal = normalize(cofactor(mat3(draw.model)) * inNormal);
+    fragColor = (normal + vec3(0.9, 0.6, 0.3)) * 0.8;
+}
@@ -0,0 +1,31 @@
+#version 450
+
+layout(push_constant) uniform Draw {
+    mat4 model;
+    vec4 offset;
+    vec4 scale;
+} draw;
+
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inNormal;
+
+layout(location = 0) out vec3 fragColor;
+
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+/* The inverse transpose up to scale, normals are renormalized anyway. */
+mat3 cofactor(mat3 m) {
+    return mat3(cross(m[1], m[2]), cross(m[2], m[0]), cross(m[0], m[1]));
+}
+
+void main() {
+    vec3 position = inPosition.xyz * draw.scale.xyz + draw.offset.xyz;
+    gl_Position = draw.model * vec4(position, 1.0);
+    vec3 normal = normalize(cofactor(mat3(draw.model)) * octDecode(inNormal));
+    fragColor = (normal + vec3(0.9, 0.6, 0.3)) * 0.8;
+}
\ No newline at end of file
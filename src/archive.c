@@ -0,0 +1,707 @@
+/* =====================
+ * src/archive.c
+ * 10/18/2026
+ * Packed asset archives.
+ * ====================
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <miur/archive.h>
+#include <miur/log.h>
+#include <miur/lz.h>
+#include <miur/mem.h>
+
+#define FNV64_OFFSET 0xcbf29ce484222325ull
+#define FNV64_PRIME 0x100000001b3ull
+/* Blocks that don't shrink below this fraction (in 16ths) are stored raw. */
+#define ARCHIVE_MIN_SAVING 15
+/* Aim for a few jobs per thread so uneven blocks balance out. */
+#define ARCHIVE_JOBS_PER_THREAD 4
+
+typedef struct
+{
+  Archive archive;
+  char *mount_point;
+  size_t mount_point_size;
+} Mount;
+
+typedef struct
+{
+  const uint8_t *src;
+  const uint32_t *block_sizes;
+  const uint64_t *block_offsets;
+  uint8_t *dst;
+  uint64_t size;
+  uint32_t block_size;
+  uint32_t first, last;
+  AtomicI32 *failed;
+} DecodeJob;
+
+static Mount mounts[ARCHIVE_MAX_MOUNTS];
+static size_t mount_count;
+static JobSystem *mount_jobs;
+
+/* === PROTOTYPES === */
+
+static bool validate(Archive *archive);
+static bool validate_blocks(const Archive *archive, const ArchiveEntry *entry);
+static uint32_t block_count(const ArchiveEntry *entry);
+static void decode_job(void *ud);
+static bool decode_blocks(DecodeJob *job);
+static bool compress_entry(const ArchiveInput *input, Membuf *blob_out,
+                           uint32_t *flags_out);
+static bool names_equal(const char *a, const char *b, size_t size);
+static size_t strip_prefix(const char *path, size_t path_size,
+                           const char *prefix, size_t prefix_size);
+static char normalize(char c);
+static uint64_t align_up(uint64_t value);
+static bool write_padding(FILE *file, uint64_t *pos, uint64_t target);
+
+/* === PUBLIC FUNCTIONS === */
+
+bool archive_open(Archive *archive_out, const char *filename)
+{
+  memset(archive_out, 0, sizeof(Archive));
+  if (!membuf_map_file(&archive_out->file, filename, 0))
+  {
+    return false;
+  }
+
+  if (!validate(archive_out))
+  {
+    MIUR_LOG_ERR("'%s' is not a valid archive", filename);
+    membuf_destroy(&archive_out->file);
+    return false;
+  }
+  return true;
+}
+
+void archive_close(Archive *archive)
+{
+  membuf_destroy(&archive->file);
+  memset(archive, 0, sizeof(Archive));
+}
+
+const ArchiveEntry *archive_find_entry(const Archive *archive,
+                                       const char *name, size_t name_size)
+{
+  uint64_t hash = archive_hash_name(name, name_size);
+  uint32_t mask = archive->header->bucket_count - 1;
+
+  for (uint32_t slot = (uint32_t) hash & mask;; slot = (slot + 1) & mask)
+  {
+    uint32_t index = archive->buckets[slot];
+    if (index == ARCHIVE_EMPTY_BUCKET)
+    {
+      return NULL;
+    }
+
+    const ArchiveEntry *entry = &archive->entries[index];
+    if (entry->hash == hash && entry->name_size == name_size &&
+        names_equal(archive->names + entry->name_offset, name, name_size))
+    {
+      return entry;
+    }
+  }
+}
+
+bool archive_read(const Archive *archive, const ArchiveEntry *entry,
+                  void *dst, JobSystem *jobs)
+{
+  const uint8_t *blob = archive->file.data + entry->offset;
+  if (!(entry->flags & ARCHIVE_ENTRY_COMPRESSED))
+  {
+    memcpy(dst, blob, (size_t) entry->size);
+    return true;
+  }
+
+  uint32_t count = block_count(entry);
+  uint64_t *offsets = MIUR_ARR(uint64_t, count > 0 ? count : 1);
+  if (offsets == NULL)
+  {
+    return false;
+  }
+
+  const uint32_t *sizes = (const uint32_t *) blob;
+  uint64_t offset = sizeof(uint32_t) * (uint64_t) count;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    offsets[i] = offset;
+    offset += sizes[i] & ~ARCHIVE_BLOCK_RAW;
+  }
+
+  AtomicI32 failed = 0;
+  DecodeJob whole = {
+    .src = blob,
+    .block_sizes = sizes,
+    .block_offsets = offsets,
+    .dst = (uint8_t *) dst,
+    .size = entry->size,
+    .block_size = entry->block_size,
+    .first = 0,
+    .last = count,
+    .failed = &failed,
+  };
+
+  uint32_t job_count = 1;
+  if (jobs != NULL)
+  {
+    job_count = job_system_thread_count(jobs) * ARCHIVE_JOBS_PER_THREAD;
+    job_count = job_count < count ? job_count : count;
+  }
+
+  if (job_count <= 1)
+  {
+    decode_job(&whole);
+  }
+  else
+  {
+    DecodeJob *decodes = MIUR_ARR(DecodeJob, job_count);
+    Job *descs = MIUR_ARR(Job, job_count);
+    if (decodes == NULL || descs == NULL)
+    {
+      MIUR_FREE(decodes);
+      MIUR_FREE(descs);
+      decode_job(&whole);
+    }
+    else
+    {
+      JobCounter counter = {0};
+      for (uint32_t i = 0; i < job_count; i++)
+      {
+        decodes[i] = whole;
+        decodes[i].first = (uint32_t) ((uint64_t) count * i / job_count);
+        decodes[i].last =
+          (uint32_t) ((uint64_t) count * (i + 1) / job_count);
+        descs[i].function = decode_job;
+        descs[i].ud = &decodes[i];
+      }
+      job_run(jobs, descs, job_count, &counter);
+      job_wait(jobs, &counter);
+      MIUR_FREE(decodes);
+      MIUR_FREE(descs);
+    }
+  }
+
+  MIUR_FREE(offsets);
+  return atomic_i32_load(&failed) == 0;
+}
+
+bool archive_find(const Archive *archive, const char *name, size_t name_size,
+                  Membuf *out, JobSystem *jobs)
+{
+  const ArchiveEntry *entry = archive_find_entry(archive, name, name_size);
+  if (entry == NULL)
+  {
+    return false;
+  }
+
+  if (!(entry->flags & ARCHIVE_ENTRY_COMPRESSED))
+  {
+    out->data = archive->file.data + entry->offset;
+    out->size = (size_t) entry->size;
+    out->kind = MEMBUF_VIEW;
+    return true;
+  }
+
+  uint8_t *data = MIUR_ARR_UNINIT(uint8_t, entry->size > 0 ? entry->size : 1);
+  if (data == NULL)
+  {
+    return false;
+  }
+  if (!archive_read(archive, entry, data, jobs))
+  {
+    MIUR_LOG_ERR("Corrupt archive entry '%.*s'", (int) name_size, name);
+    MIUR_FREE(data);
+    return false;
+  }
+  out->data = data;
+  out->size = (size_t) entry->size;
+  out->kind = MEMBUF_HEAP;
+  return true;
+}
+
+bool archive_mount(const char *filename, const char *mount_point)
+{
+  if (mount_count == ARCHIVE_MAX_MOUNTS)
+  {
+    MIUR_LOG_ERR("Can't mount '%s', too many archives mounted", filename);
+    return false;
+  }
+
+  Mount *mount = &mounts[mount_count];
+  if (!archive_open(&mount->archive, filename))
+  {
+    return false;
+  }
+
+  mount->mount_point_size = strlen(mount_point);
+  mount->mount_point = MIUR_ARR(char, mount->mount_point_size + 1);
+  memcpy(mount->mount_point, mount_point, mount->mount_point_size);
+  mount_count++;
+  return true;
+}
+
+void archive_unmount_all(void)
+{
+  for (size_t i = 0; i < mount_count; i++)
+  {
+    archive_close(&mounts[i].archive);
+    MIUR_FREE(mounts[i].mount_point);
+  }
+  mount_count = 0;
+}
+
+void archive_set_job_system(JobSystem *jobs)
+{
+  mount_jobs = jobs;
+}
+
+bool archive_resolve(const char *path, Membuf *out)
+{
+  if (mount_count == 0)
+  {
+    return false;
+  }
+
+  size_t path_size = strlen(path);
+  for (size_t i = mount_count; i-- > 0;)
+  {
+    Mount *mount = &mounts[i];
+    size_t start = strip_prefix(path, path_size, mount->mount_point,
+                                mount->mount_point_size);
+    if (start == SIZE_MAX)
+    {
+      continue;
+    }
+    if (archive_find(&mount->archive, path + start, path_size - start, out,
+                     mount_jobs))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool archive_load_file(Membuf *out, const char *path)
+{
+  if (archive_resolve(path, out))
+  {
+    return true;
+  }
+  return membuf_load_file(out, path);
+}
+
+bool archive_map_file(Membuf *out, const char *path, MembufMapFlags flags)
+{
+  if (archive_resolve(path, out))
+  {
+    return true;
+  }
+  return membuf_map_file(out, path, flags);
+}
+
+uint64_t archive_hash_name(const char *name, size_t name_size)
+{
+  uint64_t hash = FNV64_OFFSET;
+  for (size_t i = 0; i < name_size; i++)
+  {
+    hash ^= (uint8_t) normalize(name[i]);
+    hash *= FNV64_PRIME;
+  }
+  return hash;
+}
+
+bool archive_write(const char *filename, const ArchiveInput *inputs,
+                   size_t count)
+{
+  if (count >= ARCHIVE_EMPTY_BUCKET / 2)
+  {
+    return false;
+  }
+
+  uint32_t bucket_count = 1;
+  while (bucket_count < count * 2)
+  {
+    bucket_count <<= 1;
+  }
+
+  ArchiveHeader header = {
+    .magic = ARCHIVE_MAGIC,
+    .version = ARCHIVE_VERSION,
+    .entry_count = (uint32_t) count,
+    .bucket_count = bucket_count,
+  };
+  uint32_t *buckets = MIUR_ARR(uint32_t, bucket_count);
+  ArchiveEntry *entries = MIUR_ARR(ArchiveEntry, count > 0 ? count : 1);
+  Membuf *blobs = MIUR_ARR(Membuf, count > 0 ? count : 1);
+  FILE *file = NULL;
+  bool result = false;
+
+  if (buckets == NULL || entries == NULL || blobs == NULL)
+  {
+    goto cleanup;
+  }
+  memset(buckets, 0xFF, sizeof(uint32_t) * bucket_count);
+
+  uint64_t names_size = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    names_size += strlen(inputs[i].name);
+  }
+  if (names_size > UINT32_MAX)
+  {
+    goto cleanup;
+  }
+
+  header.names_size = (uint32_t) names_size;
+  header.buckets_offset = sizeof(ArchiveHeader);
+  header.entries_offset = header.buckets_offset +
+    sizeof(uint32_t) * bucket_count;
+  header.names_offset = header.entries_offset + sizeof(ArchiveEntry) * count;
+
+  uint64_t offset = align_up(header.names_offset + names_size);
+  uint32_t name_offset = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    ArchiveEntry *entry = &entries[i];
+    entry->name_size = (uint32_t) strlen(inputs[i].name);
+    entry->name_offset = name_offset;
+    entry->hash = archive_hash_name(inputs[i].name, entry->name_size);
+    if (!compress_entry(&inputs[i], &blobs[i], &entry->flags))
+    {
+      MIUR_LOG_ERR("Out of memory compressing '%s'", inputs[i].name);
+      goto cleanup;
+    }
+    entry->offset = offset;
+    entry->size = inputs[i].data.size;
+    entry->stored_size = blobs[i].size;
+    if (entry->flags & ARCHIVE_ENTRY_COMPRESSED)
+    {
+      entry->block_size = ARCHIVE_BLOCK_SIZE;
+    }
+    name_offset += entry->name_size;
+    offset = align_up(offset + entry->stored_size);
+
+    uint32_t slot = (uint32_t) entry->hash & (bucket_count - 1);
+    while (buckets[slot] != ARCHIVE_EMPTY_BUCKET)
+    {
+      const ArchiveEntry *other = &entries[buckets[slot]];
+      if (other->hash == entry->hash && other->name_size == entry->name_size &&
+          names_equal(inputs[buckets[slot]].name, inputs[i].name,
+                      entry->name_size))
+      {
+        MIUR_LOG_ERR("Duplicate archive entry '%s'", inputs[i].name);
+        goto cleanup;
+      }
+      slot = (slot + 1) & (bucket_count - 1);
+    }
+    buckets[slot] = (uint32_t) i;
+  }
+  header.file_size = offset;
+
+  file = fopen(filename, "wb");
+  if (file == NULL)
+  {
+    MIUR_LOG_ERR("Can't open '%s' for writing", filename);
+    goto cleanup;
+  }
+
+  uint64_t pos = 0;
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+    fwrite(buckets, sizeof(uint32_t), bucket_count, file) == bucket_count &&
+    fwrite(entries, sizeof(ArchiveEntry), count, file) == count;
+  pos = header.names_offset;
+  for (size_t i = 0; ok && i < count; i++)
+  {
+    ok = fwrite(inputs[i].name, 1, entries[i].name_size, file) ==
+      entries[i].name_size;
+    pos += entries[i].name_size;
+  }
+  for (size_t i = 0; ok && i < count; i++)
+  {
+    ok = write_padding(file, &pos, entries[i].offset) &&
+      fwrite(blobs[i].data, 1, blobs[i].size, file) == blobs[i].size;
+    pos += blobs[i].size;
+  }
+  ok = ok && write_padding(file, &pos, header.file_size);
+
+  if (fclose(file) != 0 || !ok)
+  {
+    MIUR_LOG_ERR("Failed to write archive '%s'", filename);
+    goto cleanup;
+  }
+  result = true;
+
+cleanup:
+  for (size_t i = 0; blobs != NULL && i < count; i++)
+  {
+    if (blobs[i].data != NULL)
+    {
+      membuf_destroy(&blobs[i]);
+    }
+  }
+  MIUR_FREE(blobs);
+  MIUR_FREE(buckets);
+  MIUR_FREE(entries);
+  return result;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/*
+ * Checks every offset once at open time, lookups then trust the index.
+ */
+static bool validate(Archive *archive)
+{
+  const uint8_t *data = archive->file.data;
+  uint64_t size = archive->file.size;
+  if (size < sizeof(ArchiveHeader))
+  {
+    return false;
+  }
+
+  const ArchiveHeader *header = (const ArchiveHeader *) data;
+  if (memcmp(header->magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 ||
+      header->version != ARCHIVE_VERSION || header->file_size != size)
+  {
+    return false;
+  }
+
+  uint64_t bucket_count = header->bucket_count;
+  uint64_t entry_count = header->entry_count;
+  if (bucket_count == 0 || (bucket_count & (bucket_count - 1)) != 0 ||
+      bucket_count <= entry_count ||
+      header->buckets_offset % sizeof(uint32_t) != 0 ||
+      header->buckets_offset + bucket_count * sizeof(uint32_t) > size ||
+      header->entries_offset % sizeof(uint64_t) != 0 ||
+      header->entries_offset + entry_count * sizeof(ArchiveEntry) > size ||
+      header->names_offset + header->names_size > size)
+  {
+    return false;
+  }
+
+  archive->header = header;
+  archive->buckets = (const uint32_t *) (data + header->buckets_offset);
+  archive->entries = (const ArchiveEntry *) (data + header->entries_offset);
+  archive->names = (const char *) (data + header->names_offset);
+
+  for (uint64_t i = 0; i < bucket_count; i++)
+  {
+    if (archive->buckets[i] != ARCHIVE_EMPTY_BUCKET &&
+        archive->buckets[i] >= entry_count)
+    {
+      return false;
+    }
+  }
+  for (uint64_t i = 0; i < entry_count; i++)
+  {
+    const ArchiveEntry *entry = &archive->entries[i];
+    if (entry->offset > size || entry->stored_size > size - entry->offset ||
+        (uint64_t) entry->name_offset + entry->name_size > header->names_size)
+    {
+      return false;
+    }
+    if (entry->flags & ARCHIVE_ENTRY_COMPRESSED)
+    {
+      if (!validate_blocks(archive, entry))
+      {
+        return false;
+      }
+    }
+    else if (entry->size != entry->stored_size)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool validate_blocks(const Archive *archive, const ArchiveEntry *entry)
+{
+  if (entry->block_size == 0 || entry->block_size > ARCHIVE_BLOCK_RAW)
+  {
+    return false;
+  }
+
+  uint64_t count = block_count(entry);
+  if (count > entry->stored_size / sizeof(uint32_t) ||
+      entry->offset % sizeof(uint32_t) != 0)
+  {
+    return false;
+  }
+
+  const uint32_t *sizes =
+    (const uint32_t *) (archive->file.data + entry->offset);
+  uint64_t stored = sizeof(uint32_t) * count;
+  for (uint64_t i = 0; i < count; i++)
+  {
+    uint64_t block = entry->size - i * entry->block_size;
+    block = block < entry->block_size ? block : entry->block_size;
+    if ((sizes[i] & ARCHIVE_BLOCK_RAW) &&
+        (sizes[i] & ~ARCHIVE_BLOCK_RAW) != block)
+    {
+      return false;
+    }
+    stored += sizes[i] & ~ARCHIVE_BLOCK_RAW;
+  }
+  return stored <= entry->stored_size;
+}
+
+static uint32_t block_count(const ArchiveEntry *entry)
+{
+  return (uint32_t) ((entry->size + entry->block_size - 1) /
+                     entry->block_size);
+}
+
+static void decode_job(void *ud)
+{
+  DecodeJob *job = (DecodeJob *) ud;
+  if (!decode_blocks(job))
+  {
+    atomic_i32_store(job->failed, 1);
+  }
+}
+
+static bool decode_blocks(DecodeJob *job)
+{
+  for (uint32_t i = job->first; i < job->last; i++)
+  {
+    uint64_t start = (uint64_t) i * job->block_size;
+    size_t size = (size_t) (job->size - start < job->block_size ?
+                            job->size - start : job->block_size);
+    const uint8_t *src = job->src + job->block_offsets[i];
+    uint32_t stored = job->block_sizes[i];
+
+    if (stored & ARCHIVE_BLOCK_RAW)
+    {
+      memcpy(job->dst + start, src, size);
+    }
+    else if (!lz_decompress(src, stored, job->dst + start, size))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Produces the blob stored for an input, a view of the input itself unless
+ * compressing saves space.
+ */
+static bool compress_entry(const ArchiveInput *input, Membuf *blob_out,
+                           uint32_t *flags_out)
+{
+  const uint8_t *src = input->data.data;
+  size_t size = input->data.size;
+
+  *flags_out = 0;
+  blob_out->data = src;
+  blob_out->size = size;
+  blob_out->kind = MEMBUF_VIEW;
+  if (!input->compress || size == 0)
+  {
+    return true;
+  }
+
+  size_t count = (size + ARCHIVE_BLOCK_SIZE - 1) / ARCHIVE_BLOCK_SIZE;
+  size_t capacity = sizeof(uint32_t) * count +
+    lz_compress_bound(ARCHIVE_BLOCK_SIZE) * count;
+  uint8_t *blob = MIUR_ARR_UNINIT(uint8_t, capacity);
+  if (blob == NULL)
+  {
+    return false;
+  }
+
+  uint32_t *sizes = (uint32_t *) blob;
+  size_t stored = sizeof(uint32_t) * count;
+  for (size_t i = 0; i < count; i++)
+  {
+    size_t start = i * ARCHIVE_BLOCK_SIZE;
+    size_t block = size - start < ARCHIVE_BLOCK_SIZE ? size - start :
+      ARCHIVE_BLOCK_SIZE;
+    size_t compressed = lz_compress(src + start, block, blob + stored,
+                                    capacity - stored);
+    if (compressed == 0 || compressed * 16 > block * ARCHIVE_MIN_SAVING)
+    {
+      memcpy(blob + stored, src + start, block);
+      sizes[i] = (uint32_t) block | ARCHIVE_BLOCK_RAW;
+      stored += block;
+    }
+    else
+    {
+      sizes[i] = (uint32_t) compressed;
+      stored += compressed;
+    }
+  }
+
+  if (stored >= size)
+  {
+    MIUR_FREE(blob);
+    return true;
+  }
+
+  blob_out->data = blob;
+  blob_out->size = stored;
+  blob_out->kind = MEMBUF_HEAP;
+  *flags_out = ARCHIVE_ENTRY_COMPRESSED;
+  return true;
+}
+
+static bool names_equal(const char *a, const char *b, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+  {
+    if (normalize(a[i]) != normalize(b[i]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Returns where the name starts after `prefix` and any "./", or SIZE_MAX. */
+static size_t strip_prefix(const char *path, size_t path_size,
+                           const char *prefix, size_t prefix_size)
+{
+  if (path_size < prefix_size || !names_equal(path, prefix, prefix_size))
+  {
+    return SIZE_MAX;
+  }
+
+  size_t start = prefix_size;
+  while (path_size - start >= 2 && path[start] == '.' &&
+         normalize(path[start + 1]) == '/')
+  {
+    start += 2;
+  }
+  return start;
+}
+
+static char normalize(char c)
+{
+  return c == '\\' ? '/' : c;
+}
+
+static uint64_t align_up(uint64_t value)
+{
+  return (value + ARCHIVE_ALIGNMENT - 1) & ~(uint64_t) (ARCHIVE_ALIGNMENT - 1);
+}
+
+static bool write_padding(FILE *file, uint64_t *pos, uint64_t target)
+{
+  static const uint8_t zeros[ARCHIVE_ALIGNMENT];
+  while (*pos < target)
+  {
+    size_t size = target - *pos < ARCHIVE_ALIGNMENT ?
+      (size_t) (target - *pos) : ARCHIVE_ALIGNMENT;
+    if (fwrite(zeros, 1, size, file) != size)
+    {
+      return false;
+    }
+    *pos += size;
+  }
+  return true;
+}
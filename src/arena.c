@@ -0,0 +1,66 @@
+/* =====================
+ * src/arena.c
+ * 10/18/2026
+ * Bump allocator for short lived data.
+ * ====================
+ */
+
+#include <stdint.h>
+
+#include <miur/arena.h>
+#include <miur/mem.h>
+
+#define ARENA_ALIGN 16
+
+struct ArenaBlock
+{
+  ArenaBlock *next;
+  size_t used, size;
+  size_t pad; /* Keeps the header a multiple of ARENA_ALIGN on 64 bit. */
+  uint8_t data[];
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+void arena_create(Arena *arena_out, size_t block_size)
+{
+  arena_out->head = NULL;
+  arena_out->block_size = block_size == 0 ? ARENA_DEFAULT_BLOCK_SIZE :
+    block_size;
+}
+
+void arena_destroy(Arena *arena)
+{
+  ArenaBlock *block = arena->head;
+  while (block != NULL)
+  {
+    ArenaBlock *next = block->next;
+    MIUR_FREE(block);
+    block = next;
+  }
+  arena->head = NULL;
+}
+
+void *arena_alloc(Arena *arena, size_t size)
+{
+  size = (size + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1);
+
+  ArenaBlock *block = arena->head;
+  if (block == NULL || block->size - block->used < size)
+  {
+    size_t block_size = size > arena->block_size ? size : arena->block_size;
+    block = (ArenaBlock *) malloc(sizeof(ArenaBlock) + block_size);
+    if (block == NULL)
+    {
+      return NULL;
+    }
+    block->used = 0;
+    block->size = block_size;
+    block->next = arena->head;
+    arena->head = block;
+  }
+
+  void *ptr = block->data + block->used;
+  block->used += size;
+  return ptr;
+}
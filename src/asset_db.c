@@ -0,0 +1,528 @@
+/* =====================
+ * src/asset_db.c
+ * 10/18/2026
+ * Cooked asset database.
+ * ====================
+ */
+
+#include <string.h>
+
+#include <miur/asset_db.h>
+#include <miur/hash.h>
+#include <miur/log.h>
+#include <miur/mem.h>
+
+#define ASSET_DB_MIN_CAPACITY 64
+
+typedef struct
+{
+  const char *path;
+  uint64_t *hash;
+  bool failed;
+} HashFileTask;
+
+/* === PROTOTYPES === */
+
+static bool validate(AssetDb *db);
+static uint64_t name_key(const char *name);
+static uint32_t find_slot(const AssetDb *db, uint64_t key, const char *name);
+static bool make_owned(AssetDb *db);
+static bool grow_entries(AssetDb *db);
+static uint32_t add_string(AssetDb *db, const char *str, size_t size);
+static void hash_file_job(void *ud);
+static uint64_t align_up(uint64_t value);
+
+/* === PUBLIC FUNCTIONS === */
+
+bool asset_db_open(AssetDb *db_out, const char *filename)
+{
+  memset(db_out, 0, sizeof(AssetDb));
+  size_t filename_len = strlen(filename);
+  db_out->filename = MIUR_ARR(char, filename_len + 1);
+  if (db_out->filename == NULL)
+  {
+    return false;
+  }
+  memcpy(db_out->filename, filename, filename_len + 1);
+
+  /* Straight from disk, a database packed into an archive is stale. */
+  if (!membuf_map_file(&db_out->file, filename, MEMBUF_MAP_WILLNEED))
+  {
+    return true;
+  }
+  if (!validate(db_out))
+  {
+    MIUR_LOG_WARN("'%s' is not a valid asset database, starting empty",
+                  filename);
+    membuf_destroy(&db_out->file);
+    db_out->entries = NULL;
+    db_out->capacity = 0;
+    db_out->count = 0;
+    db_out->strings = NULL;
+    db_out->strings_size = 0;
+  }
+  return true;
+}
+
+void asset_db_close(AssetDb *db)
+{
+  if (db->owned)
+  {
+    MIUR_FREE(db->entries);
+    MIUR_FREE(db->strings);
+  }
+  membuf_destroy(&db->file);
+  MIUR_FREE(db->filename);
+  memset(db, 0, sizeof(AssetDb));
+}
+
+/*
+ * Strings are compacted on the way out, dropping the names and
+ * dependencies of entries that were recorded over.
+ */
+bool asset_db_save(AssetDb *db)
+{
+  if (!db->dirty)
+  {
+    return true;
+  }
+
+  uint64_t strings_size = 0;
+  for (uint32_t i = 0; i < db->capacity; i++)
+  {
+    const AssetDbEntry *entry = &db->entries[i];
+    if (entry->key == 0)
+    {
+      continue;
+    }
+    const char *name = asset_db_entry_name(db, entry);
+    strings_size += strlen(name) + 1 + entry->dependencies_size;
+  }
+  if (strings_size > UINT32_MAX)
+  {
+    MIUR_LOG_ERR("Asset database '%s' is too large", db->filename);
+    return false;
+  }
+
+  uint64_t entries_offset = align_up(sizeof(AssetDbHeader));
+  uint64_t strings_offset = entries_offset +
+    (uint64_t) db->capacity * sizeof(AssetDbEntry);
+  uint64_t file_size = strings_offset + strings_size;
+  uint8_t *data = MIUR_ARR(uint8_t, file_size);
+  if (data == NULL)
+  {
+    return false;
+  }
+
+  AssetDbHeader *header = (AssetDbHeader *) data;
+  memcpy(header->magic, ASSET_DB_MAGIC, sizeof(header->magic));
+  header->version = ASSET_DB_VERSION;
+  header->capacity = db->capacity;
+  header->count = db->count;
+  header->strings_size = (uint32_t) strings_size;
+  header->entries_offset = entries_offset;
+  header->strings_offset = strings_offset;
+  header->file_size = file_size;
+
+  AssetDbEntry *entries = (AssetDbEntry *) (data + entries_offset);
+  char *strings = (char *) (data + strings_offset);
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < db->capacity; i++)
+  {
+    const AssetDbEntry *entry = &db->entries[i];
+    if (entry->key == 0)
+    {
+      continue;
+    }
+    entries[i] = *entry;
+
+    const char *name = asset_db_entry_name(db, entry);
+    size_t size = strlen(name) + 1;
+    memcpy(strings + offset, name, size);
+    entries[i].name_offset = offset;
+    offset += (uint32_t) size;
+
+    entries[i].dependencies_offset = offset;
+    memcpy(strings + offset, db->strings + entry->dependencies_offset,
+           entry->dependencies_size);
+    offset += entry->dependencies_size;
+  }
+
+  Membuf file = { .data = data, .size = file_size, .kind = MEMBUF_HEAP };
+  bool result = membuf_replace_file(file, db->filename);
+  if (result)
+  {
+    db->dirty = false;
+  }
+  else
+  {
+    MIUR_LOG_ERR("Couldn't write asset database '%s'", db->filename);
+  }
+  MIUR_FREE(data);
+  return result;
+}
+
+const AssetDbEntry *asset_db_find(const AssetDb *db, const char *name)
+{
+  if (db->capacity == 0)
+  {
+    return NULL;
+  }
+  uint32_t slot = find_slot(db, name_key(name), name);
+  return db->entries[slot].key != 0 ? &db->entries[slot] : NULL;
+}
+
+const char *asset_db_entry_name(const AssetDb *db,
+                                const AssetDbEntry *entry)
+{
+  return db->strings + entry->name_offset;
+}
+
+const char *asset_db_next_dependency(const AssetDb *db,
+                                     const AssetDbEntry *entry,
+                                     const char *prev)
+{
+  const char *start = db->strings + entry->dependencies_offset;
+  const char *end = start + entry->dependencies_size;
+  const char *next = prev == NULL ? start : prev + strlen(prev) + 1;
+  return next < end ? next : NULL;
+}
+
+bool asset_db_record(AssetDb *db, const char *name, uint64_t input_hash,
+                     const char *const *dependencies, size_t dependency_count,
+                     uint32_t cook_time_us)
+{
+  if (!make_owned(db) || !grow_entries(db))
+  {
+    return false;
+  }
+
+  uint64_t key = name_key(name);
+  uint32_t slot = find_slot(db, key, name);
+  AssetDbEntry entry = db->entries[slot];
+  if (entry.key == 0)
+  {
+    uint32_t name_offset = add_string(db, name, strlen(name) + 1);
+    if (name_offset == UINT32_MAX)
+    {
+      return false;
+    }
+    entry.key = key;
+    entry.name_offset = name_offset;
+  }
+
+  /* The dependencies go back to back, the first offset is the entry's. */
+  entry.dependencies_offset = db->strings_size;
+  for (size_t i = 0; i < dependency_count; i++)
+  {
+    const char *dep = dependencies[i];
+    if (add_string(db, dep, strlen(dep) + 1) == UINT32_MAX)
+    {
+      return false;
+    }
+  }
+  entry.dependencies_size = db->strings_size - entry.dependencies_offset;
+  entry.dependency_count = (uint32_t) dependency_count;
+  entry.input_hash = input_hash;
+  entry.cook_time_us = cook_time_us;
+
+  if (db->entries[slot].key == 0)
+  {
+    db->count++;
+  }
+  db->entries[slot] = entry;
+  db->dirty = true;
+  return true;
+}
+
+bool asset_db_hash_files(JobSystem *jobs, const char *const *paths,
+                         size_t count, uint64_t *hashes_out)
+{
+  if (count == 0)
+  {
+    return true;
+  }
+  HashFileTask *tasks = MIUR_ARR(HashFileTask, count);
+  Job *desc = MIUR_ARR(Job, count);
+  if (tasks == NULL || desc == NULL)
+  {
+    MIUR_FREE(tasks);
+    MIUR_FREE(desc);
+    return false;
+  }
+
+  for (size_t i = 0; i < count; i++)
+  {
+    tasks[i].path = paths[i];
+    tasks[i].hash = &hashes_out[i];
+    desc[i].function = hash_file_job;
+    desc[i].ud = &tasks[i];
+  }
+  if (jobs != NULL)
+  {
+    JobCounter counter = { 0 };
+    job_run(jobs, desc, count, &counter);
+    job_wait(jobs, &counter);
+  }
+  else
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      hash_file_job(&tasks[i]);
+    }
+  }
+
+  bool result = true;
+  for (size_t i = 0; i < count; i++)
+  {
+    result = result && !tasks[i].failed;
+  }
+  MIUR_FREE(tasks);
+  MIUR_FREE(desc);
+  return result;
+}
+
+uint64_t asset_db_input_hash(const char *const *paths,
+                             const uint64_t *hashes, size_t count,
+                             uint64_t seed)
+{
+  HashStream stream;
+  hash_stream_init(&stream, seed);
+  for (size_t i = 0; i < count; i++)
+  {
+    hash_stream_update(&stream, paths[i], strlen(paths[i]) + 1);
+    hash_stream_update(&stream, &hashes[i], sizeof(hashes[i]));
+  }
+  return hash_stream_digest(&stream);
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/*
+ * Bounds every offset once so lookups can trust the mapping, the strings
+ * must end in a NUL so walking them never leaves it.
+ */
+static bool validate(AssetDb *db)
+{
+  const uint8_t *data = db->file.data;
+  size_t size = db->file.size;
+
+  if (size < sizeof(AssetDbHeader))
+  {
+    return false;
+  }
+  const AssetDbHeader *header = (const AssetDbHeader *) data;
+  if (memcmp(header->magic, ASSET_DB_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != ASSET_DB_VERSION || header->file_size != size)
+  {
+    return false;
+  }
+  if (header->capacity == 0 ||
+      (header->capacity & (header->capacity - 1)) != 0 ||
+      header->count >= header->capacity ||
+      header->entries_offset % sizeof(uint64_t) != 0 ||
+      header->entries_offset > size ||
+      (size - header->entries_offset) / sizeof(AssetDbEntry) <
+      header->capacity ||
+      header->strings_offset > size ||
+      size - header->strings_offset < header->strings_size)
+  {
+    return false;
+  }
+
+  const char *strings = (const char *) (data + header->strings_offset);
+  if (header->strings_size > 0 && strings[header->strings_size - 1] != 0)
+  {
+    return false;
+  }
+
+  const AssetDbEntry *entries =
+    (const AssetDbEntry *) (data + header->entries_offset);
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < header->capacity; i++)
+  {
+    const AssetDbEntry *entry = &entries[i];
+    if (entry->key == 0)
+    {
+      continue;
+    }
+    if (entry->name_offset >= header->strings_size ||
+        entry->key != name_key(strings + entry->name_offset))
+    {
+      return false;
+    }
+    uint32_t deps_end = entry->dependencies_offset +
+      entry->dependencies_size;
+    if (entry->dependencies_offset > header->strings_size ||
+        header->strings_size - entry->dependencies_offset <
+        entry->dependencies_size ||
+        (entry->dependencies_size > 0 && strings[deps_end - 1] != 0))
+    {
+      return false;
+    }
+    count++;
+  }
+  if (count != header->count)
+  {
+    return false;
+  }
+
+  /* The file is read only, entries are copied before they're written. */
+  db->entries = (AssetDbEntry *) entries;
+  db->capacity = header->capacity;
+  db->count = header->count;
+  db->strings = (char *) strings;
+  db->strings_size = header->strings_size;
+  return true;
+}
+
+static uint64_t name_key(const char *name)
+{
+  uint64_t key = hash3(name, strlen(name), 0);
+  return key != 0 ? key : 1;
+}
+
+/* The slot holding `name`, or the empty slot it would go in. */
+static uint32_t find_slot(const AssetDb *db, uint64_t key, const char *name)
+{
+  uint32_t mask = db->capacity - 1;
+  uint32_t slot = (uint32_t) key & mask;
+  while (db->entries[slot].key != 0)
+  {
+    const AssetDbEntry *entry = &db->entries[slot];
+    if (entry->key == key &&
+        strcmp(db->strings + entry->name_offset, name) == 0)
+    {
+      break;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+static bool make_owned(AssetDb *db)
+{
+  if (db->owned)
+  {
+    return true;
+  }
+
+  uint32_t capacity = db->capacity > 0 ? db->capacity :
+    ASSET_DB_MIN_CAPACITY;
+  uint32_t strings_capacity = db->strings_size > 0 ? db->strings_size : 1;
+  AssetDbEntry *entries = MIUR_ARR(AssetDbEntry, capacity);
+  char *strings = MIUR_ARR_UNINIT(char, strings_capacity);
+  if (entries == NULL || strings == NULL)
+  {
+    MIUR_FREE(entries);
+    MIUR_FREE(strings);
+    return false;
+  }
+  if (db->capacity > 0)
+  {
+    memcpy(entries, db->entries, sizeof(AssetDbEntry) * capacity);
+    memcpy(strings, db->strings, db->strings_size);
+  }
+
+  membuf_destroy(&db->file);
+  db->entries = entries;
+  db->capacity = capacity;
+  db->strings = strings;
+  db->strings_capacity = strings_capacity;
+  db->owned = true;
+  return true;
+}
+
+/* Keeps the table under three quarters full, for one more entry. */
+static bool grow_entries(AssetDb *db)
+{
+  if ((uint64_t) (db->count + 1) * 4 <= (uint64_t) db->capacity * 3)
+  {
+    return true;
+  }
+  if (db->capacity > UINT32_MAX / 2)
+  {
+    return false;
+  }
+
+  uint32_t old_capacity = db->capacity;
+  AssetDbEntry *old_entries = db->entries;
+  AssetDbEntry *entries = MIUR_ARR(AssetDbEntry, (size_t) old_capacity * 2);
+  if (entries == NULL)
+  {
+    return false;
+  }
+  db->entries = entries;
+  db->capacity = old_capacity * 2;
+
+  uint32_t mask = db->capacity - 1;
+  for (uint32_t i = 0; i < old_capacity; i++)
+  {
+    if (old_entries[i].key == 0)
+    {
+      continue;
+    }
+    uint32_t slot = (uint32_t) old_entries[i].key & mask;
+    while (entries[slot].key != 0)
+    {
+      slot = (slot + 1) & mask;
+    }
+    entries[slot] = old_entries[i];
+  }
+  MIUR_FREE(old_entries);
+  return true;
+}
+
+/* Returns the string's offset, or UINT32_MAX if it doesn't fit. */
+static uint32_t add_string(AssetDb *db, const char *str, size_t size)
+{
+  if (size >= UINT32_MAX - db->strings_size)
+  {
+    return UINT32_MAX;
+  }
+  uint32_t needed = db->strings_size + (uint32_t) size;
+  if (needed > db->strings_capacity)
+  {
+    uint64_t capacity = (uint64_t) db->strings_capacity * 2;
+    if (capacity < needed)
+    {
+      capacity = needed;
+    }
+    if (capacity > UINT32_MAX)
+    {
+      capacity = UINT32_MAX;
+    }
+    char *strings = MIUR_REALLOC(char, db->strings, capacity);
+    if (strings == NULL)
+    {
+      return UINT32_MAX;
+    }
+    db->strings = strings;
+    db->strings_capacity = (uint32_t) capacity;
+  }
+
+  uint32_t offset = db->strings_size;
+  memcpy(db->strings + offset, str, size);
+  db->strings_size = needed;
+  return offset;
+}
+
+static void hash_file_job(void *ud)
+{
+  HashFileTask *task = (HashFileTask *) ud;
+  Membuf file;
+  if (!membuf_map_file(&file, task->path, MEMBUF_MAP_SEQUENTIAL))
+  {
+    *task->hash = 0;
+    task->failed = true;
+    return;
+  }
+  *task->hash = hash3(file.data, file.size, 0);
+  membuf_destroy(&file);
+}
+
+static uint64_t align_up(uint64_t value)
+{
+  uint64_t mask = ASSET_DB_ALIGNMENT - 1;
+  return (value + mask) & ~mask;
+}
@@ -0,0 +1,479 @@
+/* =====================
+ * src/asset_stream.c
+ * 10/18/2026
+ * Prioritized background loading of models into the renderer.
+ * ====================
+ */
+
+#include <inttypes.h>
+#include <string.h>
+
+#include <miur/asset_stream.h>
+#include <miur/gltf.h>
+#include <miur/log.h>
+#include <miur/mem.h>
+#include <miur/mesh_opt.h>
+#include <miur/texture_compress.h>
+
+#define STREAM_MIN_CAPACITY 16
+
+struct StreamAsset
+{
+  char *filename;
+  int32_t priority;
+  StreamState state;
+
+  StaticModel model;
+  GLTFLoad *load;
+
+  /*
+   * One per mesh, then one per image of the model, the first upload_count
+   * have been submitted.
+   */
+  RendererUpload *uploads;
+  uint32_t upload_count;
+  uint32_t uploads_done;
+  GPUTexture *textures;    /* One per image, empty for failed ones. */
+
+  uint64_t bytes;          /* Charged against the budget while in flight. */
+  uint64_t request_time;
+};
+
+struct AssetStreamer
+{
+  Renderer *render;
+  JobSystem *jobs;
+  IoService *io;
+  AssetStreamerDesc desc;
+
+  StreamAsset **assets;
+  uint32_t asset_count;
+  uint32_t asset_capacity;
+
+  uint64_t bytes_in_flight;
+  uint64_t last_time_to_ready;
+  uint64_t max_time_to_ready;
+};
+
+/* === PROTOTYPES === */
+
+static void finish_loads(AssetStreamer *streamer);
+static void start_uploads(AssetStreamer *streamer);
+static void finish_uploads(AssetStreamer *streamer);
+static void start_loads(AssetStreamer *streamer);
+static StreamAsset *highest_priority(AssetStreamer *streamer,
+                                     StreamState state, bool need_upload);
+static uint32_t upload_total(const StreamAsset *asset);
+static uint64_t upload_bytes(const StreamAsset *asset, uint32_t upload);
+static bool upload_texture(Renderer *render, const Texture *image,
+                           GPUTexture *gpu_out, RendererUpload *upload_out);
+static uint64_t model_bytes(const StaticModel *model);
+static uint64_t mesh_bytes(const StaticMesh *mesh);
+static void fail_asset(AssetStreamer *streamer, StreamAsset *asset);
+static void release_model(AssetStreamer *streamer, StreamAsset *asset);
+
+/* === PUBLIC FUNCTIONS === */
+
+AssetStreamer *asset_streamer_create(Renderer *render, JobSystem *jobs,
+                                     IoService *io,
+                                     const AssetStreamerDesc *desc)
+{
+  AssetStreamer *streamer = MIUR_NEW(AssetStreamer);
+  if (streamer == NULL)
+  {
+    return NULL;
+  }
+  streamer->render = render;
+  streamer->jobs = jobs;
+  streamer->io = io;
+  streamer->desc = *desc;
+  if (streamer->desc.byte_budget == 0)
+  {
+    streamer->desc.byte_budget = ASSET_STREAM_DEFAULT_BUDGET;
+  }
+  if (streamer->desc.load_estimate == 0)
+  {
+    streamer->desc.load_estimate = ASSET_STREAM_DEFAULT_ESTIMATE;
+  }
+  if (streamer->desc.upload_bytes_per_frame == 0)
+  {
+    streamer->desc.upload_bytes_per_frame = ASSET_STREAM_DEFAULT_UPLOAD_BYTES;
+  }
+  return streamer;
+}
+
+void asset_streamer_destroy(AssetStreamer *streamer)
+{
+  for (uint32_t i = 0; i < streamer->asset_count; i++)
+  {
+    StreamAsset *asset = streamer->assets[i];
+    if (asset->state == STREAM_LOADING)
+    {
+      if (gltf_load_wait(asset->load))
+      {
+        gltf_model_destroy(&asset->model);
+      }
+    } else if (asset->state == STREAM_UPLOADING ||
+               asset->state == STREAM_READY)
+    {
+      release_model(streamer, asset);
+    }
+    MIUR_FREE(asset->uploads);
+    MIUR_FREE(asset->textures);
+    MIUR_FREE(asset->filename);
+    MIUR_FREE(asset);
+  }
+  MIUR_FREE(streamer->assets);
+  MIUR_FREE(streamer);
+}
+
+StreamAsset *asset_streamer_request(AssetStreamer *streamer,
+                                    const char *filename, int32_t priority)
+{
+  if (streamer->asset_count == streamer->asset_capacity)
+  {
+    uint32_t capacity = streamer->asset_capacity > 0 ?
+      streamer->asset_capacity * 2 : STREAM_MIN_CAPACITY;
+    StreamAsset **assets = MIUR_REALLOC(StreamAsset *, streamer->assets,
+                                        capacity);
+    if (assets == NULL)
+    {
+      return NULL;
+    }
+    streamer->assets = assets;
+    streamer->asset_capacity = capacity;
+  }
+
+  StreamAsset *asset = MIUR_NEW(StreamAsset);
+  if (asset == NULL)
+  {
+    return NULL;
+  }
+  size_t length = strlen(filename);
+  asset->filename = MIUR_ARR(char, length + 1);
+  if (asset->filename == NULL)
+  {
+    MIUR_FREE(asset);
+    return NULL;
+  }
+  memcpy(asset->filename, filename, length);
+  asset->priority = priority;
+  asset->state = STREAM_QUEUED;
+  asset->request_time = thread_time_ns();
+  streamer->assets[streamer->asset_count++] = asset;
+  return asset;
+}
+
+void asset_streamer_set_priority(AssetStreamer *streamer, StreamAsset *asset,
+                                 int32_t priority)
+{
+  (void) streamer;
+  asset->priority = priority;
+}
+
+void asset_streamer_update(AssetStreamer *streamer)
+{
+  /*
+   * Retire finished work first so its bytes are back in the budget before
+   * anything new starts.
+   */
+  finish_uploads(streamer);
+  finish_loads(streamer);
+  start_uploads(streamer);
+  start_loads(streamer);
+}
+
+void asset_streamer_stats(const AssetStreamer *streamer,
+                          AssetStreamerStats *stats_out)
+{
+  memset(stats_out, 0, sizeof(*stats_out));
+  for (uint32_t i = 0; i < streamer->asset_count; i++)
+  {
+    switch (streamer->assets[i]->state)
+    {
+    case STREAM_QUEUED:
+      stats_out->queued++;
+      break;
+    case STREAM_LOADING:
+      stats_out->loading++;
+      break;
+    case STREAM_UPLOADING:
+      stats_out->uploading++;
+      break;
+    case STREAM_READY:
+      stats_out->ready++;
+      break;
+    case STREAM_FAILED:
+      stats_out->failed++;
+      break;
+    }
+  }
+  stats_out->bytes_in_flight = streamer->bytes_in_flight;
+  stats_out->last_time_to_ready = streamer->last_time_to_ready;
+  stats_out->max_time_to_ready = streamer->max_time_to_ready;
+}
+
+StreamState stream_asset_state(const StreamAsset *asset)
+{
+  return asset->state;
+}
+
+StaticModel *stream_asset_model(StreamAsset *asset)
+{
+  return asset->state == STREAM_READY ? &asset->model : NULL;
+}
+
+const GPUTexture *stream_asset_textures(const StreamAsset *asset)
+{
+  return asset->state == STREAM_READY ? asset->textures : NULL;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void finish_loads(AssetStreamer *streamer)
+{
+  for (uint32_t i = 0; i < streamer->asset_count; i++)
+  {
+    StreamAsset *asset = streamer->assets[i];
+    if (asset->state != STREAM_LOADING || !gltf_load_done(asset->load))
+    {
+      continue;
+    }
+
+    /* Already done, so this only frees the load. */
+    bool loaded = gltf_load_wait(asset->load);
+    asset->load = NULL;
+    streamer->bytes_in_flight -= asset->bytes;
+    if (!loaded)
+    {
+      MIUR_LOG_ERR("Failed to stream '%s'", asset->filename);
+      asset->bytes = 0;
+      asset->state = STREAM_FAILED;
+      continue;
+    }
+
+    asset->uploads = MIUR_ARR(RendererUpload, upload_total(asset));
+    asset->textures = MIUR_ARR(GPUTexture, asset->model.image_count);
+    if ((asset->uploads == NULL && upload_total(asset) > 0) ||
+        (asset->textures == NULL && asset->model.image_count > 0))
+    {
+      /* asset_streamer_destroy frees whichever array was allocated. */
+      gltf_model_destroy(&asset->model);
+      asset->bytes = 0;
+      asset->state = STREAM_FAILED;
+      continue;
+    }
+    asset->bytes = model_bytes(&asset->model);
+    streamer->bytes_in_flight += asset->bytes;
+    asset->state = STREAM_UPLOADING;
+  }
+}
+
+static void start_uploads(AssetStreamer *streamer)
+{
+  uint64_t frame_bytes = 0;
+  StreamAsset *asset;
+  while (frame_bytes < streamer->desc.upload_bytes_per_frame &&
+         (asset = highest_priority(streamer, STREAM_UPLOADING, true)) != NULL)
+  {
+    uint32_t upload = asset->upload_count;
+    uint32_t mesh_count = asset->model.mesh_count;
+    uint64_t bytes = upload_bytes(asset, upload);
+    /* Leave the upload for the next frame unless it's the first one. */
+    if (frame_bytes > 0 &&
+        frame_bytes + bytes > streamer->desc.upload_bytes_per_frame)
+    {
+      break;
+    }
+    bool submitted = upload < mesh_count ?
+      renderer_upload_static_mesh(streamer->render,
+                                  &asset->model.meshes[upload],
+                                  &asset->uploads[upload]) :
+      upload_texture(streamer->render,
+                     &asset->model.images[upload - mesh_count],
+                     &asset->textures[upload - mesh_count],
+                     &asset->uploads[upload]);
+    if (!submitted)
+    {
+      MIUR_LOG_ERR("Failed to upload '%s'", asset->filename);
+      fail_asset(streamer, asset);
+      continue;
+    }
+    asset->upload_count++;
+    frame_bytes += bytes;
+  }
+}
+
+static void finish_uploads(AssetStreamer *streamer)
+{
+  for (uint32_t i = 0; i < streamer->asset_count; i++)
+  {
+    StreamAsset *asset = streamer->assets[i];
+    if (asset->state != STREAM_UPLOADING)
+    {
+      continue;
+    }
+    /* Copies finish in submission order, stop at the first pending one. */
+    while (asset->uploads_done < asset->upload_count &&
+           renderer_upload_poll(streamer->render,
+                                &asset->uploads[asset->uploads_done]))
+    {
+      asset->uploads_done++;
+    }
+    if (asset->uploads_done < upload_total(asset))
+    {
+      continue;
+    }
+
+    uint64_t elapsed = thread_time_ns() - asset->request_time;
+    streamer->last_time_to_ready = elapsed;
+    if (elapsed > streamer->max_time_to_ready)
+    {
+      streamer->max_time_to_ready = elapsed;
+    }
+    streamer->bytes_in_flight -= asset->bytes;
+    asset->state = STREAM_READY;
+    MIUR_LOG_INFO("Streamed '%s', %" PRIu64 " bytes in %.2f ms",
+                  asset->filename, asset->bytes, elapsed / 1e6);
+  }
+}
+
+static void start_loads(AssetStreamer *streamer)
+{
+  StreamAsset *asset;
+  while ((asset = highest_priority(streamer, STREAM_QUEUED, false)) != NULL)
+  {
+    uint64_t estimate = streamer->desc.load_estimate;
+    if (streamer->bytes_in_flight > 0 &&
+        streamer->bytes_in_flight + estimate > streamer->desc.byte_budget)
+    {
+      break;
+    }
+
+    asset->load = gltf_load_async(&asset->model, asset->filename,
+                                  streamer->jobs, streamer->io);
+    if (asset->load == NULL)
+    {
+      MIUR_LOG_ERR("Failed to stream '%s'", asset->filename);
+      asset->state = STREAM_FAILED;
+      continue;
+    }
+    asset->bytes = estimate;
+    streamer->bytes_in_flight += estimate;
+    asset->state = STREAM_LOADING;
+  }
+}
+
+/*
+ * A linear scan, the number of outstanding requests stays small next to
+ * the cost of loading any of them.
+ */
+static StreamAsset *highest_priority(AssetStreamer *streamer,
+                                     StreamState state, bool need_upload)
+{
+  StreamAsset *best = NULL;
+  for (uint32_t i = 0; i < streamer->asset_count; i++)
+  {
+    StreamAsset *asset = streamer->assets[i];
+    if (asset->state != state ||
+        (need_upload && asset->upload_count == upload_total(asset)))
+    {
+      continue;
+    }
+    if (best == NULL || asset->priority > best->priority)
+    {
+      best = asset;
+    }
+  }
+  return best;
+}
+
+static uint32_t upload_total(const StreamAsset *asset)
+{
+  return asset->model.mesh_count + asset->model.image_count;
+}
+
+static uint64_t upload_bytes(const StreamAsset *asset, uint32_t upload)
+{
+  const StaticModel *model = &asset->model;
+  return upload < model->mesh_count ? mesh_bytes(&model->meshes[upload]) :
+    model->images[upload - model->mesh_count].size;
+}
+
+/*
+ * Images that failed to decode are left empty and upload nothing, BC ones
+ * the device can't sample are decompressed first.
+ */
+static bool upload_texture(Renderer *render, const Texture *image,
+                           GPUTexture *gpu_out, RendererUpload *upload_out)
+{
+  memset(gpu_out, 0, sizeof(*gpu_out));
+  memset(upload_out, 0, sizeof(*upload_out));
+  if (image->data == NULL)
+  {
+    return true;
+  }
+  if (renderer_can_sample(render, image->format))
+  {
+    return renderer_upload_texture(render, image, gpu_out, upload_out);
+  }
+
+  Texture rgba;
+  if (!texture_decompress(&rgba, image))
+  {
+    return false;
+  }
+  bool result = renderer_upload_texture(render, &rgba, gpu_out, upload_out);
+  texture_destroy(&rgba);
+  return result;
+}
+
+static uint64_t model_bytes(const StaticModel *model)
+{
+  uint64_t bytes = 0;
+  for (uint32_t i = 0; i < model->mesh_count; i++)
+  {
+    bytes += mesh_bytes(&model->meshes[i]);
+  }
+  for (uint32_t i = 0; i < model->image_count; i++)
+  {
+    bytes += model->images[i].size;
+  }
+  return bytes;
+}
+
+/* What a mesh stages at most, before the technique's format narrows it. */
+static uint64_t mesh_bytes(const StaticMesh *mesh)
+{
+  return (uint64_t) mesh->vert_count * 8 * sizeof(float) +
+    (uint64_t) static_mesh_index_total(mesh) * sizeof(uint32_t);
+}
+
+static void fail_asset(AssetStreamer *streamer, StreamAsset *asset)
+{
+  release_model(streamer, asset);
+  streamer->bytes_in_flight -= asset->bytes;
+  asset->bytes = 0;
+  asset->state = STREAM_FAILED;
+}
+
+/* Waits out any copies still reading the model, then frees it. */
+static void release_model(AssetStreamer *streamer, StreamAsset *asset)
+{
+  uint32_t mesh_count = asset->model.mesh_count;
+  for (uint32_t i = 0; i < asset->upload_count; i++)
+  {
+    renderer_upload_wait(streamer->render, &asset->uploads[i]);
+    if (i < mesh_count)
+    {
+      renderer_deinit_static_mesh(streamer->render, &asset->model.meshes[i]);
+    } else
+    {
+      renderer_deinit_texture(streamer->render,
+                              &asset->textures[i - mesh_count]);
+    }
+  }
+  asset->upload_count = 0;
+  asset->uploads_done = 0;
+  gltf_model_destroy(&asset->model);
+}
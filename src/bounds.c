@@ -0,0 +1,169 @@
+/* =====================
+ * src/bounds.c
+ * 10/18/2026
+ * Bounding boxes and spheres.
+ * ====================
+ */
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include <miur/bounds.h>
+#include <miur/simd.h>
+
+/* === PUBLIC FUNCTIONS === */
+
+void aabb_empty(Aabb *out)
+{
+  for (int c = 0; c < 3; c++)
+  {
+    out->min[c] = FLT_MAX;
+    out->max[c] = -FLT_MAX;
+  }
+}
+
+bool aabb_is_empty(const Aabb *box)
+{
+  return box->min[0] > box->max[0] || box->min[1] > box->max[1] ||
+    box->min[2] > box->max[2];
+}
+
+void aabb_from_points(Aabb *out, const float *positions, size_t count)
+{
+  aabb_empty(out);
+  for (size_t i = 0; i < count; i++)
+  {
+    for (int c = 0; c < 3; c++)
+    {
+      float value = positions[i * 3 + c];
+      out->min[c] = value < out->min[c] ? value : out->min[c];
+      out->max[c] = value > out->max[c] ? value : out->max[c];
+    }
+  }
+}
+
+void aabb_union(Aabb *out, const Aabb *a, const Aabb *b)
+{
+  for (int c = 0; c < 3; c++)
+  {
+    out->min[c] = a->min[c] < b->min[c] ? a->min[c] : b->min[c];
+    out->max[c] = a->max[c] > b->max[c] ? a->max[c] : b->max[c];
+  }
+}
+
+/*
+ * Moves the center by the whole matrix and the half extent by the absolute
+ * value of its linear part, the same as transforming all eight corners.
+ */
+void aabb_transform(Aabb *out, const Aabb *box, const float *matrix)
+{
+  if (aabb_is_empty(box))
+  {
+    aabb_empty(out);
+    return;
+  }
+
+  float center[3], extent[3];
+  for (int c = 0; c < 3; c++)
+  {
+    center[c] = (box->min[c] + box->max[c]) * 0.5f;
+    extent[c] = (box->max[c] - box->min[c]) * 0.5f;
+  }
+
+#ifdef MIUR_HAVE_SSE2
+  __m128 sign = _mm_set1_ps(-0.0f);
+  __m128 col0 = _mm_loadu_ps(&matrix[0]);
+  __m128 col1 = _mm_loadu_ps(&matrix[4]);
+  __m128 col2 = _mm_loadu_ps(&matrix[8]);
+  __m128 col3 = _mm_loadu_ps(&matrix[12]);
+  __m128 c = _mm_add_ps(col3, _mm_mul_ps(col0, _mm_set1_ps(center[0])));
+  c = _mm_add_ps(c, _mm_mul_ps(col1, _mm_set1_ps(center[1])));
+  c = _mm_add_ps(c, _mm_mul_ps(col2, _mm_set1_ps(center[2])));
+  __m128 e = _mm_mul_ps(_mm_andnot_ps(sign, col0), _mm_set1_ps(extent[0]));
+  e = _mm_add_ps(e, _mm_mul_ps(_mm_andnot_ps(sign, col1),
+                               _mm_set1_ps(extent[1])));
+  e = _mm_add_ps(e, _mm_mul_ps(_mm_andnot_ps(sign, col2),
+                               _mm_set1_ps(extent[2])));
+  float lo[4], hi[4];
+  _mm_storeu_ps(lo, _mm_sub_ps(c, e));
+  _mm_storeu_ps(hi, _mm_add_ps(c, e));
+  memcpy(out->min, lo, sizeof(out->min));
+  memcpy(out->max, hi, sizeof(out->max));
+#else
+  for (int r = 0; r < 3; r++)
+  {
+    float c = matrix[12 + r];
+    float e = 0.0f;
+    for (int k = 0; k < 3; k++)
+    {
+      c += matrix[k * 4 + r] * center[k];
+      e += fabsf(matrix[k * 4 + r]) * extent[k];
+    }
+    out->min[r] = c - e;
+    out->max[r] = c + e;
+  }
+#endif
+}
+
+void sphere_from_points(BoundingSphere *out, const float *positions,
+                        size_t count)
+{
+  memset(out, 0, sizeof(*out));
+  if (count == 0)
+  {
+    return;
+  }
+
+  /* Start from the pair of axis extremes that lie furthest apart. */
+  size_t lo[3] = { 0, 0, 0 }, hi[3] = { 0, 0, 0 };
+  for (size_t i = 1; i < count; i++)
+  {
+    const float *p = &positions[i * 3];
+    for (int c = 0; c < 3; c++)
+    {
+      lo[c] = p[c] < positions[lo[c] * 3 + c] ? i : lo[c];
+      hi[c] = p[c] > positions[hi[c] * 3 + c] ? i : hi[c];
+    }
+  }
+  float best2 = -1.0f;
+  const float *pa = NULL, *pb = NULL;
+  for (int c = 0; c < 3; c++)
+  {
+    const float *a = &positions[lo[c] * 3];
+    const float *z = &positions[hi[c] * 3];
+    float d2 = (z[0] - a[0]) * (z[0] - a[0]) + (z[1] - a[1]) * (z[1] - a[1]) +
+      (z[2] - a[2]) * (z[2] - a[2]);
+    if (d2 > best2)
+    {
+      best2 = d2;
+      pa = a;
+      pb = z;
+    }
+  }
+
+  float radius = sqrtf(best2) * 0.5f;
+  float *center = out->center;
+  for (int c = 0; c < 3; c++)
+  {
+    center[c] = (pa[c] + pb[c]) * 0.5f;
+  }
+
+  /* Grow it just enough to take in each point outside. */
+  for (size_t i = 0; i < count; i++)
+  {
+    const float *p = &positions[i * 3];
+    float d[3] = { p[0] - center[0], p[1] - center[1], p[2] - center[2] };
+    float dist = sqrtf(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    if (dist > radius)
+    {
+      float grow = (dist - radius) * 0.5f;
+      radius += grow;
+      for (int c = 0; c < 3; c++)
+      {
+        center[c] += d[c] * (grow / dist);
+      }
+    }
+  }
+  out->radius = radius;
+}
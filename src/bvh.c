@@ -0,0 +1,716 @@
+/* =====================
+ * src/bvh.c
+ * 10/18/2026
+ * Bounding volume hierarchy over instances.
+ * ====================
+ */
+
+#include <float.h>
+#include <string.h>
+
+#include <miur/bvh.h>
+#include <miur/mem.h>
+#include <miur/log.h>
+
+#define BVH_BINS 16
+/* Leaves past this many items split even when the heuristic says not to. */
+#define BVH_MAX_LEAF 8
+/* Subtrees at least this large go to another job. */
+#define BVH_JOB_MIN 16384
+/*
+ * Below this depth splits fall back to the middle, which bounds the depth
+ * of any tree within the query stack.
+ */
+#define BVH_MAX_SAH_DEPTH 64
+#define BVH_STACK_SIZE 128
+
+typedef struct BvhTask BvhTask;
+
+/* Items [first, first + count), their bounds and those of their centroids. */
+typedef struct
+{
+  uint32_t first;
+  uint32_t count;
+  Aabb box;
+  Aabb centroids;
+} BvhRange;
+
+typedef struct
+{
+  Bvh *bvh;
+  float *centroids;            /* In leaf order, moved along with items. */
+  JobSystem *jobs;
+  JobCounter done;
+  AtomicI32 next_node;
+  BvhTask *tasks;
+  AtomicI32 next_task;
+} BvhBuilder;
+
+struct BvhTask
+{
+  BvhBuilder *builder;
+  uint32_t node;
+  BvhRange range;
+  uint32_t depth;
+};
+
+typedef struct
+{
+  Aabb box;
+  uint32_t count;
+} BvhBin;
+
+/* === PROTOTYPES === */
+
+static void build_job(void *ud);
+static void build_node(BvhBuilder *b, uint32_t node, const BvhRange *range,
+                       uint32_t depth);
+static bool find_split(BvhBuilder *b, const BvhRange *range,
+                       BvhRange *halves);
+static void bound_range(BvhBuilder *b, BvhRange *range);
+static uint32_t bin_index(float value, float lo, float scale,
+                          uint32_t bin_count);
+static void swap_items(BvhBuilder *b, uint32_t i, uint32_t j);
+static void refit_node(Bvh *bvh, uint32_t node);
+static void grow_box(Aabb *box, const Aabb *other);
+static void grow_point(Aabb *box, const float *point);
+static float half_area(const Aabb *box);
+static bool overlaps(const BvhNode *node, const Aabb *box);
+static bool outside_planes(const float *min, const float *max,
+                           const float *planes, uint32_t plane_count,
+                           uint32_t *mask);
+static bool ray_box(const float *min, const float *max, const float *origin,
+                    const float *inv_dir, float max_t, float *t_out);
+
+/* === PUBLIC FUNCTIONS === */
+
+bool bvh_build(Bvh *bvh_out, const Aabb *bounds, uint32_t count,
+               JobSystem *jobs)
+{
+  memset(bvh_out, 0, sizeof(*bvh_out));
+  if (count == 0)
+  {
+    return true;
+  }
+
+  BvhBuilder b = { 0 };
+  b.bvh = bvh_out;
+  b.jobs = jobs;
+  bvh_out->item_count = count;
+  bvh_out->nodes = MIUR_ARR_UNINIT(BvhNode, (size_t) count * 2 - 1);
+  bvh_out->parents = MIUR_ARR_UNINIT(uint32_t, (size_t) count * 2 - 1);
+  bvh_out->items = MIUR_ARR_UNINIT(uint32_t, count);
+  bvh_out->item_bounds = MIUR_ARR_UNINIT(Aabb, count);
+  bvh_out->item_slots = MIUR_ARR_UNINIT(uint32_t, count);
+  bvh_out->item_leaves = MIUR_ARR_UNINIT(uint32_t, count);
+  b.centroids = MIUR_ARR_UNINIT(float, (size_t) count * 3);
+  b.tasks = jobs != NULL ? MIUR_ARR_UNINIT(BvhTask, count / BVH_JOB_MIN + 1) :
+    NULL;
+  if (bvh_out->nodes == NULL || bvh_out->parents == NULL ||
+      bvh_out->items == NULL || bvh_out->item_bounds == NULL ||
+      bvh_out->item_slots == NULL || bvh_out->item_leaves == NULL ||
+      b.centroids == NULL || (jobs != NULL && b.tasks == NULL))
+  {
+    MIUR_LOG_ERR("Failed to allocate a BVH of %u items", count);
+    MIUR_FREE(b.centroids);
+    MIUR_FREE(b.tasks);
+    bvh_destroy(bvh_out);
+    return false;
+  }
+
+  memcpy(bvh_out->item_bounds, bounds, sizeof(Aabb) * count);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    bvh_out->items[i] = i;
+    for (int c = 0; c < 3; c++)
+    {
+      b.centroids[i * 3 + c] = (bounds[i].min[c] + bounds[i].max[c]) * 0.5f;
+    }
+  }
+
+  BvhRange root = { 0 };
+  root.count = count;
+  bound_range(&b, &root);
+  atomic_i32_store(&b.next_node, 1);
+  bvh_out->parents[0] = BVH_NO_NODE;
+  build_node(&b, 0, &root, 0);
+  if (jobs != NULL)
+  {
+    job_wait(jobs, &b.done);
+  }
+  bvh_out->node_count = (uint32_t) atomic_i32_load(&b.next_node);
+
+  MIUR_FREE(b.centroids);
+  MIUR_FREE(b.tasks);
+  return true;
+}
+
+void bvh_destroy(Bvh *bvh)
+{
+  MIUR_FREE(bvh->nodes);
+  MIUR_FREE(bvh->parents);
+  MIUR_FREE(bvh->items);
+  MIUR_FREE(bvh->item_bounds);
+  MIUR_FREE(bvh->item_slots);
+  MIUR_FREE(bvh->item_leaves);
+  memset(bvh, 0, sizeof(*bvh));
+}
+
+void bvh_refit(Bvh *bvh, const Aabb *bounds)
+{
+  for (uint32_t i = 0; i < bvh->item_count; i++)
+  {
+    bvh->item_bounds[i] = bounds[bvh->items[i]];
+  }
+  /* Children come after their parent, so backwards is bottom up. */
+  for (uint32_t node = bvh->node_count; node-- > 0;)
+  {
+    refit_node(bvh, node);
+  }
+}
+
+void bvh_refit_items(Bvh *bvh, const Aabb *bounds, const uint32_t *items,
+                     uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint32_t item = items[i];
+    bvh->item_bounds[bvh->item_slots[item]] = bounds[item];
+    for (uint32_t node = bvh->item_leaves[item]; node != BVH_NO_NODE;
+         node = bvh->parents[node])
+    {
+      BvhNode before = bvh->nodes[node];
+      refit_node(bvh, node);
+      if (memcmp(&before, &bvh->nodes[node], sizeof(before)) == 0)
+      {
+        break;
+      }
+    }
+  }
+}
+
+uint32_t bvh_query_aabb(const Bvh *bvh, const Aabb *box, uint32_t *out,
+                        uint32_t capacity)
+{
+  uint32_t found = 0;
+  uint32_t stack[BVH_STACK_SIZE];
+  uint32_t top = 0;
+  if (bvh->node_count > 0)
+  {
+    stack[top++] = 0;
+  }
+  while (top > 0)
+  {
+    const BvhNode *node = &bvh->nodes[stack[--top]];
+    if (!overlaps(node, box))
+    {
+      continue;
+    }
+    if (node->count == 0)
+    {
+      stack[top++] = node->first;
+      stack[top++] = node->first + 1;
+      continue;
+    }
+    for (uint32_t i = node->first; i < node->first + node->count; i++)
+    {
+      const Aabb *item = &bvh->item_bounds[i];
+      bool hit = true;
+      for (int c = 0; c < 3; c++)
+      {
+        hit = hit && item->min[c] <= box->max[c] && item->max[c] >= box->min[c];
+      }
+      if (hit)
+      {
+        if (found < capacity)
+        {
+          out[found] = bvh->items[i];
+        }
+        found++;
+      }
+    }
+  }
+  return found;
+}
+
+uint32_t bvh_query_frustum(const Bvh *bvh, const float *planes,
+                           uint32_t plane_count, uint32_t *out,
+                           uint32_t capacity)
+{
+  /* Each entry carries the planes its box isn't yet known to be inside of. */
+  uint32_t found = 0;
+  uint32_t stack[BVH_STACK_SIZE];
+  uint32_t masks[BVH_STACK_SIZE];
+  uint32_t top = 0;
+  if (bvh->node_count > 0)
+  {
+    stack[top] = 0;
+    masks[top++] = plane_count >= 32 ? UINT32_MAX :
+      ((uint32_t) 1 << plane_count) - 1;
+  }
+  while (top > 0)
+  {
+    top--;
+    const BvhNode *node = &bvh->nodes[stack[top]];
+    uint32_t mask = masks[top];
+    if (outside_planes(node->min, node->max, planes, plane_count, &mask))
+    {
+      continue;
+    }
+
+    if (node->count == 0)
+    {
+      stack[top] = node->first;
+      masks[top++] = mask;
+      stack[top] = node->first + 1;
+      masks[top++] = mask;
+      continue;
+    }
+    for (uint32_t i = node->first; i < node->first + node->count; i++)
+    {
+      const Aabb *item = &bvh->item_bounds[i];
+      uint32_t item_mask = mask;
+      if (item_mask != 0 && outside_planes(item->min, item->max, planes,
+                                           plane_count, &item_mask))
+      {
+        continue;
+      }
+      if (found < capacity)
+      {
+        out[found] = bvh->items[i];
+      }
+      found++;
+    }
+  }
+  return found;
+}
+
+bool bvh_raycast(const Bvh *bvh, const float *origin, const float *dir,
+                 float max_t, BvhRayFunc hit, void *ud, BvhHit *hit_out)
+{
+  float inv_dir[3];
+  for (int c = 0; c < 3; c++)
+  {
+    inv_dir[c] = 1.0f / dir[c];
+  }
+
+  bool found = false;
+  float best = max_t;
+  uint32_t stack[BVH_STACK_SIZE];
+  uint32_t top = 0;
+  float t;
+  if (bvh->node_count > 0 &&
+      ray_box(bvh->nodes[0].min, bvh->nodes[0].max, origin, inv_dir, best,
+              &t))
+  {
+    stack[top++] = 0;
+  }
+  while (top > 0)
+  {
+    const BvhNode *node = &bvh->nodes[stack[--top]];
+    if (node->count == 0)
+    {
+      /* Pushes the nearer child last so it is taken first. */
+      const BvhNode *left = &bvh->nodes[node->first];
+      const BvhNode *right = left + 1;
+      float t_left, t_right;
+      bool hit_left = ray_box(left->min, left->max, origin, inv_dir, best,
+                              &t_left);
+      bool hit_right = ray_box(right->min, right->max, origin, inv_dir, best,
+                               &t_right);
+      uint32_t near_node = node->first, far_node = node->first + 1;
+      if (hit_left && hit_right && t_right < t_left)
+      {
+        near_node = node->first + 1;
+        far_node = node->first;
+      }
+      if (hit_left && hit_right)
+      {
+        stack[top++] = far_node;
+        stack[top++] = near_node;
+      } else if (hit_left || hit_right)
+      {
+        stack[top++] = hit_left ? node->first : node->first + 1;
+      }
+      continue;
+    }
+
+    for (uint32_t i = node->first; i < node->first + node->count; i++)
+    {
+      const Aabb *item = &bvh->item_bounds[i];
+      if (!ray_box(item->min, item->max, origin, inv_dir, best, &t))
+      {
+        continue;
+      }
+      if (hit != NULL)
+      {
+        t = best;
+        if (!hit(ud, bvh->items[i], origin, dir, &t))
+        {
+          continue;
+        }
+      }
+      best = t;
+      found = true;
+      hit_out->item = bvh->items[i];
+      hit_out->t = t;
+    }
+  }
+  return found;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void build_job(void *ud)
+{
+  BvhTask *task = (BvhTask *) ud;
+  build_node(task->builder, task->node, &task->range, task->depth);
+}
+
+/*
+ * Splits the range and carries on with the left half, the right one
+ * recursing or, if large, going to another job.
+ */
+static void build_node(BvhBuilder *b, uint32_t node, const BvhRange *range,
+                       uint32_t depth)
+{
+  Bvh *bvh = b->bvh;
+  BvhRange current = *range;
+  for (;;)
+  {
+    BvhNode *out = &bvh->nodes[node];
+    memcpy(out->min, current.box.min, sizeof(out->min));
+    memcpy(out->max, current.box.max, sizeof(out->max));
+
+    BvhRange halves[2];
+    bool split = current.count > 1 && depth < BVH_MAX_SAH_DEPTH &&
+      find_split(b, &current, halves);
+    if (!split && current.count > BVH_MAX_LEAF)
+    {
+      halves[0].first = current.first;
+      halves[0].count = current.count / 2;
+      halves[1].first = current.first + halves[0].count;
+      halves[1].count = current.count - halves[0].count;
+      bound_range(b, &halves[0]);
+      bound_range(b, &halves[1]);
+      split = true;
+    }
+    if (!split)
+    {
+      out->first = current.first;
+      out->count = current.count;
+      for (uint32_t i = current.first; i < current.first + current.count; i++)
+      {
+        bvh->item_slots[bvh->items[i]] = i;
+        bvh->item_leaves[bvh->items[i]] = node;
+      }
+      return;
+    }
+
+    uint32_t left = (uint32_t) atomic_i32_add(&b->next_node, 2) - 2;
+    out->first = left;
+    out->count = 0;
+    bvh->parents[left] = node;
+    bvh->parents[left + 1] = node;
+
+    if (b->jobs != NULL && halves[1].count >= BVH_JOB_MIN)
+    {
+      BvhTask *task = &b->tasks[atomic_i32_add(&b->next_task, 1) - 1];
+      task->builder = b;
+      task->node = left + 1;
+      task->range = halves[1];
+      task->depth = depth + 1;
+      Job job = { build_job, task };
+      job_run(b->jobs, &job, 1, &b->done);
+    } else
+    {
+      build_node(b, left + 1, &halves[1], depth + 1);
+    }
+
+    node = left;
+    current = halves[0];
+    depth++;
+  }
+}
+
+/*
+ * Bins the centroids along each axis and partitions the items at the
+ * cheapest plane.  The halves are bounded on the way, from the bins and
+ * the partition pass.  False if a leaf is cheaper or the centroids can't
+ * be told apart.
+ */
+static bool find_split(BvhBuilder *b, const BvhRange *range,
+                       BvhRange *halves)
+{
+  Bvh *bvh = b->bvh;
+  uint32_t first = range->first, count = range->count;
+  /* Small nodes can't fill many bins, sweeping the empty ones is waste. */
+  uint32_t bin_count = count < BVH_BINS ? count : BVH_BINS;
+  float lo[3], scale[3];
+  BvhBin bins[3][BVH_BINS];
+  for (int axis = 0; axis < 3; axis++)
+  {
+    float extent = range->centroids.max[axis] - range->centroids.min[axis];
+    lo[axis] = range->centroids.min[axis];
+    scale[axis] = extent > 0.0f ? (float) bin_count / extent : 0.0f;
+    for (uint32_t i = 0; i < bin_count; i++)
+    {
+      aabb_empty(&bins[axis][i].box);
+      bins[axis][i].count = 0;
+    }
+  }
+  /* One pass fills the bins of all three axes. */
+  for (uint32_t i = first; i < first + count; i++)
+  {
+    const float *centroid = &b->centroids[(size_t) i * 3];
+    const Aabb *box = &bvh->item_bounds[i];
+    for (int axis = 0; axis < 3; axis++)
+    {
+      BvhBin *bin = &bins[axis][bin_index(centroid[axis], lo[axis],
+                                          scale[axis], bin_count)];
+      grow_box(&bin->box, box);
+      bin->count++;
+    }
+  }
+
+  float best_cost = FLT_MAX;
+  int best_axis = -1;
+  uint32_t best_bin = 0;
+  for (int axis = 0; axis < 3; axis++)
+  {
+    if (scale[axis] == 0.0f)
+    {
+      continue;
+    }
+
+    /* Sweeps the right sides in, then the left sides out against them. */
+    const BvhBin *axis_bins = bins[axis];
+    float right_area[BVH_BINS];
+    Aabb acc;
+    aabb_empty(&acc);
+    uint32_t right_count = 0;
+    float area = 0.0f;
+    for (uint32_t i = bin_count - 1; i > 0; i--)
+    {
+      if (axis_bins[i].count > 0)
+      {
+        grow_box(&acc, &axis_bins[i].box);
+        right_count += axis_bins[i].count;
+        area = half_area(&acc);
+      }
+      right_area[i] = area * (float) right_count;
+    }
+    aabb_empty(&acc);
+    uint32_t left_count = 0;
+    for (uint32_t i = 0; i < bin_count - 1; i++)
+    {
+      if (axis_bins[i].count == 0)
+      {
+        continue;
+      }
+      grow_box(&acc, &axis_bins[i].box);
+      left_count += axis_bins[i].count;
+      float cost = half_area(&acc) * (float) left_count + right_area[i + 1];
+      if (left_count < count && cost < best_cost)
+      {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin = i + 1;
+      }
+    }
+  }
+
+  /* A split costs one box test more than testing every item here. */
+  float node_area = half_area(&range->box);
+  if (best_axis < 0 ||
+      (count <= BVH_MAX_LEAF && node_area > 0.0f &&
+       1.0f + best_cost / node_area >= (float) count))
+  {
+    return false;
+  }
+
+  aabb_empty(&halves[0].box);
+  aabb_empty(&halves[1].box);
+  for (uint32_t i = 0; i < bin_count; i++)
+  {
+    grow_box(&halves[i < best_bin ? 0 : 1].box, &bins[best_axis][i].box);
+  }
+  aabb_empty(&halves[0].centroids);
+  aabb_empty(&halves[1].centroids);
+  uint32_t i = first, j = first + count;
+  while (i < j)
+  {
+    const float *centroid = &b->centroids[(size_t) i * 3];
+    if (bin_index(centroid[best_axis], lo[best_axis], scale[best_axis],
+                  bin_count) < best_bin)
+    {
+      grow_point(&halves[0].centroids, centroid);
+      i++;
+    } else
+    {
+      grow_point(&halves[1].centroids, centroid);
+      swap_items(b, i, --j);
+    }
+  }
+  halves[0].first = first;
+  halves[0].count = i - first;
+  halves[1].first = i;
+  halves[1].count = first + count - i;
+  return true;
+}
+
+/* Bounds the items of the range and their centroids. */
+static void bound_range(BvhBuilder *b, BvhRange *range)
+{
+  aabb_empty(&range->box);
+  aabb_empty(&range->centroids);
+  for (uint32_t i = range->first; i < range->first + range->count; i++)
+  {
+    grow_box(&range->box, &b->bvh->item_bounds[i]);
+    grow_point(&range->centroids, &b->centroids[(size_t) i * 3]);
+  }
+}
+
+static uint32_t bin_index(float value, float lo, float scale,
+                          uint32_t bin_count)
+{
+  float bin = (value - lo) * scale;
+  return bin >= (float) (bin_count - 1) ? bin_count - 1 : (uint32_t) bin;
+}
+
+static void swap_items(BvhBuilder *b, uint32_t i, uint32_t j)
+{
+  Bvh *bvh = b->bvh;
+  uint32_t item = bvh->items[i];
+  bvh->items[i] = bvh->items[j];
+  bvh->items[j] = item;
+  Aabb box = bvh->item_bounds[i];
+  bvh->item_bounds[i] = bvh->item_bounds[j];
+  bvh->item_bounds[j] = box;
+  for (int c = 0; c < 3; c++)
+  {
+    float centroid = b->centroids[(size_t) i * 3 + c];
+    b->centroids[(size_t) i * 3 + c] = b->centroids[(size_t) j * 3 + c];
+    b->centroids[(size_t) j * 3 + c] = centroid;
+  }
+}
+
+static void refit_node(Bvh *bvh, uint32_t node)
+{
+  BvhNode *n = &bvh->nodes[node];
+  Aabb box;
+  if (n->count > 0)
+  {
+    box = bvh->item_bounds[n->first];
+    for (uint32_t i = n->first + 1; i < n->first + n->count; i++)
+    {
+      grow_box(&box, &bvh->item_bounds[i]);
+    }
+  } else
+  {
+    const BvhNode *left = &bvh->nodes[n->first];
+    const BvhNode *right = left + 1;
+    for (int c = 0; c < 3; c++)
+    {
+      box.min[c] = left->min[c] < right->min[c] ? left->min[c] : right->min[c];
+      box.max[c] = left->max[c] > right->max[c] ? left->max[c] : right->max[c];
+    }
+  }
+  memcpy(n->min, box.min, sizeof(n->min));
+  memcpy(n->max, box.max, sizeof(n->max));
+}
+
+/* aabb_union, but inlined into the loops that need it. */
+static void grow_box(Aabb *box, const Aabb *other)
+{
+  for (int c = 0; c < 3; c++)
+  {
+    box->min[c] = other->min[c] < box->min[c] ? other->min[c] : box->min[c];
+    box->max[c] = other->max[c] > box->max[c] ? other->max[c] : box->max[c];
+  }
+}
+
+static void grow_point(Aabb *box, const float *point)
+{
+  for (int c = 0; c < 3; c++)
+  {
+    box->min[c] = point[c] < box->min[c] ? point[c] : box->min[c];
+    box->max[c] = point[c] > box->max[c] ? point[c] : box->max[c];
+  }
+}
+
+/* Half the surface area, all the heuristic needs.  Empty boxes have none. */
+static float half_area(const Aabb *box)
+{
+  if (aabb_is_empty(box))
+  {
+    return 0.0f;
+  }
+  float dx = box->max[0] - box->min[0];
+  float dy = box->max[1] - box->min[1];
+  float dz = box->max[2] - box->min[2];
+  return dx * dy + dy * dz + dz * dx;
+}
+
+static bool overlaps(const BvhNode *node, const Aabb *box)
+{
+  return node->min[0] <= box->max[0] && node->max[0] >= box->min[0] &&
+    node->min[1] <= box->max[1] && node->max[1] >= box->min[1] &&
+    node->min[2] <= box->max[2] && node->max[2] >= box->min[2];
+}
+
+/*
+ * Tests the planes left in `mask`, clearing those the box is entirely
+ * inside of.  True once it is entirely outside of one.
+ */
+static bool outside_planes(const float *min, const float *max,
+                           const float *planes, uint32_t plane_count,
+                           uint32_t *mask)
+{
+  for (uint32_t p = 0; p < plane_count && *mask != 0; p++)
+  {
+    if ((*mask & ((uint32_t) 1 << p)) == 0)
+    {
+      continue;
+    }
+    /* The corners furthest along and against the plane's normal. */
+    const float *plane = &planes[p * 4];
+    float near_dist = plane[3], far_dist = plane[3];
+    for (int c = 0; c < 3; c++)
+    {
+      bool positive = plane[c] >= 0.0f;
+      far_dist += plane[c] * (positive ? max[c] : min[c]);
+      near_dist += plane[c] * (positive ? min[c] : max[c]);
+    }
+    if (far_dist < 0.0f)
+    {
+      return true;
+    }
+    if (near_dist >= 0.0f)
+    {
+      *mask &= ~((uint32_t) 1 << p);
+    }
+  }
+  return false;
+}
+
+/*
+ * Slab test, false if the ray misses the box or enters it past `max_t`.
+ * A ray starting inside enters at 0.
+ */
+static bool ray_box(const float *min, const float *max, const float *origin,
+                    const float *inv_dir, float max_t, float *t_out)
+{
+  float t_near = 0.0f, t_far = max_t;
+  for (int c = 0; c < 3; c++)
+  {
+    float t0 = (min[c] - origin[c]) * inv_dir[c];
+    float t1 = (max[c] - origin[c]) * inv_dir[c];
+    float lo = t0 < t1 ? t0 : t1;
+    float hi = t0 < t1 ? t1 : t0;
+    t_near = lo > t_near ? lo : t_near;
+    t_far = hi < t_far ? hi : t_far;
+  }
+  *t_out = t_near;
+  return t_near <= t_far;
+}
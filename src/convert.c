@@ -0,0 +1,502 @@
+/* =====================
+ * src/convert.c
+ * 10/18/2026
+ * Vertex and index component conversion.
+ * ====================
+ */
+
+#include <float.h>
+#include <string.h>
+
+#include <miur/convert.h>
+#include <miur/simd.h>
+
+/* === PROTOTYPES === */
+
+static float component_scale(ComponentType type, bool normalized);
+static bool component_signed(ComponentType type);
+static float read_component(const uint8_t *p, ComponentType type);
+static uint32_t read_index(const uint8_t *p, ComponentType type);
+
+static void convert_packed(float *dst, const uint8_t *src, size_t n,
+                           ComponentType type, float scale, float lo);
+#ifdef MIUR_HAVE_SSE2
+static void store_i16x8(float *dst, __m128i v, bool sign, __m128 scale,
+                        __m128 lo);
+static __m128i load_i32x4(const uint8_t *p, ComponentType type);
+static size_t convert_strided_sse2(float *dst, const uint8_t *src,
+                                   size_t stride, size_t count,
+                                   uint32_t components, ComponentType type,
+                                   float scale, float lo);
+static __m128i max_u32x4(__m128i a, __m128i b);
+static __m128i min_u32x4(__m128i a, __m128i b);
+static uint32_t reduce_max_u32x4(__m128i v);
+#endif
+
+/* === PUBLIC FUNCTIONS === */
+
+size_t component_size(ComponentType type)
+{
+  switch (type)
+  {
+  case COMPONENT_I8:
+  case COMPONENT_U8:
+    return 1;
+  case COMPONENT_I16:
+  case COMPONENT_U16:
+    return 2;
+  case COMPONENT_U32:
+  case COMPONENT_FLOAT:
+    return 4;
+  }
+  return 0;
+}
+
+void convert_to_float(float *dst, const uint8_t *src, size_t stride,
+                      size_t count, uint32_t components, ComponentType type,
+                      bool normalized)
+{
+  size_t size = component_size(type);
+  size_t elem_size = size * components;
+  float scale = component_scale(type, normalized);
+  float lo = normalized && component_signed(type) ? -1.0f : -FLT_MAX;
+
+  if (stride == elem_size)
+  {
+    convert_packed(dst, src, count * components, type, scale, lo);
+    return;
+  }
+
+  size_t i = 0;
+#ifdef MIUR_HAVE_SSE2
+  i = convert_strided_sse2(dst, src, stride, count, components, type, scale,
+                           lo);
+#endif
+  if (type == COMPONENT_FLOAT)
+  {
+    for (; i < count; i++)
+    {
+      memcpy(dst + i * components, src + i * stride, elem_size);
+    }
+    return;
+  }
+  for (; i < count; i++)
+  {
+    convert_packed(dst + i * components, src + i * stride, components, type,
+                   scale, lo);
+  }
+}
+
+uint32_t convert_indices_u16(uint16_t *dst, const uint8_t *src, size_t count,
+                             ComponentType type)
+{
+  uint32_t max = 0;
+  size_t i = 0;
+
+#ifdef MIUR_HAVE_SSE2
+  __m128i zero = _mm_setzero_si128();
+  if (type == COMPONENT_U8)
+  {
+    __m128i vmax = zero;
+    for (; i + 16 <= count; i += 16)
+    {
+      __m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+      vmax = _mm_max_epu8(vmax, x);
+      _mm_storeu_si128((__m128i *) (dst + i), _mm_unpacklo_epi8(x, zero));
+      _mm_storeu_si128((__m128i *) (dst + i + 8), _mm_unpackhi_epi8(x, zero));
+    }
+    vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 8));
+    vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 4));
+    vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 2));
+    vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 1));
+    max = (uint32_t) _mm_cvtsi128_si32(vmax) & 0xFF;
+  }
+  else if (type == COMPONENT_U16)
+  {
+    /* No unsigned 16 bit max before SSE4.1, flip the sign bit instead. */
+    __m128i bias = _mm_set1_epi16((short) 0x8000);
+    __m128i vmax = _mm_set1_epi16((short) 0x8000);
+    for (; i + 8 <= count; i += 8)
+    {
+      __m128i x = _mm_loadu_si128((const __m128i *) (src + i * 2));
+      vmax = _mm_max_epi16(vmax, _mm_xor_si128(x, bias));
+      _mm_storeu_si128((__m128i *) (dst + i), x);
+    }
+    vmax = _mm_xor_si128(vmax, bias);
+    max = reduce_max_u32x4(_mm_unpacklo_epi16(vmax, zero));
+    uint32_t hi = reduce_max_u32x4(_mm_unpackhi_epi16(vmax, zero));
+    max = hi > max ? hi : max;
+  }
+  else if (type == COMPONENT_U32)
+  {
+    /* Clamp to 65535 first, then narrow with signed saturation around a
+     * 32768 bias, which is exact for everything left. */
+    __m128i bias32 = _mm_set1_epi32(32768);
+    __m128i bias16 = _mm_set1_epi16((short) 0x8000);
+    __m128i limit = _mm_set1_epi32(UINT16_MAX);
+    __m128i vmax = zero;
+    for (; i + 8 <= count; i += 8)
+    {
+      __m128i a = _mm_loadu_si128((const __m128i *) (src + i * 4));
+      __m128i b = _mm_loadu_si128((const __m128i *) (src + i * 4 + 16));
+      vmax = max_u32x4(vmax, max_u32x4(a, b));
+      a = min_u32x4(a, limit);
+      b = min_u32x4(b, limit);
+      __m128i packed = _mm_packs_epi32(_mm_sub_epi32(a, bias32),
+                                       _mm_sub_epi32(b, bias32));
+      _mm_storeu_si128((__m128i *) (dst + i), _mm_xor_si128(packed, bias16));
+    }
+    max = reduce_max_u32x4(vmax);
+  }
+#endif
+
+  for (; i < count; i++)
+  {
+    uint32_t index = read_index(src + i * component_size(type), type);
+    dst[i] = (uint16_t) (index < UINT16_MAX ? index : UINT16_MAX);
+    max = index > max ? index : max;
+  }
+  return max;
+}
+
+uint32_t convert_indices_u32(uint32_t *dst, const uint8_t *src, size_t count,
+                             ComponentType type)
+{
+  uint32_t max = 0;
+  size_t i = 0;
+
+#ifdef MIUR_HAVE_SSE2
+  __m128i zero = _mm_setzero_si128();
+  __m128i vmax = zero;
+  if (type == COMPONENT_U8)
+  {
+    for (; i + 16 <= count; i += 16)
+    {
+      __m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+      __m128i lo = _mm_unpacklo_epi8(x, zero);
+      __m128i hi = _mm_unpackhi_epi8(x, zero);
+      __m128i w0 = _mm_unpacklo_epi16(lo, zero);
+      __m128i w1 = _mm_unpackhi_epi16(lo, zero);
+      __m128i w2 = _mm_unpacklo_epi16(hi, zero);
+      __m128i w3 = _mm_unpackhi_epi16(hi, zero);
+      vmax = max_u32x4(vmax, max_u32x4(max_u32x4(w0, w1), max_u32x4(w2, w3)));
+      _mm_storeu_si128((__m128i *) (dst + i), w0);
+      _mm_storeu_si128((__m128i *) (dst + i + 4), w1);
+      _mm_storeu_si128((__m128i *) (dst + i + 8), w2);
+      _mm_storeu_si128((__m128i *) (dst + i + 12), w3);
+    }
+  }
+  else if (type == COMPONENT_U16)
+  {
+    for (; i + 8 <= count; i += 8)
+    {
+      __m128i x = _mm_loadu_si128((const __m128i *) (src + i * 2));
+      __m128i w0 = _mm_unpacklo_epi16(x, zero);
+      __m128i w1 = _mm_unpackhi_epi16(x, zero);
+      vmax = max_u32x4(vmax, max_u32x4(w0, w1));
+      _mm_storeu_si128((__m128i *) (dst + i), w0);
+      _mm_storeu_si128((__m128i *) (dst + i + 4), w1);
+    }
+  }
+  else if (type == COMPONENT_U32)
+  {
+    for (; i + 4 <= count; i += 4)
+    {
+      __m128i x = _mm_loadu_si128((const __m128i *) (src + i * 4));
+      vmax = max_u32x4(vmax, x);
+      _mm_storeu_si128((__m128i *) (dst + i), x);
+    }
+  }
+  max = reduce_max_u32x4(vmax);
+#endif
+
+  for (; i < count; i++)
+  {
+    uint32_t index = read_index(src + i * component_size(type), type);
+    dst[i] = index;
+    max = index > max ? index : max;
+  }
+  return max;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static float component_scale(ComponentType type, bool normalized)
+{
+  if (!normalized)
+  {
+    return 1.0f;
+  }
+  switch (type)
+  {
+  case COMPONENT_I8: return 1.0f / 127.0f;
+  case COMPONENT_U8: return 1.0f / 255.0f;
+  case COMPONENT_I16: return 1.0f / 32767.0f;
+  case COMPONENT_U16: return 1.0f / 65535.0f;
+  case COMPONENT_U32: return 1.0f / 4294967295.0f;
+  case COMPONENT_FLOAT: return 1.0f;
+  }
+  return 1.0f;
+}
+
+static bool component_signed(ComponentType type)
+{
+  return type == COMPONENT_I8 || type == COMPONENT_I16;
+}
+
+static float read_component(const uint8_t *p, ComponentType type)
+{
+  switch (type)
+  {
+  case COMPONENT_I8:
+    return (float) (int8_t) p[0];
+  case COMPONENT_U8:
+    return (float) p[0];
+  case COMPONENT_I16:
+  {
+    int16_t value;
+    memcpy(&value, p, sizeof(value));
+    return (float) value;
+  }
+  case COMPONENT_U16:
+  {
+    uint16_t value;
+    memcpy(&value, p, sizeof(value));
+    return (float) value;
+  }
+  case COMPONENT_U32:
+  {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return (float) value;
+  }
+  case COMPONENT_FLOAT:
+  {
+    float value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+  }
+  }
+  return 0.0f;
+}
+
+static uint32_t read_index(const uint8_t *p, ComponentType type)
+{
+  switch (type)
+  {
+  case COMPONENT_U8:
+    return p[0];
+  case COMPONENT_U16:
+  {
+    uint16_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+  }
+  case COMPONENT_U32:
+  {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+  }
+  default:
+    return 0;
+  }
+}
+
+/*
+ * Converts `n` consecutive components.  Results are scaled, then clamped to
+ * `lo`, which is -1 for signed normalized types and -FLT_MAX otherwise.
+ */
+static void convert_packed(float *dst, const uint8_t *src, size_t n,
+                           ComponentType type, float scale, float lo)
+{
+  size_t size = component_size(type);
+  size_t i = 0;
+
+  if (type == COMPONENT_FLOAT)
+  {
+    memcpy(dst, src, n * sizeof(float));
+    return;
+  }
+
+  bool sign = component_signed(type);
+#ifdef MIUR_HAVE_AVX2
+  if (type != COMPONENT_U32)
+  {
+    __m256 vscale = _mm256_set1_ps(scale);
+    __m256 vlo = _mm256_set1_ps(lo);
+    for (; i + 8 <= n; i += 8)
+    {
+      __m256i wide;
+      if (size == 1)
+      {
+        __m128i raw = _mm_loadl_epi64((const __m128i *) (src + i));
+        wide = sign ? _mm256_cvtepi8_epi32(raw) : _mm256_cvtepu8_epi32(raw);
+      }
+      else
+      {
+        __m128i raw = _mm_loadu_si128((const __m128i *) (src + i * 2));
+        wide = sign ? _mm256_cvtepi16_epi32(raw) : _mm256_cvtepu16_epi32(raw);
+      }
+      __m256 f = _mm256_mul_ps(_mm256_cvtepi32_ps(wide), vscale);
+      _mm256_storeu_ps(dst + i, _mm256_max_ps(f, vlo));
+    }
+  }
+#endif
+#ifdef MIUR_HAVE_SSE2
+  __m128 vscale = _mm_set1_ps(scale);
+  __m128 vlo = _mm_set1_ps(lo);
+  if (size == 1)
+  {
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16)
+    {
+      __m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+      __m128i a, b;
+      if (sign)
+      {
+        a = _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);
+        b = _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8);
+      }
+      else
+      {
+        a = _mm_unpacklo_epi8(x, zero);
+        b = _mm_unpackhi_epi8(x, zero);
+      }
+      store_i16x8(dst + i, a, sign, vscale, vlo);
+      store_i16x8(dst + i + 8, b, sign, vscale, vlo);
+    }
+  }
+  else if (size == 2)
+  {
+    for (; i + 8 <= n; i += 8)
+    {
+      __m128i x = _mm_loadu_si128((const __m128i *) (src + i * 2));
+      store_i16x8(dst + i, x, sign, vscale, vlo);
+    }
+  }
+#endif
+
+  for (; i < n; i++)
+  {
+    float value = read_component(src + i * size, type) * scale;
+    dst[i] = value > lo ? value : lo;
+  }
+}
+
+#ifdef MIUR_HAVE_SSE2
+
+/* Widens eight 16 bit lanes, signed or not, to floats. */
+static void store_i16x8(float *dst, __m128i v, bool sign, __m128 scale,
+                        __m128 lo)
+{
+  __m128i a, b;
+  if (sign)
+  {
+    a = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+    b = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+  }
+  else
+  {
+    __m128i zero = _mm_setzero_si128();
+    a = _mm_unpacklo_epi16(v, zero);
+    b = _mm_unpackhi_epi16(v, zero);
+  }
+  _mm_storeu_ps(dst, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(a), scale), lo));
+  _mm_storeu_ps(dst + 4,
+                _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(b), scale), lo));
+}
+
+/* Loads four components of an 8 or 16 bit type widened to 32 bits. */
+static __m128i load_i32x4(const uint8_t *p, ComponentType type)
+{
+  __m128i zero = _mm_setzero_si128();
+  __m128i x;
+  if (component_size(type) == 1)
+  {
+    int32_t bytes;
+    memcpy(&bytes, p, sizeof(bytes));
+    x = _mm_cvtsi32_si128(bytes);
+    if (type == COMPONENT_I8)
+    {
+      /* Each byte ends up in the top of its lane, shift it back down. */
+      x = _mm_unpacklo_epi8(x, x);
+      return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 24);
+    }
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(x, zero), zero);
+  }
+
+  x = _mm_loadl_epi64((const __m128i *) p);
+  if (type == COMPONENT_I16)
+  {
+    return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+  }
+  return _mm_unpacklo_epi16(x, zero);
+}
+
+/*
+ * Interleaved attributes, one element per iteration.  Each element is read
+ * and written as a full vector of four, the excess lanes are overwritten by
+ * the next element, so stop while the wide accesses still stay in bounds and
+ * return where the scalar path has to pick up.
+ */
+static size_t convert_strided_sse2(float *dst, const uint8_t *src,
+                                   size_t stride, size_t count,
+                                   uint32_t components, ComponentType type,
+                                   float scale, float lo)
+{
+  size_t size = component_size(type);
+  size_t read_width = type == COMPONENT_FLOAT ? 16 : size * 4;
+  size_t i = 0;
+
+  if (components > 4 || type == COMPONENT_U32 ||
+      stride + size * components < read_width)
+  {
+    return 0;
+  }
+
+  __m128 vscale = _mm_set1_ps(scale);
+  __m128 vlo = _mm_set1_ps(lo);
+  for (; i + 1 < count && (i + 1) * components + 4 <= count * components; i++)
+  {
+    const uint8_t *p = src + i * stride;
+    __m128 f;
+    if (type == COMPONENT_FLOAT)
+    {
+      f = _mm_loadu_ps((const float *) p);
+    }
+    else
+    {
+      f = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(load_i32x4(p, type)), vscale),
+                     vlo);
+    }
+    _mm_storeu_ps(dst + i * components, f);
+  }
+  return i;
+}
+
+/* Unsigned 32 bit max, SSE2 only compares signed. */
+static __m128i max_u32x4(__m128i a, __m128i b)
+{
+  __m128i bias = _mm_set1_epi32((int) 0x80000000);
+  __m128i gt = _mm_cmpgt_epi32(_mm_xor_si128(a, bias),
+                               _mm_xor_si128(b, bias));
+  return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+
+static __m128i min_u32x4(__m128i a, __m128i b)
+{
+  __m128i bias = _mm_set1_epi32((int) 0x80000000);
+  __m128i gt = _mm_cmpgt_epi32(_mm_xor_si128(a, bias),
+                               _mm_xor_si128(b, bias));
+  return _mm_or_si128(_mm_andnot_si128(gt, a), _mm_and_si128(gt, b));
+}
+
+static uint32_t reduce_max_u32x4(__m128i v)
+{
+  v = max_u32x4(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+  v = max_u32x4(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (uint32_t) _mm_cvtsi128_si32(v);
+}
+
+#endif
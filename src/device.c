@@ -249,6 +249,12 @@ VkDevice create_vulkan_device(VkPhysicalDevice pdev, VkQueue *graphics_queue,
 
   uint32_t num_unique_queues = present_index == graphics_index ? 1 : 2;
 
+  /* Cooked textures are BC compressed, see texture_compress.h. */
+  VkPhysicalDeviceFeatures supported;
+  VkPhysicalDeviceFeatures features = { 0 };
+  vkGetPhysicalDeviceFeatures(pdev, &supported);
+  features.textureCompressionBC = supported.textureCompressionBC;
+
   VkDeviceCreateInfo device_create_info = {
     .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
     .queueCreateInfoCount = num_unique_queues,
@@ -256,6 +262,7 @@ VkDevice create_vulkan_device(VkPhysicalDevice pdev, VkQueue *graphics_queue,
     .enabledExtensionCount = sizeof(device_extensions) /
     sizeof(device_extensions[0]),
     .ppEnabledExtensionNames = device_extensions,
+    .pEnabledFeatures = &features,
   };
 
   err = vkCreateDevice(pdev, &device_create_info, NULL, &dev);
@@ -5,51 +5,68 @@
  * ====================
  */
 
+#include <float.h>
 #include <inttypes.h>
+#include <math.h>
+#include <string.h>
 
-#define JSMN_STATIC
-#include <jsmn.h>
-
+#include <miur/archive.h>
+#include <miur/convert.h>
+#include <miur/hash.h>
 #include <miur/mem.h>
+#include <miur/mesh_cache.h>
+#include <miur/mesh_opt.h>
 #include <miur/log.h>
 #include <miur/gltf.h>
+#include <miur/json_schema.h>
+#include <miur/ktx.h>
+#include <miur/texture.h>
+#include <miur/texture_compress.h>
+#include <miur/transform.h>
+
+#define GLTF_MAX_ATTRIBUTE_SETS 4
+#define GLTF_MODE_TRIANGLES 4
+/* Elements per decode task, large accessors are split across workers. */
+#define GLTF_DECODE_CHUNK (64 * 1024)
+/* Positions, normals, texture coordinates and indices. */
+#define GLTF_MAX_STREAMS 4
+/* Images are cooked once and stored, so favour sharpness over speed. */
+#define GLTF_MIP_FILTER MIP_FILTER_KAISER
+#define GLTF_TEXTURE_QUALITY TEXTURE_QUALITY_NORMAL
+
+/* Sampler filters and wrap modes, as OpenGL enumerates them. */
+#define GLTF_FILTER_NEAREST 9728
+#define GLTF_FILTER_LINEAR 9729
+#define GLTF_FILTER_NEAREST_MIPMAP_NEAREST 9984
+#define GLTF_FILTER_LINEAR_MIPMAP_NEAREST 9985
+#define GLTF_FILTER_NEAREST_MIPMAP_LINEAR 9986
+#define GLTF_FILTER_LINEAR_MIPMAP_LINEAR 9987
+#define GLTF_WRAP_CLAMP_TO_EDGE 33071
+#define GLTF_WRAP_MIRRORED_REPEAT 33648
+#define GLTF_WRAP_REPEAT 10497
+
+#define GLB_MAGIC 0x46546C67u          /* "glTF" */
+#define GLB_VERSION 2
+#define GLB_HEADER_SIZE 12
+#define GLB_CHUNK_HEADER_SIZE 8
+#define GLB_CHUNK_JSON 0x4E4F534Au     /* "JSON" */
+#define GLB_CHUNK_BIN 0x004E4942u      /* "BIN\0" */
 
-#define INIT_SCENES 4
-
-#define JSMN_NUMBER 1 << 4
-#define JSMN_BOOL 1 << 5
-#define JSMN_NULL 1 << 6
-
-#define TOKEN_CHUNK_SIZE 30
-#define ASSERT_TOKEN(_type) { if (!assert_type(parser->buf.data,                \
-                                               parser->tokens[parser->cur],     \
-                                               _type))                          \
-      return false; }
-#define ASSERT_KEY() { if (parser->tokens[parser->cur].type != JSMN_STRING \
-                                || parser->tokens[parser->cur].size == 0)       \
-      return false; }
-#define TOKEN_STRCMP(str) json_strcmp(parser->buf.data,                         \
-                                     parser->tokens[parser->cur], str)
-#define TOKEN_PREFIX(prefix) json_prefix(parser->buf.data,                      \
-                                         parser->tokens[parser->cur], prefix)
-#define GET_INDEX_WITH_PREFIX(prefix) json_get_index_with_prefix(               \
-    parser->buf.data, parser->tokens[parser->cur], prefix)
-
-#define IS_EOF() (parser->cur >= parser->token_count)
-#define TOKEN_SIZE() (parser->tokens[parser->cur].size)
-#define TOKEN_LEN() (parser->tokens[parser->cur].end -                          \
-                     parser->tokens[parser->cur].start)
-#define TOKEN_STRING() (parser->buf.data + parser->tokens[parser->cur].start)
-
-#define NEXT_TOKEN() (parser->cur++)
-#define TOKEN_MAKE_STRING() make_token_string(parser->buf.data,                 \
-                                              parser->tokens[parser->cur])
-#define TOKEN_INT() token_to_int(parser->buf.data, parser->tokens[parser->cur])
-#define TOKEN_FLOAT() token_to_float(parser->buf.data, parser->tokens[parser->cur])
+typedef struct
+{
+  const char *version;
+  const char *generator;
+} GLTFAsset;
 
+/* Either matrix or the TRS properties are given, the other stays identity. */
 typedef struct
 {
   const char *name;
+  int *children;
+  size_t child_count;
+  float matrix[16];
+  float translation[3];
+  float rotation[4];
   float scale[3];
   int mesh;
 } GLTFNode;
@@ -79,33 +96,67 @@ typedef struct {
 typedef struct
 {
   int normal, position, tangent;
-  int *tex_coords;
-  int tex_coords_alloc;
-  int *colors;
-  int colors_alloc;
-  int *joints;
-  int joints_alloc;
-  int *weights;
-  int weights_alloc;
+  int tex_coords[GLTF_MAX_ATTRIBUTE_SETS];
+  int colors[GLTF_MAX_ATTRIBUTE_SETS];
+  int joints[GLTF_MAX_ATTRIBUTE_SETS];
+  int weights[GLTF_MAX_ATTRIBUTE_SETS];
+} GLTFAttributes;
+
+typedef struct
+{
+  GLTFAttributes attributes;
   int indices;
+  int mode;
 } GLTFPrimitive;
 
 typedef struct
 {
   GLTFPrimitive *primitives;
-  int primitive_count;
+  size_t primitive_count;
   const char *name;
 } GLTFMesh;
 
-typedef enum
+/* Either uri or bufferView is given. */
+typedef struct
+{
+  const char *uri;
+  int buffer_view;
+  const char *name;
+} GLTFImage;
+
+/* Filters are -1 when left to the renderer. */
+typedef struct
+{
+  int mag_filter;
+  int min_filter;
+  int wrap_s;
+  int wrap_t;
+} GLTFSampler;
+
+typedef struct
+{
+  int sampler;
+  int source;
+} GLTFTexture;
+
+typedef struct
+{
+  int index;
+} GLTFTextureInfo;
+
+typedef struct
+{
+  GLTFTextureInfo base_color_texture;
+} GLTFPbr;
+
+/* Only what decides whether an image holds color or normals. */
+typedef struct
 {
-  GLTF_COMPONENT_TYPE_I8,
-  GLTF_COMPONENT_TYPE_U8,
-  GLTF_COMPONENT_TYPE_I16,
-  GLTF_COMPONENT_TYPE_U16,
-  GLTF_COMPONENT_TYPE_U32,
-  GLTF_COMPONENT_TYPE_FLOAT,
-} GLTFComponentType;
+  const char *name;
+  GLTFPbr pbr;
+  GLTFTextureInfo normal_texture;
+  GLTFTextureInfo emissive_texture;
+} GLTFMaterial;
 
 typedef enum
 {
@@ -121,9 +172,11 @@ typedef enum
 typedef struct
 {
   int buffer_view;
-  GLTFComponentType component_type;
+  ComponentType component_type;
   int count;
   GLTFType type;
+  bool normalized;
+  bool sparse;
   const char *name;
   float max[16];
   float min[16];
@@ -132,18 +185,16 @@ typedef struct
 
 typedef struct
 {
-  jsmntok_t *tokens;
-  size_t token_count;
-  size_t cur;
-
+  JsonStream stream;
   Membuf buf;
+  /* Views into buf, the whole file for .gltf or the chunks of a .glb. */
+  Membuf json;
+  Membuf bin;
+  Arena arena;
 
-  struct {
-    const char *version;
-    const char *generator;
-  } asset;
+  GLTFAsset asset;
 
-  uint32_t start_scene;
+  int start_scene;
   GLTFScene *scenes;
   size_t scene_count;
 
@@ -151,864 +202,2061 @@ typedef struct
   size_t node_count;
 
   GLTFMesh *meshes;
-  int mesh_count;
+  size_t mesh_count;
 
   GLTFAccessor *accessors;
-  int accessor_count;
+  size_t accessor_count;
 
   GLTFBufferView *buffer_views;
-  int buffer_view_count;
+  size_t buffer_view_count;
 
   GLTFBuffer *buffers;
-  int buffer_count;
+  size_t buffer_count;
+
+  GLTFImage *images;
+  size_t image_count;
+
+  GLTFSampler *samplers;
+  size_t sampler_count;
+
+  GLTFTexture *textures;
+  size_t texture_count;
+
+  GLTFMaterial *materials;
+  size_t material_count;
+
   const char *filename;
-  const char *local_prefix;
   size_t local_prefix_len;
 } GLTFParser;
 
+/* One accessor to decode into a mesh array. */
+typedef struct
+{
+  const uint8_t *src;
+  size_t stride;
+  ComponentType type;
+  bool normalized;
+  bool indices;                /* dst holds uint32_t instead of floats. */
+  uint32_t components;
+  uint32_t count;
+  void *dst;
+} GLTFStream;
+
+typedef struct
+{
+  GLTFLoad *load;
+  size_t index;
+  const char *path;
+  IoRequest request;
+  bool reading;                /* Submitted to the I/O service. */
+} GLTFBufferTask;
+
+typedef struct
+{
+  GLTFLoad *load;
+  const GLTFPrimitive *prim;
+  StaticMesh *mesh;
+  GLTFStream streams[GLTF_MAX_STREAMS];
+  uint32_t stream_count;
+  AtomicI32 pending;           /* Decode tasks left before finalizing. */
+  MeshOptReport report;
+} GLTFPrimitiveTask;
+
+typedef struct
+{
+  GLTFPrimitiveTask *prim;
+  const GLTFStream *stream;
+  uint32_t first, count;
+} GLTFDecodeTask;
+
+/*
+ * Cooks one image into its texture.  The encoded image is either already
+ * at `data`, e.g. in a buffer, or the whole file at `path`.
+ */
+typedef struct
+{
+  GLTFLoad *load;
+  Texture *texture;
+  const char *path;
+  Membuf file;                 /* `path` mapped, kept until it's hashed. */
+  const uint8_t *data;
+  size_t size;
+  bool srgb;                   /* Holds color. */
+  bool normal;                 /* Holds normals, unless also color. */
+} GLTFImageTask;
+
+/*
+ * A load runs as a chain of stages, each started by the last task of the one
+ * before it:
+ *
+ *   parse      map the file and decode the JSON
+ *   buffers    one task or I/O request per external buffer
+ *   prepare    validate accessors, allocate meshes, split the decode work
+ *   decode     one task per chunk of an accessor
+ *   finalize   per primitive once all of its chunks are in, fixes up and
+ *              optimizes the mesh, builds its meshlets and levels of detail
+ *   images     one task per image alongside decode, builds its mips and
+ *              compresses them, see texture_compress.h
+ *
+ * When the cooked cache next to the file still matches the sources, parse
+ * maps it instead and the load is done.  Otherwise the
+ * finished model is written back to the cache.  Without a job system every
+ * stage runs inline on the calling thread.
+ */
+struct GLTFLoad
+{
+  GLTFParser parser;
+  StaticModel *out;
+  JobSystem *jobs;
+  IoService *io;
+
+  GLTFBufferTask *buffer_tasks;
+  GLTFPrimitiveTask *prim_tasks;
+  size_t prim_task_count;
+  GLTFDecodeTask *decode_tasks;
+  size_t decode_task_count;
+  GLTFImageTask *image_tasks;
+  size_t image_task_count;
+
+  /* Cooked copy next to the source, see mesh_cache.h. */
+  char *cache_path;
+  bool cached;                 /* Loaded from the cache, nothing to cook. */
+  uint64_t source_hash;
+
+  /* Buffers, then primitives and images, left before the next stage. */
+  AtomicI32 pending;
+  AtomicI32 failed;
+  JobCounter done;
+  bool result;
+};
+
 /* === PROTOTYPES === */
 
-bool parse_root(GLTFParser *parser);
-bool parse_asset_toplevel(GLTFParser *parser);
-bool parse_scene(GLTFParser *parser, GLTFScene *scene);
-bool parse_node(GLTFParser *parser, GLTFNode *node);
-bool parse_mesh(GLTFParser *parser, GLTFMesh *mesh);
-bool parse_primitive(GLTFParser *parser, GLTFPrimitive *primitive);
-bool parse_accessor(GLTFParser *parser, GLTFAccessor *accessor);
-bool parse_buffer_view(GLTFParser *parser, GLTFBufferView *view);
-bool parse_buffer(GLTFParser *parser, GLTFBuffer *buffer);
-
-bool json_strcmp(const uint8_t *buf, jsmntok_t tok, const char *str);
-bool json_prefix(const uint8_t *buf, jsmntok_t tok, const char *prefix);
-int json_get_index_with_prefix(const uint8_t *buf, jsmntok_t tok,
-                               const char *prefix);
-
-float token_to_float(const uint8_t *buf, jsmntok_t tok);
-const char *make_token_string(const uint8_t *buf, jsmntok_t tok);
-bool assert_type(const uint8_t *buf, jsmntok_t tok, int type);
-int64_t token_to_int(const uint8_t *buf, jsmntok_t tok);
-int roundup(int base);
-
-bool translate_to_model(GLTFParser *parser, StaticModel *out);
+static void init_node(void *out);
+static void init_attributes(void *out);
+static void init_primitive(void *out);
+static void init_accessor(void *out);
+static void init_image(void *out);
+static void init_sampler(void *out);
+static void init_texture(void *out);
+static void init_texture_info(void *out);
+static void init_material(void *out);
+static bool decode_attribute_set(JsonDecoder *dec, JsonTok key, void *out);
+static bool decode_component_type(JsonDecoder *dec, void *out);
+static bool decode_sparse(JsonDecoder *dec, void *out);
+
+static bool split_glb(GLTFParser *parser);
+static uint32_t read_u32(const uint8_t *p);
+
+static GLTFLoad *load_create(StaticModel *out, const char *filename,
+                             JobSystem *jobs, IoService *io);
+static void load_dispatch(GLTFLoad *load, JobFunction function, void *ud);
+static void load_finish(GLTFLoad *load);
+static void parse_job(void *ud);
+static void start_buffers(GLTFLoad *load);
+static bool uri_path(GLTFParser *parser, const char *uri, char **path_out);
+static void map_buffer_job(void *ud);
+static void buffer_read_callback(IoRequest *req);
+static void buffer_done(GLTFLoad *load, bool success);
+static void prepare_job(void *ud);
+static void decode_job(void *ud);
+static void finalize_primitive(GLTFPrimitiveTask *task);
+static void image_job(void *ud);
+static void task_done(GLTFLoad *load);
+static bool load_cached(GLTFLoad *load);
+static void report_optimization(GLTFLoad *load);
+static void write_cache(GLTFLoad *load);
+static bool compute_world(StaticModel *model);
+
+bool uri_decode(char *uri);
+int hex_value(char c);
+void parser_destroy(GLTFParser *parser);
+
+bool translate_to_model(GLTFLoad *load);
+static bool flatten_nodes(GLTFParser *parser, StaticModel *out,
+                          int32_t **order_out);
+static bool translate_primitive(GLTFParser *parser, GLTFPrimitiveTask *task);
+static bool translate_images(GLTFLoad *load);
+static bool translate_textures(GLTFParser *parser, StaticModel *out);
+static bool translate_wrap(int wrap, TextureWrap *out);
+static const uint8_t *accessor_data(GLTFParser *parser, int index,
+                                    GLTFType type, size_t *stride_out);
+static bool add_stream(GLTFParser *parser, GLTFPrimitiveTask *task, int index,
+                       GLTFType type, void **dst_out);
+static void generate_normals(StaticMesh *mesh);
+
+/* === SCHEMAS === */
+
+static const uint32_t gltf_type_components[] = {
+  [GLTF_TYPE_SCALAR] = 1,
+  [GLTF_TYPE_VEC2] = 2,
+  [GLTF_TYPE_VEC3] = 3,
+  [GLTF_TYPE_VEC4] = 4,
+  [GLTF_TYPE_MAT2] = 4,
+  [GLTF_TYPE_MAT3] = 9,
+  [GLTF_TYPE_MAT4] = 16,
+};
+
+static const char *const gltf_type_names[] = {
+  [GLTF_TYPE_SCALAR] = "SCALAR",
+  [GLTF_TYPE_VEC2] = "VEC2",
+  [GLTF_TYPE_VEC3] = "VEC3",
+  [GLTF_TYPE_VEC4] = "VEC4",
+  [GLTF_TYPE_MAT2] = "MAT2",
+  [GLTF_TYPE_MAT3] = "MAT3",
+  [GLTF_TYPE_MAT4] = "MAT4",
+  NULL,
+};
+
+#define GLTF_ASSET_FIELDS(X, S)                                                \
+  X(S, CSTRING,      "version",       version,         ,                 )     \
+  X(S, CSTRING,      "generator",     generator,       ,                 )
+JSON_SCHEMA_DEFINE(asset_schema, GLTFAsset, GLTF_ASSET_FIELDS, 0, NULL, NULL);
+
+#define GLTF_SCENE_FIELDS(X, S)                                                \
+  X(S, CSTRING,      "name",          name,            ,                 )     \
+  X(S, INT_ARRAY,    "nodes",         nodes,           node_count,       )
+JSON_SCHEMA_DEFINE(scene_schema, GLTFScene, GLTF_SCENE_FIELDS, 0, NULL, NULL);
+
+#define GLTF_NODE_FIELDS(X, S)                                                 \
+  X(S, CSTRING,      "name",          name,            ,                 )     \
+  X(S, INT,          "mesh",          mesh,            ,                 )     \
+  X(S, INT_ARRAY,    "children",      children,        child_count,      )     \
+  X(S, FLOAT_ARRAY,  "matrix",        matrix,          ,                 )     \
+  X(S, FLOAT_ARRAY,  "translation",   translation,     ,                 )     \
+  X(S, FLOAT_ARRAY,  "rotation",      rotation,        ,                 )     \
+  X(S, FLOAT_ARRAY,  "scale",         scale,           ,                 )
+JSON_SCHEMA_DEFINE(node_schema, GLTFNode, GLTF_NODE_FIELDS, 0, init_node,
+                   NULL);
+
+#define GLTF_ATTRIBUTES_FIELDS(X, S)                                           \
+  X(S, INT,          "POSITION",      position,        ,                 )     \
+  X(S, INT,          "NORMAL",        normal,          ,                 )     \
+  X(S, INT,          "TANGENT",       tangent,         ,                 )
+JSON_SCHEMA_DEFINE(attributes_schema, GLTFAttributes, GLTF_ATTRIBUTES_FIELDS,
+                   0, init_attributes, decode_attribute_set);
+
+#define GLTF_PRIMITIVE_FIELDS(X, S)                                            \
+  X(S, OBJECT,       "attributes",    attributes,      , &attributes_schema)   \
+  X(S, INT,          "indices",       indices,         ,                 )     \
+  X(S, INT,          "mode",          mode,            ,                 )
+JSON_SCHEMA_DEFINE(primitive_schema, GLTFPrimitive, GLTF_PRIMITIVE_FIELDS, 0,
+                   init_primitive, NULL);
+
+#define GLTF_MESH_FIELDS(X, S)                                                 \
+  X(S, CSTRING,      "name",          name,            ,                 )     \
+  X(S, OBJECT_ARRAY, "primitives",    primitives,      primitive_count,        \
+    &primitive_schema)
+JSON_SCHEMA_DEFINE(mesh_schema, GLTFMesh, GLTF_MESH_FIELDS, 0, NULL, NULL);
+
+#define GLTF_ACCESSOR_FIELDS(X, S)                                             \
+  X(S, INT,          "bufferView",    buffer_view,     ,                 )     \
+  X(S, INT,          "byteOffset",    byte_offset,     ,                 )     \
+  X(S, CUSTOM,       "componentType", component_type,  ,                       \
+    decode_component_type)                                                     \
+  X(S, BOOL,         "normalized",    normalized,      ,                 )     \
+  X(S, CUSTOM,       "sparse",        sparse,          , decode_sparse   )     \
+  X(S, INT,          "count",         count,           ,                 )     \
+  X(S, ENUM,         "type",          type,            , gltf_type_names )     \
+  X(S, FLOAT_ARRAY,  "max",           max,             ,                 )     \
+  X(S, FLOAT_ARRAY,  "min",           min,             ,                 )     \
+  X(S, CSTRING,      "name",          name,            ,                 )
+JSON_SCHEMA_DEFINE(accessor_schema, GLTFAccessor, GLTF_ACCESSOR_FIELDS, 0,
+                   init_accessor, NULL);
+
+#define GLTF_BUFFER_VIEW_FIELDS(X, S)                                          \
+  X(S, INT,          "buffer",        buffer,          ,                 )     \
+  X(S, INT,          "byteLength",    byte_length,     ,                 )     \
+  X(S, INT,          "byteStride",    byte_stride,     ,                 )     \
+  X(S, INT,          "byteOffset",    byte_offset,     ,                 )     \
+  X(S, CSTRING,      "name",          name,            ,                 )
+JSON_SCHEMA_DEFINE(buffer_view_schema, GLTFBufferView, GLTF_BUFFER_VIEW_FIELDS,
+                   0, NULL, NULL);
+
+#define GLTF_BUFFER_FIELDS(X, S)                                               \
+  X(S, CSTRING,      "uri",           uri,             ,                 )     \
+  X(S, INT,          "byteLength",    byte_length,     ,                 )
+JSON_SCHEMA_DEFINE(buffer_schema, GLTFBuffer, GLTF_BUFFER_FIELDS, 0, NULL,
+                   NULL);
+
+#define GLTF_IMAGE_FIELDS(X, S)                                                \
+  X(S, CSTRING,      "uri",           uri,             ,                 )     \
+  X(S, INT,          "bufferView",    buffer_view,     ,                 )     \
+  X(S, CSTRING,      "name",          name,            ,                 )
+JSON_SCHEMA_DEFINE(image_schema, GLTFImage, GLTF_IMAGE_FIELDS, 0, init_image,
+                   NULL);
+
+#define GLTF_SAMPLER_FIELDS(X, S)                                              \
+  X(S, INT,          "magFilter",     mag_filter,      ,                 )     \
+  X(S, INT,          "minFilter",     min_filter,      ,                 )     \
+  X(S, INT,          "wrapS",         wrap_s,          ,                 )     \
+  X(S, INT,          "wrapT",         wrap_t,          ,                 )
+JSON_SCHEMA_DEFINE(sampler_schema, GLTFSampler, GLTF_SAMPLER_FIELDS, 0,
+                   init_sampler, NULL);
+
+#define GLTF_TEXTURE_FIELDS(X, S)                                              \
+  X(S, INT,          "sampler",       sampler,         ,                 )     \
+  X(S, INT,          "source",        source,          ,                 )
+JSON_SCHEMA_DEFINE(texture_schema, GLTFTexture, GLTF_TEXTURE_FIELDS, 0,
+                   init_texture, NULL);
+
+#define GLTF_TEXTURE_INFO_FIELDS(X, S)                                         \
+  X(S, INT,          "index",         index,           ,                 )
+JSON_SCHEMA_DEFINE(texture_info_schema, GLTFTextureInfo,
+                   GLTF_TEXTURE_INFO_FIELDS, 0, init_texture_info, NULL);
+
+#define GLTF_PBR_FIELDS(X, S)                                                  \
+  X(S, OBJECT,       "baseColorTexture", base_color_texture, ,                 \
+    &texture_info_schema)
+JSON_SCHEMA_DEFINE(pbr_schema, GLTFPbr, GLTF_PBR_FIELDS, 0, NULL, NULL);
+
+#define GLTF_MATERIAL_FIELDS(X, S)                                             \
+  X(S, CSTRING,      "name",          name,            ,                 )     \
+  X(S, OBJECT,       "pbrMetallicRoughness", pbr,      , &pbr_schema     )     \
+  X(S, OBJECT,       "normalTexture", normal_texture,  ,                       \
+    &texture_info_schema)                                                      \
+  X(S, OBJECT,       "emissiveTexture", emissive_texture, ,                    \
+    &texture_info_schema)
+JSON_SCHEMA_DEFINE(material_schema, GLTFMaterial, GLTF_MATERIAL_FIELDS, 0,
+                   init_material, NULL);
+
+#define GLTF_ROOT_FIELDS(X, S)                                                 \
+  X(S, OBJECT,       "asset",         asset,           , &asset_schema   )     \
+  X(S, INT,          "scene",         start_scene,     ,                 )     \
+  X(S, OBJECT_ARRAY, "scenes",        scenes,          scene_count,            \
+    &scene_schema)                                                             \
+  X(S, OBJECT_ARRAY, "nodes",         nodes,           node_count,             \
+    &node_schema)                                                              \
+  X(S, OBJECT_ARRAY, "meshes",        meshes,          mesh_count,             \
+    &mesh_schema)                                                              \
+  X(S, OBJECT_ARRAY, "accessors",     accessors,       accessor_count,         \
+    &accessor_schema)                                                          \
+  X(S, OBJECT_ARRAY, "bufferViews",   buffer_views,    buffer_view_count,      \
+    &buffer_view_schema)                                                       \
+  X(S, OBJECT_ARRAY, "buffers",       buffers,         buffer_count,           \
+    &buffer_schema)                                                            \
+  X(S, OBJECT_ARRAY, "images",        images,          image_count,            \
+    &image_schema)                                                             \
+  X(S, OBJECT_ARRAY, "samplers",      samplers,        sampler_count,          \
+    &sampler_schema)                                                           \
+  X(S, OBJECT_ARRAY, "textures",      textures,        texture_count,          \
+    &texture_schema)                                                           \
+  X(S, OBJECT_ARRAY, "materials",     materials,       material_count,         \
+    &material_schema)
+JSON_SCHEMA_DEFINE(gltf_schema, GLTFParser, GLTF_ROOT_FIELDS, 0, NULL, NULL);
 
 /* === PUBLIC FUNCTIONS === */
 
 bool
 gltf_parse(StaticModel *out, const char *filename)
 {
-  GLTFParser parser;
-
-  parser.asset.version = NULL;
-  jsmn_parser json;
-  if (!membuf_load_file(&parser.buf, filename))
+  GLTFLoad *load = load_create(out, filename, NULL, NULL);
+  if (load == NULL)
   {
     return false;
   }
-  jsmn_init(&json);
 
-  parser.filename = filename;
-  parser.token_count = jsmn_parse(&json, parser.buf.data, parser.buf.size,
-                                  NULL, 0);
+  parse_job(load);
+  bool result = load->result;
+  MIUR_FREE(load);
+  return result;
+}
 
-  size_t filename_len = strlen(filename);
-  const char *c = filename + (filename_len - 1);
-  while (*c != '\\' && *c != '/')
+GLTFLoad *gltf_load_async(StaticModel *out, const char *filename,
+                          JobSystem *jobs, IoService *io)
+{
+  GLTFLoad *load = load_create(out, filename, jobs, io);
+  if (load == NULL)
   {
-    c--;
+    return NULL;
   }
-  c++;
-  parser.local_prefix_len = c - filename;
-  char *local_prefix = MIUR_ARR(char, parser.local_prefix_len);
-  memcpy(local_prefix, filename, parser.local_prefix_len);
-  parser.local_prefix = local_prefix;
 
-  if (parser.token_count <= 0)
-  {
-    return false;
-  }
+  job_counter_add(&load->done, 1);
+  load_dispatch(load, parse_job, load);
+  return load;
+}
 
-  parser.tokens = MIUR_ARR(jsmntok_t, parser.token_count);
+bool gltf_load_done(GLTFLoad *load)
+{
+  return job_counter_done(&load->done);
+}
 
-  jsmn_init(&json);
+bool gltf_load_wait(GLTFLoad *load)
+{
+  job_wait(load->jobs, &load->done);
+  bool result = load->result;
+  MIUR_FREE(load);
+  return result;
+}
 
-  parser.cur = 0;
-  jsmn_parse(&json, parser.buf.data, parser.buf.size, parser.tokens,
-             parser.token_count);
-  if (!parse_root(&parser))
+void gltf_model_destroy(StaticModel *model)
+{
+  /* Cached meshes point into the storage block. */
+  for (uint32_t i = 0; model->storage.data == NULL && model->meshes != NULL &&
+       i < model->mesh_count; i++)
   {
-    return false;
+    MIUR_FREE(model->meshes[i].verts_pos);
+    MIUR_FREE(model->meshes[i].verts_norm);
+    MIUR_FREE(model->meshes[i].verts_uv);
+    MIUR_FREE(model->meshes[i].indices);
+    meshlet_buffer_destroy(&model->meshes[i].meshlets);
   }
-  
-  if (!translate_to_model(&parser, out))
+  if (model->storage.data == NULL)
   {
-    return false;
+    MIUR_FREE(model->node_parents);
+    MIUR_FREE(model->node_local);
+    MIUR_FREE(model->instances);
   }
-
-  return true;
+  /* A cached model's images are in its storage as well. */
+  if (model->storage.data == NULL)
+  {
+    for (uint32_t i = 0; model->images != NULL && i < model->image_count;
+         i++)
+    {
+      texture_destroy(&model->images[i]);
+    }
+    MIUR_FREE(model->textures);
+  }
+  MIUR_FREE(model->images);
+  MIUR_FREE(model->meshes);
+  MIUR_FREE(model->node_world);
+  MIUR_FREE(model->instance_bounds);
+  if (model->storage.data != NULL)
+  {
+    membuf_destroy(&model->storage);
+  }
+  memset(model, 0, sizeof(StaticModel));
 }
 
 /* === PRIVATE FUNCTIONS === */
 
-bool parse_root(GLTFParser *parser)
+static void init_node(void *out)
+{
+  GLTFNode *node = (GLTFNode *) out;
+  node->mesh = -1;
+  mat4_identity(node->matrix);
+  node->rotation[3] = 1.0f;
+  node->scale[0] = node->scale[1] = node->scale[2] = 1.0f;
+}
+
+static void init_attributes(void *out)
 {
-  ASSERT_TOKEN(JSMN_OBJECT);
+  GLTFAttributes *attributes = (GLTFAttributes *) out;
+  attributes->position = attributes->normal = attributes->tangent = -1;
+  for (int i = 0; i < GLTF_MAX_ATTRIBUTE_SETS; i++)
+  {
+    attributes->tex_coords[i] = attributes->colors[i] = -1;
+    attributes->joints[i] = attributes->weights[i] = -1;
+  }
+}
 
-  int size = TOKEN_SIZE();
-  NEXT_TOKEN();
+static void init_primitive(void *out)
+{
+  GLTFPrimitive *primitive = (GLTFPrimitive *) out;
+  primitive->indices = -1;
+  primitive->mode = GLTF_MODE_TRIANGLES;
+}
 
-  for (int i = 0; i < size; i++)
+static void init_accessor(void *out)
+{
+  GLTFAccessor *accessor = (GLTFAccessor *) out;
+  accessor->buffer_view = -1;
+  for (int c = 0; c < 3; c++)
   {
-    ASSERT_KEY();
-    if (TOKEN_STRCMP("asset"))
-    {
-      NEXT_TOKEN();
-      if (!parse_asset_toplevel(parser))
-      {
-        return false;
-      }
-    }
-    else if (TOKEN_STRCMP("scene"))
-    {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_NUMBER);
-      parser->start_scene = TOKEN_INT();
-      NEXT_TOKEN();
-    }
-    else if (TOKEN_STRCMP("scenes"))
-    {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_ARRAY);
-      parser->scene_count = TOKEN_SIZE();
-      parser->scenes = MIUR_ARR(GLTFScene, parser->scene_count);
-      NEXT_TOKEN();
+    accessor->min[c] = FLT_MAX;
+    accessor->max[c] = -FLT_MAX;
+  }
+}
 
-      for (int j = 0; j < parser->scene_count; j++)
-      {
-        if (!parse_scene(parser, &parser->scenes[j]))
-        {
-          return false;
-        }
-      }
-    } else if (TOKEN_STRCMP("nodes"))
-    {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_ARRAY);
-      parser->node_count = TOKEN_SIZE();
-      parser->nodes = MIUR_ARR(GLTFNode, parser->node_count);
-      NEXT_TOKEN();
+static void init_image(void *out)
+{
+  GLTFImage *image = (GLTFImage *) out;
+  image->buffer_view = -1;
+}
 
+static void init_sampler(void *out)
+{
+  GLTFSampler *sampler = (GLTFSampler *) out;
+  sampler->mag_filter = sampler->min_filter = -1;
+  sampler->wrap_s = sampler->wrap_t = GLTF_WRAP_REPEAT;
+}
 
-      for (int j = 0; j < parser->node_count; j++)
-      {
-        if (!parse_node(parser, &parser->nodes[j]))
-        {
-          return false;
-        }
-      }
-    } else if (TOKEN_STRCMP("meshes"))
-    {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_ARRAY);
-      parser->mesh_count = TOKEN_SIZE();
-      parser->meshes = MIUR_ARR(GLTFMesh, parser->mesh_count);
-      NEXT_TOKEN();
+static void init_texture(void *out)
+{
+  GLTFTexture *texture = (GLTFTexture *) out;
+  texture->sampler = texture->source = -1;
+}
 
-      for (int j = 0; j < parser->mesh_count; j++)
-      {
-        if (!parse_mesh(parser, &parser->meshes[j]))
-        {
-          return false;
-        }
-      }
-    } else if (TOKEN_STRCMP("accessors"))
-    {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_ARRAY);
-      parser->accessor_count = TOKEN_SIZE();
-      parser->accessors = MIUR_ARR(GLTFAccessor, parser->accessor_count);
-      NEXT_TOKEN();
+static void init_texture_info(void *out)
+{
+  GLTFTextureInfo *info = (GLTFTextureInfo *) out;
+  info->index = -1;
+}
 
-      for (int j = 0; j < parser->accessor_count; j++)
-      {
-        if (!parse_accessor(parser, &parser->accessors[j]))
-        {
-          return false;
-        }
-      }
-    } else if (TOKEN_STRCMP("bufferViews"))
-    {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_ARRAY);
-      parser->buffer_view_count = TOKEN_SIZE();
-      parser->buffer_views = MIUR_ARR(GLTFBufferView,
-                                      parser->buffer_view_count);
-      NEXT_TOKEN();
+/* The nested objects are only initialized when present. */
+static void init_material(void *out)
+{
+  GLTFMaterial *material = (GLTFMaterial *) out;
+  material->pbr.base_color_texture.index = -1;
+  material->normal_texture.index = -1;
+  material->emissive_texture.index = -1;
+}
 
-      for (int j = 0; j < parser->buffer_view_count; j++)
-      {
-        if (!parse_buffer_view(parser, &parser->buffer_views[j]))
-        {
-          return false;
-        }
-      }
-    } else if (TOKEN_STRCMP("buffers"))
+/* Handles the numbered attribute sets, e.g. "TEXCOORD_1". */
+static bool decode_attribute_set(JsonDecoder *dec, JsonTok key, void *out)
+{
+  GLTFAttributes *attributes = (GLTFAttributes *) out;
+  String str = json_get_string(dec->stream, key);
+  static const struct
+  {
+    const char *prefix;
+    size_t offset;
+  } sets[] = {
+    { "TEXCOORD_", offsetof(GLTFAttributes, tex_coords) },
+    { "COLOR_", offsetof(GLTFAttributes, colors) },
+    { "JOINTS_", offsetof(GLTFAttributes, joints) },
+    { "WEIGHTS_", offsetof(GLTFAttributes, weights) },
+  };
+
+  for (size_t i = 0; i < sizeof(sets) / sizeof(sets[0]); i++)
+  {
+    size_t prefix_len = strlen(sets[i].prefix);
+    if (str.size <= prefix_len ||
+        strncmp((const char *) str.data, sets[i].prefix, prefix_len) != 0)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_ARRAY);
-      parser->buffer_count = TOKEN_SIZE();
-      parser->buffers = MIUR_ARR(GLTFBuffer, parser->buffer_count);
-      NEXT_TOKEN();
+      continue;
+    }
 
-      for (int j = 0; j < parser->buffer_count; j++)
+    int set = 0;
+    for (size_t j = prefix_len; j < str.size; j++)
+    {
+      if (str.data[j] < '0' || str.data[j] > '9')
       {
-        if (!parse_buffer(parser, &parser->buffers[j]))
-        {
-          return false;
-        }
+        return json_decode_error(dec, key, "malformed attribute '%.*s'",
+                                 (int) str.size, str.data);
       }
+      set = set * 10 + (str.data[j] - '0');
     }
-    else
+
+    if (set >= GLTF_MAX_ATTRIBUTE_SETS)
     {
-      MIUR_LOG_ERR("Found unknown root field '%s'", TOKEN_MAKE_STRING());
-      return false;
+      MIUR_LOG_WARN("ignoring attribute '%.*s'", (int) str.size, str.data);
+      json_skip_value(dec->stream);
+      return true;
     }
+
+    int *indices = (int *) ((uint8_t *) attributes + sets[i].offset);
+    return json_decode_int(dec, &indices[set]);
+  }
+
+  /* Application specific attributes start with an underscore. */
+  json_skip_value(dec->stream);
+  return true;
+}
+
+static bool decode_component_type(JsonDecoder *dec, void *out)
+{
+  JsonTok tok = JSON_PEEK(dec->stream);
+  int value;
+  if (!json_decode_int(dec, &value))
+  {
+    return false;
   }
 
+  ComponentType *type = (ComponentType *) out;
+  switch (value)
+  {
+  case 5120: *type = COMPONENT_I8; break;
+  case 5121: *type = COMPONENT_U8; break;
+  case 5122: *type = COMPONENT_I16; break;
+  case 5123: *type = COMPONENT_U16; break;
+  case 5125: *type = COMPONENT_U32; break;
+  case 5126: *type = COMPONENT_FLOAT; break;
+  default:
+    return json_decode_error(dec, tok, "unknown component type %d", value);
+  }
   return true;
 }
 
-bool json_strcmp(const uint8_t *buf, jsmntok_t tok, const char *str)
+/* Sparse substitution isn't supported, only note it so it can be refused. */
+static bool decode_sparse(JsonDecoder *dec, void *out)
 {
-  size_t len = strlen(str);
-  return len == (tok.end - tok.start) &&
-    strncmp(str, buf + tok.start, len) == 0;
+  *(bool *) out = true;
+  json_skip_value(dec->stream);
+  return true;
 }
 
-bool parse_asset_toplevel(GLTFParser *parser)
+/*
+ * GLB files are a header and chunks, the first chunk JSON and an optional
+ * second one holding buffer 0.  Both are used in place, so the buffer data
+ * stays in the mapped file.  Plain .gltf files are all JSON.
+ */
+static bool split_glb(GLTFParser *parser)
 {
-  ASSERT_TOKEN(JSMN_OBJECT);
-  int size = TOKEN_SIZE();
-  NEXT_TOKEN();
+  const uint8_t *data = parser->buf.data;
+  size_t size = parser->buf.size;
+
+  parser->json.data = data;
+  parser->json.size = size;
+  parser->json.kind = MEMBUF_VIEW;
+  if (size < GLB_HEADER_SIZE || read_u32(data) != GLB_MAGIC)
+  {
+    return true;
+  }
 
-  for (int i = 0; i < size; i++)
+  uint32_t length = read_u32(data + 8);
+  if (read_u32(data + 4) != GLB_VERSION || length > size)
   {
-    ASSERT_KEY();
-    if (TOKEN_STRCMP("version"))
+    return false;
+  }
+
+  size_t offset = GLB_HEADER_SIZE;
+  for (int chunk = 0; offset + GLB_CHUNK_HEADER_SIZE <= length; chunk++)
+  {
+    uint32_t chunk_length = read_u32(data + offset);
+    uint32_t chunk_type = read_u32(data + offset + 4);
+    offset += GLB_CHUNK_HEADER_SIZE;
+    if (chunk_length > length - offset)
+    {
+      return false;
+    }
+
+    Membuf view = {
+      .data = data + offset,
+      .size = chunk_length,
+      .kind = MEMBUF_VIEW,
+    };
+    if (chunk == 0)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_STRING);
-      parser->asset.version = TOKEN_MAKE_STRING();
-      NEXT_TOKEN();
+      if (chunk_type != GLB_CHUNK_JSON)
+      {
+        return false;
+      }
+      parser->json = view;
     }
-    else if (TOKEN_STRCMP("generator"))
+    else if (chunk == 1 && chunk_type == GLB_CHUNK_BIN)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_STRING);
-      parser->asset.generator = TOKEN_MAKE_STRING();
-      NEXT_TOKEN();
+      parser->bin = view;
     }
+    /* Unknown chunks are skipped, chunks are padded to 4 bytes. */
+    offset += (chunk_length + 3) & ~(size_t) 3;
   }
 
-  return true;
+  return parser->json.data != data;
 }
 
-const char *make_token_string(const uint8_t *buf, jsmntok_t tok)
+static uint32_t read_u32(const uint8_t *p)
 {
-  size_t sz = tok.end - tok.start;
-  char *str = MIUR_ARR(char, sz + 1);
-  memcpy(str, buf + tok.start, sz);
-  str[sz] = '\0';
-  return str;
+  return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 |
+    (uint32_t) p[3] << 24;
 }
 
-bool assert_type(const uint8_t *buf, jsmntok_t tok, int type)
+static GLTFLoad *load_create(StaticModel *out, const char *filename,
+                             JobSystem *jobs, IoService *io)
 {
-  switch (type)
+  GLTFLoad *load = MIUR_NEW(GLTFLoad);
+  if (load == NULL)
+  {
+    return NULL;
+  }
+  /* The schemas are shared by every load, index them before any job runs. */
+  json_schema_prepare(&gltf_schema);
+
+  load->out = out;
+  load->jobs = jobs;
+  load->io = io;
+  memset(out, 0, sizeof(StaticModel));
+
+  /* The filename has to outlive the caller's string. */
+  GLTFParser *parser = &load->parser;
+  arena_create(&parser->arena, 0);
+  size_t filename_len = strlen(filename);
+  char *name = (char *) arena_alloc(&parser->arena, filename_len + 1);
+  memcpy(name, filename, filename_len + 1);
+  parser->filename = name;
+
+  size_t extension_len = strlen(MESH_CACHE_EXTENSION);
+  load->cache_path = (char *) arena_alloc(&parser->arena,
+                                          filename_len + extension_len + 1);
+  memcpy(load->cache_path, filename, filename_len);
+  memcpy(load->cache_path + filename_len, MESH_CACHE_EXTENSION,
+         extension_len + 1);
+
+  const char *c = name + filename_len;
+  while (c != name && c[-1] != '\\' && c[-1] != '/')
   {
-  case JSMN_UNDEFINED:
-  case JSMN_OBJECT:
-  case JSMN_ARRAY:
-  case JSMN_STRING:
-    return (type == tok.type);
-  case JSMN_NUMBER:
-    return (tok.type == JSMN_PRIMITIVE) && (isdigit(buf[tok.start]) ||
-                                            buf[tok.start == '-']);
-  case JSMN_BOOL:
-    return (tok.type == JSMN_PRIMITIVE) && (buf[tok.start] == 't' ||
-                                            buf[tok.start] == 'f');
-  case JSMN_NULL:
-    return (tok.type == JSMN_PRIMITIVE) && buf[tok.start] == 'n';
+    c--;
   }
-  return false;
+  parser->local_prefix_len = c - name;
+  return load;
 }
 
-int64_t
-token_to_int(const uint8_t *buf, jsmntok_t tok)
+static void load_dispatch(GLTFLoad *load, JobFunction function, void *ud)
 {
-  int64_t ret = 0;
-  for (int i = tok.start; i < tok.end; i++)
+  if (load->jobs == NULL)
   {
-    ret *= 10;
-    ret += buf[i] - '0';
+    function(ud);
+    return;
   }
-  return ret;
 
+  Job job = { function, ud };
+  job_run(load->jobs, &job, 1, NULL);
 }
 
-bool parse_scene(GLTFParser *parser, GLTFScene *scene)
+/* Ends the load, a waiter may free it as soon as `done` is signalled. */
+static void load_finish(GLTFLoad *load)
 {
-  ASSERT_TOKEN(JSMN_OBJECT);
-
-  int fields = TOKEN_SIZE();
-  NEXT_TOKEN();
-
-  for (int i = 0; i < fields; i++)
+  bool result = atomic_i32_load(&load->failed) == 0 &&
+    compute_world(load->out);
+  if (!result)
   {
+    gltf_model_destroy(load->out);
+  }
+  else if (!load->cached)
+  {
+    report_optimization(load);
+    write_cache(load);
+  }
 
-    ASSERT_KEY();
-    if (TOKEN_STRCMP("nodes"))
+  for (size_t i = 0; i < load->image_task_count; i++)
+  {
+    if (load->image_tasks[i].file.data != NULL)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_ARRAY);
-
-      scene->node_count = TOKEN_SIZE();
-      scene->nodes = MIUR_ARR(int, scene->node_count);
-
-      NEXT_TOKEN();
-
-      for (int i = 0; i < scene->node_count; i++)
-      {
-        ASSERT_TOKEN(JSMN_NUMBER);
-        scene->nodes[i] = TOKEN_INT();
-        NEXT_TOKEN();
-      }
+      membuf_destroy(&load->image_tasks[i].file);
     }
   }
-  return true;
-}
-
-bool parse_node(GLTFParser *parser, GLTFNode *node)
-{
-  node->name = NULL;
-  node->mesh = 0;
-
-  ASSERT_TOKEN(JSMN_OBJECT);
-  int fields = TOKEN_SIZE();
-  NEXT_TOKEN();
-
-  for (int i = 0; i < fields; i++)
+  for (size_t i = 0; load->buffer_tasks != NULL &&
+       i < load->parser.buffer_count; i++)
   {
-    ASSERT_KEY();
-
-    if (TOKEN_STRCMP("name"))
-    {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_STRING);
-      node->name = TOKEN_MAKE_STRING();
-      NEXT_TOKEN();
-    } else if (TOKEN_STRCMP("mesh"))
-    {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_NUMBER);
-      node->mesh = TOKEN_INT();
-      NEXT_TOKEN();
-    } else if (TOKEN_STRCMP("scale"))
-    {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_ARRAY);
-      int scale_fields = TOKEN_SIZE();
-      NEXT_TOKEN();
-      for (int j = 0; j < scale_fields; j++)
-      {
-        ASSERT_TOKEN(JSMN_NUMBER);
-        node->scale[j] = TOKEN_FLOAT();
-        NEXT_TOKEN();
-      }
-    } else
+    if (load->buffer_tasks[i].reading)
     {
-      MIUR_LOG_INFO("Unkown mesh field: '%s'", TOKEN_MAKE_STRING());
-      return false;
+      io_request_release(&load->buffer_tasks[i].request);
     }
   }
-  return true;
+  parser_destroy(&load->parser);
+  MIUR_FREE(load->buffer_tasks);
+  MIUR_FREE(load->prim_tasks);
+  MIUR_FREE(load->decode_tasks);
+  MIUR_FREE(load->image_tasks);
+
+  load->result = result;
+  if (load->jobs != NULL)
+  {
+    job_counter_signal(load->jobs, &load->done);
+  }
 }
 
-bool parse_mesh(GLTFParser *parser, GLTFMesh *mesh)
+static void parse_job(void *ud)
 {
-  ASSERT_TOKEN(JSMN_OBJECT);
-  int fields = TOKEN_SIZE();
-  NEXT_TOKEN();
+  GLTFLoad *load = (GLTFLoad *) ud;
+  GLTFParser *parser = &load->parser;
+  const char *filename = parser->filename;
+  JsonDecoder dec;
+  ParseError error;
 
-  for (int i = 0; i < fields; i++)
+  if (!archive_map_file(&parser->buf, filename, MEMBUF_MAP_SEQUENTIAL))
   {
-    ASSERT_KEY();
-    if (TOKEN_STRCMP("primitives"))
-    {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_ARRAY);
-      mesh->primitive_count = TOKEN_SIZE();
-      mesh->primitives = MIUR_ARR(GLTFPrimitive, mesh->primitive_count);
+    goto fail;
+  }
 
-      NEXT_TOKEN();
+  if (load_cached(load))
+  {
+    load_finish(load);
+    return;
+  }
 
-      for (int i = 0; i < mesh->primitive_count; i++)
-      {
-        if (!parse_primitive(parser, &mesh->primitives[i]))
-        {
-          return false;
-        }
-      }
-    } else if (TOKEN_STRCMP("name"))
-    {
+  if (!split_glb(parser))
+  {
+    MIUR_LOG_ERR("'%s' is not a valid GLB file", filename);
+    goto fail;
+  }
 
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_STRING);
-      mesh->name = TOKEN_MAKE_STRING();
-      NEXT_TOKEN();
-    }
-    else {
-      MIUR_LOG_INFO("unknown mesh field: %s", TOKEN_MAKE_STRING());
-      return false;
+  if (!json_stream_init(&parser->stream, parser->json))
+  {
+    MIUR_LOG_ERR("'%s' is not valid JSON", filename);
+    goto fail;
+  }
 
-    }
+  json_decoder_init(&dec, &parser->stream, &parser->arena, &error);
+  if (!json_decode_object(&dec, &gltf_schema, parser))
+  {
+    MIUR_LOG_ERR("%s:%d:%d: %s", filename, error.line, error.col, error.msg);
+    goto fail;
   }
-  return true;
+
+  start_buffers(load);
+  return;
+
+fail:
+  atomic_i32_store(&load->failed, 1);
+  load_finish(load);
 }
 
-bool parse_primitive(GLTFParser *parser, GLTFPrimitive *primitive)
+/*
+ * Starts a task per buffer.  The extra count held until every buffer is
+ * issued keeps early completions from starting the next stage.
+ */
+static void start_buffers(GLTFLoad *load)
 {
-  ASSERT_TOKEN(JSMN_OBJECT);
-  int fields = TOKEN_SIZE();
-  NEXT_TOKEN();
-  primitive->tex_coords_alloc = 0;
-  primitive->tex_coords = NULL;
+  GLTFParser *parser = &load->parser;
+  load->buffer_tasks = MIUR_ARR(GLTFBufferTask, parser->buffer_count);
+  atomic_i32_store(&load->pending, (int32_t) parser->buffer_count + 1);
 
-  for (int i = 0; i < fields; i++) {
-    ASSERT_KEY();
+  for (size_t i = 0; i < parser->buffer_count; i++)
+  {
+    GLTFBuffer *buffer = &parser->buffers[i];
+    GLTFBufferTask *task = &load->buffer_tasks[i];
+    task->load = load;
+    task->index = i;
 
-    if (TOKEN_STRCMP("attributes"))
+    if (buffer->uri == NULL)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_OBJECT);
-      int fields = TOKEN_SIZE();
-      NEXT_TOKEN();
-
-      for (int j = 0; j < fields; j++)
+      /* Only the first buffer of a GLB may leave out its URI. */
+      bool valid = i == 0 && parser->bin.data != NULL;
+      if (!valid)
       {
-        ASSERT_KEY();
+        MIUR_LOG_ERR("Expected URI for buffer %zu", i);
+      }
+      else if ((size_t) buffer->byte_length > parser->bin.size)
+      {
+        MIUR_LOG_ERR("GLB BIN chunk is smaller than buffer 0");
+        valid = false;
+      }
+      buffer->buf = parser->bin;
+      buffer_done(load, valid);
+      continue;
+    }
 
-        if (TOKEN_STRCMP("POSITION"))
-        {
-          NEXT_TOKEN();
-          ASSERT_TOKEN(JSMN_NUMBER);
-          primitive->position = TOKEN_INT();
-          NEXT_TOKEN();
-        } else if (TOKEN_STRCMP("NORMAL"))
-        {
-          NEXT_TOKEN();
-          ASSERT_TOKEN(JSMN_NUMBER);
-          primitive->normal = TOKEN_INT();
-          NEXT_TOKEN();
-        } else if (TOKEN_STRCMP("TANGENT"))
-        {
-          NEXT_TOKEN();
-          ASSERT_TOKEN(JSMN_NUMBER);
-          primitive->tangent = TOKEN_INT();
-          NEXT_TOKEN();
-        }
-        else if (TOKEN_PREFIX("TEXCOORD_"))
-        {
-          int num = GET_INDEX_WITH_PREFIX("TEXCOORD_");
-          if (primitive->tex_coords_alloc <= num)
-          {
-            primitive->tex_coords_alloc = roundup(num);
-            if (primitive->tex_coords == NULL)
-            {
-              primitive->tex_coords = MIUR_ARR(int,
-                                               primitive->tex_coords_alloc);
-            }
-            primitive->tex_coords = MIUR_REALLOC(int, primitive->tex_coords,
-                                            primitive->tex_coords_alloc);
-          }
-          NEXT_TOKEN();
-          ASSERT_TOKEN(JSMN_NUMBER);
-          primitive->tex_coords[num] = TOKEN_INT();
-          NEXT_TOKEN();
-        }
-        else {
-          MIUR_LOG_INFO("Unknown primitive field '%s'", TOKEN_MAKE_STRING());
-          return false;
-        }
+    char *path;
+    if (!uri_path(parser, buffer->uri, &path))
+    {
+      buffer_done(load, false);
+      continue;
+    }
+    task->path = path;
 
-      }
-    } else if (TOKEN_STRCMP("indices"))
+    /* Files packed in a mounted archive are already mapped. */
+    if (load->io != NULL && !archive_resolve(path, &buffer->buf))
+    {
+      task->reading = true;
+      io_request_init(&task->request, path);
+      task->request.callback = buffer_read_callback;
+      task->request.ud = task;
+      io_submit(load->io, &task->request, 1);
+    }
+    else
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_NUMBER);
-      primitive->indices = TOKEN_INT();
-      NEXT_TOKEN();
+      load_dispatch(load, map_buffer_job, task);
     }
   }
-  return true;
+
+  buffer_done(load, true);
 }
 
-int roundup(int base)
+/*
+ * Decodes a buffer or image URI, in place, into a path relative to the glTF
+ * file.
+ */
+static bool uri_path(GLTFParser *parser, const char *uri, char **path_out)
 {
-  int ret = 2;
-  while (ret < base)
+  if (!uri_decode((char *) uri))
   {
-    ret *= 2;
+    MIUR_LOG_ERR("Malformed URI '%s'", uri);
+    return false;
   }
-  return ret;
-}
 
-bool json_prefix(const uint8_t *buf, jsmntok_t tok, const char *prefix)
-{
-  int len = strlen(prefix);
-  int tok_len = tok.end - tok.start;
+  size_t uri_len = strlen(uri);
+  size_t full_name_len = parser->local_prefix_len + uri_len;
 
-  return len <= tok_len && strncmp(buf + tok.start, prefix, len) == 0;
+  char *full_name = (char *) arena_alloc(&parser->arena, full_name_len + 1);
+  memcpy(full_name, parser->filename, parser->local_prefix_len);
+  memcpy(full_name + parser->local_prefix_len, uri, uri_len);
+  full_name[full_name_len] = '\0';
+  *path_out = full_name;
+  return true;
 }
 
-int json_get_index_with_prefix(const uint8_t *buf, jsmntok_t tok,
-                               const char *prefix)
+static void map_buffer_job(void *ud)
 {
-  int len = tok.end - tok.start;
-  const char *c = buf + tok.start;
-  while (*c == *prefix)
+  GLTFBufferTask *task = (GLTFBufferTask *) ud;
+  GLTFBuffer *buffer = &task->load->parser.buffers[task->index];
+  bool success = true;
+
+  /* Buffers already resolved from an archive only need checking. */
+  if (buffer->buf.data == NULL &&
+      !archive_map_file(&buffer->buf, task->path, MEMBUF_MAP_WILLNEED))
   {
-    c++;
-    prefix++;
-    len--;
+    MIUR_LOG_ERR("Couldn't open buffer file '%s'", task->path);
+    success = false;
   }
 
-  int ret = 0;
-  while (len)
+  if (success && (size_t) buffer->byte_length > buffer->buf.size)
   {
-    ret *= 10;
-    ret += *c - '0';
-    len--;
-    c++;
+    MIUR_LOG_ERR("Buffer file '%s' is smaller than its byteLength",
+                 buffer->uri);
+    success = false;
   }
-
-  return ret;
+  buffer_done(task->load, success);
 }
 
-GLTFComponentType component_type_map[] = {
-  [5120] = GLTF_COMPONENT_TYPE_I8,
-  [5121] = GLTF_COMPONENT_TYPE_U8,
-  [5122] = GLTF_COMPONENT_TYPE_I16,
-  [5123] = GLTF_COMPONENT_TYPE_U16,
-  [5125] = GLTF_COMPONENT_TYPE_U32,
-  [5126] = GLTF_COMPONENT_TYPE_FLOAT,
-};
+static void buffer_read_callback(IoRequest *req)
+{
+  GLTFBufferTask *task = (GLTFBufferTask *) req->ud;
+  GLTFBuffer *buffer = &task->load->parser.buffers[task->index];
+  bool success = req->status == IO_DONE;
 
-bool parse_accessor(GLTFParser *parser, GLTFAccessor *accessor)
+  if (!success)
+  {
+    MIUR_LOG_ERR("Couldn't read buffer file '%s'", req->path);
+  }
+  else if ((size_t) buffer->byte_length > req->bytes_read)
+  {
+    MIUR_LOG_ERR("Buffer file '%s' is smaller than its byteLength",
+                 buffer->uri);
+    success = false;
+  }
+  else
+  {
+    buffer->buf.data = req->data;
+    buffer->buf.size = req->bytes_read;
+    buffer->buf.kind = MEMBUF_VIEW;
+  }
+  buffer_done(task->load, success);
+}
+
+static void buffer_done(GLTFLoad *load, bool success)
 {
-  ASSERT_TOKEN(JSMN_OBJECT);
+  if (!success)
+  {
+    atomic_i32_store(&load->failed, 1);
+  }
+  if (atomic_i32_add(&load->pending, -1) == 0)
+  {
+    load_dispatch(load, prepare_job, load);
+  }
+}
 
-  int fields = TOKEN_SIZE();
-  NEXT_TOKEN();
+/*
+ * Splits every stream into chunks of GLTF_DECODE_CHUNK elements and queues
+ * them in one batch.  The load may finish before this returns.
+ */
+static void prepare_job(void *ud)
+{
+  GLTFLoad *load = (GLTFLoad *) ud;
+  GLTFParser *parser = &load->parser;
 
-  for (int i = 0; i < fields; i++)
+  /* Hashed in the order load_cached checks them. */
+  load->source_hash = hash3(parser->buf.data, parser->buf.size, 0);
+  for (size_t i = 0; i < parser->buffer_count; i++)
   {
-    ASSERT_KEY();
-    if (TOKEN_STRCMP("bufferView"))
+    const Membuf *buf = &parser->buffers[i].buf;
+    if (parser->buffers[i].uri != NULL && buf->data != NULL)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_NUMBER);
-      accessor->buffer_view = TOKEN_INT();
-      NEXT_TOKEN();
-    } else if (TOKEN_STRCMP("componentType"))
+      load->source_hash = hash3(buf->data, buf->size, load->source_hash);
+    }
+  }
+
+  if (atomic_i32_load(&load->failed) != 0 || !translate_to_model(load))
+  {
+    atomic_i32_store(&load->failed, 1);
+    load_finish(load);
+    return;
+  }
+  if (load->prim_task_count == 0 && load->image_task_count == 0)
+  {
+    load_finish(load);
+    return;
+  }
+
+  size_t task_count = 0;
+  for (size_t i = 0; i < load->prim_task_count; i++)
+  {
+    GLTFPrimitiveTask *prim = &load->prim_tasks[i];
+    int32_t chunks = 0;
+    for (uint32_t j = 0; j < prim->stream_count; j++)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_NUMBER);
-      accessor->component_type = component_type_map[TOKEN_INT()];
-      NEXT_TOKEN();
-    } else if (TOKEN_STRCMP("byteOffset"))
+      /* Empty streams still get one task, so every primitive finalizes. */
+      uint32_t count = prim->streams[j].count;
+      chunks += count == 0 ? 1 :
+        (count + GLTF_DECODE_CHUNK - 1) / GLTF_DECODE_CHUNK;
+    }
+    atomic_i32_store(&prim->pending, chunks);
+    task_count += chunks;
+  }
+
+  load->decode_tasks = MIUR_ARR(GLTFDecodeTask, task_count + 1);
+  load->decode_task_count = task_count;
+  size_t image_count = load->image_task_count;
+  Job *descs = load->jobs != NULL ?
+    MIUR_ARR(Job, task_count + image_count) : NULL;
+  size_t n = 0;
+  for (size_t i = 0; i < load->prim_task_count; i++)
+  {
+    GLTFPrimitiveTask *prim = &load->prim_tasks[i];
+    for (uint32_t j = 0; j < prim->stream_count; j++)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_NUMBER);
-      accessor->byte_offset = TOKEN_INT();
-      NEXT_TOKEN();
-    } else if (TOKEN_STRCMP("count"))
+      const GLTFStream *stream = &prim->streams[j];
+      uint32_t first = 0;
+      do
+      {
+        GLTFDecodeTask *task = &load->decode_tasks[n];
+        task->prim = prim;
+        task->stream = stream;
+        task->first = first;
+        task->count = stream->count - first < GLTF_DECODE_CHUNK ?
+          stream->count - first : GLTF_DECODE_CHUNK;
+        if (descs != NULL)
+        {
+          descs[n].function = decode_job;
+          descs[n].ud = task;
+        }
+        first += task->count;
+        n++;
+      } while (first < stream->count);
+    }
+  }
+  atomic_i32_store(&load->pending,
+                   (int32_t) (load->prim_task_count + image_count));
+
+  /* Images go last, they're the longest tasks but don't hold up meshes. */
+  GLTFImageTask *images = load->image_tasks;
+  if (descs != NULL)
+  {
+    for (size_t i = 0; i < image_count; i++)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_NUMBER);
-      accessor->count = TOKEN_INT();
-      NEXT_TOKEN();
-    } else if (TOKEN_STRCMP("max"))
+      descs[task_count + i].function = image_job;
+      descs[task_count + i].ud = &images[i];
+    }
+    job_run(load->jobs, descs, task_count + image_count, NULL);
+    MIUR_FREE(descs);
+    return;
+  }
+  GLTFDecodeTask *tasks = load->decode_tasks;
+  for (size_t i = 0; i < task_count; i++)
+  {
+    decode_job(&tasks[i]);
+  }
+  for (size_t i = 0; i < image_count; i++)
+  {
+    image_job(&images[i]);
+  }
+}
+
+static void decode_job(void *ud)
+{
+  GLTFDecodeTask *task = (GLTFDecodeTask *) ud;
+  GLTFPrimitiveTask *prim = task->prim;
+  const GLTFStream *stream = task->stream;
+  const uint8_t *src = stream->src + (size_t) task->first * stream->stride;
+
+  if (stream->indices)
+  {
+    uint32_t *dst = (uint32_t *) stream->dst + task->first;
+    uint32_t max = convert_indices_u32(dst, src, task->count, stream->type);
+    if (task->count > 0 && max >= prim->mesh->vert_count)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_ARRAY);
-      int nums = TOKEN_SIZE();
-      NEXT_TOKEN();
-      for (int j = 0; j < nums; j++)
-      {
-        ASSERT_TOKEN(JSMN_NUMBER);
-        accessor->max[j] = TOKEN_FLOAT();
-        NEXT_TOKEN();
-      }
-    } else if (TOKEN_STRCMP("min"))
+      MIUR_LOG_ERR("index %" PRIu32 " is out of range", max);
+      atomic_i32_store(&prim->load->failed, 1);
+    }
+  }
+  else
+  {
+    float *dst = (float *) stream->dst +
+      (size_t) task->first * stream->components;
+    convert_to_float(dst, src, stream->stride, task->count,
+                     stream->components, stream->type, stream->normalized);
+  }
+
+  if (atomic_i32_add(&prim->pending, -1) == 0)
+  {
+    finalize_primitive(prim);
+  }
+}
+
+static void finalize_primitive(GLTFPrimitiveTask *task)
+{
+  GLTFLoad *load = task->load;
+  StaticMesh *mesh = task->mesh;
+
+  /* A failed load is thrown away, its indices may not even be valid. */
+  if (atomic_i32_load(&load->failed) != 0)
+  {
+    goto done;
+  }
+
+  if (task->prim->indices < 0)
+  {
+    for (uint32_t i = 0; i < mesh->index_count; i++)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_ARRAY);
-      int nums = TOKEN_SIZE();
-      NEXT_TOKEN();
+      mesh->indices[i] = i;
+    }
+  }
 
-      for (int j = 0; j < nums; j++)
-      {
-        ASSERT_TOKEN(JSMN_NUMBER);
+  if (mesh->verts_norm == NULL)
+  {
+    generate_normals(mesh);
+  }
+  if (aabb_is_empty(&mesh->bounds))
+  {
+    aabb_from_points(&mesh->bounds, mesh->verts_pos, mesh->vert_count);
+  }
+  sphere_from_points(&mesh->sphere, mesh->verts_pos, mesh->vert_count);
 
-        accessor->min[j] = TOKEN_FLOAT();
-        NEXT_TOKEN();
+  /* Only cooking gets here, cached meshes were optimized before writing. */
+  if (!static_mesh_optimize(mesh, &task->report))
+  {
+    MIUR_LOG_WARN("Couldn't optimize a mesh of '%s'", load->parser.filename);
+  }
+  if (!static_mesh_build_meshlets(mesh))
+  {
+    MIUR_LOG_WARN("Couldn't build meshlets for a mesh of '%s'",
+                  load->parser.filename);
+  }
+  if (!static_mesh_build_lods(mesh))
+  {
+    MIUR_LOG_WARN("Couldn't build levels of detail for a mesh of '%s'",
+                  load->parser.filename);
+  }
 
-      }
-    } else if (TOKEN_STRCMP("type"))
+done:
+  task_done(load);
+}
+
+/*
+ * An image that can't be read or decoded is left empty, one that can't be
+ * compressed is kept as RGBA8, both with a warning.  KTX2 images are
+ * already cooked and kept as they are.
+ */
+static void image_job(void *ud)
+{
+  GLTFImageTask *task = (GLTFImageTask *) ud;
+  GLTFLoad *load = task->load;
+  size_t index = (size_t) (task - load->image_tasks);
+  Texture decoded;
+
+  if (task->path != NULL)
+  {
+    if (!archive_resolve(task->path, &task->file) &&
+        !archive_map_file(&task->file, task->path, MEMBUF_MAP_SEQUENTIAL))
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_STRING);
-      if (TOKEN_STRCMP("SCALAR"))
-      {
-        accessor->type = GLTF_TYPE_SCALAR;
-      } else if (TOKEN_STRCMP("VEC2"))
-      {
-        accessor->type = GLTF_TYPE_VEC2;
-      } else if (TOKEN_STRCMP("VEC3"))
-      {
-        accessor->type = GLTF_TYPE_VEC3;
-      } else if (TOKEN_STRCMP("VEC4"))
-      {
-        accessor->type = GLTF_TYPE_VEC4;
-      } else if (TOKEN_STRCMP("MAT2"))
-      {
-        accessor->type = GLTF_TYPE_MAT2;
-      } else if (TOKEN_STRCMP("MAT3"))
-      {
-        accessor->type = GLTF_TYPE_MAT3;
-      } else if (TOKEN_STRCMP("MAT4"))
+      MIUR_LOG_WARN("Couldn't open image file '%s'", task->path);
+      goto done;
+    }
+    task->data = task->file.data;
+    task->size = task->file.size;
+  }
+  if (task->data == NULL || task->size == 0 ||
+      atomic_i32_load(&load->failed) != 0)
+  {
+    goto done;
+  }
+
+  if (ktx_is_ktx2(task->data, task->size))
+  {
+    if (!ktx_decode(task->texture, task->data, task->size))
+    {
+      MIUR_LOG_WARN("Couldn't read KTX2 image %zu of '%s'", index,
+                    load->parser.filename);
+    }
+    goto done;
+  }
+  if (!texture_decode(&decoded, task->data, task->size, task->srgb,
+                      GLTF_MIP_FILTER))
+  {
+    MIUR_LOG_WARN("Couldn't decode image %zu of '%s'", index,
+                  load->parser.filename);
+    goto done;
+  }
+  /* BC5 keeps a normal's x and y, z is rebuilt when it's sampled. */
+  TextureFormat format = task->srgb ? TEXTURE_FORMAT_BC7_SRGB :
+    task->normal ? TEXTURE_FORMAT_BC5 : TEXTURE_FORMAT_BC7;
+  if (texture_compress(task->texture, &decoded, format, GLTF_TEXTURE_QUALITY,
+                       load->jobs))
+  {
+    texture_destroy(&decoded);
+  }
+  else
+  {
+    MIUR_LOG_WARN("Couldn't compress image %zu of '%s'", index,
+                  load->parser.filename);
+    *task->texture = decoded;
+  }
+
+done:
+  task_done(load);
+}
+
+/* Counts off a primitive or image, the last one ends the load. */
+static void task_done(GLTFLoad *load)
+{
+  if (atomic_i32_add(&load->pending, -1) == 0)
+  {
+    load_finish(load);
+  }
+}
+
+/*
+ * Uses the cooked cache if the model file, already mapped, and the buffers
+ * it was cooked from still hash to what it recorded.
+ */
+static bool load_cached(GLTFLoad *load)
+{
+  GLTFParser *parser = &load->parser;
+  MeshCache cache;
+  if (!mesh_cache_open(&cache, load->cache_path))
+  {
+    return false;
+  }
+
+  uint64_t hash = hash3(parser->buf.data, parser->buf.size, 0);
+  for (const char *dep = mesh_cache_next_dependency(&cache, NULL);
+       dep != NULL; dep = mesh_cache_next_dependency(&cache, dep))
+  {
+    size_t dep_len = strlen(dep);
+    char *path = (char *) arena_alloc(&parser->arena,
+                                      parser->local_prefix_len + dep_len + 1);
+    if (path == NULL)
+    {
+      mesh_cache_close(&cache);
+      return false;
+    }
+    memcpy(path, parser->filename, parser->local_prefix_len);
+    memcpy(path + parser->local_prefix_len, dep, dep_len + 1);
+
+    Membuf buf;
+    if (!archive_map_file(&buf, path, MEMBUF_MAP_SEQUENTIAL))
+    {
+      mesh_cache_close(&cache);
+      return false;
+    }
+    hash = hash3(buf.data, buf.size, hash);
+    membuf_destroy(&buf);
+  }
+
+  if (hash != cache.header->source_hash)
+  {
+    MIUR_LOG_INFO("'%s' is out of date", load->cache_path);
+    mesh_cache_close(&cache);
+    return false;
+  }
+
+  if (!mesh_cache_to_model(&cache, load->out))
+  {
+    MIUR_LOG_WARN("'%s' failed to decode", load->cache_path);
+    return false;
+  }
+  load->cached = true;
+  return true;
+}
+
+/* Sums the per primitive reports, one line per cooked model. */
+static void report_optimization(GLTFLoad *load)
+{
+  VertexCacheStats before = { 0 }, after = { 0 };
+  for (size_t i = 0; i < load->prim_task_count; i++)
+  {
+    const MeshOptReport *report = &load->prim_tasks[i].report;
+    before.misses += report->before.misses;
+    before.triangles += report->before.triangles;
+    before.vertices += report->before.vertices;
+    after.misses += report->after.misses;
+    after.triangles += report->after.triangles;
+    after.vertices += report->after.vertices;
+  }
+  if (before.triangles == 0 || after.triangles == 0)
+  {
+    return;
+  }
+
+  MIUR_LOG_INFO("Optimized '%s': ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+                load->parser.filename,
+                (double) before.misses / before.triangles,
+                (double) after.misses / after.triangles,
+                (double) before.misses / before.vertices,
+                (double) after.misses / after.vertices);
+}
+
+/*
+ * A cache that can't be written, e.g. in a read only tree, only warns.  The
+ * image files are hashed here, after their tasks have mapped them.
+ */
+static void write_cache(GLTFLoad *load)
+{
+  GLTFParser *parser = &load->parser;
+  const char **deps = MIUR_ARR(const char *, parser->buffer_count +
+                               load->image_task_count + 1);
+  if (deps == NULL)
+  {
+    return;
+  }
+
+  size_t dep_count = 0;
+  for (size_t i = 0; i < parser->buffer_count; i++)
+  {
+    if (parser->buffers[i].uri != NULL)
+    {
+      deps[dep_count++] = parser->buffers[i].uri;
+    }
+  }
+  /* Image files follow the buffers, in the order translate_images set. */
+  for (size_t i = 0; i < load->image_task_count; i++)
+  {
+    const GLTFImageTask *task = &load->image_tasks[i];
+    if (task->path == NULL)
+    {
+      continue;
+    }
+    deps[dep_count++] = task->path + parser->local_prefix_len;
+    if (task->file.data != NULL)
+    {
+      load->source_hash = hash3(task->file.data, task->file.size,
+                                load->source_hash);
+    }
+  }
+
+  if (!mesh_cache_write(load->cache_path, load->out, load->source_hash, deps,
+                        dep_count))
+  {
+    MIUR_LOG_WARN("Couldn't write mesh cache '%s'", load->cache_path);
+  }
+  MIUR_FREE(deps);
+}
+
+/* World matrices aren't cached, they're cheap to derive on every load. */
+static bool compute_world(StaticModel *model)
+{
+  model->node_world = MIUR_ARR_UNINIT(float,
+                                      (size_t) model->node_count * 16 + 1);
+  model->instance_bounds = MIUR_ARR_UNINIT(Aabb, model->instance_count + 1);
+  if (model->node_world == NULL || model->instance_bounds == NULL)
+  {
+    return false;
+  }
+  transform_compute_world(model->node_world, model->node_local,
+                          model->node_parents, model->node_count);
+  for (uint32_t i = 0; i < model->instance_count; i++)
+  {
+    const MeshInstance *instance = &model->instances[i];
+    aabb_transform(&model->instance_bounds[i],
+                   &model->meshes[instance->mesh].bounds,
+                   &model->node_world[(size_t) instance->node * 16]);
+  }
+  return true;
+}
+
+/* URIs may percent-encode reserved characters, e.g. "my%20mesh.bin". */
+bool uri_decode(char *uri)
+{
+  char *out = uri;
+  for (const char *c = uri; *c != '\0'; c++)
+  {
+    if (*c == '%')
+    {
+      int hi = hex_value(c[1]);
+      int lo = hi < 0 ? -1 : hex_value(c[2]);
+      if (lo < 0)
       {
-        accessor->type = GLTF_TYPE_MAT4;
-      } else {
-        MIUR_LOG_INFO("unknown type '%s'", TOKEN_MAKE_STRING());
         return false;
       }
-      NEXT_TOKEN();
-    } else if (TOKEN_STRCMP("name"))
-    {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_STRING);
-      accessor->name = TOKEN_MAKE_STRING();
-      NEXT_TOKEN();
-    } else {
-      MIUR_LOG_INFO("unknown accessor field '%s'", TOKEN_MAKE_STRING());
-      return false;
+      *out++ = (char) ((hi << 4) | lo);
+      c += 2;
+    }
+    else
+    {
+      *out++ = *c;
     }
   }
+  *out = '\0';
   return true;
 }
 
-float token_to_float(const uint8_t *buf, jsmntok_t tok)
+int hex_value(char c)
 {
-  const char *c = buf + tok.start;
-  int len = tok.end - tok.start;
-  float sign = *c == '-' ? -1.0 : 1.0;
-  bool past_point = false;
-  float total = 0.0;
-  float multiplier = 10.0f;
-  while (len)
+  if (c >= '0' && c <= '9')
+  {
+    return c - '0';
+  }
+  else if (c >= 'a' && c <= 'f')
+  {
+    return c - 'a' + 10;
+  }
+  else if (c >= 'A' && c <= 'F')
   {
-    if (*c == '.')
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+void parser_destroy(GLTFParser *parser)
+{
+  for (size_t i = 0; i < parser->buffer_count; i++)
+  {
+    if (parser->buffers[i].buf.data != NULL)
     {
-      past_point = true;
-      multiplier = 0.1f;
-    } else {
-      if (past_point) {
-        total += ((float) (*c - '0')) * multiplier;
-        multiplier /= 10.0f;
-      } else {
-        total *= multiplier;
-        total += ((float) (*c - '0'));
-      }
+      membuf_destroy(&parser->buffers[i].buf);
     }
-    c++;
-    len--;
   }
-  return total;
+  json_stream_deinit(&parser->stream);
+  arena_destroy(&parser->arena);
+  membuf_destroy(&parser->buf);
 }
 
-bool parse_buffer_view(GLTFParser *parser, GLTFBufferView *view)
+/*
+ * Flattens the node hierarchy, then validates every primitive of the meshes
+ * it uses and allocates one mesh for each, however many nodes share it.
+ * Decoding happens later in the tasks set up from the streams recorded here.
+ */
+bool
+translate_to_model(GLTFLoad *load)
 {
-  ASSERT_TOKEN(JSMN_OBJECT);
-  int fields = TOKEN_SIZE();
-  NEXT_TOKEN();
+  GLTFParser *parser = &load->parser;
+  StaticModel *out = load->out;
+  int32_t *order;
+  if (!flatten_nodes(parser, out, &order))
+  {
+    return false;
+  }
 
-  for (int i = 0; i < fields; i++)
+  /* First mesh of each glTF mesh, in order of first use. */
+  int32_t *first_mesh = (int32_t *) arena_alloc(&parser->arena,
+                                                (parser->mesh_count + 1) *
+                                                sizeof(int32_t));
+  if (first_mesh == NULL)
+  {
+    return false;
+  }
+  for (size_t i = 0; i < parser->mesh_count; i++)
   {
-    ASSERT_KEY();
+    first_mesh[i] = -1;
+  }
 
-    if (TOKEN_STRCMP("buffer"))
+  size_t mesh_count = 0;
+  size_t instance_count = 0;
+  for (uint32_t i = 0; i < out->node_count; i++)
+  {
+    GLTFNode *node = &parser->nodes[order[i]];
+    if (node->mesh < 0)
+    {
+      continue;
+    }
+    if ((size_t) node->mesh >= parser->mesh_count)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_NUMBER);
-      view->buffer = TOKEN_INT();
-      NEXT_TOKEN();
-    } else if (TOKEN_STRCMP("byteLength"))
+      MIUR_LOG_ERR("node %d references missing mesh %d", order[i],
+                   node->mesh);
+      return false;
+    }
+    size_t primitive_count = parser->meshes[node->mesh].primitive_count;
+    if (first_mesh[node->mesh] < 0)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_NUMBER);
-      view->byte_length = TOKEN_INT();
-      NEXT_TOKEN();
-    } else if (TOKEN_STRCMP("byteStride"))
+      first_mesh[node->mesh] = (int32_t) mesh_count;
+      mesh_count += primitive_count;
+    }
+    instance_count += primitive_count;
+  }
+
+  /* Every primitive becomes its own mesh, they each have a material. */
+  out->meshes = MIUR_ARR(StaticMesh, mesh_count);
+  out->mesh_count = (uint32_t) mesh_count;
+  out->instances = MIUR_ARR(MeshInstance, instance_count);
+  out->instance_count = (uint32_t) instance_count;
+  load->prim_tasks = MIUR_ARR(GLTFPrimitiveTask, mesh_count);
+  load->prim_task_count = mesh_count;
+  if ((mesh_count > 0 && (out->meshes == NULL || load->prim_tasks == NULL)) ||
+      (instance_count > 0 && out->instances == NULL))
+  {
+    return false;
+  }
+
+  size_t n = 0;
+  for (uint32_t i = 0; i < out->node_count; i++)
+  {
+    GLTFNode *node = &parser->nodes[order[i]];
+    for (size_t j = 0; node->mesh >= 0 &&
+         j < parser->meshes[node->mesh].primitive_count; j++, n++)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_NUMBER);
-      view->byte_stride = TOKEN_INT();
-      NEXT_TOKEN();
-    } else if (TOKEN_STRCMP("byteOffset"))
+      out->instances[n].mesh = (uint32_t) first_mesh[node->mesh] + j;
+      out->instances[n].node = i;
+    }
+  }
+
+  for (size_t i = 0; i < parser->mesh_count; i++)
+  {
+    GLTFMesh *gmesh = &parser->meshes[i];
+    for (size_t j = 0; first_mesh[i] >= 0 && j < gmesh->primitive_count; j++)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_NUMBER);
-      view->byte_offset = TOKEN_INT();
-      NEXT_TOKEN();
-    } else if (TOKEN_STRCMP("name"))
+      size_t m = (size_t) first_mesh[i] + j;
+      GLTFPrimitiveTask *task = &load->prim_tasks[m];
+      task->load = load;
+      task->prim = &gmesh->primitives[j];
+      task->mesh = &out->meshes[m];
+      if (!translate_primitive(parser, task))
+      {
+        MIUR_LOG_ERR("in primitive %zu of mesh '%s'", j,
+                     gmesh->name != NULL ? gmesh->name : "");
+        return false;
+      }
+    }
+  }
+  return translate_images(load);
+}
+
+/*
+ * Orders the nodes of the default scene breadth first, so each parent comes
+ * before its children, and fills in their parents and local matrices.
+ * Without scenes every node no other one lists as a child is a root.
+ * `order_out` receives the glTF index of each flattened node.
+ */
+static bool flatten_nodes(GLTFParser *parser, StaticModel *out,
+                          int32_t **order_out)
+{
+  size_t node_count = parser->node_count;
+  int32_t *order = (int32_t *) arena_alloc(&parser->arena,
+                                           (node_count + 1) *
+                                           sizeof(int32_t));
+  bool *seen = (bool *) arena_alloc(&parser->arena, node_count + 1);
+  out->node_parents = MIUR_ARR(int32_t, node_count + 1);
+  if (order == NULL || seen == NULL || out->node_parents == NULL)
+  {
+    return false;
+  }
+  memset(seen, 0, node_count);
+
+  uint32_t count = 0;
+  if (parser->scene_count > 0)
+  {
+    if (parser->start_scene < 0 ||
+        (size_t) parser->start_scene >= parser->scene_count)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_STRING);
-      view->name = TOKEN_MAKE_STRING();
-      NEXT_TOKEN();
-    } else {
-      MIUR_LOG_ERR("Unexpected buffer view field '%s'", TOKEN_MAKE_STRING());
+      MIUR_LOG_ERR("missing scene %d", parser->start_scene);
       return false;
     }
+    const GLTFScene *scene = &parser->scenes[parser->start_scene];
+    for (size_t i = 0; i < scene->node_count; i++)
+    {
+      int root = scene->nodes[i];
+      if (root < 0 || (size_t) root >= node_count || seen[root])
+      {
+        MIUR_LOG_ERR("scene lists missing or repeated node %d", root);
+        return false;
+      }
+      seen[root] = true;
+      out->node_parents[count] = -1;
+      order[count++] = root;
+    }
+  } else
+  {
+    /* Marks children first, whatever isn't one is a root. */
+    for (size_t i = 0; i < node_count; i++)
+    {
+      for (size_t c = 0; c < parser->nodes[i].child_count; c++)
+      {
+        int child = parser->nodes[i].children[c];
+        if (child >= 0 && (size_t) child < node_count)
+        {
+          seen[child] = true;
+        }
+      }
+    }
+    for (size_t i = 0; i < node_count; i++)
+    {
+      if (!seen[i])
+      {
+        out->node_parents[count] = -1;
+        order[count++] = (int32_t) i;
+      }
+    }
+    /* From here on it tracks the nodes already placed. */
+    memset(seen, 0, node_count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+      seen[order[i]] = true;
+    }
   }
+
+  /* The order doubles as the queue, a node is only ever added once. */
+  for (uint32_t head = 0; head < count; head++)
+  {
+    const GLTFNode *node = &parser->nodes[order[head]];
+    for (size_t c = 0; c < node->child_count; c++)
+    {
+      int child = node->children[c];
+      if (child < 0 || (size_t) child >= node_count || seen[child])
+      {
+        MIUR_LOG_ERR("node %d has a missing child, or one with more than "
+                     "one parent", order[head]);
+        return false;
+      }
+      seen[child] = true;
+      out->node_parents[count] = (int32_t) head;
+      order[count++] = child;
+    }
+  }
+
+  out->node_count = count;
+  out->node_local = MIUR_ARR_UNINIT(float, (size_t) count * 16 + 1);
+  if (out->node_local == NULL)
+  {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; i++)
+  {
+    /* One of the two is identity, see GLTFNode. */
+    const GLTFNode *node = &parser->nodes[order[i]];
+    float *local = &out->node_local[i * 16];
+    mat4_from_trs(local, node->translation, node->rotation, node->scale);
+    mat4_mul(local, local, node->matrix);
+  }
+  *order_out = order;
   return true;
 }
 
-bool parse_buffer(GLTFParser *parser, GLTFBuffer *buffer)
+static bool translate_primitive(GLTFParser *parser, GLTFPrimitiveTask *task)
 {
-  ASSERT_TOKEN(JSMN_OBJECT);
-  int fields = TOKEN_SIZE();
-  NEXT_TOKEN();
+  const GLTFPrimitive *prim = task->prim;
+  StaticMesh *mesh = task->mesh;
+
+  if (prim->mode != GLTF_MODE_TRIANGLES)
+  {
+    MIUR_LOG_ERR("only triangle lists are supported, got mode %d",
+                 prim->mode);
+    return false;
+  }
+  if (prim->attributes.position < 0)
+  {
+    MIUR_LOG_ERR("primitive has no positions");
+    return false;
+  }
 
-  for (int i = 0; i < fields; i++)
+  if (!add_stream(parser, task, prim->attributes.position, GLTF_TYPE_VEC3,
+                  (void **) &mesh->verts_pos))
   {
-    ASSERT_KEY();
-    if (TOKEN_STRCMP("uri"))
+    return false;
+  }
+  mesh->vert_count = parser->accessors[prim->attributes.position].count;
+
+  /*
+   * Positions must carry min and max, saving a pass over them.  Quantized
+   * ones are in their integer range, bound those after decoding.
+   */
+  const GLTFAccessor *positions = &parser->accessors[prim->attributes.position];
+  aabb_empty(&mesh->bounds);
+  if (positions->component_type == COMPONENT_FLOAT)
+  {
+    memcpy(mesh->bounds.min, positions->min, sizeof(mesh->bounds.min));
+    memcpy(mesh->bounds.max, positions->max, sizeof(mesh->bounds.max));
+  }
+
+  if (prim->attributes.normal >= 0)
+  {
+    if (parser->accessors[prim->attributes.normal].count !=
+        (int) mesh->vert_count)
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_STRING);
-      buffer->uri = TOKEN_MAKE_STRING();
-      NEXT_TOKEN();
-    } else if (TOKEN_STRCMP("byteLength"))
+      MIUR_LOG_ERR("normal count doesn't match the position count");
+      return false;
+    }
+    if (!add_stream(parser, task, prim->attributes.normal, GLTF_TYPE_VEC3,
+                    (void **) &mesh->verts_norm))
     {
-      NEXT_TOKEN();
-      ASSERT_TOKEN(JSMN_NUMBER);
-      buffer->byte_length = TOKEN_INT();
-      NEXT_TOKEN();
-    } else {
-      MIUR_LOG_ERR("Unexpected buffer field '%s'", TOKEN_MAKE_STRING());
       return false;
     }
   }
 
-  if (buffer->uri == NULL)
+  if (prim->attributes.tex_coords[0] >= 0)
   {
-    MIUR_LOG_ERR("Expected UIR for buffer");
-    return false;
+    if (parser->accessors[prim->attributes.tex_coords[0]].count !=
+        (int) mesh->vert_count)
+    {
+      MIUR_LOG_ERR("texture coordinate count doesn't match the position "
+                   "count");
+      return false;
+    }
+    if (!add_stream(parser, task, prim->attributes.tex_coords[0],
+                    GLTF_TYPE_VEC2, (void **) &mesh->verts_uv))
+    {
+      return false;
+    }
   }
 
-  size_t uri_len = strlen(buffer->uri);
-  size_t full_name_len = parser->local_prefix_len + uri_len;
-
-  char *full_name = MIUR_ARR(char, full_name_len);
-  memcpy(full_name, parser->local_prefix, parser->local_prefix_len);
-  memcpy(full_name + parser->local_prefix_len, buffer->uri, uri_len);
-  full_name[full_name_len] = '\0';
-
-  if (!membuf_load_file(&buffer->buf, full_name))
+  if (prim->indices >= 0)
+  {
+    if (!add_stream(parser, task, prim->indices, GLTF_TYPE_SCALAR,
+                    (void **) &mesh->indices))
+    {
+      return false;
+    }
+    mesh->index_count = parser->accessors[prim->indices].count;
+  }
+  else
   {
-    MIUR_LOG_ERR("Couldn't open buffer file '%s'", full_name);
+    /* Filled in when the primitive is finalized. */
+    mesh->index_count = mesh->vert_count;
+    mesh->indices = MIUR_ARR_UNINIT(uint32_t, mesh->index_count);
+  }
+  if (mesh->index_count % 3 != 0)
+  {
+    MIUR_LOG_ERR("index count %" PRIu32 " is not a multiple of 3",
+                 mesh->index_count);
     return false;
   }
   return true;
 }
 
-bool
-translate_to_model(GLTFParser *parser, StaticModel *out)
+/*
+ * Sets up a task per image, the textures and samplers that use them, and
+ * marks the images holding color as sRGB and those holding normals, which
+ * decides how each is compressed.  Image files become dependencies of the
+ * cache after the buffers.
+ */
+static bool translate_images(GLTFLoad *load)
 {
-  out->mesh_count = parser->node_count;
-  out->meshes = MIUR_ARR(StaticMesh, parser->node_count);
-  for (int i = 0; i < parser->node_count; i++)
+  GLTFParser *parser = &load->parser;
+  StaticModel *out = load->out;
+  if (!translate_textures(parser, out))
+  {
+    return false;
+  }
+
+  size_t image_count = parser->image_count;
+  out->images = MIUR_ARR(Texture, image_count + 1);
+  load->image_tasks = MIUR_ARR(GLTFImageTask, image_count + 1);
+  if (out->images == NULL || load->image_tasks == NULL)
+  {
+    return false;
+  }
+  out->image_count = (uint32_t) image_count;
+  load->image_task_count = image_count;
+
+  for (size_t i = 0; i < parser->material_count; i++)
   {
-    GLTFNode *node = &parser->nodes[i];
-    GLTFMesh *gmesh = &parser->meshes[node->mesh];
-    StaticMesh *mesh = &out->meshes[i];
-    if (gmesh->primitive_count > 1)
+    const GLTFMaterial *material = &parser->materials[i];
+    const GLTFTextureInfo *infos[] = {
+      &material->pbr.base_color_texture,
+      &material->emissive_texture,
+      &material->normal_texture,
+    };
+    for (size_t t = 0; t < sizeof(infos) / sizeof(infos[0]); t++)
     {
-      MIUR_LOG_ERR("cannot handle more than one primitive");
-      return false;
+      int texture = infos[t]->index;
+      if (texture < 0)
+      {
+        continue;
+      }
+      if ((size_t) texture >= parser->texture_count)
+      {
+        MIUR_LOG_ERR("material %zu references missing texture %d", i,
+                     texture);
+        return false;
+      }
+      GLTFImageTask *task = &load->image_tasks[out->textures[texture].image];
+      if (infos[t] == &material->normal_texture)
+      {
+        task->normal = true;
+      }
+      else
+      {
+        task->srgb = true;
+      }
     }
+  }
 
+  for (size_t i = 0; i < image_count; i++)
+  {
+    const GLTFImage *image = &parser->images[i];
+    GLTFImageTask *task = &load->image_tasks[i];
+    task->load = load;
+    task->texture = &out->images[i];
 
-    GLTFPrimitive *prim = &gmesh->primitives[0];
+    if (image->uri != NULL)
+    {
+      if (strncmp(image->uri, "data:", 5) == 0)
+      {
+        MIUR_LOG_WARN("image %zu is a data URI, which is not supported", i);
+        continue;
+      }
+      char *path;
+      if (!uri_path(parser, image->uri, &path))
+      {
+        return false;
+      }
+      task->path = path;
+      continue;
+    }
 
-    GLTFAccessor *pos_acc = &parser->accessors[prim->position];
-    if (pos_acc->type != GLTF_TYPE_VEC3 ||
-        pos_acc->component_type != GLTF_COMPONENT_TYPE_FLOAT) {
-      MIUR_LOG_ERR("expected position to a be a vec3 float");
+    if (image->buffer_view < 0 ||
+        (size_t) image->buffer_view >= parser->buffer_view_count)
+    {
+      MIUR_LOG_ERR("image %zu has neither a URI nor a buffer view", i);
       return false;
     }
+    const GLTFBufferView *view = &parser->buffer_views[image->buffer_view];
+    if (view->buffer < 0 || (size_t) view->buffer >= parser->buffer_count ||
+        view->byte_offset < 0 || view->byte_length < 0 ||
+        (uint64_t) view->byte_offset + (uint64_t) view->byte_length >
+        parser->buffers[view->buffer].buf.size)
+    {
+      MIUR_LOG_ERR("buffer view %d of image %zu is malformed",
+                   image->buffer_view, i);
+      return false;
+    }
+
+    task->data = parser->buffers[view->buffer].buf.data +
+      view->byte_offset;
+    task->size = (size_t) view->byte_length;
+  }
+  return true;
+}
 
-    GLTFAccessor *norm_acc = &parser->accessors[prim->position];
-    if (norm_acc->type != GLTF_TYPE_VEC3 ||
-        norm_acc->component_type != GLTF_COMPONENT_TYPE_FLOAT) {
-      MIUR_LOG_ERR("expected normal to a be a vec3 float");
+/* Resolves each texture's image and translates its sampler. */
+static bool translate_textures(GLTFParser *parser, StaticModel *out)
+{
+  out->textures = MIUR_ARR(ModelTexture, parser->texture_count + 1);
+  if (out->textures == NULL)
+  {
+    return false;
+  }
+  out->texture_count = (uint32_t) parser->texture_count;
+
+  for (size_t i = 0; i < parser->texture_count; i++)
+  {
+    const GLTFTexture *texture = &parser->textures[i];
+    ModelTexture *model_texture = &out->textures[i];
+    if (texture->source < 0 || (size_t) texture->source >= parser->image_count)
+    {
+      MIUR_LOG_ERR("texture %zu has no image, images given by extensions "
+                   "are not supported", i);
+      return false;
+    }
+    model_texture->image = (uint32_t) texture->source;
+    model_texture->sampler = texture_sampler_default;
+    if (texture->sampler < 0)
+    {
+      continue;
+    }
+    if ((size_t) texture->sampler >= parser->sampler_count)
+    {
+      MIUR_LOG_ERR("texture %zu references missing sampler %d", i,
+                   texture->sampler);
       return false;
     }
 
-    GLTFAccessor *index_acc = &parser->accessors[prim->indices];
-    if (index_acc->type != GLTF_TYPE_SCALAR ||
-        index_acc->component_type != GLTF_COMPONENT_TYPE_U16) {
-      MIUR_LOG_ERR("expected normal to a be a vec3 float");
+    /* Filters left out keep the default, linear everywhere. */
+    const GLTFSampler *gsampler = &parser->samplers[texture->sampler];
+    TextureSampler *sampler = &model_texture->sampler;
+    bool valid = translate_wrap(gsampler->wrap_s, &sampler->wrap_u) &&
+      translate_wrap(gsampler->wrap_t, &sampler->wrap_v);
+    switch (gsampler->mag_filter)
+    {
+    case -1: break;
+    case GLTF_FILTER_NEAREST: sampler->mag_linear = false; break;
+    case GLTF_FILTER_LINEAR: sampler->mag_linear = true; break;
+    default: valid = false; break;
+    }
+    switch (gsampler->min_filter)
+    {
+    case -1: break;
+    case GLTF_FILTER_NEAREST:
+    case GLTF_FILTER_LINEAR:
+      sampler->min_linear = gsampler->min_filter == GLTF_FILTER_LINEAR;
+      sampler->mipmapped = false;
+      break;
+    case GLTF_FILTER_NEAREST_MIPMAP_NEAREST:
+    case GLTF_FILTER_LINEAR_MIPMAP_NEAREST:
+    case GLTF_FILTER_NEAREST_MIPMAP_LINEAR:
+    case GLTF_FILTER_LINEAR_MIPMAP_LINEAR:
+      sampler->min_linear =
+        gsampler->min_filter == GLTF_FILTER_LINEAR_MIPMAP_NEAREST ||
+        gsampler->min_filter == GLTF_FILTER_LINEAR_MIPMAP_LINEAR;
+      sampler->mip_linear =
+        gsampler->min_filter >= GLTF_FILTER_NEAREST_MIPMAP_LINEAR;
+      break;
+    default:
+      valid = false;
+      break;
+    }
+    if (!valid)
+    {
+      MIUR_LOG_ERR("sampler %d has an unknown filter or wrap mode",
+                   texture->sampler);
       return false;
     }
+  }
+  return true;
+}
 
-    GLTFBufferView *pos_view = &parser->buffer_views[pos_acc->buffer_view];
-    GLTFBufferView *norm_view = &parser->buffer_views[norm_acc->buffer_view];
-    GLTFBufferView *index_view = &parser->buffer_views[index_acc->buffer_view];
+static bool translate_wrap(int wrap, TextureWrap *out)
+{
+  switch (wrap)
+  {
+  case GLTF_WRAP_REPEAT:
+    *out = TEXTURE_WRAP_REPEAT;
+    return true;
+  case GLTF_WRAP_MIRRORED_REPEAT:
+    *out = TEXTURE_WRAP_MIRRORED_REPEAT;
+    return true;
+  case GLTF_WRAP_CLAMP_TO_EDGE:
+    *out = TEXTURE_WRAP_CLAMP_TO_EDGE;
+    return true;
+  default:
+    return false;
+  }
+}
 
-    GLTFBuffer *pos_buf = &parser->buffers[pos_view->buffer];
-    GLTFBuffer *norm_buf = &parser->buffers[norm_view->buffer];
-    GLTFBuffer *index_buf = &parser->buffers[index_view->buffer];
+/*
+ * Validates accessor `index` against `type` and the bounds of its buffer
+ * view and buffer, then returns its first element and the distance between
+ * elements.
+ */
+static const uint8_t *accessor_data(GLTFParser *parser, int index,
+                                    GLTFType type, size_t *stride_out)
+{
+  if (index < 0 || (size_t) index >= parser->accessor_count)
+  {
+    MIUR_LOG_ERR("missing accessor %d", index);
+    return NULL;
+  }
+
+  GLTFAccessor *acc = &parser->accessors[index];
+  if (acc->type != type)
+  {
+    MIUR_LOG_ERR("accessor %d should be %s, not %s", index,
+                 gltf_type_names[type], gltf_type_names[acc->type]);
+    return NULL;
+  }
+  if (acc->sparse)
+  {
+    MIUR_LOG_ERR("accessor %d is sparse, which is not supported", index);
+    return NULL;
+  }
+  if (acc->buffer_view < 0 ||
+      (size_t) acc->buffer_view >= parser->buffer_view_count)
+  {
+    MIUR_LOG_ERR("accessor %d has no buffer view", index);
+    return NULL;
+  }
+  if (acc->count < 0 || acc->byte_offset < 0)
+  {
+    MIUR_LOG_ERR("accessor %d is malformed", index);
+    return NULL;
+  }
 
-    mesh->vert_count = pos_acc->count / 3;
+  GLTFBufferView *view = &parser->buffer_views[acc->buffer_view];
+  if (view->buffer < 0 || (size_t) view->buffer >= parser->buffer_count ||
+      view->byte_offset < 0 || view->byte_length < 0 || view->byte_stride < 0)
+  {
+    MIUR_LOG_ERR("buffer view %d is malformed", acc->buffer_view);
+    return NULL;
+  }
+  GLTFBuffer *buffer = &parser->buffers[view->buffer];
+  if ((uint64_t) view->byte_offset + (uint64_t) view->byte_length >
+      buffer->buf.size)
+  {
+    MIUR_LOG_ERR("buffer view %d is out of bounds", acc->buffer_view);
+    return NULL;
+  }
 
-    mesh->verts_pos = MIUR_ARR(float, pos_acc->count);
-    memcpy(mesh->verts_pos, pos_buf->buf.data + pos_view->byte_offset +
-           pos_acc->byte_offset, pos_acc->count * sizeof(float));
+  uint64_t elem_size = component_size(acc->component_type) *
+    gltf_type_components[type];
+  uint64_t stride = view->byte_stride != 0 ?
+    (uint64_t) view->byte_stride : elem_size;
+  if (stride < elem_size)
+  {
+    MIUR_LOG_ERR("buffer view %d stride is smaller than accessor %d",
+                 acc->buffer_view, index);
+    return NULL;
+  }
+  if (acc->count > 0 &&
+      (uint64_t) acc->byte_offset + stride * (acc->count - 1) + elem_size >
+      (uint64_t) view->byte_length)
+  {
+    MIUR_LOG_ERR("accessor %d overruns buffer view %d", index,
+                 acc->buffer_view);
+    return NULL;
+  }
 
-    mesh->verts_norm = MIUR_ARR(float, norm_acc->count);
-    memcpy(mesh->verts_norm, norm_buf->buf.data + norm_view->byte_offset +
-           norm_acc->byte_offset, norm_acc->count * sizeof(float));
+  *stride_out = (size_t) stride;
+  return buffer->buf.data + view->byte_offset + acc->byte_offset;
+}
 
-    if (node->scale[0] != 1 || node->scale[1] || node->scale[2])
+/* Records accessor `index` for decoding and allocates its destination. */
+static bool add_stream(GLTFParser *parser, GLTFPrimitiveTask *task, int index,
+                       GLTFType type, void **dst_out)
+{
+  GLTFStream *stream = &task->streams[task->stream_count];
+  stream->src = accessor_data(parser, index, type, &stream->stride);
+  if (stream->src == NULL)
+  {
+    return false;
+  }
+
+  GLTFAccessor *acc = &parser->accessors[index];
+  stream->type = acc->component_type;
+  stream->normalized = acc->normalized;
+  stream->components = gltf_type_components[type];
+  stream->count = (uint32_t) acc->count;
+  stream->indices = type == GLTF_TYPE_SCALAR;
+
+  if (stream->indices)
+  {
+    if (acc->component_type != COMPONENT_U8 &&
+        acc->component_type != COMPONENT_U16 &&
+        acc->component_type != COMPONENT_U32)
     {
-      for (int i = 0; i < mesh->vert_count; i++)
-      {
-        mesh->verts_pos[i * 3] *= node->scale[0];
-        mesh->verts_pos[i * 3 + 1] *= node->scale[1];
-        mesh->verts_pos[i * 3 + 2] *= node->scale[2];
-        mesh->verts_norm[i * 3] *= node->scale[0];
-        mesh->verts_norm[i * 3 + 1] *= node->scale[1];
-        mesh->verts_norm[i * 3 + 2] *= node->scale[2];
-      }
+      MIUR_LOG_ERR("indices must be unsigned integers");
+      return false;
     }
-
-    mesh->index_count = index_acc->count;
-    mesh->indices = MIUR_ARR(uint16_t, mesh->index_count);
-    memcpy(mesh->indices, index_buf->buf.data + index_view->byte_offset +
-           index_view->byte_offset, index_acc->count * sizeof(uint16_t));
+    if (stream->stride != component_size(acc->component_type))
+    {
+      MIUR_LOG_ERR("indices must be tightly packed");
+      return false;
+    }
+    stream->dst = MIUR_ARR_UNINIT(uint32_t, stream->count);
   }
+  else
+  {
+    stream->dst = MIUR_ARR_UNINIT(float,
+                                  (size_t) stream->count * stream->components);
+  }
+
+  *dst_out = stream->dst;
+  task->stream_count++;
   return true;
 }
+
+/* Area weighted vertex normals, for primitives that leave them out. */
+static void generate_normals(StaticMesh *mesh)
+{
+  mesh->verts_norm = MIUR_ARR(float, (size_t) mesh->vert_count * 3);
+  for (uint32_t i = 0; i + 2 < mesh->index_count; i += 3)
+  {
+    const float *p0 = &mesh->verts_pos[mesh->indices[i] * 3];
+    const float *p1 = &mesh->verts_pos[mesh->indices[i + 1] * 3];
+    const float *p2 = &mesh->verts_pos[mesh->indices[i + 2] * 3];
+    float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    float n[3] = {
+      e1[1] * e2[2] - e1[2] * e2[1],
+      e1[2] * e2[0] - e1[0] * e2[2],
+      e1[0] * e2[1] - e1[1] * e2[0],
+    };
+    for (int v = 0; v < 3; v++)
+    {
+      float *norm = &mesh->verts_norm[mesh->indices[i + v] * 3];
+      norm[0] += n[0];
+      norm[1] += n[1];
+      norm[2] += n[2];
+    }
+  }
+
+  for (uint32_t i = 0; i < mesh->vert_count; i++)
+  {
+    float *norm = &mesh->verts_norm[i * 3];
+    float len2 = norm[0] * norm[0] + norm[1] * norm[1] + norm[2] * norm[2];
+    if (len2 > 0.0f)
+    {
+      float inv_len = 1.0f / sqrtf(len2);
+      norm[0] *= inv_len;
+      norm[1] *= inv_len;
+      norm[2] *= inv_len;
+    }
+  }
+}
@@ -0,0 +1,640 @@
+/* =====================
+ * src/hash.c
+ * 10/18/2026
+ * Content hashing.
+ * ====================
+ */
+
+#include <string.h>
+
+#include <miur/hash.h>
+#include <miur/simd.h>
+
+#define PRIME32_1 0x9E3779B1u
+#define PRIME32_2 0x85EBCA77u
+#define PRIME32_3 0xC2B2AE3Du
+
+#define PRIME64_1 0x9E3779B185EBCA87ull
+#define PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define PRIME64_3 0x165667B19E3779F9ull
+#define PRIME64_4 0x85EBCA77C2B2AE63ull
+#define PRIME64_5 0x27D4EB2F165667C5ull
+
+/* XXH3 consumes input in 64 byte stripes, 16 stripes to a block. */
+#define STRIPE_SIZE 64
+#define SECRET_CONSUME_RATE 8
+#define BLOCK_STRIPES ((HASH_SECRET_SIZE - STRIPE_SIZE) / SECRET_CONSUME_RATE)
+#define SHORT_MAX 240
+#define SECRET_SIZE_MIN 136
+#define SECRET_MERGE_START 11
+#define SECRET_LAST_START 7
+
+/* === PROTOTYPES === */
+
+static uint64_t rotl64(uint64_t x, int r);
+static uint64_t read64(const uint8_t *p);
+static uint32_t read32(const uint8_t *p);
+static uint32_t swap32(uint32_t x);
+static uint64_t swap64(uint64_t x);
+static uint64_t round64(uint64_t acc, uint64_t input);
+static uint64_t merge_round(uint64_t acc, uint64_t value);
+static uint64_t avalanche64(uint64_t h);
+static uint64_t avalanche3(uint64_t h);
+static uint64_t rrmxmx(uint64_t h, uint64_t size);
+static uint64_t mul_fold64(uint64_t a, uint64_t b);
+static uint64_t mix16(const uint8_t *p, const uint8_t *secret, uint64_t seed);
+static uint64_t hash3_short(const uint8_t *p, size_t size, uint64_t seed);
+static uint64_t hash3_long(const uint8_t *p, size_t size,
+                           const uint8_t *secret);
+static void derive_secret(uint8_t *secret, uint64_t seed);
+static void init_acc(uint64_t *acc);
+static void accumulate(uint64_t *acc, const uint8_t *p,
+                       const uint8_t *secret);
+static void accumulate_stripes(uint64_t *acc, const uint8_t *p,
+                               const uint8_t *secret, size_t count);
+#if defined(MIUR_HAVE_AVX2)
+static __m256i accumulate_avx2(__m256i lane, const uint8_t *p,
+                               const uint8_t *secret);
+#elif defined(MIUR_HAVE_SSE2)
+static __m128i accumulate_sse2(__m128i lane, const uint8_t *p,
+                               const uint8_t *secret);
+#endif
+static void scramble(uint64_t *acc, const uint8_t *secret);
+static size_t consume_stripes(uint64_t *acc, size_t stripes,
+                              const uint8_t *secret, const uint8_t *p,
+                              size_t count);
+static uint64_t merge_acc(const uint64_t *acc, const uint8_t *secret,
+                          uint64_t h);
+
+/* === GLOBALS === */
+
+static const uint8_t default_secret[HASH_SECRET_SIZE] = {
+  0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c,
+  0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb,
+  0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e,
+  0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+  0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6,
+  0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb,
+  0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97,
+  0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+  0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7,
+  0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31,
+  0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83,
+  0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+  0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26,
+  0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+  0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f,
+  0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+uint64_t hash64(const void *data, size_t size, uint64_t seed)
+{
+  const uint8_t *p = (const uint8_t *) data;
+  const uint8_t *end = p + size;
+  uint64_t h;
+
+  if (size >= 32)
+  {
+    uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+    uint64_t v2 = seed + PRIME64_2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - PRIME64_1;
+    const uint8_t *limit = end - 32;
+    do
+    {
+      v1 = round64(v1, read64(p));
+      v2 = round64(v2, read64(p + 8));
+      v3 = round64(v3, read64(p + 16));
+      v4 = round64(v4, read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+
+    h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+    h = merge_round(h, v1);
+    h = merge_round(h, v2);
+    h = merge_round(h, v3);
+    h = merge_round(h, v4);
+  }
+  else
+  {
+    h = seed + PRIME64_5;
+  }
+  h += (uint64_t) size;
+
+  for (; p + 8 <= end; p += 8)
+  {
+    h ^= round64(0, read64(p));
+    h = rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+  }
+  if (p + 4 <= end)
+  {
+    h ^= (uint64_t) read32(p) * PRIME64_1;
+    h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+    p += 4;
+  }
+  for (; p < end; p++)
+  {
+    h ^= *p * PRIME64_5;
+    h = rotl64(h, 11) * PRIME64_1;
+  }
+
+  return avalanche64(h);
+}
+
+uint64_t hash3(const void *data, size_t size, uint64_t seed)
+{
+  const uint8_t *p = (const uint8_t *) data;
+  if (size <= SHORT_MAX)
+  {
+    return hash3_short(p, size, seed);
+  }
+  if (seed == 0)
+  {
+    return hash3_long(p, size, default_secret);
+  }
+  uint8_t secret[HASH_SECRET_SIZE];
+  derive_secret(secret, seed);
+  return hash3_long(p, size, secret);
+}
+
+void hash_stream_init(HashStream *stream, uint64_t seed)
+{
+  init_acc(stream->acc);
+  if (seed == 0)
+  {
+    memcpy(stream->secret, default_secret, HASH_SECRET_SIZE);
+  }
+  else
+  {
+    derive_secret(stream->secret, seed);
+  }
+  stream->buffered = 0;
+  stream->stripes = 0;
+  stream->total = 0;
+  stream->seed = seed;
+}
+
+/*
+ * Input is consumed a buffer's worth of stripes at a time.  The last stripe
+ * seen is always kept back, as the digest treats it differently, so once
+ * the buffer has been flushed its tail holds the stripe before the new
+ * input for a digest that needs to reach back into it.
+ */
+void hash_stream_update(HashStream *stream, const void *data, size_t size)
+{
+  const uint8_t *p = (const uint8_t *) data;
+  const size_t buffer_stripes = HASH_STREAM_BUFFER_SIZE / STRIPE_SIZE;
+  stream->total += size;
+
+  if (size <= HASH_STREAM_BUFFER_SIZE - stream->buffered)
+  {
+    memcpy(stream->buffer + stream->buffered, p, size);
+    stream->buffered += size;
+    return;
+  }
+
+  if (stream->buffered > 0)
+  {
+    size_t fill = HASH_STREAM_BUFFER_SIZE - stream->buffered;
+    memcpy(stream->buffer + stream->buffered, p, fill);
+    p += fill;
+    size -= fill;
+    stream->stripes = consume_stripes(stream->acc, stream->stripes,
+                                      stream->secret, stream->buffer,
+                                      buffer_stripes);
+    stream->buffered = 0;
+  }
+
+  if (size > HASH_STREAM_BUFFER_SIZE)
+  {
+    do
+    {
+      stream->stripes = consume_stripes(stream->acc, stream->stripes,
+                                        stream->secret, p, buffer_stripes);
+      p += HASH_STREAM_BUFFER_SIZE;
+      size -= HASH_STREAM_BUFFER_SIZE;
+    } while (size > HASH_STREAM_BUFFER_SIZE);
+    memcpy(stream->buffer + HASH_STREAM_BUFFER_SIZE - STRIPE_SIZE,
+           p - STRIPE_SIZE, STRIPE_SIZE);
+  }
+
+  memcpy(stream->buffer, p, size);
+  stream->buffered = size;
+}
+
+uint64_t hash_stream_digest(const HashStream *stream)
+{
+  if (stream->total <= SHORT_MAX)
+  {
+    return hash3_short(stream->buffer, stream->buffered, stream->seed);
+  }
+
+  uint64_t acc[8];
+  memcpy(acc, stream->acc, sizeof(acc));
+  const uint8_t *last_secret = stream->secret + HASH_SECRET_SIZE -
+    STRIPE_SIZE - SECRET_LAST_START;
+  if (stream->buffered >= STRIPE_SIZE)
+  {
+    size_t count = (stream->buffered - 1) / STRIPE_SIZE;
+    consume_stripes(acc, stream->stripes, stream->secret, stream->buffer,
+                    count);
+    accumulate(acc, stream->buffer + stream->buffered - STRIPE_SIZE,
+               last_secret);
+  }
+  else
+  {
+    /* The last stripe starts in the input already consumed. */
+    uint8_t last[STRIPE_SIZE];
+    size_t catchup = STRIPE_SIZE - stream->buffered;
+    memcpy(last, stream->buffer + HASH_STREAM_BUFFER_SIZE - catchup,
+           catchup);
+    memcpy(last + catchup, stream->buffer, stream->buffered);
+    accumulate(acc, last, last_secret);
+  }
+  return merge_acc(acc, stream->secret + SECRET_MERGE_START,
+                   stream->total * PRIME64_1);
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static uint64_t rotl64(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t read64(const uint8_t *p)
+{
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static uint32_t read32(const uint8_t *p)
+{
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static uint32_t swap32(uint32_t x)
+{
+  return (x << 24) | ((x << 8) & 0xFF0000u) | ((x >> 8) & 0xFF00u) |
+    (x >> 24);
+}
+
+static uint64_t swap64(uint64_t x)
+{
+  return ((uint64_t) swap32((uint32_t) x) << 32) | swap32(x >> 32);
+}
+
+static uint64_t round64(uint64_t acc, uint64_t input)
+{
+  acc += input * PRIME64_2;
+  acc = rotl64(acc, 31);
+  return acc * PRIME64_1;
+}
+
+static uint64_t merge_round(uint64_t acc, uint64_t value)
+{
+  acc ^= round64(0, value);
+  return acc * PRIME64_1 + PRIME64_4;
+}
+
+static uint64_t avalanche64(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= PRIME64_2;
+  h ^= h >> 29;
+  h *= PRIME64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+static uint64_t avalanche3(uint64_t h)
+{
+  h ^= h >> 37;
+  h *= 0x165667919E3779F9ull;
+  h ^= h >> 32;
+  return h;
+}
+
+/* A stronger avalanche for the 4 to 8 byte inputs, mixing in the size. */
+static uint64_t rrmxmx(uint64_t h, uint64_t size)
+{
+  h ^= rotl64(h, 49) ^ rotl64(h, 24);
+  h *= 0x9FB21C651E98DF25ull;
+  h ^= (h >> 35) + size;
+  h *= 0x9FB21C651E98DF25ull;
+  h ^= h >> 28;
+  return h;
+}
+
+/* The 128 bit product of `a` and `b`, its halves xored together. */
+static uint64_t mul_fold64(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+  __extension__ typedef unsigned __int128 uint128;
+  uint128 product = (uint128) a * b;
+  return (uint64_t) product ^ (uint64_t) (product >> 64);
+#else
+  uint64_t lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+  uint64_t hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+  uint64_t lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+  uint64_t hi_hi = (a >> 32) * (b >> 32);
+  uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+  uint64_t hi = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+  uint64_t lo = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+  return lo ^ hi;
+#endif
+}
+
+static uint64_t mix16(const uint8_t *p, const uint8_t *secret, uint64_t seed)
+{
+  uint64_t lo = read64(p) ^ (read64(secret) + seed);
+  uint64_t hi = read64(p + 8) ^ (read64(secret + 8) - seed);
+  return mul_fold64(lo, hi);
+}
+
+/*
+ * Inputs up to 240 bytes are mixed whole rather than striped, from both
+ * ends where the size isn't a multiple of the step.  They always use the
+ * default secret, the seed is folded in directly.
+ */
+static uint64_t hash3_short(const uint8_t *p, size_t size, uint64_t seed)
+{
+  const uint8_t *secret = default_secret;
+
+  if (size == 0)
+  {
+    return avalanche64(seed ^ read64(secret + 56) ^ read64(secret + 64));
+  }
+  if (size <= 3)
+  {
+    uint32_t combined = ((uint32_t) p[0] << 16) |
+      ((uint32_t) p[size >> 1] << 24) | p[size - 1] | ((uint32_t) size << 8);
+    uint64_t flip = (uint64_t) (read32(secret) ^ read32(secret + 4)) + seed;
+    return avalanche64(combined ^ flip);
+  }
+  if (size <= 8)
+  {
+    seed ^= (uint64_t) swap32((uint32_t) seed) << 32;
+    uint64_t flip = (read64(secret + 8) ^ read64(secret + 16)) - seed;
+    uint64_t input = read32(p + size - 4) + ((uint64_t) read32(p) << 32);
+    return rrmxmx(input ^ flip, size);
+  }
+  if (size <= 16)
+  {
+    uint64_t flip_lo = (read64(secret + 24) ^ read64(secret + 32)) + seed;
+    uint64_t flip_hi = (read64(secret + 40) ^ read64(secret + 48)) - seed;
+    uint64_t lo = read64(p) ^ flip_lo;
+    uint64_t hi = read64(p + size - 8) ^ flip_hi;
+    return avalanche3(size + swap64(lo) + hi + mul_fold64(lo, hi));
+  }
+
+  uint64_t h = size * PRIME64_1;
+  if (size <= 128)
+  {
+    if (size > 32)
+    {
+      if (size > 64)
+      {
+        if (size > 96)
+        {
+          h += mix16(p + 48, secret + 96, seed);
+          h += mix16(p + size - 64, secret + 112, seed);
+        }
+        h += mix16(p + 32, secret + 64, seed);
+        h += mix16(p + size - 48, secret + 80, seed);
+      }
+      h += mix16(p + 16, secret + 32, seed);
+      h += mix16(p + size - 32, secret + 48, seed);
+    }
+    h += mix16(p, secret, seed);
+    h += mix16(p + size - 16, secret + 16, seed);
+    return avalanche3(h);
+  }
+
+  size_t rounds = size / 16;
+  for (size_t i = 0; i < 8; i++)
+  {
+    h += mix16(p + 16 * i, secret + 16 * i, seed);
+  }
+  h = avalanche3(h);
+  for (size_t i = 8; i < rounds; i++)
+  {
+    h += mix16(p + 16 * i, secret + 16 * (i - 8) + 3, seed);
+  }
+  h += mix16(p + size - 16, secret + SECRET_SIZE_MIN - 17, seed);
+  return avalanche3(h);
+}
+
+/*
+ * Each block of 16 stripes walks the secret 8 bytes per stripe, then the
+ * accumulators are scrambled.  The last stripe is always the last 64 bytes
+ * of the input, overlapping the one before where the size isn't a multiple.
+ */
+static uint64_t hash3_long(const uint8_t *p, size_t size,
+                           const uint8_t *secret)
+{
+  uint64_t acc[8];
+  init_acc(acc);
+
+  const size_t block_size = STRIPE_SIZE * BLOCK_STRIPES;
+  size_t blocks = (size - 1) / block_size;
+  for (size_t i = 0; i < blocks; i++)
+  {
+    accumulate_stripes(acc, p + i * block_size, secret, BLOCK_STRIPES);
+    scramble(acc, secret + HASH_SECRET_SIZE - STRIPE_SIZE);
+  }
+
+  size_t stripes = ((size - 1) - blocks * block_size) / STRIPE_SIZE;
+  accumulate_stripes(acc, p + blocks * block_size, secret, stripes);
+  accumulate(acc, p + size - STRIPE_SIZE,
+             secret + HASH_SECRET_SIZE - STRIPE_SIZE - SECRET_LAST_START);
+
+  return merge_acc(acc, secret + SECRET_MERGE_START, size * PRIME64_1);
+}
+
+static void derive_secret(uint8_t *secret, uint64_t seed)
+{
+  for (size_t i = 0; i < HASH_SECRET_SIZE; i += 16)
+  {
+    uint64_t lo = read64(default_secret + i) + seed;
+    uint64_t hi = read64(default_secret + i + 8) - seed;
+    memcpy(secret + i, &lo, sizeof(lo));
+    memcpy(secret + i + 8, &hi, sizeof(hi));
+  }
+}
+
+static void init_acc(uint64_t *acc)
+{
+  acc[0] = PRIME32_3;
+  acc[1] = PRIME64_1;
+  acc[2] = PRIME64_2;
+  acc[3] = PRIME64_3;
+  acc[4] = PRIME64_4;
+  acc[5] = PRIME32_2;
+  acc[6] = PRIME64_5;
+  acc[7] = PRIME32_1;
+}
+
+static void accumulate(uint64_t *acc, const uint8_t *p,
+                       const uint8_t *secret)
+{
+  accumulate_stripes(acc, p, secret, 1);
+}
+
+/*
+ * Each lane adds the product of the low and high halves of its input xored
+ * with the secret, and its neighbour's raw input, so no input bit is lost
+ * to a multiply by zero.  The accumulators stay in registers for the run.
+ */
+static void accumulate_stripes(uint64_t *acc, const uint8_t *p,
+                               const uint8_t *secret, size_t count)
+{
+#if defined(MIUR_HAVE_AVX2)
+  __m256i lane0 = _mm256_loadu_si256((const __m256i *) acc);
+  __m256i lane1 = _mm256_loadu_si256((const __m256i *) (acc + 4));
+  for (size_t s = 0; s < count; s++)
+  {
+    const uint8_t *stripe = p + s * STRIPE_SIZE;
+    const uint8_t *key = secret + s * SECRET_CONSUME_RATE;
+    lane0 = accumulate_avx2(lane0, stripe, key);
+    lane1 = accumulate_avx2(lane1, stripe + 32, key + 32);
+  }
+  _mm256_storeu_si256((__m256i *) acc, lane0);
+  _mm256_storeu_si256((__m256i *) (acc + 4), lane1);
+#elif defined(MIUR_HAVE_SSE2)
+  __m128i lane0 = _mm_loadu_si128((const __m128i *) acc);
+  __m128i lane1 = _mm_loadu_si128((const __m128i *) (acc + 2));
+  __m128i lane2 = _mm_loadu_si128((const __m128i *) (acc + 4));
+  __m128i lane3 = _mm_loadu_si128((const __m128i *) (acc + 6));
+  for (size_t s = 0; s < count; s++)
+  {
+    const uint8_t *stripe = p + s * STRIPE_SIZE;
+    const uint8_t *key = secret + s * SECRET_CONSUME_RATE;
+    lane0 = accumulate_sse2(lane0, stripe, key);
+    lane1 = accumulate_sse2(lane1, stripe + 16, key + 16);
+    lane2 = accumulate_sse2(lane2, stripe + 32, key + 32);
+    lane3 = accumulate_sse2(lane3, stripe + 48, key + 48);
+  }
+  _mm_storeu_si128((__m128i *) acc, lane0);
+  _mm_storeu_si128((__m128i *) (acc + 2), lane1);
+  _mm_storeu_si128((__m128i *) (acc + 4), lane2);
+  _mm_storeu_si128((__m128i *) (acc + 6), lane3);
+#else
+  for (size_t s = 0; s < count; s++)
+  {
+    const uint8_t *stripe = p + s * STRIPE_SIZE;
+    const uint8_t *key = secret + s * SECRET_CONSUME_RATE;
+    for (size_t i = 0; i < 8; i++)
+    {
+      uint64_t data = read64(stripe + 8 * i);
+      uint64_t keyed = data ^ read64(key + 8 * i);
+      acc[i ^ 1] += data;
+      acc[i] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
+    }
+  }
+#endif
+}
+
+#if defined(MIUR_HAVE_AVX2)
+static __m256i accumulate_avx2(__m256i lane, const uint8_t *p,
+                               const uint8_t *secret)
+{
+  __m256i data = _mm256_loadu_si256((const __m256i *) p);
+  __m256i keyed = _mm256_xor_si256(
+    data, _mm256_loadu_si256((const __m256i *) secret));
+  __m256i product = _mm256_mul_epu32(keyed, _mm256_srli_epi64(keyed, 32));
+  __m256i swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+  return _mm256_add_epi64(lane, _mm256_add_epi64(swapped, product));
+}
+#elif defined(MIUR_HAVE_SSE2)
+static __m128i accumulate_sse2(__m128i lane, const uint8_t *p,
+                               const uint8_t *secret)
+{
+  __m128i data = _mm_loadu_si128((const __m128i *) p);
+  __m128i keyed = _mm_xor_si128(data,
+                                _mm_loadu_si128((const __m128i *) secret));
+  __m128i product = _mm_mul_epu32(keyed, _mm_srli_epi64(keyed, 32));
+  __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+  return _mm_add_epi64(lane, _mm_add_epi64(swapped, product));
+}
+#endif
+
+/* Keeps the accumulators from saturating over many blocks. */
+static void scramble(uint64_t *acc, const uint8_t *secret)
+{
+#if defined(MIUR_HAVE_AVX2)
+  __m256i prime = _mm256_set1_epi32((int) PRIME32_1);
+  for (size_t i = 0; i < 2; i++)
+  {
+    __m256i *lane = (__m256i *) (acc + 4 * i);
+    __m256i value = _mm256_loadu_si256(lane);
+    value = _mm256_xor_si256(value, _mm256_srli_epi64(value, 47));
+    __m256i key = _mm256_loadu_si256((const __m256i *) (secret + 32 * i));
+    value = _mm256_xor_si256(value, key);
+    __m256i lo = _mm256_mul_epu32(value, prime);
+    __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(value, 32), prime);
+    _mm256_storeu_si256(lane,
+                        _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32)));
+  }
+#elif defined(MIUR_HAVE_SSE2)
+  __m128i prime = _mm_set1_epi32((int) PRIME32_1);
+  for (size_t i = 0; i < 4; i++)
+  {
+    __m128i *lane = (__m128i *) (acc + 2 * i);
+    __m128i value = _mm_loadu_si128(lane);
+    value = _mm_xor_si128(value, _mm_srli_epi64(value, 47));
+    __m128i key = _mm_loadu_si128((const __m128i *) (secret + 16 * i));
+    value = _mm_xor_si128(value, key);
+    __m128i lo = _mm_mul_epu32(value, prime);
+    __m128i hi = _mm_mul_epu32(_mm_srli_epi64(value, 32), prime);
+    _mm_storeu_si128(lane, _mm_add_epi64(lo, _mm_slli_epi64(hi, 32)));
+  }
+#else
+  for (size_t i = 0; i < 8; i++)
+  {
+    uint64_t value = acc[i];
+    value ^= value >> 47;
+    value ^= read64(secret + 8 * i);
+    acc[i] = value * PRIME32_1;
+  }
+#endif
+}
+
+/*
+ * Consumes `count` stripes from `stripes` into the current block,
+ * scrambling where the block ends.  Returns the stripes into the block
+ * after.
+ */
+static size_t consume_stripes(uint64_t *acc, size_t stripes,
+                              const uint8_t *secret, const uint8_t *p,
+                              size_t count)
+{
+  if (BLOCK_STRIPES - stripes > count)
+  {
+    accumulate_stripes(acc, p, secret + stripes * SECRET_CONSUME_RATE,
+                       count);
+    return stripes + count;
+  }
+
+  size_t to_end = BLOCK_STRIPES - stripes;
+  accumulate_stripes(acc, p, secret + stripes * SECRET_CONSUME_RATE, to_end);
+  scramble(acc, secret + HASH_SECRET_SIZE - STRIPE_SIZE);
+  accumulate_stripes(acc, p + to_end * STRIPE_SIZE, secret, count - to_end);
+  return count - to_end;
+}
+
+static uint64_t merge_acc(const uint64_t *acc, const uint8_t *secret,
+                          uint64_t h)
+{
+  for (size_t i = 0; i < 4; i++)
+  {
+    h += mul_fold64(acc[2 * i] ^ read64(secret + 16 * i),
+                    acc[2 * i + 1] ^ read64(secret + 16 * i + 8));
+  }
+  return avalanche3(h);
+}
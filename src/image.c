@@ -0,0 +1,80 @@
+/* =====================
+ * src/image.c
+ * 10/18/2026
+ * PNG and JPEG decoding.
+ * ====================
+ */
+
+#include <inttypes.h>
+#include <string.h>
+
+#include <miur/image_priv.h>
+#include <miur/log.h>
+#include <miur/mem.h>
+
+/* === GLOBALS === */
+
+static const uint8_t png_signature[8] = {
+  0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n',
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+ImageFormat image_detect(const uint8_t *data, size_t size)
+{
+  if (size >= sizeof(png_signature) &&
+      memcmp(data, png_signature, sizeof(png_signature)) == 0)
+  {
+    return IMAGE_FORMAT_PNG;
+  }
+  /* Start of image, then the first marker. */
+  if (size >= 3 && data[0] == 0xff && data[1] == 0xd8 && data[2] == 0xff)
+  {
+    return IMAGE_FORMAT_JPEG;
+  }
+  return IMAGE_FORMAT_UNKNOWN;
+}
+
+bool image_decode(Image *out, const uint8_t *data, size_t size)
+{
+  memset(out, 0, sizeof(*out));
+  bool result;
+  switch (image_detect(data, size))
+  {
+  case IMAGE_FORMAT_PNG:
+    result = png_decode(out, data, size);
+    break;
+  case IMAGE_FORMAT_JPEG:
+    result = jpeg_decode(out, data, size);
+    break;
+  default:
+    MIUR_LOG_ERR("Unknown image format");
+    return false;
+  }
+  if (!result)
+  {
+    image_destroy(out);
+  }
+  return result;
+}
+
+void image_destroy(Image *image)
+{
+  MIUR_FREE(image->pixels);
+  memset(image, 0, sizeof(*image));
+}
+
+bool image_alloc(Image *image, uint32_t width, uint32_t height)
+{
+  if (width == 0 || height == 0 || width > IMAGE_MAX_DIMENSION ||
+      height > IMAGE_MAX_DIMENSION)
+  {
+    MIUR_LOG_ERR("Image size %" PRIu32 "x%" PRIu32 " is out of range", width,
+                 height);
+    return false;
+  }
+  image->pixels = MIUR_ARR_UNINIT(uint8_t, (size_t) width * height * 4);
+  image->width = width;
+  image->height = height;
+  return image->pixels != NULL;
+}
@@ -0,0 +1,513 @@
+/* =====================
+ * src/inflate.c
+ * 10/18/2026
+ * DEFLATE decompression.
+ * ====================
+ */
+
+#include <string.h>
+
+#include <miur/inflate.h>
+
+/* Codes this long or shorter decode with one table lookup. */
+#define INFLATE_FAST_BITS 10
+#define INFLATE_FAST_SIZE (1 << INFLATE_FAST_BITS)
+#define INFLATE_MAX_BITS 15
+#define INFLATE_LITLEN_SYMBOLS 288
+#define INFLATE_DIST_SYMBOLS 32
+#define INFLATE_CLEN_SYMBOLS 19
+#define INFLATE_END_OF_BLOCK 256
+#define ADLER_MOD 65521
+/* Most bytes summed before the Adler-32 sums could overflow 32 bits. */
+#define ADLER_NMAX 5552
+
+/*
+ * Canonical code tables.  `fast` holds length << 9 | symbol for every code
+ * of up to INFLATE_FAST_BITS, indexed by the next bits of the stream, and 0
+ * where the code is longer.  Those are found by comparing the bit reversed
+ * stream against the end of each length's range of codes.
+ */
+typedef struct
+{
+  uint16_t fast[INFLATE_FAST_SIZE];
+  uint32_t max_code[INFLATE_MAX_BITS + 2];
+  uint16_t first_code[INFLATE_MAX_BITS + 1];
+  uint16_t first_symbol[INFLATE_MAX_BITS + 1];
+  uint16_t symbols[INFLATE_LITLEN_SYMBOLS];
+} Huffman;
+
+/*
+ * Reads past the end of the input as zero bytes, counting them, so refills
+ * never branch on the end.  A stream that actually consumed them is corrupt.
+ */
+typedef struct
+{
+  const uint8_t *p;
+  const uint8_t *end;
+  uint64_t bits;
+  uint32_t count;
+  uint32_t phantom;
+} BitReader;
+
+/* === PROTOTYPES === */
+
+static bool inflate_stream(BitReader *br, uint8_t *dst, size_t dst_size);
+static bool stored_block(BitReader *br, uint8_t **out, uint8_t *out_end);
+static bool dynamic_tables(BitReader *br, Huffman *litlen, Huffman *dist);
+static void fixed_tables(Huffman *litlen, Huffman *dist);
+static bool huffman_build(Huffman *h, const uint8_t *lengths,
+                          uint32_t count);
+static int decode_symbol(BitReader *br, const Huffman *h);
+static int decode_slow(BitReader *br, const Huffman *h);
+static bool decode_block(BitReader *br, const Huffman *litlen,
+                         const Huffman *dist, uint8_t *dst, uint8_t **out,
+                         uint8_t *out_end);
+static void refill(BitReader *br);
+static uint32_t take_bits(BitReader *br, uint32_t n);
+static bool reader_valid(const BitReader *br);
+static uint32_t reverse_bits(uint32_t code, uint32_t length);
+static uint32_t adler32(const uint8_t *data, size_t size);
+
+/* === GLOBALS === */
+
+static const uint16_t length_base[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+  67, 83, 99, 115, 131, 163, 195, 227, 258,
+};
+static const uint8_t length_extra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5,
+  5, 5, 5, 0,
+};
+static const uint16_t dist_base[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513,
+  769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+};
+static const uint8_t dist_extra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10,
+  11, 11, 12, 12, 13, 13,
+};
+static const uint8_t clen_order[INFLATE_CLEN_SYMBOLS] = {
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15,
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+bool inflate_raw(const uint8_t *src, size_t size, uint8_t *dst,
+                 size_t dst_size)
+{
+  BitReader br = { src, src + size, 0, 0, 0 };
+  return inflate_stream(&br, dst, dst_size);
+}
+
+bool inflate_zlib(const uint8_t *src, size_t size, uint8_t *dst,
+                  size_t dst_size)
+{
+  /* Deflate with a window of at most 32 KiB and no preset dictionary. */
+  if (size < 6 || (src[0] & 0x0f) != 8 || (src[0] >> 4) > 7 ||
+      (src[1] & 0x20) != 0 || ((uint32_t) src[0] << 8 | src[1]) % 31 != 0)
+  {
+    return false;
+  }
+
+  BitReader br = { src + 2, src + size, 0, 0, 0 };
+  if (!inflate_stream(&br, dst, dst_size))
+  {
+    return false;
+  }
+
+  /* The checksum follows on the next byte boundary, big endian. */
+  take_bits(&br, br.count & 7);
+  uint8_t trailer[4];
+  for (int i = 0; i < 4; i++)
+  {
+    refill(&br);
+    trailer[i] = (uint8_t) take_bits(&br, 8);
+  }
+  uint32_t expected = (uint32_t) trailer[0] << 24 |
+    (uint32_t) trailer[1] << 16 | (uint32_t) trailer[2] << 8 | trailer[3];
+  return reader_valid(&br) && adler32(dst, dst_size) == expected;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static bool inflate_stream(BitReader *br, uint8_t *dst, size_t dst_size)
+{
+  uint8_t *out = dst;
+  uint8_t *out_end = dst + dst_size;
+  Huffman litlen, dist;
+  uint32_t final;
+
+  do
+  {
+    refill(br);
+    final = take_bits(br, 1);
+    uint32_t type = take_bits(br, 2);
+    if (type == 0)
+    {
+      if (!stored_block(br, &out, out_end))
+      {
+        return false;
+      }
+      continue;
+    }
+
+    if (type == 1)
+    {
+      fixed_tables(&litlen, &dist);
+    } else if (type != 2 || !dynamic_tables(br, &litlen, &dist))
+    {
+      return false;
+    }
+    if (!decode_block(br, &litlen, &dist, dst, &out, out_end))
+    {
+      return false;
+    }
+  } while (!final);
+
+  return out == out_end && reader_valid(br);
+}
+
+static bool stored_block(BitReader *br, uint8_t **out, uint8_t *out_end)
+{
+  take_bits(br, br->count & 7);
+  refill(br);
+  uint32_t length = take_bits(br, 16);
+  uint32_t inverse = take_bits(br, 16);
+  if ((length ^ 0xffff) != inverse ||
+      length > (size_t) (out_end - *out))
+  {
+    return false;
+  }
+
+  /* Whole bytes already in the bit buffer come first. */
+  while (length > 0 && br->count >= 8)
+  {
+    *(*out)++ = (uint8_t) take_bits(br, 8);
+    length--;
+  }
+  if (!reader_valid(br) || length > (size_t) (br->end - br->p))
+  {
+    return false;
+  }
+  if (length > 0)
+  {
+    /* Refills may have left the start of p[0] above the empty buffer. */
+    br->bits = 0;
+  }
+  memcpy(*out, br->p, length);
+  br->p += length;
+  *out += length;
+  return true;
+}
+
+static bool dynamic_tables(BitReader *br, Huffman *litlen, Huffman *dist)
+{
+  uint8_t lengths[INFLATE_LITLEN_SYMBOLS + INFLATE_DIST_SYMBOLS];
+  uint8_t clen_lengths[INFLATE_CLEN_SYMBOLS] = { 0 };
+  Huffman clen;
+
+  refill(br);
+  uint32_t litlen_count = take_bits(br, 5) + 257;
+  uint32_t dist_count = take_bits(br, 5) + 1;
+  uint32_t clen_count = take_bits(br, 4) + 4;
+  if (litlen_count > 286 || dist_count > 30)
+  {
+    return false;
+  }
+  for (uint32_t i = 0; i < clen_count; i++)
+  {
+    refill(br);
+    clen_lengths[clen_order[i]] = (uint8_t) take_bits(br, 3);
+  }
+  if (!huffman_build(&clen, clen_lengths, INFLATE_CLEN_SYMBOLS))
+  {
+    return false;
+  }
+
+  /* Literal/length and distance lengths are one run-length coded list. */
+  uint32_t total = litlen_count + dist_count;
+  uint32_t n = 0;
+  while (n < total)
+  {
+    int symbol = decode_symbol(br, &clen);
+    uint32_t repeat;
+    uint8_t value;
+    if (symbol < 0)
+    {
+      return false;
+    } else if (symbol < 16)
+    {
+      lengths[n++] = (uint8_t) symbol;
+      continue;
+    } else if (symbol == 16)
+    {
+      if (n == 0)
+      {
+        return false;
+      }
+      value = lengths[n - 1];
+      repeat = 3 + take_bits(br, 2);
+    } else if (symbol == 17)
+    {
+      value = 0;
+      repeat = 3 + take_bits(br, 3);
+    } else
+    {
+      value = 0;
+      repeat = 11 + take_bits(br, 7);
+    }
+    if (repeat > total - n)
+    {
+      return false;
+    }
+    memset(&lengths[n], value, repeat);
+    n += repeat;
+  }
+
+  /* A block without an end of block code could never finish. */
+  return lengths[INFLATE_END_OF_BLOCK] != 0 &&
+    huffman_build(litlen, lengths, litlen_count) &&
+    huffman_build(dist, lengths + litlen_count, dist_count);
+}
+
+static void fixed_tables(Huffman *litlen, Huffman *dist)
+{
+  uint8_t lengths[INFLATE_LITLEN_SYMBOLS];
+  memset(lengths, 8, 144);
+  memset(lengths + 144, 9, 112);
+  memset(lengths + 256, 7, 24);
+  memset(lengths + 280, 8, 8);
+  huffman_build(litlen, lengths, INFLATE_LITLEN_SYMBOLS);
+  memset(lengths, 5, INFLATE_DIST_SYMBOLS);
+  huffman_build(dist, lengths, INFLATE_DIST_SYMBOLS);
+}
+
+/*
+ * Incomplete codes are accepted, a stream may well use a single distance
+ * code, over-subscribed ones are not.
+ */
+static bool huffman_build(Huffman *h, const uint8_t *lengths, uint32_t count)
+{
+  uint32_t counts[INFLATE_MAX_BITS + 1] = { 0 };
+  uint32_t next_code[INFLATE_MAX_BITS + 1];
+  memset(h->fast, 0, sizeof(h->fast));
+  for (uint32_t i = 0; i < count; i++)
+  {
+    counts[lengths[i]]++;
+  }
+  counts[0] = 0;
+
+  uint32_t code = 0;
+  uint32_t symbol = 0;
+  for (uint32_t length = 1; length <= INFLATE_MAX_BITS; length++)
+  {
+    next_code[length] = code;
+    h->first_code[length] = (uint16_t) code;
+    h->first_symbol[length] = (uint16_t) symbol;
+    code += counts[length];
+    if (code > (1u << length))
+    {
+      return false;
+    }
+    h->max_code[length] = code << (16 - length);
+    code <<= 1;
+    symbol += counts[length];
+  }
+  h->max_code[INFLATE_MAX_BITS + 1] = 0x10000;
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint32_t length = lengths[i];
+    if (length == 0)
+    {
+      continue;
+    }
+    uint32_t index = next_code[length] - h->first_code[length] +
+      h->first_symbol[length];
+    h->symbols[index] = (uint16_t) i;
+    if (length <= INFLATE_FAST_BITS)
+    {
+      uint16_t entry = (uint16_t) (length << 9 | i);
+      for (uint32_t j = reverse_bits(next_code[length], length);
+           j < INFLATE_FAST_SIZE; j += 1u << length)
+      {
+        h->fast[j] = entry;
+      }
+    }
+    next_code[length]++;
+  }
+  return true;
+}
+
+static int decode_symbol(BitReader *br, const Huffman *h)
+{
+  if (br->count < INFLATE_MAX_BITS)
+  {
+    refill(br);
+  }
+  uint32_t entry = h->fast[br->bits & (INFLATE_FAST_SIZE - 1)];
+  if (entry != 0)
+  {
+    take_bits(br, entry >> 9);
+    return (int) (entry & 511);
+  }
+  return decode_slow(br, h);
+}
+
+static int decode_slow(BitReader *br, const Huffman *h)
+{
+  uint32_t code = reverse_bits((uint32_t) br->bits & 0xffff, 16);
+  uint32_t length = INFLATE_FAST_BITS + 1;
+  while (code >= h->max_code[length])
+  {
+    length++;
+  }
+  if (length > INFLATE_MAX_BITS)
+  {
+    return -1;
+  }
+  take_bits(br, length);
+  uint32_t index = (code >> (16 - length)) - h->first_code[length] +
+    h->first_symbol[length];
+  return h->symbols[index];
+}
+
+static bool decode_block(BitReader *br, const Huffman *litlen,
+                         const Huffman *dist, uint8_t *dst, uint8_t **out,
+                         uint8_t *out_end)
+{
+  uint8_t *op = *out;
+  for (;;)
+  {
+    int symbol = decode_symbol(br, litlen);
+    if (symbol < INFLATE_END_OF_BLOCK)
+    {
+      if (symbol < 0 || op == out_end)
+      {
+        return false;
+      }
+      *op++ = (uint8_t) symbol;
+      continue;
+    }
+    if (symbol == INFLATE_END_OF_BLOCK)
+    {
+      break;
+    }
+
+    symbol -= 257;
+    if (symbol >= 29)
+    {
+      return false;
+    }
+    refill(br);
+    size_t length = length_base[symbol] +
+      take_bits(br, length_extra[symbol]);
+    int dist_symbol = decode_symbol(br, dist);
+    if (dist_symbol < 0 || dist_symbol >= 30)
+    {
+      return false;
+    }
+    refill(br);
+    size_t distance = dist_base[dist_symbol] +
+      take_bits(br, dist_extra[dist_symbol]);
+    if (distance > (size_t) (op - dst) || length > (size_t) (out_end - op))
+    {
+      return false;
+    }
+
+    const uint8_t *match = op - distance;
+    if (distance >= 8 && (size_t) (out_end - op) >= length + 8)
+    {
+      /* Whole words never overlap at this distance, overshoot is rewritten. */
+      uint8_t *copy_end = op + length;
+      do
+      {
+        memcpy(op, match, 8);
+        op += 8;
+        match += 8;
+      } while (op < copy_end);
+      op = copy_end;
+    } else
+    {
+      for (size_t i = 0; i < length; i++)
+      {
+        op[i] = match[i];
+      }
+      op += length;
+    }
+  }
+  *out = op;
+  return reader_valid(br);
+}
+
+/*
+ * Tops the buffer up to at least 56 bits.  The word load may leave part of
+ * the next byte above `count`, which the next refill ORs in again unchanged.
+ */
+static void refill(BitReader *br)
+{
+  if (br->end - br->p >= 8)
+  {
+    const uint8_t *p = br->p;
+    uint64_t word = (uint64_t) p[0] | (uint64_t) p[1] << 8 |
+      (uint64_t) p[2] << 16 | (uint64_t) p[3] << 24 |
+      (uint64_t) p[4] << 32 | (uint64_t) p[5] << 40 |
+      (uint64_t) p[6] << 48 | (uint64_t) p[7] << 56;
+    br->bits |= word << br->count;
+    br->p += (63 - br->count) >> 3;
+    br->count |= 56;
+    return;
+  }
+  while (br->count <= 56)
+  {
+    if (br->p < br->end)
+    {
+      br->bits |= (uint64_t) *br->p++ << br->count;
+    } else
+    {
+      br->phantom++;
+    }
+    br->count += 8;
+  }
+}
+
+static uint32_t take_bits(BitReader *br, uint32_t n)
+{
+  uint32_t value = (uint32_t) (br->bits & ((1ull << n) - 1));
+  br->bits >>= n;
+  br->count -= n;
+  return value;
+}
+
+/* Whether every bit taken so far came from the input. */
+static bool reader_valid(const BitReader *br)
+{
+  return br->count >= br->phantom * 8;
+}
+
+static uint32_t reverse_bits(uint32_t code, uint32_t length)
+{
+  code = (code & 0xaaaa) >> 1 | (code & 0x5555) << 1;
+  code = (code & 0xcccc) >> 2 | (code & 0x3333) << 2;
+  code = (code & 0xf0f0) >> 4 | (code & 0x0f0f) << 4;
+  code = (code & 0xff00) >> 8 | (code & 0x00ff) << 8;
+  return code >> (16 - length);
+}
+
+static uint32_t adler32(const uint8_t *data, size_t size)
+{
+  uint32_t a = 1, b = 0;
+  while (size > 0)
+  {
+    size_t n = size < ADLER_NMAX ? size : ADLER_NMAX;
+    size -= n;
+    while (n-- > 0)
+    {
+      a += *data++;
+      b += a;
+    }
+    a %= ADLER_MOD;
+    b %= ADLER_MOD;
+  }
+  return b << 16 | a;
+}
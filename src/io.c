@@ -0,0 +1,601 @@
+/* =====================
+ * src/io.c
+ * 10/18/2026
+ * Asynchronous file loading.
+ * ====================
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <miur/io_priv.h>
+#include <miur/log.h>
+#include <miur/mem.h>
+
+#ifdef MIUR_PLATFORM_WINDOWS
+#include <malloc.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define IO_INVALID_FILE ((intptr_t) -1)
+
+/* === PROTOTYPES === */
+
+static void pool_worker_function(void *ud);
+static void pool_read(IoService *io, IoRequest *req);
+static bool can_read_direct(IoRequest *req);
+static void wake_backend(IoService *io);
+static intptr_t file_open(const char *path, bool direct, bool overlapped);
+static bool file_size(intptr_t file, uint64_t *size_out);
+static void file_close(intptr_t file);
+static int64_t file_read(intptr_t file, void *dst, size_t size,
+                         uint64_t offset);
+static void *aligned_alloc_io(size_t size);
+static void aligned_free_io(void *ptr);
+
+/* === PUBLIC FUNCTIONS === */
+
+IoService *io_service_create(const IoServiceDesc *desc)
+{
+  IoService *io = MIUR_NEW(IoService);
+  if (io == NULL)
+  {
+    return NULL;
+  }
+
+  io->jobs = desc->jobs;
+  io->queue_depth = desc->queue_depth > 0 ? desc->queue_depth :
+    IO_DEFAULT_QUEUE_DEPTH;
+  mutex_create(&io->mutex, MUTEX_PLAIN);
+  cond_create(&io->cond);
+
+  IoBackend backend = desc->backend;
+  if (backend == IO_BACKEND_AUTO || backend == IO_BACKEND_URING)
+  {
+#ifdef MIUR_IO_HAVE_URING
+    if (io_uring_backend_create(io))
+    {
+      io->backend = IO_BACKEND_URING;
+      return io;
+    }
+    MIUR_LOG_INFO("io_uring unavailable, using thread pool I/O");
+#endif
+  }
+  if (backend == IO_BACKEND_AUTO || backend == IO_BACKEND_IOCP)
+  {
+#ifdef MIUR_PLATFORM_WINDOWS
+    if (io_iocp_backend_create(io))
+    {
+      io->backend = IO_BACKEND_IOCP;
+      return io;
+    }
+    MIUR_LOG_INFO("I/O completion port unavailable, using thread pool I/O");
+#endif
+  }
+
+  io->backend = IO_BACKEND_THREADS;
+  uint32_t thread_count = desc->thread_count > 0 ? desc->thread_count :
+    IO_DEFAULT_THREAD_COUNT;
+  io->threads = MIUR_ARR(Thread, thread_count);
+  if (io->threads == NULL)
+  {
+    io_service_destroy(io);
+    return NULL;
+  }
+  for (uint32_t i = 0; i < thread_count; i++)
+  {
+    if (!thread_create(&io->threads[i], pool_worker_function, io))
+    {
+      break;
+    }
+    io->thread_count++;
+  }
+  if (io->thread_count == 0)
+  {
+    MIUR_LOG_ERR("Failed to create I/O threads");
+    io_service_destroy(io);
+    return NULL;
+  }
+
+  return io;
+}
+
+void io_service_destroy(IoService *io)
+{
+  mutex_lock(&io->mutex);
+  while (atomic_i32_load(&io->outstanding) > 0)
+  {
+    cond_wait(&io->cond, &io->mutex);
+  }
+  io->should_quit = true;
+  cond_broadcast(&io->cond);
+  mutex_unlock(&io->mutex);
+
+  switch (io->backend)
+  {
+  case IO_BACKEND_URING:
+#ifdef MIUR_IO_HAVE_URING
+    io_uring_backend_destroy(io);
+#endif
+    break;
+  case IO_BACKEND_IOCP:
+#ifdef MIUR_PLATFORM_WINDOWS
+    io_iocp_backend_destroy(io);
+#endif
+    break;
+  default:
+    break;
+  }
+
+  for (uint32_t i = 0; i < io->thread_count; i++)
+  {
+    thread_join(&io->threads[i]);
+    thread_destroy(&io->threads[i]);
+  }
+
+  cond_destroy(&io->cond);
+  mutex_destroy(&io->mutex);
+  MIUR_FREE(io->threads);
+  MIUR_FREE(io->buffers);
+  MIUR_FREE(io);
+}
+
+IoBackend io_service_backend(IoService *io)
+{
+  return io->backend;
+}
+
+bool io_service_register_buffers(IoService *io, const IoBuffer *buffers,
+                                 size_t count)
+{
+  IoBuffer *copy = NULL;
+  if (count > 0)
+  {
+    copy = MIUR_ARR(IoBuffer, count);
+    if (copy == NULL)
+    {
+      return false;
+    }
+    memcpy(copy, buffers, sizeof(IoBuffer) * count);
+  }
+
+#ifdef MIUR_IO_HAVE_URING
+  if (io->backend == IO_BACKEND_URING &&
+      !io_uring_backend_register(io, buffers, count))
+  {
+    MIUR_FREE(copy);
+    return false;
+  }
+#endif
+
+  MIUR_FREE(io->buffers);
+  io->buffers = copy;
+  io->buffer_count = count;
+  return true;
+}
+
+void io_request_init(IoRequest *req, const char *path)
+{
+  memset(req, 0, sizeof(IoRequest));
+  req->path = path;
+  req->buffer_index = -1;
+  req->file = IO_INVALID_FILE;
+}
+
+void io_submit(IoService *io, IoRequest *reqs, size_t count)
+{
+  if (count == 0)
+  {
+    return;
+  }
+
+  for (size_t i = 0; i < count; i++)
+  {
+    reqs[i].status = IO_PENDING;
+    reqs[i].data = NULL;
+    reqs[i].buffer = NULL;
+    reqs[i].bytes_read = 0;
+    reqs[i].file = IO_INVALID_FILE;
+    reqs[i].next = i + 1 < count ? &reqs[i + 1] : NULL;
+    if (reqs[i].counter != NULL)
+    {
+      job_counter_add(reqs[i].counter, 1);
+    }
+  }
+
+  atomic_i32_add(&io->outstanding, (int32_t) count);
+
+  mutex_lock(&io->mutex);
+  if (io->pending_tail != NULL)
+  {
+    io->pending_tail->next = &reqs[0];
+  }
+  else
+  {
+    io->pending_head = &reqs[0];
+  }
+  io->pending_tail = &reqs[count - 1];
+  if (io->backend == IO_BACKEND_THREADS)
+  {
+    cond_broadcast(&io->cond);
+  }
+  mutex_unlock(&io->mutex);
+
+  wake_backend(io);
+}
+
+void io_request_release(IoRequest *req)
+{
+  aligned_free_io(req->buffer);
+  req->buffer = NULL;
+  req->data = NULL;
+}
+
+IoRequest *io_take_pending(IoService *io, size_t max)
+{
+  if (max == 0)
+  {
+    return NULL;
+  }
+
+  mutex_lock(&io->mutex);
+  IoRequest *head = io->pending_head;
+  IoRequest *tail = head;
+  for (size_t i = 1; tail != NULL && i < max; i++)
+  {
+    tail = tail->next;
+  }
+  if (tail == NULL || tail->next == NULL)
+  {
+    io->pending_head = io->pending_tail = NULL;
+  }
+  else
+  {
+    io->pending_head = tail->next;
+    tail->next = NULL;
+  }
+  mutex_unlock(&io->mutex);
+
+  return head;
+}
+
+bool io_prepare_request(IoService *io, IoRequest *req, bool overlapped)
+{
+  bool direct = (req->flags & IO_READ_DIRECT) && can_read_direct(req);
+
+  req->file = file_open(req->path, direct, overlapped);
+  if (req->file == IO_INVALID_FILE)
+  {
+    MIUR_LOG_ERR("Failed to open '%s'", req->path);
+    io_complete_request(io, req, false);
+    return false;
+  }
+
+  uint64_t size;
+  if (!file_size(req->file, &size) || req->offset > size ||
+      (req->size > 0 && req->size > size - req->offset))
+  {
+    MIUR_LOG_ERR("Read of %zu bytes at %" PRIu64 " is past the end of '%s'",
+                 req->size, req->offset, req->path);
+    io_complete_request(io, req, false);
+    return false;
+  }
+
+  uint64_t want = req->size > 0 ? req->size : size - req->offset;
+  if (want > SIZE_MAX - 2 * IO_DIRECT_ALIGNMENT)
+  {
+    io_complete_request(io, req, false);
+    return false;
+  }
+  req->bytes_read = (size_t) want;
+
+  if (want == 0)
+  {
+    req->data = req->dst;
+    io_complete_request(io, req, true);
+    return false;
+  }
+
+  if (req->dst != NULL)
+  {
+    req->data = req->dst;
+    req->read_offset = req->offset;
+    req->read_size = req->read_needed = (size_t) want;
+  }
+  else if (direct)
+  {
+    /* Read whole aligned blocks into staging and point into it. */
+    uint64_t mask = IO_DIRECT_ALIGNMENT - 1;
+    size_t head = (size_t) (req->offset & mask);
+    req->read_offset = req->offset - head;
+    req->read_needed = head + (size_t) want;
+    req->read_size = (req->read_needed + mask) & ~(size_t) mask;
+    req->buffer = aligned_alloc_io(req->read_size);
+    req->data = req->buffer + head;
+  }
+  else
+  {
+    req->read_offset = req->offset;
+    req->read_size = req->read_needed = (size_t) want;
+    req->buffer = aligned_alloc_io(req->read_size);
+    req->data = req->buffer;
+  }
+
+  if (req->data == NULL)
+  {
+    MIUR_LOG_ERR("Out of memory reading '%s'", req->path);
+    io_complete_request(io, req, false);
+    return false;
+  }
+
+  req->read_done = 0;
+  return true;
+}
+
+void io_complete_request(IoService *io, IoRequest *req, bool success)
+{
+  if (req->file != IO_INVALID_FILE)
+  {
+    file_close(req->file);
+    req->file = IO_INVALID_FILE;
+  }
+
+  if (!success)
+  {
+    aligned_free_io(req->buffer);
+    req->buffer = NULL;
+    req->data = NULL;
+    req->bytes_read = 0;
+  }
+  req->status = success ? IO_DONE : IO_FAILED;
+
+  /* The request may be gone once its counter is signalled. */
+  JobCounter *counter = req->counter;
+  if (req->callback != NULL)
+  {
+    req->callback(req);
+  }
+  if (counter != NULL)
+  {
+    if (io->jobs != NULL)
+    {
+      job_counter_signal(io->jobs, counter);
+    }
+    else
+    {
+      job_counter_add(counter, -1);
+    }
+  }
+
+  if (atomic_i32_add(&io->outstanding, -1) == 0)
+  {
+    mutex_lock(&io->mutex);
+    cond_broadcast(&io->cond);
+    mutex_unlock(&io->mutex);
+  }
+}
+
+uint8_t *io_read_target(IoRequest *req)
+{
+  return req->buffer != NULL ? req->buffer : (uint8_t *) req->dst;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void pool_worker_function(void *ud)
+{
+  IoService *io = (IoService *) ud;
+
+  for (;;)
+  {
+    mutex_lock(&io->mutex);
+    while (io->pending_head == NULL && !io->should_quit)
+    {
+      cond_wait(&io->cond, &io->mutex);
+    }
+    bool quit = io->pending_head == NULL;
+    mutex_unlock(&io->mutex);
+    if (quit)
+    {
+      return;
+    }
+
+    IoRequest *req = io_take_pending(io, 1);
+    if (req != NULL)
+    {
+      pool_read(io, req);
+    }
+  }
+}
+
+static void pool_read(IoService *io, IoRequest *req)
+{
+  if (!io_prepare_request(io, req, false))
+  {
+    return;
+  }
+
+  uint8_t *target = io_read_target(req);
+  while (req->read_done < req->read_size)
+  {
+    size_t chunk = req->read_size - req->read_done;
+    chunk = chunk < IO_MAX_READ_CHUNK ? chunk : IO_MAX_READ_CHUNK;
+
+    int64_t result = file_read(req->file, target + req->read_done, chunk,
+                               req->read_offset + req->read_done);
+    if (result < 0)
+    {
+      MIUR_LOG_ERR("Failed to read '%s'", req->path);
+      io_complete_request(io, req, false);
+      return;
+    }
+    if (result == 0)
+    {
+      break;
+    }
+    req->read_done += (size_t) result;
+  }
+
+  io_complete_request(io, req, req->read_done >= req->read_needed);
+}
+
+static bool can_read_direct(IoRequest *req)
+{
+  if (req->dst == NULL)
+  {
+    /* Staging is allocated aligned, any range can be read. */
+    return true;
+  }
+  return ((uintptr_t) req->dst % IO_DIRECT_ALIGNMENT) == 0 &&
+    req->offset % IO_DIRECT_ALIGNMENT == 0 &&
+    req->size > 0 && req->size % IO_DIRECT_ALIGNMENT == 0;
+}
+
+static void wake_backend(IoService *io)
+{
+  switch (io->backend)
+  {
+  case IO_BACKEND_URING:
+#ifdef MIUR_IO_HAVE_URING
+    io_uring_backend_wake(io);
+#endif
+    break;
+  case IO_BACKEND_IOCP:
+#ifdef MIUR_PLATFORM_WINDOWS
+    io_iocp_backend_wake(io);
+#endif
+    break;
+  default:
+    break;
+  }
+}
+
+#ifdef MIUR_PLATFORM_WINDOWS
+
+static intptr_t file_open(const char *path, bool direct, bool overlapped)
+{
+  DWORD flags = FILE_ATTRIBUTE_NORMAL;
+  if (direct)
+  {
+    flags |= FILE_FLAG_NO_BUFFERING;
+  }
+  if (overlapped)
+  {
+    flags |= FILE_FLAG_OVERLAPPED;
+  }
+
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, flags, NULL);
+  return file == INVALID_HANDLE_VALUE ? IO_INVALID_FILE : (intptr_t) file;
+}
+
+static bool file_size(intptr_t file, uint64_t *size_out)
+{
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx((HANDLE) file, &size))
+  {
+    return false;
+  }
+  *size_out = (uint64_t) size.QuadPart;
+  return true;
+}
+
+static void file_close(intptr_t file)
+{
+  CloseHandle((HANDLE) file);
+}
+
+static int64_t file_read(intptr_t file, void *dst, size_t size,
+                         uint64_t offset)
+{
+  OVERLAPPED overlapped = {
+    .Offset = (DWORD) offset,
+    .OffsetHigh = (DWORD) (offset >> 32),
+  };
+  DWORD read;
+  if (!ReadFile((HANDLE) file, dst, (DWORD) size, &read, &overlapped))
+  {
+    return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+  }
+  return read;
+}
+
+static void *aligned_alloc_io(size_t size)
+{
+  return _aligned_malloc(size, IO_DIRECT_ALIGNMENT);
+}
+
+static void aligned_free_io(void *ptr)
+{
+  _aligned_free(ptr);
+}
+
+#else
+
+static intptr_t file_open(const char *path, bool direct, bool overlapped)
+{
+  (void) overlapped;
+  int flags = O_RDONLY;
+#ifdef O_DIRECT
+  if (direct)
+  {
+    flags |= O_DIRECT;
+  }
+#endif
+
+  int fd = open(path, flags);
+#ifdef O_DIRECT
+  /* Some file systems (tmpfs) reject O_DIRECT, read those buffered. */
+  if (fd < 0 && direct)
+  {
+    fd = open(path, O_RDONLY);
+  }
+#else
+  (void) direct;
+#endif
+  return fd < 0 ? IO_INVALID_FILE : fd;
+}
+
+static bool file_size(intptr_t file, uint64_t *size_out)
+{
+  struct stat st;
+  if (fstat((int) file, &st) != 0)
+  {
+    return false;
+  }
+  *size_out = (uint64_t) st.st_size;
+  return true;
+}
+
+static void file_close(intptr_t file)
+{
+  close((int) file);
+}
+
+static int64_t file_read(intptr_t file, void *dst, size_t size,
+                         uint64_t offset)
+{
+  ssize_t result;
+  do
+  {
+    result = pread((int) file, dst, size, (off_t) offset);
+  } while (result < 0 && errno == EINTR);
+  return result;
+}
+
+static void *aligned_alloc_io(size_t size)
+{
+  void *ptr;
+  return posix_memalign(&ptr, IO_DIRECT_ALIGNMENT, size) == 0 ? ptr : NULL;
+}
+
+static void aligned_free_io(void *ptr)
+{
+  free(ptr);
+}
+
+#endif
@@ -0,0 +1,206 @@
+/* =====================
+ * src/io_iocp.c
+ * 10/18/2026
+ * I/O completion port backend for asynchronous file loading.
+ * ====================
+ */
+
+#include <miur/io_priv.h>
+
+#ifdef MIUR_PLATFORM_WINDOWS
+
+#include <string.h>
+
+#include <miur/log.h>
+#include <miur/mem.h>
+
+#define IOCP_WAKE_KEY 1
+#define IOCP_FILE_KEY 2
+
+typedef struct
+{
+  HANDLE port;
+  uint32_t inflight;
+  Thread thread;
+} IocpBackend;
+
+/* === PROTOTYPES === */
+
+static void port_function(void *ud);
+static void issue_read(IoService *io, IocpBackend *iocp, IoRequest *req);
+static void handle_completion(IoService *io, IocpBackend *iocp,
+                              IoRequest *req, DWORD bytes);
+
+/* === PUBLIC FUNCTIONS === */
+
+bool io_iocp_backend_create(IoService *io)
+{
+  IocpBackend *iocp = MIUR_NEW(IocpBackend);
+  if (iocp == NULL)
+  {
+    return false;
+  }
+
+  iocp->port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+  if (iocp->port == NULL)
+  {
+    MIUR_FREE(iocp);
+    return false;
+  }
+
+  io->backend_data = iocp;
+  if (!thread_create(&iocp->thread, port_function, io))
+  {
+    io->backend_data = NULL;
+    CloseHandle(iocp->port);
+    MIUR_FREE(iocp);
+    return false;
+  }
+  return true;
+}
+
+void io_iocp_backend_destroy(IoService *io)
+{
+  IocpBackend *iocp = (IocpBackend *) io->backend_data;
+
+  io_iocp_backend_wake(io);
+  thread_join(&iocp->thread);
+  thread_destroy(&iocp->thread);
+
+  CloseHandle(iocp->port);
+  MIUR_FREE(iocp);
+  io->backend_data = NULL;
+}
+
+void io_iocp_backend_wake(IoService *io)
+{
+  IocpBackend *iocp = (IocpBackend *) io->backend_data;
+  PostQueuedCompletionStatus(iocp->port, 0, IOCP_WAKE_KEY, NULL);
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void port_function(void *ud)
+{
+  IoService *io = (IoService *) ud;
+  IocpBackend *iocp = (IocpBackend *) io->backend_data;
+
+  for (;;)
+  {
+    IoRequest *req = io_take_pending(io, io->queue_depth - iocp->inflight);
+    while (req != NULL)
+    {
+      IoRequest *next = req->next;
+      /* Opening is synchronous, only the reads are overlapped. */
+      if (io_prepare_request(io, req, true))
+      {
+        if (CreateIoCompletionPort((HANDLE) req->file, iocp->port,
+                                   IOCP_FILE_KEY, 0) == NULL)
+        {
+          MIUR_LOG_ERR("Failed to associate '%s' with the I/O port",
+                       req->path);
+          io_complete_request(io, req, false);
+        }
+        else
+        {
+          issue_read(io, iocp, req);
+        }
+      }
+      req = next;
+    }
+
+    mutex_lock(&io->mutex);
+    bool quit = io->should_quit && io->pending_head == NULL &&
+      iocp->inflight == 0;
+    mutex_unlock(&io->mutex);
+    if (quit)
+    {
+      return;
+    }
+
+    DWORD bytes;
+    ULONG_PTR key;
+    OVERLAPPED *overlapped;
+    BOOL ok = GetQueuedCompletionStatus(iocp->port, &bytes, &key,
+                                        &overlapped, INFINITE);
+    if (overlapped == NULL)
+    {
+      /* A wake up, or the port failed and there is nothing to finish. */
+      if (!ok)
+      {
+        MIUR_LOG_ERR("GetQueuedCompletionStatus failed: %lu",
+                     GetLastError());
+        return;
+      }
+      continue;
+    }
+
+    req = CONTAINING_RECORD(overlapped, IoRequest, overlapped);
+    iocp->inflight--;
+    if (ok)
+    {
+      handle_completion(io, iocp, req, bytes);
+    }
+    else if (GetLastError() == ERROR_HANDLE_EOF)
+    {
+      io_complete_request(io, req, req->read_done >= req->read_needed);
+    }
+    else
+    {
+      MIUR_LOG_ERR("Failed to read '%s': %lu", req->path, GetLastError());
+      io_complete_request(io, req, false);
+    }
+  }
+}
+
+static void issue_read(IoService *io, IocpBackend *iocp, IoRequest *req)
+{
+  uint64_t offset = req->read_offset + req->read_done;
+  size_t size = req->read_size - req->read_done;
+  size = size < IO_MAX_READ_CHUNK ? size : IO_MAX_READ_CHUNK;
+
+  memset(&req->overlapped, 0, sizeof(OVERLAPPED));
+  req->overlapped.Offset = (DWORD) offset;
+  req->overlapped.OffsetHigh = (DWORD) (offset >> 32);
+
+  /* Completions are posted to the port even if the read finishes at once. */
+  if (!ReadFile((HANDLE) req->file, io_read_target(req) + req->read_done,
+                (DWORD) size, NULL, &req->overlapped))
+  {
+    DWORD err = GetLastError();
+    if (err == ERROR_HANDLE_EOF)
+    {
+      io_complete_request(io, req, req->read_done >= req->read_needed);
+      return;
+    }
+    if (err != ERROR_IO_PENDING)
+    {
+      MIUR_LOG_ERR("Failed to read '%s': %lu", req->path, err);
+      io_complete_request(io, req, false);
+      return;
+    }
+  }
+  iocp->inflight++;
+}
+
+static void handle_completion(IoService *io, IocpBackend *iocp,
+                              IoRequest *req, DWORD bytes)
+{
+  if (bytes == 0)
+  {
+    io_complete_request(io, req, req->read_done >= req->read_needed);
+    return;
+  }
+
+  req->read_done += bytes;
+  if (req->read_done >= req->read_size)
+  {
+    io_complete_request(io, req, true);
+  }
+  else
+  {
+    issue_read(io, iocp, req);
+  }
+}
+
+#endif
@@ -0,0 +1,441 @@
+/* =====================
+ * src/io_uring.c
+ * 10/18/2026
+ * io_uring backend for asynchronous file loading.
+ * ====================
+ */
+
+#include <miur/io_priv.h>
+
+#ifdef MIUR_IO_HAVE_URING
+
+#include <errno.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+
+#include <miur/log.h>
+#include <miur/mem.h>
+
+/* user_data of the read that waits on the wake eventfd. */
+#define URING_WAKE_TAG 0
+
+typedef struct
+{
+  int ring_fd;
+  int event_fd;
+  uint64_t event_value;
+  bool event_armed;
+
+  unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+  unsigned sq_entries, sq_pending;
+  struct io_uring_sqe *sqes;
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  struct io_uring_cqe *cqes;
+
+  void *sq_ring, *cq_ring;
+  size_t sq_ring_size, cq_ring_size, sqes_size;
+
+  uint32_t inflight;
+  Thread thread;
+} UringBackend;
+
+/* === PROTOTYPES === */
+
+static void ring_function(void *ud);
+static struct io_uring_sqe *get_sqe(UringBackend *ring);
+static bool queue_read(IoService *io, UringBackend *ring, IoRequest *req);
+static void arm_wake(UringBackend *ring);
+static bool submit_and_wait(UringBackend *ring);
+static void reap_completions(IoService *io, UringBackend *ring);
+static void handle_completion(IoService *io, UringBackend *ring,
+                              IoRequest *req, int result);
+static void unmap_rings(UringBackend *ring);
+
+/* === PUBLIC FUNCTIONS === */
+
+bool io_uring_backend_create(IoService *io)
+{
+  UringBackend *ring = MIUR_NEW(UringBackend);
+  if (ring == NULL)
+  {
+    return false;
+  }
+  ring->event_fd = -1;
+
+  /* Room for every in flight read plus the wake read. */
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring->ring_fd = (int) syscall(__NR_io_uring_setup, io->queue_depth + 1,
+                                &params);
+  if (ring->ring_fd < 0)
+  {
+    MIUR_FREE(ring);
+    return false;
+  }
+  /* IORING_OP_READ arrived in the same kernel as this flag. */
+  if (!(params.features & IORING_FEAT_RW_CUR_POS))
+  {
+    goto error;
+  }
+
+  ring->sq_ring_size = params.sq_off.array + params.sq_entries *
+    sizeof(unsigned);
+  ring->cq_ring_size = params.cq_off.cqes + params.cq_entries *
+    sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP)
+  {
+    if (ring->cq_ring_size > ring->sq_ring_size)
+    {
+      ring->sq_ring_size = ring->cq_ring_size;
+    }
+    ring->cq_ring_size = ring->sq_ring_size;
+  }
+
+  ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring->ring_fd,
+                       IORING_OFF_SQ_RING);
+  if (ring->sq_ring == MAP_FAILED)
+  {
+    ring->sq_ring = NULL;
+    goto error;
+  }
+  if (params.features & IORING_FEAT_SINGLE_MMAP)
+  {
+    ring->cq_ring = ring->sq_ring;
+  }
+  else
+  {
+    ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring->ring_fd,
+                         IORING_OFF_CQ_RING);
+    if (ring->cq_ring == MAP_FAILED)
+    {
+      ring->cq_ring = NULL;
+      goto error;
+    }
+  }
+
+  ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring->ring_fd,
+                    IORING_OFF_SQES);
+  if (ring->sqes == MAP_FAILED)
+  {
+    ring->sqes = NULL;
+    goto error;
+  }
+
+  uint8_t *sq = ring->sq_ring, *cq = ring->cq_ring;
+  ring->sq_head = (unsigned *) (sq + params.sq_off.head);
+  ring->sq_tail = (unsigned *) (sq + params.sq_off.tail);
+  ring->sq_mask = (unsigned *) (sq + params.sq_off.ring_mask);
+  ring->sq_array = (unsigned *) (sq + params.sq_off.array);
+  ring->sq_entries = params.sq_entries;
+  ring->cq_head = (unsigned *) (cq + params.cq_off.head);
+  ring->cq_tail = (unsigned *) (cq + params.cq_off.tail);
+  ring->cq_mask = (unsigned *) (cq + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+
+  ring->event_fd = eventfd(0, EFD_CLOEXEC);
+  if (ring->event_fd < 0)
+  {
+    goto error;
+  }
+
+  io->backend_data = ring;
+  if (!thread_create(&ring->thread, ring_function, io))
+  {
+    io->backend_data = NULL;
+    goto error;
+  }
+  return true;
+
+error:
+  unmap_rings(ring);
+  MIUR_FREE(ring);
+  return false;
+}
+
+void io_uring_backend_destroy(IoService *io)
+{
+  UringBackend *ring = (UringBackend *) io->backend_data;
+
+  io_uring_backend_wake(io);
+  thread_join(&ring->thread);
+  thread_destroy(&ring->thread);
+
+  unmap_rings(ring);
+  MIUR_FREE(ring);
+  io->backend_data = NULL;
+}
+
+void io_uring_backend_wake(IoService *io)
+{
+  UringBackend *ring = (UringBackend *) io->backend_data;
+  uint64_t one = 1;
+  ssize_t written;
+  do
+  {
+    written = write(ring->event_fd, &one, sizeof(one));
+  } while (written < 0 && errno == EINTR);
+}
+
+bool io_uring_backend_register(IoService *io, const IoBuffer *buffers,
+                               size_t count)
+{
+  UringBackend *ring = (UringBackend *) io->backend_data;
+
+  if (io->buffer_count > 0)
+  {
+    syscall(__NR_io_uring_register, ring->ring_fd,
+            IORING_UNREGISTER_BUFFERS, NULL, 0);
+  }
+  if (count == 0)
+  {
+    return true;
+  }
+
+  struct iovec *iovs = MIUR_ARR(struct iovec, count);
+  if (iovs == NULL)
+  {
+    return false;
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    iovs[i].iov_base = buffers[i].data;
+    iovs[i].iov_len = buffers[i].size;
+  }
+
+  long result = syscall(__NR_io_uring_register, ring->ring_fd,
+                        IORING_REGISTER_BUFFERS, iovs, (unsigned) count);
+  MIUR_FREE(iovs);
+  if (result < 0)
+  {
+    MIUR_LOG_ERR("Failed to register %zu I/O buffers: %s", count,
+                 strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void ring_function(void *ud)
+{
+  IoService *io = (IoService *) ud;
+  UringBackend *ring = (UringBackend *) io->backend_data;
+
+  for (;;)
+  {
+    if (!ring->event_armed)
+    {
+      arm_wake(ring);
+    }
+
+    IoRequest *req = io_take_pending(io, io->queue_depth - ring->inflight);
+    while (req != NULL)
+    {
+      IoRequest *next = req->next;
+      /* Opening is synchronous, only the reads go through the ring. */
+      if (io_prepare_request(io, req, false))
+      {
+        queue_read(io, ring, req);
+      }
+      req = next;
+    }
+
+    mutex_lock(&io->mutex);
+    bool quit = io->should_quit && io->pending_head == NULL &&
+      ring->inflight == 0;
+    mutex_unlock(&io->mutex);
+    if (quit)
+    {
+      return;
+    }
+
+    if (!submit_and_wait(ring))
+    {
+      MIUR_LOG_ERR("io_uring_enter failed: %s", strerror(errno));
+      return;
+    }
+    reap_completions(io, ring);
+  }
+}
+
+static struct io_uring_sqe *get_sqe(UringBackend *ring)
+{
+  unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+  unsigned tail = *ring->sq_tail;
+  if (tail - head >= ring->sq_entries)
+  {
+    return NULL;
+  }
+
+  unsigned index = tail & *ring->sq_mask;
+  struct io_uring_sqe *sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  ring->sq_array[index] = index;
+  __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+  ring->sq_pending++;
+  return sqe;
+}
+
+static bool queue_read(IoService *io, UringBackend *ring, IoRequest *req)
+{
+  struct io_uring_sqe *sqe = get_sqe(ring);
+  if (sqe == NULL)
+  {
+    /* Can't happen while in flight reads are capped below the ring size. */
+    io_complete_request(io, req, false);
+    return false;
+  }
+
+  uint8_t *target = io_read_target(req) + req->read_done;
+  size_t size = req->read_size - req->read_done;
+  size = size < IO_MAX_READ_CHUNK ? size : IO_MAX_READ_CHUNK;
+
+  sqe->opcode = IORING_OP_READ;
+  if (req->buffer_index >= 0 && (size_t) req->buffer_index < io->buffer_count)
+  {
+    IoBuffer *buffer = &io->buffers[req->buffer_index];
+    uint8_t *start = (uint8_t *) buffer->data;
+    if (target >= start && target + size <= start + buffer->size)
+    {
+      sqe->opcode = IORING_OP_READ_FIXED;
+      sqe->buf_index = (uint16_t) req->buffer_index;
+    }
+  }
+  sqe->fd = (int) req->file;
+  sqe->off = req->read_offset + req->read_done;
+  sqe->addr = (uintptr_t) target;
+  sqe->len = (uint32_t) size;
+  sqe->user_data = (uintptr_t) req;
+
+  ring->inflight++;
+  return true;
+}
+
+static void arm_wake(UringBackend *ring)
+{
+  struct io_uring_sqe *sqe = get_sqe(ring);
+  if (sqe == NULL)
+  {
+    return;
+  }
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = ring->event_fd;
+  sqe->addr = (uintptr_t) &ring->event_value;
+  sqe->len = sizeof(ring->event_value);
+  sqe->user_data = URING_WAKE_TAG;
+  ring->event_armed = true;
+}
+
+/*
+ * Submits queued entries and sleeps until at least one completes.  The wake
+ * read is always armed, so new requests and shutdown end the wait.
+ */
+static bool submit_and_wait(UringBackend *ring)
+{
+  for (;;)
+  {
+    long result = syscall(__NR_io_uring_enter, ring->ring_fd,
+                          ring->sq_pending, 1, IORING_ENTER_GETEVENTS,
+                          NULL, 0);
+    if (result >= 0)
+    {
+      ring->sq_pending -= (unsigned) result;
+      return true;
+    }
+    if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+    {
+      return false;
+    }
+  }
+}
+
+static void reap_completions(IoService *io, UringBackend *ring)
+{
+  unsigned head = *ring->cq_head;
+  unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+  while (head != tail)
+  {
+    struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+    uint64_t user_data = cqe->user_data;
+    int result = cqe->res;
+    head++;
+    /* Release the entry before handling it, handlers may queue more. */
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+    if (user_data == URING_WAKE_TAG)
+    {
+      ring->event_armed = false;
+    }
+    else
+    {
+      ring->inflight--;
+      handle_completion(io, ring, (IoRequest *) (uintptr_t) user_data,
+                        result);
+    }
+  }
+}
+
+static void handle_completion(IoService *io, UringBackend *ring,
+                              IoRequest *req, int result)
+{
+  if (result == -EINTR || result == -EAGAIN)
+  {
+    queue_read(io, ring, req);
+    return;
+  }
+  if (result < 0)
+  {
+    MIUR_LOG_ERR("Failed to read '%s': %s", req->path, strerror(-result));
+    io_complete_request(io, req, false);
+    return;
+  }
+  if (result == 0)
+  {
+    io_complete_request(io, req, req->read_done >= req->read_needed);
+    return;
+  }
+
+  req->read_done += (size_t) result;
+  if (req->read_done >= req->read_size)
+  {
+    io_complete_request(io, req, true);
+  }
+  else
+  {
+    /* Short read or a file larger than one chunk. */
+    queue_read(io, ring, req);
+  }
+}
+
+static void unmap_rings(UringBackend *ring)
+{
+  if (ring->sqes != NULL)
+  {
+    munmap(ring->sqes, ring->sqes_size);
+  }
+  if (ring->cq_ring != NULL && ring->cq_ring != ring->sq_ring)
+  {
+    munmap(ring->cq_ring, ring->cq_ring_size);
+  }
+  if (ring->sq_ring != NULL)
+  {
+    munmap(ring->sq_ring, ring->sq_ring_size);
+  }
+  if (ring->event_fd >= 0)
+  {
+    close(ring->event_fd);
+  }
+  close(ring->ring_fd);
+}
+
+#endif
@@ -0,0 +1,248 @@
+/* =====================
+ * src/job.c
+ * 10/18/2026
+ * Job system.
+ * ====================
+ */
+
+#include <miur/job.h>
+#include <miur/log.h>
+#include <miur/mem.h>
+
+#define JOB_QUEUE_INITIAL_CAPACITY 256
+
+typedef struct
+{
+  Job job;
+  JobCounter *counter;
+} QueuedJob;
+
+struct JobSystem
+{
+  Mutex mutex;
+  /* Signalled when jobs are queued and when a counter reaches zero. */
+  CondVar cond;
+  QueuedJob *queue;
+  size_t head, count, capacity;
+  bool should_quit;
+  Thread *workers;
+  uint32_t worker_count;
+};
+
+/* === PROTOTYPES === */
+
+static void worker_function(void *ud);
+static bool queue_push(JobSystem *jobs, const Job *job, JobCounter *counter);
+static bool queue_pop(JobSystem *jobs, QueuedJob *out);
+static void run_job(JobSystem *jobs, QueuedJob *queued);
+
+/* === PUBLIC FUNCTIONS === */
+
+JobSystem *job_system_create(uint32_t worker_count)
+{
+  JobSystem *jobs = MIUR_NEW(JobSystem);
+  if (jobs == NULL)
+  {
+    return NULL;
+  }
+
+  if (worker_count == 0)
+  {
+    worker_count = thread_cpu_count() - 1;
+  }
+
+  mutex_create(&jobs->mutex, MUTEX_PLAIN);
+  cond_create(&jobs->cond);
+  jobs->capacity = JOB_QUEUE_INITIAL_CAPACITY;
+  jobs->queue = MIUR_ARR(QueuedJob, jobs->capacity);
+  jobs->workers = MIUR_ARR(Thread, worker_count > 0 ? worker_count : 1);
+  if (jobs->queue == NULL || jobs->workers == NULL)
+  {
+    job_system_destroy(jobs);
+    return NULL;
+  }
+
+  for (uint32_t i = 0; i < worker_count; i++)
+  {
+    if (!thread_create(&jobs->workers[i], worker_function, jobs))
+    {
+      MIUR_LOG_ERR("Failed to create job worker %u", i);
+      break;
+    }
+    jobs->worker_count++;
+  }
+
+  return jobs;
+}
+
+void job_system_destroy(JobSystem *jobs)
+{
+  mutex_lock(&jobs->mutex);
+  jobs->should_quit = true;
+  cond_broadcast(&jobs->cond);
+  mutex_unlock(&jobs->mutex);
+
+  for (uint32_t i = 0; i < jobs->worker_count; i++)
+  {
+    thread_join(&jobs->workers[i]);
+    thread_destroy(&jobs->workers[i]);
+  }
+
+  cond_destroy(&jobs->cond);
+  mutex_destroy(&jobs->mutex);
+  MIUR_FREE(jobs->workers);
+  MIUR_FREE(jobs->queue);
+  MIUR_FREE(jobs);
+}
+
+uint32_t job_system_thread_count(JobSystem *jobs)
+{
+  return jobs->worker_count + 1;
+}
+
+void job_run(JobSystem *jobs, const Job *desc, size_t count,
+             JobCounter *counter)
+{
+  if (counter != NULL)
+  {
+    job_counter_add(counter, (int32_t) count);
+  }
+
+  mutex_lock(&jobs->mutex);
+  for (size_t i = 0; i < count; i++)
+  {
+    if (!queue_push(jobs, &desc[i], counter))
+    {
+      /* Out of memory, run it here rather than lose it. */
+      mutex_unlock(&jobs->mutex);
+      QueuedJob queued = { .job = desc[i], .counter = counter };
+      run_job(jobs, &queued);
+      mutex_lock(&jobs->mutex);
+    }
+  }
+  if (count == 1)
+  {
+    cond_signal(&jobs->cond);
+  }
+  else
+  {
+    cond_broadcast(&jobs->cond);
+  }
+  mutex_unlock(&jobs->mutex);
+}
+
+void job_wait(JobSystem *jobs, JobCounter *counter)
+{
+  mutex_lock(&jobs->mutex);
+  while (!job_counter_done(counter))
+  {
+    QueuedJob queued;
+    if (queue_pop(jobs, &queued))
+    {
+      mutex_unlock(&jobs->mutex);
+      run_job(jobs, &queued);
+      mutex_lock(&jobs->mutex);
+    }
+    else
+    {
+      cond_wait(&jobs->cond, &jobs->mutex);
+    }
+  }
+  mutex_unlock(&jobs->mutex);
+}
+
+void job_counter_add(JobCounter *counter, int32_t count)
+{
+  atomic_i32_add(&counter->value, count);
+}
+
+void job_counter_signal(JobSystem *jobs, JobCounter *counter)
+{
+  if (atomic_i32_add(&counter->value, -1) == 0)
+  {
+    /* Taking the lock orders this with a waiter that has just checked the
+     * counter and is about to sleep. */
+    mutex_lock(&jobs->mutex);
+    cond_broadcast(&jobs->cond);
+    mutex_unlock(&jobs->mutex);
+  }
+}
+
+bool job_counter_done(JobCounter *counter)
+{
+  return atomic_i32_load(&counter->value) == 0;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void worker_function(void *ud)
+{
+  JobSystem *jobs = (JobSystem *) ud;
+
+  mutex_lock(&jobs->mutex);
+  while (!jobs->should_quit)
+  {
+    QueuedJob queued;
+    if (queue_pop(jobs, &queued))
+    {
+      mutex_unlock(&jobs->mutex);
+      run_job(jobs, &queued);
+      mutex_lock(&jobs->mutex);
+    }
+    else
+    {
+      cond_wait(&jobs->cond, &jobs->mutex);
+    }
+  }
+  mutex_unlock(&jobs->mutex);
+}
+
+/* Called with the mutex held. */
+static bool queue_push(JobSystem *jobs, const Job *job, JobCounter *counter)
+{
+  if (jobs->count == jobs->capacity)
+  {
+    size_t new_capacity = jobs->capacity * 2;
+    QueuedJob *queue = MIUR_ARR(QueuedJob, new_capacity);
+    if (queue == NULL)
+    {
+      return false;
+    }
+    for (size_t i = 0; i < jobs->count; i++)
+    {
+      queue[i] = jobs->queue[(jobs->head + i) % jobs->capacity];
+    }
+    MIUR_FREE(jobs->queue);
+    jobs->queue = queue;
+    jobs->head = 0;
+    jobs->capacity = new_capacity;
+  }
+
+  QueuedJob *slot = &jobs->queue[(jobs->head + jobs->count) % jobs->capacity];
+  slot->job = *job;
+  slot->counter = counter;
+  jobs->count++;
+  return true;
+}
+
+/* Called with the mutex held. */
+static bool queue_pop(JobSystem *jobs, QueuedJob *out)
+{
+  if (jobs->count == 0)
+  {
+    return false;
+  }
+  *out = jobs->queue[jobs->head];
+  jobs->head = (jobs->head + 1) % jobs->capacity;
+  jobs->count--;
+  return true;
+}
+
+static void run_job(JobSystem *jobs, QueuedJob *queued)
+{
+  queued->job.function(queued->job.ud);
+  if (queued->counter != NULL)
+  {
+    job_counter_signal(jobs, queued->counter);
+  }
+}
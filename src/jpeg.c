@@ -0,0 +1,1531 @@
+/* =====================
+ * src/jpeg.c
+ * 10/18/2026
+ * JPEG decoding.
+ * ====================
+ */
+
+/*
+ * Huffman coded 8 bit JPEG, sequential or progressive, with one or three
+ * components.  Sequential scans go through the IDCT block by block into the
+ * component planes, progressive ones refine a buffer of coefficients that is
+ * transformed once the last scan is in.  The IDCT, chroma upsampling and
+ * YCbCr conversion follow libjpeg's defaults (islow, fancy upsampling), so
+ * the output matches what most tools show for the same file.  The one
+ * exception is libjpeg's smoothing of progressive files cut short.
+ */
+
+#include <string.h>
+
+#include <miur/image_priv.h>
+#include <miur/log.h>
+#include <miur/mem.h>
+#include <miur/simd.h>
+
+#define JPEG_MAX_COMPONENTS 3
+#define JPEG_MAX_TABLES 4
+#define JPEG_MAX_SAMPLING 4
+/* Codes this long or shorter decode with one table lookup. */
+#define JPEG_FAST_BITS 9
+#define JPEG_FAST_SIZE (1 << JPEG_FAST_BITS)
+#define JPEG_FAST_NONE 255
+
+#define JPEG_SOF0 0xc0
+#define JPEG_SOF1 0xc1
+#define JPEG_SOF2 0xc2
+#define JPEG_DHT 0xc4
+#define JPEG_RST0 0xd0
+#define JPEG_RST7 0xd7
+#define JPEG_SOI 0xd8
+#define JPEG_EOI 0xd9
+#define JPEG_SOS 0xda
+#define JPEG_DQT 0xdb
+#define JPEG_DNL 0xdc
+#define JPEG_DRI 0xdd
+#define JPEG_APP0 0xe0
+#define JPEG_APP14 0xee
+
+/* Fixed point IDCT constants, as libjpeg's jidctint.c. */
+#define IDCT_CONST_BITS 13
+#define IDCT_PASS1_BITS 2
+#define FIX_0_298631336 2446
+#define FIX_0_390180644 3196
+#define FIX_0_541196100 4433
+#define FIX_0_765366865 6270
+#define FIX_0_899976223 7373
+#define FIX_1_175875602 9633
+#define FIX_1_501321110 12299
+#define FIX_1_847759065 15137
+#define FIX_1_961570560 16069
+#define FIX_2_053119869 16819
+#define FIX_2_562915447 20995
+#define FIX_3_072711026 25172
+#define DESCALE(x, n) (((x) + ((int64_t) 1 << ((n) - 1))) >> (n))
+
+/* YCbCr to RGB in 16 bit fixed point, as libjpeg's jdcolor.c. */
+#define YCC_SCALE_BITS 16
+#define YCC_HALF ((int32_t) 1 << (YCC_SCALE_BITS - 1))
+#define YCC_CR_R 91881
+#define YCC_CB_B 116130
+#define YCC_CR_G 46802
+#define YCC_CB_G 22554
+
+/*
+ * Canonical codes, most significant bit first.  `fast` maps the next
+ * JPEG_FAST_BITS of the stream to an index into `values`, codes that are
+ * longer are found by comparing against the end of each length's range.
+ */
+typedef struct
+{
+  uint8_t fast[JPEG_FAST_SIZE];
+  uint8_t lengths[256];
+  uint8_t values[256];
+  uint32_t max_code[18];
+  int32_t delta[17];
+  bool defined;
+} JpegHuffman;
+
+typedef struct
+{
+  uint8_t id;
+  uint32_t h, v;
+  uint32_t quant;
+  uint32_t dc_table, ac_table;
+  int32_t dc_pred;
+
+  /* Downsampled size in pixels, and in blocks padded out to whole MCUs. */
+  uint32_t width, height;
+  uint32_t blocks_x, blocks_y;
+  uint8_t *plane;              /* blocks_x * 8 wide. */
+  int16_t *coeffs;             /* Progressive only, 64 per block. */
+} JpegComponent;
+
+typedef struct
+{
+  const uint8_t *p;
+  const uint8_t *end;
+  uint32_t bits;               /* Most significant bit first. */
+  int32_t count;
+  bool marker;                 /* Stopped at a marker, p points at it. */
+  int32_t padding;             /* Zero bits fed past the marker. */
+  bool exhausted;              /* The scan ran into the padding. */
+
+  uint16_t quant[JPEG_MAX_TABLES][64];
+  JpegHuffman dc[JPEG_MAX_TABLES];
+  JpegHuffman ac[JPEG_MAX_TABLES];
+
+  JpegComponent comps[JPEG_MAX_COMPONENTS];
+  uint32_t comp_count;
+  uint32_t width, height;
+  uint32_t h_max, v_max;
+  uint32_t mcus_x, mcus_y;
+  bool progressive;
+  bool frame_seen;
+  uint32_t restart_interval;
+  bool jfif;
+  int adobe_transform;         /* -1 without an Adobe marker. */
+
+  /* The current scan. */
+  JpegComponent *scan[JPEG_MAX_COMPONENTS];
+  uint32_t scan_count;
+  uint32_t spectral_start, spectral_end;
+  uint32_t approx_high, approx_low;
+  uint32_t eob_run;
+} Jpeg;
+
+/* === PROTOTYPES === */
+
+static bool read_markers(Jpeg *jpeg);
+static bool parse_frame(Jpeg *jpeg, const uint8_t *data, uint32_t size);
+static bool parse_huffman(Jpeg *jpeg, const uint8_t *data, uint32_t size);
+static bool parse_quant(Jpeg *jpeg, const uint8_t *data, uint32_t size);
+static bool parse_scan(Jpeg *jpeg, const uint8_t *data, uint32_t size);
+static bool decode_scan(Jpeg *jpeg);
+static bool decode_block(Jpeg *jpeg, JpegComponent *comp, uint32_t bx,
+                         uint32_t by);
+static bool decode_baseline(Jpeg *jpeg, JpegComponent *comp, int16_t *block);
+static bool decode_dc_first(Jpeg *jpeg, JpegComponent *comp, int16_t *block);
+static bool decode_ac_first(Jpeg *jpeg, JpegComponent *comp, int16_t *block);
+static bool decode_ac_refine(Jpeg *jpeg, JpegComponent *comp,
+                             int16_t *block);
+static void restart(Jpeg *jpeg);
+static void skip_to_marker(Jpeg *jpeg);
+static bool build_huffman(JpegHuffman *h, const uint8_t *counts);
+static int decode_huffman(Jpeg *jpeg, const JpegHuffman *h);
+static void fill_bits(Jpeg *jpeg);
+static uint32_t get_bits(Jpeg *jpeg, uint32_t n);
+static int32_t receive_extend(Jpeg *jpeg, uint32_t n);
+static void idct_block(const int16_t *in, const uint16_t *quant,
+                       uint8_t *out, size_t stride);
+static uint8_t clamp_sample(int32_t x);
+#ifndef MIUR_HAVE_SSE2
+static uint8_t clamp_idct(int64_t x);
+#endif
+static bool finish_image(Jpeg *jpeg, Image *out);
+static void convert_row(const uint8_t *c0, const uint8_t *c1,
+                        const uint8_t *c2, uint32_t width, bool rgb,
+                        uint8_t *dst);
+static uint8_t *upsample(const Jpeg *jpeg, const JpegComponent *comp);
+static void upsample_h2v1(const uint8_t *in, uint32_t in_width,
+                          uint8_t *out);
+static void upsample_h1v2(const uint8_t *in, const uint8_t *near,
+                          uint32_t width, uint8_t *out, uint32_t bias);
+static void upsample_h2v2(const uint8_t *in, const uint8_t *near,
+                          uint32_t in_width, uint8_t *out);
+static uint16_t read_be16(const uint8_t *p);
+#ifdef MIUR_HAVE_SSE2
+static void idct_block_sse2(const int16_t *in, const uint16_t *quant,
+                            uint8_t *out, size_t stride);
+static void idct_pass_sse2(__m128i v[8], int shift);
+static __m128i madd_pair_sse2(__m128i a, __m128i b, int16_t ca, int16_t cb,
+                              bool high);
+static void transpose_sse2(__m128i v[8]);
+static uint32_t convert_ycc_sse2(const uint8_t *c0, const uint8_t *c1,
+                                 const uint8_t *c2, uint32_t width,
+                                 uint8_t *dst);
+#endif
+
+/* === GLOBALS === */
+
+/* Zigzag position to natural order, padded so corrupt runs stay in range. */
+static const uint8_t natural_order[64 + 16] = {
+  0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5, 12, 19, 26, 33,
+  40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28, 35, 42, 49, 56, 57, 50, 43,
+  36, 29, 22, 15, 23, 30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53,
+  60, 61, 54, 47, 55, 62, 63,
+  63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63,
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+bool jpeg_decode(Image *out, const uint8_t *data, size_t size)
+{
+  Jpeg *jpeg = MIUR_NEW(Jpeg);
+  if (jpeg == NULL)
+  {
+    return false;
+  }
+  jpeg->p = data + 2;
+  jpeg->end = data + size;
+  jpeg->adobe_transform = -1;
+
+  bool result = read_markers(jpeg) && finish_image(jpeg, out);
+  for (uint32_t i = 0; i < jpeg->comp_count; i++)
+  {
+    MIUR_FREE(jpeg->comps[i].plane);
+    MIUR_FREE(jpeg->comps[i].coeffs);
+  }
+  MIUR_FREE(jpeg);
+  return result;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/* Reads segments up to the end of the image, decoding scans as they come. */
+static bool read_markers(Jpeg *jpeg)
+{
+  for (;;)
+  {
+    /* Markers may be padded with any number of fill bytes. */
+    while (jpeg->p < jpeg->end && *jpeg->p != 0xff)
+    {
+      jpeg->p++;
+    }
+    while (jpeg->p < jpeg->end && *jpeg->p == 0xff)
+    {
+      jpeg->p++;
+    }
+    if (jpeg->p >= jpeg->end)
+    {
+      /* Truncated files keep whatever scans made it. */
+      return jpeg->frame_seen;
+    }
+
+    uint8_t marker = *jpeg->p++;
+    if (marker == JPEG_EOI)
+    {
+      return jpeg->frame_seen;
+    }
+    if (marker == JPEG_SOI || (marker >= JPEG_RST0 && marker <= JPEG_RST7))
+    {
+      continue;
+    }
+    if (jpeg->end - jpeg->p < 2 ||
+        read_be16(jpeg->p) > (size_t) (jpeg->end - jpeg->p) ||
+        read_be16(jpeg->p) < 2)
+    {
+      MIUR_LOG_ERR("Truncated JPEG segment");
+      return false;
+    }
+    const uint8_t *body = jpeg->p + 2;
+    uint32_t length = read_be16(jpeg->p) - 2u;
+    jpeg->p = body + length;
+
+    bool valid = true;
+    switch (marker)
+    {
+    case JPEG_SOF0:
+    case JPEG_SOF1:
+    case JPEG_SOF2:
+      jpeg->progressive = marker == JPEG_SOF2;
+      valid = parse_frame(jpeg, body, length);
+      break;
+    case JPEG_DHT:
+      valid = parse_huffman(jpeg, body, length);
+      break;
+    case JPEG_DQT:
+      valid = parse_quant(jpeg, body, length);
+      break;
+    case JPEG_DRI:
+      valid = length >= 2;
+      jpeg->restart_interval = valid ? read_be16(body) : 0;
+      break;
+    case JPEG_SOS:
+      valid = parse_scan(jpeg, body, length) && decode_scan(jpeg);
+      break;
+    case JPEG_APP0:
+      jpeg->jfif |= length >= 5 && memcmp(body, "JFIF", 5) == 0;
+      break;
+    case JPEG_APP14:
+      if (length >= 12 && memcmp(body, "Adobe", 5) == 0)
+      {
+        jpeg->adobe_transform = body[11];
+      }
+      break;
+    case JPEG_DNL:
+      MIUR_LOG_ERR("JPEG line counts after the scan aren't supported");
+      return false;
+    default:
+      if (marker >= JPEG_SOF0 && marker <= 0xcf && marker != 0xc8 &&
+          marker != 0xcc)
+      {
+        MIUR_LOG_ERR("JPEG process 0x%02x isn't supported", marker);
+        return false;
+      }
+      break;
+    }
+    if (!valid)
+    {
+      return false;
+    }
+  }
+}
+
+static bool parse_frame(Jpeg *jpeg, const uint8_t *data, uint32_t size)
+{
+  if (jpeg->frame_seen || size < 6)
+  {
+    MIUR_LOG_ERR("Invalid JPEG frame");
+    return false;
+  }
+  uint32_t comp_count = data[5];
+  if (data[0] != 8)
+  {
+    MIUR_LOG_ERR("Only 8 bit JPEG is supported");
+    return false;
+  }
+  if ((comp_count != 1 && comp_count != 3) || size < 6 + comp_count * 3)
+  {
+    MIUR_LOG_ERR("JPEG with %u components isn't supported",
+                 (unsigned) comp_count);
+    return false;
+  }
+  jpeg->height = read_be16(data + 1);
+  jpeg->width = read_be16(data + 3);
+  if (jpeg->width == 0 || jpeg->height == 0 ||
+      jpeg->width > IMAGE_MAX_DIMENSION || jpeg->height > IMAGE_MAX_DIMENSION)
+  {
+    MIUR_LOG_ERR("JPEG size is out of range");
+    return false;
+  }
+
+  jpeg->comp_count = comp_count;
+  jpeg->h_max = 1;
+  jpeg->v_max = 1;
+  for (uint32_t i = 0; i < jpeg->comp_count; i++)
+  {
+    JpegComponent *comp = &jpeg->comps[i];
+    const uint8_t *c = data + 6 + i * 3;
+    comp->id = c[0];
+    comp->h = c[1] >> 4;
+    comp->v = c[1] & 15;
+    comp->quant = c[2];
+    if (comp->h == 0 || comp->h > JPEG_MAX_SAMPLING || comp->v == 0 ||
+        comp->v > JPEG_MAX_SAMPLING || comp->quant >= JPEG_MAX_TABLES)
+    {
+      MIUR_LOG_ERR("Invalid JPEG component");
+      return false;
+    }
+    jpeg->h_max = comp->h > jpeg->h_max ? comp->h : jpeg->h_max;
+    jpeg->v_max = comp->v > jpeg->v_max ? comp->v : jpeg->v_max;
+  }
+  /* A lone component is never interleaved, its blocks are its MCUs. */
+  if (jpeg->comp_count == 1)
+  {
+    jpeg->comps[0].h = jpeg->comps[0].v = 1;
+    jpeg->h_max = jpeg->v_max = 1;
+  }
+
+  jpeg->mcus_x = (jpeg->width + jpeg->h_max * 8 - 1) / (jpeg->h_max * 8);
+  jpeg->mcus_y = (jpeg->height + jpeg->v_max * 8 - 1) / (jpeg->v_max * 8);
+  for (uint32_t i = 0; i < jpeg->comp_count; i++)
+  {
+    JpegComponent *comp = &jpeg->comps[i];
+    /* Chroma has to scale by whole factors, as libjpeg requires too. */
+    if (jpeg->h_max % comp->h != 0 || jpeg->v_max % comp->v != 0)
+    {
+      MIUR_LOG_ERR("JPEG sampling factors aren't supported");
+      return false;
+    }
+    comp->width = (jpeg->width * comp->h + jpeg->h_max - 1) / jpeg->h_max;
+    comp->height = (jpeg->height * comp->v + jpeg->v_max - 1) / jpeg->v_max;
+    comp->blocks_x = jpeg->mcus_x * comp->h;
+    comp->blocks_y = jpeg->mcus_y * comp->v;
+    size_t blocks = (size_t) comp->blocks_x * comp->blocks_y;
+    comp->plane = MIUR_ARR(uint8_t, blocks * 64);
+    if (comp->plane == NULL)
+    {
+      return false;
+    }
+    if (jpeg->progressive)
+    {
+      comp->coeffs = MIUR_ARR(int16_t, blocks * 64);
+      if (comp->coeffs == NULL)
+      {
+        return false;
+      }
+    }
+  }
+  jpeg->frame_seen = true;
+  return true;
+}
+
+static bool parse_huffman(Jpeg *jpeg, const uint8_t *data, uint32_t size)
+{
+  while (size > 0)
+  {
+    if (size < 17 || (data[0] >> 4) > 1 || (data[0] & 15) >= JPEG_MAX_TABLES)
+    {
+      MIUR_LOG_ERR("Invalid JPEG Huffman table");
+      return false;
+    }
+    JpegHuffman *h = (data[0] >> 4) == 0 ? &jpeg->dc[data[0] & 15] :
+      &jpeg->ac[data[0] & 15];
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < 16; i++)
+    {
+      total += data[1 + i];
+    }
+    if (total > 256 || size < 17 + total)
+    {
+      MIUR_LOG_ERR("Invalid JPEG Huffman table");
+      return false;
+    }
+    memcpy(h->values, data + 17, total);
+    if (!build_huffman(h, data + 1))
+    {
+      MIUR_LOG_ERR("Invalid JPEG Huffman table");
+      return false;
+    }
+    data += 17 + total;
+    size -= 17 + total;
+  }
+  return true;
+}
+
+static bool parse_quant(Jpeg *jpeg, const uint8_t *data, uint32_t size)
+{
+  while (size > 0)
+  {
+    uint32_t precision = data[0] >> 4;
+    uint32_t table = data[0] & 15;
+    uint32_t length = 1 + 64 * (precision + 1);
+    if (precision > 1 || table >= JPEG_MAX_TABLES || size < length)
+    {
+      MIUR_LOG_ERR("Invalid JPEG quantization table");
+      return false;
+    }
+    /* Stored in zigzag order, kept in natural order. */
+    for (uint32_t k = 0; k < 64; k++)
+    {
+      jpeg->quant[table][natural_order[k]] = precision != 0 ?
+        read_be16(data + 1 + k * 2) : data[1 + k];
+    }
+    data += length;
+    size -= length;
+  }
+  return true;
+}
+
+static bool parse_scan(Jpeg *jpeg, const uint8_t *data, uint32_t size)
+{
+  if (!jpeg->frame_seen || size < 1 || data[0] == 0 ||
+      data[0] > jpeg->comp_count || size < 4 + data[0] * 2u)
+  {
+    MIUR_LOG_ERR("Invalid JPEG scan");
+    return false;
+  }
+  jpeg->scan_count = data[0];
+  for (uint32_t i = 0; i < jpeg->scan_count; i++)
+  {
+    const uint8_t *c = data + 1 + i * 2;
+    JpegComponent *comp = NULL;
+    for (uint32_t j = 0; j < jpeg->comp_count; j++)
+    {
+      comp = jpeg->comps[j].id == c[0] ? &jpeg->comps[j] : comp;
+    }
+    if (comp == NULL || (c[1] >> 4) >= JPEG_MAX_TABLES ||
+        (c[1] & 15) >= JPEG_MAX_TABLES)
+    {
+      MIUR_LOG_ERR("Invalid JPEG scan component");
+      return false;
+    }
+    comp->dc_table = c[1] >> 4;
+    comp->ac_table = c[1] & 15;
+    jpeg->scan[i] = comp;
+  }
+
+  const uint8_t *s = data + 1 + jpeg->scan_count * 2;
+  jpeg->spectral_start = s[0];
+  jpeg->spectral_end = s[1];
+  jpeg->approx_high = s[2] >> 4;
+  jpeg->approx_low = s[2] & 15;
+  if (jpeg->progressive)
+  {
+    /* DC and AC never share a scan, AC scans have a single component. */
+    bool dc = jpeg->spectral_start == 0;
+    if ((dc && jpeg->spectral_end != 0) ||
+        (!dc && (jpeg->spectral_end < jpeg->spectral_start ||
+                 jpeg->spectral_end > 63 || jpeg->scan_count != 1)) ||
+        jpeg->approx_low > 13)
+    {
+      MIUR_LOG_ERR("Invalid progressive JPEG scan");
+      return false;
+    }
+  } else
+  {
+    jpeg->spectral_start = 0;
+    jpeg->spectral_end = 63;
+    jpeg->approx_high = jpeg->approx_low = 0;
+  }
+
+  for (uint32_t i = 0; i < jpeg->scan_count; i++)
+  {
+    JpegComponent *comp = jpeg->scan[i];
+    bool needs_dc = jpeg->spectral_start == 0 && jpeg->approx_high == 0;
+    bool needs_ac = jpeg->spectral_end > 0;
+    if ((needs_dc && !jpeg->dc[comp->dc_table].defined) ||
+        (needs_ac && !jpeg->ac[comp->ac_table].defined))
+    {
+      MIUR_LOG_ERR("JPEG scan uses an undefined Huffman table");
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Runs the entropy coded data following a scan header.  Scans of one
+ * component cover just its blocks, interleaved ones whole MCUs.
+ */
+static bool decode_scan(Jpeg *jpeg)
+{
+  for (uint32_t i = 0; i < jpeg->comp_count; i++)
+  {
+    jpeg->comps[i].dc_pred = 0;
+  }
+  jpeg->bits = 0;
+  jpeg->count = 0;
+  jpeg->marker = false;
+  jpeg->padding = 0;
+  jpeg->exhausted = false;
+  jpeg->eob_run = 0;
+
+  uint32_t restarts_left = jpeg->restart_interval;
+  if (jpeg->scan_count == 1)
+  {
+    JpegComponent *comp = jpeg->scan[0];
+    uint32_t blocks_x = (comp->width + 7) / 8;
+    uint32_t blocks_y = (comp->height + 7) / 8;
+    for (uint32_t by = 0; by < blocks_y; by++)
+    {
+      for (uint32_t bx = 0; bx < blocks_x; bx++)
+      {
+        if (jpeg->restart_interval != 0 && restarts_left-- == 0)
+        {
+          restart(jpeg);
+          restarts_left = jpeg->restart_interval - 1;
+        }
+        jpeg->exhausted |= jpeg->count < jpeg->padding;
+        if (!decode_block(jpeg, comp, bx, by))
+        {
+          return false;
+        }
+      }
+    }
+  } else
+  {
+    for (uint32_t my = 0; my < jpeg->mcus_y; my++)
+    {
+      for (uint32_t mx = 0; mx < jpeg->mcus_x; mx++)
+      {
+        if (jpeg->restart_interval != 0 && restarts_left-- == 0)
+        {
+          restart(jpeg);
+          restarts_left = jpeg->restart_interval - 1;
+        }
+        jpeg->exhausted |= jpeg->count < jpeg->padding;
+        for (uint32_t i = 0; i < jpeg->scan_count; i++)
+        {
+          JpegComponent *comp = jpeg->scan[i];
+          for (uint32_t y = 0; y < comp->v; y++)
+          {
+            for (uint32_t x = 0; x < comp->h; x++)
+            {
+              if (!decode_block(jpeg, comp, mx * comp->h + x,
+                                my * comp->v + y))
+              {
+                return false;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  skip_to_marker(jpeg);
+  return true;
+}
+
+/*
+ * Once a truncated scan has used up its data the remaining blocks are left
+ * as they are, or flat for sequential scans, as libjpeg does.
+ */
+static bool decode_block(Jpeg *jpeg, JpegComponent *comp, uint32_t bx,
+                         uint32_t by)
+{
+  size_t block_index = (size_t) by * comp->blocks_x + bx;
+  if (!jpeg->progressive)
+  {
+    int16_t block[64] = { 0 };
+    if (!jpeg->exhausted && !decode_baseline(jpeg, comp, block))
+    {
+      return false;
+    }
+    size_t stride = (size_t) comp->blocks_x * 8;
+    idct_block(block, jpeg->quant[comp->quant],
+               comp->plane + (size_t) by * 8 * stride + (size_t) bx * 8,
+               stride);
+    return true;
+  }
+
+  int16_t *block = comp->coeffs + block_index * 64;
+  if (jpeg->exhausted)
+  {
+    return true;
+  }
+  if (jpeg->spectral_start == 0)
+  {
+    if (jpeg->approx_high == 0)
+    {
+      return decode_dc_first(jpeg, comp, block);
+    }
+    /* DC refinement is a single bit per block. */
+    if (get_bits(jpeg, 1) != 0)
+    {
+      block[0] = (int16_t) (block[0] | (1 << jpeg->approx_low));
+    }
+    return true;
+  }
+  return jpeg->approx_high == 0 ? decode_ac_first(jpeg, comp, block) :
+    decode_ac_refine(jpeg, comp, block);
+}
+
+static bool decode_baseline(Jpeg *jpeg, JpegComponent *comp, int16_t *block)
+{
+  int t = decode_huffman(jpeg, &jpeg->dc[comp->dc_table]);
+  if (t < 0 || t > 15)
+  {
+    return false;
+  }
+  comp->dc_pred += t != 0 ? receive_extend(jpeg, (uint32_t) t) : 0;
+  block[0] = (int16_t) comp->dc_pred;
+
+  const JpegHuffman *ac = &jpeg->ac[comp->ac_table];
+  for (uint32_t k = 1; k < 64; k++)
+  {
+    int rs = decode_huffman(jpeg, ac);
+    if (rs < 0)
+    {
+      return false;
+    }
+    uint32_t run = (uint32_t) rs >> 4;
+    uint32_t bits = (uint32_t) rs & 15;
+    if (bits == 0)
+    {
+      if (run != 15)
+      {
+        break;
+      }
+      k += 15;
+      continue;
+    }
+    k += run;
+    if (k > 63)
+    {
+      return false;
+    }
+    block[natural_order[k]] = (int16_t) receive_extend(jpeg, bits);
+  }
+  return true;
+}
+
+static bool decode_dc_first(Jpeg *jpeg, JpegComponent *comp, int16_t *block)
+{
+  int t = decode_huffman(jpeg, &jpeg->dc[comp->dc_table]);
+  if (t < 0 || t > 15)
+  {
+    return false;
+  }
+  comp->dc_pred += t != 0 ? receive_extend(jpeg, (uint32_t) t) : 0;
+  block[0] = (int16_t) (comp->dc_pred * (1 << jpeg->approx_low));
+  return true;
+}
+
+static bool decode_ac_first(Jpeg *jpeg, JpegComponent *comp, int16_t *block)
+{
+  if (jpeg->eob_run > 0)
+  {
+    jpeg->eob_run--;
+    return true;
+  }
+  const JpegHuffman *ac = &jpeg->ac[comp->ac_table];
+  for (uint32_t k = jpeg->spectral_start; k <= jpeg->spectral_end; k++)
+  {
+    int rs = decode_huffman(jpeg, ac);
+    if (rs < 0)
+    {
+      return false;
+    }
+    uint32_t run = (uint32_t) rs >> 4;
+    uint32_t bits = (uint32_t) rs & 15;
+    if (bits == 0)
+    {
+      if (run < 15)
+      {
+        /* The rest of this block and the next eob_run are all zero. */
+        jpeg->eob_run = (1u << run) - 1;
+        if (run != 0)
+        {
+          jpeg->eob_run += get_bits(jpeg, run);
+        }
+        break;
+      }
+      k += 15;
+      continue;
+    }
+    k += run;
+    if (k > 63)
+    {
+      return false;
+    }
+    block[natural_order[k]] = (int16_t) (receive_extend(jpeg, bits) *
+                                         (1 << jpeg->approx_low));
+  }
+  return true;
+}
+
+/*
+ * Adds one bit of precision to every nonzero coefficient in the band and
+ * places the coefficients that just became nonzero, as libjpeg's
+ * decode_mcu_AC_refine.
+ */
+static bool decode_ac_refine(Jpeg *jpeg, JpegComponent *comp,
+                             int16_t *block)
+{
+  int32_t p1 = 1 << jpeg->approx_low;
+  int32_t m1 = -p1;
+  uint32_t k = jpeg->spectral_start;
+  uint32_t end = jpeg->spectral_end;
+  const JpegHuffman *ac = &jpeg->ac[comp->ac_table];
+
+  if (jpeg->eob_run == 0)
+  {
+    for (; k <= end; k++)
+    {
+      int rs = decode_huffman(jpeg, ac);
+      if (rs < 0)
+      {
+        return false;
+      }
+      int32_t run = rs >> 4;
+      int32_t value = 0;
+      if ((rs & 15) != 0)
+      {
+        /* New coefficients are always +-1 at this precision. */
+        value = get_bits(jpeg, 1) != 0 ? p1 : m1;
+      } else if (run != 15)
+      {
+        jpeg->eob_run = 1u << run;
+        if (run != 0)
+        {
+          jpeg->eob_run += get_bits(jpeg, (uint32_t) run);
+        }
+        break;
+      }
+
+      /* Skip `run` zero coefficients, refining nonzero ones on the way. */
+      do
+      {
+        int16_t *coef = &block[natural_order[k]];
+        if (*coef != 0)
+        {
+          if (get_bits(jpeg, 1) != 0 && (*coef & p1) == 0)
+          {
+            *coef = (int16_t) (*coef + (*coef >= 0 ? p1 : m1));
+          }
+        } else if (--run < 0)
+        {
+          break;
+        }
+        k++;
+      } while (k <= end);
+      if (value != 0 && k <= end)
+      {
+        block[natural_order[k]] = (int16_t) value;
+      }
+    }
+  }
+
+  if (jpeg->eob_run > 0)
+  {
+    for (; k <= end; k++)
+    {
+      int16_t *coef = &block[natural_order[k]];
+      if (*coef != 0 && get_bits(jpeg, 1) != 0 && (*coef & p1) == 0)
+      {
+        *coef = (int16_t) (*coef + (*coef >= 0 ? p1 : m1));
+      }
+    }
+    jpeg->eob_run--;
+  }
+  return true;
+}
+
+/* Skips to the next RSTn marker and resets the predictions. */
+static void restart(Jpeg *jpeg)
+{
+  const uint8_t *p = jpeg->p;
+  while (p + 1 < jpeg->end &&
+         !(p[0] == 0xff && p[1] >= JPEG_RST0 && p[1] <= JPEG_RST7))
+  {
+    p++;
+  }
+  jpeg->p = p + 1 < jpeg->end ? p + 2 : jpeg->end;
+  jpeg->bits = 0;
+  jpeg->count = 0;
+  jpeg->marker = false;
+  jpeg->padding = 0;
+  jpeg->exhausted = false;
+  jpeg->eob_run = 0;
+  for (uint32_t i = 0; i < jpeg->comp_count; i++)
+  {
+    jpeg->comps[i].dc_pred = 0;
+  }
+}
+
+/* Leaves p at the marker ending the entropy coded data. */
+static void skip_to_marker(Jpeg *jpeg)
+{
+  const uint8_t *p = jpeg->p;
+  while (p + 1 < jpeg->end &&
+         !(p[0] == 0xff && p[1] != 0 &&
+           !(p[1] >= JPEG_RST0 && p[1] <= JPEG_RST7)))
+  {
+    p++;
+  }
+  jpeg->p = p;
+}
+
+/* Fails on tables with more codes than their lengths have room for. */
+static bool build_huffman(JpegHuffman *h, const uint8_t *counts)
+{
+  uint32_t code = 0;
+  uint32_t index = 0;
+  memset(h->fast, JPEG_FAST_NONE, sizeof(h->fast));
+  for (uint32_t length = 1; length <= 16; length++)
+  {
+    h->delta[length] = (int32_t) index - (int32_t) code;
+    if (code + counts[length - 1] > 1u << length)
+    {
+      return false;
+    }
+    for (uint32_t i = 0; i < counts[length - 1]; i++, index++, code++)
+    {
+      h->lengths[index] = (uint8_t) length;
+      if (length <= JPEG_FAST_BITS)
+      {
+        uint32_t first = code << (JPEG_FAST_BITS - length);
+        uint32_t fill = 1u << (JPEG_FAST_BITS - length);
+        memset(&h->fast[first], (int) index, fill);
+      }
+    }
+    /* Exclusive end of this length's codes, left aligned to 16 bits. */
+    h->max_code[length] = code << (16 - length);
+    code <<= 1;
+  }
+  h->max_code[17] = UINT32_MAX;
+  h->defined = true;
+  return true;
+}
+
+static int decode_huffman(Jpeg *jpeg, const JpegHuffman *h)
+{
+  if (jpeg->count < 16)
+  {
+    fill_bits(jpeg);
+  }
+  uint32_t entry = h->fast[jpeg->bits >> (32 - JPEG_FAST_BITS)];
+  if (entry != JPEG_FAST_NONE)
+  {
+    uint32_t length = h->lengths[entry];
+    jpeg->bits <<= length;
+    jpeg->count -= (int32_t) length;
+    return h->values[entry];
+  }
+
+  uint32_t top = jpeg->bits >> 16;
+  uint32_t length = JPEG_FAST_BITS + 1;
+  while (top >= h->max_code[length])
+  {
+    length++;
+  }
+  if (length > 16)
+  {
+    return -1;
+  }
+  int32_t index = (int32_t) (jpeg->bits >> (32 - length)) + h->delta[length];
+  if (index < 0 || index > 255)
+  {
+    return -1;
+  }
+  jpeg->bits <<= length;
+  jpeg->count -= (int32_t) length;
+  return h->values[index];
+}
+
+/*
+ * Unstuffs the 0 after every 0xff.  At a marker the reader stops and feeds
+ * zeroes, a corrupt scan runs out into them instead of into the next segment.
+ */
+static void fill_bits(Jpeg *jpeg)
+{
+  while (jpeg->count <= 24)
+  {
+    uint32_t byte = 0;
+    if (!jpeg->marker && jpeg->p < jpeg->end)
+    {
+      byte = *jpeg->p;
+      if (byte == 0xff)
+      {
+        uint8_t next = jpeg->p + 1 < jpeg->end ? jpeg->p[1] : 0xd9;
+        if (next == 0)
+        {
+          jpeg->p += 2;
+        } else
+        {
+          jpeg->marker = true;
+          byte = 0;
+          jpeg->padding += 8;
+        }
+      } else
+      {
+        jpeg->p++;
+      }
+    } else
+    {
+      jpeg->padding += 8;
+    }
+    jpeg->bits |= byte << (24 - jpeg->count);
+    jpeg->count += 8;
+  }
+}
+
+static uint32_t get_bits(Jpeg *jpeg, uint32_t n)
+{
+  if (jpeg->count < (int32_t) n)
+  {
+    fill_bits(jpeg);
+  }
+  uint32_t value = jpeg->bits >> (32 - n);
+  jpeg->bits <<= n;
+  jpeg->count -= (int32_t) n;
+  return value;
+}
+
+/* Reads an n bit magnitude, the top bit clear meaning it's negative. */
+static int32_t receive_extend(Jpeg *jpeg, uint32_t n)
+{
+  int32_t value = (int32_t) get_bits(jpeg, n);
+  if (value < (1 << (n - 1)))
+  {
+    value += (int32_t) (UINT32_MAX << n) + 1;
+  }
+  return value;
+}
+
+/*
+ * libjpeg's jpeg_idct_islow, dequantizing on the way in.  Intermediates are
+ * 64 bit like its JLONG, so corrupt coefficients can't overflow them.
+ */
+static void idct_block(const int16_t *in, const uint16_t *quant,
+                       uint8_t *out, size_t stride)
+{
+#ifdef MIUR_HAVE_SSE2
+  idct_block_sse2(in, quant, out, stride);
+#else
+  int64_t work[64];
+  for (uint32_t col = 0; col < 8; col++)
+  {
+    const int16_t *c = in + col;
+    const uint16_t *q = quant + col;
+    int64_t *w = work + col;
+    if (c[8] == 0 && c[16] == 0 && c[24] == 0 && c[32] == 0 && c[40] == 0 &&
+        c[48] == 0 && c[56] == 0)
+    {
+      int64_t dc = (int64_t) c[0] * q[0] * (1 << IDCT_PASS1_BITS);
+      for (uint32_t i = 0; i < 8; i++)
+      {
+        w[i * 8] = dc;
+      }
+      continue;
+    }
+
+    int64_t z2 = (int64_t) c[16] * q[16];
+    int64_t z3 = (int64_t) c[48] * q[48];
+    int64_t z1 = (z2 + z3) * FIX_0_541196100;
+    int64_t tmp2 = z1 + z3 * -FIX_1_847759065;
+    int64_t tmp3 = z1 + z2 * FIX_0_765366865;
+    z2 = (int64_t) c[0] * q[0];
+    z3 = (int64_t) c[32] * q[32];
+    int64_t tmp0 = (z2 + z3) * (1 << IDCT_CONST_BITS);
+    int64_t tmp1 = (z2 - z3) * (1 << IDCT_CONST_BITS);
+    int64_t tmp10 = tmp0 + tmp3;
+    int64_t tmp13 = tmp0 - tmp3;
+    int64_t tmp11 = tmp1 + tmp2;
+    int64_t tmp12 = tmp1 - tmp2;
+
+    tmp0 = (int64_t) c[56] * q[56];
+    tmp1 = (int64_t) c[40] * q[40];
+    tmp2 = (int64_t) c[24] * q[24];
+    tmp3 = (int64_t) c[8] * q[8];
+    z1 = tmp0 + tmp3;
+    z2 = tmp1 + tmp2;
+    z3 = tmp0 + tmp2;
+    int64_t z4 = tmp1 + tmp3;
+    int64_t z5 = (z3 + z4) * FIX_1_175875602;
+    tmp0 *= FIX_0_298631336;
+    tmp1 *= FIX_2_053119869;
+    tmp2 *= FIX_3_072711026;
+    tmp3 *= FIX_1_501321110;
+    z1 *= -FIX_0_899976223;
+    z2 *= -FIX_2_562915447;
+    z3 = z3 * -FIX_1_961570560 + z5;
+    z4 = z4 * -FIX_0_390180644 + z5;
+    tmp0 += z1 + z3;
+    tmp1 += z2 + z4;
+    tmp2 += z2 + z3;
+    tmp3 += z1 + z4;
+
+    int64_t shift = IDCT_CONST_BITS - IDCT_PASS1_BITS;
+    w[0] = DESCALE(tmp10 + tmp3, shift);
+    w[56] = DESCALE(tmp10 - tmp3, shift);
+    w[8] = DESCALE(tmp11 + tmp2, shift);
+    w[48] = DESCALE(tmp11 - tmp2, shift);
+    w[16] = DESCALE(tmp12 + tmp1, shift);
+    w[40] = DESCALE(tmp12 - tmp1, shift);
+    w[24] = DESCALE(tmp13 + tmp0, shift);
+    w[32] = DESCALE(tmp13 - tmp0, shift);
+  }
+
+  int64_t shift = IDCT_CONST_BITS + IDCT_PASS1_BITS + 3;
+  for (uint32_t row = 0; row < 8; row++, out += stride)
+  {
+    const int64_t *w = work + row * 8;
+    int64_t z2 = w[2];
+    int64_t z3 = w[6];
+    int64_t z1 = (z2 + z3) * FIX_0_541196100;
+    int64_t tmp2 = z1 + z3 * -FIX_1_847759065;
+    int64_t tmp3 = z1 + z2 * FIX_0_765366865;
+    int64_t tmp0 = (w[0] + w[4]) * (1 << IDCT_CONST_BITS);
+    int64_t tmp1 = (w[0] - w[4]) * (1 << IDCT_CONST_BITS);
+    int64_t tmp10 = tmp0 + tmp3;
+    int64_t tmp13 = tmp0 - tmp3;
+    int64_t tmp11 = tmp1 + tmp2;
+    int64_t tmp12 = tmp1 - tmp2;
+
+    tmp0 = w[7];
+    tmp1 = w[5];
+    tmp2 = w[3];
+    tmp3 = w[1];
+    z1 = tmp0 + tmp3;
+    z2 = tmp1 + tmp2;
+    z3 = tmp0 + tmp2;
+    int64_t z4 = tmp1 + tmp3;
+    int64_t z5 = (z3 + z4) * FIX_1_175875602;
+    tmp0 *= FIX_0_298631336;
+    tmp1 *= FIX_2_053119869;
+    tmp2 *= FIX_3_072711026;
+    tmp3 *= FIX_1_501321110;
+    z1 *= -FIX_0_899976223;
+    z2 *= -FIX_2_562915447;
+    z3 = z3 * -FIX_1_961570560 + z5;
+    z4 = z4 * -FIX_0_390180644 + z5;
+    tmp0 += z1 + z3;
+    tmp1 += z2 + z4;
+    tmp2 += z2 + z3;
+    tmp3 += z1 + z4;
+
+    out[0] = clamp_idct(DESCALE(tmp10 + tmp3, shift) + 128);
+    out[7] = clamp_idct(DESCALE(tmp10 - tmp3, shift) + 128);
+    out[1] = clamp_idct(DESCALE(tmp11 + tmp2, shift) + 128);
+    out[6] = clamp_idct(DESCALE(tmp11 - tmp2, shift) + 128);
+    out[2] = clamp_idct(DESCALE(tmp12 + tmp1, shift) + 128);
+    out[5] = clamp_idct(DESCALE(tmp12 - tmp1, shift) + 128);
+    out[3] = clamp_idct(DESCALE(tmp13 + tmp0, shift) + 128);
+    out[4] = clamp_idct(DESCALE(tmp13 - tmp0, shift) + 128);
+  }
+#endif
+}
+
+static uint8_t clamp_sample(int32_t x)
+{
+  return (uint8_t) (x < 0 ? 0 : x > 255 ? 255 : x);
+}
+
+#ifndef MIUR_HAVE_SSE2
+static uint8_t clamp_idct(int64_t x)
+{
+  return (uint8_t) (x < 0 ? 0 : x > 255 ? 255 : x);
+}
+#endif
+
+/* Transforms progressive coefficients, then upsamples and converts. */
+static bool finish_image(Jpeg *jpeg, Image *out)
+{
+  if (jpeg->progressive)
+  {
+    for (uint32_t i = 0; i < jpeg->comp_count; i++)
+    {
+      JpegComponent *comp = &jpeg->comps[i];
+      size_t stride = (size_t) comp->blocks_x * 8;
+      for (uint32_t by = 0; by < comp->blocks_y; by++)
+      {
+        for (uint32_t bx = 0; bx < comp->blocks_x; bx++)
+        {
+          const int16_t *block = comp->coeffs +
+            ((size_t) by * comp->blocks_x + bx) * 64;
+          idct_block(block, jpeg->quant[comp->quant],
+                     comp->plane + (size_t) by * 8 * stride + bx * 8, stride);
+        }
+      }
+    }
+  }
+
+  if (!image_alloc(out, jpeg->width, jpeg->height))
+  {
+    return false;
+  }
+
+  uint8_t *planes[JPEG_MAX_COMPONENTS] = { NULL };
+  size_t strides[JPEG_MAX_COMPONENTS];
+  bool result = true;
+  for (uint32_t i = 0; i < jpeg->comp_count; i++)
+  {
+    JpegComponent *comp = &jpeg->comps[i];
+    if (comp->h == jpeg->h_max && comp->v == jpeg->v_max)
+    {
+      planes[i] = comp->plane;
+      strides[i] = (size_t) comp->blocks_x * 8;
+      continue;
+    }
+    planes[i] = upsample(jpeg, comp);
+    strides[i] = jpeg->width;
+    result &= planes[i] != NULL;
+  }
+
+  /* Like libjpeg, three components are YCbCr unless marked as RGB. */
+  bool rgb = jpeg->adobe_transform == 0 ||
+    (jpeg->adobe_transform < 0 && !jpeg->jfif && jpeg->comps[0].id == 'R' &&
+     jpeg->comps[1].id == 'G' && jpeg->comps[2].id == 'B');
+  for (uint32_t y = 0; result && y < jpeg->height; y++)
+  {
+    uint8_t *dst = out->pixels + (size_t) y * jpeg->width * 4;
+    const uint8_t *c0 = planes[0] + y * strides[0];
+    if (jpeg->comp_count == 1)
+    {
+      convert_row(c0, c0, c0, jpeg->width, true, dst);
+    } else
+    {
+      convert_row(c0, planes[1] + y * strides[1], planes[2] + y * strides[2],
+                  jpeg->width, rgb, dst);
+    }
+  }
+
+  for (uint32_t i = 0; i < jpeg->comp_count; i++)
+  {
+    if (planes[i] != jpeg->comps[i].plane)
+    {
+      MIUR_FREE(planes[i]);
+    }
+  }
+  return result;
+}
+
+/* Grayscale passes the same row as all three components. */
+static void convert_row(const uint8_t *c0, const uint8_t *c1,
+                        const uint8_t *c2, uint32_t width, bool rgb,
+                        uint8_t *dst)
+{
+  uint32_t x = 0;
+  if (rgb)
+  {
+    for (; x < width; x++, dst += 4)
+    {
+      dst[0] = c0[x];
+      dst[1] = c1[x];
+      dst[2] = c2[x];
+      dst[3] = 255;
+    }
+    return;
+  }
+
+#ifdef MIUR_HAVE_SSE2
+  x = convert_ycc_sse2(c0, c1, c2, width, dst);
+  dst += (size_t) x * 4;
+#endif
+  for (; x < width; x++, dst += 4)
+  {
+    int32_t luma = c0[x];
+    int32_t cb = c1[x] - 128;
+    int32_t cr = c2[x] - 128;
+    dst[0] = clamp_sample(luma + ((YCC_CR_R * cr + YCC_HALF) >>
+                                  YCC_SCALE_BITS));
+    dst[1] = clamp_sample(luma + ((-YCC_CB_G * cb + YCC_HALF -
+                                   YCC_CR_G * cr) >> YCC_SCALE_BITS));
+    dst[2] = clamp_sample(luma + ((YCC_CB_B * cb + YCC_HALF) >>
+                                  YCC_SCALE_BITS));
+    dst[3] = 255;
+  }
+}
+
+/*
+ * Scales a chroma plane up to the image size.  Halved planes are
+ * interpolated with libjpeg's triangle filter, other factors replicate.
+ */
+static uint8_t *upsample(const Jpeg *jpeg, const JpegComponent *comp)
+{
+  uint32_t width = jpeg->width;
+  uint32_t height = jpeg->height;
+  uint8_t *out = MIUR_ARR_UNINIT(uint8_t, (size_t) width * height);
+  uint8_t *row = MIUR_ARR_UNINIT(uint8_t, (size_t) comp->width * 2 + 2);
+  if (out == NULL || row == NULL)
+  {
+    MIUR_FREE(out);
+    MIUR_FREE(row);
+    return NULL;
+  }
+
+  uint32_t fh = jpeg->h_max / comp->h;
+  uint32_t fv = jpeg->v_max / comp->v;
+  size_t stride = (size_t) comp->blocks_x * 8;
+  /* libjpeg only interpolates planes wider than two samples. */
+  bool fancy = comp->width > 2 && fh <= 2 && fv <= 2;
+  for (uint32_t y = 0; y < height; y++)
+  {
+    uint8_t *dst = out + (size_t) y * width;
+    uint32_t sy = y / fv;
+    const uint8_t *src = comp->plane + sy * stride;
+    if (fancy && fv == 2)
+    {
+      /* The nearer of the rows above and below, clamped at the edges. */
+      uint32_t near_y = y % 2 == 0 ? (sy > 0 ? sy - 1 : 0) :
+        (sy + 1 < comp->height ? sy + 1 : sy);
+      const uint8_t *near = comp->plane + near_y * stride;
+      if (fh == 2)
+      {
+        upsample_h2v2(src, near, comp->width, row);
+      } else
+      {
+        upsample_h1v2(src, near, comp->width, row, y % 2);
+      }
+      memcpy(dst, row, width);
+    } else if (fancy && fh == 2)
+    {
+      upsample_h2v1(src, comp->width, row);
+      memcpy(dst, row, width);
+    } else
+    {
+      for (uint32_t x = 0; x < width; x++)
+      {
+        dst[x] = src[x / fh];
+      }
+    }
+  }
+  MIUR_FREE(row);
+  return out;
+}
+
+static void upsample_h2v1(const uint8_t *in, uint32_t in_width, uint8_t *out)
+{
+  out[0] = in[0];
+  out[1] = (uint8_t) ((in[0] * 3 + in[1] + 2) >> 2);
+  for (uint32_t x = 1; x + 1 < in_width; x++)
+  {
+    int32_t center = in[x] * 3;
+    out[x * 2] = (uint8_t) ((center + in[x - 1] + 1) >> 2);
+    out[x * 2 + 1] = (uint8_t) ((center + in[x + 1] + 2) >> 2);
+  }
+  uint32_t last = in_width - 1;
+  out[last * 2] = (uint8_t) ((in[last] * 3 + in[last - 1] + 1) >> 2);
+  out[last * 2 + 1] = in[last];
+}
+
+/* `bias` is 0 for the upper output row of a pair, 1 for the lower. */
+static void upsample_h1v2(const uint8_t *in, const uint8_t *near,
+                          uint32_t width, uint8_t *out, uint32_t bias)
+{
+  for (uint32_t x = 0; x < width; x++)
+  {
+    out[x] = (uint8_t) ((in[x] * 3 + near[x] + 1 + bias) >> 2);
+  }
+}
+
+static void upsample_h2v2(const uint8_t *in, const uint8_t *near,
+                          uint32_t in_width, uint8_t *out)
+{
+  int32_t this_sum = in[0] * 3 + near[0];
+  int32_t next_sum = in[1] * 3 + near[1];
+  int32_t last_sum;
+  out[0] = (uint8_t) ((this_sum * 4 + 8) >> 4);
+  out[1] = (uint8_t) ((this_sum * 3 + next_sum + 7) >> 4);
+  for (uint32_t x = 1; x + 1 < in_width; x++)
+  {
+    last_sum = this_sum;
+    this_sum = next_sum;
+    next_sum = in[x + 1] * 3 + near[x + 1];
+    out[x * 2] = (uint8_t) ((this_sum * 3 + last_sum + 8) >> 4);
+    out[x * 2 + 1] = (uint8_t) ((this_sum * 3 + next_sum + 7) >> 4);
+  }
+  last_sum = this_sum;
+  this_sum = next_sum;
+  uint32_t last = in_width - 1;
+  out[last * 2] = (uint8_t) ((this_sum * 3 + last_sum + 8) >> 4);
+  out[last * 2 + 1] = (uint8_t) ((this_sum * 4 + 7) >> 4);
+}
+
+static uint16_t read_be16(const uint8_t *p)
+{
+  return (uint16_t) (p[0] << 8 | p[1]);
+}
+
+#ifdef MIUR_HAVE_SSE2
+
+/*
+ * libjpeg-turbo's SSE2 islow: both passes work on eight 16 bit columns at
+ * once, with the multiplications regrouped into pairs for pmaddwd.  The sums
+ * are the same as the scalar pass's, so valid data decodes identically, and
+ * corrupt data wraps instead of overflowing.
+ */
+static void idct_block_sse2(const int16_t *in, const uint16_t *quant,
+                            uint8_t *out, size_t stride)
+{
+  __m128i v[8];
+  for (uint32_t i = 0; i < 8; i++)
+  {
+    v[i] = _mm_mullo_epi16(_mm_loadu_si128((const __m128i *) (in + i * 8)),
+                           _mm_loadu_si128((const __m128i *) (quant + i * 8)));
+  }
+  idct_pass_sse2(v, IDCT_CONST_BITS - IDCT_PASS1_BITS);
+  transpose_sse2(v);
+  idct_pass_sse2(v, IDCT_CONST_BITS + IDCT_PASS1_BITS + 3);
+  transpose_sse2(v);
+
+  /* Saturating to [-128, 127] and flipping the top bit adds the 128. */
+  const __m128i center = _mm_set1_epi8((char) 0x80);
+  for (uint32_t i = 0; i < 8; i += 2, out += stride * 2)
+  {
+    __m128i rows = _mm_xor_si128(_mm_packs_epi16(v[i], v[i + 1]), center);
+    _mm_storel_epi64((__m128i *) out, rows);
+    _mm_storel_epi64((__m128i *) (out + stride), _mm_srli_si128(rows, 8));
+  }
+}
+
+/* One 1D pass down the columns of `v`, rows of coefficients in and out. */
+static void idct_pass_sse2(__m128i v[8], int shift)
+{
+  __m128i halves[2][8];
+  const __m128i round = _mm_set1_epi32(1 << (shift - 1));
+  const __m128i shift_count = _mm_cvtsi32_si128(shift);
+  __m128i z3 = _mm_add_epi16(v[7], v[3]);
+  __m128i z4 = _mm_add_epi16(v[5], v[1]);
+  for (int h = 0; h < 2; h++)
+  {
+    bool high = h != 0;
+    __m128i tmp3 = madd_pair_sse2(v[2], v[6], FIX_0_541196100 +
+                                  FIX_0_765366865, FIX_0_541196100, high);
+    __m128i tmp2 = madd_pair_sse2(v[2], v[6], FIX_0_541196100,
+                                  FIX_0_541196100 - FIX_1_847759065, high);
+    /* Sign extended into the top half, shifted down to << CONST_BITS. */
+    __m128i zero = _mm_setzero_si128();
+    __m128i c0 = high ? _mm_unpackhi_epi16(zero, v[0]) :
+      _mm_unpacklo_epi16(zero, v[0]);
+    __m128i c4 = high ? _mm_unpackhi_epi16(zero, v[4]) :
+      _mm_unpacklo_epi16(zero, v[4]);
+    c0 = _mm_srai_epi32(c0, 16 - IDCT_CONST_BITS);
+    c4 = _mm_srai_epi32(c4, 16 - IDCT_CONST_BITS);
+    __m128i tmp0 = _mm_add_epi32(c0, c4);
+    __m128i tmp1 = _mm_sub_epi32(c0, c4);
+    __m128i tmp10 = _mm_add_epi32(tmp0, tmp3);
+    __m128i tmp13 = _mm_sub_epi32(tmp0, tmp3);
+    __m128i tmp11 = _mm_add_epi32(tmp1, tmp2);
+    __m128i tmp12 = _mm_sub_epi32(tmp1, tmp2);
+
+    __m128i z3_sum = madd_pair_sse2(z3, z4, FIX_1_175875602 - FIX_1_961570560,
+                                    FIX_1_175875602, high);
+    __m128i z4_sum = madd_pair_sse2(z3, z4, FIX_1_175875602,
+                                    FIX_1_175875602 - FIX_0_390180644, high);
+    __m128i odd0 = _mm_add_epi32(madd_pair_sse2(v[7], v[1], FIX_0_298631336 -
+                                                FIX_0_899976223,
+                                                -FIX_0_899976223, high),
+                                 z3_sum);
+    __m128i odd3 = _mm_add_epi32(madd_pair_sse2(v[7], v[1], -FIX_0_899976223,
+                                                FIX_1_501321110 -
+                                                FIX_0_899976223, high),
+                                 z4_sum);
+    __m128i odd1 = _mm_add_epi32(madd_pair_sse2(v[5], v[3], FIX_2_053119869 -
+                                                FIX_2_562915447,
+                                                -FIX_2_562915447, high),
+                                 z4_sum);
+    __m128i odd2 = _mm_add_epi32(madd_pair_sse2(v[5], v[3], -FIX_2_562915447,
+                                                FIX_3_072711026 -
+                                                FIX_2_562915447, high),
+                                 z3_sum);
+
+    __m128i *r = halves[h];
+    r[0] = _mm_add_epi32(tmp10, odd3);
+    r[7] = _mm_sub_epi32(tmp10, odd3);
+    r[1] = _mm_add_epi32(tmp11, odd2);
+    r[6] = _mm_sub_epi32(tmp11, odd2);
+    r[2] = _mm_add_epi32(tmp12, odd1);
+    r[5] = _mm_sub_epi32(tmp12, odd1);
+    r[3] = _mm_add_epi32(tmp13, odd0);
+    r[4] = _mm_sub_epi32(tmp13, odd0);
+    for (uint32_t i = 0; i < 8; i++)
+    {
+      r[i] = _mm_sra_epi32(_mm_add_epi32(r[i], round), shift_count);
+    }
+  }
+  for (uint32_t i = 0; i < 8; i++)
+  {
+    v[i] = _mm_packs_epi32(halves[0][i], halves[1][i]);
+  }
+}
+
+/* a * ca + b * cb in 32 bits, for lanes 0-3 or 4-7. */
+static __m128i madd_pair_sse2(__m128i a, __m128i b, int16_t ca, int16_t cb,
+                              bool high)
+{
+  __m128i pairs = high ? _mm_unpackhi_epi16(a, b) : _mm_unpacklo_epi16(a, b);
+  return _mm_madd_epi16(pairs, _mm_set_epi16(cb, ca, cb, ca, cb, ca, cb, ca));
+}
+
+static void transpose_sse2(__m128i v[8])
+{
+  __m128i a0 = _mm_unpacklo_epi16(v[0], v[1]);
+  __m128i a1 = _mm_unpackhi_epi16(v[0], v[1]);
+  __m128i a2 = _mm_unpacklo_epi16(v[2], v[3]);
+  __m128i a3 = _mm_unpackhi_epi16(v[2], v[3]);
+  __m128i a4 = _mm_unpacklo_epi16(v[4], v[5]);
+  __m128i a5 = _mm_unpackhi_epi16(v[4], v[5]);
+  __m128i a6 = _mm_unpacklo_epi16(v[6], v[7]);
+  __m128i a7 = _mm_unpackhi_epi16(v[6], v[7]);
+  __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+  __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+  __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+  __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+  __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+  __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+  __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+  __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+  v[0] = _mm_unpacklo_epi64(b0, b4);
+  v[1] = _mm_unpackhi_epi64(b0, b4);
+  v[2] = _mm_unpacklo_epi64(b1, b5);
+  v[3] = _mm_unpackhi_epi64(b1, b5);
+  v[4] = _mm_unpacklo_epi64(b2, b6);
+  v[5] = _mm_unpackhi_epi64(b2, b6);
+  v[6] = _mm_unpacklo_epi64(b3, b7);
+  v[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+/*
+ * Eight texels at a time, returns how many were converted.  The constants
+ * don't fit pmaddwd, so their multiples of 65536 are split off and added
+ * after the shift, which keeps the results exact.
+ */
+static uint32_t convert_ycc_sse2(const uint8_t *c0, const uint8_t *c1,
+                                 const uint8_t *c2, uint32_t width,
+                                 uint8_t *dst)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i center = _mm_set1_epi16(128);
+  const __m128i two = _mm_set1_epi16(2);
+  const __m128i half = _mm_set1_epi32(YCC_HALF);
+  const __m128i opaque = _mm_set1_epi8((char) 0xff);
+  /* 91881 = 65536 + 26345, 116130 = 2 * 65536 - 14942 and
+   * -46802 = -65536 + 18734, the halves of 32768 riding along as 2 * 16384. */
+  const __m128i r_coef = _mm_set_epi16(16384, 26345, 16384, 26345, 16384,
+                                       26345, 16384, 26345);
+  const __m128i b_coef = _mm_set_epi16(16384, -14942, 16384, -14942, 16384,
+                                       -14942, 16384, -14942);
+  const __m128i g_coef = _mm_set_epi16(18734, -22554, 18734, -22554, 18734,
+                                       -22554, 18734, -22554);
+  uint32_t x = 0;
+  for (; x + 8 <= width; x += 8, dst += 32)
+  {
+    __m128i luma = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)
+                                                     (c0 + x)), zero);
+    __m128i cb = _mm_sub_epi16(_mm_unpacklo_epi8(
+      _mm_loadl_epi64((const __m128i *) (c1 + x)), zero), center);
+    __m128i cr = _mm_sub_epi16(_mm_unpacklo_epi8(
+      _mm_loadl_epi64((const __m128i *) (c2 + x)), zero), center);
+
+    __m128i r_lo = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(cr, two),
+                                                 r_coef), YCC_SCALE_BITS);
+    __m128i r_hi = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(cr, two),
+                                                 r_coef), YCC_SCALE_BITS);
+    __m128i b_lo = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(cb, two),
+                                                 b_coef), YCC_SCALE_BITS);
+    __m128i b_hi = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(cb, two),
+                                                 b_coef), YCC_SCALE_BITS);
+    __m128i g_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(
+      _mm_unpacklo_epi16(cb, cr), g_coef), half), YCC_SCALE_BITS);
+    __m128i g_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(
+      _mm_unpackhi_epi16(cb, cr), g_coef), half), YCC_SCALE_BITS);
+
+    __m128i r = _mm_add_epi16(luma, _mm_add_epi16(_mm_packs_epi32(r_lo, r_hi),
+                                                  cr));
+    __m128i g = _mm_add_epi16(luma, _mm_sub_epi16(_mm_packs_epi32(g_lo, g_hi),
+                                                  cr));
+    __m128i b = _mm_add_epi16(luma, _mm_add_epi16(_mm_packs_epi32(b_lo, b_hi),
+                                                  _mm_add_epi16(cb, cb)));
+    __m128i rg = _mm_unpacklo_epi8(_mm_packus_epi16(r, r),
+                                   _mm_packus_epi16(g, g));
+    __m128i ba = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), opaque);
+    _mm_storeu_si128((__m128i *) dst, _mm_unpacklo_epi16(rg, ba));
+    _mm_storeu_si128((__m128i *) (dst + 16), _mm_unpackhi_epi16(rg, ba));
+  }
+  return x;
+}
+
+#endif
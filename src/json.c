@@ -22,11 +22,17 @@
  * SOFTWARE.
  */
 
+#include <ctype.h>
 #include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
 
 #include <miur/json.h>
 #include <miur/mem.h>
 #include <miur/log.h>
+#include <miur/utf8.h>
+#include <miur/simd.h>
 
 /**
  * JSON parser. Contains an array of token blocks available. Also stores
@@ -36,8 +42,20 @@ typedef struct JsonParser {
   unsigned int pos;     /* offset in the JSON string */
   unsigned int toknext; /* next token to allocate */
   int toksuper;         /* superior token node, e.g. parent object or array */
+  int toksopen;         /* innermost unclosed object or array */
 } JsonParser;
 
+/**
+ * Returns the offset of the first backslash or control character in `src`,
+ * or `size` if there is none.
+ */
+static size_t json_find_special(const uint8_t *src, size_t size);
+
+/**
+ * Parses four hex digits, returns -1 if they are malformed.
+ */
+static int32_t parse_hex4(const uint8_t *src, size_t size);
+
 /**
  * Create JSON parser over an array of tokens
  */
@@ -63,6 +81,8 @@ static JsonTok *json_alloc_token(JsonParser *parser, JsonTok *tokens,
   tok = &tokens[parser->toknext++];
   tok->start = tok->end = -1;
   tok->size = 0;
+  /* Leaves are their own subtree, containers fix this up when closed. */
+  tok->skip = parser->toknext;
   return tok;
 }
 
@@ -207,7 +227,6 @@ static int json_parse_string(JsonParser *parser, const char *js,
 int json_parse(JsonParser *parser, const char *js, const size_t len,
                JsonTok *tokens, const unsigned int num_tokens) {
   int r;
-  int i;
   JsonTok *token;
   int count = parser->toknext;
 
@@ -238,6 +257,10 @@ int json_parse(JsonParser *parser, const char *js, const size_t len,
       }
       token->type = (c == '{' ? JSON_OBJECT : JSON_ARRAY);
       token->start = parser->pos;
+      /* Open containers keep their parent in skip until they are closed,
+       * so closing never has to search back through the tokens. */
+      token->skip = parser->toksopen;
+      parser->toksopen = parser->toknext - 1;
       parser->toksuper = parser->toknext - 1;
       break;
     case '}':
@@ -246,28 +269,18 @@ int json_parse(JsonParser *parser, const char *js, const size_t len,
         break;
       }
       type = (c == '}' ? JSON_OBJECT : JSON_ARRAY);
-      for (i = parser->toknext - 1; i >= 0; i--) {
-        token = &tokens[i];
-        if (token->start != -1 && token->end == -1) {
-          if (token->type != type) {
-            return JSON_ERROR_INVAL;
-          }
-          parser->toksuper = -1;
-          token->end = parser->pos + 1;
-          break;
-        }
-      }
       /* Error if unmatched closing bracket */
-      if (i == -1) {
+      if (parser->toksopen == -1) {
         return JSON_ERROR_INVAL;
       }
-      for (; i >= 0; i--) {
-        token = &tokens[i];
-        if (token->start != -1 && token->end == -1) {
-          parser->toksuper = i;
-          break;
-        }
+      token = &tokens[parser->toksopen];
+      if (token->type != type) {
+        return JSON_ERROR_INVAL;
       }
+      token->end = parser->pos + 1;
+      parser->toksopen = token->skip;
+      parser->toksuper = token->skip;
+      token->skip = parser->toknext;
       break;
     case '\"':
       r = json_parse_string(parser, js, len, tokens, num_tokens);
@@ -291,14 +304,7 @@ int json_parse(JsonParser *parser, const char *js, const size_t len,
       if (tokens != NULL && parser->toksuper != -1 &&
           tokens[parser->toksuper].type != JSON_ARRAY &&
           tokens[parser->toksuper].type != JSON_OBJECT) {
-        for (i = parser->toknext - 1; i >= 0; i--) {
-          if (tokens[i].type == JSON_ARRAY || tokens[i].type == JSON_OBJECT) {
-            if (tokens[i].start != -1 && tokens[i].end == -1) {
-              parser->toksuper = i;
-              break;
-            }
-          }
-        }
+        parser->toksuper = parser->toksopen;
       }
       break;
     /* In strict mode primitives are: numbers and booleans */
@@ -358,13 +364,9 @@ int json_parse(JsonParser *parser, const char *js, const size_t len,
     }
   }
 
-  if (tokens != NULL) {
-    for (i = parser->toknext - 1; i >= 0; i--) {
-      /* Unmatched opened object or array */
-      if (tokens[i].start != -1 && tokens[i].end == -1) {
-        return JSON_ERROR_PART;
-      }
-    }
+  /* Unmatched opened object or array */
+  if (tokens != NULL && parser->toksopen != -1) {
+    return JSON_ERROR_PART;
   }
 
   return count;
@@ -378,21 +380,46 @@ void json_init(JsonParser *parser) {
   parser->pos = 0;
   parser->toknext = 0;
   parser->toksuper = -1;
+  parser->toksopen = -1;
 }
 
-void json_stream_init(JsonStream *stream, Membuf buf)
+bool json_stream_init(JsonStream *stream, Membuf buf)
 {
   JsonParser parser;
   json_init(&parser);
 
   stream->eof.type = JSON_EOF;
   stream->cur = 0;
-  stream->toks_size = json_parse(&parser, buf.data, buf.size, NULL, 0);
-  stream->toks = MIUR_ARR(JsonTok, stream->toks_size);
+  stream->toks = NULL;
   stream->buf = buf;
+
+  int count = json_parse(&parser, (const char *) buf.data, buf.size, NULL,
+                         0);
+  if (count <= 0)
+  {
+    stream->toks_size = 0;
+    return false;
+  }
+
+  stream->toks_size = count;
+  stream->eof.skip = count;
+  stream->toks = MIUR_ARR(JsonTok, stream->toks_size);
+  if (stream->toks == NULL)
+  {
+    return false;
+  }
+
   json_init(&parser);
-  json_parse(&parser, buf.data, buf.size, stream->toks,
-             stream->toks_size);
+  return json_parse(&parser, (const char *) buf.data, buf.size, stream->toks,
+                    stream->toks_size) >= 0;
+}
+
+void json_skip_value(JsonStream *stream)
+{
+  if (stream->cur < stream->toks_size)
+  {
+    stream->cur = stream->toks[stream->cur].skip;
+  }
 }
 
 void json_print(JsonStream *stream, JsonTok tok)
@@ -474,13 +501,20 @@ double json_get_number(JsonStream *stream, JsonTok tok)
                       stream->buf.data[i] == 'E'))
   {
     double exp = 0.0;
+    bool exp_negative = false;
     i++;
+    if (i < tok.end && (stream->buf.data[i] == '-' ||
+                        stream->buf.data[i] == '+'))
+    {
+      exp_negative = stream->buf.data[i] == '-';
+      i++;
+    }
     for (; i < tok.end && isdigit(stream->buf.data[i]); i++)
     {
       exp *= 10.0;
       exp += ((double) (stream->buf.data[i] - '0'));
     }
-    sum = pow(sum, exp);
+    sum *= pow(10.0, exp_negative ? -exp : exp);
   }
 
   if (is_negative)
@@ -500,6 +534,113 @@ String json_get_string(JsonStream *stream, JsonTok tok)
   return str;
 }
 
+bool json_decode_string(JsonStream *stream, JsonTok tok, Arena *arena,
+                        String *out)
+{
+  const uint8_t *src = stream->buf.data + tok.start;
+  size_t size = tok.end - tok.start;
+
+  /* Fast path, nothing to decode so hand back the bytes in place. */
+  if (json_find_special(src, size) == size)
+  {
+    if (!utf8_validate(src, size))
+    {
+      return false;
+    }
+    out->data = src;
+    out->size = size;
+    return true;
+  }
+
+  uint8_t *dst = arena_alloc(arena, size);
+  if (dst == NULL)
+  {
+    return false;
+  }
+
+  if (!json_unescape(src, size, dst, &out->size))
+  {
+    return false;
+  }
+  out->data = dst;
+  return true;
+}
+
+bool json_unescape(const uint8_t *src, size_t size, uint8_t *dst,
+                   size_t *dst_size)
+{
+  size_t i = 0, written = 0;
+
+  while (i < size)
+  {
+    size_t run = json_find_special(src + i, size - i);
+    memcpy(dst + written, src + i, run);
+    written += run;
+    i += run;
+
+    if (i >= size)
+    {
+      break;
+    }
+
+    /* Unescaped control characters are not allowed inside strings. */
+    if (src[i] != '\\' || i + 1 >= size)
+    {
+      return false;
+    }
+
+    i++;
+    switch (src[i++])
+    {
+    case '"':  dst[written++] = '"';  break;
+    case '\\': dst[written++] = '\\'; break;
+    case '/':  dst[written++] = '/';  break;
+    case 'b':  dst[written++] = '\b'; break;
+    case 'f':  dst[written++] = '\f'; break;
+    case 'n':  dst[written++] = '\n'; break;
+    case 'r':  dst[written++] = '\r'; break;
+    case 't':  dst[written++] = '\t'; break;
+    case 'u': {
+      int32_t codepoint = parse_hex4(src + i, size - i);
+      if (codepoint < 0)
+      {
+        return false;
+      }
+      i += 4;
+
+      /* Code points outside the BMP are written as surrogate pairs. */
+      if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+      {
+        if (i + 6 > size || src[i] != '\\' || src[i + 1] != 'u')
+        {
+          return false;
+        }
+        int32_t low = parse_hex4(src + i + 2, size - i - 2);
+        if (low < 0xDC00 || low > 0xDFFF)
+        {
+          return false;
+        }
+        i += 6;
+        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+      }
+
+      size_t len = utf8_encode((uint32_t) codepoint, dst + written);
+      if (len == 0)
+      {
+        return false;
+      }
+      written += len;
+      break;
+    }
+    default:
+      return false;
+    }
+  }
+
+  *dst_size = written;
+  return utf8_validate(dst, written);
+}
+
 void json_get_position_info(JsonStream *stream, JsonTok tok, int *line_out,
                             int *col_out)
 {
@@ -518,9 +659,86 @@ void json_get_position_info(JsonStream *stream, JsonTok tok, int *line_out,
   *col_out = col;
 }
 
+void json_parse_error(JsonStream *stream, JsonTok bad_tok, ParseError *error,
+                      const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+
+  vsnprintf(error->msg, MAX_PARSE_ERROR_MSG_LENGTH, fmt, args);
+  va_end(args);
+  json_get_position_info(stream, bad_tok, &error->line, &error->col);
+}
+
 bool json_streq(JsonStream *stream, JsonTok tok, const char *cstr)
 {
   String str = json_get_string(stream, tok);
   size_t size = strlen(cstr);
-  return str.size == size && strncmp(cstr, str.data, size) == 0;
+  return str.size == size &&
+    strncmp(cstr, (const char *) str.data, size) == 0;
+}
+
+static size_t json_find_special(const uint8_t *src, size_t size)
+{
+  size_t i = 0;
+
+#ifdef MIUR_HAVE_SSE2
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i control_max = _mm_set1_epi8(0x1F);
+  for (; i + 16 <= size; i += 16)
+  {
+    __m128i chunk = _mm_loadu_si128((const __m128i *) (src + i));
+    /* max(c, 0x1F) == 0x1F exactly when c <= 0x1F (unsigned). */
+    __m128i is_control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, control_max),
+                                        control_max);
+    __m128i is_backslash = _mm_cmpeq_epi8(chunk, backslash);
+    unsigned mask = (unsigned) _mm_movemask_epi8(_mm_or_si128(is_control,
+                                                              is_backslash));
+    if (mask != 0)
+    {
+      return i + MIUR_CTZ32(mask);
+    }
+  }
+#endif
+
+  for (; i < size; i++)
+  {
+    if (src[i] == '\\' || src[i] < 0x20)
+    {
+      return i;
+    }
+  }
+  return size;
+}
+
+static int32_t parse_hex4(const uint8_t *src, size_t size)
+{
+  int32_t value = 0;
+  if (size < 4)
+  {
+    return -1;
+  }
+
+  for (int i = 0; i < 4; i++)
+  {
+    uint8_t c = src[i];
+    value <<= 4;
+    if (c >= '0' && c <= '9')
+    {
+      value |= c - '0';
+    }
+    else if (c >= 'a' && c <= 'f')
+    {
+      value |= c - 'a' + 10;
+    }
+    else if (c >= 'A' && c <= 'F')
+    {
+      value |= c - 'A' + 10;
+    }
+    else
+    {
+      return -1;
+    }
+  }
+  return value;
 }
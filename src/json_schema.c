@@ -0,0 +1,436 @@
+/* =====================
+ * src/json_schema.c
+ * 10/18/2026
+ * Table driven JSON decoding.
+ * ====================
+ */
+
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <miur/json_schema.h>
+#include <miur/log.h>
+
+#define FIELD_PTR(_out, _field) ((uint8_t *) (_out) + (_field)->offset)
+#define FIELD_COUNT_PTR(_out, _field) ((size_t *) ((uint8_t *) (_out) +        \
+                                                   (_field)->count_offset))
+
+typedef enum
+{
+  SCHEMA_UNPREPARED,
+  SCHEMA_PREPARING,
+  SCHEMA_READY,
+} SchemaState;
+
+/* === PROTOTYPES === */
+
+static const JsonField *schema_find(JsonSchema *schema, JsonStream *stream,
+                                    JsonTok key);
+static bool decode_field(JsonDecoder *dec, const JsonField *field, void *out);
+static bool decode_int_array(JsonDecoder *dec, const JsonField *field,
+                             void *out);
+static bool decode_float_array(JsonDecoder *dec, const JsonField *field,
+                               void *out);
+static bool decode_enum(JsonDecoder *dec, const JsonField *field, void *out);
+static bool decode_cstring(JsonDecoder *dec, const char **out);
+
+/* === PUBLIC FUNCTIONS === */
+
+void json_decoder_init(JsonDecoder *dec, JsonStream *stream, Arena *arena,
+                       ParseError *error)
+{
+  dec->stream = stream;
+  dec->arena = arena;
+  dec->error = error;
+}
+
+void json_schema_prepare(JsonSchema *schema)
+{
+  if (!atomic_i32_cas(&schema->state, SCHEMA_UNPREPARED, SCHEMA_PREPARING))
+  {
+    while (atomic_i32_load(&schema->state) != SCHEMA_READY)
+    {
+      thread_yield();
+    }
+    return;
+  }
+
+  if (schema->field_count > JSON_SCHEMA_MAX_FIELDS)
+  {
+    MIUR_LOG_ERR("schema %s has more than %d fields, extra fields ignored",
+                 schema->name, JSON_SCHEMA_MAX_FIELDS);
+    schema->field_count = JSON_SCHEMA_MAX_FIELDS;
+  }
+
+  memset(schema->slots, 0, sizeof(schema->slots));
+  for (size_t i = 0; i < schema->field_count; i++)
+  {
+    String key = string_from_cstr(schema->fields[i].key);
+    uint32_t hash = string_hash(&key);
+    size_t slot = hash % JSON_SCHEMA_BUCKETS;
+
+    while (schema->slots[slot] != 0)
+    {
+      slot = (slot + 1) % JSON_SCHEMA_BUCKETS;
+    }
+    schema->hashes[slot] = hash;
+    /* Zero marks an empty slot, so field indices are stored plus one. */
+    schema->slots[slot] = (uint8_t) (i + 1);
+  }
+  atomic_i32_store(&schema->state, SCHEMA_READY);
+
+  /* Ready first, so a schema nesting itself doesn't wait on itself. */
+  for (size_t i = 0; i < schema->field_count; i++)
+  {
+    if (schema->fields[i].schema != NULL)
+    {
+      json_schema_prepare(schema->fields[i].schema);
+    }
+  }
+}
+
+bool json_decode_object(JsonDecoder *dec, JsonSchema *schema, void *out)
+{
+  JsonStream *stream = dec->stream;
+  JsonTok object = JSON_NEXT(stream);
+  if (object.type != JSON_OBJECT)
+  {
+    return json_decode_error(dec, object, "expected %s to be an object",
+                             schema->name);
+  }
+
+  if (atomic_i32_load(&schema->state) != SCHEMA_READY)
+  {
+    return json_decode_error(dec, object, "schema %s isn't prepared",
+                             schema->name);
+  }
+  if (schema->init != NULL)
+  {
+    schema->init(out);
+  }
+
+  for (int i = 0; i < object.size; i++)
+  {
+    JsonTok key = JSON_NEXT(stream);
+    if (key.type != JSON_STRING)
+    {
+      return json_decode_error(dec, key, "expected key in %s", schema->name);
+    }
+
+    const JsonField *field = schema_find(schema, stream, key);
+    if (field != NULL)
+    {
+      if (!decode_field(dec, field, out))
+      {
+        return false;
+      }
+    }
+    else if (schema->unknown != NULL)
+    {
+      if (!schema->unknown(dec, key, out))
+      {
+        return false;
+      }
+    }
+    else if (schema->flags & JSON_SCHEMA_STRICT)
+    {
+      String str = json_get_string(stream, key);
+      return json_decode_error(dec, key, "unknown %s field '%.*s'",
+                               schema->name, (int) str.size, str.data);
+    }
+    else
+    {
+      json_skip_value(stream);
+    }
+  }
+
+  return true;
+}
+
+bool json_decode_object_array(JsonDecoder *dec, JsonSchema *schema,
+                              void **out, size_t *count)
+{
+  JsonTok array = JSON_NEXT(dec->stream);
+  if (array.type != JSON_ARRAY)
+  {
+    return json_decode_error(dec, array, "expected an array of %s",
+                             schema->name);
+  }
+
+  *count = array.size;
+  *out = NULL;
+  if (array.size == 0)
+  {
+    return true;
+  }
+
+  uint8_t *elems = arena_alloc(dec->arena, schema->struct_size * array.size);
+  if (elems == NULL)
+  {
+    return json_decode_error(dec, array, "out of memory");
+  }
+  memset(elems, 0, schema->struct_size * array.size);
+
+  for (int i = 0; i < array.size; i++)
+  {
+    if (!json_decode_object(dec, schema, elems + i * schema->struct_size))
+    {
+      return false;
+    }
+  }
+
+  *out = elems;
+  return true;
+}
+
+bool json_decode_int(JsonDecoder *dec, int *out)
+{
+  JsonStream *stream = dec->stream;
+  JsonTok tok = JSON_NEXT(stream);
+  if (tok.type != JSON_NUMBER)
+  {
+    return json_decode_error(dec, tok, "expected an integer");
+  }
+
+  const uint8_t *c = stream->buf.data + tok.start;
+  const uint8_t *end = stream->buf.data + tok.end;
+  bool negative = *c == '-';
+  int64_t limit = negative ? (int64_t) INT_MAX + 1 : INT_MAX;
+  int64_t value = 0;
+
+  c += negative;
+  if (c == end)
+  {
+    return json_decode_error(dec, tok, "expected an integer");
+  }
+  for (; c < end; c++)
+  {
+    if (*c < '0' || *c > '9')
+    {
+      return json_decode_error(dec, tok, "expected an integer");
+    }
+    /* Checked every digit, so `value` itself can never overflow. */
+    value = value * 10 + (*c - '0');
+    if (value > limit)
+    {
+      return json_decode_error(dec, tok, "integer out of range");
+    }
+  }
+
+  *out = (int) (negative ? -value : value);
+  return true;
+}
+
+bool json_decode_float(JsonDecoder *dec, float *out)
+{
+  JsonTok tok = JSON_NEXT(dec->stream);
+  if (tok.type != JSON_NUMBER)
+  {
+    return json_decode_error(dec, tok, "expected a number");
+  }
+  *out = (float) json_get_number(dec->stream, tok);
+  return true;
+}
+
+bool json_decode_error(JsonDecoder *dec, JsonTok tok, const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+
+  if (dec->error != NULL)
+  {
+    vsnprintf(dec->error->msg, MAX_PARSE_ERROR_MSG_LENGTH, fmt, args);
+    json_get_position_info(dec->stream, tok, &dec->error->line,
+                           &dec->error->col);
+  }
+  va_end(args);
+  return false;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static const JsonField *schema_find(JsonSchema *schema, JsonStream *stream,
+                                    JsonTok key)
+{
+  String str = json_get_string(stream, key);
+  uint32_t hash = string_hash(&str);
+  size_t slot = hash % JSON_SCHEMA_BUCKETS;
+
+  while (schema->slots[slot] != 0)
+  {
+    if (schema->hashes[slot] == hash)
+    {
+      const JsonField *field = &schema->fields[schema->slots[slot] - 1];
+      if (string_cstr_eq(&str, field->key))
+      {
+        return field;
+      }
+    }
+    slot = (slot + 1) % JSON_SCHEMA_BUCKETS;
+  }
+  return NULL;
+}
+
+static bool decode_field(JsonDecoder *dec, const JsonField *field, void *out)
+{
+  void *ptr = FIELD_PTR(out, field);
+  JsonStream *stream = dec->stream;
+
+  switch (field->kind)
+  {
+  case JSON_FIELD_INT:
+    return json_decode_int(dec, (int *) ptr);
+  case JSON_FIELD_FLOAT:
+    return json_decode_float(dec, (float *) ptr);
+  case JSON_FIELD_BOOL: {
+    JsonTok tok = JSON_NEXT(stream);
+    if (tok.type != JSON_TRUE && tok.type != JSON_FALSE)
+    {
+      return json_decode_error(dec, tok, "field '%s' must be a boolean",
+                               field->key);
+    }
+    *(bool *) ptr = tok.type == JSON_TRUE;
+    return true;
+  }
+  case JSON_FIELD_STRING: {
+    JsonTok tok = JSON_NEXT(stream);
+    if (tok.type != JSON_STRING)
+    {
+      return json_decode_error(dec, tok, "field '%s' must be a string",
+                               field->key);
+    }
+    if (!json_decode_string(stream, tok, dec->arena, (String *) ptr))
+    {
+      return json_decode_error(dec, tok, "field '%s' is not a valid string",
+                               field->key);
+    }
+    return true;
+  }
+  case JSON_FIELD_CSTRING:
+    return decode_cstring(dec, (const char **) ptr);
+  case JSON_FIELD_FLOAT_ARRAY:
+    return decode_float_array(dec, field, out);
+  case JSON_FIELD_INT_ARRAY:
+    return decode_int_array(dec, field, out);
+  case JSON_FIELD_ENUM:
+    return decode_enum(dec, field, out);
+  case JSON_FIELD_OBJECT:
+    return json_decode_object(dec, field->schema, ptr);
+  case JSON_FIELD_OBJECT_ARRAY:
+    return json_decode_object_array(dec, field->schema, (void **) ptr,
+                                    FIELD_COUNT_PTR(out, field));
+  case JSON_FIELD_CUSTOM:
+    return field->custom(dec, ptr);
+  }
+  return false;
+}
+
+static bool decode_int_array(JsonDecoder *dec, const JsonField *field,
+                             void *out)
+{
+  JsonTok array = JSON_NEXT(dec->stream);
+  if (array.type != JSON_ARRAY)
+  {
+    return json_decode_error(dec, array, "field '%s' must be an array",
+                             field->key);
+  }
+
+  int *elems = NULL;
+  if (array.size > 0)
+  {
+    elems = arena_alloc(dec->arena, sizeof(int) * array.size);
+    if (elems == NULL)
+    {
+      return json_decode_error(dec, array, "out of memory");
+    }
+  }
+
+  for (int i = 0; i < array.size; i++)
+  {
+    if (!json_decode_int(dec, &elems[i]))
+    {
+      return false;
+    }
+  }
+
+  *(int **) FIELD_PTR(out, field) = elems;
+  *FIELD_COUNT_PTR(out, field) = array.size;
+  return true;
+}
+
+static bool decode_float_array(JsonDecoder *dec, const JsonField *field,
+                               void *out)
+{
+  JsonTok array = JSON_NEXT(dec->stream);
+  if (array.type != JSON_ARRAY)
+  {
+    return json_decode_error(dec, array, "field '%s' must be an array",
+                             field->key);
+  }
+  if ((size_t) array.size > field->capacity)
+  {
+    return json_decode_error(dec, array,
+                             "field '%s' has more than %zu elements",
+                             field->key, field->capacity);
+  }
+
+  float *elems = (float *) FIELD_PTR(out, field);
+  for (int i = 0; i < array.size; i++)
+  {
+    if (!json_decode_float(dec, &elems[i]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool decode_enum(JsonDecoder *dec, const JsonField *field, void *out)
+{
+  JsonTok tok = JSON_NEXT(dec->stream);
+  if (tok.type != JSON_STRING)
+  {
+    return json_decode_error(dec, tok, "field '%s' must be a string",
+                             field->key);
+  }
+
+  String str = json_get_string(dec->stream, tok);
+  for (int i = 0; field->names[i] != NULL; i++)
+  {
+    if (string_cstr_eq(&str, field->names[i]))
+    {
+      *(int *) FIELD_PTR(out, field) = i;
+      return true;
+    }
+  }
+
+  return json_decode_error(dec, tok, "unknown value '%.*s' for field '%s'",
+                           (int) str.size, str.data, field->key);
+}
+
+static bool decode_cstring(JsonDecoder *dec, const char **out)
+{
+  JsonTok tok = JSON_NEXT(dec->stream);
+  if (tok.type != JSON_STRING)
+  {
+    return json_decode_error(dec, tok, "expected a string");
+  }
+
+  size_t size = tok.end - tok.start;
+  char *str = arena_alloc(dec->arena, size + 1);
+  if (str == NULL)
+  {
+    return json_decode_error(dec, tok, "out of memory");
+  }
+
+  if (!json_unescape(dec->stream->buf.data + tok.start, size,
+                     (uint8_t *) str, &size))
+  {
+    return json_decode_error(dec, tok, "invalid string");
+  }
+  str[size] = '\0';
+  *out = str;
+  return true;
+}
@@ -0,0 +1,414 @@
+/* =====================
+ * src/ktx.c
+ * 10/18/2026
+ * KTX2 texture containers.
+ * ====================
+ */
+
+#include <string.h>
+
+#include <miur/archive.h>
+#include <miur/inflate.h>
+#include <miur/ktx.h>
+#include <miur/log.h>
+#include <miur/mem.h>
+
+#define KTX_IDENTIFIER_SIZE 12
+#define KTX_HEADER_SIZE 80
+#define KTX_LEVEL_SIZE 24
+#define KTX_SUPERCOMPRESSION_NONE 0
+#define KTX_SUPERCOMPRESSION_ZLIB 3
+
+/* The data format descriptor, one basic block of 16 byte samples. */
+#define KTX_DFD_BLOCK_SIZE 24
+#define KTX_DFD_SAMPLE_SIZE 16
+#define KTX_DFD_VERSION 2
+#define KTX_DFD_MODEL_RGBSDA 1
+#define KTX_DFD_MODEL_BC1A 128
+#define KTX_DFD_MODEL_BC3 130
+#define KTX_DFD_MODEL_BC5 132
+#define KTX_DFD_MODEL_BC7 134
+#define KTX_DFD_PRIMARIES_BT709 1
+#define KTX_DFD_TRANSFER_LINEAR 1
+#define KTX_DFD_TRANSFER_SRGB 2
+#define KTX_DFD_CHANNEL_ALPHA 15
+#define KTX_DFD_QUALIFIER_LINEAR 0x10
+
+/* How a format is named and described in a file. */
+typedef struct
+{
+  uint32_t vk_format;          /* VkFormat, without Vulkan's headers. */
+  uint8_t model;
+  uint8_t sample_count;        /* Each an equal share of the block. */
+  uint8_t channels[4];
+} KtxFormat;
+
+/* The header past the identifier, up to the index. */
+typedef struct
+{
+  uint32_t vk_format;
+  uint32_t type_size;
+  uint32_t width;
+  uint32_t height;
+  uint32_t depth;
+  uint32_t layer_count;
+  uint32_t face_count;
+  uint32_t level_count;        /* At least 1, 0 in a file means 1. */
+  uint32_t supercompression;
+} KtxHeader;
+
+typedef struct
+{
+  uint64_t offset;
+  uint64_t size;
+  uint64_t uncompressed_size;
+} KtxLevel;
+
+/* === PROTOTYPES === */
+
+static bool parse(const uint8_t *data, size_t size, KtxHeader *header,
+                  KtxLevel *levels, Texture *layout);
+static void write_dfd(uint8_t *dst, TextureFormat format);
+static uint32_t dfd_size(TextureFormat format);
+static uint32_t read_u32(const uint8_t *p);
+static uint64_t read_u64(const uint8_t *p);
+static void write_u32(uint8_t *p, uint32_t value);
+static void write_u64(uint8_t *p, uint64_t value);
+
+/* === GLOBALS === */
+
+static const uint8_t ktx_identifier[KTX_IDENTIFIER_SIZE] = {
+  0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n',
+};
+
+static const KtxFormat ktx_formats[TEXTURE_FORMAT_COUNT] = {
+  [TEXTURE_FORMAT_RGBA8] = {
+    37, KTX_DFD_MODEL_RGBSDA, 4, { 0, 1, 2, KTX_DFD_CHANNEL_ALPHA },
+  },
+  [TEXTURE_FORMAT_RGBA8_SRGB] = {
+    43, KTX_DFD_MODEL_RGBSDA, 4, { 0, 1, 2, KTX_DFD_CHANNEL_ALPHA },
+  },
+  [TEXTURE_FORMAT_BC1] = { 131, KTX_DFD_MODEL_BC1A, 1, { 0 } },
+  [TEXTURE_FORMAT_BC1_SRGB] = { 132, KTX_DFD_MODEL_BC1A, 1, { 0 } },
+  [TEXTURE_FORMAT_BC3] = {
+    137, KTX_DFD_MODEL_BC3, 2, { KTX_DFD_CHANNEL_ALPHA, 0 },
+  },
+  [TEXTURE_FORMAT_BC3_SRGB] = {
+    138, KTX_DFD_MODEL_BC3, 2, { KTX_DFD_CHANNEL_ALPHA, 0 },
+  },
+  [TEXTURE_FORMAT_BC5] = { 141, KTX_DFD_MODEL_BC5, 2, { 0, 1 } },
+  [TEXTURE_FORMAT_BC7] = { 145, KTX_DFD_MODEL_BC7, 1, { 0 } },
+  [TEXTURE_FORMAT_BC7_SRGB] = { 146, KTX_DFD_MODEL_BC7, 1, { 0 } },
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+bool ktx_is_ktx2(const uint8_t *data, size_t size)
+{
+  return size >= KTX_IDENTIFIER_SIZE &&
+    memcmp(data, ktx_identifier, KTX_IDENTIFIER_SIZE) == 0;
+}
+
+bool ktx_open(KtxTexture *out, const char *filename)
+{
+  memset(out, 0, sizeof(KtxTexture));
+  if (!archive_map_file(&out->file, filename, MEMBUF_MAP_WILLNEED))
+  {
+    return false;
+  }
+
+  KtxHeader header;
+  KtxLevel levels[TEXTURE_MAX_MIPS];
+  Texture *texture = &out->texture;
+  if (!parse(out->file.data, out->file.size, &header, levels, texture))
+  {
+    MIUR_LOG_ERR("'%s' is not a KTX2 file miur can read", filename);
+    ktx_close(out);
+    return false;
+  }
+
+  if (header.supercompression != KTX_SUPERCOMPRESSION_NONE)
+  {
+    bool result = ktx_decode(texture, out->file.data, out->file.size);
+    membuf_destroy(&out->file);
+    if (!result)
+    {
+      MIUR_LOG_ERR("'%s' failed to inflate", filename);
+    }
+    return result;
+  }
+
+  /* The chain spans from the first level in the file to the last. */
+  uint64_t start = UINT64_MAX;
+  uint64_t end = 0;
+  for (uint32_t i = 0; i < texture->mip_count; i++)
+  {
+    start = levels[i].offset < start ? levels[i].offset : start;
+    end = levels[i].offset + levels[i].size > end ?
+      levels[i].offset + levels[i].size : end;
+  }
+  for (uint32_t i = 0; i < texture->mip_count; i++)
+  {
+    texture->mips[i].offset = (size_t) (levels[i].offset - start);
+  }
+  texture->data = (uint8_t *) out->file.data + start;
+  texture->size = (size_t) (end - start);
+  return true;
+}
+
+void ktx_close(KtxTexture *ktx)
+{
+  if (ktx->file.data != NULL)
+  {
+    membuf_destroy(&ktx->file);
+    memset(&ktx->texture, 0, sizeof(Texture));
+  }
+  else
+  {
+    texture_destroy(&ktx->texture);
+  }
+}
+
+bool ktx_decode(Texture *out, const uint8_t *data, size_t size)
+{
+  KtxHeader header;
+  KtxLevel levels[TEXTURE_MAX_MIPS];
+  Texture texture;
+  memset(out, 0, sizeof(Texture));
+  if (!parse(data, size, &header, levels, &texture))
+  {
+    return false;
+  }
+
+  texture.data = MIUR_ARR(uint8_t, texture.size);
+  if (texture.data == NULL)
+  {
+    return false;
+  }
+  for (uint32_t i = 0; i < texture.mip_count; i++)
+  {
+    const uint8_t *src = data + levels[i].offset;
+    uint8_t *dst = texture.data + texture.mips[i].offset;
+    if (header.supercompression == KTX_SUPERCOMPRESSION_NONE)
+    {
+      memcpy(dst, src, texture.mips[i].size);
+    }
+    else if (!inflate_zlib(src, (size_t) levels[i].size, dst,
+                           texture.mips[i].size))
+    {
+      texture_destroy(&texture);
+      return false;
+    }
+  }
+  *out = texture;
+  return true;
+}
+
+bool ktx_write(const Texture *texture, const char *filename)
+{
+  const KtxFormat *format = &ktx_formats[texture->format];
+  uint32_t block_size = texture_format_block_size(texture->format);
+  uint64_t alignment = block_size > 0 ? block_size : 4;
+  uint64_t dfd_offset = KTX_HEADER_SIZE +
+    (uint64_t) texture->mip_count * KTX_LEVEL_SIZE;
+
+  /* Smallest level first, each aligned to its blocks and to 4 bytes. */
+  uint64_t offsets[TEXTURE_MAX_MIPS];
+  uint64_t size = dfd_offset + dfd_size(texture->format);
+  for (uint32_t i = texture->mip_count; i-- > 0;)
+  {
+    size = (size + alignment - 1) & ~(alignment - 1);
+    offsets[i] = size;
+    size += texture->mips[i].size;
+  }
+
+  uint8_t *data = MIUR_ARR(uint8_t, (size_t) size);
+  if (data == NULL)
+  {
+    return false;
+  }
+  memcpy(data, ktx_identifier, KTX_IDENTIFIER_SIZE);
+  uint8_t *p = data + KTX_IDENTIFIER_SIZE;
+  uint32_t fields[] = {
+    format->vk_format, 1, texture->width, texture->height, 0, 0, 1,
+    texture->mip_count, KTX_SUPERCOMPRESSION_NONE,
+    (uint32_t) dfd_offset, dfd_size(texture->format), 0, 0,
+  };
+  for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+  {
+    write_u32(p + i * 4, fields[i]);
+  }
+  for (uint32_t i = 0; i < texture->mip_count; i++)
+  {
+    uint8_t *level = data + KTX_HEADER_SIZE + i * KTX_LEVEL_SIZE;
+    write_u64(level, offsets[i]);
+    write_u64(level + 8, texture->mips[i].size);
+    write_u64(level + 16, texture->mips[i].size);
+    memcpy(data + offsets[i], texture->data + texture->mips[i].offset,
+           texture->mips[i].size);
+  }
+  write_dfd(data + dfd_offset, texture->format);
+
+  Membuf file = {
+    .data = data,
+    .size = (size_t) size,
+    .kind = MEMBUF_HEAP,
+  };
+  bool result = membuf_replace_file(file, filename);
+  MIUR_FREE(data);
+  return result;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/*
+ * Checks the header and level index against a file of `size` bytes and
+ * fills in the layout its levels must have.  Everything read later is
+ * checked here.
+ */
+static bool parse(const uint8_t *data, size_t size, KtxHeader *header,
+                  KtxLevel *levels, Texture *layout)
+{
+  if (!ktx_is_ktx2(data, size) || size < KTX_HEADER_SIZE)
+  {
+    return false;
+  }
+  const uint8_t *p = data + KTX_IDENTIFIER_SIZE;
+  header->vk_format = read_u32(p);
+  header->type_size = read_u32(p + 4);
+  header->width = read_u32(p + 8);
+  header->height = read_u32(p + 12);
+  header->depth = read_u32(p + 16);
+  header->layer_count = read_u32(p + 20);
+  header->face_count = read_u32(p + 24);
+  header->level_count = read_u32(p + 28);
+  header->supercompression = read_u32(p + 32);
+
+  uint32_t format = 0;
+  while (format < TEXTURE_FORMAT_COUNT &&
+         ktx_formats[format].vk_format != header->vk_format)
+  {
+    format++;
+  }
+  if (format == TEXTURE_FORMAT_COUNT)
+  {
+    MIUR_LOG_ERR("KTX2 format %u isn't supported", header->vk_format);
+    return false;
+  }
+  if (header->supercompression != KTX_SUPERCOMPRESSION_NONE &&
+      header->supercompression != KTX_SUPERCOMPRESSION_ZLIB)
+  {
+    MIUR_LOG_ERR("KTX2 supercompression scheme %u isn't supported",
+                 header->supercompression);
+    return false;
+  }
+  if (header->type_size != 1 || header->depth != 0 ||
+      header->layer_count != 0 || header->face_count != 1 ||
+      !texture_layout(layout, (TextureFormat) format, header->width,
+                      header->height))
+  {
+    return false;
+  }
+
+  header->level_count = header->level_count > 0 ? header->level_count : 1;
+  if (header->level_count > layout->mip_count ||
+      (size - KTX_HEADER_SIZE) / KTX_LEVEL_SIZE < header->level_count)
+  {
+    return false;
+  }
+  texture_truncate_mips(layout, header->level_count);
+
+  /* Uncompressed levels are aligned so they can be copied in place. */
+  uint32_t block_size = texture_format_block_size(layout->format);
+  uint64_t alignment = block_size > 0 ? block_size : 4;
+  for (uint32_t i = 0; i < header->level_count; i++)
+  {
+    const uint8_t *index = data + KTX_HEADER_SIZE + i * KTX_LEVEL_SIZE;
+    KtxLevel *level = &levels[i];
+    level->offset = read_u64(index);
+    level->size = read_u64(index + 8);
+    level->uncompressed_size = read_u64(index + 16);
+    if (level->uncompressed_size != layout->mips[i].size ||
+        level->offset > size || level->size > size - level->offset)
+    {
+      return false;
+    }
+    if (header->supercompression == KTX_SUPERCOMPRESSION_NONE &&
+        (level->size != level->uncompressed_size ||
+         level->offset % alignment != 0))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* A basic descriptor block, as the KTX2 specification requires one. */
+static void write_dfd(uint8_t *dst, TextureFormat format)
+{
+  const KtxFormat *ktx = &ktx_formats[format];
+  bool srgb = texture_format_is_srgb(format);
+  uint32_t block_size = texture_format_block_size(format);
+  uint32_t block_bits = (block_size > 0 ? block_size : 4) * 8;
+  uint32_t sample_bits = block_bits / ktx->sample_count;
+
+  write_u32(dst, dfd_size(format));
+  /* Khronos' vendor ID and the basic descriptor type are both 0. */
+  write_u32(dst + 4, 0);
+  write_u32(dst + 8, KTX_DFD_VERSION | (dfd_size(format) - 4) << 16);
+  dst[12] = ktx->model;
+  dst[13] = KTX_DFD_PRIMARIES_BT709;
+  dst[14] = srgb ? KTX_DFD_TRANSFER_SRGB : KTX_DFD_TRANSFER_LINEAR;
+  /* Texel block dimensions less one, then bytes in the only plane. */
+  dst[16] = block_size > 0 ? 3 : 0;
+  dst[17] = block_size > 0 ? 3 : 0;
+  dst[20] = (uint8_t) (block_bits / 8);
+
+  for (uint32_t i = 0; i < ktx->sample_count; i++)
+  {
+    uint8_t *sample = dst + 4 + KTX_DFD_BLOCK_SIZE + i * KTX_DFD_SAMPLE_SIZE;
+    uint8_t channel = ktx->channels[i];
+    uint32_t offset = i * sample_bits;
+    sample[0] = (uint8_t) offset;
+    sample[1] = (uint8_t) (offset >> 8);
+    sample[2] = (uint8_t) (sample_bits - 1);
+    /* sRGB only applies to color, alpha stays linear. */
+    sample[3] = (uint8_t) (channel | (srgb && channel == KTX_DFD_CHANNEL_ALPHA ?
+                                      KTX_DFD_QUALIFIER_LINEAR : 0));
+    write_u32(sample + 8, 0);
+    write_u32(sample + 12, block_size > 0 ? UINT32_MAX :
+              (1u << sample_bits) - 1);
+  }
+}
+
+/* Of the whole descriptor, including its leading total size. */
+static uint32_t dfd_size(TextureFormat format)
+{
+  return 4 + KTX_DFD_BLOCK_SIZE +
+    ktx_formats[format].sample_count * KTX_DFD_SAMPLE_SIZE;
+}
+
+static uint32_t read_u32(const uint8_t *p)
+{
+  return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 |
+    (uint32_t) p[3] << 24;
+}
+
+static uint64_t read_u64(const uint8_t *p)
+{
+  return (uint64_t) read_u32(p) | (uint64_t) read_u32(p + 4) << 32;
+}
+
+static void write_u32(uint8_t *p, uint32_t value)
+{
+  p[0] = (uint8_t) value;
+  p[1] = (uint8_t) (value >> 8);
+  p[2] = (uint8_t) (value >> 16);
+  p[3] = (uint8_t) (value >> 24);
+}
+
+static void write_u64(uint8_t *p, uint64_t value)
+{
+  write_u32(p, (uint32_t) value);
+  write_u32(p + 4, (uint32_t) (value >> 32));
+}
@@ -0,0 +1,334 @@
+/* =====================
+ * src/lz.c
+ * 10/18/2026
+ * LZ77 block compression.
+ * ====================
+ */
+
+#include <string.h>
+
+#include <miur/lz.h>
+#include <miur/mem.h>
+
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+/* The last match must start this far from the end and the last literals
+ * must be at least LZ_LAST_LITERALS long, as in LZ4. */
+#define LZ_MATCH_LIMIT 12
+#define LZ_LAST_LITERALS 5
+#define LZ_HASH_BITS 14
+#define LZ_HASH_SIZE (1 << LZ_HASH_BITS)
+/* Scan faster through data that doesn't compress. */
+#define LZ_SKIP_TRIGGER 6
+#define LZ_WILD_COPY 16
+
+/* === PROTOTYPES === */
+
+static uint32_t read32(const uint8_t *p);
+static uint32_t hash4(uint32_t value);
+static size_t match_length(const uint8_t *a, const uint8_t *b,
+                           const uint8_t *end);
+static uint8_t *write_length(uint8_t *op, size_t length);
+static bool read_length(const uint8_t **ip, const uint8_t *end,
+                        size_t *length);
+static void copy_match(uint8_t *op, const uint8_t *match, size_t length,
+                       const uint8_t *op_end);
+
+/* === PUBLIC FUNCTIONS === */
+
+size_t lz_compress_bound(size_t size)
+{
+  return size + size / 255 + 16;
+}
+
+size_t lz_compress(const uint8_t *src, size_t size, uint8_t *dst,
+                   size_t capacity)
+{
+  if (capacity < lz_compress_bound(size))
+  {
+    return 0;
+  }
+
+  uint32_t *table = MIUR_ARR(uint32_t, LZ_HASH_SIZE);
+  if (table == NULL)
+  {
+    return 0;
+  }
+
+  const uint8_t *ip = src;
+  const uint8_t *anchor = src;
+  const uint8_t *end = src + size;
+  const uint8_t *match_limit = size > LZ_MATCH_LIMIT ?
+    end - LZ_MATCH_LIMIT : src;
+  const uint8_t *match_end = size > LZ_LAST_LITERALS ?
+    end - LZ_LAST_LITERALS : src;
+  uint8_t *op = dst;
+
+  /* Table entries are positions plus one, zero is empty. */
+  while (ip < match_limit)
+  {
+    const uint8_t *match = NULL;
+    unsigned attempts = 1 << LZ_SKIP_TRIGGER;
+
+    while (ip < match_limit)
+    {
+      uint32_t seq = read32(ip);
+      uint32_t h = hash4(seq);
+      uint32_t candidate = table[h];
+      table[h] = (uint32_t) (ip - src) + 1;
+
+      if (candidate != 0)
+      {
+        const uint8_t *ref = src + candidate - 1;
+        if (ip - ref <= LZ_MAX_OFFSET && read32(ref) == seq)
+        {
+          match = ref;
+          break;
+        }
+      }
+      ip += attempts++ >> LZ_SKIP_TRIGGER;
+    }
+    if (match == NULL)
+    {
+      break;
+    }
+
+    /* Extend backwards over literals that also match. */
+    while (ip > anchor && match > src && ip[-1] == match[-1])
+    {
+      ip--;
+      match--;
+    }
+
+    size_t literals = ip - anchor;
+    size_t length = LZ_MIN_MATCH +
+      match_length(ip + LZ_MIN_MATCH, match + LZ_MIN_MATCH, match_end);
+
+    uint8_t *token = op++;
+    *token = (uint8_t) ((literals < 15 ? literals : 15) << 4);
+    if (literals >= 15)
+    {
+      op = write_length(op, literals - 15);
+    }
+    memcpy(op, anchor, literals);
+    op += literals;
+
+    uint16_t offset = (uint16_t) (ip - match);
+    op[0] = (uint8_t) offset;
+    op[1] = (uint8_t) (offset >> 8);
+    op += 2;
+
+    size_t extra = length - LZ_MIN_MATCH;
+    *token |= (uint8_t) (extra < 15 ? extra : 15);
+    if (extra >= 15)
+    {
+      op = write_length(op, extra - 15);
+    }
+
+    ip += length;
+    anchor = ip;
+    if (ip < match_limit)
+    {
+      /* Index a position inside the match to find repeats sooner. */
+      table[hash4(read32(ip - 2))] = (uint32_t) (ip - 2 - src) + 1;
+    }
+  }
+
+  size_t literals = end - anchor;
+  *op++ = (uint8_t) ((literals < 15 ? literals : 15) << 4);
+  if (literals >= 15)
+  {
+    op = write_length(op, literals - 15);
+  }
+  memcpy(op, anchor, literals);
+  op += literals;
+
+  MIUR_FREE(table);
+  return op - dst;
+}
+
+bool lz_decompress(const uint8_t *src, size_t size, uint8_t *dst,
+                   size_t dst_size)
+{
+  const uint8_t *ip = src;
+  const uint8_t *ip_end = src + size;
+  uint8_t *op = dst;
+  uint8_t *op_end = dst + dst_size;
+
+  while (ip < ip_end)
+  {
+    uint8_t token = *ip++;
+
+    size_t literals = token >> 4;
+    if (literals == 15 && !read_length(&ip, ip_end, &literals))
+    {
+      return false;
+    }
+    if (literals > (size_t) (ip_end - ip) ||
+        literals > (size_t) (op_end - op))
+    {
+      return false;
+    }
+
+    if (literals <= LZ_WILD_COPY && ip_end - ip >= LZ_WILD_COPY &&
+        op_end - op >= LZ_WILD_COPY)
+    {
+      /* Short runs copy a fixed 16 bytes, the excess is overwritten. */
+      memcpy(op, ip, LZ_WILD_COPY);
+    }
+    else
+    {
+      memcpy(op, ip, literals);
+    }
+    ip += literals;
+    op += literals;
+
+    if (ip == ip_end)
+    {
+      break;
+    }
+
+    if (ip_end - ip < 2)
+    {
+      return false;
+    }
+    size_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (size_t) (op - dst))
+    {
+      return false;
+    }
+
+    size_t length = token & 15;
+    if (length == 15 && !read_length(&ip, ip_end, &length))
+    {
+      return false;
+    }
+    length += LZ_MIN_MATCH;
+    if (length > (size_t) (op_end - op))
+    {
+      return false;
+    }
+
+    copy_match(op, op - offset, length, op_end);
+    op += length;
+  }
+
+  return op == op_end;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static uint32_t read32(const uint8_t *p)
+{
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static uint32_t hash4(uint32_t value)
+{
+  return (value * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static size_t match_length(const uint8_t *a, const uint8_t *b,
+                           const uint8_t *end)
+{
+  const uint8_t *start = a;
+  while (a + sizeof(uint64_t) <= end)
+  {
+    uint64_t x, y;
+    memcpy(&x, a, sizeof(x));
+    memcpy(&y, b, sizeof(y));
+    uint64_t diff = x ^ y;
+    if (diff != 0)
+    {
+      /* Little endian, the lowest differing byte is the first mismatch. */
+      size_t same = 0;
+      while ((diff & 0xFF) == 0)
+      {
+        diff >>= 8;
+        same++;
+      }
+      return a - start + same;
+    }
+    a += sizeof(uint64_t);
+    b += sizeof(uint64_t);
+  }
+  while (a < end && *a == *b)
+  {
+    a++;
+    b++;
+  }
+  return a - start;
+}
+
+static uint8_t *write_length(uint8_t *op, size_t length)
+{
+  while (length >= 255)
+  {
+    *op++ = 255;
+    length -= 255;
+  }
+  *op++ = (uint8_t) length;
+  return op;
+}
+
+static bool read_length(const uint8_t **ip, const uint8_t *end,
+                        size_t *length)
+{
+  uint8_t byte;
+  do
+  {
+    if (*ip == end)
+    {
+      return false;
+    }
+    byte = *(*ip)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/*
+ * Matches may overlap their output (offset < length), which repeats the last
+ * `offset` bytes.  Copies 16 bytes at a time where the offset allows it and
+ * never writes past `op_end`.
+ */
+static void copy_match(uint8_t *op, const uint8_t *match, size_t length,
+                       const uint8_t *op_end)
+{
+  uint8_t *end = op + length;
+  size_t offset = op - match;
+
+  if (offset >= LZ_WILD_COPY)
+  {
+    while (op + LZ_WILD_COPY <= op_end && op < end)
+    {
+      memcpy(op, match, LZ_WILD_COPY);
+      op += LZ_WILD_COPY;
+      match += LZ_WILD_COPY;
+    }
+  }
+  else if (offset >= sizeof(uint64_t))
+  {
+    while (op + sizeof(uint64_t) <= op_end && op < end)
+    {
+      memcpy(op, match, sizeof(uint64_t));
+      op += sizeof(uint64_t);
+      match += sizeof(uint64_t);
+    }
+  }
+
+  /* Overshoot from the loops above is rewritten here, byte by byte. */
+  if (op > end)
+  {
+    size_t back = op - end;
+    op -= back;
+    match -= back;
+  }
+  while (op < end)
+  {
+    *op++ = *match++;
+  }
+}
@@ -10,7 +10,9 @@
 
 #include <cwin.h>
 
-#include <miur/gltf.h>
+#include <miur/archive.h>
+#include <miur/asset_stream.h>
+#include <miur/job.h>
 #include <miur/log.h>
 #include <miur/render.h>
 #include <miur/material.h>
@@ -32,7 +34,10 @@ int main(int argc, char *argv[])
   struct cwin_window *window;
   struct cwin_event event;
   bool running = true;
-  StaticModel cube;
+  AssetStreamer *streamer;
+  StreamAsset *cube;
+  bool cube_shown = false;
+  JobSystem *jobs;
   enum cwin_error err;
 
   err = cwin_init();
@@ -55,6 +60,18 @@ int main(int argc, char *argv[])
     return EXIT_FAILURE;
   }
 
+  jobs = job_system_create(0);
+  if (jobs == NULL)
+  {
+    MIUR_LOG_ERR("Failed to create job system");
+    return EXIT_FAILURE;
+  }
+
+  /* Packed builds ship assets and shaders in one archive, without it the
+   * loose files are loaded. */
+  archive_set_job_system(jobs);
+  archive_mount("../miur.pak", "../");
+
   RendererBuilder renderer_builder = {
     .window = window,
     .name = "Miur Test",
@@ -70,15 +87,19 @@ int main(int argc, char *argv[])
     return EXIT_FAILURE;
   }
 
-  if (!gltf_parse(&cube, "../assets/cube.gltf"))
+  /* Frames are drawn from the start, the cube shows up once it streams in. */
+  AssetStreamerDesc streamer_desc = { 0 };
+  streamer = asset_streamer_create(render, jobs, NULL, &streamer_desc);
+  if (streamer == NULL)
   {
-    MIUR_LOG_ERR("Failed to parser cube.gltf");
+    MIUR_LOG_ERR("Failed to create asset streamer");
     return EXIT_FAILURE;
   }
-
-  if (!renderer_init_static_mesh(render, &cube.meshes[0]))
+  cube = asset_streamer_request(streamer, "../assets/cube.gltf", 0);
+  if (cube == NULL)
   {
-    return true;
+    MIUR_LOG_ERR("Failed to request cube.gltf");
+    return EXIT_FAILURE;
   }
 
   while (running)
@@ -91,6 +112,18 @@ int main(int argc, char *argv[])
         running = false;
       }
     }
+
+    asset_streamer_update(streamer);
+    if (!cube_shown && stream_asset_state(cube) == STREAM_READY)
+    {
+      renderer_show_static_model(render, stream_asset_model(cube));
+      cube_shown = true;
+    } else if (stream_asset_state(cube) == STREAM_FAILED)
+    {
+      MIUR_LOG_ERR("Failed to parse cube.gltf");
+      running = false;
+    }
+
     if (!renderer_draw(render))
     {
       MIUR_LOG_ERR("Failed to draw frame");
@@ -100,9 +133,11 @@ int main(int argc, char *argv[])
 
   cwin_destroy_window(window);
 
-  renderer_deinit_static_mesh(render, &cube.meshes[0]);
+  asset_streamer_destroy(streamer);
 
   renderer_destroy(render);
+  archive_unmount_all();
+  job_system_destroy(jobs);
   MIUR_LOG_INFO("Exiting successfully");
   return EXIT_SUCCESS;
 }
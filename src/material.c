@@ -6,15 +6,14 @@
  */
 
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
 
 #include <miur/material.h>
-#include <miur/json.h>
+#include <miur/arena.h>
 
 /* === PROTOTYPES FUNCTIONS === */
 
-static void json_parse_error(JsonStream *stream, JsonTok bad_tok,
-                             ParseError *error,
-                             const char *fmt, ...);
 bool technique_build(VkDevice dev, VkExtent2D present_extent, 
     VkFormat present_format, Technique *tech);
 void technique_destroy(void *ud, Technique *tech);
@@ -23,6 +22,14 @@ static void mark_materials(MaterialCache *materials, Effect *effect);
 static void mark_effects(MaterialCache *materials, EffectCache *effects, Technique *tech);
 static void mark_techniques(TechniqueCache *techs, MaterialCache *materials, 
     EffectCache *effects, ShaderModule *mod);
+static Technique *technique_add(VkDevice dev, VkExtent2D present_extent,
+    VkFormat present_format, TechniqueCache *cache, String *name,
+    ShaderModule *vert, ShaderModule *frag, VertexFormat vertex_format,
+    VertexLayout vertex_layout);
+static ShaderModule *load_table_shader(VkDevice dev, ShaderCache *shaders,
+    const MaterialTable *table, uint32_t index);
+static void desc_error(ParseError *error, int line, int col,
+                       const char *fmt, ...);
 
 /* === PUBLIC FUNCTIONS === */
 
@@ -84,112 +91,80 @@ bool technique_cache_load_file(VkDevice device, VkExtent2D present_extent,
                                ParseError*error)
 {
   *(cache->dev) = device;
-  JsonStream stream;
-  JsonTok global, technique;
-  json_stream_init(&stream, file);
-  Technique empty_technique = {0};
+  Arena arena;
+  TechniqueDesc *descs;
+  size_t count;
+  bool result = false;
 
-  if (!JSON_EXPECT_WITH(&stream, JSON_OBJECT, &global))
+  arena_create(&arena, 0);
+  if (!technique_file_parse(file, &arena, &descs, &count, error))
   {
-    json_parse_error(&stream, global, error,
-                         "expected global object specifiying techniques");
-    return false;
+    goto cleanup;
   }
 
-
-  JSON_FOR_OBJECT(&stream, global, technique_name_tok)
+  for (size_t i = 0; i < count; i++)
   {
-    String _technique_name = json_get_string(&stream, technique_name_tok);
-    String technique_name = string_libc_clone(&_technique_name);
-    Technique *tech = technique_map_insert(&cache->map, &technique_name, 
-        &empty_technique);
-    if (tech == NULL)
+    TechniqueDesc *desc = &descs[i];
+    ShaderModule *vert = shader_cache_load(device, shaders, &desc->vert);
+    if (vert == NULL)
     {
-      json_parse_error(&stream, technique_name_tok, error, 
-          "duplicate technique '%.*s'", (int) technique_name.size, 
-          (char *) technique_name.data);
-      return false;
+      desc_error(error, desc->line, desc->col,
+          "failed to load vertex shader file: '%.*s'", (int) desc->vert.size,
+          (char *) desc->vert.data);
+      goto cleanup;
     }
-    tech->shaders.vert = tech->shaders.frag = NULL;
 
-    JsonTok technique_tok;
-    if (!JSON_EXPECT_WITH(&stream, JSON_OBJECT, &technique_tok))
+    ShaderModule *frag = shader_cache_load(device, shaders, &desc->frag);
+    if (frag == NULL)
     {
-      json_parse_error(&stream, technique_tok, error,
-          "techniques should be specified as a JSON object");
-      return false;
+      desc_error(error, desc->line, desc->col,
+          "failed to load fragment shader file: '%.*s'", (int) desc->frag.size,
+          (char *) desc->frag.data);
+      goto cleanup;
     }
 
-    JSON_FOR_OBJECT(&stream, technique_tok, field)
+    if (technique_add(device, present_extent, present_format, cache,
+                      &desc->name, vert, frag,
+                      (VertexFormat) desc->vertex_format,
+                      (VertexLayout) desc->vertex_layout) == NULL)
     {
-      if (json_streq(&stream, field, "vert"))
-      {
-        JsonTok filename_tok;
-        if (!JSON_EXPECT_WITH(&stream, JSON_STRING, &filename_tok))
-        {
-
-          json_parse_error(&stream, filename_tok, error,
-              "technique field 'vert' must correspond to a string");
-          return false;
-        }
-
-        String filename = json_get_string(&stream, filename_tok);
-        tech->shaders.vert = shader_cache_load(device, shaders, &filename);
-        if (tech->shaders.vert == NULL)
-        {
-          json_parse_error(&stream, filename_tok, error,
-              "failed to load vertex shader file: '%.*s'", (int) filename.size,
-              (char *) filename.data);
-          return false;
-        }
-      }
-      else if (json_streq(&stream, field, "frag"))
-      {
-        JsonTok filename_tok;
-        if (!JSON_EXPECT_WITH(&stream, JSON_STRING, &filename_tok))
-        {
-
-          json_parse_error(&stream, filename_tok, error,
-              "technique field 'frag' must correspond to a string");
-          return false;
-        }
-
-        String filename = json_get_string(&stream, filename_tok);
-        tech->shaders.frag = shader_cache_load(device, shaders, &filename);
-        if (tech->shaders.frag == NULL)
-        {
-          json_parse_error(&stream, filename_tok, error,
-              "failed to load fragment shader file: '%.*s'", (int) filename.size,
-              (char *) filename.data);
-          return false;
-        }
-      } else
-      {
-        String str = json_get_string(&stream, field);
-        json_parse_error(&stream, field, error, 
-            "unknown technique field: '%.*s'", (int) str.size, str.data);
-        return false;
-      } 
-
+      desc_error(error, desc->line, desc->col,
+          "failed to add technique: '%.*s'", (int) desc->name.size,
+          (char *) desc->name.data);
+      goto cleanup;
     }
+  }
 
-    if (tech->shaders.frag == NULL || tech->shaders.vert == NULL)
-    {
-      json_parse_error(&stream, technique_name_tok, error,
-          "technique requires both a vertex and fragment shader");
-      return false;
-    }
+  result = true;
+cleanup:
+  arena_destroy(&arena);
+  return result;
+}
 
-    if (!technique_build(device, present_extent, present_format, tech))
+bool technique_cache_load_table(VkDevice device, VkExtent2D present_extent,
+                                VkFormat present_format,
+                                TechniqueCache *cache, ShaderCache *shaders,
+                                const MaterialTable *table)
+{
+  *(cache->dev) = device;
+  for (uint32_t i = 0; i < table->header->technique_count; i++)
+  {
+    const MaterialTableTechnique *entry = &table->techniques[i];
+    String name = material_table_string(table, entry->name_offset);
+    ShaderModule *vert = load_table_shader(device, shaders, table,
+                                           entry->vert);
+    ShaderModule *frag = load_table_shader(device, shaders, table,
+                                           entry->frag);
+    if (vert == NULL || frag == NULL ||
+        technique_add(device, present_extent, present_format, cache, &name,
+                      vert, frag, (VertexFormat) entry->vertex_format,
+                      (VertexLayout) entry->vertex_layout) == NULL)
     {
-      json_parse_error(&stream, technique_name_tok, error,
-          "failed to build technique: '%.*s'", (int) technique_name.size,
-          technique_name.data);
+      MIUR_LOG_ERR("Failed to add technique '%.*s'", (int) name.size,
+                   (char *) name.data);
       return false;
     }
   }
-
-  json_stream_deinit(&stream);
   return true;
 }
 
@@ -217,69 +192,81 @@ bool effect_cache_load_file(VkDevice dev, EffectCache *cache,
                             TechniqueCache *techs, Membuf file,
                             ParseError *error)
 {
-  JsonStream stream;
-  JsonTok global;
-  json_stream_init(&stream, file);
-  Effect empty_effect = {0};
+  Arena arena;
+  EffectDesc *descs;
+  size_t count;
+  bool result = false;
 
-  if (!JSON_EXPECT_WITH(&stream, JSON_OBJECT, &global))
+  arena_create(&arena, 0);
+  if (!effect_file_parse(file, &arena, &descs, &count, error))
   {
-    json_parse_error(&stream, global, error,
-                     "expected global object specifiying effects");
-    return false;
+    goto cleanup;
   }
 
-  JSON_FOR_OBJECT(&stream, global, effect_name_tok)
+  for (size_t i = 0; i < count; i++)
   {
-    String _effect_name = json_get_string(&stream, effect_name_tok);
-    String effect_name = string_libc_clone(&_effect_name);
-    Effect *effect = effect_map_insert(&cache->map, &effect_name, &empty_effect);
-    if (effect == NULL)
+    EffectDesc *desc = &descs[i];
+    Effect new_effect = {0};
+    if (desc->forward.data != NULL)
     {
-      json_parse_error(&stream, effect_name_tok, error,
-          "duplicate effect '%.*s'", (int) effect_name.size, effect_name.data); 
-      return false;
+      new_effect.techniques.forward = technique_cache_lookup(techs, 
+          &desc->forward);
+      if (new_effect.techniques.forward == NULL)
+      {
+        desc_error(error, desc->line, desc->col,
+            "unknown technique name '%.*s'", (int) desc->forward.size, 
+            (char *) desc->forward.data);
+        goto cleanup;
+      }
     }
 
-    JsonTok effect_tok;
-    if (!JSON_EXPECT_WITH(&stream, JSON_OBJECT, &effect_tok))
+    String effect_name = string_libc_clone(&desc->name);
+    if (effect_map_insert(&cache->map, &effect_name, &new_effect) == NULL)
     {
-      json_parse_error(&stream, effect_tok, error,
-          "effects should be specified as a JSON object");
-      return false;
+      string_libc_destroy(NULL, &effect_name);
+      desc_error(error, desc->line, desc->col,
+          "duplicate effect '%.*s'", (int) desc->name.size,
+          (char *) desc->name.data); 
+      goto cleanup;
     }
+  }
+
+  result = true;
+cleanup:
+  arena_destroy(&arena);
+  return result;
+}
 
-    JSON_FOR_OBJECT(&stream, effect_tok, field_tok)
+bool effect_cache_load_table(EffectCache *cache, TechniqueCache *techs,
+                             const MaterialTable *table)
+{
+  for (uint32_t i = 0; i < table->header->effect_count; i++)
+  {
+    const MaterialTableEffect *entry = &table->effects[i];
+    String name = material_table_string(table, entry->name_offset);
+    Effect new_effect = {0};
+    if (entry->forward_offset != MATERIAL_TABLE_NONE)
     {
-      String field = json_get_string(&stream, field_tok);
-      if (string_cstr_eq(&field, "forward"))
+      String forward = material_table_string(table, entry->forward_offset);
+      new_effect.techniques.forward = technique_cache_lookup(techs, &forward);
+      if (new_effect.techniques.forward == NULL)
       {
-        JsonTok technique_name_tok;
-        if (!JSON_EXPECT_WITH(&stream, JSON_STRING, &technique_name_tok))
-        {
-          json_parse_error(&stream, technique_name_tok, error,
-              "effect field 'forward' must be the name of a technique");
-          return false;
-        }
-        String _technique_name = json_get_string(&stream, technique_name_tok);
-        String technique_name = string_libc_clone(&_technique_name);
-        effect->techniques.forward = technique_cache_lookup(techs, &technique_name);
-        if (effect->techniques.forward == NULL)
-        {
-          json_parse_error(&stream, field_tok, error,
-              "unknown technique name '%.*s'", (int) technique_name.size, 
-              technique_name.data);
-          return false;
-        }
-      } else
-      {
-        json_parse_error(&stream, field_tok, error,
-            "unknown technique field '%.*s'", (int) field.size, field.data);
+        MIUR_LOG_ERR("Effect '%.*s' has unknown technique '%.*s'",
+                     (int) name.size, (char *) name.data,
+                     (int) forward.size, (char *) forward.data);
         return false;
       }
     }
+
+    String effect_name = string_libc_clone(&name);
+    if (effect_map_insert(&cache->map, &effect_name, &new_effect) == NULL)
+    {
+      string_libc_destroy(NULL, &effect_name);
+      MIUR_LOG_ERR("Duplicate effect '%.*s'", (int) name.size,
+                   (char *) name.data);
+      return false;
+    }
   }
-  // @TODO: Load effect file.
   return true;
 }
 
@@ -392,8 +379,17 @@ bool technique_build(VkDevice dev, VkExtent2D present_extent,
   tech->mark = false;
 
   // @TODO: Add technique descriptor set building. 
+  VkPushConstantRange draw_range = {
+    .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+    .offset = 0,
+    .size = tech->vertex_format == VERTEX_FORMAT_QUANTIZED ?
+      sizeof(DrawConstants) : offsetof(DrawConstants, quantization),
+  };
+
   VkPipelineLayoutCreateInfo layout_create_info = {
     .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+    .pushConstantRangeCount = 1,
+    .pPushConstantRanges = &draw_range,
   };
 
   err = vkCreatePipelineLayout(dev, &layout_create_info, NULL, &tech->layout);
@@ -403,39 +399,36 @@ bool technique_build(VkDevice dev, VkExtent2D present_extent,
     return false;
   }
   
-  VkVertexInputBindingDescription binding_descriptions[] = {
-    {
-      .binding = 0,
-      .stride = 3 * sizeof(float),
-      .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
-    },
-    {
-      .binding = 1,
-      .stride = 3 * sizeof(float),
+  VkVertexInputBindingDescription binding_descriptions[VERTEX_ATTRIBUTE_COUNT];
+  VkVertexInputAttributeDescription
+    attribute_descriptions[VERTEX_ATTRIBUTE_COUNT];
+  bool interleaved = tech->vertex_layout == VERTEX_LAYOUT_INTERLEAVED;
+  uint32_t binding_count = vertex_layout_binding_count(tech->vertex_layout);
+  for (uint32_t i = 0; i < binding_count; i++)
+  {
+    binding_descriptions[i] = (VkVertexInputBindingDescription) {
+      .binding = i,
+      .stride = vertex_binding_stride(tech->vertex_format,
+                                      tech->vertex_layout, i),
       .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
-    },
-  };
-
-  VkVertexInputAttributeDescription attribute_descriptions[] = {
-    {
-      .binding = 0,
-      .location = 0,
-      .format = VK_FORMAT_R32G32B32_SFLOAT,
-      .offset = 0,
-    },
-    {
-      .binding = 1,
-      .location = 1,
-      .format = VK_FORMAT_R32G32B32_SFLOAT,
-      .offset = 0,
-    },
-  };
+    };
+  }
+  for (uint32_t i = 0; i < VERTEX_ATTRIBUTE_COUNT; i++)
+  {
+    attribute_descriptions[i] = (VkVertexInputAttributeDescription) {
+      .binding = interleaved ? 0 : i,
+      .location = i,
+      .format = vertex_attribute_format(tech->vertex_format, i),
+      .offset = interleaved ?
+        vertex_attribute_offset(tech->vertex_format, i) : 0,
+    };
+  }
 
   VkPipelineVertexInputStateCreateInfo vertex_input_state = {
     .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-    .vertexBindingDescriptionCount = 2,
+    .vertexBindingDescriptionCount = binding_count,
     .pVertexBindingDescriptions = binding_descriptions,
-    .vertexAttributeDescriptionCount = 2,
+    .vertexAttributeDescriptionCount = VERTEX_ATTRIBUTE_COUNT,
     .pVertexAttributeDescriptions = attribute_descriptions,
   };
 
@@ -593,15 +586,63 @@ bool technique_build(VkDevice dev, VkExtent2D present_extent,
   return true;
 }
 
-static void json_parse_error(JsonStream *stream, JsonTok bad_tok,
-                             ParseError *error, const char *fmt,
-                             ...)
+static Technique *technique_add(VkDevice dev, VkExtent2D present_extent,
+    VkFormat present_format, TechniqueCache *cache, String *name,
+    ShaderModule *vert, ShaderModule *frag, VertexFormat vertex_format,
+    VertexLayout vertex_layout)
+{
+  Technique new_tech = {
+    .shaders = { vert, frag },
+    .vertex_format = vertex_format,
+    .vertex_layout = vertex_layout,
+  };
+  if (technique_map_find(&cache->map, name) != NULL)
+  {
+    MIUR_LOG_ERR("Duplicate technique '%.*s'", (int) name->size,
+                 (char *) name->data);
+    return NULL;
+  }
+
+  /*
+   * Only inserted once built, so lookups and the map's destructor never
+   * find a technique without its pipeline.
+   */
+  if (!technique_build(dev, present_extent, present_format, &new_tech))
+  {
+    technique_destroy(&dev, &new_tech);
+    return NULL;
+  }
+  String tech_name = string_libc_clone(name);
+  Technique *tech = technique_map_insert(&cache->map, &tech_name, &new_tech);
+  if (tech == NULL)
+  {
+    string_libc_destroy(NULL, &tech_name);
+    technique_destroy(&dev, &new_tech);
+  }
+  return tech;
+}
+
+static ShaderModule *load_table_shader(VkDevice dev, ShaderCache *shaders,
+    const MaterialTable *table, uint32_t index)
+{
+  const MaterialTableShader *shader = &table->shaders[index];
+  String path = material_table_string(table, shader->path_offset);
+  return shader_cache_load_spirv(dev, shaders, &path,
+                                 (VkShaderStageFlagBits) shader->stage,
+                                 material_table_shader_code(table, shader),
+                                 shader->code_size);
+}
+
+/* A ParseError at a description, once its JSON is gone. */
+static void desc_error(ParseError *error, int line, int col,
+                       const char *fmt, ...)
 {
   va_list args;
   va_start(args, fmt);
-
   vsnprintf(error->msg, MAX_PARSE_ERROR_MSG_LENGTH, fmt, args);
-  json_get_position_info(stream, bad_tok, &error->line, &error->col);
+  va_end(args);
+  error->line = line;
+  error->col = col;
 }
 
 void technique_destroy(void *ud, Technique *tech)
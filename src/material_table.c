@@ -0,0 +1,588 @@
+/* =====================
+ * src/material_table.c
+ * 10/18/2026
+ * Technique and effect descriptions and their cooked tables.
+ * ====================
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <miur/archive.h>
+#include <miur/hash.h>
+#include <miur/json_schema.h>
+#include <miur/log.h>
+#include <miur/material_table.h>
+#include <miur/mem.h>
+
+/* === PROTOTYPES === */
+
+static bool parse_begin(JsonStream *stream, Membuf file, JsonTok *global,
+                        const char *what, ParseError *error);
+static bool validate(MaterialTable *table);
+static bool strings_in_bounds(const char *data, uint64_t offset,
+                              uint64_t size, uint64_t file_size);
+static bool sources_current(const MaterialTable *table,
+                            const char *source_filename);
+static bool has_suffix(const String *str, const char *suffix);
+static uint32_t find_shader(const MaterialTableShaderCode *shaders,
+                            size_t shader_count, const String *path);
+static uint32_t add_string(char *strings, uint32_t *size, const String *str);
+static uint64_t align_up(uint64_t value);
+
+/* === SCHEMAS === */
+
+#define TECHNIQUE_DESC_FIELDS(X, S)                                            \
+  X(S, STRING,       "vert",          vert,            ,                 )     \
+  X(S, STRING,       "frag",          frag,            ,                 )     \
+  X(S, ENUM,         "vertex_format", vertex_format,  , vertex_format_names )  \
+  X(S, ENUM,         "vertex_layout", vertex_layout,  , vertex_layout_names )
+JSON_SCHEMA_DEFINE(technique_desc_schema, TechniqueDesc, TECHNIQUE_DESC_FIELDS,
+                   JSON_SCHEMA_STRICT, NULL, NULL);
+
+#define EFFECT_DESC_FIELDS(X, S)                                               \
+  X(S, STRING,       "forward",       forward,         ,                 )
+JSON_SCHEMA_DEFINE(effect_desc_schema, EffectDesc, EFFECT_DESC_FIELDS,
+                   JSON_SCHEMA_STRICT, NULL, NULL);
+
+/* === PUBLIC FUNCTIONS === */
+
+bool technique_file_parse(Membuf file, Arena *arena, TechniqueDesc **out,
+                          size_t *count_out, ParseError *error)
+{
+  JsonStream stream;
+  JsonDecoder dec;
+  JsonTok global;
+  bool result = false;
+  size_t count = 0;
+
+  *out = NULL;
+  *count_out = 0;
+  if (!parse_begin(&stream, file, &global, "techniques", error))
+  {
+    goto cleanup;
+  }
+  json_decoder_init(&dec, &stream, arena, error);
+  json_schema_prepare(&technique_desc_schema);
+
+  TechniqueDesc *descs = (TechniqueDesc *)
+    arena_alloc(arena, sizeof(TechniqueDesc) * (global.size + 1));
+  if (descs == NULL)
+  {
+    json_parse_error(&stream, global, error, "out of memory");
+    goto cleanup;
+  }
+
+  JSON_FOR_OBJECT(&stream, global, name_tok)
+  {
+    TechniqueDesc *desc = &descs[count];
+    memset(desc, 0, sizeof(TechniqueDesc));
+    if (!json_decode_string(&stream, name_tok, arena, &desc->name))
+    {
+      json_parse_error(&stream, name_tok, error, "invalid technique name");
+      goto cleanup;
+    }
+    json_get_position_info(&stream, name_tok, &desc->line, &desc->col);
+    /* Files hold a handful of techniques, a scan is plenty. */
+    for (size_t i = 0; i < count; i++)
+    {
+      if (string_eq(&descs[i].name, &desc->name))
+      {
+        json_parse_error(&stream, name_tok, error,
+            "duplicate technique '%.*s'", (int) desc->name.size,
+            (char *) desc->name.data);
+        goto cleanup;
+      }
+    }
+
+    if (!json_decode_object(&dec, &technique_desc_schema, desc))
+    {
+      goto cleanup;
+    }
+    if (desc->vert.data == NULL || desc->frag.data == NULL)
+    {
+      json_parse_error(&stream, name_tok, error,
+          "technique requires both a vertex and fragment shader");
+      goto cleanup;
+    }
+    count++;
+  }
+
+  *out = descs;
+  *count_out = count;
+  result = true;
+cleanup:
+  json_stream_deinit(&stream);
+  return result;
+}
+
+bool effect_file_parse(Membuf file, Arena *arena, EffectDesc **out,
+                       size_t *count_out, ParseError *error)
+{
+  JsonStream stream;
+  JsonDecoder dec;
+  JsonTok global;
+  bool result = false;
+  size_t count = 0;
+
+  *out = NULL;
+  *count_out = 0;
+  if (!parse_begin(&stream, file, &global, "effects", error))
+  {
+    goto cleanup;
+  }
+  json_decoder_init(&dec, &stream, arena, error);
+  json_schema_prepare(&effect_desc_schema);
+
+  EffectDesc *descs = (EffectDesc *)
+    arena_alloc(arena, sizeof(EffectDesc) * (global.size + 1));
+  if (descs == NULL)
+  {
+    json_parse_error(&stream, global, error, "out of memory");
+    goto cleanup;
+  }
+
+  JSON_FOR_OBJECT(&stream, global, name_tok)
+  {
+    EffectDesc *desc = &descs[count];
+    memset(desc, 0, sizeof(EffectDesc));
+    if (!json_decode_string(&stream, name_tok, arena, &desc->name))
+    {
+      json_parse_error(&stream, name_tok, error, "invalid effect name");
+      goto cleanup;
+    }
+    json_get_position_info(&stream, name_tok, &desc->line, &desc->col);
+    for (size_t i = 0; i < count; i++)
+    {
+      if (string_eq(&descs[i].name, &desc->name))
+      {
+        json_parse_error(&stream, name_tok, error,
+            "duplicate effect '%.*s'", (int) desc->name.size,
+            (char *) desc->name.data);
+        goto cleanup;
+      }
+    }
+
+    if (!json_decode_object(&dec, &effect_desc_schema, desc))
+    {
+      goto cleanup;
+    }
+    count++;
+  }
+
+  *out = descs;
+  *count_out = count;
+  result = true;
+cleanup:
+  json_stream_deinit(&stream);
+  return result;
+}
+
+uint32_t material_shader_stage(String path)
+{
+  if (has_suffix(&path, ".vert"))
+  {
+    return VK_SHADER_STAGE_VERTEX_BIT;
+  }
+  if (has_suffix(&path, ".frag"))
+  {
+    return VK_SHADER_STAGE_FRAGMENT_BIT;
+  }
+  return 0;
+}
+
+char *material_table_path(const char *source_filename)
+{
+  size_t len = strlen(source_filename);
+  size_t ext_len = strlen(MATERIAL_TABLE_EXTENSION);
+  char *path = MIUR_ARR(char, len + ext_len + 1);
+  if (path == NULL)
+  {
+    return NULL;
+  }
+  memcpy(path, source_filename, len);
+  memcpy(path + len, MATERIAL_TABLE_EXTENSION, ext_len + 1);
+  return path;
+}
+
+bool material_table_open_current(MaterialTable *table_out,
+                                 const char *source_filename)
+{
+  memset(table_out, 0, sizeof(MaterialTable));
+  char *path = material_table_path(source_filename);
+  if (path == NULL)
+  {
+    return false;
+  }
+
+  bool result = false;
+  if (!archive_map_file(&table_out->file, path, MEMBUF_MAP_WILLNEED))
+  {
+    goto cleanup;
+  }
+  if (!validate(table_out))
+  {
+    MIUR_LOG_WARN("'%s' is not a valid material table", path);
+    material_table_close(table_out);
+    goto cleanup;
+  }
+  if (!sources_current(table_out, source_filename))
+  {
+    MIUR_LOG_INFO("'%s' is out of date", path);
+    material_table_close(table_out);
+    goto cleanup;
+  }
+  result = true;
+
+cleanup:
+  MIUR_FREE(path);
+  return result;
+}
+
+void material_table_close(MaterialTable *table)
+{
+  membuf_destroy(&table->file);
+  memset(table, 0, sizeof(MaterialTable));
+}
+
+String material_table_string(const MaterialTable *table, uint32_t offset)
+{
+  return string_from_cstr(table->strings + offset);
+}
+
+const void *material_table_shader_code(const MaterialTable *table,
+                                       const MaterialTableShader *shader)
+{
+  return table->file.data + shader->code_offset;
+}
+
+bool material_table_write(const char *source_filename,
+                          const TechniqueDesc *techniques,
+                          size_t technique_count, const EffectDesc *effects,
+                          size_t effect_count,
+                          const MaterialTableShaderCode *shaders,
+                          size_t shader_count)
+{
+  MaterialTableHeader header = {
+    .magic = MATERIAL_TABLE_MAGIC,
+    .version = MATERIAL_TABLE_VERSION,
+    .shader_count = (uint32_t) shader_count,
+    .dependency_count = (uint32_t) shader_count,
+    .technique_count = (uint32_t) technique_count,
+    .effect_count = (uint32_t) effect_count,
+  };
+
+  /* Shader paths are stored twice, as dependencies and as strings. */
+  uint64_t dependencies_size = 0;
+  uint64_t strings_size = 0;
+  for (size_t i = 0; i < shader_count; i++)
+  {
+    dependencies_size += shaders[i].path.size + 1;
+  }
+  strings_size += dependencies_size;
+  for (size_t i = 0; i < technique_count; i++)
+  {
+    strings_size += techniques[i].name.size + 1;
+  }
+  for (size_t i = 0; i < effect_count; i++)
+  {
+    strings_size += effects[i].name.size + 1;
+    if (effects[i].forward.data != NULL)
+    {
+      strings_size += effects[i].forward.size + 1;
+    }
+  }
+  if (strings_size > UINT32_MAX || shader_count > UINT32_MAX ||
+      technique_count > UINT32_MAX || effect_count > UINT32_MAX)
+  {
+    return false;
+  }
+
+  header.shaders_offset = sizeof(MaterialTableHeader);
+  header.techniques_offset = header.shaders_offset +
+    shader_count * sizeof(MaterialTableShader);
+  header.effects_offset = header.techniques_offset +
+    technique_count * sizeof(MaterialTableTechnique);
+  header.dependencies_offset = header.effects_offset +
+    effect_count * sizeof(MaterialTableEffect);
+  header.dependencies_size = (uint32_t) dependencies_size;
+  header.strings_offset = header.dependencies_offset + dependencies_size;
+  uint64_t offset = align_up(header.strings_offset + strings_size);
+  for (size_t i = 0; i < shader_count; i++)
+  {
+    offset = align_up(offset + shaders[i].size);
+  }
+  header.file_size = offset;
+
+  bool result = false;
+  char *path = material_table_path(source_filename);
+  uint8_t *data = MIUR_ARR(uint8_t, header.file_size);
+  if (path == NULL || data == NULL)
+  {
+    goto cleanup;
+  }
+
+  /* Hashed in the order material_table_open_current checks them. */
+  Membuf source;
+  if (!membuf_load_file(&source, source_filename))
+  {
+    MIUR_LOG_ERR("Can't read '%s'", source_filename);
+    goto cleanup;
+  }
+  header.source_hash = hash3(source.data, source.size, 0);
+  membuf_destroy(&source);
+
+  MaterialTableShader *shader_entries = (MaterialTableShader *)
+    (data + header.shaders_offset);
+  MaterialTableTechnique *technique_entries = (MaterialTableTechnique *)
+    (data + header.techniques_offset);
+  MaterialTableEffect *effect_entries = (MaterialTableEffect *)
+    (data + header.effects_offset);
+  char *dependencies = (char *) (data + header.dependencies_offset);
+  char *strings = (char *) (data + header.strings_offset);
+  uint32_t dependency_offset = 0;
+  uint32_t string_offset = 0;
+
+  offset = align_up(header.strings_offset + strings_size);
+  for (size_t i = 0; i < shader_count; i++)
+  {
+    const MaterialTableShaderCode *shader = &shaders[i];
+    /* Hashing the GLSL rather than the SPIR-V lets a load check it. */
+    Membuf glsl;
+    char *glsl_path = dependencies + dependency_offset;
+    add_string(dependencies, &dependency_offset, &shader->path);
+    if (!membuf_load_file(&glsl, glsl_path))
+    {
+      MIUR_LOG_ERR("Can't read '%s'", glsl_path);
+      goto cleanup;
+    }
+    header.source_hash = hash3(glsl.data, glsl.size, header.source_hash);
+    membuf_destroy(&glsl);
+
+    shader_entries[i].path_offset = add_string(strings, &string_offset,
+                                               &shader->path);
+    shader_entries[i].stage = shader->stage;
+    shader_entries[i].code_offset = offset;
+    shader_entries[i].code_size = shader->size;
+    memcpy(data + offset, shader->code, shader->size);
+    offset = align_up(offset + shader->size);
+  }
+
+  for (size_t i = 0; i < technique_count; i++)
+  {
+    const TechniqueDesc *desc = &techniques[i];
+    MaterialTableTechnique *entry = &technique_entries[i];
+    entry->name_offset = add_string(strings, &string_offset, &desc->name);
+    entry->vert = find_shader(shaders, shader_count, &desc->vert);
+    entry->frag = find_shader(shaders, shader_count, &desc->frag);
+    entry->vertex_format = (uint32_t) desc->vertex_format;
+    entry->vertex_layout = (uint32_t) desc->vertex_layout;
+    if (entry->vert == MATERIAL_TABLE_NONE ||
+        entry->frag == MATERIAL_TABLE_NONE)
+    {
+      MIUR_LOG_ERR("No code for the shaders of technique '%.*s'",
+                   (int) desc->name.size, (char *) desc->name.data);
+      goto cleanup;
+    }
+  }
+
+  for (size_t i = 0; i < effect_count; i++)
+  {
+    const EffectDesc *desc = &effects[i];
+    effect_entries[i].name_offset = add_string(strings, &string_offset,
+                                               &desc->name);
+    effect_entries[i].forward_offset = desc->forward.data == NULL ?
+      MATERIAL_TABLE_NONE :
+      add_string(strings, &string_offset, &desc->forward);
+  }
+  header.strings_size = string_offset;
+  memcpy(data, &header, sizeof(MaterialTableHeader));
+
+  Membuf file = {
+    .data = data,
+    .size = header.file_size,
+  };
+  result = membuf_replace_file(file, path);
+  if (!result)
+  {
+    MIUR_LOG_ERR("Can't write '%s'", path);
+  }
+
+cleanup:
+  MIUR_FREE(data);
+  MIUR_FREE(path);
+  return result;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static bool parse_begin(JsonStream *stream, Membuf file, JsonTok *global,
+                        const char *what, ParseError *error)
+{
+  if (!json_stream_init(stream, file))
+  {
+    error->line = error->col = 0;
+    snprintf(error->msg, MAX_PARSE_ERROR_MSG_LENGTH, "malformed JSON");
+    return false;
+  }
+  if (!JSON_EXPECT_WITH(stream, JSON_OBJECT, global))
+  {
+    json_parse_error(stream, *global, error,
+                     "expected global object specifiying %s", what);
+    return false;
+  }
+  return true;
+}
+
+static bool validate(MaterialTable *table)
+{
+  const uint8_t *data = table->file.data;
+  size_t size = table->file.size;
+
+  if (size < sizeof(MaterialTableHeader))
+  {
+    return false;
+  }
+  const MaterialTableHeader *header = (const MaterialTableHeader *) data;
+  if (memcmp(header->magic, MATERIAL_TABLE_MAGIC,
+             sizeof(header->magic)) != 0 ||
+      header->version != MATERIAL_TABLE_VERSION ||
+      header->file_size != size)
+  {
+    return false;
+  }
+  if (header->shaders_offset % sizeof(uint64_t) != 0 ||
+      header->shaders_offset > size ||
+      (size - header->shaders_offset) / sizeof(MaterialTableShader) <
+      header->shader_count ||
+      header->techniques_offset % sizeof(uint32_t) != 0 ||
+      header->techniques_offset > size ||
+      (size - header->techniques_offset) / sizeof(MaterialTableTechnique) <
+      header->technique_count ||
+      header->effects_offset % sizeof(uint32_t) != 0 ||
+      header->effects_offset > size ||
+      (size - header->effects_offset) / sizeof(MaterialTableEffect) <
+      header->effect_count ||
+      !strings_in_bounds((const char *) data, header->dependencies_offset,
+                         header->dependencies_size, size) ||
+      !strings_in_bounds((const char *) data, header->strings_offset,
+                         header->strings_size, size))
+  {
+    return false;
+  }
+
+  table->header = header;
+  table->shaders = (const MaterialTableShader *)
+    (data + header->shaders_offset);
+  table->techniques = (const MaterialTableTechnique *)
+    (data + header->techniques_offset);
+  table->effects = (const MaterialTableEffect *)
+    (data + header->effects_offset);
+  table->dependencies = (const char *) (data + header->dependencies_offset);
+  table->strings = (const char *) (data + header->strings_offset);
+
+  for (uint32_t i = 0; i < header->shader_count; i++)
+  {
+    const MaterialTableShader *shader = &table->shaders[i];
+    if (shader->path_offset >= header->strings_size ||
+        shader->code_offset % sizeof(uint32_t) != 0 ||
+        shader->code_offset > size ||
+        size - shader->code_offset < shader->code_size)
+    {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < header->technique_count; i++)
+  {
+    const MaterialTableTechnique *tech = &table->techniques[i];
+    if (tech->name_offset >= header->strings_size ||
+        tech->vert >= header->shader_count ||
+        tech->frag >= header->shader_count ||
+        tech->vertex_format >= VERTEX_FORMAT_COUNT ||
+        tech->vertex_layout >= VERTEX_LAYOUT_COUNT)
+    {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < header->effect_count; i++)
+  {
+    const MaterialTableEffect *effect = &table->effects[i];
+    if (effect->name_offset >= header->strings_size ||
+        (effect->forward_offset != MATERIAL_TABLE_NONE &&
+         effect->forward_offset >= header->strings_size))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* A region of NUL terminated strings, which may be empty. */
+static bool strings_in_bounds(const char *data, uint64_t offset,
+                              uint64_t size, uint64_t file_size)
+{
+  return offset <= file_size && file_size - offset >= size &&
+    (size == 0 || data[offset + size - 1] == 0);
+}
+
+static bool sources_current(const MaterialTable *table,
+                            const char *source_filename)
+{
+  Membuf buf;
+  if (!archive_map_file(&buf, source_filename, MEMBUF_MAP_SEQUENTIAL))
+  {
+    return false;
+  }
+  uint64_t hash = hash3(buf.data, buf.size, 0);
+  membuf_destroy(&buf);
+
+  const char *dep = table->dependencies;
+  const char *end = dep + table->header->dependencies_size;
+  for (; dep < end; dep += strlen(dep) + 1)
+  {
+    if (!archive_map_file(&buf, dep, MEMBUF_MAP_SEQUENTIAL))
+    {
+      return false;
+    }
+    hash = hash3(buf.data, buf.size, hash);
+    membuf_destroy(&buf);
+  }
+  return hash == table->header->source_hash;
+}
+
+static bool has_suffix(const String *str, const char *suffix)
+{
+  size_t size = strlen(suffix);
+  return str->size >= size &&
+    memcmp(str->data + str->size - size, suffix, size) == 0;
+}
+
+static uint32_t find_shader(const MaterialTableShaderCode *shaders,
+                            size_t shader_count, const String *path)
+{
+  for (size_t i = 0; i < shader_count; i++)
+  {
+    String shader_path = shaders[i].path;
+    if (string_eq(&shader_path, (String *) path))
+    {
+      return (uint32_t) i;
+    }
+  }
+  return MATERIAL_TABLE_NONE;
+}
+
+/* Appends `str` NUL terminated, returns where it starts. */
+static uint32_t add_string(char *strings, uint32_t *size, const String *str)
+{
+  uint32_t offset = *size;
+  memcpy(strings + offset, str->data, str->size);
+  strings[offset + str->size] = '\0';
+  *size += (uint32_t) str->size + 1;
+  return offset;
+}
+
+static uint64_t align_up(uint64_t value)
+{
+  return (value + MATERIAL_TABLE_ALIGNMENT - 1) &
+    ~(uint64_t) (MATERIAL_TABLE_ALIGNMENT - 1);
+}
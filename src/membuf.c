@@ -6,53 +6,274 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
+#include <miur/config.h>
 #include <miur/log.h>
 #include <miur/mem.h>
 #include <miur/membuf.h>
 
+#ifdef MIUR_PLATFORM_WINDOWS
+#include <windows.h>
+#define file_seek _fseeki64
+#define file_tell _ftelli64
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define file_seek fseeko
+#define file_tell ftello
+#endif
+
+/* === PROTOTYPES === */
+
+static bool map_file(Membuf *membuf, const char *filename,
+                     MembufMapFlags flags);
+static void unmap_file(Membuf *membuf);
+static bool rename_over(const char *from, const char *to);
+
+/* === PUBLIC FUNCTIONS === */
+
 bool membuf_load_file(Membuf *membuf, const char *filename)
 {
+  membuf->data = NULL;
+  membuf->size = 0;
+  membuf->kind = MEMBUF_HEAP;
+
   FILE *file = fopen(filename, "rb");
   if (file == NULL)
   {
     return false;
   }
 
-  fseek(file, 0, SEEK_END);
-  membuf->size = ftell(file);
-  if (membuf->size == 0)
+  if (file_seek(file, 0, SEEK_END) != 0)
+  {
+    goto error;
+  }
+  /* ftell is only 32 bit on Windows, buffers can be larger than that. */
+  int64_t size = file_tell(file);
+  if (size < 0 || (uint64_t) size > SIZE_MAX || file_seek(file, 0, SEEK_SET))
   {
-    membuf->data = NULL;
+    goto error;
+  }
+  if (size == 0)
+  {
+    fclose(file);
     return true;
   }
 
-  fseek(file, 0, SEEK_SET);
-
-  uint8_t *data = MIUR_ARR(uint8_t, membuf->size);
+  uint8_t *data = MIUR_ARR_UNINIT(uint8_t, size);
   if (data == NULL)
   {
-    fclose(file);
-    return false;
+    goto error;
   }
 
-  fread(data, 1, membuf->size, file);
+  if (fread(data, 1, size, file) != (size_t) size)
+  {
+    MIUR_LOG_ERR("Short read on '%s'", filename);
+    MIUR_FREE(data);
+    goto error;
+  }
 
   membuf->data = data;
+  membuf->size = size;
   fclose(file);
-
   return true;
+
+error:
+  fclose(file);
+  return false;
+}
+
+bool membuf_map_file(Membuf *membuf, const char *filename,
+                     MembufMapFlags flags)
+{
+  membuf->data = NULL;
+  membuf->size = 0;
+  membuf->kind = MEMBUF_HEAP;
+
+  return map_file(membuf, filename, flags);
 }
 
 bool membuf_write_file(Membuf membuf, const char *filename)
 {
   FILE *file = fopen(filename, "wb");
-  fwrite(membuf.data, 1, membuf.size, file);
-  fclose(file);
-  return true;
+  if (file == NULL)
+  {
+    return false;
+  }
+  bool written = fwrite(membuf.data, 1, membuf.size, file) == membuf.size;
+  /* A full disk may only show when the buffered tail is flushed. */
+  return fclose(file) == 0 && written;
+}
+
+bool membuf_replace_file(Membuf membuf, const char *filename)
+{
+  size_t filename_len = strlen(filename);
+  char *temp_name = MIUR_ARR(char, filename_len + 5);
+  if (temp_name == NULL)
+  {
+    return false;
+  }
+  memcpy(temp_name, filename, filename_len);
+  memcpy(temp_name + filename_len, ".tmp", 5);
+
+  bool result = membuf_write_file(membuf, temp_name) &&
+    rename_over(temp_name, filename);
+  if (!result)
+  {
+    remove(temp_name);
+  }
+  MIUR_FREE(temp_name);
+  return result;
 }
 
 void membuf_destroy(Membuf *membuf)
 {
-  MIUR_FREE((uint8_t *)membuf->data);
+  switch (membuf->kind)
+  {
+  case MEMBUF_HEAP:
+    MIUR_FREE((uint8_t *)membuf->data);
+    break;
+  case MEMBUF_MAPPED:
+    unmap_file(membuf);
+    break;
+  case MEMBUF_VIEW:
+    break;
+  }
+  membuf->data = NULL;
+  membuf->size = 0;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+#ifdef MIUR_PLATFORM_WINDOWS
+
+static bool map_file(Membuf *membuf, const char *filename,
+                     MembufMapFlags flags)
+{
+  DWORD attributes = FILE_ATTRIBUTE_NORMAL;
+  if (flags & MEMBUF_MAP_SEQUENTIAL)
+  {
+    attributes |= FILE_FLAG_SEQUENTIAL_SCAN;
+  }
+
+  HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, attributes, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || (uint64_t) size.QuadPart > SIZE_MAX)
+  {
+    CloseHandle(file);
+    return false;
+  }
+  /* Empty files can't be mapped, they are an empty heap buffer instead. */
+  if (size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return true;
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if (mapping == NULL)
+  {
+    return false;
+  }
+
+  /* The view keeps the mapping object alive until it is unmapped. */
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (view == NULL)
+  {
+    return false;
+  }
+
+  if (flags & MEMBUF_MAP_WILLNEED)
+  {
+    WIN32_MEMORY_RANGE_ENTRY range = {
+      .VirtualAddress = view,
+      .NumberOfBytes = (SIZE_T) size.QuadPart,
+    };
+    /* Only a hint, failure just means pages fault in on first touch. */
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+  }
+
+  membuf->data = view;
+  membuf->size = (size_t) size.QuadPart;
+  membuf->kind = MEMBUF_MAPPED;
+  return true;
+}
+
+static void unmap_file(Membuf *membuf)
+{
+  UnmapViewOfFile(membuf->data);
+}
+
+#else
+
+static bool map_file(Membuf *membuf, const char *filename,
+                     MembufMapFlags flags)
+{
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (uint64_t) st.st_size > SIZE_MAX)
+  {
+    close(fd);
+    return false;
+  }
+  /* Empty files can't be mapped, they are an empty heap buffer instead. */
+  if (st.st_size == 0)
+  {
+    close(fd);
+    return true;
+  }
+
+  void *view = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (view == MAP_FAILED)
+  {
+    return false;
+  }
+
+  /* Only hints, failure just means the default readahead. */
+  if (flags & MEMBUF_MAP_SEQUENTIAL)
+  {
+    madvise(view, st.st_size, MADV_SEQUENTIAL);
+  }
+  if (flags & MEMBUF_MAP_WILLNEED)
+  {
+    madvise(view, st.st_size, MADV_WILLNEED);
+  }
+
+  membuf->data = view;
+  membuf->size = st.st_size;
+  membuf->kind = MEMBUF_MAPPED;
+  return true;
+}
+
+static void unmap_file(Membuf *membuf)
+{
+  munmap((void *) membuf->data, membuf->size);
+}
+
+#endif
+
+static bool rename_over(const char *from, const char *to)
+{
+#ifdef MIUR_PLATFORM_WINDOWS
+  return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  return rename(from, to) == 0;
+#endif
 }
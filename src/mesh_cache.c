@@ -0,0 +1,701 @@
+/* =====================
+ * src/mesh_cache.c
+ * 10/18/2026
+ * Cooked mesh cache files.
+ * ====================
+ */
+
+#include <inttypes.h>
+#include <string.h>
+
+#include <miur/archive.h>
+#include <miur/mesh_cache.h>
+#include <miur/mesh_codec.h>
+#include <miur/mesh_opt.h>
+#include <miur/log.h>
+#include <miur/mem.h>
+
+/* Encoded streams per mesh, in file order. */
+typedef enum
+{
+  STREAM_POSITION,
+  STREAM_NORMAL,
+  STREAM_UV,
+  STREAM_INDEX,
+  STREAM_COUNT,
+} MeshCacheStream;
+
+/* === PROTOTYPES === */
+
+static bool validate(MeshCache *cache);
+static bool stream_in_bounds(const MeshCache *cache, uint64_t offset,
+                             uint64_t size);
+static uint64_t align_up(uint64_t value);
+static uint8_t *encode_vertices(const float *src, uint32_t count,
+                                uint32_t components, uint64_t *size);
+static uint8_t *encode_indices(const uint32_t *src, uint32_t count,
+                               uint64_t *size);
+static uint64_t decoded_size(const MeshCacheEntry *entry);
+static void encode_sampler(MeshCacheTexture *out, const ModelTexture *texture);
+static void decode_sampler(ModelTexture *out, const MeshCacheTexture *entry);
+static bool validate_image(const MeshCache *cache,
+                           const MeshCacheImage *image);
+
+/* === PUBLIC FUNCTIONS === */
+
+bool mesh_cache_open(MeshCache *cache_out, const char *filename)
+{
+  memset(cache_out, 0, sizeof(MeshCache));
+  if (!archive_map_file(&cache_out->file, filename, MEMBUF_MAP_WILLNEED))
+  {
+    return false;
+  }
+
+  if (!validate(cache_out))
+  {
+    MIUR_LOG_WARN("'%s' is not a valid mesh cache", filename);
+    mesh_cache_close(cache_out);
+    return false;
+  }
+  return true;
+}
+
+void mesh_cache_close(MeshCache *cache)
+{
+  membuf_destroy(&cache->file);
+  memset(cache, 0, sizeof(MeshCache));
+}
+
+const char *mesh_cache_next_dependency(const MeshCache *cache,
+                                       const char *prev)
+{
+  const char *end = cache->dependencies + cache->header->dependencies_size;
+  const char *next = prev == NULL ? cache->dependencies :
+    prev + strlen(prev) + 1;
+  return next < end ? next : NULL;
+}
+
+bool mesh_cache_to_model(MeshCache *cache, StaticModel *out)
+{
+  bool result = false;
+  const uint8_t *data = cache->file.data;
+  const MeshCacheHeader *header = cache->header;
+  uint32_t mesh_count = header->mesh_count;
+  uint64_t parents_size = (uint64_t) header->node_count * sizeof(int32_t);
+  uint64_t locals_size = (uint64_t) header->node_count * 16 * sizeof(float);
+  uint64_t instances_size = (uint64_t) header->instance_count *
+    sizeof(MeshInstance);
+  uint64_t textures_size = (uint64_t) header->texture_count *
+    sizeof(ModelTexture);
+  uint64_t size = align_up(parents_size) + align_up(locals_size) +
+    align_up(instances_size) + align_up(textures_size);
+  for (uint32_t i = 0; i < mesh_count; i++)
+  {
+    size += decoded_size(&cache->meshes[i]);
+  }
+  const MeshCacheImage *images =
+    (const MeshCacheImage *) (data + header->images_offset);
+  for (uint32_t i = 0; i < header->image_count; i++)
+  {
+    size += align_up(images[i].size);
+  }
+
+  out->meshes = MIUR_ARR(StaticMesh, mesh_count > 0 ? mesh_count : 1);
+  out->images = MIUR_ARR(Texture, header->image_count + 1);
+  uint8_t *storage = size <= SIZE_MAX ?
+    MIUR_ARR_UNINIT(uint8_t, size > 0 ? (size_t) size : 1) : NULL;
+  if (out->meshes == NULL || out->images == NULL || storage == NULL)
+  {
+    goto cleanup;
+  }
+
+  uint8_t *op = storage;
+  out->node_parents = (int32_t *) op;
+  memcpy(op, data + header->parents_offset, (size_t) parents_size);
+  op += align_up(parents_size);
+  out->node_local = (float *) op;
+  memcpy(op, data + header->locals_offset, (size_t) locals_size);
+  op += align_up(locals_size);
+  out->instances = (MeshInstance *) op;
+  memcpy(op, data + header->instances_offset, (size_t) instances_size);
+  op += align_up(instances_size);
+  out->textures = (ModelTexture *) op;
+  const MeshCacheTexture *textures =
+    (const MeshCacheTexture *) (data + header->textures_offset);
+  for (uint32_t i = 0; i < header->texture_count; i++)
+  {
+    decode_sampler(&out->textures[i], &textures[i]);
+  }
+  op += align_up(textures_size);
+
+  for (uint32_t i = 0; i < mesh_count; i++)
+  {
+    const MeshCacheEntry *entry = &cache->meshes[i];
+    StaticMesh *mesh = &out->meshes[i];
+    size_t vec3_size = (size_t) entry->vert_count * 3 * sizeof(float);
+    size_t index_total = (size_t) entry->index_count +
+      entry->lod_index_count;
+    mesh->vert_count = entry->vert_count;
+    mesh->index_count = entry->index_count;
+
+    mesh->verts_pos = (float *) op;
+    op += align_up(vec3_size);
+    mesh->verts_norm = (float *) op;
+    op += align_up(vec3_size);
+    if (!mesh_vertex_decode(data + entry->pos_offset, entry->pos_size,
+                            mesh->verts_pos, entry->vert_count,
+                            3 * sizeof(float)) ||
+        !mesh_vertex_decode(data + entry->norm_offset, entry->norm_size,
+                            mesh->verts_norm, entry->vert_count,
+                            3 * sizeof(float)))
+    {
+      goto cleanup;
+    }
+    if (entry->flags & MESH_CACHE_HAS_UV)
+    {
+      mesh->verts_uv = (float *) op;
+      op += align_up((uint64_t) entry->vert_count * 2 * sizeof(float));
+      if (!mesh_vertex_decode(data + entry->uv_offset, entry->uv_size,
+                              mesh->verts_uv, entry->vert_count,
+                              2 * sizeof(float)))
+      {
+        goto cleanup;
+      }
+    }
+
+    mesh->indices = (uint32_t *) op;
+    op += align_up(index_total * sizeof(uint32_t));
+    if (!mesh_index_decode(data + entry->index_offset, entry->index_size,
+                           mesh->indices, index_total, entry->vert_count))
+    {
+      goto cleanup;
+    }
+    mesh->bounds = entry->bounds;
+    mesh->sphere = entry->sphere;
+    mesh->lod_count = entry->lod_count;
+    memcpy(mesh->lods, entry->lods, sizeof(MeshLod) * entry->lod_count);
+
+    if (entry->meshlet_count > 0)
+    {
+      size_t meshlet_size = meshlet_buffer_size(entry->meshlet_count,
+                                                entry->meshlet_vertex_count,
+                                                entry->meshlet_triangle_size);
+      memcpy(op, data + entry->meshlet_offset, meshlet_size);
+      meshlet_buffer_bind(&mesh->meshlets, op, entry->meshlet_count,
+                          entry->meshlet_vertex_count,
+                          entry->meshlet_triangle_size);
+      op += align_up(meshlet_size);
+    }
+  }
+
+  for (uint32_t i = 0; i < header->image_count; i++)
+  {
+    const MeshCacheImage *image = &images[i];
+    Texture *texture = &out->images[i];
+    if (image->width == 0)
+    {
+      continue;
+    }
+    texture_layout(texture, (TextureFormat) image->format, image->width,
+                   image->height);
+    texture_truncate_mips(texture, image->mip_count);
+    texture->data = op;
+    memcpy(op, data + image->offset, (size_t) image->size);
+    op += align_up(image->size);
+  }
+
+  out->mesh_count = mesh_count;
+  out->node_count = header->node_count;
+  out->instance_count = header->instance_count;
+  out->image_count = header->image_count;
+  out->texture_count = header->texture_count;
+  out->storage = (Membuf) {
+    .data = storage,
+    .size = (size_t) size,
+    .kind = MEMBUF_HEAP,
+  };
+  storage = NULL;
+  result = true;
+
+cleanup:
+  if (!result)
+  {
+    MIUR_FREE(out->meshes);
+    MIUR_FREE(out->images);
+    memset(out, 0, sizeof(StaticModel));
+  }
+  MIUR_FREE(storage);
+  mesh_cache_close(cache);
+  return result;
+}
+
+bool mesh_cache_write(const char *filename, const StaticModel *model,
+                      uint64_t source_hash, const char *const *dependencies,
+                      size_t dependency_count)
+{
+  MeshCacheHeader header = {
+    .magic = MESH_CACHE_MAGIC,
+    .version = MESH_CACHE_VERSION,
+    .mesh_count = model->mesh_count,
+    .source_hash = source_hash,
+    .dependency_count = (uint32_t) dependency_count,
+    .node_count = model->node_count,
+    .instance_count = model->instance_count,
+    .image_count = model->image_count,
+    .texture_count = model->texture_count,
+  };
+
+  uint64_t dependencies_size = 0;
+  for (size_t i = 0; i < dependency_count; i++)
+  {
+    dependencies_size += strlen(dependencies[i]) + 1;
+  }
+  if (dependencies_size > UINT32_MAX)
+  {
+    return false;
+  }
+  header.dependencies_size = (uint32_t) dependencies_size;
+  header.meshes_offset = sizeof(MeshCacheHeader);
+  header.dependencies_offset = header.meshes_offset +
+    sizeof(MeshCacheEntry) * model->mesh_count;
+
+  bool result = false;
+  uint8_t *data = NULL;
+  size_t stream_count = (size_t) model->mesh_count * STREAM_COUNT;
+  uint8_t **streams = MIUR_ARR(uint8_t *,
+                               stream_count > 0 ? stream_count : 1);
+  MeshCacheEntry *entries = MIUR_ARR(MeshCacheEntry,
+                                     model->mesh_count > 0 ?
+                                     model->mesh_count : 1);
+  MeshCacheImage *images = MIUR_ARR(MeshCacheImage, model->image_count + 1);
+  if (streams == NULL || entries == NULL || images == NULL)
+  {
+    goto cleanup;
+  }
+
+  uint64_t raw_size = 0;
+  uint64_t encoded_size = 0;
+  uint64_t offset = align_up(header.dependencies_offset + dependencies_size);
+  header.parents_offset = offset;
+  offset = align_up(offset + (uint64_t) model->node_count * sizeof(int32_t));
+  header.locals_offset = offset;
+  offset = align_up(offset + (uint64_t) model->node_count * 16 *
+                    sizeof(float));
+  header.instances_offset = offset;
+  offset = align_up(offset + (uint64_t) model->instance_count *
+                    sizeof(MeshInstance));
+  header.images_offset = offset;
+  offset = align_up(offset + (uint64_t) model->image_count *
+                    sizeof(MeshCacheImage));
+  header.textures_offset = offset;
+  offset = align_up(offset + (uint64_t) model->texture_count *
+                    sizeof(MeshCacheTexture));
+  for (uint32_t i = 0; i < model->mesh_count; i++)
+  {
+    const StaticMesh *mesh = &model->meshes[i];
+    MeshCacheEntry *entry = &entries[i];
+    uint8_t **encoded = &streams[i * STREAM_COUNT];
+    uint32_t index_total = static_mesh_index_total(mesh);
+
+    entry->vert_count = mesh->vert_count;
+    entry->index_count = mesh->index_count;
+    encoded[STREAM_POSITION] = encode_vertices(mesh->verts_pos,
+                                               mesh->vert_count, 3,
+                                               &entry->pos_size);
+    encoded[STREAM_NORMAL] = encode_vertices(mesh->verts_norm,
+                                             mesh->vert_count, 3,
+                                             &entry->norm_size);
+    encoded[STREAM_INDEX] = encode_indices(mesh->indices, index_total,
+                                           &entry->index_size);
+    if (encoded[STREAM_POSITION] == NULL || encoded[STREAM_NORMAL] == NULL ||
+        encoded[STREAM_INDEX] == NULL)
+    {
+      goto cleanup;
+    }
+    raw_size += (uint64_t) mesh->vert_count * 6 * sizeof(float) +
+      (uint64_t) index_total * sizeof(uint32_t);
+
+    entry->pos_offset = offset;
+    offset = align_up(offset + entry->pos_size);
+    entry->norm_offset = offset;
+    offset = align_up(offset + entry->norm_size);
+    if (mesh->verts_uv != NULL)
+    {
+      encoded[STREAM_UV] = encode_vertices(mesh->verts_uv, mesh->vert_count,
+                                           2, &entry->uv_size);
+      if (encoded[STREAM_UV] == NULL)
+      {
+        goto cleanup;
+      }
+      raw_size += (uint64_t) mesh->vert_count * 2 * sizeof(float);
+      entry->flags |= MESH_CACHE_HAS_UV;
+      entry->uv_offset = offset;
+      offset = align_up(offset + entry->uv_size);
+    }
+    entry->lod_count = mesh->lod_count;
+    entry->lod_index_count = index_total - mesh->index_count;
+    memcpy(entry->lods, mesh->lods, sizeof(MeshLod) * mesh->lod_count);
+    entry->index_offset = offset;
+    offset = align_up(offset + entry->index_size);
+    encoded_size += entry->pos_size + entry->norm_size + entry->uv_size +
+      entry->index_size;
+    if (mesh->meshlets.meshlet_count > 0)
+    {
+      entry->meshlet_count = mesh->meshlets.meshlet_count;
+      entry->meshlet_vertex_count = mesh->meshlets.vertex_count;
+      entry->meshlet_triangle_size = mesh->meshlets.triangle_size;
+      entry->meshlet_offset = offset;
+      offset = align_up(offset + mesh->meshlets.size);
+    }
+    entry->bounds = mesh->bounds;
+    entry->sphere = mesh->sphere;
+  }
+  for (uint32_t i = 0; i < model->image_count; i++)
+  {
+    const Texture *texture = &model->images[i];
+    if (texture->data == NULL)
+    {
+      continue;
+    }
+    images[i] = (MeshCacheImage) {
+      .format = texture->format,
+      .width = texture->width,
+      .height = texture->height,
+      .mip_count = texture->mip_count,
+      .offset = offset,
+      .size = texture->size,
+    };
+    offset = align_up(offset + texture->size);
+  }
+  header.file_size = offset;
+
+  /* Cooked models are small next to what they save, build it in memory. */
+  data = MIUR_ARR(uint8_t, (size_t) offset);
+  if (data == NULL)
+  {
+    goto cleanup;
+  }
+
+  memcpy(data, &header, sizeof(header));
+  memcpy(data + header.meshes_offset, entries,
+         sizeof(MeshCacheEntry) * model->mesh_count);
+  char *names = (char *) data + header.dependencies_offset;
+  for (size_t i = 0; i < dependency_count; i++)
+  {
+    size_t size = strlen(dependencies[i]) + 1;
+    memcpy(names, dependencies[i], size);
+    names += size;
+  }
+  memcpy(data + header.parents_offset, model->node_parents,
+         (size_t) model->node_count * sizeof(int32_t));
+  memcpy(data + header.locals_offset, model->node_local,
+         (size_t) model->node_count * 16 * sizeof(float));
+  memcpy(data + header.instances_offset, model->instances,
+         (size_t) model->instance_count * sizeof(MeshInstance));
+  memcpy(data + header.images_offset, images,
+         (size_t) model->image_count * sizeof(MeshCacheImage));
+  MeshCacheTexture *textures =
+    (MeshCacheTexture *) (data + header.textures_offset);
+  for (uint32_t i = 0; i < model->texture_count; i++)
+  {
+    encode_sampler(&textures[i], &model->textures[i]);
+  }
+  for (uint32_t i = 0; i < model->mesh_count; i++)
+  {
+    const StaticMesh *mesh = &model->meshes[i];
+    const MeshCacheEntry *entry = &entries[i];
+    uint8_t *const *encoded = &streams[i * STREAM_COUNT];
+    memcpy(data + entry->pos_offset, encoded[STREAM_POSITION],
+           (size_t) entry->pos_size);
+    memcpy(data + entry->norm_offset, encoded[STREAM_NORMAL],
+           (size_t) entry->norm_size);
+    if (mesh->verts_uv != NULL)
+    {
+      memcpy(data + entry->uv_offset, encoded[STREAM_UV],
+             (size_t) entry->uv_size);
+    }
+    memcpy(data + entry->index_offset, encoded[STREAM_INDEX],
+           (size_t) entry->index_size);
+    if (entry->meshlet_count > 0)
+    {
+      memcpy(data + entry->meshlet_offset, mesh->meshlets.data,
+             mesh->meshlets.size);
+    }
+  }
+  for (uint32_t i = 0; i < model->image_count; i++)
+  {
+    if (images[i].width > 0)
+    {
+      memcpy(data + images[i].offset, model->images[i].data,
+             (size_t) images[i].size);
+    }
+  }
+
+  MIUR_LOG_INFO("'%s': %" PRIu64 " bytes of streams encoded to %" PRIu64,
+                filename, raw_size, encoded_size);
+  Membuf file = {
+    .data = data,
+    .size = (size_t) offset,
+    .kind = MEMBUF_HEAP,
+  };
+  result = membuf_replace_file(file, filename);
+
+cleanup:
+  for (size_t i = 0; streams != NULL && i < stream_count; i++)
+  {
+    MIUR_FREE(streams[i]);
+  }
+  MIUR_FREE(streams);
+  MIUR_FREE(entries);
+  MIUR_FREE(images);
+  MIUR_FREE(data);
+  return result;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/* Everything used later is checked here, a truncated write fails cleanly. */
+static bool validate(MeshCache *cache)
+{
+  const uint8_t *data = cache->file.data;
+  size_t size = cache->file.size;
+
+  if (size < sizeof(MeshCacheHeader))
+  {
+    return false;
+  }
+  const MeshCacheHeader *header = (const MeshCacheHeader *) data;
+  if (memcmp(header->magic, MESH_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != MESH_CACHE_VERSION || header->file_size != size)
+  {
+    return false;
+  }
+  cache->header = header;
+
+  uint64_t meshes_size = (uint64_t) header->mesh_count *
+    sizeof(MeshCacheEntry);
+  if (header->meshes_offset % sizeof(uint64_t) != 0 ||
+      !stream_in_bounds(cache, header->meshes_offset, meshes_size) ||
+      !stream_in_bounds(cache, header->dependencies_offset,
+                        header->dependencies_size))
+  {
+    return false;
+  }
+  if (!stream_in_bounds(cache, header->parents_offset,
+                        (uint64_t) header->node_count * sizeof(int32_t)) ||
+      !stream_in_bounds(cache, header->locals_offset,
+                        (uint64_t) header->node_count * 16 * sizeof(float)) ||
+      !stream_in_bounds(cache, header->instances_offset,
+                        (uint64_t) header->instance_count *
+                        sizeof(MeshInstance)) ||
+      !stream_in_bounds(cache, header->images_offset,
+                        (uint64_t) header->image_count *
+                        sizeof(MeshCacheImage)) ||
+      !stream_in_bounds(cache, header->textures_offset,
+                        (uint64_t) header->texture_count *
+                        sizeof(MeshCacheTexture)))
+  {
+    return false;
+  }
+
+  /* Parents come first, transform_compute_world relies on it. */
+  const int32_t *parents = (const int32_t *) (data + header->parents_offset);
+  for (uint32_t i = 0; i < header->node_count; i++)
+  {
+    if (parents[i] < -1 || parents[i] >= (int64_t) i)
+    {
+      return false;
+    }
+  }
+  const MeshInstance *instances =
+    (const MeshInstance *) (data + header->instances_offset);
+  for (uint32_t i = 0; i < header->instance_count; i++)
+  {
+    if (instances[i].mesh >= header->mesh_count ||
+        instances[i].node >= header->node_count)
+    {
+      return false;
+    }
+  }
+  const MeshCacheImage *images =
+    (const MeshCacheImage *) (data + header->images_offset);
+  for (uint32_t i = 0; i < header->image_count; i++)
+  {
+    if (!validate_image(cache, &images[i]))
+    {
+      return false;
+    }
+  }
+  const MeshCacheTexture *textures =
+    (const MeshCacheTexture *) (data + header->textures_offset);
+  for (uint32_t i = 0; i < header->texture_count; i++)
+  {
+    if (textures[i].image >= header->image_count ||
+        textures[i].wrap_u > TEXTURE_WRAP_CLAMP_TO_EDGE ||
+        textures[i].wrap_v > TEXTURE_WRAP_CLAMP_TO_EDGE)
+    {
+      return false;
+    }
+  }
+  cache->meshes = (const MeshCacheEntry *) (data + header->meshes_offset);
+  cache->dependencies = (const char *) data + header->dependencies_offset;
+
+  /* Dependencies are NUL terminated, including the last one. */
+  uint32_t names = 0;
+  for (uint32_t i = 0; i < header->dependencies_size; i++)
+  {
+    names += cache->dependencies[i] == '\0';
+  }
+  if (names != header->dependency_count ||
+      (header->dependencies_size > 0 &&
+       cache->dependencies[header->dependencies_size - 1] != '\0'))
+  {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < header->mesh_count; i++)
+  {
+    const MeshCacheEntry *entry = &cache->meshes[i];
+    if (!stream_in_bounds(cache, entry->pos_offset, entry->pos_size) ||
+        !stream_in_bounds(cache, entry->norm_offset, entry->norm_size) ||
+        !stream_in_bounds(cache, entry->index_offset, entry->index_size) ||
+        entry->lod_count > MESH_MAX_LODS)
+    {
+      return false;
+    }
+    uint64_t index_total = (uint64_t) entry->index_count +
+      entry->lod_index_count;
+    for (uint32_t l = 0; l < entry->lod_count; l++)
+    {
+      const MeshLod *lod = &entry->lods[l];
+      if ((uint64_t) lod->first_index + lod->index_count > index_total)
+      {
+        return false;
+      }
+    }
+    if ((entry->flags & MESH_CACHE_HAS_UV) &&
+        !stream_in_bounds(cache, entry->uv_offset, entry->uv_size))
+    {
+      return false;
+    }
+    if (entry->meshlet_count > 0 &&
+        !stream_in_bounds(cache, entry->meshlet_offset,
+                          meshlet_buffer_size(entry->meshlet_count,
+                                              entry->meshlet_vertex_count,
+                                              entry->meshlet_triangle_size)))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool stream_in_bounds(const MeshCache *cache, uint64_t offset,
+                             uint64_t size)
+{
+  return offset % sizeof(float) == 0 && offset <= cache->file.size &&
+    size <= cache->file.size - offset;
+}
+
+static uint64_t align_up(uint64_t value)
+{
+  return (value + MESH_CACHE_ALIGNMENT - 1) &
+    ~(uint64_t) (MESH_CACHE_ALIGNMENT - 1);
+}
+
+/* Returns the encoded stream, or NULL if out of memory. */
+static uint8_t *encode_vertices(const float *src, uint32_t count,
+                                uint32_t components, uint64_t *size)
+{
+  size_t stride = components * sizeof(float);
+  size_t capacity = mesh_vertex_encode_bound(count, stride);
+  uint8_t *dst = MIUR_ARR_UNINIT(uint8_t, capacity);
+  if (dst != NULL)
+  {
+    *size = mesh_vertex_encode(src, count, stride, dst, capacity);
+  }
+  return dst;
+}
+
+static uint8_t *encode_indices(const uint32_t *src, uint32_t count,
+                               uint64_t *size)
+{
+  size_t capacity = mesh_index_encode_bound(count);
+  uint8_t *dst = MIUR_ARR_UNINIT(uint8_t, capacity);
+  if (dst != NULL)
+  {
+    *size = mesh_index_encode(src, count, dst, capacity);
+  }
+  return dst;
+}
+
+/* Bytes the streams of `entry` take decoded, each aligned as on disk. */
+static uint64_t decoded_size(const MeshCacheEntry *entry)
+{
+  uint64_t vec3_size = (uint64_t) entry->vert_count * 3 * sizeof(float);
+  uint64_t size = align_up(vec3_size) * 2 +
+    align_up(((uint64_t) entry->index_count + entry->lod_index_count) *
+             sizeof(uint32_t));
+  if (entry->flags & MESH_CACHE_HAS_UV)
+  {
+    size += align_up((uint64_t) entry->vert_count * 2 * sizeof(float));
+  }
+  if (entry->meshlet_count > 0)
+  {
+    size += align_up(meshlet_buffer_size(entry->meshlet_count,
+                                         entry->meshlet_vertex_count,
+                                         entry->meshlet_triangle_size));
+  }
+  return size;
+}
+
+static void encode_sampler(MeshCacheTexture *out, const ModelTexture *texture)
+{
+  const TextureSampler *sampler = &texture->sampler;
+  out->image = texture->image;
+  out->sampler_flags =
+    (sampler->mag_linear ? MESH_CACHE_SAMPLER_MAG_LINEAR : 0) |
+    (sampler->min_linear ? MESH_CACHE_SAMPLER_MIN_LINEAR : 0) |
+    (sampler->mip_linear ? MESH_CACHE_SAMPLER_MIP_LINEAR : 0) |
+    (sampler->mipmapped ? MESH_CACHE_SAMPLER_MIPMAPPED : 0);
+  out->wrap_u = sampler->wrap_u;
+  out->wrap_v = sampler->wrap_v;
+}
+
+static void decode_sampler(ModelTexture *out, const MeshCacheTexture *entry)
+{
+  uint32_t flags = entry->sampler_flags;
+  out->image = entry->image;
+  out->sampler = (TextureSampler) {
+    .mag_linear = (flags & MESH_CACHE_SAMPLER_MAG_LINEAR) != 0,
+    .min_linear = (flags & MESH_CACHE_SAMPLER_MIN_LINEAR) != 0,
+    .mip_linear = (flags & MESH_CACHE_SAMPLER_MIP_LINEAR) != 0,
+    .mipmapped = (flags & MESH_CACHE_SAMPLER_MIPMAPPED) != 0,
+    .wrap_u = (TextureWrap) entry->wrap_u,
+    .wrap_v = (TextureWrap) entry->wrap_v,
+  };
+}
+
+/*
+ * The stored mips must be exactly what texture_layout gives the image, a
+ * KTX2 source may have fewer than the whole chain.
+ */
+static bool validate_image(const MeshCache *cache,
+                           const MeshCacheImage *image)
+{
+  Texture layout;
+  if (image->width == 0)
+  {
+    return true;
+  }
+  if (image->format >= TEXTURE_FORMAT_COUNT ||
+      !texture_layout(&layout, (TextureFormat) image->format, image->width,
+                      image->height) ||
+      image->mip_count == 0 || image->mip_count > layout.mip_count)
+  {
+    return false;
+  }
+  texture_truncate_mips(&layout, image->mip_count);
+  return layout.size == image->size &&
+    stream_in_bounds(cache, image->offset, image->size);
+}
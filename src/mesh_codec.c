@@ -0,0 +1,591 @@
+/* =====================
+ * src/mesh_codec.c
+ * 10/18/2026
+ * Index and vertex compression for cooked meshes.
+ * ====================
+ */
+
+#include <string.h>
+
+#include <miur/mesh_codec.h>
+#include <miur/mem.h>
+#include <miur/simd.h>
+
+#define INDEX_CODEC_HEADER 0xe1
+#define VERTEX_CODEC_HEADER 0xa1
+#define FIFO_SIZE 16
+/* Code nibbles, see mesh_codec.h. */
+#define CODE_NO_EDGE 15
+#define CODE_NEXT 0
+#define CODE_EXPLICIT 15
+#define MAX_VARINT_SIZE 5
+#define VERTEX_BLOCK_SIZE 256
+#define VERTEX_GROUP_SIZE 16
+#define VERTEX_MAX_STRIDE 256
+#define VERTEX_GROUPS_PER_HEADER 4
+
+typedef struct
+{
+  uint32_t edges[FIFO_SIZE][2];
+  uint32_t vertices[FIFO_SIZE];
+  uint32_t edge_offset;
+  uint32_t vertex_offset;
+  uint32_t next;      /* Lowest vertex not coded as next yet. */
+  uint32_t last;      /* Last explicitly coded vertex. */
+} IndexFifo;
+
+/* Bytes of packed data for each group width. */
+static const uint8_t group_sizes[4] = { 0, 4, 8, 16 };
+
+/* === PROTOTYPES === */
+
+static void push_edge(IndexFifo *fifo, uint32_t a, uint32_t b);
+static void push_vertex(IndexFifo *fifo, uint32_t v);
+static int find_edge(const IndexFifo *fifo, uint32_t a, uint32_t b);
+static int find_vertex(const IndexFifo *fifo, uint32_t v);
+static uint32_t encode_vertex(IndexFifo *fifo, uint32_t v, uint8_t **data);
+static bool decode_vertex(IndexFifo *fifo, uint32_t code, const uint8_t **data,
+                          const uint8_t *end, uint32_t *v);
+static bool read_varint(const uint8_t **data, const uint8_t *end,
+                        uint32_t *value);
+static uint8_t *encode_stream(uint8_t *op, const uint8_t *deltas,
+                              size_t count);
+static const uint8_t *decode_stream(const uint8_t *ip, const uint8_t *end,
+                                    uint8_t *out, size_t count, uint8_t prev);
+static void transpose_block(uint8_t *dst, const uint8_t *block, size_t count,
+                            size_t stride);
+
+/* === PUBLIC FUNCTIONS === */
+
+size_t mesh_index_encode_bound(size_t index_count)
+{
+  /* A code byte, the extra byte and three varints per triangle. */
+  return 1 + index_count / 3 * (2 + 3 * MAX_VARINT_SIZE);
+}
+
+size_t mesh_index_encode(const uint32_t *indices, size_t index_count,
+                         uint8_t *dst, size_t capacity)
+{
+  if (index_count % 3 != 0 || capacity < mesh_index_encode_bound(index_count))
+  {
+    return 0;
+  }
+
+  size_t tri_count = index_count / 3;
+  IndexFifo fifo;
+  memset(&fifo, 0, sizeof(fifo));
+  dst[0] = INDEX_CODEC_HEADER;
+  uint8_t *codes = dst + 1;
+  uint8_t *data = codes + tri_count;
+
+  for (size_t t = 0; t < tri_count; t++)
+  {
+    const uint32_t *tri = &indices[t * 3];
+    int edge = -1;
+    int rotation = 0;
+    for (; rotation < 3; rotation++)
+    {
+      edge = find_edge(&fifo, tri[rotation], tri[(rotation + 1) % 3]);
+      if (edge >= 0)
+      {
+        break;
+      }
+    }
+
+    if (edge >= 0)
+    {
+      uint32_t a = tri[rotation];
+      uint32_t b = tri[(rotation + 1) % 3];
+      uint32_t c = tri[(rotation + 2) % 3];
+      codes[t] = (uint8_t) (edge << 4 | encode_vertex(&fifo, c, &data));
+      push_edge(&fifo, c, b);
+      push_edge(&fifo, a, c);
+    } else
+    {
+      /* The extra byte goes ahead of any of the three's varints. */
+      uint8_t *extra = data++;
+      uint32_t code_a = encode_vertex(&fifo, tri[0], &data);
+      uint32_t code_b = encode_vertex(&fifo, tri[1], &data);
+      uint32_t code_c = encode_vertex(&fifo, tri[2], &data);
+      codes[t] = (uint8_t) (CODE_NO_EDGE << 4 | code_a);
+      *extra = (uint8_t) (code_b << 4 | code_c);
+      push_edge(&fifo, tri[1], tri[0]);
+      push_edge(&fifo, tri[2], tri[1]);
+      push_edge(&fifo, tri[0], tri[2]);
+    }
+  }
+  return (size_t) (data - dst);
+}
+
+bool mesh_index_decode(const uint8_t *src, size_t size, uint32_t *dst,
+                       size_t index_count, size_t vertex_count)
+{
+  size_t tri_count = index_count / 3;
+  if (index_count % 3 != 0 || size < 1 + tri_count ||
+      src[0] != INDEX_CODEC_HEADER)
+  {
+    return false;
+  }
+
+  IndexFifo fifo;
+  memset(&fifo, 0, sizeof(fifo));
+  const uint8_t *codes = src + 1;
+  const uint8_t *data = codes + tri_count;
+  const uint8_t *end = src + size;
+
+  for (size_t t = 0; t < tri_count; t++)
+  {
+    uint32_t code = codes[t];
+    uint32_t a, b, c;
+    if (code >> 4 != CODE_NO_EDGE)
+    {
+      const uint32_t *edge =
+        fifo.edges[(fifo.edge_offset - 1 - (code >> 4)) % FIFO_SIZE];
+      a = edge[0];
+      b = edge[1];
+      if (!decode_vertex(&fifo, code & 15, &data, end, &c))
+      {
+        return false;
+      }
+      push_edge(&fifo, c, b);
+      push_edge(&fifo, a, c);
+    } else
+    {
+      if (data == end)
+      {
+        return false;
+      }
+      uint32_t extra = *data++;
+      if (!decode_vertex(&fifo, code & 15, &data, end, &a) ||
+          !decode_vertex(&fifo, extra >> 4, &data, end, &b) ||
+          !decode_vertex(&fifo, extra & 15, &data, end, &c))
+      {
+        return false;
+      }
+      push_edge(&fifo, b, a);
+      push_edge(&fifo, c, b);
+      push_edge(&fifo, a, c);
+    }
+
+    if (a >= vertex_count || b >= vertex_count || c >= vertex_count)
+    {
+      return false;
+    }
+    dst[t * 3 + 0] = a;
+    dst[t * 3 + 1] = b;
+    dst[t * 3 + 2] = c;
+  }
+  return data == end;
+}
+
+size_t mesh_vertex_encode_bound(size_t vertex_count, size_t stride)
+{
+  size_t blocks = (vertex_count + VERTEX_BLOCK_SIZE - 1) / VERTEX_BLOCK_SIZE;
+  size_t headers = VERTEX_BLOCK_SIZE / VERTEX_GROUP_SIZE /
+    VERTEX_GROUPS_PER_HEADER;
+  return 1 + blocks * stride * (headers + VERTEX_BLOCK_SIZE);
+}
+
+size_t mesh_vertex_encode(const void *vertices, size_t vertex_count,
+                          size_t stride, uint8_t *dst, size_t capacity)
+{
+  if (stride == 0 || stride % 4 != 0 || stride > VERTEX_MAX_STRIDE ||
+      capacity < mesh_vertex_encode_bound(vertex_count, stride))
+  {
+    return 0;
+  }
+
+  const uint8_t *src = (const uint8_t *) vertices;
+  uint8_t last[VERTEX_MAX_STRIDE] = { 0 };
+  uint8_t deltas[VERTEX_BLOCK_SIZE];
+  uint8_t *op = dst;
+  *op++ = VERTEX_CODEC_HEADER;
+
+  for (size_t first = 0; first < vertex_count; first += VERTEX_BLOCK_SIZE)
+  {
+    size_t count = vertex_count - first < VERTEX_BLOCK_SIZE ?
+      vertex_count - first : VERTEX_BLOCK_SIZE;
+    for (size_t k = 0; k < stride; k++)
+    {
+      uint8_t prev = last[k];
+      for (size_t v = 0; v < count; v++)
+      {
+        uint8_t byte = src[(first + v) * stride + k];
+        int8_t delta = (int8_t) (uint8_t) (byte - prev);
+        deltas[v] = (uint8_t) (((uint32_t) (uint8_t) delta << 1) ^
+                               (uint8_t) (delta >> 7));
+        prev = byte;
+      }
+      last[k] = prev;
+      op = encode_stream(op, deltas, count);
+    }
+  }
+  return (size_t) (op - dst);
+}
+
+bool mesh_vertex_decode(const uint8_t *src, size_t size, void *dst,
+                        size_t vertex_count, size_t stride)
+{
+  if (stride == 0 || stride % 4 != 0 || stride > VERTEX_MAX_STRIDE ||
+      size < 1 || src[0] != VERTEX_CODEC_HEADER)
+  {
+    return false;
+  }
+
+  /* One block's streams, decoded a byte of every vertex at a time. */
+  uint8_t *block = MIUR_ARR_UNINIT(uint8_t, stride * VERTEX_BLOCK_SIZE);
+  if (block == NULL)
+  {
+    return false;
+  }
+
+  bool result = false;
+  uint8_t *out = (uint8_t *) dst;
+  uint8_t last[VERTEX_MAX_STRIDE] = { 0 };
+  const uint8_t *ip = src + 1;
+  const uint8_t *end = src + size;
+  for (size_t first = 0; first < vertex_count; first += VERTEX_BLOCK_SIZE)
+  {
+    size_t count = vertex_count - first < VERTEX_BLOCK_SIZE ?
+      vertex_count - first : VERTEX_BLOCK_SIZE;
+    for (size_t k = 0; k < stride; k++)
+    {
+      uint8_t *stream = block + k * VERTEX_BLOCK_SIZE;
+      ip = decode_stream(ip, end, stream, count, last[k]);
+      if (ip == NULL)
+      {
+        goto cleanup;
+      }
+      last[k] = stream[count - 1];
+    }
+    transpose_block(out + first * stride, block, count, stride);
+  }
+  result = ip == end;
+
+cleanup:
+  MIUR_FREE(block);
+  return result;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void push_edge(IndexFifo *fifo, uint32_t a, uint32_t b)
+{
+  uint32_t *edge = fifo->edges[fifo->edge_offset % FIFO_SIZE];
+  edge[0] = a;
+  edge[1] = b;
+  fifo->edge_offset++;
+}
+
+static void push_vertex(IndexFifo *fifo, uint32_t v)
+{
+  fifo->vertices[fifo->vertex_offset % FIFO_SIZE] = v;
+  fifo->vertex_offset++;
+}
+
+/* Distance from the newest entry, -1 if the edge isn't reachable. */
+static int find_edge(const IndexFifo *fifo, uint32_t a, uint32_t b)
+{
+  for (int d = 0; d < CODE_NO_EDGE; d++)
+  {
+    const uint32_t *edge = fifo->edges[(fifo->edge_offset - 1 - d) %
+                                       FIFO_SIZE];
+    if (edge[0] == a && edge[1] == b)
+    {
+      return d;
+    }
+  }
+  return -1;
+}
+
+static int find_vertex(const IndexFifo *fifo, uint32_t v)
+{
+  for (int d = 0; d < CODE_EXPLICIT - 1; d++)
+  {
+    if (fifo->vertices[(fifo->vertex_offset - 1 - d) % FIFO_SIZE] == v)
+    {
+      return d;
+    }
+  }
+  return -1;
+}
+
+static uint32_t encode_vertex(IndexFifo *fifo, uint32_t v, uint8_t **data)
+{
+  if (v == fifo->next)
+  {
+    fifo->next++;
+    push_vertex(fifo, v);
+    return CODE_NEXT;
+  }
+  int d = find_vertex(fifo, v);
+  if (d >= 0)
+  {
+    return (uint32_t) d + 1;
+  }
+
+  int32_t delta = (int32_t) (v - fifo->last);
+  uint32_t zigzag = ((uint32_t) delta << 1) ^ (uint32_t) (delta >> 31);
+  while (zigzag >= 0x80)
+  {
+    *(*data)++ = (uint8_t) (zigzag | 0x80);
+    zigzag >>= 7;
+  }
+  *(*data)++ = (uint8_t) zigzag;
+  fifo->last = v;
+  push_vertex(fifo, v);
+  return CODE_EXPLICIT;
+}
+
+static bool decode_vertex(IndexFifo *fifo, uint32_t code, const uint8_t **data,
+                          const uint8_t *end, uint32_t *v)
+{
+  if (code == CODE_NEXT)
+  {
+    *v = fifo->next++;
+    push_vertex(fifo, *v);
+    return true;
+  }
+  if (code != CODE_EXPLICIT)
+  {
+    *v = fifo->vertices[(fifo->vertex_offset - code) % FIFO_SIZE];
+    return true;
+  }
+
+  uint32_t zigzag;
+  if (!read_varint(data, end, &zigzag))
+  {
+    return false;
+  }
+  *v = fifo->last + ((zigzag >> 1) ^ (0u - (zigzag & 1)));
+  fifo->last = *v;
+  push_vertex(fifo, *v);
+  return true;
+}
+
+static bool read_varint(const uint8_t **data, const uint8_t *end,
+                        uint32_t *value)
+{
+  uint32_t result = 0;
+  for (uint32_t shift = 0; shift < 7 * MAX_VARINT_SIZE; shift += 7)
+  {
+    if (*data == end)
+    {
+      return false;
+    }
+    uint8_t byte = *(*data)++;
+    result |= (uint32_t) (byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0)
+    {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * The 2 bit layout puts values b, b + 4, b + 8 and b + 12 in byte b and the
+ * 4 bit one values b and b + 8, so both unpack with whole register shifts.
+ */
+static uint8_t *encode_stream(uint8_t *op, const uint8_t *deltas,
+                              size_t count)
+{
+  size_t groups = (count + VERTEX_GROUP_SIZE - 1) / VERTEX_GROUP_SIZE;
+  size_t header_size = (groups + VERTEX_GROUPS_PER_HEADER - 1) /
+    VERTEX_GROUPS_PER_HEADER;
+  uint8_t *header = op;
+  memset(header, 0, header_size);
+  op += header_size;
+
+  for (size_t g = 0; g < groups; g++)
+  {
+    uint8_t values[VERTEX_GROUP_SIZE] = { 0 };
+    size_t first = g * VERTEX_GROUP_SIZE;
+    size_t size = count - first < VERTEX_GROUP_SIZE ?
+      count - first : VERTEX_GROUP_SIZE;
+    memcpy(values, deltas + first, size);
+
+    uint8_t max = 0;
+    for (size_t i = 0; i < VERTEX_GROUP_SIZE; i++)
+    {
+      max |= values[i];
+    }
+    uint32_t width = max == 0 ? 0 : max < 4 ? 1 : max < 16 ? 2 : 3;
+    header[g / VERTEX_GROUPS_PER_HEADER] |=
+      (uint8_t) (width << (g % VERTEX_GROUPS_PER_HEADER * 2));
+
+    if (width == 1)
+    {
+      for (int b = 0; b < 4; b++)
+      {
+        op[b] = (uint8_t) (values[b] | values[b + 4] << 2 |
+                           values[b + 8] << 4 | values[b + 12] << 6);
+      }
+    } else if (width == 2)
+    {
+      for (int b = 0; b < 8; b++)
+      {
+        op[b] = (uint8_t) (values[b] | values[b + 8] << 4);
+      }
+    } else if (width == 3)
+    {
+      memcpy(op, values, VERTEX_GROUP_SIZE);
+    }
+    op += group_sizes[width];
+  }
+  return op;
+}
+
+/*
+ * Writes whole groups, `out` must have room for `count` rounded up to
+ * VERTEX_GROUP_SIZE.  Returns NULL if the stream runs past `end`.
+ */
+static const uint8_t *decode_stream(const uint8_t *ip, const uint8_t *end,
+                                    uint8_t *out, size_t count, uint8_t prev)
+{
+  size_t groups = (count + VERTEX_GROUP_SIZE - 1) / VERTEX_GROUP_SIZE;
+  size_t header_size = (groups + VERTEX_GROUPS_PER_HEADER - 1) /
+    VERTEX_GROUPS_PER_HEADER;
+  if ((size_t) (end - ip) < header_size)
+  {
+    return NULL;
+  }
+  const uint8_t *header = ip;
+  ip += header_size;
+
+  size_t data_size = 0;
+  for (size_t g = 0; g < groups; g++)
+  {
+    data_size += group_sizes[(header[g / VERTEX_GROUPS_PER_HEADER] >>
+                              (g % VERTEX_GROUPS_PER_HEADER * 2)) & 3];
+  }
+  if ((size_t) (end - ip) < data_size)
+  {
+    return NULL;
+  }
+
+#ifdef MIUR_HAVE_SSE2
+  const __m128i mask2 = _mm_set1_epi8(0x03);
+  const __m128i mask4 = _mm_set1_epi8(0x0f);
+  const __m128i mask7 = _mm_set1_epi8(0x7f);
+  const __m128i one = _mm_set1_epi8(1);
+  __m128i carry = _mm_set1_epi8((char) prev);
+  for (size_t g = 0; g < groups; g++)
+  {
+    uint32_t width = (header[g / VERTEX_GROUPS_PER_HEADER] >>
+                      (g % VERTEX_GROUPS_PER_HEADER * 2)) & 3;
+    __m128i x;
+    if (width == 0)
+    {
+      x = _mm_setzero_si128();
+    } else if (width == 1)
+    {
+      uint32_t packed;
+      memcpy(&packed, ip, sizeof(packed));
+      x = _mm_and_si128(_mm_set_epi32((int) (packed >> 6), (int) (packed >> 4),
+                                      (int) (packed >> 2), (int) packed),
+                        mask2);
+    } else if (width == 2)
+    {
+      __m128i packed = _mm_loadl_epi64((const __m128i *) ip);
+      x = _mm_unpacklo_epi64(_mm_and_si128(packed, mask4),
+                             _mm_and_si128(_mm_srli_epi16(packed, 4), mask4));
+    } else
+    {
+      x = _mm_loadu_si128((const __m128i *) ip);
+    }
+    ip += group_sizes[width];
+
+    /* Undo the zigzag, then a running sum across the lanes. */
+    x = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(x, 1), mask7),
+                      _mm_sub_epi8(_mm_setzero_si128(),
+                                   _mm_and_si128(x, one)));
+    x = _mm_add_epi8(x, _mm_slli_si128(x, 1));
+    x = _mm_add_epi8(x, _mm_slli_si128(x, 2));
+    x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+    x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi8(x, carry);
+    _mm_storeu_si128((__m128i *) (out + g * VERTEX_GROUP_SIZE), x);
+
+    /* Broadcast the last lane. */
+    carry = _mm_unpackhi_epi8(x, x);
+    carry = _mm_shufflehi_epi16(carry, 0xff);
+    carry = _mm_unpackhi_epi64(carry, carry);
+  }
+#else
+  for (size_t g = 0; g < groups; g++)
+  {
+    uint32_t width = (header[g / VERTEX_GROUPS_PER_HEADER] >>
+                      (g % VERTEX_GROUPS_PER_HEADER * 2)) & 3;
+    uint8_t values[VERTEX_GROUP_SIZE];
+    for (int i = 0; i < VERTEX_GROUP_SIZE; i++)
+    {
+      values[i] = width == 0 ? 0 :
+        width == 1 ? (uint8_t) (ip[i % 4] >> (i / 4 * 2) & 3) :
+        width == 2 ? (uint8_t) (ip[i % 8] >> (i / 8 * 4) & 15) : ip[i];
+    }
+    ip += group_sizes[width];
+
+    for (int i = 0; i < VERTEX_GROUP_SIZE; i++)
+    {
+      prev = (uint8_t) (prev + ((values[i] >> 1) ^ (0u - (values[i] & 1))));
+      out[g * VERTEX_GROUP_SIZE + i] = prev;
+    }
+  }
+#endif
+  return ip;
+}
+
+/* Scatters the byte streams of `block` back into whole vertices. */
+static void transpose_block(uint8_t *dst, const uint8_t *block, size_t count,
+                            size_t stride)
+{
+  for (size_t k = 0; k < stride; k += 4)
+  {
+    const uint8_t *s0 = block + (k + 0) * VERTEX_BLOCK_SIZE;
+    const uint8_t *s1 = block + (k + 1) * VERTEX_BLOCK_SIZE;
+    const uint8_t *s2 = block + (k + 2) * VERTEX_BLOCK_SIZE;
+    const uint8_t *s3 = block + (k + 3) * VERTEX_BLOCK_SIZE;
+    size_t v = 0;
+#ifdef MIUR_HAVE_SSE2
+    for (; v + VERTEX_GROUP_SIZE <= count; v += VERTEX_GROUP_SIZE)
+    {
+      __m128i x0 = _mm_loadu_si128((const __m128i *) (s0 + v));
+      __m128i x1 = _mm_loadu_si128((const __m128i *) (s1 + v));
+      __m128i x2 = _mm_loadu_si128((const __m128i *) (s2 + v));
+      __m128i x3 = _mm_loadu_si128((const __m128i *) (s3 + v));
+      __m128i lo01 = _mm_unpacklo_epi8(x0, x1);
+      __m128i lo23 = _mm_unpacklo_epi8(x2, x3);
+      __m128i hi01 = _mm_unpackhi_epi8(x0, x1);
+      __m128i hi23 = _mm_unpackhi_epi8(x2, x3);
+      __m128i rows[4] = {
+        _mm_unpacklo_epi16(lo01, lo23),
+        _mm_unpackhi_epi16(lo01, lo23),
+        _mm_unpacklo_epi16(hi01, hi23),
+        _mm_unpackhi_epi16(hi01, hi23),
+      };
+
+      uint8_t *op = dst + v * stride + k;
+      for (int r = 0; r < 4; r++)
+      {
+        for (int i = 0; i < 4; i++)
+        {
+          uint32_t word = (uint32_t) _mm_cvtsi128_si32(rows[r]);
+          memcpy(op, &word, sizeof(word));
+          rows[r] = _mm_srli_si128(rows[r], 4);
+          op += stride;
+        }
+      }
+    }
+#endif
+    for (; v < count; v++)
+    {
+      uint8_t *op = dst + v * stride + k;
+      op[0] = s0[v];
+      op[1] = s1[v];
+      op[2] = s2[v];
+      op[3] = s3[v];
+    }
+  }
+}
@@ -0,0 +1,780 @@
+/* =====================
+ * src/mesh_opt.c
+ * 10/18/2026
+ * Mesh optimization passes.
+ * ====================
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <miur/mesh_opt.h>
+#include <miur/log.h>
+#include <miur/mem.h>
+#include <miur/simplify.h>
+
+/* Triangles around each vertex, by offset into one shared array. */
+typedef struct
+{
+  uint32_t *counts;
+  uint32_t *offsets;
+  uint32_t *triangles;
+} Adjacency;
+
+/*
+ * Tipsify state, see Sander et al., "Fast Triangle Reordering for Vertex
+ * Locality and Reduced Overdraw", 2007.
+ */
+typedef struct
+{
+  const uint32_t *indices;
+  size_t vertex_count;
+  uint32_t cache_size;
+  uint32_t *live;              /* Triangles not yet emitted per vertex. */
+  uint32_t *stamps;            /* Time each vertex last entered the cache. */
+  uint32_t time;
+  uint32_t *dead_end;          /* Vertices of emitted triangles, a stack. */
+  size_t dead_end_count;
+  uint32_t cursor;             /* Next vertex to try once the stack is dry. */
+} Tipsify;
+
+typedef struct
+{
+  float key;
+  uint32_t cluster;
+} ClusterKey;
+
+/* === PROTOTYPES === */
+
+static bool adjacency_build(Adjacency *adj, const uint32_t *indices,
+                            size_t index_count, size_t vertex_count);
+static void adjacency_destroy(Adjacency *adj);
+static uint32_t next_fan(Tipsify *tip, size_t candidates);
+static uint32_t skip_dead_end(Tipsify *tip);
+static uint32_t cache_misses(const uint32_t *triangle, uint32_t *stamps,
+                             uint32_t *time, uint32_t cache_size);
+static size_t soft_boundaries(uint32_t *soft, const uint32_t *indices,
+                              size_t tri_count, size_t vertex_count,
+                              const uint32_t *clusters, size_t cluster_count,
+                              uint32_t cache_size, float threshold);
+static void cluster_key(ClusterKey *out, const uint32_t *indices,
+                        const float *positions, uint32_t first, uint32_t end,
+                        const float center[3]);
+static void triangle_normal(const uint32_t *triangle, const float *positions,
+                            float normal_out[3], float centroid_out[3]);
+static int compare_cluster_keys(const void *a, const void *b);
+
+/* === PUBLIC FUNCTIONS === */
+
+VertexCacheStats mesh_analyze_vertex_cache(const uint32_t *indices,
+                                           size_t index_count,
+                                           size_t vertex_count,
+                                           uint32_t cache_size)
+{
+  VertexCacheStats stats = { 0 };
+  uint32_t *stamps = MIUR_ARR(uint32_t, vertex_count > 0 ? vertex_count : 1);
+  if (stamps == NULL)
+  {
+    return stats;
+  }
+
+  /* A vertex is cached while fewer than cache_size misses came after it. */
+  uint32_t time = cache_size + 1;
+  for (size_t i = 0; i < index_count; i++)
+  {
+    uint32_t v = indices[i];
+    if (stamps[v] == 0)
+    {
+      stats.vertices++;
+    }
+    if (time - stamps[v] > cache_size)
+    {
+      stamps[v] = time++;
+      stats.misses++;
+    }
+  }
+  MIUR_FREE(stamps);
+
+  stats.triangles = (uint32_t) (index_count / 3);
+  stats.acmr = stats.triangles > 0 ?
+    (float) stats.misses / (float) stats.triangles : 0.0f;
+  stats.atvr = stats.vertices > 0 ?
+    (float) stats.misses / (float) stats.vertices : 0.0f;
+  return stats;
+}
+
+bool mesh_optimize_vertex_cache(uint32_t *dst, const uint32_t *indices,
+                                size_t index_count, size_t vertex_count,
+                                uint32_t cache_size, uint32_t *clusters,
+                                size_t *cluster_count)
+{
+  size_t tri_count = index_count / 3;
+  size_t out = 0;
+  size_t found = 0;
+  bool result = false;
+
+  Adjacency adj = { 0 };
+  Tipsify tip = {
+    .indices = indices,
+    .vertex_count = vertex_count,
+    .cache_size = cache_size,
+    .time = cache_size + 1,
+  };
+  uint8_t *emitted = NULL;
+
+  if (tri_count == 0 || vertex_count == 0)
+  {
+    goto copy_rest;
+  }
+
+  if (!adjacency_build(&adj, indices, tri_count * 3, vertex_count))
+  {
+    goto cleanup;
+  }
+  tip.live = MIUR_ARR_UNINIT(uint32_t, vertex_count);
+  tip.stamps = MIUR_ARR(uint32_t, vertex_count);
+  tip.dead_end = MIUR_ARR_UNINIT(uint32_t, tri_count * 3);
+  emitted = MIUR_ARR(uint8_t, tri_count);
+  if (tip.live == NULL || tip.stamps == NULL || tip.dead_end == NULL ||
+      emitted == NULL)
+  {
+    goto cleanup;
+  }
+  memcpy(tip.live, adj.counts, vertex_count * sizeof(uint32_t));
+
+  /*
+   * Emit every triangle around the fan vertex, then move to the neighbour
+   * that is still in the cache and will stay there for its own fan.
+   */
+  bool fresh = true;
+  uint32_t fan = skip_dead_end(&tip);
+  while (fan != UINT32_MAX)
+  {
+    size_t candidates = tip.dead_end_count;
+    const uint32_t *tris = adj.triangles + adj.offsets[fan];
+    for (uint32_t k = 0; k < adj.counts[fan]; k++)
+    {
+      uint32_t t = tris[k];
+      if (emitted[t])
+      {
+        continue;
+      }
+      if (fresh && clusters != NULL)
+      {
+        clusters[found++] = (uint32_t) (out / 3);
+      }
+      fresh = false;
+
+      for (int c = 0; c < 3; c++)
+      {
+        uint32_t v = indices[t * 3 + c];
+        dst[out++] = v;
+        tip.dead_end[tip.dead_end_count++] = v;
+        tip.live[v]--;
+        if (tip.time - tip.stamps[v] > cache_size)
+        {
+          tip.stamps[v] = tip.time++;
+        }
+      }
+      emitted[t] = 1;
+    }
+
+    fan = next_fan(&tip, candidates);
+    if (fan == UINT32_MAX)
+    {
+      fresh = true;
+      fan = skip_dead_end(&tip);
+    }
+  }
+
+copy_rest:
+  /* Indices past the last whole triangle are kept as they were. */
+  memcpy(dst + out, indices + out, (index_count - out) * sizeof(uint32_t));
+  if (clusters != NULL && found == 0 && tri_count > 0)
+  {
+    clusters[found++] = 0;
+  }
+  if (cluster_count != NULL)
+  {
+    *cluster_count = found;
+  }
+  result = true;
+
+cleanup:
+  adjacency_destroy(&adj);
+  MIUR_FREE(tip.live);
+  MIUR_FREE(tip.stamps);
+  MIUR_FREE(tip.dead_end);
+  MIUR_FREE(emitted);
+  return result;
+}
+
+bool mesh_optimize_overdraw(uint32_t *dst, const uint32_t *indices,
+                            size_t index_count, const float *positions,
+                            size_t vertex_count, const uint32_t *clusters,
+                            size_t cluster_count, uint32_t cache_size,
+                            float threshold)
+{
+  size_t tri_count = index_count / 3;
+  memcpy(dst + tri_count * 3, indices + tri_count * 3,
+         (index_count - tri_count * 3) * sizeof(uint32_t));
+  if (tri_count == 0)
+  {
+    return true;
+  }
+
+  static const uint32_t whole_mesh = 0;
+  if (cluster_count == 0)
+  {
+    clusters = &whole_mesh;
+    cluster_count = 1;
+  }
+
+  bool result = false;
+  ClusterKey *keys = NULL;
+  uint32_t *soft = MIUR_ARR_UNINIT(uint32_t, tri_count + 1);
+  if (soft == NULL)
+  {
+    goto cleanup;
+  }
+  size_t soft_count = soft_boundaries(soft, indices, tri_count, vertex_count,
+                                      clusters, cluster_count, cache_size,
+                                      threshold);
+  if (soft_count == 0)
+  {
+    goto cleanup;
+  }
+  soft[soft_count] = (uint32_t) tri_count;
+
+  /*
+   * Clusters facing away from the middle of the mesh tend to occlude the
+   * rest, so they draw first.
+   */
+  float center[3] = { 0.0f, 0.0f, 0.0f };
+  float total_area = 0.0f;
+  for (size_t t = 0; t < tri_count; t++)
+  {
+    float normal[3], centroid[3];
+    triangle_normal(&indices[t * 3], positions, normal, centroid);
+    float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] +
+                       normal[2] * normal[2]);
+    for (int c = 0; c < 3; c++)
+    {
+      center[c] += centroid[c] * area;
+    }
+    total_area += area;
+  }
+  for (int c = 0; c < 3; c++)
+  {
+    center[c] = total_area > 0.0f ? center[c] / total_area : 0.0f;
+  }
+
+  keys = MIUR_ARR_UNINIT(ClusterKey, soft_count);
+  if (keys == NULL)
+  {
+    goto cleanup;
+  }
+  for (size_t i = 0; i < soft_count; i++)
+  {
+    cluster_key(&keys[i], indices, positions, soft[i], soft[i + 1], center);
+    keys[i].cluster = (uint32_t) i;
+  }
+  qsort(keys, soft_count, sizeof(ClusterKey), compare_cluster_keys);
+
+  size_t out = 0;
+  for (size_t i = 0; i < soft_count; i++)
+  {
+    uint32_t cluster = keys[i].cluster;
+    size_t count = (size_t) (soft[cluster + 1] - soft[cluster]) * 3;
+    memcpy(dst + out, indices + (size_t) soft[cluster] * 3,
+           count * sizeof(uint32_t));
+    out += count;
+  }
+  result = true;
+
+cleanup:
+  MIUR_FREE(soft);
+  MIUR_FREE(keys);
+  return result;
+}
+
+size_t mesh_optimize_vertex_fetch(uint32_t *remap, const uint32_t *indices,
+                                  size_t index_count, size_t vertex_count)
+{
+  memset(remap, 0xFF, vertex_count * sizeof(uint32_t));
+  uint32_t next = 0;
+  for (size_t i = 0; i < index_count; i++)
+  {
+    uint32_t v = indices[i];
+    if (remap[v] == UINT32_MAX)
+    {
+      remap[v] = next++;
+    }
+  }
+  return next;
+}
+
+void mesh_remap_vertices(void *dst, const void *src, size_t vertex_count,
+                         size_t size, const uint32_t *remap)
+{
+  uint8_t *out = (uint8_t *) dst;
+  const uint8_t *in = (const uint8_t *) src;
+  for (size_t v = 0; v < vertex_count; v++)
+  {
+    if (remap[v] != UINT32_MAX)
+    {
+      memcpy(out + (size_t) remap[v] * size, in + v * size, size);
+    }
+  }
+}
+
+bool static_mesh_optimize(StaticMesh *mesh, MeshOptReport *report)
+{
+  size_t index_count = mesh->index_count;
+  size_t vertex_count = mesh->vert_count;
+  size_t tri_count = index_count / 3;
+  bool result = false;
+
+  memset(report, 0, sizeof(MeshOptReport));
+  if (tri_count == 0)
+  {
+    return true;
+  }
+
+  uint32_t *indices = MIUR_ARR_UNINIT(uint32_t, index_count);
+  uint32_t *scratch = MIUR_ARR_UNINIT(uint32_t, index_count);
+  uint32_t *clusters = MIUR_ARR_UNINIT(uint32_t, tri_count);
+  uint32_t *remap = MIUR_ARR_UNINIT(uint32_t, vertex_count);
+  float *pos = MIUR_ARR_UNINIT(float, vertex_count * 3);
+  float *norm = MIUR_ARR_UNINIT(float, vertex_count * 3);
+  float *uv = mesh->verts_uv != NULL ?
+    MIUR_ARR_UNINIT(float, vertex_count * 2) : NULL;
+  if (indices == NULL || scratch == NULL || clusters == NULL ||
+      remap == NULL || pos == NULL || norm == NULL ||
+      (mesh->verts_uv != NULL && uv == NULL))
+  {
+    goto cleanup;
+  }
+
+  memcpy(indices, mesh->indices, index_count * sizeof(uint32_t));
+  report->before = mesh_analyze_vertex_cache(indices, index_count,
+                                             vertex_count,
+                                             MESH_OPT_CACHE_SIZE);
+
+  size_t cluster_count;
+  if (!mesh_optimize_vertex_cache(scratch, indices, index_count,
+                                  vertex_count, MESH_OPT_CACHE_SIZE,
+                                  clusters, &cluster_count) ||
+      !mesh_optimize_overdraw(indices, scratch, index_count, mesh->verts_pos,
+                              vertex_count, clusters, cluster_count,
+                              MESH_OPT_CACHE_SIZE,
+                              MESH_OPT_OVERDRAW_THRESHOLD))
+  {
+    goto cleanup;
+  }
+
+  size_t used = mesh_optimize_vertex_fetch(remap, indices, index_count,
+                                           vertex_count);
+  mesh_remap_vertices(pos, mesh->verts_pos, vertex_count, 3 * sizeof(float),
+                      remap);
+  mesh_remap_vertices(norm, mesh->verts_norm, vertex_count,
+                      3 * sizeof(float), remap);
+  if (uv != NULL)
+  {
+    mesh_remap_vertices(uv, mesh->verts_uv, vertex_count, 2 * sizeof(float),
+                        remap);
+  }
+  for (size_t i = 0; i < index_count; i++)
+  {
+    mesh->indices[i] = indices[i] = remap[indices[i]];
+  }
+  report->after = mesh_analyze_vertex_cache(indices, index_count, used,
+                                            MESH_OPT_CACHE_SIZE);
+
+  /* Swap in the remapped streams, the old ones are freed below. */
+  float *swap = mesh->verts_pos;
+  mesh->verts_pos = pos;
+  pos = swap;
+  swap = mesh->verts_norm;
+  mesh->verts_norm = norm;
+  norm = swap;
+  swap = mesh->verts_uv;
+  mesh->verts_uv = uv;
+  uv = swap;
+  mesh->vert_count = (uint32_t) used;
+  result = true;
+
+cleanup:
+  MIUR_FREE(indices);
+  MIUR_FREE(scratch);
+  MIUR_FREE(clusters);
+  MIUR_FREE(remap);
+  MIUR_FREE(pos);
+  MIUR_FREE(norm);
+  MIUR_FREE(uv);
+  return result;
+}
+
+bool static_mesh_build_meshlets(StaticMesh *mesh)
+{
+  MeshletBuffer meshlets;
+  bool result = meshlet_build(&meshlets, mesh->indices, mesh->index_count,
+                              mesh->verts_pos, mesh->vert_count);
+#ifndef NDEBUG
+  if (result && !meshlet_validate(&meshlets, mesh->indices, mesh->index_count,
+                                  mesh->vert_count))
+  {
+    MIUR_LOG_ERR("Built invalid meshlets");
+    meshlet_buffer_destroy(&meshlets);
+    result = false;
+  }
+#endif
+  if (result)
+  {
+    meshlet_buffer_destroy(&mesh->meshlets);
+    mesh->meshlets = meshlets;
+  }
+  return result;
+}
+
+bool static_mesh_build_lods(StaticMesh *mesh)
+{
+  size_t vertex_count = mesh->vert_count;
+  size_t count = mesh->index_count;
+  mesh->lod_count = 0;
+  if (count / 3 <= MESH_LOD_MIN_TRIANGLES)
+  {
+    return true;
+  }
+
+  /* Normals and texture coordinates steer which edges go first. */
+  static const float weights[] = { 0.5f, 0.5f, 0.5f, 1.0f, 1.0f };
+  size_t attribute_count = mesh->verts_uv != NULL ? 5 : 3;
+  bool result = false;
+  uint32_t *level = MIUR_ARR_UNINIT(uint32_t, count);
+  uint32_t *next = MIUR_ARR_UNINIT(uint32_t, count);
+  uint32_t *scratch = MIUR_ARR_UNINIT(uint32_t, count);
+  float *attributes = MIUR_ARR_UNINIT(float, vertex_count * attribute_count);
+  if (level == NULL || next == NULL || scratch == NULL || attributes == NULL)
+  {
+    goto cleanup;
+  }
+  for (size_t v = 0; v < vertex_count; v++)
+  {
+    float *attr = &attributes[v * attribute_count];
+    memcpy(attr, &mesh->verts_norm[v * 3], 3 * sizeof(float));
+    if (mesh->verts_uv != NULL)
+    {
+      memcpy(attr + 3, &mesh->verts_uv[v * 2], 2 * sizeof(float));
+    }
+  }
+  memcpy(level, mesh->indices, count * sizeof(uint32_t));
+
+  uint32_t total = mesh->index_count;
+  float error = 0.0f;
+  while (mesh->lod_count < MESH_MAX_LODS &&
+         count / 3 > MESH_LOD_MIN_TRIANGLES)
+  {
+    MeshSimplifyDesc desc = {
+      .target_index_count = (size_t) ((float) (count / 3) * MESH_LOD_RATIO) *
+        3,
+      .target_error = MESH_LOD_MAX_ERROR,
+      .attributes = attributes,
+      .attribute_weights = weights,
+      .attribute_count = attribute_count,
+    };
+    size_t next_count;
+    float level_error;
+    if (!mesh_simplify(next, &next_count, &level_error, level, count,
+                       mesh->verts_pos, vertex_count, &desc))
+    {
+      goto cleanup;
+    }
+    /* Too little gone to be worth a level. */
+    if (next_count == 0 || (float) next_count > (float) count * 0.9f)
+    {
+      break;
+    }
+
+    uint32_t *indices = MIUR_REALLOC(uint32_t, mesh->indices,
+                                     (total + next_count));
+    if (indices == NULL)
+    {
+      goto cleanup;
+    }
+    mesh->indices = indices;
+    if (!mesh_optimize_vertex_cache(scratch, next, next_count, vertex_count,
+                                    MESH_OPT_CACHE_SIZE, NULL, NULL))
+    {
+      goto cleanup;
+    }
+    memcpy(indices + total, scratch, next_count * sizeof(uint32_t));
+
+    /* Each level is simplified from the last, so their errors add up. */
+    error += level_error;
+    mesh->lods[mesh->lod_count++] = (MeshLod) {
+      .first_index = total,
+      .index_count = (uint32_t) next_count,
+      .error = error,
+    };
+    total += (uint32_t) next_count;
+
+    uint32_t *swap = level;
+    level = scratch;
+    scratch = swap;
+    count = next_count;
+  }
+  result = true;
+
+cleanup:
+  MIUR_FREE(level);
+  MIUR_FREE(next);
+  MIUR_FREE(scratch);
+  MIUR_FREE(attributes);
+  return result;
+}
+
+uint32_t static_mesh_index_total(const StaticMesh *mesh)
+{
+  if (mesh->lod_count == 0)
+  {
+    return mesh->index_count;
+  }
+  const MeshLod *last = &mesh->lods[mesh->lod_count - 1];
+  return last->first_index + last->index_count;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static bool adjacency_build(Adjacency *adj, const uint32_t *indices,
+                            size_t index_count, size_t vertex_count)
+{
+  adj->counts = MIUR_ARR(uint32_t, vertex_count);
+  adj->offsets = MIUR_ARR_UNINIT(uint32_t, vertex_count);
+  adj->triangles = MIUR_ARR_UNINIT(uint32_t, index_count);
+  if (adj->counts == NULL || adj->offsets == NULL || adj->triangles == NULL)
+  {
+    adjacency_destroy(adj);
+    return false;
+  }
+
+  for (size_t i = 0; i < index_count; i++)
+  {
+    adj->counts[indices[i]]++;
+  }
+  uint32_t offset = 0;
+  for (size_t v = 0; v < vertex_count; v++)
+  {
+    adj->offsets[v] = offset;
+    offset += adj->counts[v];
+  }
+  /* Fill by bumping the offsets, then step them back. */
+  for (size_t i = 0; i < index_count; i++)
+  {
+    adj->triangles[adj->offsets[indices[i]]++] = (uint32_t) (i / 3);
+  }
+  for (size_t v = 0; v < vertex_count; v++)
+  {
+    adj->offsets[v] -= adj->counts[v];
+  }
+  return true;
+}
+
+static void adjacency_destroy(Adjacency *adj)
+{
+  MIUR_FREE(adj->counts);
+  MIUR_FREE(adj->offsets);
+  MIUR_FREE(adj->triangles);
+  memset(adj, 0, sizeof(Adjacency));
+}
+
+/*
+ * Picks, among the vertices the last fan added, the one that entered the
+ * cache longest ago but will still be in it once its remaining triangles
+ * are emitted.  UINT32_MAX if none of them has triangles left.
+ */
+static uint32_t next_fan(Tipsify *tip, size_t candidates)
+{
+  uint32_t best = UINT32_MAX;
+  int64_t best_priority = -1;
+  for (size_t i = candidates; i < tip->dead_end_count; i++)
+  {
+    uint32_t v = tip->dead_end[i];
+    if (tip->live[v] == 0)
+    {
+      continue;
+    }
+    int64_t priority = 0;
+    uint32_t age = tip->time - tip->stamps[v];
+    if ((uint64_t) age + 2 * (uint64_t) tip->live[v] <= tip->cache_size)
+    {
+      priority = age;
+    }
+    if (priority > best_priority)
+    {
+      best_priority = priority;
+      best = v;
+    }
+  }
+  return best;
+}
+
+/* Falls back to recently used vertices, then to input order. */
+static uint32_t skip_dead_end(Tipsify *tip)
+{
+  while (tip->dead_end_count > 0)
+  {
+    uint32_t v = tip->dead_end[--tip->dead_end_count];
+    if (tip->live[v] > 0)
+    {
+      return v;
+    }
+  }
+  for (; tip->cursor < tip->vertex_count; tip->cursor++)
+  {
+    if (tip->live[tip->cursor] > 0)
+    {
+      return tip->cursor;
+    }
+  }
+  return UINT32_MAX;
+}
+
+static uint32_t cache_misses(const uint32_t *triangle, uint32_t *stamps,
+                             uint32_t *time, uint32_t cache_size)
+{
+  uint32_t misses = 0;
+  for (int c = 0; c < 3; c++)
+  {
+    uint32_t v = triangle[c];
+    if (*time - stamps[v] > cache_size)
+    {
+      stamps[v] = (*time)++;
+      misses++;
+    }
+  }
+  return misses;
+}
+
+/*
+ * Splits each hard cluster wherever the run since the last split, started
+ * from a cold cache, already does within `threshold` of the whole cluster.
+ * Writes the first triangle of every run to `soft` and returns how many,
+ * 0 if out of memory.
+ */
+static size_t soft_boundaries(uint32_t *soft, const uint32_t *indices,
+                              size_t tri_count, size_t vertex_count,
+                              const uint32_t *clusters, size_t cluster_count,
+                              uint32_t cache_size, float threshold)
+{
+  uint32_t *stamps = MIUR_ARR(uint32_t, vertex_count > 0 ? vertex_count : 1);
+  if (stamps == NULL)
+  {
+    return 0;
+  }
+
+  /* Moving time past every stamp empties the cache. */
+  uint32_t time = cache_size + 1;
+  size_t count = 0;
+  for (size_t h = 0; h < cluster_count; h++)
+  {
+    uint32_t first = clusters[h];
+    uint32_t end = h + 1 < cluster_count ? clusters[h + 1] :
+      (uint32_t) tri_count;
+
+    time += cache_size + 1;
+    uint32_t cluster_misses = 0;
+    for (uint32_t t = first; t < end; t++)
+    {
+      cluster_misses += cache_misses(&indices[t * 3], stamps, &time,
+                                     cache_size);
+    }
+    float limit = threshold * (float) cluster_misses / (float) (end - first);
+
+    time += cache_size + 1;
+    soft[count++] = first;
+    uint32_t run = first;
+    uint32_t run_misses = 0;
+    for (uint32_t t = first; t < end; t++)
+    {
+      run_misses += cache_misses(&indices[t * 3], stamps, &time, cache_size);
+      if (t + 1 < end && (float) run_misses <= limit * (float) (t + 1 - run))
+      {
+        soft[count++] = t + 1;
+        run = t + 1;
+        run_misses = 0;
+        time += cache_size + 1;
+      }
+    }
+  }
+  MIUR_FREE(stamps);
+  return count;
+}
+
+/* How far the cluster faces out from `center`, larger draws earlier. */
+static void cluster_key(ClusterKey *out, const uint32_t *indices,
+                        const float *positions, uint32_t first, uint32_t end,
+                        const float center[3])
+{
+  float normal[3] = { 0.0f, 0.0f, 0.0f };
+  float weighted[3] = { 0.0f, 0.0f, 0.0f };
+  float plain[3] = { 0.0f, 0.0f, 0.0f };
+  float total_area = 0.0f;
+  for (uint32_t t = first; t < end; t++)
+  {
+    float tri_normal[3], centroid[3];
+    triangle_normal(&indices[(size_t) t * 3], positions, tri_normal, centroid);
+    float area = sqrtf(tri_normal[0] * tri_normal[0] +
+                       tri_normal[1] * tri_normal[1] +
+                       tri_normal[2] * tri_normal[2]);
+    for (int c = 0; c < 3; c++)
+    {
+      normal[c] += tri_normal[c];
+      weighted[c] += centroid[c] * area;
+      plain[c] += centroid[c];
+    }
+    total_area += area;
+  }
+
+  /* Degenerate clusters fall back to the unweighted centroid. */
+  float len = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] +
+                    normal[2] * normal[2]);
+  out->key = 0.0f;
+  for (int c = 0; c < 3; c++)
+  {
+    float centroid = total_area > 0.0f ? weighted[c] / total_area :
+      plain[c] / (float) (end - first);
+    out->key += (centroid - center[c]) * (len > 0.0f ? normal[c] / len : 0.0f);
+  }
+}
+
+/* The normal comes out unnormalized, twice the triangle's area long. */
+static void triangle_normal(const uint32_t *triangle, const float *positions,
+                            float normal_out[3], float centroid_out[3])
+{
+  const float *a = &positions[(size_t) triangle[0] * 3];
+  const float *b = &positions[(size_t) triangle[1] * 3];
+  const float *c = &positions[(size_t) triangle[2] * 3];
+  float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+  float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+  normal_out[0] = ab[1] * ac[2] - ab[2] * ac[1];
+  normal_out[1] = ab[2] * ac[0] - ab[0] * ac[2];
+  normal_out[2] = ab[0] * ac[1] - ab[1] * ac[0];
+  for (int i = 0; i < 3; i++)
+  {
+    centroid_out[i] = (a[i] + b[i] + c[i]) * (1.0f / 3.0f);
+  }
+}
+
+/* Descending key, ties keep the vertex cache order. */
+static int compare_cluster_keys(const void *a, const void *b)
+{
+  const ClusterKey *ka = (const ClusterKey *) a;
+  const ClusterKey *kb = (const ClusterKey *) b;
+  if (ka->key != kb->key)
+  {
+    return ka->key > kb->key ? -1 : 1;
+  }
+  return ka->cluster < kb->cluster ? -1 : ka->cluster > kb->cluster;
+}
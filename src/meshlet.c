@@ -0,0 +1,857 @@
+/* =====================
+ * src/meshlet.c
+ * 10/18/2026
+ * Meshlet generation.
+ * ====================
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <miur/meshlet.h>
+#include <miur/mem.h>
+
+#define MESHLET_NONE UINT32_MAX
+#define MESHLET_NOT_LOCAL 0xFF
+/*
+ * How much a triangle's distance and normal count, each at most.  They add
+ * up to less than one so a triangle that needs fewer new vertices always
+ * wins.
+ */
+#define MESHLET_SPREAD_WEIGHT 0.45f
+#define MESHLET_CONE_WEIGHT 0.45f
+/*
+ * Triangles per cell of the centroid grid, and how many cells out from the
+ * meshlet's center a triangle that shares no vertex with it may be.
+ */
+#define MESHLET_CELL_TRIANGLES 4
+#define MESHLET_SEARCH_CELLS 2
+
+typedef struct
+{
+  const uint32_t *indices;
+  const float *positions;
+  size_t tri_count;
+
+  /* Triangles left around each vertex, emitted ones are swapped out. */
+  uint32_t *live;
+  uint32_t *offsets;
+  uint32_t *adjacency;
+  float *normals;              /* Unit normal per triangle, 0 if degenerate. */
+  float *centroids;
+  uint8_t *local;              /* Index in the current meshlet per vertex. */
+  size_t cursor;               /* No triangle before it is left. */
+
+  /*
+   * Triangles left bucketed by centroid, for meshes whose faces share no
+   * vertices, e.g. flat shaded ones.  Swapped out like `live`.
+   */
+  uint32_t *cell_offsets;
+  uint32_t *cell_live;
+  uint32_t *cell_tris;
+  uint32_t grid_size;          /* Cells per axis. */
+  float grid_min[3];
+  float grid_scale[3];         /* Cells per unit. */
+
+  /* The meshlet being grown. */
+  uint32_t verts[MESHLET_MAX_VERTICES];
+  uint32_t vert_count;
+  uint32_t tris[MESHLET_MAX_TRIANGLES];
+  uint32_t tri_count_current;
+  float centroid_sum[3];
+  float normal_sum[3];
+  float box_min[3], box_max[3];
+
+  /* Output, sized for the worst case and compacted at the end. */
+  Meshlet *meshlets;
+  uint32_t meshlet_count;
+  uint32_t *out_verts;
+  uint32_t out_vert_count;
+  uint8_t *out_tris;
+  uint32_t out_tri_size;
+} MeshletBuilder;
+
+/* What candidates are scored against, the current meshlet's shape. */
+typedef struct
+{
+  float center[3];
+  float inv_extent2;
+  float axis[3];
+} MeshletFocus;
+
+typedef struct
+{
+  uint32_t v[3];
+} TriangleKey;
+
+/* === PROTOTYPES === */
+
+static bool builder_init(MeshletBuilder *b, const uint32_t *indices,
+                         size_t tri_count, const float *positions,
+                         size_t vertex_count);
+static void builder_destroy(MeshletBuilder *b);
+static uint32_t new_vertices(const MeshletBuilder *b, uint32_t tri);
+static float triangle_score(const MeshletBuilder *b,
+                            const MeshletFocus *focus, uint32_t tri);
+static uint32_t best_candidate(const MeshletBuilder *b);
+static uint32_t nearest_candidate(const MeshletBuilder *b,
+                                  const float *center, uint32_t max_extra);
+static uint32_t next_seed(MeshletBuilder *b);
+static bool grid_init(MeshletBuilder *b);
+static size_t grid_index(const MeshletBuilder *b, const float *p);
+static uint32_t grid_cell(const MeshletBuilder *b, const float *p, int axis);
+static void add_triangle(MeshletBuilder *b, uint32_t tri);
+static void flush_meshlet(MeshletBuilder *b);
+static void compute_sphere(const MeshletBuilder *b, Meshlet *meshlet);
+static void compute_cone(const MeshletBuilder *b, Meshlet *meshlet);
+static const float *vertex_position(const MeshletBuilder *b, uint32_t v);
+static TriangleKey triangle_key(uint32_t a, uint32_t b, uint32_t c);
+static int compare_triangle_keys(const void *a, const void *b);
+
+/* === PUBLIC FUNCTIONS === */
+
+size_t meshlet_buffer_size(uint32_t meshlet_count, uint32_t vertex_count,
+                           uint32_t triangle_size)
+{
+  return sizeof(Meshlet) * meshlet_count + sizeof(uint32_t) * vertex_count +
+    triangle_size;
+}
+
+void meshlet_buffer_bind(MeshletBuffer *buf, void *data,
+                         uint32_t meshlet_count, uint32_t vertex_count,
+                         uint32_t triangle_size)
+{
+  uint8_t *base = (uint8_t *) data;
+  buf->meshlets = (Meshlet *) base;
+  buf->vertices = (uint32_t *) (base + sizeof(Meshlet) * meshlet_count);
+  buf->triangles = (uint8_t *) (buf->vertices + vertex_count);
+  buf->meshlet_count = meshlet_count;
+  buf->vertex_count = vertex_count;
+  buf->triangle_size = triangle_size;
+  buf->data = data;
+  buf->size = meshlet_buffer_size(meshlet_count, vertex_count, triangle_size);
+}
+
+void meshlet_buffer_destroy(MeshletBuffer *buf)
+{
+  MIUR_FREE(buf->data);
+  memset(buf, 0, sizeof(MeshletBuffer));
+}
+
+bool meshlet_build(MeshletBuffer *out, const uint32_t *indices,
+                   size_t index_count, const float *positions,
+                   size_t vertex_count)
+{
+  memset(out, 0, sizeof(MeshletBuffer));
+  size_t tri_count = index_count / 3;
+  if (tri_count == 0)
+  {
+    return true;
+  }
+
+  MeshletBuilder b;
+  bool result = false;
+  if (!builder_init(&b, indices, tri_count, positions, vertex_count))
+  {
+    goto cleanup;
+  }
+
+  for (uint32_t seed = next_seed(&b); seed != MESHLET_NONE;
+       seed = next_seed(&b))
+  {
+    add_triangle(&b, seed);
+    while (b.tri_count_current < MESHLET_MAX_TRIANGLES)
+    {
+      uint32_t tri = best_candidate(&b);
+      if (tri == MESHLET_NONE)
+      {
+        float center[3];
+        for (int c = 0; c < 3; c++)
+        {
+          center[c] = b.centroid_sum[c] / (float) b.tri_count_current;
+        }
+        tri = nearest_candidate(&b, center,
+                                MESHLET_MAX_VERTICES - b.vert_count);
+      }
+      if (tri == MESHLET_NONE)
+      {
+        break;
+      }
+      add_triangle(&b, tri);
+    }
+    flush_meshlet(&b);
+  }
+
+  size_t size = meshlet_buffer_size(b.meshlet_count, b.out_vert_count,
+                                    b.out_tri_size);
+  void *data = MIUR_ARR_UNINIT(uint8_t, size);
+  if (data == NULL)
+  {
+    goto cleanup;
+  }
+  meshlet_buffer_bind(out, data, b.meshlet_count, b.out_vert_count,
+                      b.out_tri_size);
+  memcpy(out->meshlets, b.meshlets, sizeof(Meshlet) * b.meshlet_count);
+  memcpy(out->vertices, b.out_verts, sizeof(uint32_t) * b.out_vert_count);
+  memcpy(out->triangles, b.out_tris, b.out_tri_size);
+  result = true;
+
+cleanup:
+  builder_destroy(&b);
+  return result;
+}
+
+bool meshlet_validate(const MeshletBuffer *buf, const uint32_t *indices,
+                      size_t index_count, size_t vertex_count)
+{
+  size_t tri_count = index_count / 3;
+  size_t covered = 0;
+  for (uint32_t i = 0; i < buf->meshlet_count; i++)
+  {
+    const Meshlet *m = &buf->meshlets[i];
+    if (m->vertex_count == 0 || m->vertex_count > MESHLET_MAX_VERTICES ||
+        m->triangle_count == 0 ||
+        m->triangle_count > MESHLET_MAX_TRIANGLES ||
+        m->vertex_offset > buf->vertex_count ||
+        m->vertex_count > buf->vertex_count - m->vertex_offset ||
+        m->triangle_offset % 4 != 0 ||
+        m->triangle_offset > buf->triangle_size ||
+        m->triangle_count * 3 > buf->triangle_size - m->triangle_offset)
+    {
+      return false;
+    }
+    covered += m->triangle_count;
+  }
+  if (covered != tri_count)
+  {
+    return false;
+  }
+
+  bool result = false;
+  TriangleKey *expected = MIUR_ARR_UNINIT(TriangleKey, tri_count + 1);
+  TriangleKey *found = MIUR_ARR_UNINIT(TriangleKey, tri_count + 1);
+  if (expected == NULL || found == NULL)
+  {
+    goto cleanup;
+  }
+
+  size_t n = 0;
+  for (uint32_t i = 0; i < buf->meshlet_count; i++)
+  {
+    const Meshlet *m = &buf->meshlets[i];
+    const uint32_t *verts = buf->vertices + m->vertex_offset;
+    const uint8_t *tris = buf->triangles + m->triangle_offset;
+    for (uint32_t v = 0; v < m->vertex_count; v++)
+    {
+      if (verts[v] >= vertex_count)
+      {
+        goto cleanup;
+      }
+    }
+    for (uint32_t t = 0; t < m->triangle_count; t++)
+    {
+      const uint8_t *tri = &tris[t * 3];
+      if (tri[0] >= m->vertex_count || tri[1] >= m->vertex_count ||
+          tri[2] >= m->vertex_count)
+      {
+        goto cleanup;
+      }
+      found[n++] = triangle_key(verts[tri[0]], verts[tri[1]], verts[tri[2]]);
+    }
+  }
+  for (size_t t = 0; t < tri_count; t++)
+  {
+    expected[t] = triangle_key(indices[t * 3], indices[t * 3 + 1],
+                               indices[t * 3 + 2]);
+  }
+
+  qsort(expected, tri_count, sizeof(TriangleKey), compare_triangle_keys);
+  qsort(found, tri_count, sizeof(TriangleKey), compare_triangle_keys);
+  result = memcmp(expected, found, sizeof(TriangleKey) * tri_count) == 0;
+
+cleanup:
+  MIUR_FREE(expected);
+  MIUR_FREE(found);
+  return result;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static bool builder_init(MeshletBuilder *b, const uint32_t *indices,
+                         size_t tri_count, const float *positions,
+                         size_t vertex_count)
+{
+  memset(b, 0, sizeof(MeshletBuilder));
+  b->indices = indices;
+  b->positions = positions;
+  b->tri_count = tri_count;
+
+  size_t index_count = tri_count * 3;
+  b->live = MIUR_ARR(uint32_t, vertex_count);
+  b->offsets = MIUR_ARR_UNINIT(uint32_t, vertex_count);
+  b->adjacency = MIUR_ARR_UNINIT(uint32_t, index_count);
+  b->normals = MIUR_ARR_UNINIT(float, index_count);
+  b->centroids = MIUR_ARR_UNINIT(float, index_count);
+  b->local = MIUR_ARR_UNINIT(uint8_t, vertex_count);
+  b->meshlets = MIUR_ARR_UNINIT(Meshlet, tri_count);
+  b->out_verts = MIUR_ARR_UNINIT(uint32_t, index_count);
+  /* Every meshlet pads its triangles by at most 3 bytes. */
+  b->out_tris = MIUR_ARR_UNINIT(uint8_t, index_count + tri_count * 3);
+  if (b->live == NULL || b->offsets == NULL || b->adjacency == NULL ||
+      b->normals == NULL || b->centroids == NULL || b->local == NULL ||
+      b->meshlets == NULL || b->out_verts == NULL || b->out_tris == NULL)
+  {
+    return false;
+  }
+  memset(b->local, MESHLET_NOT_LOCAL, vertex_count);
+
+  for (size_t i = 0; i < index_count; i++)
+  {
+    b->live[indices[i]]++;
+  }
+  uint32_t offset = 0;
+  for (size_t v = 0; v < vertex_count; v++)
+  {
+    b->offsets[v] = offset;
+    offset += b->live[v];
+    b->live[v] = 0;
+  }
+  for (size_t i = 0; i < index_count; i++)
+  {
+    uint32_t v = indices[i];
+    b->adjacency[b->offsets[v] + b->live[v]++] = (uint32_t) (i / 3);
+  }
+
+  for (size_t t = 0; t < tri_count; t++)
+  {
+    const float *p0 = vertex_position(b, indices[t * 3]);
+    const float *p1 = vertex_position(b, indices[t * 3 + 1]);
+    const float *p2 = vertex_position(b, indices[t * 3 + 2]);
+    float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    float *n = &b->normals[t * 3];
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    float len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    for (int c = 0; c < 3; c++)
+    {
+      n[c] = len > 0.0f ? n[c] / len : 0.0f;
+      b->centroids[t * 3 + c] = (p0[c] + p1[c] + p2[c]) * (1.0f / 3.0f);
+    }
+  }
+  return grid_init(b);
+}
+
+static void builder_destroy(MeshletBuilder *b)
+{
+  MIUR_FREE(b->live);
+  MIUR_FREE(b->offsets);
+  MIUR_FREE(b->adjacency);
+  MIUR_FREE(b->normals);
+  MIUR_FREE(b->centroids);
+  MIUR_FREE(b->local);
+  MIUR_FREE(b->meshlets);
+  MIUR_FREE(b->out_verts);
+  MIUR_FREE(b->out_tris);
+  MIUR_FREE(b->cell_offsets);
+  MIUR_FREE(b->cell_live);
+  MIUR_FREE(b->cell_tris);
+}
+
+/* Vertices `tri` would add to the current meshlet. */
+static uint32_t new_vertices(const MeshletBuilder *b, uint32_t tri)
+{
+  const uint32_t *v = &b->indices[(size_t) tri * 3];
+  uint32_t extra = 0;
+  extra += b->local[v[0]] == MESHLET_NOT_LOCAL;
+  extra += b->local[v[1]] == MESHLET_NOT_LOCAL && v[1] != v[0];
+  extra += b->local[v[2]] == MESHLET_NOT_LOCAL && v[2] != v[0] &&
+    v[2] != v[1];
+  return extra;
+}
+
+/* From 0 to MESHLET_SPREAD_WEIGHT + MESHLET_CONE_WEIGHT, lower is better. */
+static float triangle_score(const MeshletBuilder *b,
+                            const MeshletFocus *focus, uint32_t tri)
+{
+  const float *centroid = &b->centroids[(size_t) tri * 3];
+  const float *normal = &b->normals[(size_t) tri * 3];
+  float dist2 = 0.0f, facing = 0.0f;
+  for (int c = 0; c < 3; c++)
+  {
+    float d = centroid[c] - focus->center[c];
+    dist2 += d * d;
+    facing += focus->axis[c] * normal[c];
+  }
+  float spread = dist2 * focus->inv_extent2;
+  spread = spread < 1.0f ? spread : 1.0f;
+  return MESHLET_SPREAD_WEIGHT * spread +
+    MESHLET_CONE_WEIGHT * (1.0f - facing) * 0.5f;
+}
+
+/* The best triangle left around the meshlet that still fits in it. */
+static uint32_t best_candidate(const MeshletBuilder *b)
+{
+  MeshletFocus focus;
+  float extent2 = 0.0f, axis_len2 = 0.0f;
+  for (int c = 0; c < 3; c++)
+  {
+    focus.center[c] = b->centroid_sum[c] / (float) b->tri_count_current;
+    float half = (b->box_max[c] - b->box_min[c]) * 0.5f;
+    extent2 += half * half;
+    axis_len2 += b->normal_sum[c] * b->normal_sum[c];
+  }
+  focus.inv_extent2 = extent2 > 0.0f ? 1.0f / extent2 : 0.0f;
+  float inv_axis_len = axis_len2 > 0.0f ? 1.0f / sqrtf(axis_len2) : 0.0f;
+  for (int c = 0; c < 3; c++)
+  {
+    focus.axis[c] = b->normal_sum[c] * inv_axis_len;
+  }
+
+  uint32_t best = MESHLET_NONE;
+  uint32_t best_extra = MESHLET_MAX_VERTICES - b->vert_count;
+  float best_score = FLT_MAX;
+  for (uint32_t i = 0; i < b->vert_count; i++)
+  {
+    uint32_t v = b->verts[i];
+    const uint32_t *tris = b->adjacency + b->offsets[v];
+    for (uint32_t k = 0; k < b->live[v]; k++)
+    {
+      uint32_t extra = new_vertices(b, tris[k]);
+      if (extra > best_extra)
+      {
+        continue;
+      }
+      float score = triangle_score(b, &focus, tris[k]);
+      if (extra < best_extra || score < best_score)
+      {
+        best_extra = extra;
+        best_score = score;
+        best = tris[k];
+      }
+    }
+  }
+  return best;
+}
+
+/* A triangle next to or near the meshlet just flushed, or the first left. */
+static uint32_t next_seed(MeshletBuilder *b)
+{
+  if (b->meshlet_count > 0)
+  {
+    const Meshlet *last = &b->meshlets[b->meshlet_count - 1];
+    for (uint32_t i = 0; i < last->vertex_count; i++)
+    {
+      uint32_t v = b->out_verts[last->vertex_offset + i];
+      if (b->live[v] > 0)
+      {
+        return b->adjacency[b->offsets[v]];
+      }
+    }
+    uint32_t near = nearest_candidate(b, last->center, 3);
+    if (near != MESHLET_NONE)
+    {
+      return near;
+    }
+  }
+
+  for (; b->cursor < b->tri_count; b->cursor++)
+  {
+    if (b->live[b->indices[b->cursor * 3]] == 0)
+    {
+      continue;
+    }
+    /* The first vertex has triangles left, see if this is one of them. */
+    uint32_t v = b->indices[b->cursor * 3];
+    const uint32_t *tris = b->adjacency + b->offsets[v];
+    for (uint32_t k = 0; k < b->live[v]; k++)
+    {
+      if (tris[k] == b->cursor)
+      {
+        return (uint32_t) b->cursor;
+      }
+    }
+  }
+  return MESHLET_NONE;
+}
+
+/*
+ * The triangle left closest to `center` that adds at most `max_extra`
+ * vertices, for when none shares a vertex with the meshlet.  Cells are
+ * searched in shells around the center's, up to MESHLET_SEARCH_CELLS out,
+ * and the first shell holding a fit wins.
+ */
+static uint32_t nearest_candidate(const MeshletBuilder *b,
+                                  const float *center, uint32_t max_extra)
+{
+  int cell[3];
+  for (int c = 0; c < 3; c++)
+  {
+    cell[c] = (int) grid_cell(b, center, c);
+  }
+
+  uint32_t best = MESHLET_NONE;
+  float best_dist2 = FLT_MAX;
+  int size = (int) b->grid_size;
+  for (int r = 0; r <= MESHLET_SEARCH_CELLS && best == MESHLET_NONE; r++)
+  {
+    for (int z = cell[2] - r; z <= cell[2] + r; z++)
+    {
+      for (int y = cell[1] - r; y <= cell[1] + r; y++)
+      {
+        for (int x = cell[0] - r; x <= cell[0] + r; x++)
+        {
+          bool on_shell = abs(x - cell[0]) == r || abs(y - cell[1]) == r ||
+            abs(z - cell[2]) == r;
+          if (!on_shell || x < 0 || y < 0 || z < 0 || x >= size ||
+              y >= size || z >= size)
+          {
+            continue;
+          }
+          size_t index = ((size_t) z * b->grid_size + (size_t) y) *
+            b->grid_size + (size_t) x;
+          const uint32_t *tris = b->cell_tris + b->cell_offsets[index];
+          for (uint32_t k = 0; k < b->cell_live[index]; k++)
+          {
+            if (new_vertices(b, tris[k]) > max_extra)
+            {
+              continue;
+            }
+            const float *centroid = &b->centroids[(size_t) tris[k] * 3];
+            float dist2 = 0.0f;
+            for (int c = 0; c < 3; c++)
+            {
+              float d = centroid[c] - center[c];
+              dist2 += d * d;
+            }
+            if (dist2 < best_dist2)
+            {
+              best_dist2 = dist2;
+              best = tris[k];
+            }
+          }
+        }
+      }
+    }
+  }
+  return best;
+}
+
+/* Buckets the triangles by centroid into about MESHLET_CELL_TRIANGLES each. */
+static bool grid_init(MeshletBuilder *b)
+{
+  size_t cells = b->tri_count / MESHLET_CELL_TRIANGLES + 1;
+  b->grid_size = (uint32_t) ceilf(cbrtf((float) cells));
+  size_t cell_count = (size_t) b->grid_size * b->grid_size * b->grid_size;
+  b->cell_offsets = MIUR_ARR_UNINIT(uint32_t, cell_count);
+  b->cell_live = MIUR_ARR(uint32_t, cell_count);
+  b->cell_tris = MIUR_ARR_UNINIT(uint32_t, b->tri_count);
+  if (b->cell_offsets == NULL || b->cell_live == NULL ||
+      b->cell_tris == NULL)
+  {
+    return false;
+  }
+
+  float grid_max[3];
+  for (int c = 0; c < 3; c++)
+  {
+    b->grid_min[c] = FLT_MAX;
+    grid_max[c] = -FLT_MAX;
+  }
+  for (size_t t = 0; t < b->tri_count; t++)
+  {
+    for (int c = 0; c < 3; c++)
+    {
+      float p = b->centroids[t * 3 + c];
+      b->grid_min[c] = p < b->grid_min[c] ? p : b->grid_min[c];
+      grid_max[c] = p > grid_max[c] ? p : grid_max[c];
+    }
+  }
+  for (int c = 0; c < 3; c++)
+  {
+    float extent = grid_max[c] - b->grid_min[c];
+    b->grid_scale[c] = extent > 0.0f ? (float) b->grid_size / extent : 0.0f;
+  }
+
+  /* Counted into cell_live first, the same way as the adjacency. */
+  for (size_t t = 0; t < b->tri_count; t++)
+  {
+    b->cell_live[grid_index(b, &b->centroids[t * 3])]++;
+  }
+  uint32_t offset = 0;
+  for (size_t i = 0; i < cell_count; i++)
+  {
+    b->cell_offsets[i] = offset;
+    offset += b->cell_live[i];
+    b->cell_live[i] = 0;
+  }
+  for (size_t t = 0; t < b->tri_count; t++)
+  {
+    size_t index = grid_index(b, &b->centroids[t * 3]);
+    b->cell_tris[b->cell_offsets[index] + b->cell_live[index]++] =
+      (uint32_t) t;
+  }
+  return true;
+}
+
+static size_t grid_index(const MeshletBuilder *b, const float *p)
+{
+  return ((size_t) grid_cell(b, p, 2) * b->grid_size + grid_cell(b, p, 1)) *
+    b->grid_size + grid_cell(b, p, 0);
+}
+
+static uint32_t grid_cell(const MeshletBuilder *b, const float *p, int axis)
+{
+  float cell = (p[axis] - b->grid_min[axis]) * b->grid_scale[axis];
+  if (!(cell > 0.0f))
+  {
+    return 0;
+  }
+  return cell < (float) b->grid_size ? (uint32_t) cell : b->grid_size - 1;
+}
+
+static void add_triangle(MeshletBuilder *b, uint32_t tri)
+{
+  const uint32_t *v = &b->indices[(size_t) tri * 3];
+  for (int c = 0; c < 3; c++)
+  {
+    if (b->local[v[c]] == MESHLET_NOT_LOCAL)
+    {
+      const float *p = vertex_position(b, v[c]);
+      for (int k = 0; k < 3; k++)
+      {
+        b->box_min[k] = b->vert_count == 0 || p[k] < b->box_min[k] ?
+          p[k] : b->box_min[k];
+        b->box_max[k] = b->vert_count == 0 || p[k] > b->box_max[k] ?
+          p[k] : b->box_max[k];
+      }
+      b->local[v[c]] = (uint8_t) b->vert_count;
+      b->verts[b->vert_count++] = v[c];
+    }
+
+    /* Swap the triangle out of the vertex's live ones. */
+    uint32_t *tris = b->adjacency + b->offsets[v[c]];
+    for (uint32_t k = 0; k < b->live[v[c]]; k++)
+    {
+      if (tris[k] == tri)
+      {
+        tris[k] = tris[--b->live[v[c]]];
+        break;
+      }
+    }
+  }
+
+  for (int c = 0; c < 3; c++)
+  {
+    b->centroid_sum[c] += b->centroids[(size_t) tri * 3 + c];
+    b->normal_sum[c] += b->normals[(size_t) tri * 3 + c];
+  }
+  size_t index = grid_index(b, &b->centroids[(size_t) tri * 3]);
+  uint32_t *cell = b->cell_tris + b->cell_offsets[index];
+  for (uint32_t k = 0; k < b->cell_live[index]; k++)
+  {
+    if (cell[k] == tri)
+    {
+      cell[k] = cell[--b->cell_live[index]];
+      break;
+    }
+  }
+  b->tris[b->tri_count_current++] = tri;
+}
+
+static void flush_meshlet(MeshletBuilder *b)
+{
+  Meshlet *meshlet = &b->meshlets[b->meshlet_count++];
+  meshlet->vertex_offset = b->out_vert_count;
+  meshlet->triangle_offset = b->out_tri_size;
+  meshlet->vertex_count = b->vert_count;
+  meshlet->triangle_count = b->tri_count_current;
+  meshlet->reserved = 0;
+  compute_sphere(b, meshlet);
+  compute_cone(b, meshlet);
+
+  memcpy(b->out_verts + b->out_vert_count, b->verts,
+         sizeof(uint32_t) * b->vert_count);
+  b->out_vert_count += b->vert_count;
+  uint8_t *out = b->out_tris + b->out_tri_size;
+  for (uint32_t t = 0; t < b->tri_count_current; t++)
+  {
+    const uint32_t *v = &b->indices[(size_t) b->tris[t] * 3];
+    for (int c = 0; c < 3; c++)
+    {
+      *out++ = b->local[v[c]];
+    }
+  }
+  uint32_t size = b->tri_count_current * 3;
+  for (; size % 4 != 0; size++)
+  {
+    *out++ = 0;
+  }
+  b->out_tri_size += size;
+
+  for (uint32_t i = 0; i < b->vert_count; i++)
+  {
+    b->local[b->verts[i]] = MESHLET_NOT_LOCAL;
+  }
+  b->vert_count = 0;
+  b->tri_count_current = 0;
+  memset(b->centroid_sum, 0, sizeof(b->centroid_sum));
+  memset(b->normal_sum, 0, sizeof(b->normal_sum));
+}
+
+/* Ritter's sphere, within a few percent of the smallest one. */
+static void compute_sphere(const MeshletBuilder *b, Meshlet *meshlet)
+{
+  /* Start from the pair of axis extremes that lie furthest apart. */
+  uint32_t lo[3] = { 0, 0, 0 }, hi[3] = { 0, 0, 0 };
+  for (uint32_t i = 1; i < b->vert_count; i++)
+  {
+    const float *p = vertex_position(b, b->verts[i]);
+    for (int c = 0; c < 3; c++)
+    {
+      lo[c] = p[c] < vertex_position(b, b->verts[lo[c]])[c] ? i : lo[c];
+      hi[c] = p[c] > vertex_position(b, b->verts[hi[c]])[c] ? i : hi[c];
+    }
+  }
+  float best2 = -1.0f;
+  const float *pa = NULL, *pb = NULL;
+  for (int c = 0; c < 3; c++)
+  {
+    const float *a = vertex_position(b, b->verts[lo[c]]);
+    const float *z = vertex_position(b, b->verts[hi[c]]);
+    float d2 = (z[0] - a[0]) * (z[0] - a[0]) + (z[1] - a[1]) * (z[1] - a[1]) +
+      (z[2] - a[2]) * (z[2] - a[2]);
+    if (d2 > best2)
+    {
+      best2 = d2;
+      pa = a;
+      pb = z;
+    }
+  }
+
+  float radius = sqrtf(best2) * 0.5f;
+  float *center = meshlet->center;
+  for (int c = 0; c < 3; c++)
+  {
+    center[c] = (pa[c] + pb[c]) * 0.5f;
+  }
+
+  /* Grow it just enough to take in each point outside. */
+  for (uint32_t i = 0; i < b->vert_count; i++)
+  {
+    const float *p = vertex_position(b, b->verts[i]);
+    float d[3] = { p[0] - center[0], p[1] - center[1], p[2] - center[2] };
+    float dist = sqrtf(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    if (dist > radius)
+    {
+      float grow = (dist - radius) * 0.5f;
+      radius += grow;
+      for (int c = 0; c < 3; c++)
+      {
+        center[c] += d[c] * (grow / dist);
+      }
+    }
+  }
+  meshlet->radius = radius;
+}
+
+/*
+ * The axis is the average normal and the cone holds every normal.  The apex
+ * sits behind all the triangle planes along the axis, so the test is exact
+ * from any viewpoint rather than only far away.
+ */
+static void compute_cone(const MeshletBuilder *b, Meshlet *meshlet)
+{
+  float axis[3], len2 = 0.0f;
+  for (int c = 0; c < 3; c++)
+  {
+    axis[c] = b->normal_sum[c];
+    len2 += axis[c] * axis[c];
+  }
+
+  float min_dot = 1.0f;
+  float len = sqrtf(len2);
+  for (uint32_t t = 0; len > 0.0f && t < b->tri_count_current; t++)
+  {
+    const float *n = &b->normals[(size_t) b->tris[t] * 3];
+    float dot = (n[0] * axis[0] + n[1] * axis[1] + n[2] * axis[2]) / len;
+    min_dot = dot < min_dot ? dot : min_dot;
+  }
+
+  /* Past a hemisphere no view direction sees only back faces. */
+  if (len == 0.0f || min_dot <= 0.0f)
+  {
+    memcpy(meshlet->cone_apex, meshlet->center, sizeof(float) * 3);
+    memset(meshlet->cone_axis, 0, sizeof(float) * 3);
+    meshlet->cone_cutoff = 1.0f;
+    return;
+  }
+
+  for (int c = 0; c < 3; c++)
+  {
+    axis[c] /= len;
+  }
+  float max_t = 0.0f;
+  for (uint32_t t = 0; t < b->tri_count_current; t++)
+  {
+    const float *n = &b->normals[(size_t) b->tris[t] * 3];
+    const float *p = vertex_position(b, b->indices[(size_t) b->tris[t] * 3]);
+    float along = n[0] * axis[0] + n[1] * axis[1] + n[2] * axis[2];
+    if (along <= 0.0f)
+    {
+      continue;
+    }
+    float dist = (meshlet->center[0] - p[0]) * n[0] +
+      (meshlet->center[1] - p[1]) * n[1] + (meshlet->center[2] - p[2]) * n[2];
+    float t_plane = dist / along;
+    max_t = t_plane > max_t ? t_plane : max_t;
+  }
+
+  for (int c = 0; c < 3; c++)
+  {
+    meshlet->cone_apex[c] = meshlet->center[c] - axis[c] * max_t;
+    meshlet->cone_axis[c] = axis[c];
+  }
+  meshlet->cone_cutoff = sqrtf(1.0f - min_dot * min_dot);
+}
+
+static const float *vertex_position(const MeshletBuilder *b, uint32_t v)
+{
+  return &b->positions[(size_t) v * 3];
+}
+
+/* Rotates the smallest index first, which keeps the winding. */
+static TriangleKey triangle_key(uint32_t a, uint32_t b, uint32_t c)
+{
+  TriangleKey key;
+  if (a <= b && a <= c)
+  {
+    key = (TriangleKey) { { a, b, c } };
+  }
+  else if (b <= a && b <= c)
+  {
+    key = (TriangleKey) { { b, c, a } };
+  }
+  else
+  {
+    key = (TriangleKey) { { c, a, b } };
+  }
+  return key;
+}
+
+static int compare_triangle_keys(const void *a, const void *b)
+{
+  const TriangleKey *ka = (const TriangleKey *) a;
+  const TriangleKey *kb = (const TriangleKey *) b;
+  for (int i = 0; i < 3; i++)
+  {
+    if (ka->v[i] != kb->v[i])
+    {
+      return ka->v[i] < kb->v[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
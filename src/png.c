@@ -0,0 +1,555 @@
+/* =====================
+ * src/png.c
+ * 10/18/2026
+ * PNG decoding.
+ * ====================
+ */
+
+#include <string.h>
+
+#include <miur/image_priv.h>
+#include <miur/inflate.h>
+#include <miur/log.h>
+#include <miur/mem.h>
+
+#define PNG_SIGNATURE_SIZE 8
+#define PNG_CHUNK_OVERHEAD 12          /* Length, type and CRC. */
+#define PNG_CHUNK(a, b, c, d)                                                  \
+  ((uint32_t) (a) << 24 | (uint32_t) (b) << 16 | (uint32_t) (c) << 8 |        \
+   (uint32_t) (d))
+#define PNG_IHDR PNG_CHUNK('I', 'H', 'D', 'R')
+#define PNG_PLTE PNG_CHUNK('P', 'L', 'T', 'E')
+#define PNG_TRNS PNG_CHUNK('t', 'R', 'N', 'S')
+#define PNG_IDAT PNG_CHUNK('I', 'D', 'A', 'T')
+#define PNG_IEND PNG_CHUNK('I', 'E', 'N', 'D')
+#define PNG_ADAM7_PASSES 7
+
+typedef enum
+{
+  PNG_GRAY = 0,
+  PNG_RGB = 2,
+  PNG_PALETTE = 3,
+  PNG_GRAY_ALPHA = 4,
+  PNG_RGBA = 6,
+} PngColorType;
+
+typedef struct
+{
+  uint32_t width, height;
+  uint32_t depth;
+  PngColorType color_type;
+  bool interlaced;
+  uint32_t channels;
+
+  uint8_t palette[256][4];
+  uint32_t palette_count;
+  /* tRNS for gray and RGB, samples equal to the key are transparent. */
+  bool has_key;
+  uint16_t key[3];
+} PngHeader;
+
+/* === PROTOTYPES === */
+
+static bool parse_header(PngHeader *png, const uint8_t *data, uint32_t size);
+static bool parse_transparency(PngHeader *png, const uint8_t *data,
+                               uint32_t size);
+static bool gather_idat(const uint8_t *data, size_t size,
+                        const uint8_t **idat_out, size_t *idat_size_out,
+                        uint8_t **copy_out);
+static size_t row_bytes(const PngHeader *png, uint32_t width);
+static bool decode_pass(const PngHeader *png, uint8_t *filtered,
+                        uint32_t width, uint32_t height, Image *out,
+                        uint32_t x0, uint32_t y0, uint32_t dx, uint32_t dy);
+static bool unfilter_row(uint8_t *row, const uint8_t *prev, size_t size,
+                         uint32_t bpp, uint8_t filter);
+static void expand_row(const PngHeader *png, const uint8_t *src,
+                       uint8_t *dst, uint32_t width, uint32_t dx);
+static uint32_t read_sample(const uint8_t *row, size_t index, uint32_t depth);
+static uint32_t read_be32(const uint8_t *p);
+
+/* === GLOBALS === */
+
+static const uint8_t adam7_x0[PNG_ADAM7_PASSES] = { 0, 4, 0, 2, 0, 1, 0 };
+static const uint8_t adam7_y0[PNG_ADAM7_PASSES] = { 0, 0, 4, 0, 2, 0, 1 };
+static const uint8_t adam7_dx[PNG_ADAM7_PASSES] = { 8, 8, 4, 4, 2, 2, 1 };
+static const uint8_t adam7_dy[PNG_ADAM7_PASSES] = { 8, 8, 8, 4, 4, 2, 2 };
+
+/* === PUBLIC FUNCTIONS === */
+
+bool png_decode(Image *out, const uint8_t *data, size_t size)
+{
+  PngHeader png = { 0 };
+  const uint8_t *idat;
+  size_t idat_size;
+  uint8_t *idat_copy = NULL;
+  uint8_t *filtered = NULL;
+  bool result = false;
+
+  /* IHDR has to come first. */
+  if (size < PNG_SIGNATURE_SIZE + PNG_CHUNK_OVERHEAD + 13 ||
+      read_be32(data + 12) != PNG_IHDR ||
+      !parse_header(&png, data + 16, read_be32(data + 8)))
+  {
+    MIUR_LOG_ERR("Invalid PNG header");
+    return false;
+  }
+
+  for (size_t offset = PNG_SIGNATURE_SIZE;
+       size - offset >= PNG_CHUNK_OVERHEAD;)
+  {
+    uint32_t length = read_be32(data + offset);
+    uint32_t type = read_be32(data + offset + 4);
+    const uint8_t *body = data + offset + 8;
+    if (length > size - offset - PNG_CHUNK_OVERHEAD)
+    {
+      MIUR_LOG_ERR("Truncated PNG chunk");
+      return false;
+    }
+    if (type == PNG_PLTE)
+    {
+      if (length % 3 != 0 || length > 256 * 3)
+      {
+        MIUR_LOG_ERR("Invalid PNG palette");
+        return false;
+      }
+      png.palette_count = length / 3;
+      for (uint32_t i = 0; i < png.palette_count; i++)
+      {
+        memcpy(png.palette[i], body + i * 3, 3);
+        png.palette[i][3] = 255;
+      }
+    } else if (type == PNG_TRNS)
+    {
+      if (!parse_transparency(&png, body, length))
+      {
+        MIUR_LOG_ERR("Invalid PNG transparency");
+        return false;
+      }
+    } else if (type == PNG_IEND)
+    {
+      break;
+    }
+    offset += (size_t) length + PNG_CHUNK_OVERHEAD;
+  }
+
+  if (png.color_type == PNG_PALETTE && png.palette_count == 0)
+  {
+    MIUR_LOG_ERR("PNG has no palette");
+    return false;
+  }
+  if (!gather_idat(data, size, &idat, &idat_size, &idat_copy))
+  {
+    MIUR_LOG_ERR("PNG has no image data");
+    return false;
+  }
+
+  if (!image_alloc(out, png.width, png.height))
+  {
+    goto cleanup;
+  }
+
+  /* Every pass is a small image of its own, rows start with a filter. */
+  size_t filtered_size = 0;
+  for (uint32_t pass = 0; pass < PNG_ADAM7_PASSES; pass++)
+  {
+    uint32_t x0 = png.interlaced ? adam7_x0[pass] : 0;
+    uint32_t y0 = png.interlaced ? adam7_y0[pass] : 0;
+    uint32_t dx = png.interlaced ? adam7_dx[pass] : 1;
+    uint32_t dy = png.interlaced ? adam7_dy[pass] : 1;
+    if (png.width > x0 && png.height > y0)
+    {
+      filtered_size += ((png.height - y0 + dy - 1) / dy) *
+        (1 + row_bytes(&png, (png.width - x0 + dx - 1) / dx));
+    }
+    if (!png.interlaced)
+    {
+      break;
+    }
+  }
+
+  filtered = MIUR_ARR_UNINIT(uint8_t, filtered_size);
+  if (filtered == NULL)
+  {
+    goto cleanup;
+  }
+  if (!inflate_zlib(idat, idat_size, filtered, filtered_size))
+  {
+    MIUR_LOG_ERR("Corrupt PNG image data");
+    goto cleanup;
+  }
+
+  uint8_t *pass_data = filtered;
+  for (uint32_t pass = 0; pass < PNG_ADAM7_PASSES; pass++)
+  {
+    uint32_t x0 = png.interlaced ? adam7_x0[pass] : 0;
+    uint32_t y0 = png.interlaced ? adam7_y0[pass] : 0;
+    uint32_t dx = png.interlaced ? adam7_dx[pass] : 1;
+    uint32_t dy = png.interlaced ? adam7_dy[pass] : 1;
+    if (png.width > x0 && png.height > y0)
+    {
+      uint32_t width = (png.width - x0 + dx - 1) / dx;
+      uint32_t height = (png.height - y0 + dy - 1) / dy;
+      if (!decode_pass(&png, pass_data, width, height, out, x0, y0, dx, dy))
+      {
+        MIUR_LOG_ERR("Invalid PNG row filter");
+        goto cleanup;
+      }
+      pass_data += height * (1 + row_bytes(&png, width));
+    }
+    if (!png.interlaced)
+    {
+      break;
+    }
+  }
+  result = true;
+
+cleanup:
+  MIUR_FREE(idat_copy);
+  MIUR_FREE(filtered);
+  return result;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static bool parse_header(PngHeader *png, const uint8_t *data, uint32_t size)
+{
+  if (size != 13)
+  {
+    return false;
+  }
+  png->width = read_be32(data);
+  png->height = read_be32(data + 4);
+  png->depth = data[8];
+  png->color_type = (PngColorType) data[9];
+  png->interlaced = data[12] == 1;
+  /* Deflate, adaptive filtering and no or Adam7 interlacing. */
+  if (data[10] != 0 || data[11] != 0 || data[12] > 1)
+  {
+    return false;
+  }
+
+  uint32_t depth = png->depth;
+  bool byte_depth = depth == 8 || depth == 16;
+  bool bit_depth = depth == 1 || depth == 2 || depth == 4;
+  switch (png->color_type)
+  {
+  case PNG_GRAY:
+    png->channels = 1;
+    return byte_depth || bit_depth;
+  case PNG_RGB:
+    png->channels = 3;
+    return byte_depth;
+  case PNG_PALETTE:
+    png->channels = 1;
+    return depth == 8 || bit_depth;
+  case PNG_GRAY_ALPHA:
+    png->channels = 2;
+    return byte_depth;
+  case PNG_RGBA:
+    png->channels = 4;
+    return byte_depth;
+  }
+  return false;
+}
+
+static bool parse_transparency(PngHeader *png, const uint8_t *data,
+                               uint32_t size)
+{
+  switch (png->color_type)
+  {
+  case PNG_PALETTE:
+    if (size > png->palette_count)
+    {
+      return false;
+    }
+    for (uint32_t i = 0; i < size; i++)
+    {
+      png->palette[i][3] = data[i];
+    }
+    return true;
+  case PNG_GRAY:
+  case PNG_RGB:
+    if (size != png->channels * 2)
+    {
+      return false;
+    }
+    for (uint32_t i = 0; i < png->channels; i++)
+    {
+      png->key[i] = (uint16_t) (data[i * 2] << 8 | data[i * 2 + 1]);
+    }
+    png->has_key = true;
+    return true;
+  default:
+    /* Only allowed without an alpha channel. */
+    return false;
+  }
+}
+
+/*
+ * The zlib stream may be split over any number of IDAT chunks.  A single
+ * one is inflated in place, several are joined into `copy_out` first.
+ */
+static bool gather_idat(const uint8_t *data, size_t size,
+                        const uint8_t **idat_out, size_t *idat_size_out,
+                        uint8_t **copy_out)
+{
+  size_t total = 0;
+  uint32_t count = 0;
+  const uint8_t *first = NULL;
+  for (size_t offset = PNG_SIGNATURE_SIZE;
+       size - offset >= PNG_CHUNK_OVERHEAD;)
+  {
+    uint32_t length = read_be32(data + offset);
+    uint32_t type = read_be32(data + offset + 4);
+    if (length > size - offset - PNG_CHUNK_OVERHEAD || type == PNG_IEND)
+    {
+      break;
+    }
+    if (type == PNG_IDAT)
+    {
+      first = first != NULL ? first : data + offset + 8;
+      total += length;
+      count++;
+    }
+    offset += (size_t) length + PNG_CHUNK_OVERHEAD;
+  }
+  if (count == 0)
+  {
+    return false;
+  }
+  if (count == 1)
+  {
+    *idat_out = first;
+    *idat_size_out = total;
+    return true;
+  }
+
+  uint8_t *copy = MIUR_ARR_UNINIT(uint8_t, total);
+  if (copy == NULL)
+  {
+    return false;
+  }
+  size_t copied = 0;
+  for (size_t offset = PNG_SIGNATURE_SIZE; copied < total;)
+  {
+    uint32_t length = read_be32(data + offset);
+    if (read_be32(data + offset + 4) == PNG_IDAT)
+    {
+      memcpy(copy + copied, data + offset + 8, length);
+      copied += length;
+    }
+    offset += (size_t) length + PNG_CHUNK_OVERHEAD;
+  }
+  *copy_out = copy;
+  *idat_out = copy;
+  *idat_size_out = total;
+  return true;
+}
+
+static size_t row_bytes(const PngHeader *png, uint32_t width)
+{
+  return ((size_t) width * png->channels * png->depth + 7) / 8;
+}
+
+/* Unfilters a pass in place and writes every dx-th pixel of every dy-th row. */
+static bool decode_pass(const PngHeader *png, uint8_t *filtered,
+                        uint32_t width, uint32_t height, Image *out,
+                        uint32_t x0, uint32_t y0, uint32_t dx, uint32_t dy)
+{
+  size_t size = row_bytes(png, width);
+  /* Filters look at the byte of the previous pixel, at least one back. */
+  uint32_t bpp = (png->channels * png->depth + 7) / 8;
+  const uint8_t *prev = NULL;
+  for (uint32_t y = 0; y < height; y++)
+  {
+    uint8_t *row = filtered + y * (size + 1);
+    if (!unfilter_row(row + 1, prev, size, bpp, row[0]))
+    {
+      return false;
+    }
+    uint8_t *dst = out->pixels +
+      (((size_t) (y0 + y * dy) * out->width) + x0) * 4;
+    expand_row(png, row + 1, dst, width, dx);
+    prev = row + 1;
+  }
+  return true;
+}
+
+/* The row before the first is all zeroes, `prev` is NULL for it. */
+static bool unfilter_row(uint8_t *row, const uint8_t *prev, size_t size,
+                         uint32_t bpp, uint8_t filter)
+{
+  size_t i;
+  switch (filter)
+  {
+  case 0:
+    break;
+  case 1:
+    for (i = bpp; i < size; i++)
+    {
+      row[i] = (uint8_t) (row[i] + row[i - bpp]);
+    }
+    break;
+  case 2:
+    for (i = 0; prev != NULL && i < size; i++)
+    {
+      row[i] = (uint8_t) (row[i] + prev[i]);
+    }
+    break;
+  case 3:
+    for (i = 0; i < bpp && i < size; i++)
+    {
+      row[i] = (uint8_t) (row[i] + (prev != NULL ? prev[i] >> 1 : 0));
+    }
+    for (; i < size; i++)
+    {
+      uint32_t up = prev != NULL ? prev[i] : 0;
+      row[i] = (uint8_t) (row[i] + ((row[i - bpp] + up) >> 1));
+    }
+    break;
+  case 4:
+    if (prev == NULL)
+    {
+      /* Paeth against a zero row always picks the left byte. */
+      for (i = bpp; i < size; i++)
+      {
+        row[i] = (uint8_t) (row[i] + row[i - bpp]);
+      }
+      break;
+    }
+    for (i = 0; i < bpp && i < size; i++)
+    {
+      row[i] = (uint8_t) (row[i] + prev[i]);
+    }
+    for (; i < size; i++)
+    {
+      int a = row[i - bpp], b = prev[i], c = prev[i - bpp];
+      int p = a + b - c;
+      int pa = p > a ? p - a : a - p;
+      int pb = p > b ? p - b : b - p;
+      int pc = p > c ? p - c : c - p;
+      int pred = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+      row[i] = (uint8_t) (row[i] + pred);
+    }
+    break;
+  default:
+    return false;
+  }
+  return true;
+}
+
+static void expand_row(const PngHeader *png, const uint8_t *src,
+                       uint8_t *dst, uint32_t width, uint32_t dx)
+{
+  size_t step = (size_t) dx * 4;
+  uint32_t depth = png->depth;
+
+  /* The common 8 bit layouts first. */
+  if (depth == 8 && png->color_type == PNG_RGBA)
+  {
+    if (dx == 1)
+    {
+      memcpy(dst, src, (size_t) width * 4);
+      return;
+    }
+    for (uint32_t x = 0; x < width; x++, dst += step, src += 4)
+    {
+      memcpy(dst, src, 4);
+    }
+    return;
+  }
+  if (depth == 8 && png->color_type == PNG_RGB && !png->has_key)
+  {
+    for (uint32_t x = 0; x < width; x++, dst += step, src += 3)
+    {
+      dst[0] = src[0];
+      dst[1] = src[1];
+      dst[2] = src[2];
+      dst[3] = 255;
+    }
+    return;
+  }
+  if (depth == 8 && png->color_type == PNG_PALETTE)
+  {
+    for (uint32_t x = 0; x < width; x++, dst += step)
+    {
+      /* Indices past the palette are an error, treated as black. */
+      uint8_t index = src[x];
+      if (index < png->palette_count)
+      {
+        memcpy(dst, png->palette[index], 4);
+      } else
+      {
+        memset(dst, 0, 3);
+        dst[3] = 255;
+      }
+    }
+    return;
+  }
+
+  uint32_t channels = png->channels;
+  uint32_t max = (1u << depth) - 1;
+  for (uint32_t x = 0; x < width; x++, dst += step)
+  {
+    uint32_t samples[4];
+    uint8_t bytes[4];
+    for (uint32_t c = 0; c < channels; c++)
+    {
+      samples[c] = read_sample(src, (size_t) x * channels + c, depth);
+      bytes[c] = depth == 16 ? (uint8_t) (samples[c] >> 8) :
+        (uint8_t) (samples[c] * 255 / max);
+    }
+
+    switch (png->color_type)
+    {
+    case PNG_GRAY:
+      dst[0] = dst[1] = dst[2] = bytes[0];
+      dst[3] = png->has_key && samples[0] == png->key[0] ? 0 : 255;
+      break;
+    case PNG_RGB:
+      memcpy(dst, bytes, 3);
+      dst[3] = png->has_key && samples[0] == png->key[0] &&
+        samples[1] == png->key[1] && samples[2] == png->key[2] ? 0 : 255;
+      break;
+    case PNG_PALETTE:
+      if (samples[0] < png->palette_count)
+      {
+        memcpy(dst, png->palette[samples[0]], 4);
+      } else
+      {
+        memset(dst, 0, 3);
+        dst[3] = 255;
+      }
+      break;
+    case PNG_GRAY_ALPHA:
+      dst[0] = dst[1] = dst[2] = bytes[0];
+      dst[3] = bytes[1];
+      break;
+    case PNG_RGBA:
+      memcpy(dst, bytes, 4);
+      break;
+    }
+  }
+}
+
+/* Samples under 8 bits are packed from the most significant bit down. */
+static uint32_t read_sample(const uint8_t *row, size_t index, uint32_t depth)
+{
+  if (depth == 8)
+  {
+    return row[index];
+  }
+  if (depth == 16)
+  {
+    return (uint32_t) row[index * 2] << 8 | row[index * 2 + 1];
+  }
+  size_t bit = index * depth;
+  return (uint32_t) (row[bit >> 3] >> (8 - depth - (bit & 7))) &
+    ((1u << depth) - 1);
+}
+
+static uint32_t read_be32(const uint8_t *p)
+{
+  return (uint32_t) p[0] << 24 | (uint32_t) p[1] << 16 |
+    (uint32_t) p[2] << 8 | (uint32_t) p[3];
+}
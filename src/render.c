@@ -6,8 +6,11 @@
  */
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <inttypes.h>
+#include <string.h>
 
+#include <miur/archive.h>
 #include <miur/membuf.h>
 #include <miur/bsl.h>
 #include <miur/mem.h>
@@ -15,6 +18,8 @@
 #include <miur/render.h>
 #include <miur/render_priv.h>
 #include <miur/device.h>
+#include <miur/convert.h>
+#include <miur/mesh_opt.h>
 
 /* === PROTOTYPES === */
 
@@ -24,22 +29,33 @@ bool create_buffer(Renderer *render, VkDeviceSize size,
                    VkBufferUsageFlagBits bits,
                    VkMemoryPropertyFlagBits properties, VkBuffer *buffer,
                    VkDeviceMemory *memory);
+static Technique *prepare_static_mesh(Renderer *render, StaticMesh *mesh);
+static void write_vertex_binding(void *dst, const Technique *tech,
+                                 const StaticMesh *mesh, uint32_t binding);
+static VkDeviceSize index_buffer_size(const StaticMesh *mesh);
+static void write_indices(void *dst, const StaticMesh *mesh);
+static bool find_memory_type(Renderer *render, uint32_t type_bits,
+                             VkMemoryPropertyFlags properties,
+                             uint32_t *type_out);
+static VkFormat texture_vk_format(TextureFormat format);
+static bool begin_upload(Renderer *render, RendererUpload *upload);
+static bool submit_upload(Renderer *render, RendererUpload *upload);
+static void release_upload(Renderer *render, RendererUpload *upload);
+static bool load_techniques(Renderer *render, const char *filename);
+static bool load_effects(Renderer *render, const char *filename);
 
 /* === PUBLIC FUNCTIONS === */
 
 void draw_triangle_callback(void *ud, VkCommandBuffer *buffer)
 {
   Renderer *render = (Renderer *) ud;
-  StaticMesh *mesh = render->mesh;
-  MIUR_LOG_INFO("%zu", mesh->index_count);
-  Material *mat = mesh->material;
-  Effect *effect = mat->effect;
-  Technique *tech = effect->techniques.forward;
-  vkCmdBindPipeline(*buffer,
-      VK_PIPELINE_BIND_POINT_GRAPHICS,
-      tech->pipeline);
-
-  VkDeviceSize offsets[] = {0, 0};
+  StaticModel *model = render->model;
+  /* Nothing streamed in yet. */
+  if (model == NULL)
+  {
+    return;
+  }
+
   VkViewport viewport = {
     .x = 0,
     .y = 0,
@@ -57,8 +73,45 @@ void draw_triangle_callback(void *ud, VkCommandBuffer *buffer)
   vkCmdSetViewport(*buffer, 0, 1, &viewport);
   vkCmdSetScissor(*buffer, 0, 1, &scissor);
 
-  vkCmdBindVertexBuffers(*buffer, 0, 2, mesh->vert_bufs, offsets);
-  vkCmdDraw(*buffer, 6, 1, 0, 0);
+  /* Instances share meshes, only rebind what changed since the last one. */
+  const Technique *bound_tech = NULL;
+  const StaticMesh *bound_mesh = NULL;
+  VkDeviceSize offsets[VERTEX_ATTRIBUTE_COUNT] = {0};
+  for (uint32_t i = 0; i < model->instance_count; i++)
+  {
+    const MeshInstance *instance = &model->instances[i];
+    StaticMesh *mesh = &model->meshes[instance->mesh];
+    Technique *tech = mesh->material->effect->techniques.forward;
+    if (tech != bound_tech)
+    {
+      vkCmdBindPipeline(*buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                        tech->pipeline);
+      bound_tech = tech;
+    }
+
+    DrawConstants constants;
+    uint32_t constants_size = offsetof(DrawConstants, quantization);
+    memcpy(constants.model, &model->node_world[(size_t) instance->node * 16],
+           sizeof(constants.model));
+    if (tech->vertex_format == VERTEX_FORMAT_QUANTIZED)
+    {
+      constants.quantization = mesh->quantization;
+      constants_size = sizeof(DrawConstants);
+    }
+    vkCmdPushConstants(*buffer, tech->layout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                       constants_size, &constants);
+
+    if (mesh != bound_mesh)
+    {
+      vkCmdBindVertexBuffers(*buffer, 0,
+                             vertex_layout_binding_count(tech->vertex_layout),
+                             mesh->vert_bufs, offsets);
+      /* The full level leads the index buffer, the lods follow it. */
+      vkCmdBindIndexBuffer(*buffer, mesh->index_buf, 0, mesh->index_type);
+      bound_mesh = mesh;
+    }
+    vkCmdDrawIndexed(*buffer, mesh->index_count, 1, 0, 0, 0);
+  }
 }
 
 void clear_color_triangle_callback(void *ud, VkClearColorValue *color)
@@ -174,43 +227,9 @@ Renderer *renderer_create(RendererBuilder *builder)
 
   render_graph_bake(&render->render_graph);
 
-  Membuf technique_config;
-  if (!membuf_load_file(&technique_config, builder->technique_filename))
+  if (!load_techniques(render, builder->technique_filename) ||
+      !load_effects(render, builder->effect_filename))
   {
-    MIUR_LOG_ERR("Failed to load technique config: '%s'",
-                   builder->technique_filename);
-    goto cleanup;
-  }
-
-  ParseError technique_error;
-  if (!technique_cache_load_file(render->dev, render->swapchain.extent, 
-                                 render->swapchain.format.format,
-                                 &render->technique_cache, 
-                                 &render->shader_cache, technique_config, 
-                                 &technique_error))
-  {
-    MIUR_LOG_ERR("Error parsing technique config file '%s'\n%d:%d: %s",
-                 builder->technique_filename, technique_error.line,
-                 technique_error.col, technique_error.msg);
-    goto cleanup;
-  }
-
-  Membuf effect_config;
-  if (!membuf_load_file(&effect_config, builder->effect_filename))
-  {
-    MIUR_LOG_ERR("Failed to load effectconfig: '%s'",
-                   builder->effect_filename);
-    goto cleanup;
-  }
-
-  ParseError effect_error;
-  if (!effect_cache_load_file(render->dev, &render->effect_cache,
-                              &render->technique_cache,
-                              effect_config, &effect_error))
-  {
-    MIUR_LOG_ERR("Error parsing effect config file '%s'\n%d:%d: %s",
-                 builder->effect_filename, effect_error.line,
-                 effect_error.col, effect_error.msg);
     goto cleanup;
   }
 
@@ -224,6 +243,20 @@ Renderer *renderer_create(RendererBuilder *builder)
     goto cleanup;
   }
 
+  /* Short lived command buffers for uploads. */
+  VkCommandPoolCreateInfo pool_create_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+    .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+    .queueFamilyIndex = render->queue_indices.graphics,
+  };
+  err = vkCreateCommandPool(render->dev, &pool_create_info, NULL,
+                            &render->command_pool);
+  if (err)
+  {
+    print_vulkan_error(err);
+    goto cleanup;
+  }
+
   render->shader_monitor = fs_monitor_create();
   if (render->shader_monitor == NULL)
   {
@@ -287,34 +320,32 @@ void renderer_destroy(Renderer *render)
 
 bool renderer_init_static_mesh(Renderer *render, StaticMesh *mesh)
 {
-  render->mesh = mesh;
-  VkDeviceSize buffer_size = mesh->vert_count * 3 * sizeof(float);
-  if (!create_buffer(render, buffer_size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &mesh->vert_bufs[0],
-                     &mesh->pos_memory))
+  Technique *tech = prepare_static_mesh(render, mesh);
+  if (tech == NULL)
   {
     return false;
   }
 
   void *data;
-  vkMapMemory(render->dev, mesh->pos_memory, 0, buffer_size, 0, &data);
-  memcpy(data, mesh->verts_pos, buffer_size);
-  vkUnmapMemory(render->dev, mesh->pos_memory);
-
-  if (!create_buffer(render, buffer_size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &mesh->vert_bufs[1],
-                     &mesh->norm_memory))
+  uint32_t binding_count = vertex_layout_binding_count(tech->vertex_layout);
+  for (uint32_t i = 0; i < binding_count; i++)
   {
-    return false;
-  }
+    VkDeviceSize buffer_size = (VkDeviceSize) mesh->vert_count *
+      vertex_binding_stride(tech->vertex_format, tech->vertex_layout, i);
+    if (!create_buffer(render, buffer_size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &mesh->vert_bufs[i],
+                       &mesh->vert_memory[i]))
+    {
+      return false;
+    }
 
-  vkMapMemory(render->dev, mesh->norm_memory, 0, buffer_size, 0, &data);
-  memcpy(data, mesh->verts_norm, buffer_size);
-  vkUnmapMemory(render->dev, mesh->norm_memory);
+    vkMapMemory(render->dev, mesh->vert_memory[i], 0, buffer_size, 0, &data);
+    write_vertex_binding(data, tech, mesh, i);
+    vkUnmapMemory(render->dev, mesh->vert_memory[i]);
+  }
 
-  buffer_size = mesh->index_count * sizeof(uint16_t);
+  VkDeviceSize buffer_size = index_buffer_size(mesh);
   if (!create_buffer(render, buffer_size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
                 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &mesh->index_buf,
@@ -324,29 +355,329 @@ bool renderer_init_static_mesh(Renderer *render, StaticMesh *mesh)
   }
 
   vkMapMemory(render->dev, mesh->index_memory, 0, buffer_size, 0, &data);
-  memcpy(data, mesh->indices, buffer_size);
+  write_indices(data, mesh);
   vkUnmapMemory(render->dev, mesh->index_memory);
+  return true;
+}
 
-  String material_name = string_from_cstr("triangle");
-  render->mesh->material = material_cache_lookup(&render->material_cache, &material_name);
-  if (render->mesh->material == NULL)
+bool renderer_upload_static_mesh(Renderer *render, StaticMesh *mesh,
+                                 RendererUpload *upload_out)
+{
+  memset(upload_out, 0, sizeof(*upload_out));
+  upload_out->mesh = mesh;
+  Technique *tech = prepare_static_mesh(render, mesh);
+  if (tech == NULL)
+  {
+    return false;
+  }
+
+  /* Every buffer's data goes in one staging buffer, the index data last. */
+  uint32_t binding_count = vertex_layout_binding_count(tech->vertex_layout);
+  VkDeviceSize sizes[VERTEX_ATTRIBUTE_COUNT + 1];
+  VkDeviceSize offsets[VERTEX_ATTRIBUTE_COUNT + 1];
+  VkDeviceSize total = 0;
+  for (uint32_t i = 0; i <= binding_count; i++)
+  {
+    sizes[i] = i < binding_count ? (VkDeviceSize) mesh->vert_count *
+      vertex_binding_stride(tech->vertex_format, tech->vertex_layout, i) :
+      index_buffer_size(mesh);
+    offsets[i] = total;
+    total += (sizes[i] + 15) & ~(VkDeviceSize) 15;
+  }
+  upload_out->size = total;
+
+  if (!create_buffer(render, total, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     &upload_out->staging, &upload_out->staging_memory))
+  {
+    goto cleanup;
+  }
+  uint8_t *data;
+  vkMapMemory(render->dev, upload_out->staging_memory, 0, total, 0,
+              (void **) &data);
+  for (uint32_t i = 0; i < binding_count; i++)
+  {
+    write_vertex_binding(data + offsets[i], tech, mesh, i);
+  }
+  write_indices(data + offsets[binding_count], mesh);
+  vkUnmapMemory(render->dev, upload_out->staging_memory);
+
+  for (uint32_t i = 0; i < binding_count; i++)
+  {
+    if (!create_buffer(render, sizes[i], VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                       VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                       &mesh->vert_bufs[i], &mesh->vert_memory[i]))
+    {
+      goto cleanup;
+    }
+  }
+  if (!create_buffer(render, sizes[binding_count],
+                     VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                     VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &mesh->index_buf,
+                     &mesh->index_memory))
+  {
+    goto cleanup;
+  }
+
+  if (!begin_upload(render, upload_out))
+  {
+    goto cleanup;
+  }
+  for (uint32_t i = 0; i <= binding_count; i++)
+  {
+    VkBufferCopy region = {
+      .srcOffset = offsets[i],
+      .dstOffset = 0,
+      .size = sizes[i],
+    };
+    vkCmdCopyBuffer(upload_out->commands, upload_out->staging,
+                    i < binding_count ? mesh->vert_bufs[i] : mesh->index_buf,
+                    1, &region);
+  }
+  /* Later submissions on the queue read the copies as vertex input. */
+  VkMemoryBarrier barrier = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+    .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+      VK_ACCESS_INDEX_READ_BIT,
+  };
+  vkCmdPipelineBarrier(upload_out->commands, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &barrier, 0,
+                       NULL, 0, NULL);
+  if (submit_upload(render, upload_out))
+  {
+    return true;
+  }
+
+cleanup:
+  release_upload(render, upload_out);
+  renderer_deinit_static_mesh(render, mesh);
+  return false;
+}
+
+bool renderer_can_sample(Renderer *render, TextureFormat format)
+{
+  VkFormatProperties props;
+  vkGetPhysicalDeviceFormatProperties(render->pdev, texture_vk_format(format),
+                                      &props);
+  return (props.optimalTilingFeatures &
+          VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+}
+
+bool renderer_upload_texture(Renderer *render, const Texture *texture,
+                             GPUTexture *gpu_out, RendererUpload *upload_out)
+{
+  memset(gpu_out, 0, sizeof(*gpu_out));
+  memset(upload_out, 0, sizeof(*upload_out));
+  VkFormat format = texture_vk_format(texture->format);
+  if (!renderer_can_sample(render, texture->format))
+  {
+    MIUR_LOG_ERR("The device can't sample texture format %d",
+                 (int) texture->format);
+    return false;
+  }
+
+  /* The texture's data is already laid out for the copy, mips and all. */
+  upload_out->size = texture->size;
+  if (!create_buffer(render, texture->size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     &upload_out->staging, &upload_out->staging_memory))
+  {
+    goto cleanup;
+  }
+  void *data;
+  vkMapMemory(render->dev, upload_out->staging_memory, 0, texture->size, 0,
+              &data);
+  memcpy(data, texture->data, texture->size);
+  vkUnmapMemory(render->dev, upload_out->staging_memory);
+
+  VkImageCreateInfo image_info = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+    .imageType = VK_IMAGE_TYPE_2D,
+    .format = format,
+    .extent = { texture->width, texture->height, 1 },
+    .mipLevels = texture->mip_count,
+    .arrayLayers = 1,
+    .samples = VK_SAMPLE_COUNT_1_BIT,
+    .tiling = VK_IMAGE_TILING_OPTIMAL,
+    .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+  };
+  VkResult err = vkCreateImage(render->dev, &image_info, NULL,
+                               &gpu_out->image);
+  if (err)
+  {
+    print_vulkan_error(err);
+    goto cleanup;
+  }
+  VkMemoryRequirements mem_required;
+  vkGetImageMemoryRequirements(render->dev, gpu_out->image, &mem_required);
+  VkMemoryAllocateInfo alloc_info = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+    .allocationSize = mem_required.size,
+  };
+  if (!find_memory_type(render, mem_required.memoryTypeBits,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                        &alloc_info.memoryTypeIndex))
+  {
+    goto cleanup;
+  }
+  err = vkAllocateMemory(render->dev, &alloc_info, NULL, &gpu_out->memory);
+  if (err)
+  {
+    print_vulkan_error(err);
+    goto cleanup;
+  }
+  vkBindImageMemory(render->dev, gpu_out->image, gpu_out->memory, 0);
+
+  VkImageSubresourceRange mips = {
+    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+    .baseMipLevel = 0,
+    .levelCount = texture->mip_count,
+    .baseArrayLayer = 0,
+    .layerCount = 1,
+  };
+  VkImageViewCreateInfo view_info = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+    .image = gpu_out->image,
+    .viewType = VK_IMAGE_VIEW_TYPE_2D,
+    .format = format,
+    .subresourceRange = mips,
+  };
+  err = vkCreateImageView(render->dev, &view_info, NULL, &gpu_out->view);
+  if (err)
+  {
+    print_vulkan_error(err);
+    goto cleanup;
+  }
+
+  if (!begin_upload(render, upload_out))
+  {
+    goto cleanup;
+  }
+  VkImageMemoryBarrier barrier = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .srcAccessMask = 0,
+    .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image = gpu_out->image,
+    .subresourceRange = mips,
+  };
+  vkCmdPipelineBarrier(upload_out->commands,
+                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1,
+                       &barrier);
+
+  /* One copy for the whole chain, a region per mip. */
+  VkBufferImageCopy regions[TEXTURE_MAX_MIPS];
+  for (uint32_t i = 0; i < texture->mip_count; i++)
+  {
+    const TextureMip *mip = &texture->mips[i];
+    regions[i] = (VkBufferImageCopy) {
+      .bufferOffset = mip->offset,
+      .imageSubresource = {
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .mipLevel = i,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+      },
+      .imageExtent = { mip->width, mip->height, 1 },
+    };
+  }
+  vkCmdCopyBufferToImage(upload_out->commands, upload_out->staging,
+                         gpu_out->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         texture->mip_count, regions);
+
+  /* Later submissions on the queue sample it from fragment shaders. */
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  vkCmdPipelineBarrier(upload_out->commands, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0,
+                       NULL, 1, &barrier);
+  if (submit_upload(render, upload_out))
+  {
+    return true;
+  }
+
+cleanup:
+  release_upload(render, upload_out);
+  renderer_deinit_texture(render, gpu_out);
+  return false;
+}
+
+void renderer_deinit_texture(Renderer *render, GPUTexture *texture)
+{
+  vkDeviceWaitIdle(render->dev);
+  vkDestroyImageView(render->dev, texture->view, NULL);
+  vkDestroyImage(render->dev, texture->image, NULL);
+  vkFreeMemory(render->dev, texture->memory, NULL);
+  memset(texture, 0, sizeof(*texture));
+}
+
+bool renderer_upload_poll(Renderer *render, RendererUpload *upload)
+{
+  if (upload->fence == VK_NULL_HANDLE)
+  {
+    return true;
+  }
+  VkResult err = vkGetFenceStatus(render->dev, upload->fence);
+  if (err == VK_NOT_READY)
   {
-    MIUR_LOG_ERR("Couldn't find material: '%.*s'", (int) material_name.size, 
-       material_name.data);
     return false;
   }
+  if (err)
+  {
+    print_vulkan_error(err);
+  }
+  release_upload(render, upload);
   return true;
 }
 
+void renderer_upload_wait(Renderer *render, RendererUpload *upload)
+{
+  if (upload->fence != VK_NULL_HANDLE)
+  {
+    vkWaitForFences(render->dev, 1, &upload->fence, VK_TRUE, UINT64_MAX);
+  }
+  release_upload(render, upload);
+}
+
+void renderer_show_static_model(Renderer *render, StaticModel *model)
+{
+  render->model = model;
+}
+
 void renderer_deinit_static_mesh(Renderer *render, StaticMesh *mesh)
 {
   vkDeviceWaitIdle(render->dev);
-  vkDestroyBuffer(render->dev, mesh->vert_bufs[0], NULL);
-  vkDestroyBuffer(render->dev, mesh->vert_bufs[1], NULL);
+  for (uint32_t i = 0; i < VERTEX_ATTRIBUTE_COUNT; i++)
+  {
+    vkDestroyBuffer(render->dev, mesh->vert_bufs[i], NULL);
+    vkFreeMemory(render->dev, mesh->vert_memory[i], NULL);
+  }
   vkDestroyBuffer(render->dev, mesh->index_buf, NULL);
-  vkFreeMemory(render->dev, mesh->pos_memory, NULL);
-  vkFreeMemory(render->dev, mesh->norm_memory, NULL);
   vkFreeMemory(render->dev, mesh->index_memory, NULL);
+  memset(mesh->vert_bufs, 0, sizeof(mesh->vert_bufs));
+  memset(mesh->vert_memory, 0, sizeof(mesh->vert_memory));
+  mesh->index_buf = VK_NULL_HANDLE;
+  mesh->index_memory = VK_NULL_HANDLE;
+  /* Stop drawing a model as soon as any of its meshes goes away. */
+  StaticModel *model = render->model;
+  if (model != NULL && mesh >= model->meshes &&
+      mesh < model->meshes + model->mesh_count)
+  {
+    render->model = NULL;
+  }
 }
 
 bool do_recreate = false;
@@ -563,21 +894,11 @@ bool create_buffer(Renderer *render, VkDeviceSize size,
   uint32_t memory_type;
   VkMemoryRequirements mem_required;
   vkGetBufferMemoryRequirements(render->dev, *buffer, &mem_required);
-  VkPhysicalDeviceMemoryProperties mem_props;
-  vkGetPhysicalDeviceMemoryProperties(render->pdev, &mem_props);
-
-  for (uint32_t i = 0; i < mem_props.memoryTypeCount; i++)
+  if (!find_memory_type(render, mem_required.memoryTypeBits, properties,
+                        &memory_type))
   {
-    if (mem_required.memoryTypeBits & (1 << i) &&
-        (mem_props.memoryTypes[i].propertyFlags) & properties)
-      {
-        memory_type = i;
-        goto done;
-      }
-  }
-    MIUR_LOG_ERR("couldn't find suitable memory type");
     return false;
-  done:
+  }
 
   VkMemoryAllocateInfo alloc_info = {
     .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
@@ -595,3 +916,285 @@ bool create_buffer(Renderer *render, VkDeviceSize size,
   vkBindBufferMemory(render->dev, *buffer, *memory, 0);
   return true;
 }
+
+/*
+ * Binds the mesh's material and fits its quantization, returns the
+ * technique its buffers are laid out for or NULL if there is none.
+ */
+static Technique *prepare_static_mesh(Renderer *render, StaticMesh *mesh)
+{
+  String material_name = string_from_cstr("triangle");
+  mesh->material = material_cache_lookup(&render->material_cache,
+                                         &material_name);
+  if (mesh->material == NULL)
+  {
+    MIUR_LOG_ERR("Couldn't find material: '%.*s'", (int) material_name.size,
+       material_name.data);
+    return NULL;
+  }
+
+  Technique *tech = mesh->material->effect->techniques.forward;
+  if (tech->vertex_format == VERTEX_FORMAT_QUANTIZED)
+  {
+    VertexQuantizationError error;
+    vertex_quantization_fit(&mesh->quantization, mesh->verts_pos,
+                            mesh->vert_count);
+    vertex_quantization_measure(&error, &mesh->quantization, mesh->verts_pos,
+                                mesh->verts_norm, mesh->verts_uv,
+                                mesh->vert_count);
+    MIUR_LOG_INFO("Quantized %" PRIu32 " vertices: position error %g, "
+                  "normal error %g degrees, UV error %g", mesh->vert_count,
+                  error.position, error.normal * 57.29578f, error.uv);
+  }
+
+  for (uint32_t i = 0; i < VERTEX_ATTRIBUTE_COUNT; i++)
+  {
+    mesh->vert_bufs[i] = VK_NULL_HANDLE;
+    mesh->vert_memory[i] = VK_NULL_HANDLE;
+  }
+  mesh->index_buf = VK_NULL_HANDLE;
+  mesh->index_memory = VK_NULL_HANDLE;
+  /* Every level shares the index buffer, narrow it when the vertices allow. */
+  mesh->index_type = mesh->vert_count <= UINT16_MAX + 1 ?
+    VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+  return tech;
+}
+
+static void write_vertex_binding(void *dst, const Technique *tech,
+                                 const StaticMesh *mesh, uint32_t binding)
+{
+  const float *sources[VERTEX_ATTRIBUTE_COUNT] = {
+    [VERTEX_ATTRIBUTE_POSITION] = mesh->verts_pos,
+    [VERTEX_ATTRIBUTE_NORMAL] = mesh->verts_norm,
+    [VERTEX_ATTRIBUTE_UV] = mesh->verts_uv,
+  };
+  if (tech->vertex_layout == VERTEX_LAYOUT_INTERLEAVED)
+  {
+    vertex_interleave(dst, tech->vertex_format, sources, mesh->vert_count,
+                      &mesh->quantization);
+  } else
+  {
+    vertex_attribute_write(dst, vertex_binding_stride(tech->vertex_format,
+                                                      tech->vertex_layout,
+                                                      binding),
+                           tech->vertex_format, binding, sources[binding],
+                           mesh->vert_count, &mesh->quantization);
+  }
+}
+
+static VkDeviceSize index_buffer_size(const StaticMesh *mesh)
+{
+  return (VkDeviceSize) static_mesh_index_total(mesh) *
+    (mesh->index_type == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) :
+     sizeof(uint32_t));
+}
+
+static void write_indices(void *dst, const StaticMesh *mesh)
+{
+  uint32_t index_total = static_mesh_index_total(mesh);
+  if (mesh->index_type == VK_INDEX_TYPE_UINT16)
+  {
+    convert_indices_u16(dst, (const uint8_t *) mesh->indices, index_total,
+                        COMPONENT_U32);
+  } else
+  {
+    memcpy(dst, mesh->indices, (size_t) index_total * sizeof(uint32_t));
+  }
+}
+
+static bool find_memory_type(Renderer *render, uint32_t type_bits,
+                             VkMemoryPropertyFlags properties,
+                             uint32_t *type_out)
+{
+  VkPhysicalDeviceMemoryProperties mem_props;
+  vkGetPhysicalDeviceMemoryProperties(render->pdev, &mem_props);
+  for (uint32_t i = 0; i < mem_props.memoryTypeCount; i++)
+  {
+    if (type_bits & (1 << i) &&
+        (mem_props.memoryTypes[i].propertyFlags) & properties)
+    {
+      *type_out = i;
+      return true;
+    }
+  }
+  MIUR_LOG_ERR("couldn't find suitable memory type");
+  return false;
+}
+
+static VkFormat texture_vk_format(TextureFormat format)
+{
+  switch (format)
+  {
+  case TEXTURE_FORMAT_RGBA8:
+    return VK_FORMAT_R8G8B8A8_UNORM;
+  case TEXTURE_FORMAT_RGBA8_SRGB:
+    return VK_FORMAT_R8G8B8A8_SRGB;
+  case TEXTURE_FORMAT_BC1:
+    return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+  case TEXTURE_FORMAT_BC1_SRGB:
+    return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+  case TEXTURE_FORMAT_BC3:
+    return VK_FORMAT_BC3_UNORM_BLOCK;
+  case TEXTURE_FORMAT_BC3_SRGB:
+    return VK_FORMAT_BC3_SRGB_BLOCK;
+  case TEXTURE_FORMAT_BC5:
+    return VK_FORMAT_BC5_UNORM_BLOCK;
+  case TEXTURE_FORMAT_BC7:
+    return VK_FORMAT_BC7_UNORM_BLOCK;
+  case TEXTURE_FORMAT_BC7_SRGB:
+    return VK_FORMAT_BC7_SRGB_BLOCK;
+  default:
+    return VK_FORMAT_UNDEFINED;
+  }
+}
+
+/* Allocates and begins the one time command buffer of an upload. */
+static bool begin_upload(Renderer *render, RendererUpload *upload)
+{
+  VkCommandBufferAllocateInfo alloc_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+    .commandPool = render->command_pool,
+    .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+    .commandBufferCount = 1,
+  };
+  VkResult err = vkAllocateCommandBuffers(render->dev, &alloc_info,
+                                          &upload->commands);
+  if (err)
+  {
+    print_vulkan_error(err);
+    return false;
+  }
+
+  VkCommandBufferBeginInfo begin_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+  };
+  vkBeginCommandBuffer(upload->commands, &begin_info);
+  return true;
+}
+
+/* Ends the upload's commands and submits them without waiting. */
+static bool submit_upload(Renderer *render, RendererUpload *upload)
+{
+  VkResult err = vkEndCommandBuffer(upload->commands);
+  if (err)
+  {
+    print_vulkan_error(err);
+    return false;
+  }
+
+  VkFenceCreateInfo fence_info = {
+    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+  };
+  err = vkCreateFence(render->dev, &fence_info, NULL, &upload->fence);
+  if (err)
+  {
+    print_vulkan_error(err);
+    return false;
+  }
+  VkSubmitInfo submit_info = {
+    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+    .commandBufferCount = 1,
+    .pCommandBuffers = &upload->commands,
+  };
+  err = vkQueueSubmit(render->graphics_queue, 1, &submit_info,
+                      upload->fence);
+  if (err)
+  {
+    print_vulkan_error(err);
+    return false;
+  }
+  return true;
+}
+
+/* Frees the staging side of an upload, the mesh's buffers or image stay. */
+static void release_upload(Renderer *render, RendererUpload *upload)
+{
+  if (upload->commands != VK_NULL_HANDLE)
+  {
+    vkFreeCommandBuffers(render->dev, render->command_pool, 1,
+                         &upload->commands);
+  }
+  vkDestroyFence(render->dev, upload->fence, NULL);
+  vkDestroyBuffer(render->dev, upload->staging, NULL);
+  vkFreeMemory(render->dev, upload->staging_memory, NULL);
+  upload->commands = VK_NULL_HANDLE;
+  upload->fence = VK_NULL_HANDLE;
+  upload->staging = VK_NULL_HANDLE;
+  upload->staging_memory = VK_NULL_HANDLE;
+}
+
+/*
+ * Loads the table miur-cook made of a technique file while it is current,
+ * with no JSON to parse or GLSL to compile, and the file itself otherwise.
+ */
+static bool load_techniques(Renderer *render, const char *filename)
+{
+  MaterialTable table;
+  if (material_table_open_current(&table, filename))
+  {
+    bool loaded = technique_cache_load_table(render->dev,
+                                             render->swapchain.extent,
+                                             render->swapchain.format.format,
+                                             &render->technique_cache,
+                                             &render->shader_cache, &table);
+    material_table_close(&table);
+    return loaded;
+  }
+
+  Membuf technique_config;
+  if (!archive_map_file(&technique_config, filename, MEMBUF_MAP_SEQUENTIAL))
+  {
+    MIUR_LOG_ERR("Failed to load technique config: '%s'", filename);
+    return false;
+  }
+
+  ParseError technique_error;
+  bool techniques_loaded =
+    technique_cache_load_file(render->dev, render->swapchain.extent, 
+                              render->swapchain.format.format,
+                              &render->technique_cache, 
+                              &render->shader_cache, technique_config, 
+                              &technique_error);
+  membuf_destroy(&technique_config);
+  if (!techniques_loaded)
+  {
+    MIUR_LOG_ERR("Error parsing technique config file '%s'\n%d:%d: %s",
+                 filename, technique_error.line, technique_error.col,
+                 technique_error.msg);
+  }
+  return techniques_loaded;
+}
+
+static bool load_effects(Renderer *render, const char *filename)
+{
+  MaterialTable table;
+  if (material_table_open_current(&table, filename))
+  {
+    bool loaded = effect_cache_load_table(&render->effect_cache,
+                                          &render->technique_cache, &table);
+    material_table_close(&table);
+    return loaded;
+  }
+
+  Membuf effect_config;
+  if (!archive_map_file(&effect_config, filename, MEMBUF_MAP_SEQUENTIAL))
+  {
+    MIUR_LOG_ERR("Failed to load effectconfig: '%s'", filename);
+    return false;
+  }
+
+  ParseError effect_error;
+  bool effects_loaded = effect_cache_load_file(render->dev,
+                                               &render->effect_cache,
+                                               &render->technique_cache,
+                                               effect_config, &effect_error);
+  membuf_destroy(&effect_config);
+  if (!effects_loaded)
+  {
+    MIUR_LOG_ERR("Error parsing effect config file '%s'\n%d:%d: %s",
+                 filename, effect_error.line, effect_error.col,
+                 effect_error.msg);
+  }
+  return effects_loaded;
+}
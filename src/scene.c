@@ -0,0 +1,343 @@
+/* =====================
+ * src/scene.c
+ * 10/18/2026
+ * Scene graph with incremental transform updates.
+ * ====================
+ */
+
+#include <string.h>
+
+#include <miur/scene.h>
+#include <miur/transform.h>
+#include <miur/simd.h>
+#include <miur/mem.h>
+#include <miur/log.h>
+
+#define SCENE_MIN_CAPACITY 64
+
+enum
+{
+  LINK_PARENT,
+  LINK_FIRST,
+  LINK_LAST,
+  LINK_NEXT,
+  LINK_COUNT,
+};
+
+/* === PROTOTYPES === */
+
+static bool grow(Scene *scene, uint32_t capacity);
+static bool reorder(Scene *scene);
+static void mark_range(uint64_t *bits, uint32_t first, uint32_t count);
+
+/* === PUBLIC FUNCTIONS === */
+
+bool scene_create(Scene *scene_out, uint32_t capacity)
+{
+  memset(scene_out, 0, sizeof(*scene_out));
+  scene_out->first_root = SCENE_NO_NODE;
+  scene_out->last_root = SCENE_NO_NODE;
+  if (capacity < SCENE_MIN_CAPACITY)
+  {
+    capacity = SCENE_MIN_CAPACITY;
+  }
+  if (!grow(scene_out, capacity))
+  {
+    MIUR_LOG_ERR("Failed to allocate a scene of %u nodes", capacity);
+    scene_destroy(scene_out);
+    return false;
+  }
+  return true;
+}
+
+void scene_destroy(Scene *scene)
+{
+  MIUR_FREE(scene->parents);
+  MIUR_FREE(scene->first_child);
+  MIUR_FREE(scene->child_count);
+  MIUR_FREE(scene->handles);
+  MIUR_FREE(scene->local);
+  MIUR_FREE(scene->world);
+  MIUR_FREE(scene->dirty);
+  MIUR_FREE(scene->slots);
+  MIUR_FREE(scene->links);
+  memset(scene, 0, sizeof(*scene));
+}
+
+SceneNode scene_add(Scene *scene, SceneNode parent, const float *local)
+{
+  if (scene->count == scene->capacity &&
+      (scene->capacity > UINT32_MAX / 2 || !grow(scene, scene->capacity * 2)))
+  {
+    MIUR_LOG_ERR("Failed to grow the scene past %u nodes", scene->capacity);
+    return SCENE_NO_NODE;
+  }
+
+  /* Appended for now, the next update puts it with its siblings. */
+  SceneNode node = scene->count++;
+  uint32_t slot = node;
+  scene->slots[node] = slot;
+  scene->handles[slot] = node;
+  scene->parents[slot] =
+    parent == SCENE_NO_NODE ? SCENE_NO_NODE : scene->slots[parent];
+  scene->first_child[slot] = 0;
+  scene->child_count[slot] = 0;
+  if (local != NULL)
+  {
+    memcpy(&scene->local[(size_t) slot * 16], local, 16 * sizeof(float));
+  } else
+  {
+    mat4_identity(&scene->local[(size_t) slot * 16]);
+  }
+
+  SceneNode *links = &scene->links[(size_t) node * LINK_COUNT];
+  links[LINK_PARENT] = parent;
+  links[LINK_FIRST] = SCENE_NO_NODE;
+  links[LINK_LAST] = SCENE_NO_NODE;
+  links[LINK_NEXT] = SCENE_NO_NODE;
+  SceneNode *first = &scene->first_root;
+  SceneNode *last = &scene->last_root;
+  if (parent != SCENE_NO_NODE)
+  {
+    first = &scene->links[(size_t) parent * LINK_COUNT + LINK_FIRST];
+    last = &scene->links[(size_t) parent * LINK_COUNT + LINK_LAST];
+  }
+  if (*last == SCENE_NO_NODE)
+  {
+    *first = node;
+  } else
+  {
+    scene->links[(size_t) *last * LINK_COUNT + LINK_NEXT] = node;
+  }
+  *last = node;
+
+  scene->unordered = true;
+  return node;
+}
+
+bool scene_add_model(Scene *scene, const StaticModel *model, SceneNode parent,
+                     SceneNode *first_out)
+{
+  /* Handles are handed out in order, the model's parents come first. */
+  SceneNode first = scene->count;
+  for (uint32_t i = 0; i < model->node_count; i++)
+  {
+    int32_t model_parent = model->node_parents[i];
+    SceneNode node_parent =
+      model_parent < 0 ? parent : first + (uint32_t) model_parent;
+    if (scene_add(scene, node_parent,
+                  &model->node_local[(size_t) i * 16]) == SCENE_NO_NODE)
+    {
+      return false;
+    }
+  }
+  *first_out = first;
+  return true;
+}
+
+void scene_set_local(Scene *scene, SceneNode node, const float *local)
+{
+  uint32_t slot = scene->slots[node];
+  memcpy(&scene->local[(size_t) slot * 16], local, 16 * sizeof(float));
+  scene->dirty[slot >> 6] |= (uint64_t) 1 << (slot & 63);
+}
+
+const float *scene_world(const Scene *scene, SceneNode node)
+{
+  return &scene->world[(size_t) scene->slots[node] * 16];
+}
+
+uint32_t scene_slot(const Scene *scene, SceneNode node)
+{
+  return scene->slots[node];
+}
+
+bool scene_update(Scene *scene, SceneUpdate *update_out)
+{
+  if (scene->unordered && !reorder(scene))
+  {
+    return false;
+  }
+
+  SceneUpdate update = { 0 };
+  update.first = UINT32_MAX;
+  uint32_t words = (scene->count + 63) / 64;
+  for (uint32_t w = 0; w < words; w++)
+  {
+    /* Children come later, marking them may refill this very word. */
+    uint64_t bits;
+    while ((bits = scene->dirty[w]) != 0)
+    {
+      scene->dirty[w] = bits & (bits - 1);
+      uint32_t slot = w * 64 + MIUR_CTZ64(bits);
+      uint32_t parent = scene->parents[slot];
+      float *world = &scene->world[(size_t) slot * 16];
+      const float *local = &scene->local[(size_t) slot * 16];
+      if (parent == SCENE_NO_NODE)
+      {
+        memcpy(world, local, 16 * sizeof(float));
+      } else
+      {
+        mat4_mul(world, &scene->world[(size_t) parent * 16], local);
+      }
+      mark_range(scene->dirty, scene->first_child[slot],
+                 scene->child_count[slot]);
+
+      if (update.first == UINT32_MAX)
+      {
+        update.first = slot;
+      }
+      update.end = slot + 1;
+      update.updated++;
+    }
+  }
+  if (update.updated == 0)
+  {
+    update.first = 0;
+  }
+
+  if (update_out != NULL)
+  {
+    *update_out = update;
+  }
+  return true;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static bool grow(Scene *scene, uint32_t capacity)
+{
+  size_t old_words = ((size_t) scene->capacity + 63) / 64;
+  size_t words = ((size_t) capacity + 63) / 64;
+  size_t links = (size_t) capacity * LINK_COUNT;
+  size_t matrices = (size_t) capacity * 16;
+
+  /* Each array is stored back as soon as it moves, failing halfway is fine. */
+  uint32_t *parents = MIUR_REALLOC(uint32_t, scene->parents, capacity);
+  if (parents == NULL)
+  {
+    return false;
+  }
+  scene->parents = parents;
+  uint32_t *first_child = MIUR_REALLOC(uint32_t, scene->first_child,
+                                       capacity);
+  if (first_child == NULL)
+  {
+    return false;
+  }
+  scene->first_child = first_child;
+  uint32_t *child_count = MIUR_REALLOC(uint32_t, scene->child_count,
+                                       capacity);
+  if (child_count == NULL)
+  {
+    return false;
+  }
+  scene->child_count = child_count;
+  SceneNode *handles = MIUR_REALLOC(SceneNode, scene->handles, capacity);
+  if (handles == NULL)
+  {
+    return false;
+  }
+  scene->handles = handles;
+  uint32_t *slots = MIUR_REALLOC(uint32_t, scene->slots, capacity);
+  if (slots == NULL)
+  {
+    return false;
+  }
+  scene->slots = slots;
+  SceneNode *link_arr = MIUR_REALLOC(SceneNode, scene->links, links);
+  if (link_arr == NULL)
+  {
+    return false;
+  }
+  scene->links = link_arr;
+  float *local = MIUR_REALLOC(float, scene->local, matrices);
+  if (local == NULL)
+  {
+    return false;
+  }
+  scene->local = local;
+  float *world = MIUR_REALLOC(float, scene->world, matrices);
+  if (world == NULL)
+  {
+    return false;
+  }
+  scene->world = world;
+  uint64_t *dirty = MIUR_REALLOC(uint64_t, scene->dirty, words);
+  if (dirty == NULL)
+  {
+    return false;
+  }
+  memset(&dirty[old_words], 0, (words - old_words) * sizeof(uint64_t));
+  scene->dirty = dirty;
+
+  scene->capacity = capacity;
+  return true;
+}
+
+/*
+ * Lays the nodes out breadth first from their links and marks all of them,
+ * new nodes have no world matrix yet and the old ones have moved.
+ */
+static bool reorder(Scene *scene)
+{
+  float *local = MIUR_ARR_UNINIT(float, (size_t) scene->capacity * 16);
+  if (local == NULL)
+  {
+    MIUR_LOG_ERR("Failed to reorder a scene of %u nodes", scene->count);
+    return false;
+  }
+
+  /* The handles array doubles as the queue. */
+  uint32_t tail = 0;
+  for (SceneNode n = scene->first_root; n != SCENE_NO_NODE;
+       n = scene->links[(size_t) n * LINK_COUNT + LINK_NEXT])
+  {
+    scene->handles[tail++] = n;
+  }
+  for (uint32_t slot = 0; slot < scene->count; slot++)
+  {
+    SceneNode node = scene->handles[slot];
+    const SceneNode *links = &scene->links[(size_t) node * LINK_COUNT];
+    memcpy(&local[(size_t) slot * 16],
+           &scene->local[(size_t) scene->slots[node] * 16],
+           16 * sizeof(float));
+
+    scene->first_child[slot] = tail;
+    for (SceneNode n = links[LINK_FIRST]; n != SCENE_NO_NODE;
+         n = scene->links[(size_t) n * LINK_COUNT + LINK_NEXT])
+    {
+      scene->handles[tail++] = n;
+    }
+    scene->child_count[slot] = tail - scene->first_child[slot];
+  }
+
+  /* Parents get their new slot before any of their children look. */
+  for (uint32_t slot = 0; slot < scene->count; slot++)
+  {
+    SceneNode node = scene->handles[slot];
+    SceneNode parent = scene->links[(size_t) node * LINK_COUNT + LINK_PARENT];
+    scene->slots[node] = slot;
+    scene->parents[slot] =
+      parent == SCENE_NO_NODE ? SCENE_NO_NODE : scene->slots[parent];
+  }
+
+  MIUR_FREE(scene->local);
+  scene->local = local;
+  mark_range(scene->dirty, 0, scene->count);
+  scene->unordered = false;
+  return true;
+}
+
+static void mark_range(uint64_t *bits, uint32_t first, uint32_t count)
+{
+  while (count > 0)
+  {
+    uint32_t bit = first & 63;
+    uint32_t take = 64 - bit < count ? 64 - bit : count;
+    uint64_t mask = take == 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << take) - 1;
+    bits[first >> 6] |= mask << bit;
+    first += take;
+    count -= take;
+  }
+}
@@ -8,6 +8,7 @@
 #include <vulkan/vulkan.h>
 #include <string.h>
 
+#include <miur/archive.h>
 #include <miur/shader.h>
 #include <miur/log.h>
 #include <miur/bsl.h>
@@ -15,6 +16,7 @@
 /* === PROTOTYPES === */
 
 static void shader_destroy(void *ud, ShaderModule *module);
+static shaderc_compiler_t get_compiler(ShaderCache *cache);
 const char *get_filename_ext(const char *filename);
 
 /* === PUBLIC FUNCTIONS === */
@@ -36,12 +38,17 @@ void shader_cache_create(ShaderCache *cache_out, VkDevice *dev)
 {
   shader_map_create(&cache_out->map);
   shader_map_set_user_data(&cache_out->map, dev);
-  cache_out->compiler = shaderc_compiler_initialize();
+  /* Created on the first compile, cooked shaders never need it. */
+  cache_out->compiler = NULL;
 }
 
 void shader_cache_destroy(ShaderCache *cache)
 {
   shader_map_destroy(&cache->map);
+  if (cache->compiler != NULL)
+  {
+    shaderc_compiler_release(cache->compiler);
+  }
 }
 
 ShaderModule *shader_cache_load(VkDevice dev, ShaderCache *cache,
@@ -50,7 +57,7 @@ ShaderModule *shader_cache_load(VkDevice dev, ShaderCache *cache,
   ShaderModule *mod = shader_map_find(&cache->map, str);
   if (mod == NULL)
   {
-    ShaderModule module;
+    ShaderModule module = {0};
     Membuf file_contents;
     BSLCompileResult compile_result;
     shaderc_shader_kind kind;
@@ -60,7 +67,7 @@ ShaderModule *shader_cache_load(VkDevice dev, ShaderCache *cache,
     shaderc_compilation_result_t glsl_result;
     memcpy(zero_terminated, str->data, str->size);
     zero_terminated[str->size] = '\0';
-    result = membuf_load_file(&file_contents, zero_terminated);
+    result = archive_load_file(&file_contents, zero_terminated);
     if (!result) {
       MIUR_LOG_ERR("Failed to open shader file '%s'", zero_terminated);
       MIUR_FREE(zero_terminated);
@@ -82,7 +89,7 @@ ShaderModule *shader_cache_load(VkDevice dev, ShaderCache *cache,
     }
 
     glsl_result = shaderc_compile_into_spv(
-      cache->compiler,
+      get_compiler(cache),
       (char *) file_contents.data,
       file_contents.size,
       kind, zero_terminated, "main", 
@@ -114,7 +121,6 @@ ShaderModule *shader_cache_load(VkDevice dev, ShaderCache *cache,
     err = vkCreateShaderModule(dev, &shader_create_info, NULL, &module.module);
     if (err)
     {
-      membuf_destroy(&file_contents);
       MIUR_FREE(zero_terminated);
       MIUR_LOG_ERR("Failed to create shader module from shader file '%s': %d",
                    zero_terminated, err);
@@ -131,6 +137,56 @@ ShaderModule *shader_cache_load(VkDevice dev, ShaderCache *cache,
   return mod;
 }
 
+ShaderModule *shader_cache_load_spirv(VkDevice dev, ShaderCache *cache,
+                                      String *str,
+                                      VkShaderStageFlagBits stage,
+                                      const void *code, size_t size)
+{
+  ShaderModule *mod = shader_map_find(&cache->map, str);
+  if (mod != NULL)
+  {
+    return mod;
+  }
+
+  ShaderModule module = {
+    .stage = stage,
+  };
+  /* Kept NUL terminated like compiled shaders, hot reload looks them up. */
+  uint8_t *path = MIUR_ARR(uint8_t, str->size + 1);
+  uint8_t *new_data = MIUR_ARR_UNINIT(uint8_t, size);
+  if (path == NULL || new_data == NULL)
+  {
+    MIUR_FREE(path);
+    MIUR_FREE(new_data);
+    return NULL;
+  }
+  memcpy(path, str->data, str->size);
+  memcpy(new_data, code, size);
+  module.code.data = new_data;
+  module.code.size = size;
+
+  VkShaderModuleCreateInfo shader_create_info = {
+    .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+    .codeSize = size,
+    .pCode = (uint32_t *) module.code.data,
+  };
+  VkResult err = vkCreateShaderModule(dev, &shader_create_info, NULL,
+                                      &module.module);
+  if (err)
+  {
+    MIUR_LOG_ERR("Failed to create shader module for '%s': %d", path, err);
+    MIUR_FREE(path);
+    MIUR_FREE(new_data);
+    return NULL;
+  }
+
+  String new_str = {
+    .data = path,
+    .size = str->size,
+  };
+  return shader_map_insert(&cache->map, &new_str, &module);
+}
+
 ShaderModule *shader_cache_lookup(ShaderCache *cache, String *str)
 {
   return shader_map_find(&cache->map, str);
@@ -167,7 +223,7 @@ bool shader_cache_reload_shader(VkDevice dev, ShaderCache *cache,
   }
 
   glsl_result = shaderc_compile_into_spv(
-    cache->compiler,
+    get_compiler(cache),
     (char *) source.data,
     source.size,
     kind, path, "main", 
@@ -215,6 +271,15 @@ static void shader_destroy(void *ud, ShaderModule *module)
   vkDestroyShaderModule(*dev, module->module, NULL);
 }
 
+static shaderc_compiler_t get_compiler(ShaderCache *cache)
+{
+  if (cache->compiler == NULL)
+  {
+    cache->compiler = shaderc_compiler_initialize();
+  }
+  return cache->compiler;
+}
+
 const char *
 get_filename_ext(const char *filename) {
     const char *dot = strrchr(filename, '.');
@@ -0,0 +1,660 @@
+/* =====================
+ * src/simplify.c
+ * 10/18/2026
+ * Quadric error mesh simplification.
+ * ====================
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <miur/simplify.h>
+#include <miur/hash.h>
+#include <miur/mem.h>
+
+/* Border planes weigh this much more than faces, borders keep their shape. */
+#define SIMPLIFY_BORDER_WEIGHT 10.0f
+/* A collapse may turn no triangle further than about 75 degrees. */
+#define SIMPLIFY_FLIP_LIMIT 0.25f
+
+typedef enum
+{
+  VERTEX_MANIFOLD,
+  VERTEX_BORDER,
+  VERTEX_LOCKED,
+} VertexKind;
+
+/* Symmetric 3x3 A, b and c of the squared distance p'Ap + 2b'p + c. */
+typedef struct
+{
+  float a00, a11, a22, a01, a02, a12;
+  float b0, b1, b2;
+  float c;
+  float w;
+} Quadric;
+
+typedef struct
+{
+  uint32_t v, t;               /* v moves onto t. */
+  float cost;                  /* Orders collapses, includes attributes. */
+  float error;                 /* Squared distance, checked against limit. */
+} Collapse;
+
+typedef struct
+{
+  const uint32_t *indices;
+  const MeshSimplifyDesc *desc;
+  size_t vertex_count;
+
+  float *pos;                  /* Scaled into the unit cube. */
+  float extent;                /* Object space size of one unit. */
+  uint32_t *canon;             /* First vertex at the same position. */
+  uint8_t *kind;
+  Quadric *quadrics;
+
+  /* Triangles around each vertex of whatever adjacency_build was given. */
+  uint32_t *counts;
+  uint32_t *offsets;
+  uint32_t *adjacency;
+
+  uint32_t *remap;
+  uint8_t *locked;             /* Near a collapse made in this pass. */
+  Collapse *collapses;
+} Simplifier;
+
+/* === PROTOTYPES === */
+
+static bool simplifier_init(Simplifier *s, const uint32_t *indices,
+                            size_t index_count, const float *positions,
+                            size_t vertex_count, const MeshSimplifyDesc *desc);
+static void simplifier_destroy(Simplifier *s);
+static bool find_positions(Simplifier *s, const float *positions);
+static void adjacency_build(Simplifier *s, const uint32_t *indices,
+                            size_t index_count, const uint32_t *map);
+static bool has_edge(const uint32_t *tri, const uint32_t *map, uint32_t a,
+                     uint32_t b);
+static void classify(Simplifier *s, size_t index_count);
+static void add_face_quadrics(Simplifier *s, size_t index_count);
+static void add_border_quadric(Simplifier *s, uint32_t a, uint32_t b,
+                               uint32_t c);
+static size_t pick_collapses(Simplifier *s, const uint32_t *indices);
+static bool can_collapse(const Simplifier *s, const uint32_t *indices,
+                         uint32_t v, uint32_t t);
+static bool flips(const Simplifier *s, const uint32_t *indices, uint32_t v,
+                  uint32_t t);
+static size_t apply_collapses(Simplifier *s, const uint32_t *indices,
+                              size_t collapse_count, size_t goal,
+                              float *error_max);
+static size_t rewrite_indices(const Simplifier *s, uint32_t *indices,
+                              size_t index_count);
+static void quadric_plane(Quadric *q, const float n[3], float d, float w);
+static void quadric_add(Quadric *q, const Quadric *r);
+static float quadric_error(const Quadric *q, const float p[3]);
+static void cross(float out[3], const float a[3], const float b[3]);
+static int compare_collapses(const void *a, const void *b);
+
+/* === PUBLIC FUNCTIONS === */
+
+bool mesh_simplify(uint32_t *dst, size_t *index_count_out, float *error_out,
+                   const uint32_t *indices, size_t index_count,
+                   const float *positions, size_t vertex_count,
+                   const MeshSimplifyDesc *desc)
+{
+  size_t count = index_count / 3 * 3;
+  memcpy(dst, indices, count * sizeof(uint32_t));
+  *index_count_out = count;
+  *error_out = 0.0f;
+  if (count == 0 || count <= desc->target_index_count)
+  {
+    return true;
+  }
+
+  Simplifier s;
+  bool result = false;
+  if (!simplifier_init(&s, indices, count, positions, vertex_count, desc))
+  {
+    goto cleanup;
+  }
+  classify(&s, count);
+  add_face_quadrics(&s, count);
+
+  float limit = desc->target_error * desc->target_error;
+  float error_max = 0.0f;
+  while (count > desc->target_index_count)
+  {
+    adjacency_build(&s, dst, count, NULL);
+    size_t collapse_count = pick_collapses(&s, dst);
+    qsort(s.collapses, collapse_count, sizeof(Collapse), compare_collapses);
+
+    /* Only collapses within the limit are kept, see apply_collapses. */
+    size_t kept = 0;
+    for (size_t i = 0; i < collapse_count; i++)
+    {
+      if (s.collapses[i].error <= limit)
+      {
+        s.collapses[kept++] = s.collapses[i];
+      }
+    }
+    size_t goal = (count - desc->target_index_count) / 3;
+    if (apply_collapses(&s, dst, kept, goal, &error_max) == 0)
+    {
+      break;
+    }
+    count = rewrite_indices(&s, dst, count);
+  }
+
+  *index_count_out = count;
+  *error_out = sqrtf(error_max) * s.extent;
+  result = true;
+
+cleanup:
+  simplifier_destroy(&s);
+  return result;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static bool simplifier_init(Simplifier *s, const uint32_t *indices,
+                            size_t index_count, const float *positions,
+                            size_t vertex_count, const MeshSimplifyDesc *desc)
+{
+  memset(s, 0, sizeof(Simplifier));
+  s->indices = indices;
+  s->desc = desc;
+  s->vertex_count = vertex_count;
+  s->pos = MIUR_ARR_UNINIT(float, vertex_count * 3);
+  s->canon = MIUR_ARR_UNINIT(uint32_t, vertex_count);
+  s->kind = MIUR_ARR(uint8_t, vertex_count);
+  s->quadrics = MIUR_ARR(Quadric, vertex_count);
+  s->counts = MIUR_ARR_UNINIT(uint32_t, vertex_count);
+  s->offsets = MIUR_ARR_UNINIT(uint32_t, vertex_count);
+  s->adjacency = MIUR_ARR_UNINIT(uint32_t, index_count);
+  s->remap = MIUR_ARR_UNINIT(uint32_t, vertex_count);
+  s->locked = MIUR_ARR_UNINIT(uint8_t, vertex_count);
+  s->collapses = MIUR_ARR_UNINIT(Collapse, vertex_count);
+  if (s->pos == NULL || s->canon == NULL || s->kind == NULL ||
+      s->quadrics == NULL || s->counts == NULL || s->offsets == NULL ||
+      s->adjacency == NULL || s->remap == NULL || s->locked == NULL ||
+      s->collapses == NULL || !find_positions(s, positions))
+  {
+    return false;
+  }
+
+  /* Errors are relative to the extent, so scale it to 1. */
+  float min[3] = { INFINITY, INFINITY, INFINITY };
+  float max[3] = { -INFINITY, -INFINITY, -INFINITY };
+  for (size_t v = 0; v < vertex_count; v++)
+  {
+    for (int c = 0; c < 3; c++)
+    {
+      float p = positions[v * 3 + c];
+      min[c] = p < min[c] ? p : min[c];
+      max[c] = p > max[c] ? p : max[c];
+    }
+  }
+  float extent = 0.0f;
+  for (int c = 0; c < 3; c++)
+  {
+    extent = max[c] - min[c] > extent ? max[c] - min[c] : extent;
+  }
+  s->extent = extent > 0.0f ? extent : 1.0f;
+  float inv_extent = 1.0f / s->extent;
+  for (size_t v = 0; v < vertex_count; v++)
+  {
+    for (int c = 0; c < 3; c++)
+    {
+      s->pos[v * 3 + c] = (positions[v * 3 + c] - min[c]) * inv_extent;
+    }
+    s->remap[v] = (uint32_t) v;
+  }
+  return true;
+}
+
+static void simplifier_destroy(Simplifier *s)
+{
+  MIUR_FREE(s->pos);
+  MIUR_FREE(s->canon);
+  MIUR_FREE(s->kind);
+  MIUR_FREE(s->quadrics);
+  MIUR_FREE(s->counts);
+  MIUR_FREE(s->offsets);
+  MIUR_FREE(s->adjacency);
+  MIUR_FREE(s->remap);
+  MIUR_FREE(s->locked);
+  MIUR_FREE(s->collapses);
+}
+
+/* Open addressing on the exact position bits. */
+static bool find_positions(Simplifier *s, const float *positions)
+{
+  size_t capacity = 16;
+  while (capacity < s->vertex_count * 2)
+  {
+    capacity *= 2;
+  }
+  uint32_t *table = MIUR_ARR_UNINIT(uint32_t, capacity);
+  if (table == NULL)
+  {
+    return false;
+  }
+  memset(table, 0xFF, capacity * sizeof(uint32_t));
+
+  for (size_t v = 0; v < s->vertex_count; v++)
+  {
+    const float *p = &positions[v * 3];
+    size_t slot = (size_t) hash64(p, sizeof(float) * 3, 0) & (capacity - 1);
+    while (table[slot] != UINT32_MAX &&
+           memcmp(&positions[(size_t) table[slot] * 3], p,
+                  sizeof(float) * 3) != 0)
+    {
+      slot = (slot + 1) & (capacity - 1);
+    }
+    if (table[slot] == UINT32_MAX)
+    {
+      table[slot] = (uint32_t) v;
+    }
+    s->canon[v] = table[slot];
+  }
+  MIUR_FREE(table);
+  return true;
+}
+
+/* Groups triangles by `map[v]`, or by v itself if `map` is NULL. */
+static void adjacency_build(Simplifier *s, const uint32_t *indices,
+                            size_t index_count, const uint32_t *map)
+{
+  memset(s->counts, 0, s->vertex_count * sizeof(uint32_t));
+  for (size_t i = 0; i < index_count; i++)
+  {
+    s->counts[map != NULL ? map[indices[i]] : indices[i]]++;
+  }
+  uint32_t offset = 0;
+  for (size_t v = 0; v < s->vertex_count; v++)
+  {
+    s->offsets[v] = offset;
+    offset += s->counts[v];
+  }
+  for (size_t i = 0; i < index_count; i++)
+  {
+    uint32_t v = map != NULL ? map[indices[i]] : indices[i];
+    s->adjacency[s->offsets[v]++] = (uint32_t) (i / 3);
+  }
+  for (size_t v = 0; v < s->vertex_count; v++)
+  {
+    s->offsets[v] -= s->counts[v];
+  }
+}
+
+/* Whether `tri` has the directed edge a -> b, comparing through `map`. */
+static bool has_edge(const uint32_t *tri, const uint32_t *map, uint32_t a,
+                     uint32_t b)
+{
+  for (int k = 0; k < 3; k++)
+  {
+    if (map[tri[k]] == a && map[tri[(k + 1) % 3]] == b)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Seams and non-manifold edges are locked, open edges are borders.  Edges
+ * are compared by position so a seam doesn't look like two borders.
+ */
+static void classify(Simplifier *s, size_t index_count)
+{
+  const uint32_t *indices = s->indices;
+  uint8_t border_kind = s->desc->flags & MESH_SIMPLIFY_LOCK_BORDER ?
+    VERTEX_LOCKED : VERTEX_BORDER;
+
+  /* More than one vertex at a position is a seam. */
+  uint32_t *wedges = s->remap;
+  memset(wedges, 0, s->vertex_count * sizeof(uint32_t));
+  for (size_t v = 0; v < s->vertex_count; v++)
+  {
+    wedges[s->canon[v]]++;
+  }
+  for (size_t v = 0; v < s->vertex_count; v++)
+  {
+    s->kind[v] = wedges[s->canon[v]] > 1 ? VERTEX_LOCKED : VERTEX_MANIFOLD;
+  }
+  for (size_t v = 0; v < s->vertex_count; v++)
+  {
+    s->remap[v] = (uint32_t) v;
+  }
+
+  adjacency_build(s, indices, index_count, s->canon);
+  for (size_t i = 0; i < index_count; i++)
+  {
+    uint32_t a = indices[i];
+    uint32_t b = indices[i - i % 3 + (i + 1) % 3];
+    uint32_t ca = s->canon[a], cb = s->canon[b];
+    if (ca == cb)
+    {
+      continue;
+    }
+
+    uint32_t same = 0, opposite = 0;
+    for (uint32_t k = 0; k < s->counts[ca]; k++)
+    {
+      same += has_edge(&indices[(size_t) s->adjacency[s->offsets[ca] + k] *
+                                3], s->canon, ca, cb);
+    }
+    for (uint32_t k = 0; k < s->counts[cb]; k++)
+    {
+      opposite += has_edge(&indices[(size_t) s->adjacency[s->offsets[cb] + k] *
+                                    3], s->canon, cb, ca);
+    }
+
+    if (same > 1 || opposite > 1)
+    {
+      s->kind[a] = VERTEX_LOCKED;
+      s->kind[b] = VERTEX_LOCKED;
+    }
+    else if (opposite == 0)
+    {
+      s->kind[a] = s->kind[a] > border_kind ? s->kind[a] : border_kind;
+      s->kind[b] = s->kind[b] > border_kind ? s->kind[b] : border_kind;
+      add_border_quadric(s, a, b, indices[i - i % 3 + (i + 2) % 3]);
+    }
+  }
+}
+
+/* Each face's plane, weighted by its area, goes to its three vertices. */
+static void add_face_quadrics(Simplifier *s, size_t index_count)
+{
+  for (size_t i = 0; i < index_count; i += 3)
+  {
+    const float *p0 = &s->pos[(size_t) s->indices[i] * 3];
+    const float *p1 = &s->pos[(size_t) s->indices[i + 1] * 3];
+    const float *p2 = &s->pos[(size_t) s->indices[i + 2] * 3];
+    float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    float n[3];
+    cross(n, e1, e2);
+    float len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (len == 0.0f)
+    {
+      continue;
+    }
+    for (int c = 0; c < 3; c++)
+    {
+      n[c] /= len;
+    }
+
+    Quadric q;
+    quadric_plane(&q, n, -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]),
+                  len * 0.5f);
+    for (int k = 0; k < 3; k++)
+    {
+      quadric_add(&s->quadrics[s->indices[i + k]], &q);
+    }
+  }
+}
+
+/* The plane through border edge a-b at right angles to its face a-b-c. */
+static void add_border_quadric(Simplifier *s, uint32_t a, uint32_t b,
+                               uint32_t c)
+{
+  const float *pa = &s->pos[(size_t) a * 3];
+  const float *pb = &s->pos[(size_t) b * 3];
+  const float *pc = &s->pos[(size_t) c * 3];
+  float edge[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+  float side[3] = { pc[0] - pa[0], pc[1] - pa[1], pc[2] - pa[2] };
+  float face[3], n[3];
+  cross(face, edge, side);
+  cross(n, edge, face);
+  float len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+  if (len == 0.0f)
+  {
+    return;
+  }
+  for (int c = 0; c < 3; c++)
+  {
+    n[c] /= len;
+  }
+
+  float edge_len2 = edge[0] * edge[0] + edge[1] * edge[1] +
+    edge[2] * edge[2];
+  Quadric q;
+  quadric_plane(&q, n, -(n[0] * pa[0] + n[1] * pa[1] + n[2] * pa[2]),
+                edge_len2 * SIMPLIFY_BORDER_WEIGHT);
+  quadric_add(&s->quadrics[a], &q);
+  quadric_add(&s->quadrics[b], &q);
+}
+
+/* The cheapest collapse of every vertex that can move. */
+static size_t pick_collapses(Simplifier *s, const uint32_t *indices)
+{
+  const MeshSimplifyDesc *desc = s->desc;
+  size_t count = 0;
+  for (uint32_t v = 0; v < s->vertex_count; v++)
+  {
+    if (s->kind[v] == VERTEX_LOCKED || s->counts[v] == 0)
+    {
+      continue;
+    }
+
+    Collapse best = { v, v, INFINITY, INFINITY };
+    const uint32_t *tris = s->adjacency + s->offsets[v];
+    for (uint32_t k = 0; k < s->counts[v]; k++)
+    {
+      const uint32_t *tri = &indices[(size_t) tris[k] * 3];
+      for (int c = 0; c < 3; c++)
+      {
+        uint32_t t = tri[c];
+        if (t == v || !can_collapse(s, indices, v, t))
+        {
+          continue;
+        }
+
+        Quadric q = s->quadrics[v];
+        quadric_add(&q, &s->quadrics[t]);
+        float error = quadric_error(&q, &s->pos[(size_t) t * 3]);
+        float cost = error;
+        for (size_t a = 0; a < desc->attribute_count; a++)
+        {
+          float d = (desc->attributes[v * desc->attribute_count + a] -
+                     desc->attributes[t * desc->attribute_count + a]) *
+            desc->attribute_weights[a];
+          cost += d * d;
+        }
+        if (cost < best.cost)
+        {
+          best = (Collapse) { v, t, cost, error };
+        }
+      }
+    }
+    if (best.t != v)
+    {
+      s->collapses[count++] = best;
+    }
+  }
+  return count;
+}
+
+/*
+ * Manifold vertices go anywhere.  Border vertices only slide along a border
+ * edge onto another border vertex, which keeps the outline.
+ */
+static bool can_collapse(const Simplifier *s, const uint32_t *indices,
+                         uint32_t v, uint32_t t)
+{
+  if (s->kind[v] == VERTEX_MANIFOLD)
+  {
+    return true;
+  }
+  if (s->kind[t] == VERTEX_MANIFOLD)
+  {
+    return false;
+  }
+
+  uint32_t ct = s->canon[t];
+  uint32_t shared = 0;
+  const uint32_t *tris = s->adjacency + s->offsets[v];
+  for (uint32_t k = 0; k < s->counts[v]; k++)
+  {
+    const uint32_t *tri = &indices[(size_t) tris[k] * 3];
+    shared += s->canon[tri[0]] == ct || s->canon[tri[1]] == ct ||
+      s->canon[tri[2]] == ct;
+  }
+  return shared == 1;
+}
+
+/* Whether moving v onto t turns some remaining triangle over. */
+static bool flips(const Simplifier *s, const uint32_t *indices, uint32_t v,
+                  uint32_t t)
+{
+  const float *pt = &s->pos[(size_t) t * 3];
+  const uint32_t *tris = s->adjacency + s->offsets[v];
+  for (uint32_t k = 0; k < s->counts[v]; k++)
+  {
+    const uint32_t *tri = &indices[(size_t) tris[k] * 3];
+    if (tri[0] == t || tri[1] == t || tri[2] == t)
+    {
+      continue;
+    }
+
+    int corner = tri[0] == v ? 0 : tri[1] == v ? 1 : 2;
+    const float *pv = &s->pos[(size_t) v * 3];
+    const float *p1 = &s->pos[(size_t) tri[(corner + 1) % 3] * 3];
+    const float *p2 = &s->pos[(size_t) tri[(corner + 2) % 3] * 3];
+    float e1[3] = { p1[0] - pv[0], p1[1] - pv[1], p1[2] - pv[2] };
+    float e2[3] = { p2[0] - pv[0], p2[1] - pv[1], p2[2] - pv[2] };
+    float f1[3] = { p1[0] - pt[0], p1[1] - pt[1], p1[2] - pt[2] };
+    float f2[3] = { p2[0] - pt[0], p2[1] - pt[1], p2[2] - pt[2] };
+    float before[3], after[3];
+    cross(before, e1, e2);
+    cross(after, f1, f2);
+    float dot = before[0] * after[0] + before[1] * after[1] +
+      before[2] * after[2];
+    float len2 = (before[0] * before[0] + before[1] * before[1] +
+                  before[2] * before[2]) *
+      (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]);
+    if (dot <= 0.0f ||
+        dot * dot < SIMPLIFY_FLIP_LIMIT * SIMPLIFY_FLIP_LIMIT * len2)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Applies the sorted collapses until `goal` triangles are gone.  Everything
+ * around a collapse is locked for the rest of the pass, so each one sees the
+ * positions it was scored with.  Returns how many were applied.
+ */
+static size_t apply_collapses(Simplifier *s, const uint32_t *indices,
+                              size_t collapse_count, size_t goal,
+                              float *error_max)
+{
+  memset(s->locked, 0, s->vertex_count);
+  size_t applied = 0, removed = 0;
+  for (size_t i = 0; i < collapse_count && removed < goal; i++)
+  {
+    const Collapse *c = &s->collapses[i];
+    if (s->locked[c->v] || s->locked[c->t] ||
+        flips(s, indices, c->v, c->t))
+    {
+      continue;
+    }
+
+    s->remap[c->v] = c->t;
+    quadric_add(&s->quadrics[c->t], &s->quadrics[c->v]);
+    *error_max = c->error > *error_max ? c->error : *error_max;
+    const uint32_t *tris = s->adjacency + s->offsets[c->v];
+    for (uint32_t k = 0; k < s->counts[c->v]; k++)
+    {
+      const uint32_t *tri = &indices[(size_t) tris[k] * 3];
+      removed += tri[0] == c->t || tri[1] == c->t || tri[2] == c->t;
+      s->locked[tri[0]] = 1;
+      s->locked[tri[1]] = 1;
+      s->locked[tri[2]] = 1;
+    }
+    applied++;
+  }
+  return applied;
+}
+
+/* Remaps in place and drops triangles that collapsed. */
+static size_t rewrite_indices(const Simplifier *s, uint32_t *indices,
+                              size_t index_count)
+{
+  size_t out = 0;
+  for (size_t i = 0; i < index_count; i += 3)
+  {
+    uint32_t a = s->remap[indices[i]];
+    uint32_t b = s->remap[indices[i + 1]];
+    uint32_t c = s->remap[indices[i + 2]];
+    if (a != b && b != c && a != c)
+    {
+      indices[out++] = a;
+      indices[out++] = b;
+      indices[out++] = c;
+    }
+  }
+  return out;
+}
+
+static void quadric_plane(Quadric *q, const float n[3], float d, float w)
+{
+  q->a00 = w * n[0] * n[0];
+  q->a11 = w * n[1] * n[1];
+  q->a22 = w * n[2] * n[2];
+  q->a01 = w * n[0] * n[1];
+  q->a02 = w * n[0] * n[2];
+  q->a12 = w * n[1] * n[2];
+  q->b0 = w * n[0] * d;
+  q->b1 = w * n[1] * d;
+  q->b2 = w * n[2] * d;
+  q->c = w * d * d;
+  q->w = w;
+}
+
+static void quadric_add(Quadric *q, const Quadric *r)
+{
+  q->a00 += r->a00;
+  q->a11 += r->a11;
+  q->a22 += r->a22;
+  q->a01 += r->a01;
+  q->a02 += r->a02;
+  q->a12 += r->a12;
+  q->b0 += r->b0;
+  q->b1 += r->b1;
+  q->b2 += r->b2;
+  q->c += r->c;
+  q->w += r->w;
+}
+
+/* The weighted mean squared distance from p to the planes in q. */
+static float quadric_error(const Quadric *q, const float p[3])
+{
+  float x = p[0], y = p[1], z = p[2];
+  float e = q->a00 * x * x + q->a11 * y * y + q->a22 * z * z +
+    2.0f * (q->a01 * x * y + q->a02 * x * z + q->a12 * y * z) +
+    2.0f * (q->b0 * x + q->b1 * y + q->b2 * z) + q->c;
+  e = q->w > 0.0f ? e / q->w : 0.0f;
+  return e > 0.0f ? e : 0.0f;
+}
+
+static void cross(float out[3], const float a[3], const float b[3])
+{
+  out[0] = a[1] * b[2] - a[2] * b[1];
+  out[1] = a[2] * b[0] - a[0] * b[2];
+  out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static int compare_collapses(const void *a, const void *b)
+{
+  const Collapse *ca = (const Collapse *) a;
+  const Collapse *cb = (const Collapse *) b;
+  if (ca->cost != cb->cost)
+  {
+    return ca->cost < cb->cost ? -1 : 1;
+  }
+  return ca->v < cb->v ? -1 : ca->v > cb->v;
+}
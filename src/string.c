@@ -17,9 +17,16 @@ bool string_eq(String *str1, String *str2)
     strncmp(str1->data, str2->data, str1->size) == 0;
 }
 
+/* 32 bit FNV-1a. */
 uint32_t string_hash(String *str)
 {
-  return str->size;
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < str->size; i++)
+  {
+    hash ^= str->data[i];
+    hash *= 16777619u;
+  }
+  return hash;
 }
 
 void string_print(String *str)
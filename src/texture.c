@@ -0,0 +1,607 @@
+/* =====================
+ * src/texture.c
+ * 10/18/2026
+ * Mipmapped textures.
+ * ====================
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <miur/log.h>
+#include <miur/mem.h>
+#include <miur/simd.h>
+#include <miur/texture.h>
+
+#define KAISER_ALPHA 4.0f
+/* Radius in destination texels, the sinc's third zero. */
+#define KAISER_WIDTH 3.0f
+#define PI 3.14159265358979f
+
+/*
+ * Linear values from 2^-SRGB_ENCODE_OCTAVES up to 1 map to sRGB bytes by
+ * interpolating between the exact curve at SRGB_ENCODE_STEPS points per
+ * octave, found from the float's exponent and top mantissa bits.  Below
+ * that the curve is linear anyway.
+ */
+#define SRGB_ENCODE_OCTAVES 12
+#define SRGB_ENCODE_STEP_BITS 3
+#define SRGB_ENCODE_BUCKETS (SRGB_ENCODE_OCTAVES << SRGB_ENCODE_STEP_BITS)
+#define SRGB_ENCODE_MIN_BITS ((uint32_t) (127 - SRGB_ENCODE_OCTAVES) << 23)
+#define SRGB_ENCODE_FRAC_BITS (23 - SRGB_ENCODE_STEP_BITS)
+#define SRGB_ENCODE_MIN (1.0f / (float) (1 << SRGB_ENCODE_OCTAVES))
+
+/* Conversions between texel bytes and the linear floats filtered. */
+typedef struct
+{
+  bool srgb;
+  float decode[256];
+  float encode[SRGB_ENCODE_BUCKETS + 1];
+} TexelTables;
+
+/*
+ * The source texels and weights of every destination texel along one axis,
+ * `taps` of each.  Edges clamp, so an index may repeat.
+ */
+typedef struct
+{
+  uint32_t taps;
+  uint32_t *indices;
+  float *weights;
+} FilterTaps;
+
+/* === PROTOTYPES === */
+
+static void init_tables(TexelTables *tables, bool srgb);
+static float srgb_to_linear(float value);
+static float linear_to_srgb(float value);
+static uint8_t encode_srgb(const TexelTables *tables, float value);
+static bool downsample(const TexelTables *tables, MipFilter filter,
+                       const uint8_t *src, uint32_t src_width,
+                       uint32_t src_height, uint8_t *dst, uint32_t dst_width,
+                       uint32_t dst_height);
+static bool downsample_box(const TexelTables *tables, const uint8_t *src,
+                           uint32_t src_width, uint32_t src_height,
+                           uint8_t *dst, uint32_t dst_width,
+                           uint32_t dst_height);
+static bool build_taps(FilterTaps *taps, MipFilter filter,
+                       uint32_t src_size, uint32_t dst_size);
+static void destroy_taps(FilterTaps *taps);
+static float kaiser(float x);
+static float bessel0(float x);
+static void decode_row(const TexelTables *tables, const uint8_t *src,
+                       uint32_t width, float *dst);
+static void encode_row(const TexelTables *tables, const float *src,
+                       uint32_t width, uint8_t *dst);
+static void box_row(const float *row0, const float *row1, uint32_t src_width,
+                    float *dst, uint32_t dst_width);
+static void accumulate_row(float *acc, const float *row, float weight,
+                           size_t count);
+static void filter_row(const float *src, const FilterTaps *taps,
+                       uint32_t width, float *dst);
+
+/* === GLOBALS === */
+
+const TextureSampler texture_sampler_default = {
+  .mag_linear = true,
+  .min_linear = true,
+  .mip_linear = true,
+  .mipmapped = true,
+  .wrap_u = TEXTURE_WRAP_REPEAT,
+  .wrap_v = TEXTURE_WRAP_REPEAT,
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+bool texture_decode(Texture *out, const uint8_t *data, size_t size,
+                    bool srgb, MipFilter filter)
+{
+  Image image;
+  memset(out, 0, sizeof(Texture));
+  if (!image_decode(&image, data, size))
+  {
+    return false;
+  }
+  return texture_from_image(out, &image, srgb, filter);
+}
+
+bool texture_from_image(Texture *out, Image *image, bool srgb,
+                        MipFilter filter)
+{
+  memset(out, 0, sizeof(Texture));
+  if (!texture_layout(out, srgb ? TEXTURE_FORMAT_RGBA8_SRGB :
+                      TEXTURE_FORMAT_RGBA8, image->width, image->height))
+  {
+    image_destroy(image);
+    return false;
+  }
+
+  /* The image's rows are already level 0, grow them to fit the rest. */
+  out->data = MIUR_REALLOC(uint8_t, image->pixels, out->size);
+  if (out->data == NULL)
+  {
+    image_destroy(image);
+    memset(out, 0, sizeof(Texture));
+    return false;
+  }
+  image->pixels = NULL;
+  image_destroy(image);
+
+  TexelTables tables;
+  init_tables(&tables, srgb);
+  for (uint32_t i = 1; i < out->mip_count; i++)
+  {
+    const TextureMip *src = &out->mips[i - 1];
+    const TextureMip *dst = &out->mips[i];
+    if (!downsample(&tables, filter, out->data + src->offset, src->width,
+                    src->height, out->data + dst->offset, dst->width,
+                    dst->height))
+    {
+      texture_destroy(out);
+      return false;
+    }
+  }
+  return true;
+}
+
+void texture_destroy(Texture *texture)
+{
+  MIUR_FREE(texture->data);
+  memset(texture, 0, sizeof(Texture));
+}
+
+bool texture_layout(Texture *texture, TextureFormat format, uint32_t width,
+                    uint32_t height)
+{
+  if (width == 0 || height == 0 || width > IMAGE_MAX_DIMENSION ||
+      height > IMAGE_MAX_DIMENSION || format >= TEXTURE_FORMAT_COUNT)
+  {
+    return false;
+  }
+
+  /* Compressed levels round up to whole blocks, down to the last 1x1. */
+  uint32_t block_size = texture_format_block_size(format);
+  texture->format = format;
+  texture->width = width;
+  texture->height = height;
+  size_t offset = 0;
+  for (uint32_t i = 0; i < TEXTURE_MAX_MIPS; i++)
+  {
+    TextureMip *mip = &texture->mips[i];
+    mip->width = width;
+    mip->height = height;
+    mip->offset = offset;
+    mip->size = block_size == 0 ? (size_t) width * height * 4 :
+      (size_t) ((width + 3) / 4) * ((height + 3) / 4) * block_size;
+    offset = (offset + mip->size + TEXTURE_MIP_ALIGNMENT - 1) &
+      ~(size_t) (TEXTURE_MIP_ALIGNMENT - 1);
+    texture->mip_count = i + 1;
+    if (width == 1 && height == 1)
+    {
+      break;
+    }
+    width = width > 1 ? width / 2 : 1;
+    height = height > 1 ? height / 2 : 1;
+  }
+  texture->size = offset;
+  return true;
+}
+
+void texture_truncate_mips(Texture *texture, uint32_t mip_count)
+{
+  if (mip_count < texture->mip_count)
+  {
+    texture->mip_count = mip_count;
+    texture->size = texture->mips[mip_count].offset;
+  }
+}
+
+uint32_t texture_format_block_size(TextureFormat format)
+{
+  switch (format)
+  {
+  case TEXTURE_FORMAT_BC1:
+  case TEXTURE_FORMAT_BC1_SRGB:
+    return 8;
+  case TEXTURE_FORMAT_BC3:
+  case TEXTURE_FORMAT_BC3_SRGB:
+  case TEXTURE_FORMAT_BC5:
+  case TEXTURE_FORMAT_BC7:
+  case TEXTURE_FORMAT_BC7_SRGB:
+    return 16;
+  default:
+    return 0;
+  }
+}
+
+bool texture_format_is_srgb(TextureFormat format)
+{
+  return format == TEXTURE_FORMAT_RGBA8_SRGB ||
+    format == TEXTURE_FORMAT_BC1_SRGB || format == TEXTURE_FORMAT_BC3_SRGB ||
+    format == TEXTURE_FORMAT_BC7_SRGB;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/* Built per texture, a few hundred pow() calls next to millions of texels. */
+static void init_tables(TexelTables *tables, bool srgb)
+{
+  tables->srgb = srgb;
+  for (uint32_t i = 0; i < 256; i++)
+  {
+    float value = (float) i / 255.0f;
+    tables->decode[i] = srgb ? srgb_to_linear(value) : value;
+  }
+  for (uint32_t i = 0; i <= SRGB_ENCODE_BUCKETS; i++)
+  {
+    float value = ldexpf(1.0f + (float) (i & 7) / 8.0f,
+                         (int) (i >> SRGB_ENCODE_STEP_BITS) -
+                         SRGB_ENCODE_OCTAVES);
+    tables->encode[i] = linear_to_srgb(value) * 255.0f;
+  }
+}
+
+static float srgb_to_linear(float value)
+{
+  return value <= 0.04045f ? value / 12.92f :
+    powf((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float linear_to_srgb(float value)
+{
+  return value <= 0.0031308f ? value * 12.92f :
+    1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+}
+
+static uint8_t encode_srgb(const TexelTables *tables, float value)
+{
+  if (!(value >= SRGB_ENCODE_MIN))
+  {
+    return (uint8_t) (value > 0.0f ? value * 12.92f * 255.0f + 0.5f : 0.0f);
+  }
+  if (value >= 1.0f)
+  {
+    return 255;
+  }
+
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  bits -= SRGB_ENCODE_MIN_BITS;
+  uint32_t bucket = bits >> SRGB_ENCODE_FRAC_BITS;
+  float frac = (float) (bits & ((1u << SRGB_ENCODE_FRAC_BITS) - 1)) *
+    (1.0f / (float) (1u << SRGB_ENCODE_FRAC_BITS));
+  float low = tables->encode[bucket];
+  return (uint8_t) (low + (tables->encode[bucket + 1] - low) * frac + 0.5f);
+}
+
+/*
+ * Filters one level into the next.  Both filters are separable: source rows
+ * are decoded to linear floats once each, weighted into a row of vertical
+ * sums and that row is filtered horizontally.
+ */
+static bool downsample(const TexelTables *tables, MipFilter filter,
+                       const uint8_t *src, uint32_t src_width,
+                       uint32_t src_height, uint8_t *dst, uint32_t dst_width,
+                       uint32_t dst_height)
+{
+  bool halves = (src_width == dst_width * 2 || src_width == 1) &&
+    (src_height == dst_height * 2 || src_height == 1);
+  if (filter == MIP_FILTER_BOX && halves)
+  {
+    return downsample_box(tables, src, src_width, src_height, dst, dst_width,
+                          dst_height);
+  }
+
+  bool result = false;
+  FilterTaps horizontal = { 0 }, vertical = { 0 };
+  size_t row_floats = (size_t) src_width * 4;
+  float *rows = NULL;
+  uint32_t *row_tags = NULL;
+  float *acc = MIUR_ARR_UNINIT(float, row_floats);
+  float *out = MIUR_ARR_UNINIT(float, (size_t) dst_width * 4);
+  if (acc == NULL || out == NULL ||
+      !build_taps(&horizontal, filter, src_width, dst_width) ||
+      !build_taps(&vertical, filter, src_height, dst_height))
+  {
+    goto cleanup;
+  }
+
+  /* A ring of decoded rows, as many as one destination row reads. */
+  uint32_t ring = vertical.taps;
+  rows = MIUR_ARR_UNINIT(float, row_floats * ring);
+  row_tags = MIUR_ARR_UNINIT(uint32_t, ring);
+  if (rows == NULL || row_tags == NULL)
+  {
+    goto cleanup;
+  }
+  memset(row_tags, 0xff, sizeof(uint32_t) * ring);
+
+  for (uint32_t y = 0; y < dst_height; y++)
+  {
+    memset(acc, 0, sizeof(float) * row_floats);
+    for (uint32_t t = 0; t < vertical.taps; t++)
+    {
+      uint32_t sy = vertical.indices[(size_t) y * vertical.taps + t];
+      float weight = vertical.weights[(size_t) y * vertical.taps + t];
+      float *row = rows + (size_t) (sy % ring) * row_floats;
+      if (weight == 0.0f)
+      {
+        continue;
+      }
+      if (row_tags[sy % ring] != sy)
+      {
+        decode_row(tables, src + (size_t) sy * src_width * 4, src_width, row);
+        row_tags[sy % ring] = sy;
+      }
+      accumulate_row(acc, row, weight, row_floats);
+    }
+    filter_row(acc, &horizontal, dst_width, out);
+    encode_row(tables, out, dst_width, dst + (size_t) y * dst_width * 4);
+  }
+  result = true;
+
+cleanup:
+  destroy_taps(&horizontal);
+  destroy_taps(&vertical);
+  MIUR_FREE(rows);
+  MIUR_FREE(row_tags);
+  MIUR_FREE(acc);
+  MIUR_FREE(out);
+  return result;
+}
+
+/* The common case, a 2x2 average, or 2x1 where an axis is down to 1. */
+static bool downsample_box(const TexelTables *tables, const uint8_t *src,
+                           uint32_t src_width, uint32_t src_height,
+                           uint8_t *dst, uint32_t dst_width,
+                           uint32_t dst_height)
+{
+  size_t row_floats = (size_t) src_width * 4;
+  float *rows = MIUR_ARR_UNINIT(float, row_floats * 2);
+  float *out = MIUR_ARR_UNINIT(float, (size_t) dst_width * 4);
+  if (rows == NULL || out == NULL)
+  {
+    MIUR_FREE(rows);
+    MIUR_FREE(out);
+    return false;
+  }
+
+  size_t src_stride = (size_t) src_width * 4;
+  for (uint32_t y = 0; y < dst_height; y++)
+  {
+    const uint8_t *row0 = src + (size_t) y * (src_height > 1 ? 2 : 1) *
+      src_stride;
+    const uint8_t *row1 = src_height > 1 ? row0 + src_stride : row0;
+    decode_row(tables, row0, src_width, rows);
+    decode_row(tables, row1, src_width, rows + row_floats);
+    box_row(rows, rows + row_floats, src_width, out, dst_width);
+    encode_row(tables, out, dst_width, dst + (size_t) y * dst_width * 4);
+  }
+  MIUR_FREE(rows);
+  MIUR_FREE(out);
+  return true;
+}
+
+/*
+ * Boxes weigh each source texel by how much of it the destination texel
+ * covers, Kaiser by the kernel at its center.  Weights are normalized, so
+ * clamped taps at the edges keep the brightness.
+ */
+static bool build_taps(FilterTaps *taps, MipFilter filter, uint32_t src_size,
+                       uint32_t dst_size)
+{
+  float scale = (float) src_size / (float) dst_size;
+  float radius = filter == MIP_FILTER_BOX ? scale * 0.5f :
+    KAISER_WIDTH * scale;
+  taps->taps = (uint32_t) ceilf(radius * 2.0f) + 2;
+  taps->indices = MIUR_ARR(uint32_t, (size_t) dst_size * taps->taps);
+  taps->weights = MIUR_ARR(float, (size_t) dst_size * taps->taps);
+  if (taps->indices == NULL || taps->weights == NULL)
+  {
+    destroy_taps(taps);
+    return false;
+  }
+
+  for (uint32_t x = 0; x < dst_size; x++)
+  {
+    float center = ((float) x + 0.5f) * scale;
+    int32_t first = (int32_t) floorf(center - radius);
+    uint32_t *indices = taps->indices + (size_t) x * taps->taps;
+    float *weights = taps->weights + (size_t) x * taps->taps;
+    float total = 0.0f;
+    for (uint32_t t = 0; t < taps->taps; t++)
+    {
+      int32_t i = first + (int32_t) t;
+      float weight;
+      if (filter == MIP_FILTER_BOX)
+      {
+        float low = fmaxf((float) i, center - radius);
+        float high = fminf((float) i + 1.0f, center + radius);
+        weight = fmaxf(high - low, 0.0f);
+      } else
+      {
+        weight = kaiser(((float) i + 0.5f - center) / scale);
+      }
+      indices[t] = i < 0 ? 0 : i >= (int32_t) src_size ? src_size - 1 :
+        (uint32_t) i;
+      weights[t] = weight;
+      total += weight;
+    }
+    for (uint32_t t = 0; t < taps->taps; t++)
+    {
+      weights[t] /= total;
+    }
+  }
+  return true;
+}
+
+static void destroy_taps(FilterTaps *taps)
+{
+  MIUR_FREE(taps->indices);
+  MIUR_FREE(taps->weights);
+  memset(taps, 0, sizeof(FilterTaps));
+}
+
+static float kaiser(float x)
+{
+  float t = x / KAISER_WIDTH;
+  if (t <= -1.0f || t >= 1.0f)
+  {
+    return 0.0f;
+  }
+  float sinc = x == 0.0f ? 1.0f : sinf(PI * x) / (PI * x);
+  return sinc * bessel0(KAISER_ALPHA * sqrtf(1.0f - t * t)) /
+    bessel0(KAISER_ALPHA);
+}
+
+/* Zeroth order modified Bessel function of the first kind, as a series. */
+static float bessel0(float x)
+{
+  float sum = 1.0f;
+  float term = 1.0f;
+  float half = x * 0.5f;
+  for (uint32_t k = 1; term > sum * 1e-8f; k++)
+  {
+    term *= (half / (float) k) * (half / (float) k);
+    sum += term;
+  }
+  return sum;
+}
+
+static void decode_row(const TexelTables *tables, const uint8_t *src,
+                       uint32_t width, float *dst)
+{
+  for (uint32_t x = 0; x < width; x++, src += 4, dst += 4)
+  {
+    dst[0] = tables->decode[src[0]];
+    dst[1] = tables->decode[src[1]];
+    dst[2] = tables->decode[src[2]];
+    dst[3] = (float) src[3] * (1.0f / 255.0f);
+  }
+}
+
+/*
+ * Kaiser rings past [0, 1], so everything is clamped.  Linear bytes round
+ * four texels at a time, sRGB color goes through the table one by one.
+ */
+static void encode_row(const TexelTables *tables, const float *src,
+                       uint32_t width, uint8_t *dst)
+{
+  uint32_t x = 0;
+#ifdef MIUR_HAVE_SSE2
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 scale = _mm_set1_ps(255.0f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  for (; x + 4 <= width; x += 4)
+  {
+    __m128i texels[4];
+    for (uint32_t i = 0; i < 4; i++)
+    {
+      __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + (x + i) * 4),
+                                       zero), one);
+      texels[i] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+    }
+    __m128i packed = _mm_packus_epi16(_mm_packs_epi32(texels[0], texels[1]),
+                                      _mm_packs_epi32(texels[2], texels[3]));
+    _mm_storeu_si128((__m128i *) (dst + x * 4), packed);
+  }
+#endif
+  for (; x < width; x++)
+  {
+    for (uint32_t c = 0; c < 4; c++)
+    {
+      float v = fminf(fmaxf(src[x * 4 + c], 0.0f), 1.0f);
+      dst[x * 4 + c] = (uint8_t) (v * 255.0f + 0.5f);
+    }
+  }
+
+  if (tables->srgb)
+  {
+    for (x = 0; x < width; x++)
+    {
+      dst[x * 4 + 0] = encode_srgb(tables, src[x * 4 + 0]);
+      dst[x * 4 + 1] = encode_srgb(tables, src[x * 4 + 1]);
+      dst[x * 4 + 2] = encode_srgb(tables, src[x * 4 + 2]);
+    }
+  }
+}
+
+/* `src_width` is twice `dst_width`, or both are 1. */
+static void box_row(const float *row0, const float *row1, uint32_t src_width,
+                    float *dst, uint32_t dst_width)
+{
+  uint32_t step = src_width > 1 ? 8 : 0;
+#ifdef MIUR_HAVE_SSE2
+  const __m128 quarter = _mm_set1_ps(0.25f);
+  for (uint32_t x = 0; x < dst_width; x++, row0 += 8, row1 += 8)
+  {
+    __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(row0),
+                                       _mm_loadu_ps(row0 + step / 2)),
+                            _mm_add_ps(_mm_loadu_ps(row1),
+                                       _mm_loadu_ps(row1 + step / 2)));
+    _mm_storeu_ps(dst + x * 4, _mm_mul_ps(sum, quarter));
+  }
+#else
+  for (uint32_t x = 0; x < dst_width; x++, row0 += 8, row1 += 8)
+  {
+    for (uint32_t c = 0; c < 4; c++)
+    {
+      dst[x * 4 + c] = (row0[c] + row0[step / 2 + c] + row1[c] +
+                        row1[step / 2 + c]) * 0.25f;
+    }
+  }
+#endif
+}
+
+static void accumulate_row(float *acc, const float *row, float weight,
+                           size_t count)
+{
+  size_t i = 0;
+#ifdef MIUR_HAVE_SSE2
+  __m128 w = _mm_set1_ps(weight);
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128 a0 = _mm_add_ps(_mm_loadu_ps(acc + i),
+                           _mm_mul_ps(_mm_loadu_ps(row + i), w));
+    __m128 a1 = _mm_add_ps(_mm_loadu_ps(acc + i + 4),
+                           _mm_mul_ps(_mm_loadu_ps(row + i + 4), w));
+    _mm_storeu_ps(acc + i, a0);
+    _mm_storeu_ps(acc + i + 4, a1);
+  }
+#endif
+  for (; i < count; i++)
+  {
+    acc[i] += row[i] * weight;
+  }
+}
+
+/* One texel, all four channels, per step of every tap. */
+static void filter_row(const float *src, const FilterTaps *taps,
+                       uint32_t width, float *dst)
+{
+  for (uint32_t x = 0; x < width; x++)
+  {
+    const uint32_t *indices = taps->indices + (size_t) x * taps->taps;
+    const float *weights = taps->weights + (size_t) x * taps->taps;
+#ifdef MIUR_HAVE_SSE2
+    __m128 sum = _mm_setzero_ps();
+    for (uint32_t t = 0; t < taps->taps; t++)
+    {
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src + indices[t] * 4),
+                                       _mm_set1_ps(weights[t])));
+    }
+    _mm_storeu_ps(dst + x * 4, sum);
+#else
+    float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (uint32_t t = 0; t < taps->taps; t++)
+    {
+      for (uint32_t c = 0; c < 4; c++)
+      {
+        sum[c] += src[indices[t] * 4 + c] * weights[t];
+      }
+    }
+    memcpy(dst + x * 4, sum, sizeof(sum));
+#endif
+  }
+}
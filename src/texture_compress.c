@@ -0,0 +1,1913 @@
+/* =====================
+ * src/texture_compress.c
+ * 10/18/2026
+ * BC block compression.
+ * ====================
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <miur/log.h>
+#include <miur/mem.h>
+#include <miur/simd.h>
+#include <miur/texture_compress.h>
+
+/* Blocks per job, a millisecond or so of BC7. */
+#define COMPRESS_JOB_BLOCKS 256
+
+/* Power iterations finding a block's principal axis. */
+#define AXIS_ITERATIONS 4
+
+#define BC7_MAX_SUBSETS 3
+#define BC7_MODES 8
+/* Estimated best partitions encoded for real, by quality. */
+#define BC7_NORMAL_PARTITIONS 2
+#define BC7_HIGH_PARTITIONS 8
+#define BC7_MAX_PARTITIONS BC7_HIGH_PARTITIONS
+/*
+ * Squared error under which normal quality keeps mode 6, an average of
+ * about one step per texel channel.
+ */
+#define BC7_CLOSE_ENOUGH 64
+/* K-means rounds clustering texels to rank partitions. */
+#define BC7_CLUSTER_ROUNDS 3
+
+/* A block's texels by channel, as the palette search reads them. */
+typedef struct
+{
+  int16_t c[4][16];
+} BlockTexels;
+
+typedef struct
+{
+  uint8_t subsets;
+  uint8_t partition_bits;
+  uint8_t rotation_bits;
+  uint8_t index_selection_bits;
+  uint8_t color_bits;
+  uint8_t alpha_bits;          /* 0 when alpha is always 255. */
+  uint8_t endpoint_pbits;
+  uint8_t shared_pbits;
+  uint8_t index_bits;
+  uint8_t index2_bits;         /* Separate alpha indices, 0 if none. */
+} Bc7Mode;
+
+/* A BC7 block unpacked, endpoints still quantized and without p-bits. */
+typedef struct
+{
+  uint32_t mode;
+  uint32_t partition;
+  uint32_t rotation;
+  uint32_t index_selection;
+  uint8_t endpoints[BC7_MAX_SUBSETS][2][4];
+  uint8_t pbits[BC7_MAX_SUBSETS][2];
+  uint8_t indices[16];
+  uint8_t indices2[16];
+} Bc7Block;
+
+/* How one subset's endpoints are fitted, and the result. */
+typedef struct
+{
+  const BlockTexels *texels;
+  uint32_t mask;               /* Texels in the subset. */
+  uint32_t channels;           /* Bit per channel fitted and compared. */
+  uint32_t color_bits;
+  uint32_t alpha_bits;
+  uint32_t pbits;              /* 0 none, 1 shared or 2 per endpoint. */
+  uint32_t index_bits;
+  uint32_t refine;
+  /* Tries every choice of p-bits, else the one closest to the fit. */
+  bool search_pbits;
+} Bc7Fit;
+
+typedef struct
+{
+  uint8_t endpoints[2][4];
+  uint8_t pbits[2];
+  uint8_t indices[16];
+  uint32_t error;
+} Bc7Subset;
+
+typedef struct
+{
+  const Texture *src;
+  Texture *dst;
+  TextureQuality quality;
+  uint32_t mip;
+  uint32_t first_block;
+  uint32_t block_count;
+} CompressTask;
+
+/* === PROTOTYPES === */
+
+static void compress_job(void *ud);
+static void load_block(const uint8_t *texels, BlockTexels *out);
+
+static uint32_t find_indices(const BlockTexels *texels,
+                             const int16_t (*palette)[4], uint32_t count,
+                             uint32_t channels, uint32_t mask,
+                             uint8_t indices[16]);
+#ifdef MIUR_HAVE_SSE2
+static uint32_t find_indices_sse2(const BlockTexels *texels,
+                                  const int16_t (*palette)[4],
+                                  uint32_t count, uint32_t channels,
+                                  uint32_t mask, uint8_t indices[16]);
+#endif
+static void fit_line(const BlockTexels *texels, uint32_t mask,
+                     uint32_t channels, float mean[4], float axis[4]);
+static void line_endpoints(const BlockTexels *texels, uint32_t mask,
+                           uint32_t channels, float e0[4], float e1[4]);
+static bool solve_endpoints(const BlockTexels *texels, uint32_t mask,
+                            uint32_t channels, const uint8_t indices[16],
+                            const float *weights, float e0[4], float e1[4]);
+static int32_t round_clamp(float value, int32_t max);
+
+static void encode_color(const BlockTexels *texels, TextureQuality quality,
+                         uint8_t *block);
+static uint32_t color_error(const BlockTexels *texels, int32_t q[2][3],
+                            uint8_t indices[16]);
+static void color_palette(uint16_t c0, uint16_t c1, int16_t palette[4][4]);
+static uint16_t pack_565(const int32_t q[3]);
+static void encode_solid_color(const BlockTexels *texels, uint8_t *block);
+static void decode_color(const uint8_t *block, bool four_color,
+                         uint8_t texels[64]);
+
+static void encode_alpha(const BlockTexels *texels, uint32_t channel,
+                         TextureQuality quality, uint8_t *block);
+static uint32_t alpha_palette(uint32_t a0, uint32_t a1, uint8_t palette[8]);
+static uint32_t alpha_error(const BlockTexels *texels, uint32_t channel,
+                            const uint8_t palette[8], uint8_t indices[16]);
+static void decode_alpha(const uint8_t *block, uint32_t channel,
+                         uint8_t texels[64]);
+
+static void bc7_encode(const BlockTexels *texels, TextureQuality quality,
+                       uint8_t *block);
+static void bc7_try_partitions(const BlockTexels *texels,
+                               const uint8_t *modes, uint32_t mode_count,
+                               uint32_t count, TextureQuality quality,
+                               Bc7Block *best, uint32_t *best_error);
+static void bc7_cluster(const BlockTexels *texels, uint32_t channels,
+                        uint32_t subsets, uint32_t clusters[BC7_MAX_SUBSETS]);
+static uint32_t bc7_matches(uint32_t subsets, uint32_t partition,
+                            const uint32_t clusters[BC7_MAX_SUBSETS]);
+static uint32_t count_bits(uint32_t value);
+static uint32_t gather_even_bits(uint32_t value);
+static uint32_t bc7_encode_mode(const BlockTexels *texels, uint32_t mode,
+                                uint32_t partition, uint32_t rotation,
+                                uint32_t index_selection,
+                                TextureQuality quality, Bc7Block *out);
+static void bc7_fit_subset(const Bc7Fit *fit, const float e0[4],
+                           const float e1[4], Bc7Subset *out);
+static void bc7_evaluate(const Bc7Fit *fit, const float e0[4],
+                         const float e1[4], Bc7Subset *out);
+static void bc7_quantize(const Bc7Fit *fit, const float value[4],
+                         uint32_t pbit, uint8_t q[4], uint8_t unq[4]);
+static void bc7_fix_anchor(const Bc7Fit *fit, uint32_t anchor,
+                           Bc7Subset *subset);
+static void bc7_subset_masks(uint32_t subsets, uint32_t partition,
+                             uint32_t masks[BC7_MAX_SUBSETS]);
+static uint32_t bc7_subset(uint32_t subsets, uint32_t partition,
+                           uint32_t texel);
+static uint32_t bc7_anchor(uint32_t subsets, uint32_t partition,
+                           uint32_t subset);
+static const uint8_t *bc7_weights(uint32_t bits);
+static uint8_t bc7_unquantize(uint32_t value, uint32_t bits);
+static void bc7_pack(const Bc7Block *in, uint8_t *block);
+static bool bc7_unpack(const uint8_t *block, Bc7Block *out);
+static void bc7_decode(const uint8_t *block, uint8_t texels[64]);
+static void put_bits(uint8_t *block, uint32_t *pos, uint32_t value,
+                     uint32_t count);
+static uint32_t get_bits(const uint8_t *block, uint32_t *pos,
+                         uint32_t count);
+
+/* === GLOBALS === */
+
+static const Bc7Mode bc7_modes[BC7_MODES] = {
+  { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+  { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+  { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+  { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+  { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+  { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+  { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+  { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+};
+
+static const uint8_t bc7_weights2[4] = { 0, 21, 43, 64 };
+static const uint8_t bc7_weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const uint8_t bc7_weights4[16] = {
+  0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64,
+};
+
+/* Bit i set when texel i is in the second subset. */
+static const uint16_t bc7_partitions2[64] = {
+  0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80,
+  0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+  0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce,
+  0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+  0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a,
+  0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+  0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c,
+  0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22,
+};
+
+/* Two bits per texel, texel i's subset at bit 2i. */
+static const uint32_t bc7_partitions3[64] = {
+  0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8,
+  0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+  0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090,
+  0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+  0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0,
+  0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+  0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400,
+  0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+  0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424,
+  0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+  0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0,
+  0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+  0xaa444444, 0x54a854a8, 0x95809580, 0x96969600,
+  0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+  0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000,
+  0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254,
+};
+
+/* The texel whose index drops its top bit, per subset after the first. */
+static const uint8_t bc7_anchors2[64] = {
+  15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+  15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+  15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+  6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15,
+};
+
+static const uint8_t bc7_anchors3[2][64] = {
+  {
+    3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+    3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+    8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+    3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3,
+  },
+  {
+    15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+    15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+    15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+    15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8,
+  },
+};
+
+/* Least squares weights of BC1 indices, towards the second endpoint. */
+static const float color_weights[4] = { 0.0f, 1.0f, 1.0f / 3, 2.0f / 3 };
+
+/* === PUBLIC FUNCTIONS === */
+
+bool texture_compress(Texture *out, const Texture *src, TextureFormat format,
+                      TextureQuality quality, JobSystem *jobs)
+{
+  memset(out, 0, sizeof(Texture));
+  uint32_t block_size = texture_format_block_size(format);
+  if (block_size == 0 || texture_format_block_size(src->format) != 0)
+  {
+    MIUR_LOG_ERR("Can only compress RGBA8 textures into BC formats");
+    return false;
+  }
+  if (!texture_layout(out, format, src->width, src->height) ||
+      out->mip_count != src->mip_count)
+  {
+    MIUR_LOG_ERR("Bad texture layout");
+    return false;
+  }
+
+  size_t task_count = 0;
+  for (uint32_t i = 0; i < out->mip_count; i++)
+  {
+    uint32_t blocks = (uint32_t) (out->mips[i].size / block_size);
+    task_count += (blocks + COMPRESS_JOB_BLOCKS - 1) / COMPRESS_JOB_BLOCKS;
+  }
+
+  /* Zeroed, so the padding between mips is the same on every cook. */
+  out->data = MIUR_ARR(uint8_t, out->size);
+  CompressTask *tasks = MIUR_ARR(CompressTask, task_count);
+  Job *descs = MIUR_ARR(Job, task_count);
+  bool result = false;
+  if (out->data == NULL || tasks == NULL || descs == NULL)
+  {
+    MIUR_LOG_ERR("Out of memory compressing a texture");
+    goto cleanup;
+  }
+
+  size_t task = 0;
+  for (uint32_t i = 0; i < out->mip_count; i++)
+  {
+    uint32_t blocks = (uint32_t) (out->mips[i].size / block_size);
+    for (uint32_t first = 0; first < blocks; first += COMPRESS_JOB_BLOCKS)
+    {
+      tasks[task].src = src;
+      tasks[task].dst = out;
+      tasks[task].quality = quality;
+      tasks[task].mip = i;
+      tasks[task].first_block = first;
+      tasks[task].block_count = blocks - first < COMPRESS_JOB_BLOCKS ?
+        blocks - first : COMPRESS_JOB_BLOCKS;
+      descs[task].function = compress_job;
+      descs[task].ud = &tasks[task];
+      task++;
+    }
+  }
+
+  if (jobs != NULL)
+  {
+    JobCounter done = { 0 };
+    job_run(jobs, descs, task_count, &done);
+    job_wait(jobs, &done);
+  }
+  else
+  {
+    for (size_t i = 0; i < task_count; i++)
+    {
+      compress_job(&tasks[i]);
+    }
+  }
+  result = true;
+
+cleanup:
+  MIUR_FREE(tasks);
+  MIUR_FREE(descs);
+  if (!result)
+  {
+    texture_destroy(out);
+  }
+  return result;
+}
+
+bool texture_decompress(Texture *out, const Texture *src)
+{
+  memset(out, 0, sizeof(Texture));
+  uint32_t block_size = texture_format_block_size(src->format);
+  TextureFormat format = texture_format_is_srgb(src->format) ?
+    TEXTURE_FORMAT_RGBA8_SRGB : TEXTURE_FORMAT_RGBA8;
+  if (block_size == 0 || !texture_layout(out, format, src->width,
+                                         src->height))
+  {
+    MIUR_LOG_ERR("Can only decompress BC textures");
+    return false;
+  }
+  out->data = MIUR_ARR(uint8_t, out->size);
+  if (out->data == NULL)
+  {
+    MIUR_LOG_ERR("Out of memory decompressing a texture");
+    return false;
+  }
+
+  for (uint32_t i = 0; i < out->mip_count; i++)
+  {
+    const TextureMip *from = &src->mips[i];
+    const TextureMip *to = &out->mips[i];
+    uint32_t blocks_x = (to->width + 3) / 4;
+    uint32_t blocks_y = (to->height + 3) / 4;
+    for (uint32_t by = 0; by < blocks_y; by++)
+    {
+      for (uint32_t bx = 0; bx < blocks_x; bx++)
+      {
+        uint8_t texels[64];
+        texture_decode_block(src->format, src->data + from->offset +
+                             ((size_t) by * blocks_x + bx) * block_size,
+                             texels);
+        /* Edge blocks hang over the level, only their inside is kept. */
+        for (uint32_t y = 0; y < 4 && by * 4 + y < to->height; y++)
+        {
+          uint32_t width = to->width - bx * 4 < 4 ? to->width - bx * 4 : 4;
+          memcpy(out->data + to->offset +
+                 ((size_t) (by * 4 + y) * to->width + bx * 4) * 4,
+                 &texels[y * 16], width * 4);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+void texture_encode_block(TextureFormat format, TextureQuality quality,
+                          const uint8_t texels[64], uint8_t *block)
+{
+  BlockTexels loaded;
+  load_block(texels, &loaded);
+  switch (format)
+  {
+  case TEXTURE_FORMAT_BC1:
+  case TEXTURE_FORMAT_BC1_SRGB:
+    encode_color(&loaded, quality, block);
+    break;
+  case TEXTURE_FORMAT_BC3:
+  case TEXTURE_FORMAT_BC3_SRGB:
+    encode_alpha(&loaded, 3, quality, block);
+    encode_color(&loaded, quality, block + 8);
+    break;
+  case TEXTURE_FORMAT_BC5:
+    encode_alpha(&loaded, 0, quality, block);
+    encode_alpha(&loaded, 1, quality, block + 8);
+    break;
+  case TEXTURE_FORMAT_BC7:
+  case TEXTURE_FORMAT_BC7_SRGB:
+    bc7_encode(&loaded, quality, block);
+    break;
+  default:
+    break;
+  }
+}
+
+void texture_decode_block(TextureFormat format, const uint8_t *block,
+                          uint8_t texels[64])
+{
+  switch (format)
+  {
+  case TEXTURE_FORMAT_BC1:
+  case TEXTURE_FORMAT_BC1_SRGB:
+    decode_color(block, false, texels);
+    break;
+  case TEXTURE_FORMAT_BC3:
+  case TEXTURE_FORMAT_BC3_SRGB:
+    decode_color(block + 8, true, texels);
+    decode_alpha(block, 3, texels);
+    break;
+  case TEXTURE_FORMAT_BC5:
+    for (uint32_t i = 0; i < 16; i++)
+    {
+      texels[i * 4 + 2] = 0;
+      texels[i * 4 + 3] = 255;
+    }
+    decode_alpha(block, 0, texels);
+    decode_alpha(block + 8, 1, texels);
+    break;
+  case TEXTURE_FORMAT_BC7:
+  case TEXTURE_FORMAT_BC7_SRGB:
+    bc7_decode(block, texels);
+    break;
+  default:
+    memset(texels, 0, 64);
+    break;
+  }
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void compress_job(void *ud)
+{
+  CompressTask *task = (CompressTask *) ud;
+  const TextureMip *from = &task->src->mips[task->mip];
+  const TextureMip *to = &task->dst->mips[task->mip];
+  TextureFormat format = task->dst->format;
+  uint32_t block_size = texture_format_block_size(format);
+  uint32_t blocks_x = (to->width + 3) / 4;
+  for (uint32_t i = 0; i < task->block_count; i++)
+  {
+    uint32_t block = task->first_block + i;
+    uint32_t bx = block % blocks_x * 4;
+    uint32_t by = block / blocks_x * 4;
+
+    /* Blocks past the edge repeat its last texels. */
+    uint8_t texels[64];
+    for (uint32_t y = 0; y < 4; y++)
+    {
+      uint32_t sy = by + y < from->height ? by + y : from->height - 1;
+      const uint8_t *row = task->src->data + from->offset +
+        (size_t) sy * from->width * 4;
+      for (uint32_t x = 0; x < 4; x++)
+      {
+        uint32_t sx = bx + x < from->width ? bx + x : from->width - 1;
+        memcpy(&texels[(y * 4 + x) * 4], &row[sx * 4], 4);
+      }
+    }
+    texture_encode_block(format, task->quality, texels,
+                         task->dst->data + to->offset +
+                         (size_t) block * block_size);
+  }
+}
+
+static void load_block(const uint8_t *texels, BlockTexels *out)
+{
+  for (uint32_t i = 0; i < 16; i++)
+  {
+    for (uint32_t c = 0; c < 4; c++)
+    {
+      out->c[c][i] = texels[i * 4 + c];
+    }
+  }
+}
+
+/*
+ * Finds each texel's nearest palette entry over the channels set in
+ * `channels`, the first on ties.  Only texels in `mask` get an index and
+ * count towards the summed squared error returned.
+ */
+static uint32_t find_indices(const BlockTexels *texels,
+                             const int16_t (*palette)[4], uint32_t count,
+                             uint32_t channels, uint32_t mask,
+                             uint8_t indices[16])
+{
+#ifdef MIUR_HAVE_SSE2
+  return find_indices_sse2(texels, palette, count, channels, mask, indices);
+#else
+  uint32_t total = 0;
+  for (uint32_t t = 0; t < 16; t++)
+  {
+    if ((mask >> t & 1) == 0)
+    {
+      continue;
+    }
+    uint32_t best = UINT32_MAX;
+    for (uint32_t i = 0; i < count; i++)
+    {
+      uint32_t error = 0;
+      for (uint32_t c = 0; c < 4; c++)
+      {
+        if (channels >> c & 1)
+        {
+          int32_t d = texels->c[c][t] - palette[i][c];
+          error += (uint32_t) (d * d);
+        }
+      }
+      if (error < best)
+      {
+        best = error;
+        indices[t] = (uint8_t) i;
+      }
+    }
+    total += best;
+  }
+  return total;
+#endif
+}
+
+#ifdef MIUR_HAVE_SSE2
+/*
+ * Eight texels at a time per palette entry: the channel differences are
+ * interleaved in pairs so one madd squares and sums two channels.
+ */
+static uint32_t find_indices_sse2(const BlockTexels *texels,
+                                  const int16_t (*palette)[4],
+                                  uint32_t count, uint32_t channels,
+                                  uint32_t mask, uint8_t indices[16])
+{
+  __m128i zero = _mm_setzero_si128();
+  uint32_t total = 0;
+  for (uint32_t half = 0; half < 2; half++)
+  {
+    __m128i c[4];
+    for (uint32_t k = 0; k < 4; k++)
+    {
+      c[k] = channels >> k & 1 ?
+        _mm_loadu_si128((const __m128i *) &texels->c[k][half * 8]) : zero;
+    }
+
+    __m128i best_lo = _mm_set1_epi32(INT32_MAX);
+    __m128i best_hi = best_lo;
+    __m128i index_lo = zero;
+    __m128i index_hi = zero;
+    for (uint32_t i = 0; i < count; i++)
+    {
+      __m128i d[4];
+      for (uint32_t k = 0; k < 4; k++)
+      {
+        d[k] = _mm_sub_epi16(c[k], _mm_set1_epi16(
+                               channels >> k & 1 ? palette[i][k] : 0));
+      }
+      __m128i rg = _mm_unpacklo_epi16(d[0], d[1]);
+      __m128i ba = _mm_unpacklo_epi16(d[2], d[3]);
+      __m128i lo = _mm_add_epi32(_mm_madd_epi16(rg, rg),
+                                 _mm_madd_epi16(ba, ba));
+      rg = _mm_unpackhi_epi16(d[0], d[1]);
+      ba = _mm_unpackhi_epi16(d[2], d[3]);
+      __m128i hi = _mm_add_epi32(_mm_madd_epi16(rg, rg),
+                                 _mm_madd_epi16(ba, ba));
+
+      __m128i index = _mm_set1_epi32((int32_t) i);
+      __m128i less = _mm_cmplt_epi32(lo, best_lo);
+      best_lo = _mm_or_si128(_mm_and_si128(less, lo),
+                             _mm_andnot_si128(less, best_lo));
+      index_lo = _mm_or_si128(_mm_and_si128(less, index),
+                              _mm_andnot_si128(less, index_lo));
+      less = _mm_cmplt_epi32(hi, best_hi);
+      best_hi = _mm_or_si128(_mm_and_si128(less, hi),
+                             _mm_andnot_si128(less, best_hi));
+      index_hi = _mm_or_si128(_mm_and_si128(less, index),
+                              _mm_andnot_si128(less, index_hi));
+    }
+
+    int32_t best[8];
+    int32_t index[8];
+    _mm_storeu_si128((__m128i *) &best[0], best_lo);
+    _mm_storeu_si128((__m128i *) &best[4], best_hi);
+    _mm_storeu_si128((__m128i *) &index[0], index_lo);
+    _mm_storeu_si128((__m128i *) &index[4], index_hi);
+    for (uint32_t t = 0; t < 8; t++)
+    {
+      if (mask >> (half * 8 + t) & 1)
+      {
+        indices[half * 8 + t] = (uint8_t) index[t];
+        total += (uint32_t) best[t];
+      }
+    }
+  }
+  return total;
+}
+#endif
+
+/*
+ * Finds the mean and principal axis of the texels in `mask`, by power
+ * iteration on their scatter matrix.  The axis is zero if they're equal.
+ */
+static void fit_line(const BlockTexels *texels, uint32_t mask,
+                     uint32_t channels, float mean[4], float axis[4])
+{
+  /* Integer moments, the scatter is their spread about the mean. */
+  int32_t count = 0;
+  int32_t sums[4] = { 0 };
+  int32_t products[4][4] = { { 0 } };
+  for (uint32_t bits = mask; bits != 0; bits &= bits - 1)
+  {
+    uint32_t t = MIUR_CTZ32(bits);
+    int32_t x[4];
+    for (uint32_t c = 0; c < 4; c++)
+    {
+      x[c] = channels >> c & 1 ? texels->c[c][t] : 0;
+      sums[c] += x[c];
+    }
+    for (uint32_t a = 0; a < 4; a++)
+    {
+      for (uint32_t b = a; b < 4; b++)
+      {
+        products[a][b] += x[a] * x[b];
+      }
+    }
+    count++;
+  }
+  memset(axis, 0, sizeof(float) * 4);
+  if (count == 0)
+  {
+    memset(mean, 0, sizeof(float) * 4);
+    return;
+  }
+  float inv = 1.0f / (float) count;
+  float scatter[4][4];
+  for (uint32_t a = 0; a < 4; a++)
+  {
+    mean[a] = (float) sums[a] * inv;
+    for (uint32_t b = a; b < 4; b++)
+    {
+      scatter[a][b] = (float) products[a][b] - (float) sums[a] * sums[b] * inv;
+    }
+  }
+
+  /* Start from the widest channel's column, it can't be orthogonal. */
+  uint32_t widest = 0;
+  for (uint32_t a = 0; a < 4; a++)
+  {
+    for (uint32_t b = 0; b < a; b++)
+    {
+      scatter[a][b] = scatter[b][a];
+    }
+    if (scatter[a][a] > scatter[widest][widest])
+    {
+      widest = a;
+    }
+  }
+  if (scatter[widest][widest] == 0.0f)
+  {
+    return;
+  }
+
+  float v[4];
+  for (uint32_t c = 0; c < 4; c++)
+  {
+    v[c] = scatter[c][widest];
+  }
+  for (uint32_t i = 0; i < AXIS_ITERATIONS; i++)
+  {
+    float w[4];
+    float length = 0.0f;
+    for (uint32_t a = 0; a < 4; a++)
+    {
+      w[a] = 0.0f;
+      for (uint32_t b = 0; b < 4; b++)
+      {
+        w[a] += scatter[a][b] * v[b];
+      }
+      length += w[a] * w[a];
+    }
+    if (length == 0.0f)
+    {
+      break;
+    }
+    float scale = 1.0f / sqrtf(length);
+    for (uint32_t c = 0; c < 4; c++)
+    {
+      v[c] = w[c] * scale;
+    }
+  }
+  memcpy(axis, v, sizeof(v));
+}
+
+/* Endpoints at the extremes of the texels along their principal axis. */
+static void line_endpoints(const BlockTexels *texels, uint32_t mask,
+                           uint32_t channels, float e0[4], float e1[4])
+{
+  float mean[4];
+  float axis[4];
+  fit_line(texels, mask, channels, mean, axis);
+  float low = 0.0f;
+  float high = 0.0f;
+  for (uint32_t t = 0; t < 16; t++)
+  {
+    if (mask >> t & 1)
+    {
+      float along = 0.0f;
+      for (uint32_t c = 0; c < 4; c++)
+      {
+        along += (texels->c[c][t] - mean[c]) * axis[c];
+      }
+      low = along < low ? along : low;
+      high = along > high ? along : high;
+    }
+  }
+  for (uint32_t c = 0; c < 4; c++)
+  {
+    e0[c] = mean[c] + low * axis[c];
+    e1[c] = mean[c] + high * axis[c];
+  }
+}
+
+/*
+ * The endpoints minimizing the squared error for fixed indices, each
+ * weighted `weights[index]` of the way to `e1`.  Fails when every texel
+ * has the same weight and the endpoints are free.
+ */
+static bool solve_endpoints(const BlockTexels *texels, uint32_t mask,
+                            uint32_t channels, const uint8_t indices[16],
+                            const float *weights, float e0[4], float e1[4])
+{
+  float aa = 0.0f;
+  float ab = 0.0f;
+  float bb = 0.0f;
+  float ax[4] = { 0.0f };
+  float bx[4] = { 0.0f };
+  for (uint32_t t = 0; t < 16; t++)
+  {
+    if ((mask >> t & 1) == 0)
+    {
+      continue;
+    }
+    float b = weights[indices[t]];
+    float a = 1.0f - b;
+    aa += a * a;
+    ab += a * b;
+    bb += b * b;
+    for (uint32_t c = 0; c < 4; c++)
+    {
+      ax[c] += a * texels->c[c][t];
+      bx[c] += b * texels->c[c][t];
+    }
+  }
+  float det = aa * bb - ab * ab;
+  if (det < 1e-6f)
+  {
+    return false;
+  }
+  float inv = 1.0f / det;
+  for (uint32_t c = 0; c < 4; c++)
+  {
+    if (channels >> c & 1)
+    {
+      e0[c] = (bb * ax[c] - ab * bx[c]) * inv;
+      e1[c] = (aa * bx[c] - ab * ax[c]) * inv;
+    }
+  }
+  return true;
+}
+
+static int32_t round_clamp(float value, int32_t max)
+{
+  int32_t rounded = (int32_t) (value + 0.5f);
+  return value < 0.0f ? 0 : rounded > max ? max : rounded;
+}
+
+/*
+ * BC1 colors, always in four color mode: the principal axis fit, then
+ * least squares and at high quality a walk over neighbouring endpoints.
+ */
+static void encode_color(const BlockTexels *texels, TextureQuality quality,
+                         uint8_t *block)
+{
+  bool solid = true;
+  for (uint32_t t = 1; t < 16 && solid; t++)
+  {
+    solid = texels->c[0][t] == texels->c[0][0] &&
+      texels->c[1][t] == texels->c[1][0] && texels->c[2][t] == texels->c[2][0];
+  }
+  if (solid)
+  {
+    encode_solid_color(texels, block);
+    return;
+  }
+
+  static const int32_t max[3] = { 31, 63, 31 };
+  float e0[4];
+  float e1[4];
+  line_endpoints(texels, 0xffff, 0x7, e0, e1);
+  int32_t q[2][3];
+  for (uint32_t c = 0; c < 3; c++)
+  {
+    q[0][c] = round_clamp(e0[c] * max[c] / 255.0f, max[c]);
+    q[1][c] = round_clamp(e1[c] * max[c] / 255.0f, max[c]);
+  }
+  uint8_t indices[16];
+  uint32_t error = color_error(texels, q, indices);
+
+  uint32_t refine = quality == TEXTURE_QUALITY_FAST ? 0 :
+    quality == TEXTURE_QUALITY_NORMAL ? 1 : 3;
+  for (uint32_t i = 0; i < refine && error > 0; i++)
+  {
+    if (!solve_endpoints(texels, 0xffff, 0x7, indices, color_weights, e0, e1))
+    {
+      break;
+    }
+    int32_t next[2][3];
+    for (uint32_t c = 0; c < 3; c++)
+    {
+      next[0][c] = round_clamp(e0[c] * max[c] / 255.0f, max[c]);
+      next[1][c] = round_clamp(e1[c] * max[c] / 255.0f, max[c]);
+    }
+    uint8_t next_indices[16];
+    uint32_t next_error = color_error(texels, next, next_indices);
+    if (next_error >= error)
+    {
+      break;
+    }
+    error = next_error;
+    memcpy(q, next, sizeof(q));
+    memcpy(indices, next_indices, sizeof(indices));
+  }
+
+  /* Nudge each endpoint channel a step while it helps. */
+  for (bool improved = quality == TEXTURE_QUALITY_HIGH;
+       improved && error > 0;)
+  {
+    improved = false;
+    for (uint32_t e = 0; e < 2; e++)
+    {
+      for (uint32_t c = 0; c < 3; c++)
+      {
+        for (int32_t step = -1; step <= 1; step += 2)
+        {
+          int32_t old = q[e][c];
+          if (old + step < 0 || old + step > max[c])
+          {
+            continue;
+          }
+          q[e][c] = old + step;
+          uint8_t next_indices[16];
+          uint32_t next_error = color_error(texels, q, next_indices);
+          if (next_error < error)
+          {
+            error = next_error;
+            memcpy(indices, next_indices, sizeof(indices));
+            improved = true;
+          }
+          else
+          {
+            q[e][c] = old;
+          }
+        }
+      }
+    }
+  }
+
+  /* Four color mode needs the first endpoint greater. */
+  uint16_t c0 = pack_565(q[0]);
+  uint16_t c1 = pack_565(q[1]);
+  uint32_t flip = 0;
+  if (c0 < c1)
+  {
+    uint16_t swap = c0;
+    c0 = c1;
+    c1 = swap;
+    flip = 1;
+  }
+  uint32_t bits = 0;
+  for (uint32_t t = 0; t < 16; t++)
+  {
+    bits |= (c0 == c1 ? 0u : indices[t] ^ flip) << (t * 2);
+  }
+  block[0] = (uint8_t) c0;
+  block[1] = (uint8_t) (c0 >> 8);
+  block[2] = (uint8_t) c1;
+  block[3] = (uint8_t) (c1 >> 8);
+  for (uint32_t i = 0; i < 4; i++)
+  {
+    block[4 + i] = (uint8_t) (bits >> (i * 8));
+  }
+}
+
+static uint32_t color_error(const BlockTexels *texels, int32_t q[2][3],
+                            uint8_t indices[16])
+{
+  int16_t palette[4][4];
+  color_palette(pack_565(q[0]), pack_565(q[1]), palette);
+  return find_indices(texels, (const int16_t (*)[4]) palette, 4, 0x7, 0xffff,
+                      indices);
+}
+
+/* The four color palette, the last two a third and two thirds along. */
+static void color_palette(uint16_t c0, uint16_t c1, int16_t palette[4][4])
+{
+  int16_t ends[2][3];
+  uint16_t packed[2] = { c0, c1 };
+  for (uint32_t e = 0; e < 2; e++)
+  {
+    uint32_t r = packed[e] >> 11;
+    uint32_t g = packed[e] >> 5 & 63;
+    uint32_t b = packed[e] & 31;
+    ends[e][0] = (int16_t) (r << 3 | r >> 2);
+    ends[e][1] = (int16_t) (g << 2 | g >> 4);
+    ends[e][2] = (int16_t) (b << 3 | b >> 2);
+  }
+  for (uint32_t c = 0; c < 3; c++)
+  {
+    palette[0][c] = ends[0][c];
+    palette[1][c] = ends[1][c];
+    palette[2][c] = (int16_t) ((2 * ends[0][c] + ends[1][c]) / 3);
+    palette[3][c] = (int16_t) ((ends[0][c] + 2 * ends[1][c]) / 3);
+  }
+  for (uint32_t i = 0; i < 4; i++)
+  {
+    palette[i][3] = 255;
+  }
+}
+
+static uint16_t pack_565(const int32_t q[3])
+{
+  return (uint16_t) (q[0] << 11 | q[1] << 5 | q[2]);
+}
+
+/*
+ * A flat block is best as the third of the way entry, which reaches
+ * colors neither endpoint can.  Each channel searches endpoints around the
+ * color on its own.
+ */
+static void encode_solid_color(const BlockTexels *texels, uint8_t *block)
+{
+  static const int32_t max[3] = { 31, 63, 31 };
+  static const int32_t shift[3] = { 3, 2, 3 };
+  int32_t q[2][3] = { { 0 } };
+  for (uint32_t c = 0; c < 3; c++)
+  {
+    int32_t value = texels->c[c][0];
+    int32_t center = round_clamp(value * max[c] / 255.0f, max[c]);
+    int32_t best = INT32_MAX;
+    for (int32_t a = center - 2; a <= center + 2; a++)
+    {
+      for (int32_t b = center - 6; b <= center + 6; b++)
+      {
+        if (a < 0 || a > max[c] || b < 0 || b > max[c])
+        {
+          continue;
+        }
+        int32_t ea = a << shift[c] | a >> (8 - 2 * shift[c]);
+        int32_t eb = b << shift[c] | b >> (8 - 2 * shift[c]);
+        int32_t d = (2 * ea + eb) / 3 - value;
+        if (d * d < best)
+        {
+          best = d * d;
+          q[0][c] = a;
+          q[1][c] = b;
+        }
+      }
+    }
+  }
+
+  /* Index 2 of (c0, c1) is index 3 of (c1, c0). */
+  uint16_t c0 = pack_565(q[0]);
+  uint16_t c1 = pack_565(q[1]);
+  uint32_t index = 2;
+  if (c0 < c1)
+  {
+    uint16_t swap = c0;
+    c0 = c1;
+    c1 = swap;
+    index = 3;
+  }
+  else if (c0 == c1)
+  {
+    index = 0;
+  }
+  block[0] = (uint8_t) c0;
+  block[1] = (uint8_t) (c0 >> 8);
+  block[2] = (uint8_t) c1;
+  block[3] = (uint8_t) (c1 >> 8);
+  memset(block + 4, (int) (index * 0x55), 4);
+}
+
+/*
+ * `four_color` is set for BC3, whose colors ignore the endpoint order.
+ * BC1 blocks with the first endpoint not greater have three colors and
+ * transparent black.
+ */
+static void decode_color(const uint8_t *block, bool four_color,
+                         uint8_t texels[64])
+{
+  uint16_t c0 = (uint16_t) (block[0] | block[1] << 8);
+  uint16_t c1 = (uint16_t) (block[2] | block[3] << 8);
+  int16_t palette[4][4];
+  color_palette(c0, c1, palette);
+  if (!four_color && c0 <= c1)
+  {
+    for (uint32_t c = 0; c < 3; c++)
+    {
+      palette[2][c] = (int16_t) ((palette[0][c] + palette[1][c]) / 2);
+      palette[3][c] = 0;
+    }
+    palette[3][3] = 0;
+  }
+  uint32_t bits = (uint32_t) block[4] | (uint32_t) block[5] << 8 |
+    (uint32_t) block[6] << 16 | (uint32_t) block[7] << 24;
+  for (uint32_t t = 0; t < 16; t++)
+  {
+    const int16_t *entry = palette[bits >> (t * 2) & 3];
+    for (uint32_t c = 0; c < 4; c++)
+    {
+      texels[t * 4 + c] = (uint8_t) entry[c];
+    }
+  }
+}
+
+/*
+ * A BC4 channel in its eight value mode, from the channel's range, then
+ * trying ranges shrunk by a few steps which suit clustered values.
+ */
+static void encode_alpha(const BlockTexels *texels, uint32_t channel,
+                         TextureQuality quality, uint8_t *block)
+{
+  int32_t low = 255;
+  int32_t high = 0;
+  for (uint32_t t = 0; t < 16; t++)
+  {
+    int32_t value = texels->c[channel][t];
+    low = value < low ? value : low;
+    high = value > high ? value : high;
+  }
+
+  uint8_t palette[8];
+  uint8_t indices[16] = { 0 };
+  uint32_t best_a0 = (uint32_t) high;
+  uint32_t best_a1 = (uint32_t) low;
+  if (high > low)
+  {
+    int32_t range = quality == TEXTURE_QUALITY_FAST ? 0 :
+      quality == TEXTURE_QUALITY_NORMAL ? 2 : 6;
+    uint32_t best = UINT32_MAX;
+    for (int32_t a0 = high; a0 >= high - range; a0--)
+    {
+      for (int32_t a1 = low; a1 <= low + range && a1 < a0; a1++)
+      {
+        uint8_t candidate[16];
+        alpha_palette((uint32_t) a0, (uint32_t) a1, palette);
+        uint32_t error = alpha_error(texels, channel, palette, candidate);
+        if (error < best)
+        {
+          best = error;
+          best_a0 = (uint32_t) a0;
+          best_a1 = (uint32_t) a1;
+          memcpy(indices, candidate, sizeof(indices));
+        }
+      }
+    }
+  }
+
+  block[0] = (uint8_t) best_a0;
+  block[1] = (uint8_t) best_a1;
+  uint64_t bits = 0;
+  for (uint32_t t = 0; t < 16; t++)
+  {
+    bits |= (uint64_t) indices[t] << (t * 3);
+  }
+  for (uint32_t i = 0; i < 6; i++)
+  {
+    block[2 + i] = (uint8_t) (bits >> (i * 8));
+  }
+}
+
+/*
+ * Eight interpolated values when a0 > a1, otherwise six and the extremes
+ * 0 and 255.  Returns the count interpolated.
+ */
+static uint32_t alpha_palette(uint32_t a0, uint32_t a1, uint8_t palette[8])
+{
+  palette[0] = (uint8_t) a0;
+  palette[1] = (uint8_t) a1;
+  if (a0 > a1)
+  {
+    for (uint32_t i = 1; i < 7; i++)
+    {
+      palette[i + 1] = (uint8_t) (((7 - i) * a0 + i * a1 + 3) / 7);
+    }
+    return 8;
+  }
+  for (uint32_t i = 1; i < 5; i++)
+  {
+    palette[i + 1] = (uint8_t) (((5 - i) * a0 + i * a1 + 2) / 5);
+  }
+  palette[6] = 0;
+  palette[7] = 255;
+  return 6;
+}
+
+static uint32_t alpha_error(const BlockTexels *texels, uint32_t channel,
+                            const uint8_t palette[8], uint8_t indices[16])
+{
+  int16_t entries[8][4] = { { 0 } };
+  for (uint32_t i = 0; i < 8; i++)
+  {
+    entries[i][channel] = palette[i];
+  }
+  return find_indices(texels, (const int16_t (*)[4]) entries, 8,
+                      1u << channel, 0xffff, indices);
+}
+
+static void decode_alpha(const uint8_t *block, uint32_t channel,
+                         uint8_t texels[64])
+{
+  uint8_t palette[8];
+  alpha_palette(block[0], block[1], palette);
+  uint64_t bits = 0;
+  for (uint32_t i = 0; i < 6; i++)
+  {
+    bits |= (uint64_t) block[2 + i] << (i * 8);
+  }
+  for (uint32_t t = 0; t < 16; t++)
+  {
+    texels[t * 4 + channel] = palette[bits >> (t * 3) & 7];
+  }
+}
+
+/*
+ * Mode 6 suits most blocks on its own.  Above fast quality opaque blocks
+ * try the two subset modes 1 and 3 and blocks with alpha the separate
+ * alpha of mode 5 and two subsets of mode 7, over the partitions that
+ * best match the texels' clusters.  High quality tries every mode.
+ */
+static void bc7_encode(const BlockTexels *texels, TextureQuality quality,
+                       uint8_t *block)
+{
+  bool opaque = true;
+  for (uint32_t t = 0; t < 16 && opaque; t++)
+  {
+    opaque = texels->c[3][t] == 255;
+  }
+
+  Bc7Block best;
+  uint32_t best_error = bc7_encode_mode(texels, 6, 0, 0, 0, quality, &best);
+  /* Modes sharing subsets, partitions and channels rank them once. */
+  static const uint8_t opaque_modes[2] = { 1, 3 };
+  static const uint8_t alpha_modes[1] = { 7 };
+  static const uint8_t three_subset_modes[2][1] = { { 0 }, { 2 } };
+  if (quality == TEXTURE_QUALITY_NORMAL && best_error > BC7_CLOSE_ENOUGH)
+  {
+    Bc7Block candidate;
+    if (opaque)
+    {
+      bc7_try_partitions(texels, opaque_modes, 2, BC7_NORMAL_PARTITIONS,
+                         quality, &best, &best_error);
+    }
+    else
+    {
+      uint32_t error = bc7_encode_mode(texels, 5, 0, 0, 0, quality,
+                                       &candidate);
+      if (error < best_error)
+      {
+        best_error = error;
+        best = candidate;
+      }
+      bc7_try_partitions(texels, alpha_modes, 1, BC7_NORMAL_PARTITIONS,
+                         quality, &best, &best_error);
+    }
+  }
+  else if (quality == TEXTURE_QUALITY_HIGH && best_error > 0)
+  {
+    bc7_try_partitions(texels, opaque_modes, 2, BC7_HIGH_PARTITIONS,
+                       quality, &best, &best_error);
+    bc7_try_partitions(texels, alpha_modes, 1, BC7_HIGH_PARTITIONS, quality,
+                       &best, &best_error);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+      bc7_try_partitions(texels, three_subset_modes[i], 1,
+                         BC7_HIGH_PARTITIONS, quality, &best, &best_error);
+    }
+    for (uint32_t mode = 4; mode <= 5; mode++)
+    {
+      for (uint32_t rotation = 0; rotation < 4; rotation++)
+      {
+        for (uint32_t selection = 0;
+             selection <= bc7_modes[mode].index_selection_bits; selection++)
+        {
+          Bc7Block candidate;
+          uint32_t error = bc7_encode_mode(texels, mode, 0, rotation,
+                                           selection, quality, &candidate);
+          if (error < best_error)
+          {
+            best_error = error;
+            best = candidate;
+          }
+        }
+      }
+    }
+  }
+  bc7_pack(&best, block);
+}
+
+/*
+ * Encodes the `count` partitions that best match the texels' clusters in
+ * each of `modes`, which is far cheaper than fitting every partition.
+ */
+static void bc7_try_partitions(const BlockTexels *texels,
+                               const uint8_t *modes, uint32_t mode_count,
+                               uint32_t count, TextureQuality quality,
+                               Bc7Block *best, uint32_t *best_error)
+{
+  const Bc7Mode *info = &bc7_modes[modes[0]];
+  uint32_t clusters[BC7_MAX_SUBSETS];
+  bc7_cluster(texels, info->alpha_bits > 0 ? 0xf : 0x7, info->subsets,
+              clusters);
+
+  uint32_t partitions = 1u << info->partition_bits;
+  uint32_t ranked[BC7_MAX_PARTITIONS];
+  uint32_t scores[BC7_MAX_PARTITIONS];
+  uint32_t ranked_count = 0;
+  for (uint32_t p = 0; p < partitions; p++)
+  {
+    uint32_t score = bc7_matches(info->subsets, p, clusters);
+
+    /* Insertion into the short list, kept sorted. */
+    uint32_t at = ranked_count < count ? ranked_count++ : count;
+    for (; at > 0 && scores[at - 1] < score; at--)
+    {
+      if (at < count)
+      {
+        scores[at] = scores[at - 1];
+        ranked[at] = ranked[at - 1];
+      }
+    }
+    if (at < count)
+    {
+      scores[at] = score;
+      ranked[at] = p;
+    }
+  }
+
+  for (uint32_t m = 0; m < mode_count; m++)
+  {
+    for (uint32_t i = 0; i < ranked_count && *best_error > 0; i++)
+    {
+      Bc7Block candidate;
+      uint32_t error = bc7_encode_mode(texels, modes[m], ranked[i], 0, 0,
+                                       quality, &candidate);
+      if (error < *best_error)
+      {
+        *best_error = error;
+        *best = candidate;
+      }
+    }
+  }
+}
+
+/*
+ * Splits the texels into `subsets` clusters by a few rounds of k-means,
+ * the centroids starting spread along the principal axis.
+ */
+static void bc7_cluster(const BlockTexels *texels, uint32_t channels,
+                        uint32_t subsets, uint32_t clusters[BC7_MAX_SUBSETS])
+{
+  float mean[4];
+  float axis[4];
+  fit_line(texels, 0xffff, channels, mean, axis);
+  float along[16];
+  float low = 0.0f;
+  float high = 0.0f;
+  for (uint32_t t = 0; t < 16; t++)
+  {
+    along[t] = 0.0f;
+    for (uint32_t c = 0; c < 4; c++)
+    {
+      along[t] += (texels->c[c][t] - mean[c]) * axis[c];
+    }
+    low = along[t] < low ? along[t] : low;
+    high = along[t] > high ? along[t] : high;
+  }
+
+  float centroids[BC7_MAX_SUBSETS][4];
+  for (uint32_t s = 0; s < subsets; s++)
+  {
+    float at = low + (high - low) * (s + 0.5f) / subsets;
+    for (uint32_t c = 0; c < 4; c++)
+    {
+      centroids[s][c] = mean[c] + at * axis[c];
+    }
+  }
+
+  for (uint32_t round = 0; round < BC7_CLUSTER_ROUNDS; round++)
+  {
+    float sums[BC7_MAX_SUBSETS][4] = { { 0.0f } };
+    float counts[BC7_MAX_SUBSETS] = { 0.0f };
+    memset(clusters, 0, sizeof(uint32_t) * BC7_MAX_SUBSETS);
+    for (uint32_t t = 0; t < 16; t++)
+    {
+      uint32_t nearest = 0;
+      float best = 0.0f;
+      for (uint32_t s = 0; s < subsets; s++)
+      {
+        float distance = 0.0f;
+        for (uint32_t c = 0; c < 4; c++)
+        {
+          float d = channels >> c & 1 ? texels->c[c][t] - centroids[s][c] :
+            0.0f;
+          distance += d * d;
+        }
+        if (s == 0 || distance < best)
+        {
+          best = distance;
+          nearest = s;
+        }
+      }
+      clusters[nearest] |= 1u << t;
+      counts[nearest] += 1.0f;
+      for (uint32_t c = 0; c < 4; c++)
+      {
+        sums[nearest][c] += texels->c[c][t];
+      }
+    }
+    for (uint32_t s = 0; s < subsets; s++)
+    {
+      for (uint32_t c = 0; c < 4 && counts[s] > 0.0f; c++)
+      {
+        centroids[s][c] = sums[s][c] / counts[s];
+      }
+    }
+  }
+}
+
+/* Texels in the same subset as cluster, under the best pairing of them. */
+static uint32_t bc7_matches(uint32_t subsets, uint32_t partition,
+                            const uint32_t clusters[BC7_MAX_SUBSETS])
+{
+  /* The first two suffice for two subsets. */
+  static const uint8_t pairings[6][3] = {
+    { 0, 1, 2 }, { 1, 0, 2 }, { 0, 2, 1 },
+    { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 },
+  };
+  uint32_t masks[BC7_MAX_SUBSETS];
+  bc7_subset_masks(subsets, partition, masks);
+  uint32_t best = 0;
+  for (uint32_t i = 0; i < (subsets == 2 ? 2u : 6u); i++)
+  {
+    uint32_t matches = 0;
+    for (uint32_t s = 0; s < subsets; s++)
+    {
+      matches += count_bits(masks[s] & clusters[pairings[i][s]]);
+    }
+    best = matches > best ? matches : best;
+  }
+  return best;
+}
+
+static uint32_t count_bits(uint32_t value)
+{
+  value = value - (value >> 1 & 0x55555555);
+  value = (value & 0x33333333) + (value >> 2 & 0x33333333);
+  return ((value + (value >> 4)) & 0x0f0f0f0f) * 0x01010101 >> 24;
+}
+
+/* Returns the squared error of the block as it will decode. */
+static uint32_t bc7_encode_mode(const BlockTexels *texels, uint32_t mode,
+                                uint32_t partition, uint32_t rotation,
+                                uint32_t index_selection,
+                                TextureQuality quality, Bc7Block *out)
+{
+  const Bc7Mode *info = &bc7_modes[mode];
+  memset(out, 0, sizeof(Bc7Block));
+  out->mode = mode;
+  out->partition = partition;
+  out->rotation = rotation;
+  out->index_selection = index_selection;
+
+  /* Rotation swaps a color channel with alpha, the decoder swaps back. */
+  BlockTexels rotated;
+  if (rotation > 0)
+  {
+    rotated = *texels;
+    memcpy(rotated.c[rotation - 1], texels->c[3], sizeof(rotated.c[0]));
+    memcpy(rotated.c[3], texels->c[rotation - 1], sizeof(rotated.c[0]));
+    texels = &rotated;
+  }
+
+  bool separate = info->index2_bits > 0;
+  uint32_t error = 0;
+  if (info->alpha_bits == 0)
+  {
+    for (uint32_t t = 0; t < 16; t++)
+    {
+      int32_t d = 255 - texels->c[3][t];
+      error += (uint32_t) (d * d);
+    }
+  }
+
+  Bc7Fit fit;
+  fit.texels = texels;
+  fit.channels = info->alpha_bits > 0 && !separate ? 0xf : 0x7;
+  fit.color_bits = info->color_bits;
+  fit.alpha_bits = info->alpha_bits;
+  fit.pbits = info->endpoint_pbits ? 2 : info->shared_pbits ? 1 : 0;
+  fit.index_bits = separate && index_selection ? info->index2_bits :
+    info->index_bits;
+  fit.refine = quality == TEXTURE_QUALITY_FAST ? 0 :
+    quality == TEXTURE_QUALITY_NORMAL ? 1 : 2;
+  fit.search_pbits = quality == TEXTURE_QUALITY_HIGH;
+
+  uint32_t masks[BC7_MAX_SUBSETS];
+  bc7_subset_masks(info->subsets, partition, masks);
+  for (uint32_t s = 0; s < info->subsets; s++)
+  {
+    float e0[4];
+    float e1[4];
+    Bc7Subset subset;
+    fit.mask = masks[s];
+    line_endpoints(texels, fit.mask, fit.channels, e0, e1);
+    bc7_fit_subset(&fit, e0, e1, &subset);
+    bc7_fix_anchor(&fit, bc7_anchor(info->subsets, partition, s), &subset);
+    error += subset.error;
+    memcpy(out->endpoints[s], subset.endpoints, sizeof(subset.endpoints));
+    memcpy(out->pbits[s], subset.pbits, sizeof(subset.pbits));
+    for (uint32_t t = 0; t < 16; t++)
+    {
+      if (fit.mask >> t & 1)
+      {
+        out->indices[t] = subset.indices[t];
+      }
+    }
+  }
+
+  if (separate)
+  {
+    /* Alpha as a line of its own, with the other set of indices. */
+    uint8_t color[16];
+    memcpy(color, out->indices, sizeof(color));
+    fit.mask = 0xffff;
+    fit.channels = 0x8;
+    fit.index_bits = index_selection ? info->index_bits : info->index2_bits;
+    float e0[4] = { 0.0f, 0.0f, 0.0f, 255.0f };
+    float e1[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (uint32_t t = 0; t < 16; t++)
+    {
+      e0[3] = texels->c[3][t] < e0[3] ? texels->c[3][t] : e0[3];
+      e1[3] = texels->c[3][t] > e1[3] ? texels->c[3][t] : e1[3];
+    }
+    Bc7Subset subset;
+    bc7_fit_subset(&fit, e0, e1, &subset);
+    bc7_fix_anchor(&fit, 0, &subset);
+    error += subset.error;
+    out->endpoints[0][0][3] = subset.endpoints[0][3];
+    out->endpoints[0][1][3] = subset.endpoints[1][3];
+    memcpy(index_selection ? out->indices2 : out->indices, color,
+           sizeof(color));
+    memcpy(index_selection ? out->indices : out->indices2, subset.indices,
+           sizeof(subset.indices));
+  }
+  return error;
+}
+
+/* Quantizes the endpoints, then refines them from the indices found. */
+static void bc7_fit_subset(const Bc7Fit *fit, const float e0[4],
+                           const float e1[4], Bc7Subset *out)
+{
+  bc7_evaluate(fit, e0, e1, out);
+  const uint8_t *weights = bc7_weights(fit->index_bits);
+  float scale[16];
+  for (uint32_t i = 0; i < 1u << fit->index_bits; i++)
+  {
+    scale[i] = weights[i] / 64.0f;
+  }
+  for (uint32_t i = 0; i < fit->refine && out->error > 0; i++)
+  {
+    float next0[4];
+    float next1[4];
+    memcpy(next0, e0, sizeof(next0));
+    memcpy(next1, e1, sizeof(next1));
+    if (!solve_endpoints(fit->texels, fit->mask, fit->channels, out->indices,
+                         scale, next0, next1))
+    {
+      break;
+    }
+    Bc7Subset next;
+    bc7_evaluate(fit, next0, next1, &next);
+    if (next.error >= out->error)
+    {
+      break;
+    }
+    *out = next;
+  }
+}
+
+/* Quantizes with each choice of p-bits searched, keeping the best. */
+static void bc7_evaluate(const Bc7Fit *fit, const float e0[4],
+                         const float e1[4], Bc7Subset *out)
+{
+  uint32_t combinations = fit->pbits == 2 ? 4 : fit->pbits == 1 ? 2 : 1;
+  uint32_t first = 0;
+  if (!fit->search_pbits && combinations > 1)
+  {
+    /* How far each endpoint quantizes with each p-bit. */
+    const float *ends[2] = { e0, e1 };
+    float distance[2][2];
+    for (uint32_t e = 0; e < 2; e++)
+    {
+      for (uint32_t p = 0; p < 2; p++)
+      {
+        uint8_t q[4];
+        uint8_t unq[4];
+        bc7_quantize(fit, ends[e], p, q, unq);
+        distance[e][p] = 0.0f;
+        for (uint32_t c = 0; c < 4; c++)
+        {
+          float d = unq[c] - ends[e][c];
+          distance[e][p] += fit->channels >> c & 1 ? d * d : 0.0f;
+        }
+      }
+    }
+    if (fit->pbits == 2)
+    {
+      first = (distance[0][1] < distance[0][0]) |
+        (uint32_t) (distance[1][1] < distance[1][0]) << 1;
+    }
+    else
+    {
+      first = distance[0][1] + distance[1][1] <
+        distance[0][0] + distance[1][0];
+    }
+    combinations = first + 1;
+  }
+
+  const uint8_t *weights = bc7_weights(fit->index_bits);
+  uint32_t count = 1u << fit->index_bits;
+  out->error = UINT32_MAX;
+  for (uint32_t p = first; p < combinations; p++)
+  {
+    uint32_t p0 = fit->pbits == 0 ? UINT32_MAX : p & 1;
+    uint32_t p1 = fit->pbits == 2 ? p >> 1 : p0;
+    uint8_t q[2][4];
+    uint8_t unq[2][4];
+    bc7_quantize(fit, e0, p0, q[0], unq[0]);
+    bc7_quantize(fit, e1, p1, q[1], unq[1]);
+
+    int16_t palette[16][4];
+    for (uint32_t i = 0; i < count; i++)
+    {
+      for (uint32_t c = 0; c < 4; c++)
+      {
+        palette[i][c] = (int16_t) (((64 - weights[i]) * unq[0][c] +
+                                    weights[i] * unq[1][c] + 32) >> 6);
+      }
+    }
+    uint8_t indices[16];
+    uint32_t error = find_indices(fit->texels, (const int16_t (*)[4]) palette,
+                                  count, fit->channels, fit->mask, indices);
+    if (error < out->error)
+    {
+      out->error = error;
+      memcpy(out->endpoints, q, sizeof(q));
+      out->pbits[0] = (uint8_t) (fit->pbits > 0 ? p0 : 0);
+      out->pbits[1] = (uint8_t) (fit->pbits > 0 ? p1 : 0);
+      memcpy(out->indices, indices, sizeof(indices));
+    }
+  }
+}
+
+/*
+ * Quantizes the fitted channels, to the nearest value whose low bit is
+ * `pbit` when there is one.  `unq` is what the decoder expands it to.
+ */
+static void bc7_quantize(const Bc7Fit *fit, const float value[4],
+                         uint32_t pbit, uint8_t q[4], uint8_t unq[4])
+{
+  for (uint32_t c = 0; c < 4; c++)
+  {
+    q[c] = 0;
+    unq[c] = 0;
+    if ((fit->channels >> c & 1) == 0)
+    {
+      continue;
+    }
+    uint32_t bits = c < 3 ? fit->color_bits : fit->alpha_bits;
+    int32_t max = (1 << bits) - 1;
+    if (pbit == UINT32_MAX)
+    {
+      q[c] = (uint8_t) round_clamp(value[c] * max / 255.0f, max);
+      unq[c] = bc7_unquantize(q[c], bits);
+    }
+    else
+    {
+      float full = value[c] * ((2 << bits) - 1) / 255.0f;
+      q[c] = (uint8_t) round_clamp((full - (float) pbit) * 0.5f, max);
+      unq[c] = bc7_unquantize((uint32_t) q[c] << 1 | pbit, bits + 1);
+    }
+  }
+}
+
+/*
+ * The anchor texel's index is stored without its top bit, so when it's
+ * set the endpoints swap and the subset's indices mirror.  The weights
+ * are symmetric, so the decoded texels don't change.
+ */
+static void bc7_fix_anchor(const Bc7Fit *fit, uint32_t anchor,
+                           Bc7Subset *subset)
+{
+  uint32_t max = (1u << fit->index_bits) - 1;
+  if ((subset->indices[anchor] >> (fit->index_bits - 1)) == 0)
+  {
+    return;
+  }
+  for (uint32_t c = 0; c < 4; c++)
+  {
+    uint8_t swap = subset->endpoints[0][c];
+    subset->endpoints[0][c] = subset->endpoints[1][c];
+    subset->endpoints[1][c] = swap;
+  }
+  uint8_t swap = subset->pbits[0];
+  subset->pbits[0] = subset->pbits[1];
+  subset->pbits[1] = swap;
+  for (uint32_t t = 0; t < 16; t++)
+  {
+    if (fit->mask >> t & 1)
+    {
+      subset->indices[t] = (uint8_t) (max - subset->indices[t]);
+    }
+  }
+}
+
+static void bc7_subset_masks(uint32_t subsets, uint32_t partition,
+                             uint32_t masks[BC7_MAX_SUBSETS])
+{
+  memset(masks, 0, sizeof(uint32_t) * BC7_MAX_SUBSETS);
+  if (subsets == 1)
+  {
+    masks[0] = 0xffff;
+  }
+  else if (subsets == 2)
+  {
+    masks[1] = bc7_partitions2[partition];
+    masks[0] = masks[1] ^ 0xffff;
+  }
+  else
+  {
+    uint32_t low = bc7_partitions3[partition];
+    uint32_t high = low >> 1;
+    masks[0] = gather_even_bits(~(low | high));
+    masks[1] = gather_even_bits(low & ~high);
+    masks[2] = gather_even_bits(high & ~low);
+  }
+}
+
+/* Packs bits 0, 2, 4... of `value` into the low 16. */
+static uint32_t gather_even_bits(uint32_t value)
+{
+  value &= 0x55555555;
+  value = (value | value >> 1) & 0x33333333;
+  value = (value | value >> 2) & 0x0f0f0f0f;
+  value = (value | value >> 4) & 0x00ff00ff;
+  return (value | value >> 8) & 0x0000ffff;
+}
+
+static uint32_t bc7_subset(uint32_t subsets, uint32_t partition,
+                           uint32_t texel)
+{
+  switch (subsets)
+  {
+  case 2:
+    return bc7_partitions2[partition] >> texel & 1;
+  case 3:
+    return bc7_partitions3[partition] >> (texel * 2) & 3;
+  default:
+    return 0;
+  }
+}
+
+static uint32_t bc7_anchor(uint32_t subsets, uint32_t partition,
+                           uint32_t subset)
+{
+  if (subset == 0)
+  {
+    return 0;
+  }
+  return subsets == 2 ? bc7_anchors2[partition] :
+    bc7_anchors3[subset - 1][partition];
+}
+
+static const uint8_t *bc7_weights(uint32_t bits)
+{
+  return bits == 2 ? bc7_weights2 : bits == 3 ? bc7_weights3 : bc7_weights4;
+}
+
+/* Replicates the top bits of a `bits` wide value into the low ones. */
+static uint8_t bc7_unquantize(uint32_t value, uint32_t bits)
+{
+  value <<= 8 - bits;
+  return (uint8_t) (value | value >> bits);
+}
+
+/*
+ * The fields in order, least significant bit first: the mode as a one
+ * after that many zeros, partition, rotation and index selection, every
+ * endpoint's red then green, blue and alpha, p-bits and the indices.
+ */
+static void bc7_pack(const Bc7Block *in, uint8_t *block)
+{
+  const Bc7Mode *info = &bc7_modes[in->mode];
+  uint32_t pos = 0;
+  memset(block, 0, 16);
+  put_bits(block, &pos, 1u << in->mode, in->mode + 1);
+  put_bits(block, &pos, in->partition, info->partition_bits);
+  put_bits(block, &pos, in->rotation, info->rotation_bits);
+  put_bits(block, &pos, in->index_selection, info->index_selection_bits);
+  for (uint32_t c = 0; c < (info->alpha_bits > 0 ? 4u : 3u); c++)
+  {
+    for (uint32_t s = 0; s < info->subsets; s++)
+    {
+      for (uint32_t e = 0; e < 2; e++)
+      {
+        put_bits(block, &pos, in->endpoints[s][e][c],
+                 c < 3 ? info->color_bits : info->alpha_bits);
+      }
+    }
+  }
+  for (uint32_t s = 0; s < info->subsets; s++)
+  {
+    if (info->endpoint_pbits)
+    {
+      put_bits(block, &pos, in->pbits[s][0], 1);
+      put_bits(block, &pos, in->pbits[s][1], 1);
+    }
+    else if (info->shared_pbits)
+    {
+      put_bits(block, &pos, in->pbits[s][0], 1);
+    }
+  }
+  for (uint32_t t = 0; t < 16; t++)
+  {
+    uint32_t subset = bc7_subset(info->subsets, in->partition, t);
+    bool anchor = bc7_anchor(info->subsets, in->partition, subset) == t;
+    put_bits(block, &pos, in->indices[t], info->index_bits - anchor);
+  }
+  for (uint32_t t = 0; t < 16 && info->index2_bits > 0; t++)
+  {
+    put_bits(block, &pos, in->indices2[t], info->index2_bits - (t == 0));
+  }
+}
+
+/* Fails on the reserved mode, which decodes as transparent black. */
+static bool bc7_unpack(const uint8_t *block, Bc7Block *out)
+{
+  memset(out, 0, sizeof(Bc7Block));
+  if (block[0] == 0)
+  {
+    return false;
+  }
+  out->mode = MIUR_CTZ32(block[0]);
+  const Bc7Mode *info = &bc7_modes[out->mode];
+  uint32_t pos = out->mode + 1;
+  out->partition = get_bits(block, &pos, info->partition_bits);
+  out->rotation = get_bits(block, &pos, info->rotation_bits);
+  out->index_selection = get_bits(block, &pos, info->index_selection_bits);
+  for (uint32_t c = 0; c < (info->alpha_bits > 0 ? 4u : 3u); c++)
+  {
+    for (uint32_t s = 0; s < info->subsets; s++)
+    {
+      for (uint32_t e = 0; e < 2; e++)
+      {
+        out->endpoints[s][e][c] = (uint8_t) get_bits(
+          block, &pos, c < 3 ? info->color_bits : info->alpha_bits);
+      }
+    }
+  }
+  for (uint32_t s = 0; s < info->subsets; s++)
+  {
+    if (info->endpoint_pbits)
+    {
+      out->pbits[s][0] = (uint8_t) get_bits(block, &pos, 1);
+      out->pbits[s][1] = (uint8_t) get_bits(block, &pos, 1);
+    }
+    else if (info->shared_pbits)
+    {
+      out->pbits[s][0] = (uint8_t) get_bits(block, &pos, 1);
+      out->pbits[s][1] = out->pbits[s][0];
+    }
+  }
+  for (uint32_t t = 0; t < 16; t++)
+  {
+    uint32_t subset = bc7_subset(info->subsets, out->partition, t);
+    bool anchor = bc7_anchor(info->subsets, out->partition, subset) == t;
+    out->indices[t] = (uint8_t) get_bits(block, &pos,
+                                         info->index_bits - anchor);
+  }
+  for (uint32_t t = 0; t < 16 && info->index2_bits > 0; t++)
+  {
+    out->indices2[t] = (uint8_t) get_bits(block, &pos,
+                                          info->index2_bits - (t == 0));
+  }
+  return true;
+}
+
+static void bc7_decode(const uint8_t *block, uint8_t texels[64])
+{
+  Bc7Block in;
+  if (!bc7_unpack(block, &in))
+  {
+    memset(texels, 0, 64);
+    return;
+  }
+  const Bc7Mode *info = &bc7_modes[in.mode];
+  bool pbits = info->endpoint_pbits || info->shared_pbits;
+  uint8_t endpoints[BC7_MAX_SUBSETS][2][4];
+  for (uint32_t s = 0; s < info->subsets; s++)
+  {
+    for (uint32_t e = 0; e < 2; e++)
+    {
+      for (uint32_t c = 0; c < 4; c++)
+      {
+        uint32_t bits = c < 3 ? info->color_bits : info->alpha_bits;
+        uint32_t value = in.endpoints[s][e][c];
+        if (bits == 0)
+        {
+          endpoints[s][e][c] = 255;
+        }
+        else if (pbits)
+        {
+          endpoints[s][e][c] = bc7_unquantize(value << 1 | in.pbits[s][e],
+                                              bits + 1);
+        }
+        else
+        {
+          endpoints[s][e][c] = bc7_unquantize(value, bits);
+        }
+      }
+    }
+  }
+
+  /* Mode 4's index selection swaps which set of indices is color's. */
+  const uint8_t *color = in.indices;
+  const uint8_t *alpha = in.indices;
+  uint32_t color_bits = info->index_bits;
+  uint32_t alpha_bits = info->index_bits;
+  if (info->index2_bits > 0)
+  {
+    bool swap = in.index_selection != 0;
+    color = swap ? in.indices2 : in.indices;
+    alpha = swap ? in.indices : in.indices2;
+    color_bits = swap ? info->index2_bits : info->index_bits;
+    alpha_bits = swap ? info->index_bits : info->index2_bits;
+  }
+  const uint8_t *color_weights = bc7_weights(color_bits);
+  const uint8_t *alpha_weights = bc7_weights(alpha_bits);
+  for (uint32_t t = 0; t < 16; t++)
+  {
+    uint8_t (*ends)[4] = endpoints[bc7_subset(info->subsets, in.partition,
+                                              t)];
+    for (uint32_t c = 0; c < 4; c++)
+    {
+      uint32_t w = c < 3 ? color_weights[color[t]] : alpha_weights[alpha[t]];
+      texels[t * 4 + c] = (uint8_t) (((64 - w) * ends[0][c] +
+                                      w * ends[1][c] + 32) >> 6);
+    }
+    if (in.rotation > 0)
+    {
+      uint8_t swap = texels[t * 4 + in.rotation - 1];
+      texels[t * 4 + in.rotation - 1] = texels[t * 4 + 3];
+      texels[t * 4 + 3] = swap;
+    }
+  }
+}
+
+static void put_bits(uint8_t *block, uint32_t *pos, uint32_t value,
+                     uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++, (*pos)++)
+  {
+    block[*pos >> 3] |= (uint8_t) ((value >> i & 1) << (*pos & 7));
+  }
+}
+
+static uint32_t get_bits(const uint8_t *block, uint32_t *pos,
+                         uint32_t count)
+{
+  uint32_t value = 0;
+  for (uint32_t i = 0; i < count; i++, (*pos)++)
+  {
+    value |= (uint32_t) (block[*pos >> 3] >> (*pos & 7) & 1) << i;
+  }
+  return value;
+}
@@ -49,6 +49,33 @@ void thread_destroy(Thread *thread)
   CloseHandle((HANDLE) *thread);
 }
 
+void thread_yield(void)
+{
+  SwitchToThread();
+}
+
+uint32_t thread_cpu_count(void)
+{
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+}
+
+uint64_t thread_time_ns(void)
+{
+  static LARGE_INTEGER frequency;
+  if (frequency.QuadPart == 0)
+  {
+    QueryPerformanceFrequency(&frequency);
+  }
+  LARGE_INTEGER counter;
+  QueryPerformanceCounter(&counter);
+  /* Split to keep the multiply from overflowing. */
+  uint64_t ticks = (uint64_t) counter.QuadPart;
+  uint64_t freq = (uint64_t) frequency.QuadPart;
+  return ticks / freq * 1000000000ull + ticks % freq * 1000000000ull / freq;
+}
+
 void mutex_create(Mutex *mutex_out, MutexBits bits)
 {
   (void) bits;
@@ -75,6 +102,52 @@ void mutex_unlock(Mutex *mutex)
   LeaveCriticalSection(mutex);
 }
 
+void cond_create(CondVar *cond_out)
+{
+  InitializeConditionVariable(cond_out);
+}
+
+void cond_destroy(CondVar *cond)
+{
+  /* Windows condition variables hold no resources. */
+  (void) cond;
+}
+
+void cond_wait(CondVar *cond, Mutex *mutex)
+{
+  SleepConditionVariableCS(cond, mutex, INFINITE);
+}
+
+void cond_signal(CondVar *cond)
+{
+  WakeConditionVariable(cond);
+}
+
+void cond_broadcast(CondVar *cond)
+{
+  WakeAllConditionVariable(cond);
+}
+
+int32_t atomic_i32_load(AtomicI32 *atomic)
+{
+  return InterlockedCompareExchange(atomic, 0, 0);
+}
+
+void atomic_i32_store(AtomicI32 *atomic, int32_t value)
+{
+  InterlockedExchange(atomic, value);
+}
+
+int32_t atomic_i32_add(AtomicI32 *atomic, int32_t value)
+{
+  return InterlockedExchangeAdd(atomic, value) + value;
+}
+
+bool atomic_i32_cas(AtomicI32 *atomic, int32_t expected, int32_t desired)
+{
+  return InterlockedCompareExchange(atomic, desired, expected) == expected;
+}
+
 /* === PRIVATE FUNCTIONS === */
 
 DWORD WINAPI win32_thread_start(void *_ud)
@@ -87,4 +160,155 @@ DWORD WINAPI win32_thread_start(void *_ud)
   return 0;
 }
 
+#elif defined(MIUR_PLATFORM_POSIX)
+
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct
+{
+  ThreadStartFunction function;
+  void *ud;
+} PosixUserData;
+
+/* === PROTOTYPES === */
+static void *posix_thread_start(void *ud);
+
+/* === PUBLIC FUNCTIONS === */
+
+bool thread_create(Thread *thread_out, ThreadStartFunction function, void *ud)
+{
+  PosixUserData *posix_ud = MIUR_NEW(PosixUserData);
+  posix_ud->function = function;
+  posix_ud->ud = ud;
+
+  if (pthread_create(thread_out, NULL, posix_thread_start, posix_ud) != 0)
+  {
+    MIUR_FREE(posix_ud);
+    return false;
+  }
+
+  return true;
+}
+
+void thread_join(Thread *thread)
+{
+  pthread_join(*thread, NULL);
+}
+
+void thread_destroy(Thread *thread)
+{
+  /* Joined threads have nothing left to release. */
+  (void) thread;
+}
+
+void thread_yield(void)
+{
+  sched_yield();
+}
+
+uint32_t thread_cpu_count(void)
+{
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (uint32_t) count : 1;
+}
+
+uint64_t thread_time_ns(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec;
+}
+
+void mutex_create(Mutex *mutex_out, MutexBits bits)
+{
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  if (bits & MUTEX_RECURSIVE)
+  {
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  }
+  pthread_mutex_init(mutex_out, &attr);
+  pthread_mutexattr_destroy(&attr);
+}
+
+void mutex_destroy(Mutex *mutex)
+{
+  pthread_mutex_destroy(mutex);
+}
+
+bool mutex_try_lock(Mutex *mutex)
+{
+  return pthread_mutex_trylock(mutex) == 0;
+}
+
+void mutex_lock(Mutex *mutex)
+{
+  pthread_mutex_lock(mutex);
+}
+
+void mutex_unlock(Mutex *mutex)
+{
+  pthread_mutex_unlock(mutex);
+}
+
+void cond_create(CondVar *cond_out)
+{
+  pthread_cond_init(cond_out, NULL);
+}
+
+void cond_destroy(CondVar *cond)
+{
+  pthread_cond_destroy(cond);
+}
+
+void cond_wait(CondVar *cond, Mutex *mutex)
+{
+  pthread_cond_wait(cond, mutex);
+}
+
+void cond_signal(CondVar *cond)
+{
+  pthread_cond_signal(cond);
+}
+
+void cond_broadcast(CondVar *cond)
+{
+  pthread_cond_broadcast(cond);
+}
+
+int32_t atomic_i32_load(AtomicI32 *atomic)
+{
+  return __atomic_load_n(atomic, __ATOMIC_SEQ_CST);
+}
+
+void atomic_i32_store(AtomicI32 *atomic, int32_t value)
+{
+  __atomic_store_n(atomic, value, __ATOMIC_SEQ_CST);
+}
+
+int32_t atomic_i32_add(AtomicI32 *atomic, int32_t value)
+{
+  return __atomic_add_fetch(atomic, value, __ATOMIC_SEQ_CST);
+}
+
+bool atomic_i32_cas(AtomicI32 *atomic, int32_t expected, int32_t desired)
+{
+  return __atomic_compare_exchange_n(atomic, &expected, desired, false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void *posix_thread_start(void *_ud)
+{
+  PosixUserData *ud = (PosixUserData *) _ud;
+
+  ud->function(ud->ud);
+
+  MIUR_FREE(ud);
+  return NULL;
+}
+
 #endif
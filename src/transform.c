@@ -0,0 +1,133 @@
+/* =====================
+ * src/transform.c
+ * 10/18/2026
+ * 4x4 transforms and node hierarchies.
+ * ====================
+ */
+
+#include <string.h>
+
+#include <miur/transform.h>
+#include <miur/simd.h>
+
+/* === PROTOTYPES === */
+
+static void mul_kernel(float *out, const float *a, const float *b);
+
+/* === PUBLIC FUNCTIONS === */
+
+void mat4_identity(float *out)
+{
+  memset(out, 0, 16 * sizeof(float));
+  out[0] = out[5] = out[10] = out[15] = 1.0f;
+}
+
+void mat4_from_trs(float *out, const float *translation,
+                   const float *rotation, const float *scale)
+{
+  float x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+  float xx = x * x, yy = y * y, zz = z * z;
+  float xy = x * y, xz = x * z, yz = y * z;
+  float wx = w * x, wy = w * y, wz = w * z;
+
+  out[0] = (1.0f - 2.0f * (yy + zz)) * scale[0];
+  out[1] = 2.0f * (xy + wz) * scale[0];
+  out[2] = 2.0f * (xz - wy) * scale[0];
+  out[3] = 0.0f;
+  out[4] = 2.0f * (xy - wz) * scale[1];
+  out[5] = (1.0f - 2.0f * (xx + zz)) * scale[1];
+  out[6] = 2.0f * (yz + wx) * scale[1];
+  out[7] = 0.0f;
+  out[8] = 2.0f * (xz + wy) * scale[2];
+  out[9] = 2.0f * (yz - wx) * scale[2];
+  out[10] = (1.0f - 2.0f * (xx + yy)) * scale[2];
+  out[11] = 0.0f;
+  out[12] = translation[0];
+  out[13] = translation[1];
+  out[14] = translation[2];
+  out[15] = 1.0f;
+}
+
+void mat4_mul(float *out, const float *a, const float *b)
+{
+  mul_kernel(out, a, b);
+}
+
+void transform_compute_world(float *world, const float *local,
+                             const int32_t *parents, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    if (parents[i] < 0)
+    {
+      memcpy(&world[i * 16], &local[i * 16], 16 * sizeof(float));
+    } else
+    {
+      mul_kernel(&world[i * 16], &world[(size_t) parents[i] * 16],
+                 &local[i * 16]);
+    }
+  }
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/*
+ * Column j of the product is the columns of `a` weighted by column j of
+ * `b`.  Every input is read before the first store, so `out` may alias.
+ */
+static void mul_kernel(float *out, const float *a, const float *b)
+{
+#if defined(MIUR_HAVE_AVX2)
+  /* Two result columns per register, each lane pair weighted by its own. */
+  __m256 a0 = _mm256_broadcast_ps((const __m128 *) &a[0]);
+  __m256 a1 = _mm256_broadcast_ps((const __m128 *) &a[4]);
+  __m256 a2 = _mm256_broadcast_ps((const __m128 *) &a[8]);
+  __m256 a3 = _mm256_broadcast_ps((const __m128 *) &a[12]);
+  __m256 b01 = _mm256_loadu_ps(&b[0]);
+  __m256 b23 = _mm256_loadu_ps(&b[8]);
+  __m256 r01 = _mm256_mul_ps(a0, _mm256_permute_ps(b01, 0x00));
+  __m256 r23 = _mm256_mul_ps(a0, _mm256_permute_ps(b23, 0x00));
+  r01 = _mm256_add_ps(r01, _mm256_mul_ps(a1, _mm256_permute_ps(b01, 0x55)));
+  r23 = _mm256_add_ps(r23, _mm256_mul_ps(a1, _mm256_permute_ps(b23, 0x55)));
+  r01 = _mm256_add_ps(r01, _mm256_mul_ps(a2, _mm256_permute_ps(b01, 0xaa)));
+  r23 = _mm256_add_ps(r23, _mm256_mul_ps(a2, _mm256_permute_ps(b23, 0xaa)));
+  r01 = _mm256_add_ps(r01, _mm256_mul_ps(a3, _mm256_permute_ps(b01, 0xff)));
+  r23 = _mm256_add_ps(r23, _mm256_mul_ps(a3, _mm256_permute_ps(b23, 0xff)));
+  _mm256_storeu_ps(&out[0], r01);
+  _mm256_storeu_ps(&out[8], r23);
+#elif defined(MIUR_HAVE_SSE2)
+  __m128 a0 = _mm_loadu_ps(&a[0]);
+  __m128 a1 = _mm_loadu_ps(&a[4]);
+  __m128 a2 = _mm_loadu_ps(&a[8]);
+  __m128 a3 = _mm_loadu_ps(&a[12]);
+  __m128 b0 = _mm_loadu_ps(&b[0]);
+  __m128 b1 = _mm_loadu_ps(&b[4]);
+  __m128 b2 = _mm_loadu_ps(&b[8]);
+  __m128 b3 = _mm_loadu_ps(&b[12]);
+  __m128 cols[4] = { b0, b1, b2, b3 };
+  for (int j = 0; j < 4; j++)
+  {
+    __m128 col = cols[j];
+    __m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(col, col, 0x00));
+    r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(col, col, 0x55)));
+    r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(col, col, 0xaa)));
+    r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(col, col, 0xff)));
+    cols[j] = r;
+  }
+  _mm_storeu_ps(&out[0], cols[0]);
+  _mm_storeu_ps(&out[4], cols[1]);
+  _mm_storeu_ps(&out[8], cols[2]);
+  _mm_storeu_ps(&out[12], cols[3]);
+#else
+  float r[16];
+  for (int j = 0; j < 4; j++)
+  {
+    for (int i = 0; i < 4; i++)
+    {
+      r[j * 4 + i] = a[i] * b[j * 4] + a[4 + i] * b[j * 4 + 1] +
+        a[8 + i] * b[j * 4 + 2] + a[12 + i] * b[j * 4 + 3];
+    }
+  }
+  memcpy(out, r, sizeof(r));
+#endif
+}
@@ -0,0 +1,153 @@
+/* =====================
+ * src/utf8.c
+ * 10/18/2026
+ * UTF-8 validation and encoding.
+ * ====================
+ */
+
+#include <miur/utf8.h>
+#include <miur/simd.h>
+
+/* === PROTOTYPES === */
+
+static size_t validate_sequence(const uint8_t *data, size_t size);
+
+/* === PUBLIC FUNCTIONS === */
+
+bool utf8_validate(const uint8_t *data, size_t size)
+{
+  size_t i = 0;
+
+  while (i < size)
+  {
+#ifdef MIUR_HAVE_SSE2
+    /* Skip ASCII 16 bytes at a time, most of what we see (keys, paths,
+     * names) never leaves this loop. */
+    while (i + 16 <= size)
+    {
+      __m128i chunk = _mm_loadu_si128((const __m128i *) (data + i));
+      unsigned mask = (unsigned) _mm_movemask_epi8(chunk);
+      if (mask != 0)
+      {
+        i += MIUR_CTZ32(mask);
+        break;
+      }
+      i += 16;
+    }
+    if (i >= size)
+    {
+      break;
+    }
+#endif
+    if (data[i] < 0x80)
+    {
+      i++;
+      continue;
+    }
+
+    size_t len = validate_sequence(data + i, size - i);
+    if (len == 0)
+    {
+      return false;
+    }
+    i += len;
+  }
+
+  return true;
+}
+
+size_t utf8_encode(uint32_t codepoint, uint8_t out[UTF8_MAX_ENCODED_LENGTH])
+{
+  if (codepoint < 0x80)
+  {
+    out[0] = (uint8_t) codepoint;
+    return 1;
+  }
+  else if (codepoint < 0x800)
+  {
+    out[0] = (uint8_t) (0xC0 | (codepoint >> 6));
+    out[1] = (uint8_t) (0x80 | (codepoint & 0x3F));
+    return 2;
+  }
+  else if (codepoint < 0x10000)
+  {
+    if (codepoint >= 0xD800 && codepoint <= 0xDFFF)
+    {
+      return 0;
+    }
+    out[0] = (uint8_t) (0xE0 | (codepoint >> 12));
+    out[1] = (uint8_t) (0x80 | ((codepoint >> 6) & 0x3F));
+    out[2] = (uint8_t) (0x80 | (codepoint & 0x3F));
+    return 3;
+  }
+  else if (codepoint < 0x110000)
+  {
+    out[0] = (uint8_t) (0xF0 | (codepoint >> 18));
+    out[1] = (uint8_t) (0x80 | ((codepoint >> 12) & 0x3F));
+    out[2] = (uint8_t) (0x80 | ((codepoint >> 6) & 0x3F));
+    out[3] = (uint8_t) (0x80 | (codepoint & 0x3F));
+    return 4;
+  }
+  return 0;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/*
+ * Validates one multi byte sequence starting at `data`, following table 3-7
+ * of the Unicode standard.  Returns its length or 0 if it is malformed.
+ */
+static size_t validate_sequence(const uint8_t *data, size_t size)
+{
+  uint8_t lead = data[0];
+  uint8_t lo = 0x80, hi = 0xBF;
+  size_t len;
+
+  if (lead >= 0xC2 && lead <= 0xDF)
+  {
+    len = 2;
+  }
+  else if (lead >= 0xE0 && lead <= 0xEF)
+  {
+    len = 3;
+    if (lead == 0xE0)
+    {
+      lo = 0xA0;
+    }
+    else if (lead == 0xED)
+    {
+      hi = 0x9F;
+    }
+  }
+  else if (lead >= 0xF0 && lead <= 0xF4)
+  {
+    len = 4;
+    if (lead == 0xF0)
+    {
+      lo = 0x90;
+    }
+    else if (lead == 0xF4)
+    {
+      hi = 0x8F;
+    }
+  }
+  else
+  {
+    return 0;
+  }
+
+  if (size < len || data[1] < lo || data[1] > hi)
+  {
+    return 0;
+  }
+
+  for (size_t i = 2; i < len; i++)
+  {
+    if ((data[i] & 0xC0) != 0x80)
+    {
+      return 0;
+    }
+  }
+
+  return len;
+}
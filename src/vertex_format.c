@@ -0,0 +1,476 @@
+/* =====================
+ * src/vertex_format.c
+ * 10/18/2026
+ * GPU vertex formats.
+ * ====================
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <miur/vertex_format.h>
+#include <miur/simd.h>
+
+typedef struct
+{
+  VkFormat format;
+  uint32_t size;
+} AttributeFormat;
+
+/* === PROTOTYPES === */
+
+static int16_t snorm16_encode(float v);
+static float snorm16_decode(int16_t v);
+static void position_encode(int16_t out[4], const float p[3],
+                            const float inv_scale[3],
+                            const VertexQuantization *quant);
+static void oct_encode(int16_t out[2], const float n[3]);
+static void oct_decode(float out[3], const int16_t e[2]);
+static uint16_t half_encode(float f);
+static float half_decode(uint16_t h);
+static void inverse_scale(float out[3], const VertexQuantization *quant);
+static void interleave_float(float *dst, const float *pos, const float *norm,
+                             const float *uv, size_t count);
+
+/* === GLOBALS === */
+
+const char *const vertex_format_names[] = {
+  [VERTEX_FORMAT_FLOAT] = "float",
+  [VERTEX_FORMAT_QUANTIZED] = "quantized",
+  [VERTEX_FORMAT_COUNT] = NULL,
+};
+
+const char *const vertex_layout_names[] = {
+  [VERTEX_LAYOUT_SEPARATE] = "separate",
+  [VERTEX_LAYOUT_INTERLEAVED] = "interleaved",
+  [VERTEX_LAYOUT_COUNT] = NULL,
+};
+
+static const AttributeFormat
+attribute_formats[VERTEX_FORMAT_COUNT][VERTEX_ATTRIBUTE_COUNT] = {
+  [VERTEX_FORMAT_FLOAT] = {
+    [VERTEX_ATTRIBUTE_POSITION] = { VK_FORMAT_R32G32B32_SFLOAT, 12 },
+    [VERTEX_ATTRIBUTE_NORMAL] = { VK_FORMAT_R32G32B32_SFLOAT, 12 },
+    [VERTEX_ATTRIBUTE_UV] = { VK_FORMAT_R32G32_SFLOAT, 8 },
+  },
+  [VERTEX_FORMAT_QUANTIZED] = {
+    [VERTEX_ATTRIBUTE_POSITION] = { VK_FORMAT_R16G16B16A16_SNORM, 8 },
+    [VERTEX_ATTRIBUTE_NORMAL] = { VK_FORMAT_R16G16_SNORM, 4 },
+    [VERTEX_ATTRIBUTE_UV] = { VK_FORMAT_R16G16_SFLOAT, 4 },
+  },
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+VkFormat vertex_attribute_format(VertexFormat format, VertexAttribute attr)
+{
+  return attribute_formats[format][attr].format;
+}
+
+uint32_t vertex_attribute_size(VertexFormat format, VertexAttribute attr)
+{
+  return attribute_formats[format][attr].size;
+}
+
+uint32_t vertex_attribute_offset(VertexFormat format, VertexAttribute attr)
+{
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < (uint32_t) attr; i++)
+  {
+    offset += attribute_formats[format][i].size;
+  }
+  return offset;
+}
+
+uint32_t vertex_stride(VertexFormat format)
+{
+  return vertex_attribute_offset(format, VERTEX_ATTRIBUTE_COUNT);
+}
+
+uint32_t vertex_layout_binding_count(VertexLayout layout)
+{
+  return layout == VERTEX_LAYOUT_INTERLEAVED ? 1 : VERTEX_ATTRIBUTE_COUNT;
+}
+
+uint32_t vertex_binding_stride(VertexFormat format, VertexLayout layout,
+                               uint32_t binding)
+{
+  if (layout == VERTEX_LAYOUT_INTERLEAVED)
+  {
+    return vertex_stride(format);
+  }
+  return attribute_formats[format][binding].size;
+}
+
+void vertex_quantization_fit(VertexQuantization *quant,
+                             const float *positions, size_t count)
+{
+  float min[3] = {0.0f, 0.0f, 0.0f};
+  float max[3] = {0.0f, 0.0f, 0.0f};
+  for (size_t i = 0; i < count; i++)
+  {
+    for (int c = 0; c < 3; c++)
+    {
+      float v = positions[i * 3 + c];
+      if (i == 0 || v < min[c])
+      {
+        min[c] = v;
+      }
+      if (i == 0 || v > max[c])
+      {
+        max[c] = v;
+      }
+    }
+  }
+
+  for (int c = 0; c < 3; c++)
+  {
+    quant->offset[c] = (min[c] + max[c]) * 0.5f;
+    quant->scale[c] = (max[c] - min[c]) * 0.5f;
+    /* A flat axis maps everything to the offset, any scale will do. */
+    if (quant->scale[c] <= 0.0f)
+    {
+      quant->scale[c] = 1.0f;
+    }
+  }
+  quant->offset[3] = 0.0f;
+  quant->scale[3] = 1.0f;
+}
+
+void vertex_attribute_write(void *dst, size_t stride, VertexFormat format,
+                            VertexAttribute attr, const float *src,
+                            size_t count, const VertexQuantization *quant)
+{
+  uint8_t *out = (uint8_t *) dst;
+  uint32_t size = attribute_formats[format][attr].size;
+
+  if (src == NULL)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      memset(out + i * stride, 0, size);
+    }
+    return;
+  }
+
+  if (format == VERTEX_FORMAT_FLOAT)
+  {
+    if (stride == size)
+    {
+      memcpy(out, src, count * size);
+      return;
+    }
+    size_t components = size / sizeof(float);
+    for (size_t i = 0; i < count; i++)
+    {
+      memcpy(out + i * stride, src + i * components, size);
+    }
+    return;
+  }
+
+  switch (attr)
+  {
+    case VERTEX_ATTRIBUTE_POSITION:
+    {
+      float inv_scale[3];
+      inverse_scale(inv_scale, quant);
+      for (size_t i = 0; i < count; i++)
+      {
+        int16_t v[4];
+        position_encode(v, &src[i * 3], inv_scale, quant);
+        memcpy(out + i * stride, v, sizeof(v));
+      }
+      break;
+    }
+    case VERTEX_ATTRIBUTE_NORMAL:
+    {
+      for (size_t i = 0; i < count; i++)
+      {
+        int16_t v[2];
+        oct_encode(v, &src[i * 3]);
+        memcpy(out + i * stride, v, sizeof(v));
+      }
+      break;
+    }
+    case VERTEX_ATTRIBUTE_UV:
+    {
+      for (size_t i = 0; i < count; i++)
+      {
+        uint16_t v[2] = {half_encode(src[i * 2]), half_encode(src[i * 2 + 1])};
+        memcpy(out + i * stride, v, sizeof(v));
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void vertex_interleave(void *dst, VertexFormat format,
+                       const float *const sources[VERTEX_ATTRIBUTE_COUNT],
+                       size_t count, const VertexQuantization *quant)
+{
+  const float *pos = sources[VERTEX_ATTRIBUTE_POSITION];
+  const float *norm = sources[VERTEX_ATTRIBUTE_NORMAL];
+  if (format == VERTEX_FORMAT_FLOAT && pos != NULL && norm != NULL)
+  {
+    interleave_float((float *) dst, pos, norm, sources[VERTEX_ATTRIBUTE_UV],
+                     count);
+    return;
+  }
+
+  uint32_t stride = vertex_stride(format);
+  for (uint32_t i = 0; i < VERTEX_ATTRIBUTE_COUNT; i++)
+  {
+    vertex_attribute_write((uint8_t *) dst + vertex_attribute_offset(format, i),
+                           stride, format, i, sources[i], count, quant);
+  }
+}
+
+void vertex_quantization_measure(VertexQuantizationError *error,
+                                 const VertexQuantization *quant,
+                                 const float *positions, const float *normals,
+                                 const float *uvs, size_t count)
+{
+  float inv_scale[3];
+  inverse_scale(inv_scale, quant);
+  error->position = error->normal = error->uv = 0.0f;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    const float *p = &positions[i * 3];
+    int16_t qp[4];
+    position_encode(qp, p, inv_scale, quant);
+    for (int c = 0; c < 3; c++)
+    {
+      float d = snorm16_decode(qp[c]) * quant->scale[c] + quant->offset[c];
+      error->position = fmaxf(error->position, fabsf(d - p[c]));
+    }
+
+    const float *n = &normals[i * 3];
+    float len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (len > 0.0f)
+    {
+      int16_t qn[2];
+      float d[3];
+      oct_encode(qn, n);
+      oct_decode(d, qn);
+      /* acosf of a cosine this close to 1 is off by more than the error. */
+      float cross[3] = {
+        n[1] * d[2] - n[2] * d[1],
+        n[2] * d[0] - n[0] * d[2],
+        n[0] * d[1] - n[1] * d[0],
+      };
+      float sine = sqrtf(cross[0] * cross[0] + cross[1] * cross[1] +
+                         cross[2] * cross[2]);
+      float cosine = n[0] * d[0] + n[1] * d[1] + n[2] * d[2];
+      error->normal = fmaxf(error->normal, atan2f(sine, cosine));
+    }
+
+    if (uvs != NULL)
+    {
+      for (int c = 0; c < 2; c++)
+      {
+        float uv = uvs[i * 2 + c];
+        float d = half_decode(half_encode(uv));
+        error->uv = fmaxf(error->uv, fabsf(d - uv));
+      }
+    }
+  }
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/*
+ * Vulkan decodes SNORM as c / 32767, round to the nearest step.  Biased to
+ * be positive so the conversion's truncation floors, no branch on the sign
+ * and no lrintf, which stays a library call unless errno handling is off.
+ */
+static int16_t snorm16_encode(float v)
+{
+  v = v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v);
+  return (int16_t) ((int32_t) (v * 32767.0f + 32768.5f) - 32768);
+}
+
+static float snorm16_decode(int16_t v)
+{
+  return v == -32768 ? -1.0f : (float) v / 32767.0f;
+}
+
+static void position_encode(int16_t out[4], const float p[3],
+                            const float inv_scale[3],
+                            const VertexQuantization *quant)
+{
+  for (int c = 0; c < 3; c++)
+  {
+    out[c] = snorm16_encode((p[c] - quant->offset[c]) * inv_scale[c]);
+  }
+  out[3] = 0;
+}
+
+/*
+ * Projects the normal onto the octahedron |x| + |y| + |z| = 1 and unfolds
+ * the lower half over the corners, see Cigolle et al., "A Survey of
+ * Efficient Representations for Independent Unit Vectors", 2014.
+ */
+static void oct_encode(int16_t out[2], const float n[3])
+{
+  float l1 = fabsf(n[0]) + fabsf(n[1]) + fabsf(n[2]);
+  float x = 0.0f;
+  float y = 0.0f;
+  if (l1 > 0.0f)
+  {
+    x = n[0] / l1;
+    y = n[1] / l1;
+    if (n[2] < 0.0f)
+    {
+      float fx = copysignf(1.0f - fabsf(y), x);
+      float fy = copysignf(1.0f - fabsf(x), y);
+      x = fx;
+      y = fy;
+    }
+  }
+  out[0] = snorm16_encode(x);
+  out[1] = snorm16_encode(y);
+}
+
+/* Mirrors oct_decode in the quantized vertex shaders. */
+static void oct_decode(float out[3], const int16_t e[2])
+{
+  float x = snorm16_decode(e[0]);
+  float y = snorm16_decode(e[1]);
+  float z = 1.0f - fabsf(x) - fabsf(y);
+  float t = z < 0.0f ? -z : 0.0f;
+  x -= copysignf(t, x);
+  y -= copysignf(t, y);
+  float len = sqrtf(x * x + y * y + z * z);
+  out[0] = x / len;
+  out[1] = y / len;
+  out[2] = z / len;
+}
+
+/* Round to nearest even, overflow goes to infinity. */
+static uint16_t half_encode(float f)
+{
+  uint32_t x;
+  memcpy(&x, &f, sizeof(x));
+  uint16_t sign = (uint16_t) ((x >> 16) & 0x8000);
+  uint32_t abs = x & 0x7fffffff;
+
+  if (abs >= 0x7f800000)
+  {
+    return sign | 0x7c00 | (abs > 0x7f800000 ? 0x200 : 0);
+  }
+  /* 65520 and up round past the largest half. */
+  if (abs >= 0x477ff000)
+  {
+    return sign | 0x7c00;
+  }
+  /* Below 2^-14 the half is denormal, steps of 2^-24. */
+  if (abs < 0x38800000)
+  {
+    float a;
+    memcpy(&a, &abs, sizeof(a));
+    return sign | (uint16_t) lrintf(a * 16777216.0f);
+  }
+
+  /* Rebias the exponent from 127 to 15 and round off 13 mantissa bits. */
+  abs += 0xc8000fffu + ((abs >> 13) & 1);
+  return sign | (uint16_t) (abs >> 13);
+}
+
+static float half_decode(uint16_t h)
+{
+  uint32_t sign = (uint32_t) (h & 0x8000) << 16;
+  uint32_t exponent = (h >> 10) & 0x1f;
+  uint32_t mantissa = h & 0x3ff;
+  uint32_t x;
+
+  if (exponent == 0)
+  {
+    float f = ldexpf((float) mantissa, -24);
+    return sign ? -f : f;
+  }
+  if (exponent == 31)
+  {
+    x = sign | 0x7f800000 | (mantissa << 13);
+  } else
+  {
+    x = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  }
+
+  float f;
+  memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+static void inverse_scale(float out[3], const VertexQuantization *quant)
+{
+  for (int c = 0; c < 3; c++)
+  {
+    out[c] = 1.0f / quant->scale[c];
+  }
+}
+
+/* Vertices of 8 floats, the position, normal and UV back to back. */
+static void interleave_float(float *dst, const float *pos, const float *norm,
+                             const float *uv, size_t count)
+{
+  size_t i = 0;
+#ifdef MIUR_HAVE_SSE2
+  /*
+   * Four vertices at a time, a 4x8 transpose.  Positions and normals come
+   * in as 3 vectors each, (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3), UVs
+   * as 2.
+   */
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 p0 = _mm_loadu_ps(pos + i * 3);
+    __m128 p1 = _mm_loadu_ps(pos + i * 3 + 4);
+    __m128 p2 = _mm_loadu_ps(pos + i * 3 + 8);
+    __m128 n0 = _mm_loadu_ps(norm + i * 3);
+    __m128 n1 = _mm_loadu_ps(norm + i * 3 + 4);
+    __m128 n2 = _mm_loadu_ps(norm + i * 3 + 8);
+    __m128 t0 = _mm_setzero_ps();
+    __m128 t1 = _mm_setzero_ps();
+    if (uv != NULL)
+    {
+      t0 = _mm_loadu_ps(uv + i * 2);
+      t1 = _mm_loadu_ps(uv + i * 2 + 4);
+    }
+
+    float *out = dst + i * 8;
+    /* Each `zn` pairs up a position's z with its normal's x. */
+    __m128 zn = _mm_shuffle_ps(p0, n0, _MM_SHUFFLE(0, 0, 2, 2));
+    _mm_storeu_ps(out, _mm_shuffle_ps(p0, zn, _MM_SHUFFLE(2, 0, 1, 0)));
+    _mm_storeu_ps(out + 4, _mm_shuffle_ps(n0, t0, _MM_SHUFFLE(1, 0, 2, 1)));
+
+    __m128 xy = _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(0, 0, 3, 3));
+    zn = _mm_shuffle_ps(p1, n0, _MM_SHUFFLE(3, 3, 1, 1));
+    _mm_storeu_ps(out + 8, _mm_shuffle_ps(xy, zn, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(out + 12, _mm_shuffle_ps(n1, t0, _MM_SHUFFLE(3, 2, 1, 0)));
+
+    zn = _mm_shuffle_ps(p2, n1, _MM_SHUFFLE(2, 2, 0, 0));
+    _mm_storeu_ps(out + 16, _mm_shuffle_ps(p1, zn, _MM_SHUFFLE(2, 0, 3, 2)));
+    __m128 yz = _mm_shuffle_ps(n1, n2, _MM_SHUFFLE(0, 0, 3, 3));
+    _mm_storeu_ps(out + 20, _mm_shuffle_ps(yz, t1, _MM_SHUFFLE(1, 0, 2, 0)));
+
+    zn = _mm_shuffle_ps(p2, n2, _MM_SHUFFLE(1, 1, 3, 3));
+    _mm_storeu_ps(out + 24, _mm_shuffle_ps(p2, zn, _MM_SHUFFLE(2, 0, 2, 1)));
+    _mm_storeu_ps(out + 28, _mm_shuffle_ps(n2, t1, _MM_SHUFFLE(3, 2, 3, 2)));
+  }
+#endif
+
+  for (; i < count; i++)
+  {
+    memcpy(dst + i * 8, pos + i * 3, 3 * sizeof(float));
+    memcpy(dst + i * 8 + 3, norm + i * 3, 3 * sizeof(float));
+    if (uv != NULL)
+    {
+      memcpy(dst + i * 8 + 6, uv + i * 2, 2 * sizeof(float));
+    } else
+    {
+      dst[i * 8 + 6] = dst[i * 8 + 7] = 0.0f;
+    }
+  }
+}
@@ -0,0 +1,434 @@
+/* =====================
+ * tests/accessor.c
+ * 10/18/2026
+ * Checks accessor decoding for every component type, stride and alignment.
+ * ====================
+ */
+
+/*
+ * convert_to_float is checked against a double precision reference on
+ * random bytes, for each component type, normalized or not, one to four
+ * components, packed and padded strides, misaligned sources and counts
+ * around the vector widths, with guard floats after the output to catch
+ * overruns.  The index conversions are checked the same way.  Then a glTF
+ * with one interleaved buffer view of i16 positions, normalized i8 normals
+ * and normalized u16 uvs, byteStride 20, and u8 indices is written to the
+ * directory given as the first argument, or the current one, and every
+ * loaded vertex is checked against what was written.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <miur/convert.h>
+#include <miur/gltf.h>
+#include <miur/mem.h>
+#include <miur/membuf.h>
+#include <miur/mesh_cache.h>
+
+#include "test.h"
+
+#define ACCESSOR_TEST_SEED 0x6163636573736F72ULL
+#define ACCESSOR_TEST_MAX_COUNT 1000
+#define ACCESSOR_TEST_GUARD 16
+#define ACCESSOR_TEST_SENTINEL 1234.5f
+#define ACCESSOR_TEST_GRID 8
+#define ACCESSOR_TEST_STRIDE 20
+#define ACCESSOR_TEST_PATH_SIZE 1024
+
+/* === PROTOTYPES === */
+
+static void check_convert(TestRng *rng);
+static bool convert_case(const uint8_t *src, float *dst, size_t stride,
+                         size_t count, uint32_t components,
+                         ComponentType type, bool normalized);
+static double reference_component(const uint8_t *p, ComponentType type,
+                                  bool normalized);
+static void check_indices(TestRng *rng);
+static uint32_t reference_index(const uint8_t *p, ComponentType type);
+static void check_interleaved(const char *dir, TestRng *rng);
+static bool write_interleaved(const char *path, const char *bin_path,
+                              uint8_t *bin, size_t bin_size);
+
+/* === GLOBALS === */
+
+static const size_t test_counts[] = {
+  0, 1, 2, 3, 4, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 65, 100,
+  ACCESSOR_TEST_MAX_COUNT,
+};
+
+/* Extra bytes between elements, 0 is tightly packed. */
+static const size_t test_padding[] = { 0, 1, 2, 3, 5, 16 };
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(int argc, char **argv)
+{
+  const char *dir = argc > 1 ? argv[1] : ".";
+  TestRng rng = test_rng(ACCESSOR_TEST_SEED);
+  check_convert(&rng);
+  check_indices(&rng);
+  check_interleaved(dir, &rng);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void check_convert(TestRng *rng)
+{
+  const size_t max_stride = 4 * 4 + 16;
+  size_t src_size = max_stride * ACCESSOR_TEST_MAX_COUNT + 8;
+  uint8_t *src = MIUR_ARR(uint8_t, src_size);
+  float *dst = MIUR_ARR(float, 4 * ACCESSOR_TEST_MAX_COUNT +
+                        ACCESSOR_TEST_GUARD);
+  if (!TEST_CHECK(src != NULL && dst != NULL))
+  {
+    MIUR_FREE(src);
+    MIUR_FREE(dst);
+    return;
+  }
+  for (size_t i = 0; i < src_size; i++)
+  {
+    src[i] = (uint8_t) test_rng_next(rng);
+  }
+
+  for (int type = COMPONENT_I8; type <= COMPONENT_FLOAT; type++)
+  {
+    /* Random bytes are mostly NaN or huge as floats, use real values. */
+    if (type == COMPONENT_FLOAT)
+    {
+      for (size_t i = 0; i + 4 <= src_size; i += 4)
+      {
+        float value = test_rng_float(rng, -1000.0f, 1000.0f);
+        memcpy(src + i, &value, sizeof(float));
+      }
+    }
+    for (int normalized = 0; normalized < 2; normalized++)
+    {
+      if (type == COMPONENT_FLOAT && normalized)
+      {
+        continue;
+      }
+      for (uint32_t components = 1; components <= 4; components++)
+      {
+        size_t elem_size = component_size((ComponentType) type) * components;
+        for (size_t p = 0; p < sizeof(test_padding) / sizeof(size_t); p++)
+        {
+          for (size_t c = 0; c < sizeof(test_counts) / sizeof(size_t); c++)
+          {
+            /* Odd offsets misalign the source for every type. */
+            for (size_t offset = 0; offset < 4; offset += 3)
+            {
+              bool ok = convert_case(src + offset, dst,
+                                     elem_size + test_padding[p],
+                                     test_counts[c], components,
+                                     (ComponentType) type, normalized);
+              if (!ok)
+              {
+                fprintf(stderr, "type %d normalized %d components %u "
+                        "stride %zu count %zu offset %zu\n", type,
+                        normalized, components, elem_size + test_padding[p],
+                        test_counts[c], offset);
+              }
+              TEST_CHECK(ok);
+            }
+          }
+        }
+      }
+    }
+  }
+  MIUR_FREE(src);
+  MIUR_FREE(dst);
+}
+
+static bool convert_case(const uint8_t *src, float *dst, size_t stride,
+                         size_t count, uint32_t components,
+                         ComponentType type, bool normalized)
+{
+  size_t out_count = count * components;
+  for (size_t i = 0; i < out_count + ACCESSOR_TEST_GUARD; i++)
+  {
+    dst[i] = ACCESSOR_TEST_SENTINEL;
+  }
+  convert_to_float(dst, src, stride, count, components, type, normalized);
+
+  size_t size = component_size(type);
+  for (size_t e = 0; e < count; e++)
+  {
+    for (uint32_t c = 0; c < components; c++)
+    {
+      double expected = reference_component(src + e * stride + c * size,
+                                            type, normalized);
+      double error = fabs(dst[e * components + c] - expected);
+      if (error > 1e-6 * fmax(1.0, fabs(expected)))
+      {
+        return false;
+      }
+    }
+  }
+  for (size_t i = out_count; i < out_count + ACCESSOR_TEST_GUARD; i++)
+  {
+    if (dst[i] != ACCESSOR_TEST_SENTINEL)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Vulkan's UNORM and SNORM rules, the most negative SNORM clamps to -1. */
+static double reference_component(const uint8_t *p, ComponentType type,
+                                  bool normalized)
+{
+  double value = 0.0, max = 1.0;
+  switch (type)
+  {
+  case COMPONENT_I8:
+    value = (int8_t) p[0];
+    max = 127.0;
+    break;
+  case COMPONENT_U8:
+    value = p[0];
+    max = 255.0;
+    break;
+  case COMPONENT_I16:
+    value = (int16_t) (p[0] | p[1] << 8);
+    max = 32767.0;
+    break;
+  case COMPONENT_U16:
+    value = (uint16_t) (p[0] | p[1] << 8);
+    max = 65535.0;
+    break;
+  case COMPONENT_U32:
+    value = (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 |
+      (uint32_t) p[3] << 24;
+    max = 4294967295.0;
+    break;
+  case COMPONENT_FLOAT:
+  {
+    float f;
+    memcpy(&f, p, sizeof(float));
+    return f;
+  }
+  }
+  return normalized ? fmax(value / max, -1.0) : value;
+}
+
+/* Indices are packed, the largest returned one is checked as well. */
+static void check_indices(TestRng *rng)
+{
+  const ComponentType types[] = { COMPONENT_U8, COMPONENT_U16, COMPONENT_U32 };
+  const size_t count = ACCESSOR_TEST_MAX_COUNT;
+  uint8_t *src = MIUR_ARR(uint8_t, count * 4 + 8);
+  uint16_t *dst16 = MIUR_ARR(uint16_t, count + ACCESSOR_TEST_GUARD);
+  uint32_t *dst32 = MIUR_ARR(uint32_t, count + ACCESSOR_TEST_GUARD);
+  if (!TEST_CHECK(src != NULL && dst16 != NULL && dst32 != NULL))
+  {
+    goto cleanup;
+  }
+
+  for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++)
+  {
+    size_t size = component_size(types[t]);
+    for (size_t c = 0; c < sizeof(test_counts) / sizeof(size_t); c++)
+    {
+      size_t n = test_counts[c];
+      for (size_t i = 0; i < n * size + 1; i++)
+      {
+        /* Mostly small, so u32 sources don't always saturate u16. */
+        src[i + 1] = (uint8_t) (i % size == size - 1 &&
+                                test_rng_below(rng, 4) != 0 ? 0 :
+                                test_rng_next(rng));
+      }
+      for (size_t i = 0; i < n + ACCESSOR_TEST_GUARD; i++)
+      {
+        dst16[i] = 0xBEEF;
+        dst32[i] = 0xDEADBEEF;
+      }
+
+      /* Misaligned by one byte. */
+      uint32_t max16 = convert_indices_u16(dst16, src + 1, n, types[t]);
+      uint32_t max32 = convert_indices_u32(dst32, src + 1, n, types[t]);
+      uint32_t expected_max = 0;
+      bool ok = true;
+      for (size_t i = 0; i < n; i++)
+      {
+        uint32_t index = reference_index(src + 1 + i * size, types[t]);
+        expected_max = index > expected_max ? index : expected_max;
+        ok &= dst32[i] == index;
+        ok &= dst16[i] == (index > 0xFFFF ? 0xFFFF : index);
+      }
+      for (size_t i = n; i < n + ACCESSOR_TEST_GUARD; i++)
+      {
+        ok &= dst16[i] == 0xBEEF && dst32[i] == 0xDEADBEEF;
+      }
+      TEST_CHECK(ok);
+      TEST_CHECK(max16 == expected_max && max32 == expected_max);
+    }
+  }
+
+cleanup:
+  MIUR_FREE(src);
+  MIUR_FREE(dst16);
+  MIUR_FREE(dst32);
+}
+
+static uint32_t reference_index(const uint8_t *p, ComponentType type)
+{
+  switch (type)
+  {
+  case COMPONENT_U8:
+    return p[0];
+  case COMPONENT_U16:
+    return (uint32_t) p[0] | (uint32_t) p[1] << 8;
+  default:
+    return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 |
+      (uint32_t) p[3] << 24;
+  }
+}
+
+/*
+ * Each vertex is 20 bytes: i16 position at 0, normalized i8 normal at 8,
+ * normalized u16 uv at 12.  Positions are 100 times the grid point with a
+ * random height, so loaded vertices are found by x and z however the
+ * optimizer reorders them.
+ */
+static void check_interleaved(const char *dir, TestRng *rng)
+{
+  enum { GRID = ACCESSOR_TEST_GRID, VERTS = GRID * GRID };
+  const int index_count = (GRID - 1) * (GRID - 1) * 6;
+  size_t vertex_size = (size_t) VERTS * ACCESSOR_TEST_STRIDE;
+  size_t bin_size = vertex_size + ((index_count + 3) & ~3);
+  uint8_t *bin = MIUR_ARR(uint8_t, bin_size);
+  char path[ACCESSOR_TEST_PATH_SIZE], bin_path[ACCESSOR_TEST_PATH_SIZE];
+  char cache[ACCESSOR_TEST_PATH_SIZE + sizeof(MESH_CACHE_EXTENSION)];
+  snprintf(path, sizeof(path), "%s/accessor-test.gltf", dir);
+  snprintf(bin_path, sizeof(bin_path), "%s/accessor-test.bin", dir);
+  snprintf(cache, sizeof(cache), "%s%s", path, MESH_CACHE_EXTENSION);
+  if (!TEST_CHECK(bin != NULL))
+  {
+    return;
+  }
+
+  static const int8_t normals[4][3] = {
+    { 0, 127, 0 }, { 127, 0, 0 }, { 0, 0, -127 }, { -127, 0, 0 },
+  };
+  int16_t heights[VERTS];
+  uint16_t uvs[VERTS][2];
+  for (int v = 0; v < VERTS; v++)
+  {
+    uint8_t *vertex = bin + v * ACCESSOR_TEST_STRIDE;
+    heights[v] = (int16_t) ((int) test_rng_below(rng, 601) - 300);
+    int16_t pos[3] = {
+      (int16_t) (v % GRID * 100), heights[v], (int16_t) (v / GRID * 100),
+    };
+    uvs[v][0] = (uint16_t) test_rng_below(rng, 65536);
+    uvs[v][1] = (uint16_t) test_rng_below(rng, 65536);
+    memcpy(vertex, pos, sizeof(pos));
+    memcpy(vertex + 8, normals[v % 4], 3);
+    memcpy(vertex + 12, uvs[v], sizeof(uvs[v]));
+  }
+  uint8_t *indices = bin + vertex_size;
+  for (int y = 0, n = 0; y + 1 < GRID; y++)
+  {
+    for (int x = 0; x + 1 < GRID; x++)
+    {
+      uint8_t v = (uint8_t) (y * GRID + x);
+      uint8_t quad[6] = {
+        v, (uint8_t) (v + GRID), (uint8_t) (v + 1), (uint8_t) (v + 1),
+        (uint8_t) (v + GRID), (uint8_t) (v + GRID + 1),
+      };
+      memcpy(indices + n, quad, sizeof(quad));
+      n += 6;
+    }
+  }
+
+  StaticModel model;
+  remove(cache);
+  if (TEST_CHECK(write_interleaved(path, bin_path, bin, bin_size)) &&
+      TEST_CHECK(gltf_parse(&model, path)))
+  {
+    if (TEST_CHECK(model.mesh_count == 1 &&
+                   model.meshes[0].vert_count == VERTS &&
+                   model.meshes[0].index_count == (uint32_t) index_count))
+    {
+      const StaticMesh *mesh = &model.meshes[0];
+      bool positions_ok = true, normals_ok = true, uvs_ok = true;
+      for (uint32_t i = 0; i < mesh->vert_count; i++)
+      {
+        const float *pos = &mesh->verts_pos[3 * i];
+        int x = (int) pos[0] / 100, z = (int) pos[2] / 100;
+        if (x < 0 || z < 0 || x >= GRID || z >= GRID ||
+            pos[0] != x * 100.0f || pos[2] != z * 100.0f)
+        {
+          positions_ok = false;
+          continue;
+        }
+        int v = z * GRID + x;
+        positions_ok &= pos[1] == (float) heights[v];
+        const float *norm = &mesh->verts_norm[3 * i];
+        for (int c = 0; c < 3; c++)
+        {
+          normals_ok &= norm[c] == normals[v % 4][c] / 127.0f;
+        }
+        const float *uv = &mesh->verts_uv[2 * i];
+        for (int c = 0; c < 2; c++)
+        {
+          uvs_ok &= fabsf(uv[c] - uvs[v][c] / 65535.0f) < 1e-6f;
+        }
+      }
+      TEST_CHECK(positions_ok);
+      TEST_CHECK(normals_ok);
+      TEST_CHECK(uvs_ok);
+    }
+    gltf_model_destroy(&model);
+  }
+
+  remove(path);
+  remove(bin_path);
+  remove(cache);
+  MIUR_FREE(bin);
+}
+
+static bool write_interleaved(const char *path, const char *bin_path,
+                              uint8_t *bin, size_t bin_size)
+{
+  const int verts = ACCESSOR_TEST_GRID * ACCESSOR_TEST_GRID;
+  const int index_count = (ACCESSOR_TEST_GRID - 1) *
+    (ACCESSOR_TEST_GRID - 1) * 6;
+  const int vertex_size = verts * ACCESSOR_TEST_STRIDE;
+  const char *name = strrchr(bin_path, '/');
+  char json[2048];
+  int size = snprintf(
+    json, sizeof(json),
+    "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,"
+    "\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+    "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,"
+    "\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3}]}],"
+    "\"accessors\":["
+    "{\"bufferView\":0,\"byteOffset\":0,\"componentType\":5122,"
+    "\"count\":%d,\"type\":\"VEC3\",\"min\":[0,-300,0],"
+    "\"max\":[%d,300,%d]},"
+    "{\"bufferView\":0,\"byteOffset\":8,\"componentType\":5120,"
+    "\"normalized\":true,\"count\":%d,\"type\":\"VEC3\"},"
+    "{\"bufferView\":0,\"byteOffset\":12,\"componentType\":5123,"
+    "\"normalized\":true,\"count\":%d,\"type\":\"VEC2\"},"
+    "{\"bufferView\":1,\"componentType\":5121,\"count\":%d,"
+    "\"type\":\"SCALAR\"}],"
+    "\"bufferViews\":["
+    "{\"buffer\":0,\"byteLength\":%d,\"byteStride\":%d},"
+    "{\"buffer\":0,\"byteOffset\":%d,\"byteLength\":%d}],"
+    "\"buffers\":[{\"uri\":\"%s\",\"byteLength\":%zu}]}",
+    verts, (ACCESSOR_TEST_GRID - 1) * 100, (ACCESSOR_TEST_GRID - 1) * 100,
+    verts, verts, index_count, vertex_size, ACCESSOR_TEST_STRIDE,
+    vertex_size, index_count, name != NULL ? name + 1 : bin_path, bin_size);
+  if (size <= 0 || (size_t) size >= sizeof(json))
+  {
+    return false;
+  }
+
+  Membuf json_file = { (const uint8_t *) json, (size_t) size, MEMBUF_VIEW };
+  Membuf bin_file = { bin, bin_size, MEMBUF_VIEW };
+  return membuf_write_file(json_file, path) &&
+    membuf_write_file(bin_file, bin_path);
+}
@@ -0,0 +1,209 @@
+/* =====================
+ * tests/accessor_bench.c
+ * 10/18/2026
+ * Measures accessor decoding throughput against a scalar loop.
+ * ====================
+ */
+
+/*
+ * Each case decodes a million three component elements with
+ * convert_to_float, once tightly packed and once interleaved at a 32 byte
+ * stride the way most exported vertex buffers are, and the same with a
+ * plain loop reading one component at a time.  Throughput counts the
+ * accessor's own bytes, not the whole stride, and the last float written is
+ * kept so neither side can be optimized away.
+ */
+
+#include <string.h>
+
+#include <miur/convert.h>
+#include <miur/mem.h>
+
+#include "test.h"
+
+#define ACCESSOR_BENCH_COUNT (1 << 20)
+#define ACCESSOR_BENCH_COMPONENTS 3
+#define ACCESSOR_BENCH_STRIDE 32
+#define ACCESSOR_BENCH_RUNS 9
+#define ACCESSOR_BENCH_SEED 0x6163636262656E63ULL
+
+typedef struct
+{
+  const uint8_t *src;
+  float *dst;
+  size_t stride;
+  ComponentType type;
+  bool normalized;
+} AccessorBench;
+
+/* === PROTOTYPES === */
+
+static void bench_case(AccessorBench *bench, const char *name);
+static void bench_convert(void *ud);
+static void bench_scalar(void *ud);
+static float scalar_component(const uint8_t *p, ComponentType type,
+                              bool normalized);
+
+/* === GLOBALS === */
+
+static const struct
+{
+  const char *name;
+  ComponentType type;
+  bool normalized;
+} bench_types[] = {
+  { "i8 norm", COMPONENT_I8, true },
+  { "u8 norm", COMPONENT_U8, true },
+  { "i16", COMPONENT_I16, false },
+  { "i16 norm", COMPONENT_I16, true },
+  { "u16 norm", COMPONENT_U16, true },
+  { "u32", COMPONENT_U32, false },
+  { "float", COMPONENT_FLOAT, false },
+};
+
+/* Keeps the results alive. */
+static volatile float bench_sink;
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(void)
+{
+  size_t src_size = (size_t) ACCESSOR_BENCH_COUNT * ACCESSOR_BENCH_STRIDE;
+  uint8_t *src = MIUR_ARR_UNINIT(uint8_t, src_size);
+  float *dst = MIUR_ARR(float, ACCESSOR_BENCH_COUNT *
+                        ACCESSOR_BENCH_COMPONENTS);
+  if (!TEST_CHECK(src != NULL && dst != NULL))
+  {
+    MIUR_FREE(src);
+    MIUR_FREE(dst);
+    return test_result();
+  }
+
+  TestRng rng = test_rng(ACCESSOR_BENCH_SEED);
+  char name[64];
+  for (size_t t = 0; t < sizeof(bench_types) / sizeof(bench_types[0]); t++)
+  {
+    /* Floats get real values, random bits would be full of NaNs. */
+    for (size_t i = 0; i + 4 <= src_size; i += 4)
+    {
+      uint32_t bits = (uint32_t) test_rng_next(&rng);
+      if (bench_types[t].type == COMPONENT_FLOAT)
+      {
+        float value = test_rng_float(&rng, -100.0f, 100.0f);
+        memcpy(&bits, &value, sizeof(float));
+      }
+      memcpy(src + i, &bits, sizeof(bits));
+    }
+
+    AccessorBench bench = {
+      .src = src,
+      .dst = dst,
+      .type = bench_types[t].type,
+      .normalized = bench_types[t].normalized,
+    };
+    size_t elem_size = component_size(bench.type) * ACCESSOR_BENCH_COMPONENTS;
+    for (int interleaved = 0; interleaved < 2; interleaved++)
+    {
+      bench.stride = interleaved ? ACCESSOR_BENCH_STRIDE : elem_size;
+      snprintf(name, sizeof(name), "  %s %s", bench_types[t].name,
+               interleaved ? "interleaved" : "packed");
+      bench_case(&bench, name);
+    }
+  }
+
+  MIUR_FREE(src);
+  MIUR_FREE(dst);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void bench_case(AccessorBench *bench, const char *name)
+{
+  uint64_t bytes = (uint64_t) ACCESSOR_BENCH_COUNT *
+    ACCESSOR_BENCH_COMPONENTS * component_size(bench->type);
+  char line[80];
+  uint64_t convert = test_bench_best_ns(bench_convert, bench,
+                                        ACCESSOR_BENCH_RUNS);
+  snprintf(line, sizeof(line), "%s convert", name);
+  test_bench_report(line, bytes, convert);
+  uint64_t scalar = test_bench_best_ns(bench_scalar, bench,
+                                       ACCESSOR_BENCH_RUNS);
+  snprintf(line, sizeof(line), "%s scalar", name);
+  test_bench_report(line, bytes, scalar);
+}
+
+static void bench_convert(void *ud)
+{
+  AccessorBench *bench = ud;
+  convert_to_float(bench->dst, bench->src, bench->stride,
+                   ACCESSOR_BENCH_COUNT, ACCESSOR_BENCH_COMPONENTS,
+                   bench->type, bench->normalized);
+  bench_sink = bench->dst[ACCESSOR_BENCH_COUNT - 1];
+}
+
+static void bench_scalar(void *ud)
+{
+  AccessorBench *bench = ud;
+  size_t size = component_size(bench->type);
+  for (size_t e = 0; e < ACCESSOR_BENCH_COUNT; e++)
+  {
+    const uint8_t *elem = bench->src + e * bench->stride;
+    for (size_t c = 0; c < ACCESSOR_BENCH_COMPONENTS; c++)
+    {
+      bench->dst[e * ACCESSOR_BENCH_COMPONENTS + c] =
+        scalar_component(elem + c * size, bench->type, bench->normalized);
+    }
+  }
+  bench_sink = bench->dst[ACCESSOR_BENCH_COUNT - 1];
+}
+
+static float scalar_component(const uint8_t *p, ComponentType type,
+                              bool normalized)
+{
+  float value = 0.0f, max = 1.0f;
+  switch (type)
+  {
+  case COMPONENT_I8:
+    value = (int8_t) p[0];
+    max = 127.0f;
+    break;
+  case COMPONENT_U8:
+    value = p[0];
+    max = 255.0f;
+    break;
+  case COMPONENT_I16:
+  {
+    int16_t v;
+    memcpy(&v, p, sizeof(v));
+    value = v;
+    max = 32767.0f;
+    break;
+  }
+  case COMPONENT_U16:
+  {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    value = v;
+    max = 65535.0f;
+    break;
+  }
+  case COMPONENT_U32:
+  {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    value = (float) v;
+    max = 4294967295.0f;
+    break;
+  }
+  case COMPONENT_FLOAT:
+    memcpy(&value, p, sizeof(float));
+    return value;
+  }
+  if (!normalized)
+  {
+    return value;
+  }
+  value /= max;
+  return value < -1.0f ? -1.0f : value;
+}
@@ -0,0 +1,290 @@
+/* =====================
+ * tests/archive_bench.c
+ * 10/18/2026
+ * Times a cold start from a packed archive against loose files.
+ * ====================
+ */
+
+/*
+ * Generates a few thousand asset sized files in the directory given as the
+ * first argument, or the current one, and packs them into one stored and
+ * one compressed archive.  A start loads every file once: from disk with
+ * membuf_load_file, or by mounting an archive and going through
+ * archive_load_file, with the mount included in the time.  Views returned
+ * from a stored archive have every page touched, so they are actually read
+ * like the heap copies are.  On Linux the cold runs drop the files from the
+ * page cache first, which is close to a first launch without needing to be
+ * root.  Everything is removed again afterwards.
+ */
+
+#include <inttypes.h>
+#include <string.h>
+
+#include <miur/archive.h>
+#include <miur/job.h>
+#include <miur/mem.h>
+#include <miur/membuf.h>
+
+#include "test.h"
+
+#define ARCHIVE_BENCH_COUNT 4000
+#define ARCHIVE_BENCH_MIN_SIZE (1 << 10)
+#define ARCHIVE_BENCH_MAX_SIZE (64 << 10)
+#define ARCHIVE_BENCH_RUNS 3
+#define ARCHIVE_BENCH_SEED 0x7061636B62656E63ULL
+#define ARCHIVE_BENCH_PATH_SIZE 1024
+#define ARCHIVE_BENCH_PAGE 4096
+
+typedef enum
+{
+  ARCHIVE_BENCH_LOOSE,
+  ARCHIVE_BENCH_STORED,
+  ARCHIVE_BENCH_COMPRESSED,
+  ARCHIVE_BENCH_MODE_COUNT,
+} ArchiveBenchMode;
+
+typedef struct
+{
+  char *mount_point;
+  char **paths;
+  size_t *sizes;
+  size_t count;
+  uint64_t total_size;
+  char *archives[ARCHIVE_BENCH_MODE_COUNT];
+} ArchiveBenchSet;
+
+/* === PROTOTYPES === */
+
+static bool create_set(ArchiveBenchSet *set, const char *dir, TestRng *rng);
+static bool pack_set(ArchiveBenchSet *set, ArchiveBenchMode mode);
+static void destroy_set(ArchiveBenchSet *set);
+static uint64_t start_set(ArchiveBenchSet *set, ArchiveBenchMode mode,
+                          bool cold);
+
+/* === GLOBALS === */
+
+static const char *const mode_names[ARCHIVE_BENCH_MODE_COUNT] = {
+  "loose", "packed", "packed lz",
+};
+
+/* Token soup, about as compressible as JSON and shader sources. */
+static const char *const words[] = {
+  "\"accessor\": ", "\"bufferView\": ", "\"byteOffset\": ", "\"count\": ",
+  "\"componentType\": 5126, ", "\"type\": \"VEC3\"", "{ ", " }, ", "\n    ",
+  "vec4 ", "layout(location = ", ") in ", "uniform ", "gl_Position = ",
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(int argc, char **argv)
+{
+  const char *dir = argc > 1 ? argv[1] : ".";
+  TestRng rng = test_rng(ARCHIVE_BENCH_SEED);
+  JobSystem *jobs = job_system_create(0);
+  if (!TEST_CHECK(jobs != NULL))
+  {
+    return test_result();
+  }
+  archive_set_job_system(jobs);
+
+  ArchiveBenchSet set = { 0 };
+  if (TEST_CHECK(create_set(&set, dir, &rng)) &&
+      TEST_CHECK(pack_set(&set, ARCHIVE_BENCH_STORED)) &&
+      TEST_CHECK(pack_set(&set, ARCHIVE_BENCH_COMPRESSED)))
+  {
+    printf("%zu files, %" PRIu64 " MB\n", set.count, set.total_size >> 20);
+    char name[64];
+    for (int mode = 0; mode < ARCHIVE_BENCH_MODE_COUNT; mode++)
+    {
+      for (int cold = 0; cold < 2; cold++)
+      {
+#ifndef __linux__
+        if (cold)
+        {
+          break;
+        }
+#endif
+        uint64_t best = UINT64_MAX;
+        for (int run = 0; run < ARCHIVE_BENCH_RUNS; run++)
+        {
+          uint64_t time = start_set(&set, (ArchiveBenchMode) mode, cold);
+          best = time < best ? time : best;
+        }
+        snprintf(name, sizeof(name), "  %s %s", mode_names[mode],
+                 cold ? "cold" : "warm");
+        test_bench_report(name, set.total_size, best);
+      }
+    }
+  }
+  destroy_set(&set);
+
+  archive_set_job_system(NULL);
+  job_system_destroy(jobs);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static bool create_set(ArchiveBenchSet *set, const char *dir, TestRng *rng)
+{
+  set->mount_point = MIUR_ARR(char, ARCHIVE_BENCH_PATH_SIZE);
+  set->paths = MIUR_ARR(char *, ARCHIVE_BENCH_COUNT);
+  set->sizes = MIUR_ARR(size_t, ARCHIVE_BENCH_COUNT);
+  uint8_t *data = MIUR_ARR(uint8_t, ARCHIVE_BENCH_MAX_SIZE);
+  if (set->mount_point == NULL || set->paths == NULL || set->sizes == NULL ||
+      data == NULL)
+  {
+    MIUR_FREE(data);
+    return false;
+  }
+  snprintf(set->mount_point, ARCHIVE_BENCH_PATH_SIZE, "%s/", dir);
+
+  bool ok = true;
+  for (size_t i = 0; i < ARCHIVE_BENCH_COUNT && ok; i++)
+  {
+    set->paths[i] = MIUR_ARR(char, ARCHIVE_BENCH_PATH_SIZE);
+    if (set->paths[i] == NULL)
+    {
+      ok = false;
+      break;
+    }
+    snprintf(set->paths[i], ARCHIVE_BENCH_PATH_SIZE,
+             "%sarchive-bench-%05zu.bin", set->mount_point, i);
+    size_t size = ARCHIVE_BENCH_MIN_SIZE +
+      test_rng_below(rng, ARCHIVE_BENCH_MAX_SIZE - ARCHIVE_BENCH_MIN_SIZE +
+                     1);
+    for (size_t filled = 0; filled < size;)
+    {
+      const char *word = words[test_rng_below(rng, sizeof(words) /
+                                              sizeof(words[0]))];
+      size_t word_len = strlen(word);
+      word_len = word_len < size - filled ? word_len : size - filled;
+      memcpy(data + filled, word, word_len);
+      filled += word_len;
+    }
+    set->sizes[i] = size;
+    set->count++;
+    set->total_size += size;
+
+    Membuf file = {
+      .data = data,
+      .size = size,
+      .kind = MEMBUF_VIEW,
+    };
+    ok = membuf_write_file(file, set->paths[i]);
+  }
+
+  MIUR_FREE(data);
+  return ok;
+}
+
+static bool pack_set(ArchiveBenchSet *set, ArchiveBenchMode mode)
+{
+  set->archives[mode] = MIUR_ARR(char, ARCHIVE_BENCH_PATH_SIZE);
+  ArchiveInput *inputs = MIUR_ARR(ArchiveInput, set->count);
+  if (set->archives[mode] == NULL || inputs == NULL)
+  {
+    MIUR_FREE(inputs);
+    return false;
+  }
+  snprintf(set->archives[mode], ARCHIVE_BENCH_PATH_SIZE,
+           "%sarchive-bench-%d.pak", set->mount_point, (int) mode);
+
+  size_t prefix_len = strlen(set->mount_point);
+  size_t loaded = 0;
+  bool ok = true;
+  for (; loaded < set->count && ok; loaded++)
+  {
+    inputs[loaded].name = set->paths[loaded] + prefix_len;
+    inputs[loaded].compress = mode == ARCHIVE_BENCH_COMPRESSED;
+    ok = membuf_map_file(&inputs[loaded].data, set->paths[loaded],
+                         MEMBUF_MAP_SEQUENTIAL);
+  }
+  if (ok)
+  {
+    ok = archive_write(set->archives[mode], inputs, set->count);
+  }
+  else
+  {
+    loaded--;
+  }
+
+  for (size_t i = 0; i < loaded; i++)
+  {
+    membuf_destroy(&inputs[i].data);
+  }
+  MIUR_FREE(inputs);
+  return ok;
+}
+
+static void destroy_set(ArchiveBenchSet *set)
+{
+  for (size_t i = 0; i < set->count; i++)
+  {
+    remove(set->paths[i]);
+    MIUR_FREE(set->paths[i]);
+  }
+  for (int mode = 0; mode < ARCHIVE_BENCH_MODE_COUNT; mode++)
+  {
+    if (set->archives[mode] != NULL)
+    {
+      remove(set->archives[mode]);
+      MIUR_FREE(set->archives[mode]);
+    }
+  }
+  MIUR_FREE(set->mount_point);
+  MIUR_FREE(set->paths);
+  MIUR_FREE(set->sizes);
+  memset(set, 0, sizeof(ArchiveBenchSet));
+}
+
+/* Returns the time taken, checking every file arrived in full. */
+static uint64_t start_set(ArchiveBenchSet *set, ArchiveBenchMode mode,
+                          bool cold)
+{
+  if (cold)
+  {
+    if (mode == ARCHIVE_BENCH_LOOSE)
+    {
+      for (size_t i = 0; i < set->count; i++)
+      {
+        test_drop_cached(set->paths[i]);
+      }
+    }
+    else
+    {
+      test_drop_cached(set->archives[mode]);
+    }
+  }
+
+  uint64_t bytes = 0, sum = 0;
+  uint64_t start = thread_time_ns();
+  if (mode != ARCHIVE_BENCH_LOOSE &&
+      !TEST_CHECK(archive_mount(set->archives[mode], set->mount_point)))
+  {
+    return 0;
+  }
+  for (size_t i = 0; i < set->count; i++)
+  {
+    Membuf file;
+    bool loaded = mode == ARCHIVE_BENCH_LOOSE ?
+      membuf_load_file(&file, set->paths[i]) :
+      archive_load_file(&file, set->paths[i]);
+    if (!loaded)
+    {
+      continue;
+    }
+    for (size_t offset = 0; offset < file.size; offset += ARCHIVE_BENCH_PAGE)
+    {
+      sum += file.data[offset];
+    }
+    bytes += file.size == set->sizes[i] ? file.size : 0;
+    TEST_CHECK(mode != ARCHIVE_BENCH_STORED || file.kind == MEMBUF_VIEW);
+    membuf_destroy(&file);
+  }
+  archive_unmount_all();
+  uint64_t time = thread_time_ns() - start;
+
+  TEST_CHECK(bytes == set->total_size && sum > 0);
+  return time;
+}
@@ -0,0 +1,342 @@
+/* =====================
+ * tests/asset_db.c
+ * 10/18/2026
+ * Checks that the asset database keeps what was recorded across saves.
+ * ====================
+ */
+
+/*
+ * A thousand artifacts with random dependencies are recorded, a fifth of
+ * them recorded over, and the database saved and reopened.  Every entry has
+ * to come back as last recorded, from the heap before saving, from the
+ * mapping after reopening, and from the heap again once the mapped
+ * database is changed.  The strings have to be compacted to exactly the
+ * live names and dependencies.  Damaged files have to open empty rather
+ * than be trusted, and file hashes have to be the content's hash3 whether
+ * or not they're hashed on jobs.
+ */
+
+#include <string.h>
+
+#include <miur/asset_db.h>
+#include <miur/hash.h>
+#include <miur/job.h>
+#include <miur/mem.h>
+#include <miur/membuf.h>
+
+#include "test.h"
+
+#define ASSET_DB_TEST_SEED 0x6173736574ULL
+#define ASSET_DB_TEST_ENTRIES 1000
+#define ASSET_DB_TEST_DEPS 4
+#define ASSET_DB_TEST_NAME_SIZE 48
+#define ASSET_DB_TEST_PATH_SIZE 1024
+#define ASSET_DB_TEST_FILES 4
+
+typedef struct
+{
+  char name[ASSET_DB_TEST_NAME_SIZE];
+  char deps[ASSET_DB_TEST_DEPS][ASSET_DB_TEST_NAME_SIZE];
+  const char *dep_ptrs[ASSET_DB_TEST_DEPS];
+  uint32_t dep_count;
+  uint64_t input_hash;
+  uint32_t cook_time_us;
+} ExpectedEntry;
+
+/* === PROTOTYPES === */
+
+static void check_round_trip(const char *path, TestRng *rng);
+static void random_entry(ExpectedEntry *entry, uint32_t index, TestRng *rng);
+static bool record(AssetDb *db, const ExpectedEntry *entry);
+static void check_entries(const AssetDb *db, const ExpectedEntry *expected,
+                          uint32_t count);
+static void check_damaged(const char *path);
+static bool opens_empty(const char *path, const uint8_t *data, size_t size);
+static void check_hash_files(const char *dir, TestRng *rng);
+static void check_input_hash(void);
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(int argc, char **argv)
+{
+  const char *dir = argc > 1 ? argv[1] : ".";
+  TestRng rng = test_rng(ASSET_DB_TEST_SEED);
+  char path[ASSET_DB_TEST_PATH_SIZE];
+  snprintf(path, sizeof(path), "%s/asset-db-test%s", dir,
+           ASSET_DB_EXTENSION);
+
+  remove(path);
+  check_round_trip(path, &rng);
+  check_damaged(path);
+  remove(path);
+  check_hash_files(dir, &rng);
+  check_input_hash();
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void check_round_trip(const char *path, TestRng *rng)
+{
+  ExpectedEntry *expected = MIUR_ARR(ExpectedEntry, ASSET_DB_TEST_ENTRIES);
+  AssetDb db;
+  if (!TEST_CHECK(expected != NULL) || !TEST_CHECK(asset_db_open(&db, path)))
+  {
+    MIUR_FREE(expected);
+    return;
+  }
+
+  /* Missing opens empty, and saving nothing writes nothing. */
+  TEST_CHECK(db.count == 0);
+  TEST_CHECK(asset_db_find(&db, "missing.gltf") == NULL);
+  TEST_CHECK(asset_db_save(&db));
+  Membuf file;
+  TEST_CHECK(!membuf_map_file(&file, path, 0));
+
+  bool recorded = true;
+  for (uint32_t i = 0; i < ASSET_DB_TEST_ENTRIES; i++)
+  {
+    random_entry(&expected[i], i, rng);
+    recorded &= record(&db, &expected[i]);
+  }
+  for (uint32_t i = 0; i < ASSET_DB_TEST_ENTRIES / 5; i++)
+  {
+    uint32_t index = test_rng_below(rng, ASSET_DB_TEST_ENTRIES);
+    random_entry(&expected[index], index, rng);
+    recorded &= record(&db, &expected[index]);
+  }
+  if (!TEST_CHECK(recorded))
+  {
+    goto cleanup;
+  }
+  check_entries(&db, expected, ASSET_DB_TEST_ENTRIES);
+
+  /* Only the live strings are written. */
+  uint32_t strings_size = 0;
+  for (uint32_t i = 0; i < ASSET_DB_TEST_ENTRIES; i++)
+  {
+    strings_size += (uint32_t) strlen(expected[i].name) + 1;
+    for (uint32_t d = 0; d < expected[i].dep_count; d++)
+    {
+      strings_size += (uint32_t) strlen(expected[i].deps[d]) + 1;
+    }
+  }
+  TEST_CHECK(asset_db_save(&db));
+  TEST_CHECK(!db.dirty);
+  asset_db_close(&db);
+
+  if (!TEST_CHECK(asset_db_open(&db, path)))
+  {
+    goto cleanup;
+  }
+  TEST_CHECK(!db.owned && db.file.kind == MEMBUF_MAPPED);
+  TEST_CHECK(db.strings_size == strings_size);
+  check_entries(&db, expected, ASSET_DB_TEST_ENTRIES);
+
+  /* The first change copies the mapping. */
+  random_entry(&expected[0], 0, rng);
+  TEST_CHECK(record(&db, &expected[0]));
+  TEST_CHECK(db.owned);
+  check_entries(&db, expected, ASSET_DB_TEST_ENTRIES);
+  TEST_CHECK(asset_db_save(&db));
+  asset_db_close(&db);
+
+  if (TEST_CHECK(asset_db_open(&db, path)))
+  {
+    check_entries(&db, expected, ASSET_DB_TEST_ENTRIES);
+    asset_db_close(&db);
+  }
+
+cleanup:
+  MIUR_FREE(expected);
+}
+
+/* Names are unique by index, dependencies are shared between entries. */
+static void random_entry(ExpectedEntry *entry, uint32_t index, TestRng *rng)
+{
+  snprintf(entry->name, sizeof(entry->name), "models/%u/model.gltf", index);
+  entry->dep_count = test_rng_below(rng, ASSET_DB_TEST_DEPS + 1);
+  for (uint32_t d = 0; d < entry->dep_count; d++)
+  {
+    snprintf(entry->deps[d], sizeof(entry->deps[d]), "buffers/%u.bin",
+             test_rng_below(rng, 100));
+    entry->dep_ptrs[d] = entry->deps[d];
+  }
+  entry->input_hash = test_rng_next(rng);
+  entry->cook_time_us = test_rng_below(rng, 1000000);
+}
+
+static bool record(AssetDb *db, const ExpectedEntry *entry)
+{
+  return asset_db_record(db, entry->name, entry->input_hash,
+                         entry->dep_ptrs, entry->dep_count,
+                         entry->cook_time_us);
+}
+
+static void check_entries(const AssetDb *db, const ExpectedEntry *expected,
+                          uint32_t count)
+{
+  bool found_ok = true, fields_ok = true, deps_ok = true;
+  TEST_CHECK(db->count == count);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    const ExpectedEntry *want = &expected[i];
+    const AssetDbEntry *entry = asset_db_find(db, want->name);
+    if (entry == NULL)
+    {
+      found_ok = false;
+      continue;
+    }
+    fields_ok &= strcmp(asset_db_entry_name(db, entry), want->name) == 0 &&
+      entry->input_hash == want->input_hash &&
+      entry->cook_time_us == want->cook_time_us &&
+      entry->dependency_count == want->dep_count;
+
+    const char *dep = NULL;
+    for (uint32_t d = 0; d < want->dep_count; d++)
+    {
+      dep = asset_db_next_dependency(db, entry, dep);
+      deps_ok &= dep != NULL && strcmp(dep, want->deps[d]) == 0;
+      if (dep == NULL)
+      {
+        break;
+      }
+    }
+    deps_ok &= asset_db_next_dependency(db, entry, dep) == NULL;
+  }
+  TEST_CHECK(found_ok);
+  TEST_CHECK(fields_ok);
+  TEST_CHECK(deps_ok);
+  TEST_CHECK(asset_db_find(db, "models/model.gltf") == NULL);
+}
+
+/*
+ * Truncated, another version, and a name that no longer matches its key,
+ * each of which would send lookups outside the file or to the wrong entry.
+ */
+static void check_damaged(const char *path)
+{
+  Membuf file;
+  if (!TEST_CHECK(membuf_load_file(&file, path)))
+  {
+    return;
+  }
+  size_t size = file.size;
+  uint8_t *data = MIUR_ARR_UNINIT(uint8_t, size);
+  if (!TEST_CHECK(data != NULL))
+  {
+    membuf_destroy(&file);
+    return;
+  }
+  const AssetDbHeader *header = (const AssetDbHeader *) file.data;
+
+  memcpy(data, file.data, size);
+  TEST_CHECK(opens_empty(path, data, size / 2));
+  TEST_CHECK(opens_empty(path, data, sizeof(AssetDbHeader) - 1));
+
+  ((AssetDbHeader *) data)->version = ASSET_DB_VERSION + 1;
+  TEST_CHECK(opens_empty(path, data, size));
+
+  memcpy(data, file.data, size);
+  data[header->strings_offset] ^= 1;
+  TEST_CHECK(opens_empty(path, data, size));
+
+  memcpy(data, file.data, size);
+  data[size - 1] = 'x';
+  TEST_CHECK(opens_empty(path, data, size));
+
+  MIUR_FREE(data);
+  membuf_destroy(&file);
+}
+
+static bool opens_empty(const char *path, const uint8_t *data, size_t size)
+{
+  Membuf file = { .data = data, .size = size, .kind = MEMBUF_VIEW };
+  AssetDb db;
+  if (!membuf_write_file(file, path) || !asset_db_open(&db, path))
+  {
+    return false;
+  }
+  bool empty = db.count == 0 && db.capacity == 0 &&
+    asset_db_find(&db, "models/0/model.gltf") == NULL;
+  asset_db_close(&db);
+  return empty;
+}
+
+/* The last path doesn't exist, which mustn't stop the others. */
+static void check_hash_files(const char *dir, TestRng *rng)
+{
+  static const size_t sizes[ASSET_DB_TEST_FILES] = { 0, 100, 100000, 0 };
+  char paths[ASSET_DB_TEST_FILES][ASSET_DB_TEST_PATH_SIZE];
+  const char *path_ptrs[ASSET_DB_TEST_FILES];
+  uint64_t expected[ASSET_DB_TEST_FILES] = { 0 };
+  uint64_t hashes[ASSET_DB_TEST_FILES];
+  uint8_t *data = MIUR_ARR_UNINIT(uint8_t, sizes[2]);
+  JobSystem *jobs = job_system_create(2);
+  if (!TEST_CHECK(data != NULL && jobs != NULL))
+  {
+    MIUR_FREE(data);
+    if (jobs != NULL)
+    {
+      job_system_destroy(jobs);
+    }
+    return;
+  }
+  for (size_t i = 0; i < sizes[2]; i++)
+  {
+    data[i] = (uint8_t) test_rng_next(rng);
+  }
+
+  for (int i = 0; i < ASSET_DB_TEST_FILES; i++)
+  {
+    snprintf(paths[i], sizeof(paths[i]), "%s/asset-db-test-%d.bin", dir, i);
+    path_ptrs[i] = paths[i];
+    remove(paths[i]);
+    if (i < ASSET_DB_TEST_FILES - 1)
+    {
+      Membuf file = { .data = data, .size = sizes[i], .kind = MEMBUF_VIEW };
+      TEST_CHECK(membuf_write_file(file, paths[i]));
+      expected[i] = hash3(data, sizes[i], 0);
+    }
+  }
+
+  for (int pass = 0; pass < 2; pass++)
+  {
+    memset(hashes, 0xFF, sizeof(hashes));
+    TEST_CHECK(asset_db_hash_files(pass == 0 ? NULL : jobs, path_ptrs,
+                                   ASSET_DB_TEST_FILES - 1, hashes));
+    TEST_CHECK(memcmp(hashes, expected,
+                      sizeof(uint64_t) * (ASSET_DB_TEST_FILES - 1)) == 0);
+
+    memset(hashes, 0xFF, sizeof(hashes));
+    TEST_CHECK(!asset_db_hash_files(pass == 0 ? NULL : jobs, path_ptrs,
+                                    ASSET_DB_TEST_FILES, hashes));
+    TEST_CHECK(memcmp(hashes, expected, sizeof(hashes)) == 0);
+  }
+
+  for (int i = 0; i < ASSET_DB_TEST_FILES; i++)
+  {
+    remove(paths[i]);
+  }
+  job_system_destroy(jobs);
+  MIUR_FREE(data);
+}
+
+/* Any change to a path, a hash, their order or the seed is a new input. */
+static void check_input_hash(void)
+{
+  const char *paths[2] = { "scene.gltf", "scene.bin" };
+  const char *renamed[2] = { "scene.gltf", "scene2.bin" };
+  const char *swapped[2] = { "scene.bin", "scene.gltf" };
+  const uint64_t hashes[2] = { 1, 2 };
+  const uint64_t changed[2] = { 1, 3 };
+  const uint64_t swapped_hashes[2] = { 2, 1 };
+
+  uint64_t hash = asset_db_input_hash(paths, hashes, 2, 0);
+  TEST_CHECK(hash == asset_db_input_hash(paths, hashes, 2, 0));
+  TEST_CHECK(hash != asset_db_input_hash(paths, hashes, 2, 1));
+  TEST_CHECK(hash != asset_db_input_hash(paths, hashes, 1, 0));
+  TEST_CHECK(hash != asset_db_input_hash(renamed, hashes, 2, 0));
+  TEST_CHECK(hash != asset_db_input_hash(paths, changed, 2, 0));
+  TEST_CHECK(hash != asset_db_input_hash(swapped, swapped_hashes, 2, 0));
+}
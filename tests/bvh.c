@@ -0,0 +1,437 @@
+/* =====================
+ * tests/bvh.c
+ * 10/18/2026
+ * Checks BVH queries against testing every item.
+ * ====================
+ */
+
+/*
+ * Random boxes of very different sizes, some of them points and a few
+ * hundred exact duplicates, are built into a BVH on this thread and on the
+ * job system.  Every node has to bound its children or items, every item
+ * has to be in exactly one leaf, and box, frustum and ray queries have to
+ * find what testing every item does.  Then some items move and are refit
+ * one by one, then all of them at once, and the queries are checked again.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <miur/bvh.h>
+#include <miur/job.h>
+#include <miur/mem.h>
+
+#include "test.h"
+
+#define BVH_TEST_SEED 0x6276687465737431ULL
+#define BVH_TEST_ITEMS 50000
+#define BVH_TEST_DUPLICATES 500
+#define BVH_TEST_WORLD 1000.0f
+#define BVH_TEST_QUERIES 200
+#define BVH_TEST_MOVED 2000
+#define BVH_TEST_WORKERS 4
+
+typedef struct
+{
+  const Aabb *bounds;
+  uint32_t *found;
+  uint32_t *expected;
+} BvhTest;
+
+/* === PROTOTYPES === */
+
+static void check_bvh(const Bvh *bvh, BvhTest *test, TestRng *rng);
+static void check_structure(const Bvh *bvh, const Aabb *bounds);
+static bool contains(const float *min, const float *max, const Aabb *box);
+static void check_aabb_queries(const Bvh *bvh, BvhTest *test, TestRng *rng);
+static void check_frustum_queries(const Bvh *bvh, BvhTest *test,
+                                  TestRng *rng);
+static void check_rays(const Bvh *bvh, BvhTest *test, TestRng *rng);
+static bool same_items(uint32_t *a, uint32_t *b, uint32_t count);
+static int compare_u32(const void *a, const void *b);
+static bool ray_box(const Aabb *box, const float *origin,
+                    const float *inv_dir, float max_t, float *t_out);
+static bool even_items(void *ud, uint32_t item, const float *origin,
+                       const float *dir, float *t_inout);
+static void random_box(Aabb *out, TestRng *rng);
+static void random_direction(float *out, TestRng *rng);
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(void)
+{
+  TestRng rng = test_rng(BVH_TEST_SEED);
+  Aabb *bounds = MIUR_ARR(Aabb, BVH_TEST_ITEMS);
+  BvhTest test = {
+    .bounds = bounds,
+    .found = MIUR_ARR(uint32_t, BVH_TEST_ITEMS),
+    .expected = MIUR_ARR(uint32_t, BVH_TEST_ITEMS),
+  };
+  JobSystem *jobs = job_system_create(BVH_TEST_WORKERS);
+  if (!TEST_CHECK(bounds != NULL && test.found != NULL &&
+                  test.expected != NULL && jobs != NULL))
+  {
+    goto cleanup;
+  }
+
+  for (uint32_t i = 0; i < BVH_TEST_ITEMS; i++)
+  {
+    random_box(&bounds[i], &rng);
+  }
+  /* All in one place, so no centroid split can separate them. */
+  for (uint32_t i = 0; i < BVH_TEST_DUPLICATES; i++)
+  {
+    bounds[i * 7] = bounds[0];
+  }
+
+  Bvh bvh;
+  for (int threaded = 0; threaded < 2; threaded++)
+  {
+    if (!TEST_CHECK(bvh_build(&bvh, bounds, BVH_TEST_ITEMS,
+                              threaded ? jobs : NULL)))
+    {
+      continue;
+    }
+    check_bvh(&bvh, &test, &rng);
+    bvh_destroy(&bvh);
+  }
+
+  if (TEST_CHECK(bvh_build(&bvh, bounds, BVH_TEST_ITEMS, jobs)))
+  {
+    uint32_t moved[BVH_TEST_MOVED];
+    for (uint32_t i = 0; i < BVH_TEST_MOVED; i++)
+    {
+      moved[i] = (uint32_t) test_rng_below(&rng, BVH_TEST_ITEMS);
+      random_box(&bounds[moved[i]], &rng);
+    }
+    bvh_refit_items(&bvh, bounds, moved, BVH_TEST_MOVED);
+    check_bvh(&bvh, &test, &rng);
+
+    for (uint32_t i = 0; i < BVH_TEST_ITEMS; i++)
+    {
+      random_box(&bounds[i], &rng);
+    }
+    bvh_refit(&bvh, bounds);
+    check_bvh(&bvh, &test, &rng);
+    bvh_destroy(&bvh);
+  }
+
+  /* Nothing to build, nothing to find. */
+  if (TEST_CHECK(bvh_build(&bvh, bounds, 0, NULL)))
+  {
+    BvhHit hit;
+    float origin[3] = { 0.0f, 0.0f, 0.0f }, dir[3] = { 1.0f, 0.0f, 0.0f };
+    TEST_CHECK(bvh_query_aabb(&bvh, &bounds[0], test.found, 1) == 0);
+    TEST_CHECK(!bvh_raycast(&bvh, origin, dir, INFINITY, NULL, NULL, &hit));
+    bvh_destroy(&bvh);
+  }
+
+cleanup:
+  if (jobs != NULL)
+  {
+    job_system_destroy(jobs);
+  }
+  MIUR_FREE(bounds);
+  MIUR_FREE(test.found);
+  MIUR_FREE(test.expected);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void check_bvh(const Bvh *bvh, BvhTest *test, TestRng *rng)
+{
+  check_structure(bvh, test->bounds);
+  check_aabb_queries(bvh, test, rng);
+  check_frustum_queries(bvh, test, rng);
+  check_rays(bvh, test, rng);
+}
+
+static void check_structure(const Bvh *bvh, const Aabb *bounds)
+{
+  if (!TEST_CHECK(bvh->item_count == BVH_TEST_ITEMS &&
+                  bvh->node_count > 0 &&
+                  bvh->node_count <= 2 * BVH_TEST_ITEMS - 1))
+  {
+    return;
+  }
+  TEST_CHECK(bvh->parents[0] == BVH_NO_NODE);
+
+  bool nodes_ok = true, items_ok = true;
+  uint8_t *seen = MIUR_ARR(uint8_t, BVH_TEST_ITEMS);
+  if (!TEST_CHECK(seen != NULL))
+  {
+    return;
+  }
+  for (uint32_t n = 0; n < bvh->node_count; n++)
+  {
+    const BvhNode *node = &bvh->nodes[n];
+    if (node->count == 0)
+    {
+      for (uint32_t c = node->first; c < node->first + 2; c++)
+      {
+        const BvhNode *child = &bvh->nodes[c];
+        Aabb box;
+        memcpy(box.min, child->min, sizeof(box.min));
+        memcpy(box.max, child->max, sizeof(box.max));
+        nodes_ok &= c > n && c < bvh->node_count &&
+          bvh->parents[c] == n && contains(node->min, node->max, &box);
+      }
+      continue;
+    }
+    for (uint32_t i = node->first; i < node->first + node->count; i++)
+    {
+      uint32_t item = bvh->items[i];
+      items_ok &= item < BVH_TEST_ITEMS && seen[item]++ == 0 &&
+        bvh->item_slots[item] == i && bvh->item_leaves[item] == n &&
+        memcmp(&bvh->item_bounds[i], &bounds[item], sizeof(Aabb)) == 0 &&
+        contains(node->min, node->max, &bounds[item]);
+    }
+  }
+  for (uint32_t i = 0; i < BVH_TEST_ITEMS; i++)
+  {
+    items_ok &= seen[i] == 1;
+  }
+  TEST_CHECK(nodes_ok);
+  TEST_CHECK(items_ok);
+  MIUR_FREE(seen);
+}
+
+static bool contains(const float *min, const float *max, const Aabb *box)
+{
+  for (int c = 0; c < 3; c++)
+  {
+    if (box->min[c] < min[c] || box->max[c] > max[c])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Touching counts as overlapping, as in bvh.c. */
+static void check_aabb_queries(const Bvh *bvh, BvhTest *test, TestRng *rng)
+{
+  bool ok = true;
+  for (int q = 0; q < BVH_TEST_QUERIES; q++)
+  {
+    Aabb box;
+    random_box(&box, rng);
+    /* Some queries are one of the items exactly. */
+    if (q % 4 == 0)
+    {
+      box = test->bounds[test_rng_below(rng, BVH_TEST_ITEMS)];
+    }
+
+    uint32_t expected = 0;
+    for (uint32_t i = 0; i < BVH_TEST_ITEMS; i++)
+    {
+      const Aabb *item = &test->bounds[i];
+      bool hit = true;
+      for (int c = 0; c < 3; c++)
+      {
+        hit = hit && item->min[c] <= box.max[c] && item->max[c] >= box.min[c];
+      }
+      if (hit)
+      {
+        test->expected[expected++] = i;
+      }
+    }
+    uint32_t found = bvh_query_aabb(bvh, &box, test->found, BVH_TEST_ITEMS);
+    ok &= found == expected && same_items(test->found, test->expected, found);
+    /* A short buffer still gets the full count. */
+    ok &= bvh_query_aabb(bvh, &box, test->found, 1) == expected;
+  }
+  TEST_CHECK(ok);
+}
+
+/*
+ * Planes facing a random center, so the inside is a random convex region
+ * around it.  An item is in when its corner furthest along each plane's
+ * normal is on the inside.
+ */
+static void check_frustum_queries(const Bvh *bvh, BvhTest *test,
+                                  TestRng *rng)
+{
+  bool ok = true;
+  for (int q = 0; q < BVH_TEST_QUERIES; q++)
+  {
+    uint32_t plane_count = 1 + (uint32_t) test_rng_below(rng, 6);
+    float planes[6 * 4];
+    float center[3];
+    float radius = test_rng_float(rng, 1.0f, BVH_TEST_WORLD / 4);
+    for (int c = 0; c < 3; c++)
+    {
+      center[c] = test_rng_float(rng, 0.0f, BVH_TEST_WORLD);
+    }
+    for (uint32_t p = 0; p < plane_count; p++)
+    {
+      float *plane = &planes[p * 4];
+      random_direction(plane, rng);
+      plane[3] = radius - (plane[0] * center[0] + plane[1] * center[1] +
+                           plane[2] * center[2]);
+    }
+
+    uint32_t expected = 0;
+    for (uint32_t i = 0; i < BVH_TEST_ITEMS; i++)
+    {
+      const Aabb *item = &test->bounds[i];
+      bool inside = true;
+      for (uint32_t p = 0; p < plane_count && inside; p++)
+      {
+        const float *plane = &planes[p * 4];
+        float far_dist = plane[3];
+        for (int c = 0; c < 3; c++)
+        {
+          far_dist += plane[c] * (plane[c] >= 0.0f ? item->max[c] :
+                                  item->min[c]);
+        }
+        inside = far_dist >= 0.0f;
+      }
+      if (inside)
+      {
+        test->expected[expected++] = i;
+      }
+    }
+    uint32_t found = bvh_query_frustum(bvh, planes, plane_count, test->found,
+                                       BVH_TEST_ITEMS);
+    ok &= found == expected && same_items(test->found, test->expected, found);
+  }
+  TEST_CHECK(ok);
+}
+
+/*
+ * The nearest box entry is compared by distance, ties may pick either
+ * item.  Half the rays only accept even items through the hit callback.
+ */
+static void check_rays(const Bvh *bvh, BvhTest *test, TestRng *rng)
+{
+  bool ok = true;
+  for (int q = 0; q < BVH_TEST_QUERIES; q++)
+  {
+    bool filtered = q % 2 == 1;
+    float origin[3], dir[3], inv_dir[3];
+    for (int c = 0; c < 3; c++)
+    {
+      origin[c] = test_rng_float(rng, -100.0f, BVH_TEST_WORLD + 100.0f);
+    }
+    random_direction(dir, rng);
+    for (int c = 0; c < 3; c++)
+    {
+      inv_dir[c] = 1.0f / dir[c];
+    }
+    float max_t = q % 3 == 0 ? 200.0f : INFINITY;
+
+    bool expected = false;
+    float expected_t = max_t;
+    for (uint32_t i = 0; i < BVH_TEST_ITEMS; i++)
+    {
+      float t;
+      if ((!filtered || i % 2 == 0) &&
+          ray_box(&test->bounds[i], origin, inv_dir, expected_t, &t))
+      {
+        expected = true;
+        expected_t = t;
+      }
+    }
+
+    BvhHit hit;
+    bool found = bvh_raycast(bvh, origin, dir, max_t,
+                             filtered ? even_items : NULL, (void *) test,
+                             &hit);
+    ok &= found == expected;
+    if (found && expected)
+    {
+      float t;
+      ok &= hit.t == expected_t && hit.item < BVH_TEST_ITEMS &&
+        (!filtered || hit.item % 2 == 0) &&
+        ray_box(&test->bounds[hit.item], origin, inv_dir, max_t, &t) &&
+        t == hit.t;
+    }
+  }
+  TEST_CHECK(ok);
+}
+
+/* Sorts both lists and checks they hold the same ids. */
+static bool same_items(uint32_t *a, uint32_t *b, uint32_t count)
+{
+  qsort(a, count, sizeof(uint32_t), compare_u32);
+  qsort(b, count, sizeof(uint32_t), compare_u32);
+  return memcmp(a, b, count * sizeof(uint32_t)) == 0;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+  return (x > y) - (x < y);
+}
+
+/* The slab test bvh.c documents, a ray starting inside enters at 0. */
+static bool ray_box(const Aabb *box, const float *origin,
+                    const float *inv_dir, float max_t, float *t_out)
+{
+  float t_near = 0.0f, t_far = max_t;
+  for (int c = 0; c < 3; c++)
+  {
+    float t0 = (box->min[c] - origin[c]) * inv_dir[c];
+    float t1 = (box->max[c] - origin[c]) * inv_dir[c];
+    float lo = t0 < t1 ? t0 : t1;
+    float hi = t0 < t1 ? t1 : t0;
+    t_near = lo > t_near ? lo : t_near;
+    t_far = hi < t_far ? hi : t_far;
+  }
+  *t_out = t_near;
+  return t_near <= t_far;
+}
+
+/* Takes the box's own entry distance as the exact hit. */
+static bool even_items(void *ud, uint32_t item, const float *origin,
+                       const float *dir, float *t_inout)
+{
+  const BvhTest *test = ud;
+  float inv_dir[3], t;
+  for (int c = 0; c < 3; c++)
+  {
+    inv_dir[c] = 1.0f / dir[c];
+  }
+  if (item % 2 != 0 ||
+      !ray_box(&test->bounds[item], origin, inv_dir, *t_inout, &t))
+  {
+    return false;
+  }
+  *t_inout = t;
+  return true;
+}
+
+/* Mostly small, some points and some spanning a good part of the world. */
+static void random_box(Aabb *out, TestRng *rng)
+{
+  uint64_t kind = test_rng_below(rng, 20);
+  float size = kind == 0 ? 0.0f : kind == 1 ?
+    test_rng_float(rng, 50.0f, 300.0f) : test_rng_float(rng, 0.1f, 10.0f);
+  for (int c = 0; c < 3; c++)
+  {
+    out->min[c] = test_rng_float(rng, 0.0f, BVH_TEST_WORLD);
+    out->max[c] = out->min[c] + size * test_rng_float(rng, 0.0f, 1.0f);
+  }
+}
+
+static void random_direction(float *out, TestRng *rng)
+{
+  float length;
+  do
+  {
+    length = 0.0f;
+    for (int c = 0; c < 3; c++)
+    {
+      out[c] = test_rng_float(rng, -1.0f, 1.0f);
+      length += out[c] * out[c];
+    }
+  } while (length < 0.01f || length > 1.0f);
+  length = 1.0f / sqrtf(length);
+  for (int c = 0; c < 3; c++)
+  {
+    out[c] *= length;
+  }
+}
@@ -0,0 +1,382 @@
+/* =====================
+ * tests/bvh_bench.c
+ * 10/18/2026
+ * Times BVH builds, refits and queries over 100k and 1M instances.
+ * ====================
+ */
+
+/*
+ * Instances are random boxes spread over a world that grows with their
+ * count, so their density stays the same, most small and a few large.  The
+ * build is timed on this thread and on a job system with a worker per CPU,
+ * refits after 1% of the instances moved and after all of them did, then
+ * box, frustum and ray queries against testing every instance, which is
+ * what the renderer would do without the tree.  Query times are per query,
+ * the best of several batches.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <miur/bvh.h>
+#include <miur/job.h>
+#include <miur/mem.h>
+
+#include "test.h"
+
+#define BVH_BENCH_RUNS 3
+#define BVH_BENCH_QUERIES 1000
+#define BVH_BENCH_BRUTE_QUERIES 20
+#define BVH_BENCH_SEED 0x6276686265ULL
+#define BVH_BENCH_OUT_SIZE (1 << 16)
+
+typedef enum
+{
+  BVH_BENCH_AABB,
+  BVH_BENCH_FRUSTUM,
+  BVH_BENCH_RAY,
+  BVH_BENCH_QUERY_COUNT,
+} BvhBenchQuery;
+
+typedef struct
+{
+  Aabb box;
+  float planes[6 * 4];
+  float origin[3];
+  float dir[3];
+  float inv_dir[3];
+} BvhBenchProbe;
+
+/* === PROTOTYPES === */
+
+static void bench_count(uint32_t count, JobSystem *jobs, TestRng *rng);
+static void bench_queries(const Bvh *bvh, const Aabb *bounds,
+                          uint32_t count, float world, TestRng *rng);
+static uint64_t run_bvh(const Bvh *bvh, BvhBenchQuery query,
+                        const BvhBenchProbe *probes, uint32_t probe_count,
+                        uint32_t *out, uint64_t *results);
+static uint64_t run_brute(const Aabb *bounds, uint32_t count,
+                          BvhBenchQuery query, const BvhBenchProbe *probes,
+                          uint32_t probe_count, uint64_t *results);
+static bool brute_hit(const Aabb *item, BvhBenchQuery query,
+                      const BvhBenchProbe *probe, float *t_inout);
+static void random_probe(BvhBenchProbe *out, float world, TestRng *rng);
+static void random_instance(Aabb *out, float world, TestRng *rng);
+
+/* === GLOBALS === */
+
+static const uint32_t bench_counts[] = { 100000, 1000000 };
+
+static const char *const query_names[BVH_BENCH_QUERY_COUNT] = {
+  "aabb", "frustum", "ray",
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(void)
+{
+  TestRng rng = test_rng(BVH_BENCH_SEED);
+  JobSystem *jobs = job_system_create(thread_cpu_count());
+  if (!TEST_CHECK(jobs != NULL))
+  {
+    return test_result();
+  }
+  printf("%u job threads\n", job_system_thread_count(jobs));
+  for (size_t i = 0; i < sizeof(bench_counts) / sizeof(uint32_t); i++)
+  {
+    bench_count(bench_counts[i], jobs, &rng);
+  }
+  job_system_destroy(jobs);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void bench_count(uint32_t count, JobSystem *jobs, TestRng *rng)
+{
+  /* About one instance per 1000 cubic units. */
+  float world = 10.0f * cbrtf((float) count);
+  Aabb *bounds = MIUR_ARR(Aabb, count);
+  uint32_t *moved = MIUR_ARR(uint32_t, count / 100);
+  if (!TEST_CHECK(bounds != NULL && moved != NULL))
+  {
+    goto cleanup;
+  }
+  for (uint32_t i = 0; i < count; i++)
+  {
+    random_instance(&bounds[i], world, rng);
+  }
+  printf("%u instances\n", count);
+
+  Bvh bvh;
+  for (int threaded = 0; threaded < 2; threaded++)
+  {
+    uint64_t best = UINT64_MAX;
+    uint32_t node_count = 0;
+    for (int run = 0; run < BVH_BENCH_RUNS; run++)
+    {
+      uint64_t start = thread_time_ns();
+      bool ok = bvh_build(&bvh, bounds, count, threaded ? jobs : NULL);
+      uint64_t time = thread_time_ns() - start;
+      if (!TEST_CHECK(ok))
+      {
+        goto cleanup;
+      }
+      best = time < best ? time : best;
+      node_count = bvh.node_count;
+      /* The last one on the job system is kept for the rest. */
+      if (run + 1 < BVH_BENCH_RUNS || !threaded)
+      {
+        bvh_destroy(&bvh);
+      }
+    }
+    printf("  %-30s %10.3f ms %10u nodes\n",
+           threaded ? "build jobs" : "build", best / 1e6, node_count);
+  }
+
+  /* Moved a little, as animated instances do between frames. */
+  for (uint32_t i = 0; i < count / 100; i++)
+  {
+    moved[i] = (uint32_t) test_rng_below(rng, count);
+    Aabb *box = &bounds[moved[i]];
+    for (int c = 0; c < 3; c++)
+    {
+      float offset = test_rng_float(rng, -1.0f, 1.0f);
+      box->min[c] += offset;
+      box->max[c] += offset;
+    }
+  }
+  uint64_t start = thread_time_ns();
+  bvh_refit_items(&bvh, bounds, moved, count / 100);
+  printf("  %-30s %10.3f ms\n", "refit 1%", (thread_time_ns() - start) / 1e6);
+  start = thread_time_ns();
+  bvh_refit(&bvh, bounds);
+  printf("  %-30s %10.3f ms\n", "refit all", (thread_time_ns() - start) / 1e6);
+
+  bench_queries(&bvh, bounds, count, world, rng);
+  bvh_destroy(&bvh);
+
+cleanup:
+  MIUR_FREE(bounds);
+  MIUR_FREE(moved);
+}
+
+/*
+ * Both sides answer the same first probes, their result counts, summed,
+ * have to agree.  Rays count hits.
+ */
+static void bench_queries(const Bvh *bvh, const Aabb *bounds,
+                          uint32_t count, float world, TestRng *rng)
+{
+  BvhBenchProbe *probes = MIUR_ARR(BvhBenchProbe, BVH_BENCH_QUERIES);
+  uint32_t *out = MIUR_ARR(uint32_t, BVH_BENCH_OUT_SIZE);
+  if (!TEST_CHECK(probes != NULL && out != NULL))
+  {
+    MIUR_FREE(probes);
+    MIUR_FREE(out);
+    return;
+  }
+  for (uint32_t i = 0; i < BVH_BENCH_QUERIES; i++)
+  {
+    random_probe(&probes[i], world, rng);
+  }
+
+  for (int q = 0; q < BVH_BENCH_QUERY_COUNT; q++)
+  {
+    uint64_t bvh_results = 0, brute_results = 0, tree_check = 0;
+    uint64_t best = UINT64_MAX;
+    for (int run = 0; run < BVH_BENCH_RUNS; run++)
+    {
+      uint64_t time = run_bvh(bvh, (BvhBenchQuery) q, probes,
+                              BVH_BENCH_QUERIES, out, &bvh_results);
+      best = time < best ? time : best;
+    }
+    run_bvh(bvh, (BvhBenchQuery) q, probes, BVH_BENCH_BRUTE_QUERIES, out,
+            &tree_check);
+    uint64_t brute = run_brute(bounds, count, (BvhBenchQuery) q, probes,
+                               BVH_BENCH_BRUTE_QUERIES, &brute_results);
+    TEST_CHECK(tree_check == brute_results);
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s query", query_names[q]);
+    printf("  %-30s %10.3f us %10.3f us brute %8.1fx %8.1f results\n", name,
+           best / 1e3 / BVH_BENCH_QUERIES,
+           brute / 1e3 / BVH_BENCH_BRUTE_QUERIES,
+           (brute / (double) BVH_BENCH_BRUTE_QUERIES) /
+           (best / (double) BVH_BENCH_QUERIES),
+           bvh_results / (double) BVH_BENCH_QUERIES);
+  }
+  MIUR_FREE(probes);
+  MIUR_FREE(out);
+}
+
+static uint64_t run_bvh(const Bvh *bvh, BvhBenchQuery query,
+                        const BvhBenchProbe *probes, uint32_t probe_count,
+                        uint32_t *out, uint64_t *results)
+{
+  uint64_t found = 0;
+  uint64_t start = thread_time_ns();
+  for (uint32_t i = 0; i < probe_count; i++)
+  {
+    const BvhBenchProbe *probe = &probes[i];
+    BvhHit hit;
+    switch (query)
+    {
+    case BVH_BENCH_AABB:
+      found += bvh_query_aabb(bvh, &probe->box, out, BVH_BENCH_OUT_SIZE);
+      break;
+    case BVH_BENCH_FRUSTUM:
+      found += bvh_query_frustum(bvh, probe->planes, 6, out,
+                                 BVH_BENCH_OUT_SIZE);
+      break;
+    default:
+      found += bvh_raycast(bvh, probe->origin, probe->dir, INFINITY, NULL,
+                           NULL, &hit);
+      break;
+    }
+  }
+  uint64_t time = thread_time_ns() - start;
+  *results = found;
+  return time;
+}
+
+static uint64_t run_brute(const Aabb *bounds, uint32_t count,
+                          BvhBenchQuery query, const BvhBenchProbe *probes,
+                          uint32_t probe_count, uint64_t *results)
+{
+  uint64_t found = 0;
+  uint64_t start = thread_time_ns();
+  for (uint32_t i = 0; i < probe_count; i++)
+  {
+    float t = INFINITY;
+    bool any = false;
+    for (uint32_t j = 0; j < count; j++)
+    {
+      bool hit = brute_hit(&bounds[j], query, &probes[i], &t);
+      if (query == BVH_BENCH_RAY)
+      {
+        any |= hit;
+      }
+      else
+      {
+        found += hit;
+      }
+    }
+    found += any;
+  }
+  uint64_t time = thread_time_ns() - start;
+  *results = found;
+  return time;
+}
+
+/* The tests bvh.c makes, a ray's nearest entry so far is in `*t_inout`. */
+static bool brute_hit(const Aabb *item, BvhBenchQuery query,
+                      const BvhBenchProbe *probe, float *t_inout)
+{
+  switch (query)
+  {
+  case BVH_BENCH_AABB:
+    for (int c = 0; c < 3; c++)
+    {
+      if (item->min[c] > probe->box.max[c] || item->max[c] < probe->box.min[c])
+      {
+        return false;
+      }
+    }
+    return true;
+  case BVH_BENCH_FRUSTUM:
+    for (int p = 0; p < 6; p++)
+    {
+      const float *plane = &probe->planes[p * 4];
+      float far_dist = plane[3];
+      for (int c = 0; c < 3; c++)
+      {
+        far_dist += plane[c] * (plane[c] >= 0.0f ? item->max[c] :
+                                item->min[c]);
+      }
+      if (far_dist < 0.0f)
+      {
+        return false;
+      }
+    }
+    return true;
+  default:
+  {
+    float t_near = 0.0f, t_far = *t_inout;
+    for (int c = 0; c < 3; c++)
+    {
+      float t0 = (item->min[c] - probe->origin[c]) * probe->inv_dir[c];
+      float t1 = (item->max[c] - probe->origin[c]) * probe->inv_dir[c];
+      t_near = fmaxf(t_near, fminf(t0, t1));
+      t_far = fminf(t_far, fmaxf(t0, t1));
+    }
+    if (t_near > t_far)
+    {
+      return false;
+    }
+    *t_inout = t_near;
+    return true;
+  }
+  }
+}
+
+/*
+ * A box about ten instances wide, a view frustum a fifth of the world deep
+ * looking along a random axis, and a ray from outside the world.
+ */
+static void random_probe(BvhBenchProbe *out, float world, TestRng *rng)
+{
+  float center[3];
+  for (int c = 0; c < 3; c++)
+  {
+    center[c] = test_rng_float(rng, 0.0f, world);
+    out->box.min[c] = center[c] - 10.0f;
+    out->box.max[c] = center[c] + 10.0f;
+  }
+
+  /* Near and far, then the four sides at 45 degrees. */
+  int axis = (int) test_rng_below(rng, 3);
+  int u = (axis + 1) % 3, v = (axis + 2) % 3;
+  float depth = world / 5.0f;
+  float *plane = out->planes;
+  memset(plane, 0, sizeof(out->planes));
+  plane[axis] = 1.0f;
+  plane[3] = -center[axis];
+  plane += 4;
+  plane[axis] = -1.0f;
+  plane[3] = center[axis] + depth;
+  plane += 4;
+  for (int side = 0; side < 4; side++, plane += 4)
+  {
+    int across = side < 2 ? u : v;
+    float sign = side % 2 == 0 ? 1.0f : -1.0f;
+    plane[axis] = 0.70710678f;
+    plane[across] = sign * 0.70710678f;
+    plane[3] = -(plane[axis] * center[axis] + plane[across] * center[across]);
+  }
+
+  for (int c = 0; c < 3; c++)
+  {
+    out->origin[c] = test_rng_float(rng, -world * 0.1f, 0.0f);
+    out->dir[c] = test_rng_float(rng, 0.2f, 1.0f);
+  }
+  float length = sqrtf(out->dir[0] * out->dir[0] + out->dir[1] * out->dir[1] +
+                       out->dir[2] * out->dir[2]);
+  for (int c = 0; c < 3; c++)
+  {
+    out->dir[c] /= length;
+    out->inv_dir[c] = 1.0f / out->dir[c];
+  }
+}
+
+/* Mostly a few units across, one in a hundred up to 100. */
+static void random_instance(Aabb *out, float world, TestRng *rng)
+{
+  float size = test_rng_below(rng, 100) == 0 ?
+    test_rng_float(rng, 10.0f, 100.0f) : test_rng_float(rng, 0.5f, 4.0f);
+  for (int c = 0; c < 3; c++)
+  {
+    out->min[c] = test_rng_float(rng, 0.0f, world);
+    out->max[c] = out->min[c] + size;
+  }
+}
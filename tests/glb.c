@@ -0,0 +1,197 @@
+/* =====================
+ * tests/glb.c
+ * 10/18/2026
+ * Checks GLB files load the same as .gltf and .bin pairs.
+ * ====================
+ */
+
+/*
+ * A generated model, see gltf_gen.h, is written both ways to the directory
+ * given as the first argument, or the current one.  Every mesh's buffer
+ * views start at a different offset into the GLB's BIN chunk, so each
+ * vertex is checked against the grid it was generated from, then the two
+ * loads are compared.  A GLB cut short must fail to load.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <miur/gltf.h>
+#include <miur/mem.h>
+#include <miur/membuf.h>
+#include <miur/mesh_cache.h>
+
+#include "gltf_gen.h"
+#include "test.h"
+
+#define GLB_TEST_MESHES 3
+#define GLB_TEST_GRID 8
+#define GLB_TEST_SEED 0x676C6274657374ULL
+#define GLB_TEST_PATH_SIZE 1024
+
+typedef struct
+{
+  char gltf[GLB_TEST_PATH_SIZE];
+  char bin[GLB_TEST_PATH_SIZE];
+  char glb[GLB_TEST_PATH_SIZE];
+  char truncated[GLB_TEST_PATH_SIZE];
+} GlbTestPaths;
+
+/* === PROTOTYPES === */
+
+static bool load(StaticModel *model, const char *path);
+static void check_model(const StaticModel *model, const GltfGen *gen);
+static void check_same(const StaticModel *a, const StaticModel *b);
+static bool write_truncated(const char *glb, const char *path);
+static void remove_files(const GlbTestPaths *paths);
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(int argc, char **argv)
+{
+  const char *dir = argc > 1 ? argv[1] : ".";
+  GlbTestPaths paths;
+  snprintf(paths.gltf, GLB_TEST_PATH_SIZE, "%s/glb-test.gltf", dir);
+  snprintf(paths.bin, GLB_TEST_PATH_SIZE, "%s/glb-test.bin", dir);
+  snprintf(paths.glb, GLB_TEST_PATH_SIZE, "%s/glb-test.glb", dir);
+  snprintf(paths.truncated, GLB_TEST_PATH_SIZE, "%s/glb-test-cut.glb", dir);
+  TestRng rng = test_rng(GLB_TEST_SEED);
+  GltfGen gen;
+
+  if (!TEST_CHECK(gltf_gen_create(&gen, GLB_TEST_MESHES, GLB_TEST_GRID,
+                                  &rng)))
+  {
+    return test_result();
+  }
+  if (TEST_CHECK(gltf_gen_write_gltf(&gen, paths.gltf, paths.bin,
+                                     "glb-test.bin")) &&
+      TEST_CHECK(gltf_gen_write_glb(&gen, paths.glb)))
+  {
+    StaticModel from_glb, from_gltf;
+    if (TEST_CHECK(load(&from_glb, paths.glb)))
+    {
+      check_model(&from_glb, &gen);
+      if (TEST_CHECK(load(&from_gltf, paths.gltf)))
+      {
+        check_same(&from_glb, &from_gltf);
+        gltf_model_destroy(&from_gltf);
+      }
+      gltf_model_destroy(&from_glb);
+    }
+
+    StaticModel cut;
+    if (TEST_CHECK(write_truncated(paths.glb, paths.truncated)))
+    {
+      TEST_CHECK(!load(&cut, paths.truncated));
+    }
+  }
+
+  remove_files(&paths);
+  gltf_gen_destroy(&gen);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/* Always parses, a cache left by an earlier run would skip the buffers. */
+static bool load(StaticModel *model, const char *path)
+{
+  char cache[GLB_TEST_PATH_SIZE + sizeof(MESH_CACHE_EXTENSION)];
+  snprintf(cache, sizeof(cache), "%s%s", path, MESH_CACHE_EXTENSION);
+  remove(cache);
+  return gltf_parse(model, path);
+}
+
+/*
+ * Vertices may be reordered when the mesh is optimized, so each is looked
+ * up in its grid by x and z and has to carry that grid point's height.
+ */
+static void check_model(const StaticModel *model, const GltfGen *gen)
+{
+  if (!TEST_CHECK(model->mesh_count == GLB_TEST_MESHES))
+  {
+    return;
+  }
+  const int grid = GLB_TEST_GRID;
+  for (int m = 0; m < GLB_TEST_MESHES; m++)
+  {
+    const StaticMesh *mesh = &model->meshes[m];
+    const float *source = gltf_gen_positions(gen, m);
+    TEST_CHECK(mesh->vert_count == (uint32_t) (grid * grid));
+    TEST_CHECK(mesh->index_count == (uint32_t) gltf_gen_index_count(gen));
+
+    bool positions_ok = true, normals_ok = true, uvs_ok = true;
+    for (uint32_t v = 0; v < mesh->vert_count; v++)
+    {
+      const float *pos = &mesh->verts_pos[3 * v];
+      int x = (int) pos[0], z = (int) pos[2];
+      if (pos[0] != (float) x || pos[2] != (float) z || x < 0 || z < 0 ||
+          x >= grid || z >= grid ||
+          pos[1] != source[3 * (z * grid + x) + 1])
+      {
+        positions_ok = false;
+        continue;
+      }
+      const float *norm = &mesh->verts_norm[3 * v];
+      normals_ok &= norm[0] == 0.0f && norm[1] == 1.0f && norm[2] == 0.0f;
+      const float *uv = &mesh->verts_uv[2 * v];
+      uvs_ok &= fabsf(uv[0] - x / (float) (grid - 1)) < 1e-6f &&
+        fabsf(uv[1] - z / (float) (grid - 1)) < 1e-6f;
+    }
+    TEST_CHECK(positions_ok);
+    TEST_CHECK(normals_ok);
+    TEST_CHECK(uvs_ok);
+  }
+}
+
+static void check_same(const StaticModel *a, const StaticModel *b)
+{
+  if (!TEST_CHECK(a->mesh_count == b->mesh_count &&
+                  a->node_count == b->node_count))
+  {
+    return;
+  }
+  for (uint32_t m = 0; m < a->mesh_count; m++)
+  {
+    const StaticMesh *x = &a->meshes[m], *y = &b->meshes[m];
+    if (!TEST_CHECK(x->vert_count == y->vert_count &&
+                    x->index_count == y->index_count))
+    {
+      continue;
+    }
+    TEST_CHECK(memcmp(x->verts_pos, y->verts_pos,
+                      x->vert_count * 3 * sizeof(float)) == 0);
+    TEST_CHECK(memcmp(x->indices, y->indices,
+                      x->index_count * sizeof(uint32_t)) == 0);
+  }
+  TEST_CHECK(memcmp(a->node_world, b->node_world,
+                    a->node_count * 16 * sizeof(float)) == 0);
+}
+
+/* Keeps the header's length but drops the tail of the BIN chunk. */
+static bool write_truncated(const char *glb, const char *path)
+{
+  Membuf file;
+  if (!membuf_load_file(&file, glb))
+  {
+    return false;
+  }
+  Membuf cut = { file.data, file.size / 2, MEMBUF_VIEW };
+  bool ok = membuf_write_file(cut, path);
+  membuf_destroy(&file);
+  return ok;
+}
+
+static void remove_files(const GlbTestPaths *paths)
+{
+  const char *files[] = {
+    paths->gltf, paths->bin, paths->glb, paths->truncated,
+  };
+  char cache[GLB_TEST_PATH_SIZE + sizeof(MESH_CACHE_EXTENSION)];
+  for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+  {
+    remove(files[i]);
+    snprintf(cache, sizeof(cache), "%s%s", files[i], MESH_CACHE_EXTENSION);
+    remove(cache);
+  }
+}
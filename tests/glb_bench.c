@@ -0,0 +1,145 @@
+/* =====================
+ * tests/glb_bench.c
+ * 10/18/2026
+ * Times loading a model as .gltf and .bin against one .glb.
+ * ====================
+ */
+
+/*
+ * The same generated model, see gltf_gen.h, is written both ways to the
+ * directory given as the first argument, or the current one, and removed
+ * afterwards.  Each is loaded with gltf_parse twice over: cooking, with the
+ * mesh cache removed first, and from the cache the previous load wrote,
+ * which still maps and hashes every source.  Warm runs read from the page
+ * cache, cold ones drop the sources and the mesh cache from it first.
+ */
+
+#include <miur/gltf.h>
+#include <miur/mesh_cache.h>
+
+#include "gltf_gen.h"
+#include "test.h"
+
+#define GLB_BENCH_MESHES 200
+#define GLB_BENCH_GRID 32
+#define GLB_BENCH_RUNS 3
+#define GLB_BENCH_SEED 0x676C6262656E6368ULL
+#define GLB_BENCH_PATH_SIZE 1024
+#define GLB_BENCH_CACHE_SIZE (GLB_BENCH_PATH_SIZE +                            \
+                              sizeof(MESH_CACHE_EXTENSION))
+
+typedef struct
+{
+  const char *name;
+  char path[GLB_BENCH_PATH_SIZE];
+  char bin[GLB_BENCH_PATH_SIZE];       /* Empty for the GLB. */
+  char cache[GLB_BENCH_CACHE_SIZE];
+} GlbBenchFile;
+
+/* === PROTOTYPES === */
+
+static void bench_file(GlbBenchFile *file, uint64_t bytes);
+static uint64_t load(GlbBenchFile *file, bool cook, bool cold);
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(int argc, char **argv)
+{
+  const char *dir = argc > 1 ? argv[1] : ".";
+  GlbBenchFile files[2] = {
+    { .name = "gltf" },
+    { .name = "glb" },
+  };
+  snprintf(files[0].path, GLB_BENCH_PATH_SIZE, "%s/glb-bench.gltf", dir);
+  snprintf(files[0].bin, GLB_BENCH_PATH_SIZE, "%s/glb-bench.bin", dir);
+  snprintf(files[1].path, GLB_BENCH_PATH_SIZE, "%s/glb-bench.glb", dir);
+  for (int i = 0; i < 2; i++)
+  {
+    snprintf(files[i].cache, GLB_BENCH_CACHE_SIZE, "%s%s", files[i].path,
+             MESH_CACHE_EXTENSION);
+  }
+
+  TestRng rng = test_rng(GLB_BENCH_SEED);
+  GltfGen gen;
+  if (TEST_CHECK(gltf_gen_create(&gen, GLB_BENCH_MESHES, GLB_BENCH_GRID,
+                                 &rng)) &&
+      TEST_CHECK(gltf_gen_write_gltf(&gen, files[0].path, files[0].bin,
+                                     "glb-bench.bin")) &&
+      TEST_CHECK(gltf_gen_write_glb(&gen, files[1].path)))
+  {
+    printf("%d meshes, %zu KB of buffers\n", GLB_BENCH_MESHES,
+           gen.bin_size >> 10);
+    for (int i = 0; i < 2; i++)
+    {
+      bench_file(&files[i], gen.bin_size);
+    }
+  }
+  gltf_gen_destroy(&gen);
+
+  for (int i = 0; i < 2; i++)
+  {
+    remove(files[i].path);
+    remove(files[i].cache);
+    if (files[i].bin[0] != '\0')
+    {
+      remove(files[i].bin);
+    }
+  }
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void bench_file(GlbBenchFile *file, uint64_t bytes)
+{
+  char name[64];
+  for (int cook = 1; cook >= 0; cook--)
+  {
+    for (int cold = 0; cold < 2; cold++)
+    {
+#ifndef __linux__
+      if (cold)
+      {
+        break;
+      }
+#endif
+      uint64_t best = UINT64_MAX;
+      for (int run = 0; run < GLB_BENCH_RUNS; run++)
+      {
+        uint64_t time = load(file, cook, cold);
+        best = time < best ? time : best;
+      }
+      snprintf(name, sizeof(name), "  %s %s %s", file->name,
+               cook ? "cook" : "cached", cold ? "cold" : "warm");
+      test_bench_report(name, bytes, best);
+    }
+  }
+}
+
+static uint64_t load(GlbBenchFile *file, bool cook, bool cold)
+{
+  if (cook)
+  {
+    remove(file->cache);
+  }
+  if (cold)
+  {
+    test_drop_cached(file->path);
+    test_drop_cached(file->cache);
+    if (file->bin[0] != '\0')
+    {
+      test_drop_cached(file->bin);
+    }
+  }
+
+  StaticModel model;
+  uint64_t start = thread_time_ns();
+  bool ok = gltf_parse(&model, file->path);
+  uint64_t time = thread_time_ns() - start;
+  if (TEST_CHECK(ok))
+  {
+    TEST_CHECK(model.mesh_count == GLB_BENCH_MESHES);
+    gltf_model_destroy(&model);
+  }
+  return time;
+}
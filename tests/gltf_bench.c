@@ -0,0 +1,586 @@
+/* =====================
+ * tests/gltf_bench.c
+ * 10/18/2026
+ * Times schema decoding of a large glTF scene against the old parser.
+ * ====================
+ */
+
+/*
+ * The document is a generated scene graph of 50k nodes, each with a name,
+ * a TRS transform and the children of a four way tree, the leaves holding
+ * the one mesh.  The schema side decodes it the way gltf.c does: tokenize
+ * into a JsonStream, then json_decode_object with node and scene tables
+ * matching gltf.c's, unknown root keys skipped.  The reference is the path
+ * gltf.c took before the schemas, with jsmn tokenizing twice to size the
+ * token array and a strcmp chain per key, extended to the node fields the
+ * schema decodes and skipping the few root keys it doesn't.  Both decode
+ * the same document and their results are compared.
+ *
+ * Without JSMN_PARENT_LINKS, which the old parser didn't set, jsmn finds
+ * the parent of every closed object by scanning back to it, so the token
+ * pass is quadratic in the node count.  The reference is timed once.
+ */
+
+#include <string.h>
+
+#define JSMN_STATIC
+#include <jsmn.h>
+
+#include <miur/arena.h>
+#include <miur/json.h>
+#include <miur/json_schema.h>
+#include <miur/mem.h>
+#include <miur/utils.h>
+
+#include "test.h"
+
+#define GLTF_BENCH_NODES 50000
+#define GLTF_BENCH_FANOUT 4
+#define GLTF_BENCH_DOC_SIZE (64 << 20)
+#define GLTF_BENCH_RUNS 5
+#define GLTF_BENCH_REFERENCE_RUNS 1
+#define GLTF_BENCH_SEED 0x676C746662656E63ULL
+#define GLTF_BENCH_ARENA_BLOCK (1 << 20)
+
+typedef struct
+{
+  const char *name;
+  int mesh;
+  int *children;
+  size_t child_count;
+  float matrix[16];
+  float translation[3];
+  float rotation[4];
+  float scale[3];
+} BenchNode;
+
+typedef struct
+{
+  const char *name;
+  int *nodes;
+  size_t node_count;
+} BenchScene;
+
+typedef struct
+{
+  int scene;
+  BenchScene *scenes;
+  size_t scene_count;
+  BenchNode *nodes;
+  size_t node_count;
+} BenchRoot;
+
+typedef struct
+{
+  Membuf doc;
+  BenchRoot root;
+  /* Schema side. */
+  JsonStream stream;
+  Arena arena;
+  /* Reference side. */
+  jsmntok_t *tokens;
+  int token_count;
+  int cur;
+  bool ok;
+} GltfBench;
+
+/* === PROTOTYPES === */
+
+static void init_node(void *out);
+static size_t generate(char *out, size_t capacity, TestRng *rng);
+static void bench_schema(void *ud);
+static bool schema_decode(GltfBench *bench);
+static void schema_free(GltfBench *bench);
+static void bench_reference(void *ud);
+static bool reference_decode(GltfBench *bench);
+static bool reference_node(GltfBench *bench, BenchNode *node);
+static bool reference_scene(GltfBench *bench, BenchScene *scene);
+static bool reference_floats(GltfBench *bench, float *out, int capacity);
+static bool reference_ints(GltfBench *bench, int **out, size_t *count);
+static void reference_skip(GltfBench *bench);
+static bool reference_key(GltfBench *bench, const char *key);
+static int64_t reference_int(GltfBench *bench);
+static float reference_float(GltfBench *bench);
+static void reference_free(GltfBench *bench);
+static bool same_roots(const BenchRoot *a, const BenchRoot *b);
+
+/* === SCHEMAS === */
+
+#define BENCH_SCENE_FIELDS(X, S)                                               \
+  X(S, CSTRING,      "name",          name,            ,                 )     \
+  X(S, INT_ARRAY,    "nodes",         nodes,           node_count,       )
+JSON_SCHEMA_DEFINE(scene_schema, BenchScene, BENCH_SCENE_FIELDS, 0, NULL,
+                   NULL);
+
+#define BENCH_NODE_FIELDS(X, S)                                                \
+  X(S, CSTRING,      "name",          name,            ,                 )     \
+  X(S, INT,          "mesh",          mesh,            ,                 )     \
+  X(S, INT_ARRAY,    "children",      children,        child_count,      )     \
+  X(S, FLOAT_ARRAY,  "matrix",        matrix,          ,                 )     \
+  X(S, FLOAT_ARRAY,  "translation",   translation,     ,                 )     \
+  X(S, FLOAT_ARRAY,  "rotation",      rotation,        ,                 )     \
+  X(S, FLOAT_ARRAY,  "scale",         scale,           ,                 )
+JSON_SCHEMA_DEFINE(node_schema, BenchNode, BENCH_NODE_FIELDS, 0, init_node,
+                   NULL);
+
+#define BENCH_ROOT_FIELDS(X, S)                                                \
+  X(S, INT,          "scene",         scene,           ,                 )     \
+  X(S, OBJECT_ARRAY, "scenes",        scenes,          scene_count,            \
+    &scene_schema)                                                             \
+  X(S, OBJECT_ARRAY, "nodes",         nodes,           node_count,             \
+    &node_schema)
+JSON_SCHEMA_DEFINE(root_schema, BenchRoot, BENCH_ROOT_FIELDS, 0, NULL, NULL);
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(void)
+{
+  TestRng rng = test_rng(GLTF_BENCH_SEED);
+  char *doc = MIUR_ARR(char, GLTF_BENCH_DOC_SIZE);
+  if (!TEST_CHECK(doc != NULL))
+  {
+    return test_result();
+  }
+  size_t size = generate(doc, GLTF_BENCH_DOC_SIZE, &rng);
+  json_schema_prepare(&root_schema);
+
+  GltfBench schema = {
+    .doc = { (const uint8_t *) doc, size, MEMBUF_VIEW },
+    .ok = true,
+  };
+  GltfBench reference = schema;
+
+  printf("%d nodes, %zu KB of JSON\n", GLTF_BENCH_NODES, size >> 10);
+  test_bench_report("schema", size,
+                    test_bench_best_ns(bench_schema, &schema,
+                                       GLTF_BENCH_RUNS));
+  test_bench_report("reference", size,
+                    test_bench_best_ns(bench_reference, &reference,
+                                       GLTF_BENCH_REFERENCE_RUNS));
+  TEST_CHECK(schema.ok && reference.ok);
+
+  if (TEST_CHECK(schema_decode(&schema)) &&
+      TEST_CHECK(reference_decode(&reference)))
+  {
+    TEST_CHECK(schema.root.node_count == GLTF_BENCH_NODES);
+    TEST_CHECK(same_roots(&schema.root, &reference.root));
+  }
+  schema_free(&schema);
+  reference_free(&reference);
+
+  MIUR_FREE(doc);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void init_node(void *out)
+{
+  BenchNode *node = (BenchNode *) out;
+  node->mesh = -1;
+  for (int i = 0; i < 16; i++)
+  {
+    node->matrix[i] = i % 5 == 0 ? 1.0f : 0.0f;
+  }
+  node->rotation[3] = 1.0f;
+  node->scale[0] = node->scale[1] = node->scale[2] = 1.0f;
+}
+
+/* Node i has children GLTF_BENCH_FANOUT * i + 1 onwards. */
+static size_t generate(char *out, size_t capacity, TestRng *rng)
+{
+  size_t size = snprintf(out, capacity,
+                         "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,"
+                         "\"scenes\":[{\"name\":\"bench\",\"nodes\":[0]}],"
+                         "\"meshes\":[{\"primitives\":[{\"attributes\":"
+                         "{\"POSITION\":0}}]}],\"nodes\":[\n");
+  for (int i = 0; i < GLTF_BENCH_NODES; i++)
+  {
+    size += snprintf(out + size, capacity - size,
+                     "{\"name\":\"node%05d\",\"translation\":[%.4f,%.4f,%.4f],"
+                     "\"rotation\":[0,%.4f,0,%.4f],\"scale\":[%.3f,%.3f,%.3f]",
+                     i, test_rng_float(rng, -100.0f, 100.0f),
+                     test_rng_float(rng, -100.0f, 100.0f),
+                     test_rng_float(rng, -100.0f, 100.0f),
+                     test_rng_float(rng, 0.0f, 0.7f),
+                     test_rng_float(rng, 0.7f, 1.0f),
+                     test_rng_float(rng, 0.5f, 2.0f),
+                     test_rng_float(rng, 0.5f, 2.0f),
+                     test_rng_float(rng, 0.5f, 2.0f));
+    int first = GLTF_BENCH_FANOUT * i + 1;
+    if (first < GLTF_BENCH_NODES)
+    {
+      size += snprintf(out + size, capacity - size, ",\"children\":[");
+      for (int c = first; c < first + GLTF_BENCH_FANOUT &&
+             c < GLTF_BENCH_NODES; c++)
+      {
+        size += snprintf(out + size, capacity - size, "%s%d",
+                         c == first ? "" : ",", c);
+      }
+      size += snprintf(out + size, capacity - size, "]");
+    }
+    else
+    {
+      size += snprintf(out + size, capacity - size, ",\"mesh\":0");
+    }
+    size += snprintf(out + size, capacity - size, "}%s\n",
+                     i + 1 < GLTF_BENCH_NODES ? "," : "");
+  }
+  size += snprintf(out + size, capacity - size, "]}");
+  return size;
+}
+
+static void bench_schema(void *ud)
+{
+  GltfBench *bench = (GltfBench *) ud;
+  bench->ok &= schema_decode(bench);
+  schema_free(bench);
+}
+
+static bool schema_decode(GltfBench *bench)
+{
+  memset(&bench->root, 0, sizeof(BenchRoot));
+  arena_create(&bench->arena, GLTF_BENCH_ARENA_BLOCK);
+  if (!json_stream_init(&bench->stream, bench->doc))
+  {
+    return false;
+  }
+
+  JsonDecoder dec;
+  ParseError error;
+  json_decoder_init(&dec, &bench->stream, &bench->arena, &error);
+  return json_decode_object(&dec, &root_schema, &bench->root);
+}
+
+static void schema_free(GltfBench *bench)
+{
+  json_stream_deinit(&bench->stream);
+  arena_destroy(&bench->arena);
+}
+
+static void bench_reference(void *ud)
+{
+  GltfBench *bench = (GltfBench *) ud;
+  bench->ok &= reference_decode(bench);
+  reference_free(bench);
+}
+
+static bool reference_decode(GltfBench *bench)
+{
+  memset(&bench->root, 0, sizeof(BenchRoot));
+  const char *js = (const char *) bench->doc.data;
+  jsmn_parser json;
+  jsmn_init(&json);
+  bench->token_count = jsmn_parse(&json, js, bench->doc.size, NULL, 0);
+  if (bench->token_count <= 0)
+  {
+    return false;
+  }
+  bench->tokens = MIUR_ARR(jsmntok_t, bench->token_count);
+  jsmn_init(&json);
+  jsmn_parse(&json, js, bench->doc.size, bench->tokens, bench->token_count);
+  bench->cur = 0;
+
+  if (bench->tokens[0].type != JSMN_OBJECT)
+  {
+    return false;
+  }
+  int size = bench->tokens[bench->cur++].size;
+  for (int i = 0; i < size; i++)
+  {
+    if (reference_key(bench, "scene"))
+    {
+      bench->cur++;
+      bench->root.scene = (int) reference_int(bench);
+    }
+    else if (reference_key(bench, "scenes"))
+    {
+      bench->cur++;
+      bench->root.scene_count = bench->tokens[bench->cur++].size;
+      bench->root.scenes = MIUR_ARR(BenchScene, bench->root.scene_count);
+      for (size_t j = 0; j < bench->root.scene_count; j++)
+      {
+        if (!reference_scene(bench, &bench->root.scenes[j]))
+        {
+          return false;
+        }
+      }
+    }
+    else if (reference_key(bench, "nodes"))
+    {
+      bench->cur++;
+      bench->root.node_count = bench->tokens[bench->cur++].size;
+      bench->root.nodes = MIUR_ARR(BenchNode, bench->root.node_count);
+      for (size_t j = 0; j < bench->root.node_count; j++)
+      {
+        if (!reference_node(bench, &bench->root.nodes[j]))
+        {
+          return false;
+        }
+      }
+    }
+    else
+    {
+      bench->cur++;
+      reference_skip(bench);
+    }
+  }
+  return true;
+}
+
+static bool reference_node(GltfBench *bench, BenchNode *node)
+{
+  init_node(node);
+  if (bench->tokens[bench->cur].type != JSMN_OBJECT)
+  {
+    return false;
+  }
+  int fields = bench->tokens[bench->cur++].size;
+  for (int i = 0; i < fields; i++)
+  {
+    if (reference_key(bench, "name"))
+    {
+      bench->cur++;
+      jsmntok_t tok = bench->tokens[bench->cur++];
+      size_t size = tok.end - tok.start;
+      char *name = MIUR_ARR(char, size + 1);
+      if (tok.type != JSMN_STRING ||
+          !json_unescape(bench->doc.data + tok.start, size,
+                         (uint8_t *) name, &size))
+      {
+        MIUR_FREE(name);
+        return false;
+      }
+      name[size] = '\0';
+      node->name = name;
+    }
+    else if (reference_key(bench, "mesh"))
+    {
+      bench->cur++;
+      node->mesh = (int) reference_int(bench);
+    }
+    else if (reference_key(bench, "children"))
+    {
+      bench->cur++;
+      if (!reference_ints(bench, &node->children, &node->child_count))
+      {
+        return false;
+      }
+    }
+    else
+    {
+      float *floats = NULL;
+      int capacity = 0;
+      if (reference_key(bench, "matrix"))
+      {
+        floats = node->matrix;
+        capacity = 16;
+      }
+      else if (reference_key(bench, "translation"))
+      {
+        floats = node->translation;
+        capacity = 3;
+      }
+      else if (reference_key(bench, "rotation"))
+      {
+        floats = node->rotation;
+        capacity = 4;
+      }
+      else if (reference_key(bench, "scale"))
+      {
+        floats = node->scale;
+        capacity = 3;
+      }
+      else
+      {
+        return false;
+      }
+      bench->cur++;
+      if (!reference_floats(bench, floats, capacity))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static bool reference_scene(GltfBench *bench, BenchScene *scene)
+{
+  if (bench->tokens[bench->cur].type != JSMN_OBJECT)
+  {
+    return false;
+  }
+  int fields = bench->tokens[bench->cur++].size;
+  for (int i = 0; i < fields; i++)
+  {
+    if (reference_key(bench, "nodes"))
+    {
+      bench->cur++;
+      if (!reference_ints(bench, &scene->nodes, &scene->node_count))
+      {
+        return false;
+      }
+    }
+    else
+    {
+      bench->cur++;
+      reference_skip(bench);
+    }
+  }
+  return true;
+}
+
+static bool reference_floats(GltfBench *bench, float *out, int capacity)
+{
+  jsmntok_t array = bench->tokens[bench->cur++];
+  if (array.type != JSMN_ARRAY || array.size > capacity)
+  {
+    return false;
+  }
+  for (int i = 0; i < array.size; i++)
+  {
+    out[i] = reference_float(bench);
+  }
+  return true;
+}
+
+static bool reference_ints(GltfBench *bench, int **out, size_t *count)
+{
+  jsmntok_t array = bench->tokens[bench->cur++];
+  if (array.type != JSMN_ARRAY)
+  {
+    return false;
+  }
+  *count = array.size;
+  *out = MIUR_ARR(int, array.size > 0 ? array.size : 1);
+  for (int i = 0; i < array.size; i++)
+  {
+    (*out)[i] = (int) reference_int(bench);
+  }
+  return true;
+}
+
+/* Skips the value at the cursor, one token at a time. */
+static void reference_skip(GltfBench *bench)
+{
+  int pending = 1;
+  while (pending > 0)
+  {
+    jsmntok_t tok = bench->tokens[bench->cur++];
+    pending--;
+    if (tok.type == JSMN_OBJECT)
+    {
+      pending += 2 * tok.size;
+    }
+    else if (tok.type == JSMN_ARRAY)
+    {
+      pending += tok.size;
+    }
+  }
+}
+
+static bool reference_key(GltfBench *bench, const char *key)
+{
+  jsmntok_t tok = bench->tokens[bench->cur];
+  size_t len = strlen(key);
+  return len == (size_t) (tok.end - tok.start) &&
+    strncmp(key, (const char *) bench->doc.data + tok.start, len) == 0;
+}
+
+static int64_t reference_int(GltfBench *bench)
+{
+  jsmntok_t tok = bench->tokens[bench->cur++];
+  int64_t value = 0;
+  for (int i = tok.start; i < tok.end; i++)
+  {
+    value = value * 10 + (bench->doc.data[i] - '0');
+  }
+  return value;
+}
+
+/* The digit loop the old parser used, see git history of src/gltf.c. */
+static float reference_float(GltfBench *bench)
+{
+  jsmntok_t tok = bench->tokens[bench->cur++];
+  const char *c = (const char *) bench->doc.data + tok.start;
+  int len = tok.end - tok.start;
+  float sign = 1.0f;
+  if (*c == '-')
+  {
+    sign = -1.0f;
+    c++;
+    len--;
+  }
+  bool past_point = false;
+  float total = 0.0f;
+  float multiplier = 10.0f;
+  for (; len > 0; c++, len--)
+  {
+    if (*c == '.')
+    {
+      past_point = true;
+      multiplier = 0.1f;
+    }
+    else if (past_point)
+    {
+      total += (float) (*c - '0') * multiplier;
+      multiplier /= 10.0f;
+    }
+    else
+    {
+      total = total * multiplier + (float) (*c - '0');
+    }
+  }
+  return sign * total;
+}
+
+static void reference_free(GltfBench *bench)
+{
+  for (size_t i = 0; i < bench->root.node_count; i++)
+  {
+    MIUR_FREE((char *) bench->root.nodes[i].name);
+    MIUR_FREE(bench->root.nodes[i].children);
+  }
+  for (size_t i = 0; i < bench->root.scene_count; i++)
+  {
+    MIUR_FREE(bench->root.scenes[i].nodes);
+  }
+  MIUR_FREE(bench->root.nodes);
+  MIUR_FREE(bench->root.scenes);
+  MIUR_FREE(bench->tokens);
+  memset(&bench->root, 0, sizeof(BenchRoot));
+  bench->tokens = NULL;
+}
+
+/* The old float loop rounds differently, so floats only need to be close. */
+static bool same_roots(const BenchRoot *a, const BenchRoot *b)
+{
+  if (a->scene != b->scene || a->scene_count != b->scene_count ||
+      a->node_count != b->node_count || a->scenes[0].node_count !=
+      b->scenes[0].node_count)
+  {
+    return false;
+  }
+  for (size_t i = 0; i < a->node_count; i++)
+  {
+    const BenchNode *x = &a->nodes[i], *y = &b->nodes[i];
+    if (strcmp(x->name, y->name) != 0 || x->mesh != y->mesh ||
+        x->child_count != y->child_count ||
+        (x->child_count > 0 && memcmp(x->children, y->children,
+                                      x->child_count * sizeof(int)) != 0))
+    {
+      return false;
+    }
+    for (int j = 0; j < 3; j++)
+    {
+      float dt = x->translation[j] - y->translation[j];
+      float ds = x->scale[j] - y->scale[j];
+      if (dt * dt > 1e-6f || ds * ds > 1e-6f)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,274 @@
+/* =====================
+ * tests/gltf_gen.h
+ * 10/18/2026
+ * Generated glTF models for the loader tests and benchmarks.
+ * ====================
+ */
+
+/*
+ * A model is `mesh_count` meshes, each a grid of `grid` by `grid` vertices
+ * with random heights, a node per mesh.  Every mesh has four buffer views
+ * back to back in the one buffer: positions, normals, uvs and u16 indices,
+ * so all but the first mesh's views start well inside it.  The same model
+ * can be written as a .gltf with an external .bin or as one .glb.
+ */
+
+#ifndef MIUR_TEST_GLTF_GEN_H
+#define MIUR_TEST_GLTF_GEN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <miur/mem.h>
+#include <miur/membuf.h>
+
+#include "test.h"
+
+#define GLTF_GEN_JSON_SIZE (16 << 20)
+#define GLTF_GEN_GLB_MAGIC 0x46546C67u
+#define GLTF_GEN_GLB_VERSION 2
+#define GLTF_GEN_GLB_JSON 0x4E4F534Au
+#define GLTF_GEN_GLB_BIN 0x004E4942u
+
+typedef struct
+{
+  int mesh_count;
+  int grid;
+  size_t pos_size;
+  size_t uv_size;
+  size_t index_size;
+  size_t mesh_size;
+  uint8_t *bin;
+  size_t bin_size;
+  char *json;
+} GltfGen;
+
+/* === PROTOTYPES === */
+
+static inline bool gltf_gen_create(GltfGen *gen, int mesh_count, int grid,
+                                   TestRng *rng);
+static inline void gltf_gen_destroy(GltfGen *gen);
+static inline int gltf_gen_index_count(const GltfGen *gen);
+static inline const float *gltf_gen_positions(const GltfGen *gen, int mesh);
+static inline bool gltf_gen_write_gltf(GltfGen *gen, const char *path,
+                                       const char *bin_path,
+                                       const char *bin_uri);
+static inline bool gltf_gen_write_glb(GltfGen *gen, const char *path);
+static inline size_t gltf_gen_json(GltfGen *gen, const char *bin_uri);
+static inline void gltf_gen_u32(uint8_t *out, uint32_t value);
+
+/* === PUBLIC FUNCTIONS === */
+
+static inline bool gltf_gen_create(GltfGen *gen, int mesh_count, int grid,
+                                   TestRng *rng)
+{
+  memset(gen, 0, sizeof(GltfGen));
+  gen->mesh_count = mesh_count;
+  gen->grid = grid;
+  gen->pos_size = (size_t) grid * grid * 3 * sizeof(float);
+  gen->uv_size = (size_t) grid * grid * 2 * sizeof(float);
+  /* Padded so the next mesh's floats stay aligned. */
+  gen->index_size = ((size_t) gltf_gen_index_count(gen) * sizeof(uint16_t) +
+                     3) & ~(size_t) 3;
+  gen->mesh_size = 2 * gen->pos_size + gen->uv_size + gen->index_size;
+  gen->bin_size = gen->mesh_size * mesh_count;
+  gen->bin = MIUR_ARR(uint8_t, gen->bin_size);
+  gen->json = MIUR_ARR(char, GLTF_GEN_JSON_SIZE);
+  if (gen->bin == NULL || gen->json == NULL)
+  {
+    gltf_gen_destroy(gen);
+    return false;
+  }
+
+  for (int i = 0; i < mesh_count; i++)
+  {
+    uint8_t *base = gen->bin + gen->mesh_size * i;
+    float *pos = (float *) base;
+    float *norm = (float *) (base + gen->pos_size);
+    float *uv = (float *) (base + 2 * gen->pos_size);
+    uint16_t *indices = (uint16_t *) (base + 2 * gen->pos_size + gen->uv_size);
+    for (int y = 0; y < grid; y++)
+    {
+      for (int x = 0; x < grid; x++)
+      {
+        int v = y * grid + x;
+        pos[3 * v] = (float) x;
+        pos[3 * v + 1] = test_rng_float(rng, -1.0f, 1.0f);
+        pos[3 * v + 2] = (float) y;
+        norm[3 * v + 1] = 1.0f;
+        uv[2 * v] = x / (float) (grid - 1);
+        uv[2 * v + 1] = y / (float) (grid - 1);
+      }
+    }
+    for (int y = 0, n = 0; y + 1 < grid; y++)
+    {
+      for (int x = 0; x + 1 < grid; x++)
+      {
+        uint16_t v = (uint16_t) (y * grid + x);
+        uint16_t quad[6] = {
+          v, (uint16_t) (v + grid), (uint16_t) (v + 1),
+          (uint16_t) (v + 1), (uint16_t) (v + grid),
+          (uint16_t) (v + grid + 1),
+        };
+        memcpy(indices + n, quad, sizeof(quad));
+        n += 6;
+      }
+    }
+  }
+  return true;
+}
+
+static inline void gltf_gen_destroy(GltfGen *gen)
+{
+  MIUR_FREE(gen->bin);
+  MIUR_FREE(gen->json);
+  memset(gen, 0, sizeof(GltfGen));
+}
+
+static inline int gltf_gen_index_count(const GltfGen *gen)
+{
+  return (gen->grid - 1) * (gen->grid - 1) * 6;
+}
+
+static inline const float *gltf_gen_positions(const GltfGen *gen, int mesh)
+{
+  return (const float *) (gen->bin + gen->mesh_size * mesh);
+}
+
+static inline bool gltf_gen_write_gltf(GltfGen *gen, const char *path,
+                                       const char *bin_path,
+                                       const char *bin_uri)
+{
+  size_t json_size = gltf_gen_json(gen, bin_uri);
+  Membuf json = { (const uint8_t *) gen->json, json_size, MEMBUF_VIEW };
+  Membuf bin = { gen->bin, gen->bin_size, MEMBUF_VIEW };
+  return json_size > 0 && membuf_write_file(json, path) &&
+    membuf_write_file(bin, bin_path);
+}
+
+/* Both chunks are padded to 4 bytes, JSON with spaces and BIN with zeros. */
+static inline bool gltf_gen_write_glb(GltfGen *gen, const char *path)
+{
+  size_t json_size = gltf_gen_json(gen, NULL);
+  if (json_size == 0)
+  {
+    return false;
+  }
+  size_t json_chunk = (json_size + 3) & ~(size_t) 3;
+  size_t bin_chunk = (gen->bin_size + 3) & ~(size_t) 3;
+  size_t size = 12 + 8 + json_chunk + 8 + bin_chunk;
+  uint8_t *glb = MIUR_ARR(uint8_t, size);
+  if (glb == NULL)
+  {
+    return false;
+  }
+
+  gltf_gen_u32(glb, GLTF_GEN_GLB_MAGIC);
+  gltf_gen_u32(glb + 4, GLTF_GEN_GLB_VERSION);
+  gltf_gen_u32(glb + 8, (uint32_t) size);
+  uint8_t *chunk = glb + 12;
+  gltf_gen_u32(chunk, (uint32_t) json_chunk);
+  gltf_gen_u32(chunk + 4, GLTF_GEN_GLB_JSON);
+  memcpy(chunk + 8, gen->json, json_size);
+  memset(chunk + 8 + json_size, ' ', json_chunk - json_size);
+  chunk += 8 + json_chunk;
+  gltf_gen_u32(chunk, (uint32_t) bin_chunk);
+  gltf_gen_u32(chunk + 4, GLTF_GEN_GLB_BIN);
+  memcpy(chunk + 8, gen->bin, gen->bin_size);
+
+  Membuf file = { glb, size, MEMBUF_VIEW };
+  bool ok = membuf_write_file(file, path);
+  MIUR_FREE(glb);
+  return ok;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/* The buffer is the GLB's own when `bin_uri` is NULL.  Returns 0 if full. */
+static inline size_t gltf_gen_json(GltfGen *gen, const char *bin_uri)
+{
+  char *json = gen->json;
+  size_t size = 0;
+  const size_t cap = GLTF_GEN_JSON_SIZE;
+  int verts = gen->grid * gen->grid;
+
+#define GLTF_GEN_APPEND(...)                                                   \
+  size += snprintf(json + size, size < cap ? cap - size : 0, __VA_ARGS__)
+
+  GLTF_GEN_APPEND("{\"asset\":{\"version\":\"2.0\"},\"scene\":0,"
+                  "\"scenes\":[{\"nodes\":[");
+  for (int i = 0; i < gen->mesh_count; i++)
+  {
+    GLTF_GEN_APPEND("%s%d", i == 0 ? "" : ",", i);
+  }
+  GLTF_GEN_APPEND("]}],\"nodes\":[");
+  for (int i = 0; i < gen->mesh_count; i++)
+  {
+    GLTF_GEN_APPEND("%s{\"mesh\":%d,\"translation\":[%d,0,%d]}",
+                    i == 0 ? "" : ",", i, (i % 64) * gen->grid,
+                    (i / 64) * gen->grid);
+  }
+  GLTF_GEN_APPEND("],\"meshes\":[");
+  for (int i = 0; i < gen->mesh_count; i++)
+  {
+    GLTF_GEN_APPEND("%s{\"primitives\":[{\"attributes\":{\"POSITION\":%d,"
+                    "\"NORMAL\":%d,\"TEXCOORD_0\":%d},\"indices\":%d}]}",
+                    i == 0 ? "" : ",", 4 * i, 4 * i + 1, 4 * i + 2,
+                    4 * i + 3);
+  }
+  GLTF_GEN_APPEND("],\"accessors\":[");
+  for (int i = 0; i < gen->mesh_count; i++)
+  {
+    GLTF_GEN_APPEND("%s{\"bufferView\":%d,\"componentType\":5126,"
+                    "\"count\":%d,\"type\":\"VEC3\",\"min\":[0,-1,0],"
+                    "\"max\":[%d,1,%d]},"
+                    "{\"bufferView\":%d,\"componentType\":5126,\"count\":%d,"
+                    "\"type\":\"VEC3\"},"
+                    "{\"bufferView\":%d,\"componentType\":5126,\"count\":%d,"
+                    "\"type\":\"VEC2\"},"
+                    "{\"bufferView\":%d,\"componentType\":5123,\"count\":%d,"
+                    "\"type\":\"SCALAR\"}",
+                    i == 0 ? "" : ",", 4 * i, verts, gen->grid - 1,
+                    gen->grid - 1, 4 * i + 1, verts, 4 * i + 2, verts,
+                    4 * i + 3, gltf_gen_index_count(gen));
+  }
+  GLTF_GEN_APPEND("],\"bufferViews\":[");
+  for (int i = 0; i < gen->mesh_count; i++)
+  {
+    size_t base = gen->mesh_size * i;
+    GLTF_GEN_APPEND("%s{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu},"
+                    "{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu},"
+                    "{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu},"
+                    "{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu}",
+                    i == 0 ? "" : ",", base, gen->pos_size,
+                    base + gen->pos_size, gen->pos_size,
+                    base + 2 * gen->pos_size, gen->uv_size,
+                    base + 2 * gen->pos_size + gen->uv_size,
+                    (size_t) gltf_gen_index_count(gen) * sizeof(uint16_t));
+  }
+  if (bin_uri != NULL)
+  {
+    GLTF_GEN_APPEND("],\"buffers\":[{\"uri\":\"%s\",\"byteLength\":%zu}]}",
+                    bin_uri, gen->bin_size);
+  }
+  else
+  {
+    GLTF_GEN_APPEND("],\"buffers\":[{\"byteLength\":%zu}]}", gen->bin_size);
+  }
+
+#undef GLTF_GEN_APPEND
+  return size < cap ? size : 0;
+}
+
+static inline void gltf_gen_u32(uint8_t *out, uint32_t value)
+{
+  out[0] = (uint8_t) value;
+  out[1] = (uint8_t) (value >> 8);
+  out[2] = (uint8_t) (value >> 16);
+  out[3] = (uint8_t) (value >> 24);
+}
+
+#endif
@@ -0,0 +1,120 @@
+/* =====================
+ * tests/gltf_scaling_bench.c
+ * 10/18/2026
+ * Times loading a many mesh glTF across job system sizes.
+ * ====================
+ */
+
+/*
+ * Writes a glTF of 2000 meshes, each a 16 by 16 grid from gltf_gen.h, to
+ * the directory given as the first argument, or the current one, and
+ * removes it afterwards.  The file is loaded with gltf_parse on the calling
+ * thread alone, then with gltf_load_async on job_system_create(n) for n
+ * from 1 up to the processor count, the caller helping while it waits.
+ * Every load cooks from scratch, the mesh cache written by the previous one
+ * is removed first.  Speedups are against the single threaded load.
+ */
+
+#include <inttypes.h>
+
+#include <miur/gltf.h>
+#include <miur/job.h>
+#include <miur/mesh_cache.h>
+
+#include "gltf_gen.h"
+#include "test.h"
+
+#define SCALING_BENCH_MESHES 2000
+#define SCALING_BENCH_GRID 16
+#define SCALING_BENCH_RUNS 3
+#define SCALING_BENCH_SEED 0x7363616C696E67ULL
+#define SCALING_BENCH_PATH_SIZE 1024
+
+typedef struct
+{
+  const char *path;
+  const char *cache_path;
+  JobSystem *jobs;
+  bool ok;
+} ScalingBench;
+
+/* === PROTOTYPES === */
+
+static void bench_load(void *ud);
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(int argc, char **argv)
+{
+  const char *dir = argc > 1 ? argv[1] : ".";
+  char gltf_path[SCALING_BENCH_PATH_SIZE], bin_path[SCALING_BENCH_PATH_SIZE];
+  char cache_path[SCALING_BENCH_PATH_SIZE + sizeof(MESH_CACHE_EXTENSION)];
+  snprintf(gltf_path, sizeof(gltf_path), "%s/scaling-bench.gltf", dir);
+  snprintf(bin_path, sizeof(bin_path), "%s/scaling-bench.bin", dir);
+  snprintf(cache_path, sizeof(cache_path), "%s%s", gltf_path,
+           MESH_CACHE_EXTENSION);
+  TestRng rng = test_rng(SCALING_BENCH_SEED);
+  GltfGen gen;
+
+  if (TEST_CHECK(gltf_gen_create(&gen, SCALING_BENCH_MESHES,
+                                 SCALING_BENCH_GRID, &rng)) &&
+      TEST_CHECK(gltf_gen_write_gltf(&gen, gltf_path, bin_path,
+                                     "scaling-bench.bin")))
+  {
+    uint32_t cpus = thread_cpu_count();
+    printf("%d meshes of %d triangles, %" PRIu32 " processors\n",
+           SCALING_BENCH_MESHES, gltf_gen_index_count(&gen) / 3, cpus);
+
+    ScalingBench bench = { gltf_path, cache_path, NULL, true };
+    uint64_t serial = test_bench_best_ns(bench_load, &bench,
+                                         SCALING_BENCH_RUNS);
+    printf("  %-24s %10.3f ms\n", "calling thread", serial / 1e6);
+
+    for (uint32_t n = 1; n <= cpus; n++)
+    {
+      bench.jobs = job_system_create(n);
+      if (!TEST_CHECK(bench.jobs != NULL))
+      {
+        break;
+      }
+      uint64_t time = test_bench_best_ns(bench_load, &bench,
+                                         SCALING_BENCH_RUNS);
+      job_system_destroy(bench.jobs);
+      printf("  %2" PRIu32 " workers %15s %10.3f ms %8.2fx\n", n, "",
+             time / 1e6, time > 0 ? (double) serial / time : 0.0);
+    }
+    TEST_CHECK(bench.ok);
+  }
+  gltf_gen_destroy(&gen);
+
+  remove(gltf_path);
+  remove(bin_path);
+  remove(cache_path);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void bench_load(void *ud)
+{
+  ScalingBench *bench = (ScalingBench *) ud;
+  remove(bench->cache_path);
+
+  StaticModel model;
+  bool ok;
+  if (bench->jobs == NULL)
+  {
+    ok = gltf_parse(&model, bench->path);
+  }
+  else
+  {
+    GLTFLoad *load = gltf_load_async(&model, bench->path, bench->jobs, NULL);
+    ok = load != NULL && gltf_load_wait(load);
+  }
+  if (ok)
+  {
+    ok = model.mesh_count == SCALING_BENCH_MESHES;
+    gltf_model_destroy(&model);
+  }
+  bench->ok &= ok;
+}
@@ -0,0 +1,199 @@
+/* =====================
+ * tests/hash.c
+ * 10/18/2026
+ * Checks hash3 and hash64 against the reference xxHash.
+ * ====================
+ */
+
+/*
+ * The expected values are what the reference xxHash library gives for
+ * XXH3_64bits_withSeed and XXH64 on the first `size` bytes of the buffer
+ * its own sanity test generates, with seed 0 and a nonzero seed.  The sizes
+ * cover each of XXH3's paths and their edges: empty, 1-3, 4-8, 9-16,
+ * 17-128, 129-240, and longer inputs ending inside, on and just past a
+ * block.  The same values have to come out of unaligned input and of
+ * streams fed in random pieces.  Which stripe accumulator runs, AVX2, SSE2
+ * or scalar, is fixed at compile time, so each build checks its own.
+ */
+
+#include <string.h>
+
+#include <miur/hash.h>
+#include <miur/mem.h>
+
+#include "test.h"
+
+#define HASH_TEST_SIZE 200000
+#define HASH_TEST_SEED 0x9E3779B185EBCA8DULL
+#define HASH_TEST_STREAMS 20
+
+typedef struct
+{
+  size_t size;
+  uint64_t hash3;
+  uint64_t hash3_seeded;
+  uint64_t hash64;
+  uint64_t hash64_seeded;
+} HashVector;
+
+/* === GLOBALS === */
+
+static const HashVector VECTORS[] = {
+  {      0, 0x2D06800538D394C2ULL, 0xA8A6B918B2F0364AULL,
+            0xEF46DB3751D8E999ULL, 0x0B303D920EC349DFULL },
+  {      1, 0xC44BDFF4074EECDBULL, 0x032BE332DD766EF8ULL,
+            0xE934A84ADB052768ULL, 0x9C6678669FCD2E6DULL },
+  {      2, 0x7A9978044CB8A8BBULL, 0x764B35C90519AD88ULL,
+            0x5D48CD60A77E23FFULL, 0x8469CBF08335C09CULL },
+  {      3, 0x54247382A8D6B94DULL, 0x634B8990B4976373ULL,
+            0xFF7E1959CB50794AULL, 0x281B7CBB86CC6A05ULL },
+  {      4, 0xE5DC74BC51848A51ULL, 0xAA2E7ECCB0C8F747ULL,
+            0x9136A0DCA57457EEULL, 0xCCFE4EAD7E01983CULL },
+  {      7, 0x9941E0007F555E50ULL, 0x75BDAB43463F0151ULL,
+            0x6C83909A9F01ED25ULL, 0x3C18DF70E6EF9D24ULL },
+  {      8, 0x24CCC9ACAA9F65E4ULL, 0x8F973410999B8F6BULL,
+            0xCDBCF538E71D1348ULL, 0x768161B4E5A58DFAULL },
+  {      9, 0x14D5001C15DD3F2BULL, 0xB3AE7333D9013F60ULL,
+            0x554B1AE991EDA6B6ULL, 0x6A7EF24927B938A0ULL },
+  {     15, 0x45556D4D6E1798BCULL, 0x710DD5318F6F16D5ULL,
+            0x180719316D622D84ULL, 0xAC31EE102E5CF442ULL },
+  {     16, 0x981B17D36C7498C9ULL, 0x663F29333B4DB6B1ULL,
+            0x98C90B57FDFCB55CULL, 0x85446BBA49CB7DF1ULL },
+  {     17, 0x796F5ACD3A60F862ULL, 0xF3EC5067F4306DB3ULL,
+            0x0D39A2D051A30C2CULL, 0x1DD902D73122EDA0ULL },
+  {     64, 0x9CB48487720EC49DULL, 0x4FE8895DB9B8C077ULL,
+            0xEF558F8ACAC2B5CDULL, 0xF90D26FED8023D61ULL },
+  {    127, 0x2408ED71323D6096ULL, 0x41D2F0C3F483208FULL,
+            0x3C7A21119AA662B0ULL, 0x9238093F3286F85AULL },
+  {    128, 0xFCFF24126754D861ULL, 0x73FDE75280646649ULL,
+            0x90CA021457D96DC5ULL, 0xFCEF9BEB2CE440A6ULL },
+  {    129, 0x98F1B0A679A2CA29ULL, 0x21FFFDBCA099C844ULL,
+            0x41C280132D697ABAULL, 0xAEB872C374EABF84ULL },
+  {    200, 0xBDDCA58935D7C038ULL, 0x5B899E984B88DB8DULL,
+            0x4D863378A2052D65ULL, 0xA3F3EFDA734B1256ULL },
+  {    240, 0x81C3C2B67F568CCFULL, 0xCC0F58C27EF3D8EEULL,
+            0xB81838D483BAEE53ULL, 0x7C3C8490FE0C1B94ULL },
+  {    241, 0xC5A639ECD2030E5EULL, 0xDDA9B0A161D4829AULL,
+            0x95D76C8B4D8FC4D6ULL, 0x6BD0DB4EF4123409ULL },
+  {    256, 0x55DE574AD89D0AC5ULL, 0x4D30234B7A3AA61CULL,
+            0x5E3F5BF94D574981ULL, 0xA1CBBC0DA72934FEULL },
+  {   1023, 0x87A8F7B2F2E22496ULL, 0x0F0F02DE8590E1B5ULL,
+            0xAAC72718B7620924ULL, 0xA471CAEE31BA9F8AULL },
+  {   1024, 0xDD85C9B5C1109C5CULL, 0xEF368A8A2EBABAEFULL,
+            0x4775BF7CACE4D177ULL, 0xCFBC5E785FF33CCDULL },
+  {   1025, 0xD870C0FA13211C6AULL, 0x96792BCF9AF88519ULL,
+            0x847FA6006D7C2AC0ULL, 0x880172CBAE03711FULL },
+  {   4096, 0xE91206429D1F48F9ULL, 0x2A3BBB20A5439DCDULL,
+            0xAB77F4AF85F4E70BULL, 0x7B950D3AD86DCD2CULL },
+  {  16387, 0xF44C4BC71B4C709CULL, 0x055CDBE7304E4D6CULL,
+            0x64D9E78F60346611ULL, 0xDED8361FF7F3ED98ULL },
+  { 100000, 0x34D658192A014311ULL, 0x0682260A8A5AFE82ULL,
+            0x2F2257F45994FF6AULL, 0xA53C361A45679B06ULL },
+  { 200000, 0x813794D4FBDA666AULL, 0xA124E4E29C1182F2ULL,
+            0x9241268AC8CF395AULL, 0x5FF9039B50AC0FE3ULL },
+};
+
+/* === PROTOTYPES === */
+
+static void fill_sanity_buffer(uint8_t *buffer, size_t size);
+static void check_vector(const HashVector *vector, const uint8_t *data,
+                         uint8_t *unaligned, TestRng *rng);
+static uint64_t stream_pieces(const uint8_t *data, size_t size,
+                              uint64_t seed, TestRng *rng);
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(void)
+{
+  TestRng rng = test_rng(HASH_TEST_SEED);
+  uint8_t *data = MIUR_ARR_UNINIT(uint8_t, HASH_TEST_SIZE);
+  uint8_t *unaligned = MIUR_ARR_UNINIT(uint8_t, HASH_TEST_SIZE + 8);
+  if (!TEST_CHECK(data != NULL && unaligned != NULL))
+  {
+    MIUR_FREE(data);
+    MIUR_FREE(unaligned);
+    return test_result();
+  }
+
+  fill_sanity_buffer(data, HASH_TEST_SIZE);
+  for (size_t i = 0; i < sizeof(VECTORS) / sizeof(VECTORS[0]); i++)
+  {
+    check_vector(&VECTORS[i], data, unaligned, &rng);
+  }
+
+  MIUR_FREE(data);
+  MIUR_FREE(unaligned);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/* As xxHash's sanity check fills its buffer. */
+static void fill_sanity_buffer(uint8_t *buffer, size_t size)
+{
+  uint64_t generator = 2654435761u;
+  for (size_t i = 0; i < size; i++)
+  {
+    buffer[i] = (uint8_t) (generator >> 56);
+    generator *= 0x9E3779B185EBCA8Dull;
+  }
+}
+
+static void check_vector(const HashVector *vector, const uint8_t *data,
+                         uint8_t *unaligned, TestRng *rng)
+{
+  size_t size = vector->size;
+  bool ok = TEST_CHECK(hash3(data, size, 0) == vector->hash3);
+  ok &= TEST_CHECK(hash3(data, size, HASH_TEST_SEED) ==
+                   vector->hash3_seeded);
+  ok &= TEST_CHECK(hash64(data, size, 0) == vector->hash64);
+  ok &= TEST_CHECK(hash64(data, size, HASH_TEST_SEED) ==
+                   vector->hash64_seeded);
+
+  for (size_t offset = 1; offset < 8; offset++)
+  {
+    memcpy(unaligned + offset, data, size);
+    ok &= TEST_CHECK(hash3(unaligned + offset, size, 0) == vector->hash3);
+    ok &= TEST_CHECK(hash64(unaligned + offset, size, 0) == vector->hash64);
+  }
+
+  for (int i = 0; i < HASH_TEST_STREAMS; i++)
+  {
+    ok &= TEST_CHECK(stream_pieces(data, size, 0, rng) == vector->hash3);
+    ok &= TEST_CHECK(stream_pieces(data, size, HASH_TEST_SEED, rng) ==
+                     vector->hash3_seeded);
+  }
+  if (!ok)
+  {
+    fprintf(stderr, "  for %zu bytes\n", size);
+  }
+}
+
+/*
+ * Piece sizes mix single bytes, sizes around the stream buffer and large
+ * runs, and the digest is also taken part way, which mustn't change what
+ * comes after.
+ */
+static uint64_t stream_pieces(const uint8_t *data, size_t size,
+                              uint64_t seed, TestRng *rng)
+{
+  static const uint32_t limits[] = {
+    2, 65, HASH_STREAM_BUFFER_SIZE + 1, 4 * HASH_STREAM_BUFFER_SIZE, 70000,
+  };
+  HashStream stream;
+  hash_stream_init(&stream, seed);
+  size_t done = 0;
+  while (done < size)
+  {
+    uint32_t limit = limits[test_rng_below(rng, 5)];
+    size_t piece = test_rng_below(rng, limit);
+    piece = piece < size - done ? piece : size - done;
+    hash_stream_update(&stream, data + done, piece);
+    done += piece;
+    if (test_rng_below(rng, 4) == 0)
+    {
+      TEST_CHECK(hash_stream_digest(&stream) == hash3(data, done, seed));
+    }
+  }
+  return hash_stream_digest(&stream);
+}
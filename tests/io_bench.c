@@ -0,0 +1,276 @@
+/* =====================
+ * tests/io_bench.c
+ * 10/18/2026
+ * Times loading many small files and a few huge ones through IoService.
+ * ====================
+ */
+
+/*
+ * The files are written to the directory given as the first argument, or
+ * the current one, and removed again afterwards.  Every backend available
+ * here loads the same set, next to the synchronous membuf_load_file loop
+ * that asset loading used to be.  Warm runs read from the page cache; on
+ * Linux the cold runs drop each file from it first, which is close to a
+ * first launch without needing to be root.
+ */
+
+#include <inttypes.h>
+#include <string.h>
+
+#include <miur/io.h>
+#include <miur/job.h>
+#include <miur/mem.h>
+#include <miur/membuf.h>
+
+#include "test.h"
+
+#define IO_BENCH_SMALL_COUNT 10000
+#define IO_BENCH_SMALL_MIN (1 << 10)
+#define IO_BENCH_SMALL_MAX (16 << 10)
+#define IO_BENCH_HUGE_COUNT 4
+#define IO_BENCH_HUGE_SIZE (256 << 20)
+#define IO_BENCH_RUNS 3
+#define IO_BENCH_SEED 0x696F62656E6368ULL
+#define IO_BENCH_PATH_SIZE 1024
+
+typedef struct
+{
+  char **paths;
+  size_t *sizes;
+  size_t count;
+  uint64_t total_size;
+} IoBenchSet;
+
+typedef enum
+{
+  IO_BENCH_SYNC,
+  IO_BENCH_THREADS,
+  IO_BENCH_URING,
+  IO_BENCH_IOCP,
+  IO_BENCH_URING_DIRECT,
+  IO_BENCH_MODE_COUNT,
+} IoBenchMode;
+
+/* === PROTOTYPES === */
+
+static bool create_set(IoBenchSet *set, const char *dir, const char *prefix,
+                       size_t count, size_t min_size, size_t max_size,
+                       TestRng *rng);
+static void destroy_set(IoBenchSet *set);
+static void bench_set(const char *set_name, IoBenchSet *set,
+                      JobSystem *jobs);
+static uint64_t load_set(IoBenchSet *set, IoBenchMode mode, IoService *io,
+                         JobSystem *jobs, bool cold);
+
+/* === GLOBALS === */
+
+static const char *const mode_names[IO_BENCH_MODE_COUNT] = {
+  "sync", "threads", "uring", "iocp", "uring direct",
+};
+
+static const IoBackend mode_backends[IO_BENCH_MODE_COUNT] = {
+  IO_BACKEND_AUTO, IO_BACKEND_THREADS, IO_BACKEND_URING, IO_BACKEND_IOCP,
+  IO_BACKEND_URING,
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(int argc, char **argv)
+{
+  const char *dir = argc > 1 ? argv[1] : ".";
+  TestRng rng = test_rng(IO_BENCH_SEED);
+  JobSystem *jobs = job_system_create(0);
+  if (!TEST_CHECK(jobs != NULL))
+  {
+    return test_result();
+  }
+
+  IoBenchSet small = { 0 }, huge = { 0 };
+  if (TEST_CHECK(create_set(&small, dir, "small", IO_BENCH_SMALL_COUNT,
+                            IO_BENCH_SMALL_MIN, IO_BENCH_SMALL_MAX, &rng)))
+  {
+    bench_set("small", &small, jobs);
+  }
+  destroy_set(&small);
+
+  if (TEST_CHECK(create_set(&huge, dir, "huge", IO_BENCH_HUGE_COUNT,
+                            IO_BENCH_HUGE_SIZE, IO_BENCH_HUGE_SIZE, &rng)))
+  {
+    bench_set("huge", &huge, jobs);
+  }
+  destroy_set(&huge);
+
+  job_system_destroy(jobs);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static bool create_set(IoBenchSet *set, const char *dir, const char *prefix,
+                       size_t count, size_t min_size, size_t max_size,
+                       TestRng *rng)
+{
+  set->paths = MIUR_ARR(char *, count);
+  set->sizes = MIUR_ARR(size_t, count);
+  uint8_t *data = MIUR_ARR(uint8_t, max_size);
+  if (set->paths == NULL || set->sizes == NULL || data == NULL)
+  {
+    MIUR_FREE(data);
+    return false;
+  }
+  for (size_t i = 0; i < max_size; i += 8)
+  {
+    uint64_t value = test_rng_next(rng);
+    memcpy(data + i, &value, max_size - i < 8 ? max_size - i : 8);
+  }
+
+  bool ok = true;
+  for (size_t i = 0; i < count && ok; i++)
+  {
+    set->paths[i] = MIUR_ARR(char, IO_BENCH_PATH_SIZE);
+    if (set->paths[i] == NULL)
+    {
+      ok = false;
+      break;
+    }
+    snprintf(set->paths[i], IO_BENCH_PATH_SIZE, "%s/io-bench-%s-%05zu.bin",
+             dir, prefix, i);
+    set->sizes[i] = min_size +
+      test_rng_below(rng, (uint32_t) (max_size - min_size + 1));
+    set->count++;
+    set->total_size += set->sizes[i];
+
+    Membuf file = {
+      .data = data,
+      .size = set->sizes[i],
+      .kind = MEMBUF_VIEW,
+    };
+    ok = membuf_write_file(file, set->paths[i]);
+  }
+
+  MIUR_FREE(data);
+  return ok;
+}
+
+static void destroy_set(IoBenchSet *set)
+{
+  for (size_t i = 0; i < set->count; i++)
+  {
+    remove(set->paths[i]);
+    MIUR_FREE(set->paths[i]);
+  }
+  MIUR_FREE(set->paths);
+  MIUR_FREE(set->sizes);
+  memset(set, 0, sizeof(IoBenchSet));
+}
+
+static void bench_set(const char *set_name, IoBenchSet *set,
+                      JobSystem *jobs)
+{
+  printf("%s: %zu files, %" PRIu64 " MB\n", set_name, set->count,
+         set->total_size >> 20);
+  char name[64];
+  for (int mode = 0; mode < IO_BENCH_MODE_COUNT; mode++)
+  {
+    IoService *io = NULL;
+    if (mode != IO_BENCH_SYNC)
+    {
+      IoServiceDesc desc = {
+        .backend = mode_backends[mode],
+        .jobs = jobs,
+      };
+      io = io_service_create(&desc);
+      /* Unavailable backends fall back to the thread pool, skip those. */
+      if (io == NULL || io_service_backend(io) != mode_backends[mode])
+      {
+        if (io != NULL)
+        {
+          io_service_destroy(io);
+        }
+        continue;
+      }
+    }
+
+    for (int cold = 0; cold < 2; cold++)
+    {
+#ifndef __linux__
+      if (cold)
+      {
+        break;
+      }
+#endif
+      uint64_t best = UINT64_MAX;
+      for (int run = 0; run < IO_BENCH_RUNS; run++)
+      {
+        uint64_t time = load_set(set, (IoBenchMode) mode, io, jobs, cold);
+        best = time < best ? time : best;
+      }
+      snprintf(name, sizeof(name), "  %s %s", mode_names[mode],
+               cold ? "cold" : "warm");
+      test_bench_report(name, set->total_size, best);
+    }
+
+    if (io != NULL)
+    {
+      io_service_destroy(io);
+    }
+  }
+}
+
+/* Returns the time taken, checking every file arrived in full. */
+static uint64_t load_set(IoBenchSet *set, IoBenchMode mode, IoService *io,
+                         JobSystem *jobs, bool cold)
+{
+  if (cold)
+  {
+    for (size_t i = 0; i < set->count; i++)
+    {
+      test_drop_cached(set->paths[i]);
+    }
+  }
+
+  uint64_t bytes = 0, time = 0;
+  if (mode == IO_BENCH_SYNC)
+  {
+    uint64_t start = thread_time_ns();
+    for (size_t i = 0; i < set->count; i++)
+    {
+      Membuf file;
+      if (membuf_load_file(&file, set->paths[i]))
+      {
+        bytes += file.size;
+        membuf_destroy(&file);
+      }
+    }
+    time = thread_time_ns() - start;
+    TEST_CHECK(bytes == set->total_size);
+    return time;
+  }
+
+  IoRequest *reqs = MIUR_ARR(IoRequest, set->count);
+  if (!TEST_CHECK(reqs != NULL))
+  {
+    return 0;
+  }
+  JobCounter counter = { 0 };
+  for (size_t i = 0; i < set->count; i++)
+  {
+    io_request_init(&reqs[i], set->paths[i]);
+    reqs[i].counter = &counter;
+    reqs[i].flags = mode == IO_BENCH_URING_DIRECT ? IO_READ_DIRECT : 0;
+  }
+
+  uint64_t start = thread_time_ns();
+  io_submit(io, reqs, set->count);
+  job_wait(jobs, &counter);
+  time = thread_time_ns() - start;
+
+  for (size_t i = 0; i < set->count; i++)
+  {
+    TEST_CHECK(reqs[i].status == IO_DONE &&
+               reqs[i].bytes_read == set->sizes[i]);
+    io_request_release(&reqs[i]);
+  }
+  MIUR_FREE(reqs);
+  return time;
+}
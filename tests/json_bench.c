@@ -0,0 +1,173 @@
+/* =====================
+ * tests/json_bench.c
+ * 10/18/2026
+ * Times JSON string decoding and UTF-8 validation against the reference.
+ * ====================
+ */
+
+/*
+ * Strings are decoded back to back from one large buffer, so the numbers
+ * are the scans' throughput rather than the call overhead.  Plain ASCII is
+ * what glTF names and URIs mostly are, the other inputs keep the escape and
+ * multi-byte paths honest.
+ */
+
+#include <string.h>
+
+#include <miur/json.h>
+#include <miur/mem.h>
+#include <miur/utf8.h>
+
+#include "json_reference.h"
+#include "test.h"
+
+#define JSON_BENCH_SIZE (16 << 20)
+#define JSON_BENCH_RUNS 10
+#define JSON_BENCH_SEED 0x62656E6368ULL
+
+typedef struct
+{
+  const uint8_t *src;
+  uint8_t *dst;
+  size_t size;
+  bool ok;
+} JsonBench;
+
+typedef enum
+{
+  JSON_BENCH_ASCII,
+  JSON_BENCH_ESCAPED,
+  JSON_BENCH_MULTILINGUAL,
+  JSON_BENCH_COUNT,
+} JsonBenchInput;
+
+/* === PROTOTYPES === */
+
+static void fill_input(JsonBenchInput input, uint8_t *out, size_t size);
+static void run(const char *name, TestBenchFunction function,
+                JsonBench *bench);
+static void bench_unescape(void *ud);
+static void bench_reference_unescape(void *ud);
+static void bench_validate(void *ud);
+static void bench_reference_validate(void *ud);
+
+/* === GLOBALS === */
+
+static const char *const input_names[JSON_BENCH_COUNT] = {
+  "ascii", "escaped", "multilingual",
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(void)
+{
+  uint8_t *src = MIUR_ARR(uint8_t, JSON_BENCH_SIZE);
+  uint8_t *dst = MIUR_ARR(uint8_t, JSON_BENCH_SIZE);
+  char name[64];
+  for (int input = 0; input < JSON_BENCH_COUNT; input++)
+  {
+    fill_input((JsonBenchInput) input, src, JSON_BENCH_SIZE);
+    JsonBench bench = { src, dst, JSON_BENCH_SIZE, true };
+
+    snprintf(name, sizeof(name), "unescape %s", input_names[input]);
+    run(name, bench_unescape, &bench);
+    snprintf(name, sizeof(name), "reference unescape %s",
+             input_names[input]);
+    run(name, bench_reference_unescape, &bench);
+
+    snprintf(name, sizeof(name), "validate %s", input_names[input]);
+    run(name, bench_validate, &bench);
+    snprintf(name, sizeof(name), "reference validate %s",
+             input_names[input]);
+    run(name, bench_reference_validate, &bench);
+  }
+  MIUR_FREE(src);
+  MIUR_FREE(dst);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/*
+ * Every input is valid, so neither side stops early.  Escapes come about
+ * once every 32 characters and a quarter of the multilingual characters
+ * take more than a byte.
+ */
+static void fill_input(JsonBenchInput input, uint8_t *out, size_t size)
+{
+  static const char *const escaped[] = {
+    "\\n", "\\\"", "\\\\", "\\/", "\\u00e9", "\\ud83d\\ude00",
+  };
+  static const char *const multilingual[] = {
+    "\xC3\xA9", "\xE6\x97\xA5", "\xD0\xB6", "\xF0\x9F\x98\x80",
+  };
+
+  TestRng rng = test_rng(JSON_BENCH_SEED);
+  size_t i = 0;
+  while (i + 16 < size)
+  {
+    uint32_t roll = test_rng_below(&rng, 32);
+    const char *piece = NULL;
+    if (input == JSON_BENCH_ESCAPED && roll < 1)
+    {
+      piece = escaped[test_rng_below(&rng, sizeof(escaped) /
+                                     sizeof(escaped[0]))];
+    }
+    else if (input == JSON_BENCH_MULTILINGUAL && roll < 8)
+    {
+      piece = multilingual[test_rng_below(&rng, sizeof(multilingual) /
+                                          sizeof(multilingual[0]))];
+    }
+
+    if (piece != NULL)
+    {
+      size_t len = strlen(piece);
+      memcpy(out + i, piece, len);
+      i += len;
+    }
+    else
+    {
+      out[i++] = (uint8_t) ('a' + test_rng_below(&rng, 26));
+    }
+  }
+  while (i < size)
+  {
+    out[i++] = 'a';
+  }
+}
+
+static void run(const char *name, TestBenchFunction function,
+                JsonBench *bench)
+{
+  bench->ok = true;
+  uint64_t time = test_bench_best_ns(function, bench, JSON_BENCH_RUNS);
+  TEST_CHECK(bench->ok);
+  test_bench_report(name, bench->size, time);
+}
+
+static void bench_unescape(void *ud)
+{
+  JsonBench *bench = ud;
+  size_t dst_size;
+  bench->ok &= json_unescape(bench->src, bench->size, bench->dst, &dst_size);
+}
+
+static void bench_reference_unescape(void *ud)
+{
+  JsonBench *bench = ud;
+  size_t dst_size;
+  bench->ok &= reference_unescape(bench->src, bench->size, bench->dst,
+                                  &dst_size);
+}
+
+static void bench_validate(void *ud)
+{
+  JsonBench *bench = ud;
+  bench->ok &= utf8_validate(bench->src, bench->size);
+}
+
+static void bench_reference_validate(void *ud)
+{
+  JsonBench *bench = ud;
+  bench->ok &= reference_utf8_validate(bench->src, bench->size);
+}
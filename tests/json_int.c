@@ -0,0 +1,94 @@
+/* =====================
+ * tests/json_int.c
+ * 10/18/2026
+ * Checks json_decode_int at and past the range of int.
+ * ====================
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#include <miur/json_schema.h>
+
+#include "test.h"
+
+typedef struct
+{
+  const char *src;
+  bool ok;
+  int expected;
+} JsonIntCase;
+
+/* === PROTOTYPES === */
+
+static void check_case(const JsonIntCase *test);
+
+/* === GLOBALS === */
+
+static const JsonIntCase cases[] = {
+  { "0", true, 0 },
+  { "-0", true, 0 },
+  { "42", true, 42 },
+  { "-42", true, -42 },
+  { "2147483647", true, INT_MAX },
+  { "-2147483648", true, INT_MIN },
+  { "0002147483647", true, INT_MAX },
+  { "2147483648", false, 0 },
+  { "-2147483649", false, 0 },
+  { "4294967296", false, 0 },
+  { "99999999999999999999999999", false, 0 },
+  { "-99999999999999999999999999", false, 0 },
+  { "1.5", false, 0 },
+  { "1e3", false, 0 },
+  { "-", false, 0 },
+  { "\"1\"", false, 0 },
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(void)
+{
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+  {
+    check_case(&cases[i]);
+  }
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void check_case(const JsonIntCase *test)
+{
+  char document[64];
+  int size = snprintf(document, sizeof(document), "[%s]", test->src);
+  Membuf buf = {
+    .data = (uint8_t *) document,
+    .size = (size_t) size,
+    .kind = MEMBUF_VIEW,
+  };
+
+  JsonStream stream;
+  if (!json_stream_init(&stream, buf))
+  {
+    /* Only the malformed numbers may fail to tokenize. */
+    TEST_CHECK(!test->ok);
+    json_stream_deinit(&stream);
+    return;
+  }
+  JSON_NEXT(&stream);
+
+  ParseError error;
+  JsonDecoder dec;
+  json_decoder_init(&dec, &stream, NULL, &error);
+  int value = -1;
+  bool ok = json_decode_int(&dec, &value);
+  if (!TEST_CHECK(ok == test->ok))
+  {
+    fprintf(stderr, "  input: %s\n", test->src);
+  }
+  else if (ok)
+  {
+    TEST_CHECK(value == test->expected);
+  }
+  json_stream_deinit(&stream);
+}
@@ -0,0 +1,183 @@
+/* =====================
+ * tests/json_reference.h
+ * 10/18/2026
+ * Byte at a time JSON string decoding, what the SIMD paths are checked and
+ * timed against.
+ * ====================
+ */
+
+#ifndef MIUR_TEST_JSON_REFERENCE_H
+#define MIUR_TEST_JSON_REFERENCE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* === PROTOTYPES === */
+
+static inline bool reference_utf8_validate(const uint8_t *data, size_t size);
+static inline bool reference_unescape(const uint8_t *src, size_t size,
+                                      uint8_t *dst, size_t *dst_size);
+static inline int32_t reference_hex4(const uint8_t *src, size_t size);
+static inline size_t reference_encode(uint32_t codepoint, uint8_t *out);
+
+/* === PUBLIC FUNCTIONS === */
+
+/* Decodes each sequence to its code point and checks the range. */
+static inline bool reference_utf8_validate(const uint8_t *data, size_t size)
+{
+  size_t i = 0;
+  while (i < size)
+  {
+    uint8_t lead = data[i];
+    size_t len;
+    uint32_t codepoint, min;
+    if (lead < 0x80)
+    {
+      i++;
+      continue;
+    }
+    else if ((lead & 0xE0) == 0xC0)
+    {
+      len = 2;
+      codepoint = lead & 0x1F;
+      min = 0x80;
+    }
+    else if ((lead & 0xF0) == 0xE0)
+    {
+      len = 3;
+      codepoint = lead & 0x0F;
+      min = 0x800;
+    }
+    else if ((lead & 0xF8) == 0xF0)
+    {
+      len = 4;
+      codepoint = lead & 0x07;
+      min = 0x10000;
+    }
+    else
+    {
+      return false;
+    }
+
+    if (i + len > size)
+    {
+      return false;
+    }
+    for (size_t j = 1; j < len; j++)
+    {
+      if ((data[i + j] & 0xC0) != 0x80)
+      {
+        return false;
+      }
+      codepoint = codepoint << 6 | (data[i + j] & 0x3F);
+    }
+    if (codepoint < min || codepoint > 0x10FFFF ||
+        (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+    {
+      return false;
+    }
+    i += len;
+  }
+  return true;
+}
+
+static inline bool reference_unescape(const uint8_t *src, size_t size,
+                                      uint8_t *dst, size_t *dst_size)
+{
+  size_t i = 0, written = 0;
+  while (i < size)
+  {
+    uint8_t c = src[i++];
+    if (c < 0x20)
+    {
+      return false;
+    }
+    if (c != '\\')
+    {
+      dst[written++] = c;
+      continue;
+    }
+    if (i >= size)
+    {
+      return false;
+    }
+
+    c = src[i++];
+    const char *simple = strchr("\"\\/bfnrt", c);
+    if (c != '\0' && simple != NULL)
+    {
+      dst[written++] = (uint8_t) "\"\\/\b\f\n\r\t"[simple - "\"\\/bfnrt"];
+      continue;
+    }
+    if (c != 'u')
+    {
+      return false;
+    }
+
+    int32_t unit = reference_hex4(src + i, size - i);
+    if (unit < 0 || (unit >= 0xDC00 && unit <= 0xDFFF))
+    {
+      return false;
+    }
+    i += 4;
+    uint32_t codepoint = (uint32_t) unit;
+    if (unit >= 0xD800 && unit <= 0xDBFF)
+    {
+      if (size - i < 6 || src[i] != '\\' || src[i + 1] != 'u')
+      {
+        return false;
+      }
+      int32_t low = reference_hex4(src + i + 2, size - i - 2);
+      if (low < 0xDC00 || low > 0xDFFF)
+      {
+        return false;
+      }
+      i += 6;
+      codepoint = 0x10000 + ((uint32_t) (unit - 0xD800) << 10) +
+        (uint32_t) (low - 0xDC00);
+    }
+    written += reference_encode(codepoint, dst + written);
+  }
+  *dst_size = written;
+  return reference_utf8_validate(dst, written);
+}
+
+static inline int32_t reference_hex4(const uint8_t *src, size_t size)
+{
+  if (size < 4)
+  {
+    return -1;
+  }
+  int32_t value = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    uint8_t c = src[i];
+    int32_t digit = c >= '0' && c <= '9' ? c - '0' :
+      c >= 'a' && c <= 'f' ? c - 'a' + 10 :
+      c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+    if (digit < 0)
+    {
+      return -1;
+    }
+    value = value << 4 | digit;
+  }
+  return value;
+}
+
+static inline size_t reference_encode(uint32_t codepoint, uint8_t *out)
+{
+  size_t len = codepoint < 0x80 ? 1 : codepoint < 0x800 ? 2 :
+    codepoint < 0x10000 ? 3 : 4;
+  static const uint8_t leads[] = { 0x00, 0x00, 0xC0, 0xE0, 0xF0 };
+  for (size_t i = len - 1; i > 0; i--)
+  {
+    out[i] = (uint8_t) (0x80 | (codepoint & 0x3F));
+    codepoint >>= 6;
+  }
+  out[0] = (uint8_t) (leads[len] | codepoint);
+  return len;
+}
+
+#endif
@@ -0,0 +1,373 @@
+/* =====================
+ * tests/json_string.c
+ * 10/18/2026
+ * Checks JSON string decoding and UTF-8 validation against a reference.
+ * ====================
+ */
+
+/*
+ * The reference decoder in json_reference.h goes a byte at a time and
+ * decodes every UTF-8 sequence to its code point, nothing like the SIMD
+ * scans it checks.
+ * Hand written cases cover each escape and each way UTF-8 can be invalid,
+ * then random strings built from the same pieces, and random bytes, are
+ * compared against it with the special bytes at every offset of a vector.
+ */
+
+#include <string.h>
+
+#include <miur/arena.h>
+#include <miur/json.h>
+#include <miur/utf8.h>
+
+#include "json_reference.h"
+#include "test.h"
+
+#define JSON_STRING_MAX 512
+#define JSON_STRING_FUZZ_COUNT 200000
+#define JSON_STRING_FUZZ_SEED 0x6A736F6EULL
+
+typedef struct
+{
+  const char *src;
+  const char *expected;        /* NULL when decoding must fail. */
+  size_t expected_size;        /* For outputs holding NUL. */
+} JsonStringCase;
+
+/* === PROTOTYPES === */
+
+static void check_case(const uint8_t *src, size_t size);
+static void check_decode_string(const uint8_t *src, size_t size);
+static size_t random_string(TestRng *rng, uint8_t *out);
+static void check_cases(void);
+static void check_offsets(void);
+static void check_random_strings(void);
+static void check_random_bytes(void);
+
+/* === GLOBALS === */
+
+static const JsonStringCase cases[] = {
+  { "", "", 0 },
+  { "plain ascii", "plain ascii", 0 },
+  { "\\\"\\\\\\/\\b\\f\\n\\r\\t", "\"\\/\b\f\n\r\t", 0 },
+  { "a\\u0000b", "a\0b", 3 },
+  { "\\u0041\\u00e9\\u00E9", "A\xC3\xA9\xC3\xA9", 0 },
+  { "\\u20AC", "\xE2\x82\xAC", 0 },
+  { "\\uFFFF", "\xEF\xBF\xBF", 0 },
+  { "\\ud83d\\ude00", "\xF0\x9F\x98\x80", 0 },
+  { "\\uDBFF\\uDFFF", "\xF4\x8F\xBF\xBF", 0 },
+  { "caf\xC3\xA9 \\n na\xC3\xAFve", "caf\xC3\xA9 \n na\xC3\xAFve", 0 },
+  { "\xF0\x9F\x98\x80", "\xF0\x9F\x98\x80", 0 },
+  /* Escapes */
+  { "\\", NULL, 0 },
+  { "\\x", NULL, 0 },
+  { "\\'", NULL, 0 },
+  { "\\u12", NULL, 0 },
+  { "\\u12G4", NULL, 0 },
+  /* Surrogates must pair, high then low. */
+  { "\\ud83d", NULL, 0 },
+  { "\\ud83dx", NULL, 0 },
+  { "\\ud83d\\n", NULL, 0 },
+  { "\\ud83d\\u0041", NULL, 0 },
+  { "\\ud83d\\ud83d", NULL, 0 },
+  { "\\ude00", NULL, 0 },
+  { "\\ude00\\ud83d", NULL, 0 },
+  /* Unescaped control characters */
+  { "a\x01" "b", NULL, 0 },
+  { "tab\there", NULL, 0 },
+  { "\x1F", NULL, 0 },
+  /* UTF-8: stray, missing and bad continuations */
+  { "\x80", NULL, 0 },
+  { "\xBF", NULL, 0 },
+  { "\xC3", NULL, 0 },
+  { "\xC3x", NULL, 0 },
+  { "\xE2\x82", NULL, 0 },
+  { "\xF0\x9F\x98", NULL, 0 },
+  /* Overlong encodings */
+  { "\xC0\x80", NULL, 0 },
+  { "\xC1\xBF", NULL, 0 },
+  { "\xE0\x9F\xBF", NULL, 0 },
+  { "\xF0\x8F\xBF\xBF", NULL, 0 },
+  /* UTF-16 surrogates and what's above U+10FFFF */
+  { "\xED\xA0\x80", NULL, 0 },
+  { "\xED\xBF\xBF", NULL, 0 },
+  { "\xF4\x90\x80\x80", NULL, 0 },
+  { "\xF5\x80\x80\x80", NULL, 0 },
+  { "\xFF", NULL, 0 },
+  /* Valid bytes around an escape may still be invalid after it. */
+  { "\\n\xC3", NULL, 0 },
+};
+
+static const char *const escapes[] = {
+  "\\\"", "\\\\", "\\/", "\\b", "\\f", "\\n", "\\r", "\\t",
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(void)
+{
+  check_cases();
+  check_offsets();
+  check_random_strings();
+  check_random_bytes();
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void check_cases(void)
+{
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+  {
+    const JsonStringCase *c = &cases[i];
+    const uint8_t *src = (const uint8_t *) c->src;
+    size_t size = strlen(c->src);
+    uint8_t reference[JSON_STRING_MAX];
+    size_t reference_size = 0;
+    bool reference_ok = reference_unescape(src, size, reference,
+                                           &reference_size);
+
+    /* The reference is checked too, the rest relies on it. */
+    if (!TEST_CHECK(reference_ok == (c->expected != NULL)))
+    {
+      fprintf(stderr, "  case %zu: '%s'\n", i, c->src);
+      continue;
+    }
+    if (c->expected != NULL)
+    {
+      size_t expected_size = c->expected_size > 0 ? c->expected_size :
+        strlen(c->expected);
+      TEST_CHECK(reference_size == expected_size &&
+                 memcmp(reference, c->expected, expected_size) == 0);
+    }
+    check_case(src, size);
+  }
+}
+
+/*
+ * Every special byte and invalid sequence at every offset of the first two
+ * vectors, so both the SIMD scans and their scalar tails meet them.
+ */
+static void check_offsets(void)
+{
+  static const char *const specials[] = {
+    "\\n", "\\u00e9", "\\ud83d\\ude00", "\x01", "\\", "\xC3\xA9", "\xC3",
+    "\xED\xA0\x80", "\xF0\x9F\x98\x80", "\x80",
+  };
+  for (size_t s = 0; s < sizeof(specials) / sizeof(specials[0]); s++)
+  {
+    size_t special_size = strlen(specials[s]);
+    for (size_t offset = 0; offset < 40; offset++)
+    {
+      for (size_t tail = 0; tail < 20; tail += 3)
+      {
+        uint8_t src[JSON_STRING_MAX];
+        memset(src, 'a', offset);
+        memcpy(src + offset, specials[s], special_size);
+        memset(src + offset + special_size, 'z', tail);
+        check_case(src, offset + special_size + tail);
+      }
+    }
+  }
+}
+
+static void check_random_strings(void)
+{
+  TestRng rng = test_rng(JSON_STRING_FUZZ_SEED);
+  for (int i = 0; i < JSON_STRING_FUZZ_COUNT; i++)
+  {
+    uint8_t src[JSON_STRING_MAX];
+    size_t size = random_string(&rng, src);
+    check_case(src, size);
+  }
+}
+
+/* Mostly high bytes, where almost every way UTF-8 can go wrong lives. */
+static void check_random_bytes(void)
+{
+  TestRng rng = test_rng(JSON_STRING_FUZZ_SEED + 1);
+  for (int i = 0; i < JSON_STRING_FUZZ_COUNT; i++)
+  {
+    uint8_t data[64];
+    size_t size = test_rng_below(&rng, sizeof(data) + 1);
+    for (size_t j = 0; j < size; j++)
+    {
+      uint32_t r = test_rng_below(&rng, 8);
+      data[j] = r < 3 ? (uint8_t) (0x20 + test_rng_below(&rng, 0x60)) :
+        r < 6 ? (uint8_t) (0x80 + test_rng_below(&rng, 0x40)) :
+        (uint8_t) (0xC0 + test_rng_below(&rng, 0x40));
+    }
+    if (!TEST_CHECK(utf8_validate(data, size) ==
+                    reference_utf8_validate(data, size)))
+    {
+      return;
+    }
+  }
+}
+
+/* Compares json_unescape and json_decode_string with the reference. */
+static void check_case(const uint8_t *src, size_t size)
+{
+  uint8_t expected[JSON_STRING_MAX];
+  size_t expected_size = 0;
+  bool expected_ok = reference_unescape(src, size, expected, &expected_size);
+
+  uint8_t decoded[JSON_STRING_MAX];
+  size_t decoded_size = 0;
+  bool decoded_ok = json_unescape(src, size, decoded, &decoded_size);
+  if (!TEST_CHECK(decoded_ok == expected_ok) ||
+      (expected_ok && !TEST_CHECK(decoded_size == expected_size &&
+                                  memcmp(decoded, expected,
+                                         expected_size) == 0)))
+  {
+    fprintf(stderr, "  input of %zu bytes:", size);
+    for (size_t i = 0; i < size; i++)
+    {
+      fprintf(stderr, " %02x", src[i]);
+    }
+    fprintf(stderr, "\n");
+    return;
+  }
+  if (expected_ok)
+  {
+    check_decode_string(src, size);
+  }
+}
+
+/*
+ * As the loaders see strings: tokenized out of a document, then decoded in
+ * place when there's nothing to unescape or into the arena otherwise.
+ */
+static void check_decode_string(const uint8_t *src, size_t size)
+{
+  uint8_t document[JSON_STRING_MAX + 4];
+  document[0] = '[';
+  document[1] = '"';
+  memcpy(document + 2, src, size);
+  document[size + 2] = '"';
+  document[size + 3] = ']';
+  Membuf buf = {
+    .data = document,
+    .size = size + 4,
+    .kind = MEMBUF_VIEW,
+  };
+
+  JsonStream stream;
+  if (!TEST_CHECK(json_stream_init(&stream, buf)))
+  {
+    json_stream_deinit(&stream);
+    return;
+  }
+  JSON_NEXT(&stream);
+  JsonTok tok = JSON_NEXT(&stream);
+
+  Arena arena;
+  arena_create(&arena, 0);
+  uint8_t expected[JSON_STRING_MAX];
+  size_t expected_size = 0;
+  reference_unescape(src, size, expected, &expected_size);
+  String out;
+  if (TEST_CHECK(tok.type == JSON_STRING) &&
+      TEST_CHECK(json_decode_string(&stream, tok, &arena, &out)))
+  {
+    TEST_CHECK(out.size == expected_size &&
+               memcmp(out.data, expected, expected_size) == 0);
+    bool in_place = out.data == document + 2;
+    TEST_CHECK(in_place == (memchr(src, '\\', size) == NULL));
+  }
+  arena_destroy(&arena);
+  json_stream_deinit(&stream);
+}
+
+/*
+ * Pieces the decoder treats differently: plain runs long enough to cross
+ * vectors, escapes, valid and broken \u sequences, valid UTF-8 and bytes
+ * that are usually not.
+ */
+static size_t random_string(TestRng *rng, uint8_t *out)
+{
+  size_t size = 0;
+  uint32_t pieces = test_rng_below(rng, 12);
+  for (uint32_t p = 0; p < pieces && size + 40 < JSON_STRING_MAX; p++)
+  {
+    switch (test_rng_below(rng, 10))
+    {
+    case 0:
+    case 1:
+    case 2: {
+      uint32_t run = test_rng_below(rng, 40);
+      for (uint32_t i = 0; i < run; i++)
+      {
+        uint8_t c = (uint8_t) (0x20 + test_rng_below(rng, 0x5F));
+        out[size++] = c == '\\' || c == '"' ? 'x' : c;
+      }
+      break;
+    }
+    case 3: {
+      const char *escape = escapes[test_rng_below(rng, 8)];
+      memcpy(out + size, escape, 2);
+      size += 2;
+      break;
+    }
+    case 4: {
+      /* Any four hex digits, surrogates included. */
+      static const char hex[] = "0123456789abcdefABCDEF";
+      uint32_t codepoint = test_rng_below(rng, 0x10000);
+      out[size++] = '\\';
+      out[size++] = 'u';
+      for (int shift = 12; shift >= 0; shift -= 4)
+      {
+        uint32_t digit = (codepoint >> shift) & 0xF;
+        out[size++] = (uint8_t) hex[digit >= 10 && test_rng_below(rng, 2) ?
+                                    digit + 6 : digit];
+      }
+      break;
+    }
+    case 5: {
+      uint32_t codepoint = 0x10000 + test_rng_below(rng, 0x100000);
+      size += (size_t) sprintf((char *) out + size, "\\u%04x\\u%04x",
+                               0xD800 + ((codepoint - 0x10000) >> 10),
+                               0xDC00 + ((codepoint - 0x10000) & 0x3FF));
+      break;
+    }
+    case 6:
+    case 7: {
+      uint32_t codepoint = test_rng_below(rng, 0x110000);
+      if (codepoint >= 0x20 && (codepoint < 0xD800 || codepoint > 0xDFFF) &&
+          codepoint != '\\' && codepoint != '"')
+      {
+        size += reference_encode(codepoint, out + size);
+      }
+      break;
+    }
+    case 8:
+      out[size++] = (uint8_t) test_rng_below(rng, 0x100);
+      break;
+    case 9: {
+      static const char *const broken[] = {
+        "\\", "\\x", "\\u", "\\u12", "\\uZZZZ", "\\ud800", "\\udc00",
+      };
+      const char *piece = broken[test_rng_below(rng, 7)];
+      memcpy(out + size, piece, strlen(piece));
+      size += strlen(piece);
+      break;
+    }
+    }
+  }
+  /*
+   * A raw quote would end the string, the tokenizer never passes one.
+   * Pieces can join into one, e.g. a lone backslash and an escaped quote.
+   */
+  for (size_t i = 0; i < size; i++)
+  {
+    if (out[i] == '\\')
+    {
+      i++;
+    }
+    else if (out[i] == '"')
+    {
+      out[i] = '\'';
+    }
+  }
+  return size;
+}
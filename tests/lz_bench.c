@@ -0,0 +1,268 @@
+/* =====================
+ * tests/lz_bench.c
+ * 10/18/2026
+ * Measures archive compression ratio and throughput on mesh buffers.
+ * ====================
+ */
+
+/*
+ * Each input is packed into an archive the way miur-pack does it for the
+ * ratio, then read back through archive_read on one thread and on the job
+ * system, so decoding includes the block splitting and parallel decode.
+ * Every timing covers at least 64 MB, repeating the tiny shipped buffers,
+ * which are read from the directory given as the first argument or
+ * "assets".  The synthetic meshes are interleaved position, normal and uv
+ * vertices with u32 indices, one smooth grid and one with noise in every
+ * vertex.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <miur/archive.h>
+#include <miur/job.h>
+#include <miur/lz.h>
+#include <miur/mem.h>
+#include <miur/membuf.h>
+
+#include "test.h"
+
+#define LZ_BENCH_GRID_SIZE 1024
+#define LZ_BENCH_RUNS 5
+#define LZ_BENCH_MIN_BYTES (64 << 20)
+#define LZ_BENCH_SEED 0x6C7A62656E6368ULL
+#define LZ_BENCH_ARCHIVE "lz-bench.pak"
+#define LZ_BENCH_PATH_SIZE 1024
+
+typedef struct
+{
+  float position[3];
+  float normal[3];
+  float uv[2];
+} LzBenchVertex;
+
+typedef struct
+{
+  Membuf data;
+  uint8_t *dst;
+  size_t capacity;
+  uint32_t reps;
+  bool ok;
+} LzBenchCompress;
+
+typedef struct
+{
+  const Archive *archive;
+  const ArchiveEntry *entry;
+  uint8_t *dst;
+  JobSystem *jobs;
+  uint32_t reps;
+  bool ok;
+} LzBenchRead;
+
+/* === PROTOTYPES === */
+
+static void bench_input(const char *name, Membuf data, JobSystem *jobs);
+static bool create_grid(Membuf *out, float noise, TestRng *rng);
+static void bench_compress(void *ud);
+static void bench_read(void *ud);
+
+/* === GLOBALS === */
+
+static const char *const asset_names[] = {
+  "cube.bin", "funny-cube.bin", "plane.bin",
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(int argc, char **argv)
+{
+  const char *dir = argc > 1 ? argv[1] : "assets";
+  JobSystem *jobs = job_system_create(0);
+  if (!TEST_CHECK(jobs != NULL))
+  {
+    return test_result();
+  }
+  printf("%-24s %10s %8s %13s %13s %13s\n", "input", "size", "ratio",
+         "compress", "decode", "decode jobs");
+
+  char path[LZ_BENCH_PATH_SIZE];
+  for (size_t i = 0; i < sizeof(asset_names) / sizeof(asset_names[0]); i++)
+  {
+    snprintf(path, sizeof(path), "%s/%s", dir, asset_names[i]);
+    Membuf data;
+    if (TEST_CHECK(membuf_load_file(&data, path)))
+    {
+      bench_input(asset_names[i], data, jobs);
+      membuf_destroy(&data);
+    }
+  }
+
+  TestRng rng = test_rng(LZ_BENCH_SEED);
+  Membuf grid;
+  if (TEST_CHECK(create_grid(&grid, 0.0f, &rng)))
+  {
+    bench_input("synthetic grid", grid, jobs);
+    membuf_destroy(&grid);
+  }
+  if (TEST_CHECK(create_grid(&grid, 1e-3f, &rng)))
+  {
+    bench_input("synthetic noisy grid", grid, jobs);
+    membuf_destroy(&grid);
+  }
+
+  remove(LZ_BENCH_ARCHIVE);
+  job_system_destroy(jobs);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void bench_input(const char *name, Membuf data, JobSystem *jobs)
+{
+  ArchiveInput input = {
+    .name = name,
+    .data = data,
+    .compress = true,
+  };
+  Archive archive;
+  if (!TEST_CHECK(archive_write(LZ_BENCH_ARCHIVE, &input, 1)) ||
+      !TEST_CHECK(archive_open(&archive, LZ_BENCH_ARCHIVE)))
+  {
+    return;
+  }
+  const ArchiveEntry *entry = archive_find_entry(&archive, name,
+                                                 strlen(name));
+  if (!TEST_CHECK(entry != NULL && entry->size == data.size))
+  {
+    archive_close(&archive);
+    return;
+  }
+
+  uint32_t reps = (uint32_t) (LZ_BENCH_MIN_BYTES / data.size + 1);
+  LzBenchCompress compress = {
+    .data = data,
+    .capacity = lz_compress_bound(ARCHIVE_BLOCK_SIZE),
+    .reps = reps,
+    .ok = true,
+  };
+  compress.dst = MIUR_ARR(uint8_t, compress.capacity);
+  uint64_t compress_time = test_bench_best_ns(bench_compress, &compress,
+                                              LZ_BENCH_RUNS);
+
+  LzBenchRead read = {
+    .archive = &archive,
+    .entry = entry,
+    .dst = MIUR_ARR(uint8_t, data.size),
+    .reps = reps,
+    .ok = true,
+  };
+  uint64_t decode_time = test_bench_best_ns(bench_read, &read,
+                                            LZ_BENCH_RUNS);
+  read.jobs = jobs;
+  uint64_t jobs_time = test_bench_best_ns(bench_read, &read, LZ_BENCH_RUNS);
+  TEST_CHECK(compress.ok && read.ok &&
+             memcmp(read.dst, data.data, data.size) == 0);
+
+  uint64_t bytes = (uint64_t) reps * data.size;
+  printf("%-24s %8.1f K %6.2f:1 %8.1f MB/s %8.1f MB/s %8.1f MB/s\n", name,
+         data.size / 1024.0, (double) data.size / entry->stored_size,
+         bytes * 1e3 / compress_time, bytes * 1e3 / decode_time,
+         bytes * 1e3 / jobs_time);
+
+  MIUR_FREE(compress.dst);
+  MIUR_FREE(read.dst);
+  archive_close(&archive);
+}
+
+/* A rolling height field, `noise` jitters every attribute like a scan. */
+static bool create_grid(Membuf *out, float noise, TestRng *rng)
+{
+  const uint32_t n = LZ_BENCH_GRID_SIZE;
+  size_t vertex_size = (size_t) n * n * sizeof(LzBenchVertex);
+  size_t index_count = (size_t) (n - 1) * (n - 1) * 6;
+  uint8_t *data = MIUR_ARR(uint8_t, vertex_size +
+                           index_count * sizeof(uint32_t));
+  if (data == NULL)
+  {
+    return false;
+  }
+
+  LzBenchVertex *vertices = (LzBenchVertex *) data;
+  for (uint32_t y = 0; y < n; y++)
+  {
+    for (uint32_t x = 0; x < n; x++)
+    {
+      float u = (float) x / (n - 1), v = (float) y / (n - 1);
+      float h = 0.1f * sinf(u * 12.0f) * cosf(v * 9.0f);
+      float dx = 1.2f * cosf(u * 12.0f) * cosf(v * 9.0f);
+      float dy = -0.9f * sinf(u * 12.0f) * sinf(v * 9.0f);
+      float len = sqrtf(dx * dx + dy * dy + 1.0f);
+      LzBenchVertex *vertex = &vertices[y * n + x];
+      *vertex = (LzBenchVertex) {
+        .position = { u, h, v },
+        .normal = { -dx / len, 1.0f / len, -dy / len },
+        .uv = { u, v },
+      };
+      float *attributes = (float *) vertex;
+      for (size_t i = 0; noise > 0.0f && i < 8; i++)
+      {
+        attributes[i] += test_rng_float(rng, -noise, noise);
+      }
+    }
+  }
+
+  uint32_t *indices = (uint32_t *) (data + vertex_size);
+  for (uint32_t y = 0; y + 1 < n; y++)
+  {
+    for (uint32_t x = 0; x + 1 < n; x++)
+    {
+      uint32_t i = y * n + x;
+      uint32_t quad[6] = { i, i + n, i + 1, i + 1, i + n, i + n + 1 };
+      memcpy(indices, quad, sizeof(quad));
+      indices += 6;
+    }
+  }
+
+  out->data = data;
+  out->size = vertex_size + index_count * sizeof(uint32_t);
+  out->kind = MEMBUF_HEAP;
+  return true;
+}
+
+/* Block by block, as archive_write compresses entries. */
+static void bench_compress(void *ud)
+{
+  LzBenchCompress *compress = ud;
+  if (compress->dst == NULL)
+  {
+    compress->ok = false;
+    return;
+  }
+  for (uint32_t i = 0; i < compress->reps; i++)
+  {
+    for (size_t offset = 0; offset < compress->data.size;
+         offset += ARCHIVE_BLOCK_SIZE)
+    {
+      size_t size = compress->data.size - offset;
+      size = size < ARCHIVE_BLOCK_SIZE ? size : ARCHIVE_BLOCK_SIZE;
+      compress->ok &= lz_compress(compress->data.data + offset, size,
+                                  compress->dst, compress->capacity) > 0;
+    }
+  }
+}
+
+static void bench_read(void *ud)
+{
+  LzBenchRead *read = ud;
+  if (read->dst == NULL)
+  {
+    read->ok = false;
+    return;
+  }
+  for (uint32_t i = 0; i < read->reps; i++)
+  {
+    read->ok &= archive_read(read->archive, read->entry, read->dst,
+                             read->jobs);
+  }
+}
@@ -0,0 +1,437 @@
+/* =====================
+ * tests/mesh_codec_bench.c
+ * 10/18/2026
+ * Measures mesh codec ratio and decode throughput against LZ.
+ * ====================
+ */
+
+/*
+ * Every stream a mesh cache stores is encoded with mesh_codec.h and, for
+ * comparison, with the archive's LZ, then decoded until at least 64 MB came
+ * out.  The float streams are what the cache holds, the quantized ones are
+ * the same vertices in the formats vertex_format.h uploads.  Meshes are
+ * the bundled funny-cube, read from the directory given as the first
+ * argument or "assets", and a 512x512 height field in cooked order.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <miur/lz.h>
+#include <miur/mem.h>
+#include <miur/membuf.h>
+#include <miur/mesh_codec.h>
+#include <miur/mesh_opt.h>
+#include <miur/vertex_format.h>
+
+#include "test.h"
+
+/* Layout of assets/funny-cube.bin, see funny-cube.gltf. */
+#define FUNNY_CUBE_INDEX_COUNT 1512
+#define FUNNY_CUBE_VERTEX_COUNT 706
+#define FUNNY_CUBE_POSITION_OFFSET 3024
+#define FUNNY_CUBE_NORMAL_OFFSET 11496
+#define FUNNY_CUBE_UV_OFFSET 19968
+
+#define CODEC_BENCH_GRID_SIZE 512
+#define CODEC_BENCH_RUNS 5
+#define CODEC_BENCH_MIN_BYTES (64 << 20)
+#define CODEC_BENCH_SEED 0x636F646563ULL
+#define CODEC_BENCH_PATH_SIZE 1024
+
+typedef struct
+{
+  uint32_t *indices;
+  float *positions;
+  float *normals;
+  float *uvs;
+  size_t index_count;
+  size_t vertex_count;
+} BenchMesh;
+
+typedef struct
+{
+  const uint8_t *src;
+  size_t src_size;
+  uint8_t *dst;
+  size_t dst_size;
+  size_t count;                /* Indices or vertices. */
+  size_t stride;               /* 0 for indices. */
+  size_t vertex_count;
+  uint32_t reps;
+  bool lz;
+  bool ok;
+} CodecBenchDecode;
+
+/* === PROTOTYPES === */
+
+static void bench_mesh(const char *name, const BenchMesh *mesh);
+static void bench_stream(const char *name, const void *data, size_t count,
+                         size_t stride, size_t vertex_count);
+static size_t lz_encode_blocks(const uint8_t *src, size_t size,
+                               uint8_t *dst, size_t capacity);
+static void bench_decode(void *ud);
+static bool same_triangles(const uint32_t *a, const uint32_t *b,
+                           size_t index_count);
+static bool load_funny_cube(BenchMesh *mesh, const char *dir);
+static bool create_grid(BenchMesh *mesh, TestRng *rng);
+static bool alloc_mesh(BenchMesh *mesh, size_t index_count,
+                       size_t vertex_count);
+static void destroy_mesh(BenchMesh *mesh);
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(int argc, char **argv)
+{
+  const char *dir = argc > 1 ? argv[1] : "assets";
+  TestRng rng = test_rng(CODEC_BENCH_SEED);
+  printf("%-32s %9s %8s %11s %8s %11s\n", "stream", "raw", "codec",
+         "decode", "lz", "lz decode");
+
+  BenchMesh mesh;
+  if (TEST_CHECK(load_funny_cube(&mesh, dir)))
+  {
+    bench_mesh("funny-cube", &mesh);
+    destroy_mesh(&mesh);
+  }
+  if (TEST_CHECK(create_grid(&mesh, &rng)))
+  {
+    bench_mesh("grid", &mesh);
+    destroy_mesh(&mesh);
+  }
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void bench_mesh(const char *name, const BenchMesh *mesh)
+{
+  char stream[64];
+  size_t count = mesh->vertex_count;
+  snprintf(stream, sizeof(stream), "%s indices", name);
+  bench_stream(stream, mesh->indices, mesh->index_count, 0, count);
+  snprintf(stream, sizeof(stream), "%s positions f32", name);
+  bench_stream(stream, mesh->positions, count, 3 * sizeof(float), count);
+  snprintf(stream, sizeof(stream), "%s normals f32", name);
+  bench_stream(stream, mesh->normals, count, 3 * sizeof(float), count);
+  snprintf(stream, sizeof(stream), "%s uvs f32", name);
+  bench_stream(stream, mesh->uvs, count, 2 * sizeof(float), count);
+
+  static const char *const attribute_names[VERTEX_ATTRIBUTE_COUNT] = {
+    "positions", "normals", "uvs",
+  };
+  const float *sources[VERTEX_ATTRIBUTE_COUNT] = {
+    mesh->positions, mesh->normals, mesh->uvs,
+  };
+  VertexQuantization quant;
+  vertex_quantization_fit(&quant, mesh->positions, count);
+  for (int attr = 0; attr < VERTEX_ATTRIBUTE_COUNT; attr++)
+  {
+    uint32_t stride = vertex_attribute_size(VERTEX_FORMAT_QUANTIZED,
+                                            (VertexAttribute) attr);
+    uint8_t *quantized = MIUR_ARR(uint8_t, count * stride);
+    if (!TEST_CHECK(quantized != NULL))
+    {
+      continue;
+    }
+    vertex_attribute_write(quantized, stride, VERTEX_FORMAT_QUANTIZED,
+                           (VertexAttribute) attr, sources[attr], count,
+                           &quant);
+    snprintf(stream, sizeof(stream), "%s %s quantized", name,
+             attribute_names[attr]);
+    bench_stream(stream, quantized, count, stride, count);
+    MIUR_FREE(quantized);
+  }
+}
+
+static void bench_stream(const char *name, const void *data, size_t count,
+                         size_t stride, size_t vertex_count)
+{
+  size_t raw_size = stride > 0 ? count * stride : count * sizeof(uint32_t);
+  size_t capacity = stride > 0 ? mesh_vertex_encode_bound(count, stride) :
+    mesh_index_encode_bound(count);
+  size_t lz_capacity = lz_compress_bound(raw_size) + raw_size / 4096 + 64;
+  uint8_t *encoded = MIUR_ARR(uint8_t, capacity);
+  uint8_t *lz_encoded = MIUR_ARR(uint8_t, lz_capacity);
+  uint8_t *decoded = MIUR_ARR(uint8_t, raw_size);
+  if (!TEST_CHECK(encoded != NULL && lz_encoded != NULL && decoded != NULL))
+  {
+    goto cleanup;
+  }
+
+  size_t size = stride > 0 ?
+    mesh_vertex_encode(data, count, stride, encoded, capacity) :
+    mesh_index_encode(data, count, encoded, capacity);
+  size_t lz_size = lz_encode_blocks(data, raw_size, lz_encoded, lz_capacity);
+  if (!TEST_CHECK(size > 0 && lz_size > 0))
+  {
+    goto cleanup;
+  }
+
+  CodecBenchDecode decode = {
+    .src = encoded,
+    .src_size = size,
+    .dst = decoded,
+    .dst_size = raw_size,
+    .count = count,
+    .stride = stride,
+    .vertex_count = vertex_count,
+    .reps = (uint32_t) (CODEC_BENCH_MIN_BYTES / raw_size + 1),
+    .ok = true,
+  };
+  uint64_t time = test_bench_best_ns(bench_decode, &decode,
+                                     CODEC_BENCH_RUNS);
+  TEST_CHECK(decode.ok);
+  TEST_CHECK(stride > 0 ? memcmp(decoded, data, raw_size) == 0 :
+             same_triangles((const uint32_t *) decoded, data, count));
+
+  decode.src = lz_encoded;
+  decode.src_size = lz_size;
+  decode.lz = true;
+  uint64_t lz_time = test_bench_best_ns(bench_decode, &decode,
+                                        CODEC_BENCH_RUNS);
+  TEST_CHECK(decode.ok && memcmp(decoded, data, raw_size) == 0);
+
+  double bytes = (double) decode.reps * raw_size;
+  printf("%-32s %7.1f K %6.2f:1 %6.0f MB/s %6.2f:1 %6.0f MB/s\n", name,
+         raw_size / 1024.0, (double) raw_size / size, bytes * 1e3 / time,
+         (double) raw_size / lz_size, bytes * 1e3 / lz_time);
+
+cleanup:
+  MIUR_FREE(encoded);
+  MIUR_FREE(lz_encoded);
+  MIUR_FREE(decoded);
+}
+
+/*
+ * In archive sized blocks, each behind its compressed size, so both sides
+ * decode the same amount of data per call.
+ */
+static size_t lz_encode_blocks(const uint8_t *src, size_t size,
+                               uint8_t *dst, size_t capacity)
+{
+  const size_t block_size = 128 * 1024;
+  size_t written = 0;
+  for (size_t offset = 0; offset < size; offset += block_size)
+  {
+    size_t block = size - offset < block_size ? size - offset : block_size;
+    if (capacity - written < sizeof(uint32_t))
+    {
+      return 0;
+    }
+    size_t packed = lz_compress(src + offset, block,
+                                dst + written + sizeof(uint32_t),
+                                capacity - written - sizeof(uint32_t));
+    if (packed == 0)
+    {
+      return 0;
+    }
+    uint32_t packed32 = (uint32_t) packed;
+    memcpy(dst + written, &packed32, sizeof(uint32_t));
+    written += sizeof(uint32_t) + packed;
+  }
+  return written;
+}
+
+static void bench_decode(void *ud)
+{
+  CodecBenchDecode *decode = ud;
+  for (uint32_t r = 0; r < decode->reps; r++)
+  {
+    if (!decode->lz)
+    {
+      decode->ok &= decode->stride > 0 ?
+        mesh_vertex_decode(decode->src, decode->src_size, decode->dst,
+                           decode->count, decode->stride) :
+        mesh_index_decode(decode->src, decode->src_size,
+                          (uint32_t *) decode->dst, decode->count,
+                          decode->vertex_count);
+      continue;
+    }
+
+    const size_t block_size = 128 * 1024;
+    const uint8_t *src = decode->src;
+    for (size_t offset = 0; offset < decode->dst_size; offset += block_size)
+    {
+      size_t block = decode->dst_size - offset < block_size ?
+        decode->dst_size - offset : block_size;
+      uint32_t packed;
+      memcpy(&packed, src, sizeof(uint32_t));
+      decode->ok &= lz_decompress(src + sizeof(uint32_t), packed,
+                                  decode->dst + offset, block);
+      src += sizeof(uint32_t) + packed;
+    }
+  }
+}
+
+/* Decoded triangles may start at another corner, but keep their winding. */
+static bool same_triangles(const uint32_t *a, const uint32_t *b,
+                           size_t index_count)
+{
+  for (size_t t = 0; t < index_count; t += 3)
+  {
+    bool same = false;
+    for (int r = 0; r < 3 && !same; r++)
+    {
+      same = a[t] == b[t + r] && a[t + 1] == b[t + (r + 1) % 3] &&
+        a[t + 2] == b[t + (r + 2) % 3];
+    }
+    if (!same)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool load_funny_cube(BenchMesh *mesh, const char *dir)
+{
+  char path[CODEC_BENCH_PATH_SIZE];
+  snprintf(path, sizeof(path), "%s/funny-cube.bin", dir);
+  Membuf file;
+  if (!membuf_load_file(&file, path))
+  {
+    return false;
+  }
+  bool result = false;
+  size_t vec3_size = FUNNY_CUBE_VERTEX_COUNT * 3 * sizeof(float);
+  if (file.size < FUNNY_CUBE_UV_OFFSET +
+      FUNNY_CUBE_VERTEX_COUNT * 2 * sizeof(float) ||
+      !alloc_mesh(mesh, FUNNY_CUBE_INDEX_COUNT, FUNNY_CUBE_VERTEX_COUNT))
+  {
+    goto cleanup;
+  }
+
+  for (size_t i = 0; i < mesh->index_count; i++)
+  {
+    uint16_t index;
+    memcpy(&index, file.data + i * sizeof(uint16_t), sizeof(uint16_t));
+    mesh->indices[i] = index;
+  }
+  memcpy(mesh->positions, file.data + FUNNY_CUBE_POSITION_OFFSET, vec3_size);
+  memcpy(mesh->normals, file.data + FUNNY_CUBE_NORMAL_OFFSET, vec3_size);
+  memcpy(mesh->uvs, file.data + FUNNY_CUBE_UV_OFFSET,
+         FUNNY_CUBE_VERTEX_COUNT * 2 * sizeof(float));
+  result = true;
+
+cleanup:
+  membuf_destroy(&file);
+  return result;
+}
+
+/* A random height field, reordered by the cook's vertex cache passes. */
+static bool create_grid(BenchMesh *mesh, TestRng *rng)
+{
+  const uint32_t n = CODEC_BENCH_GRID_SIZE;
+  size_t index_count = (size_t) (n - 1) * (n - 1) * 6;
+  size_t vertex_count = (size_t) n * n;
+  if (!alloc_mesh(mesh, index_count, vertex_count))
+  {
+    return false;
+  }
+
+  float *heights = MIUR_ARR(float, vertex_count);
+  uint32_t *indices = MIUR_ARR(uint32_t, index_count);
+  uint32_t *remap = MIUR_ARR(uint32_t, vertex_count);
+  float *scratch = MIUR_ARR(float, vertex_count * 3);
+  bool result = false;
+  if (heights == NULL || indices == NULL || remap == NULL || scratch == NULL)
+  {
+    goto cleanup;
+  }
+
+  /* Smoothed noise, so normals vary like a terrain's. */
+  for (size_t i = 0; i < vertex_count; i++)
+  {
+    heights[i] = test_rng_float(rng, -1.0f, 1.0f);
+  }
+  for (uint32_t y = 0; y < n; y++)
+  {
+    for (uint32_t x = 0; x < n; x++)
+    {
+      size_t i = (size_t) y * n + x;
+      float h = heights[i] * 0.02f + 0.5f * sinf(x * 0.05f) *
+        cosf(y * 0.07f);
+      float dx = 0.025f * cosf(x * 0.05f) * cosf(y * 0.07f);
+      float dy = -0.035f * sinf(x * 0.05f) * sinf(y * 0.07f);
+      float len = sqrtf(dx * dx + dy * dy + 1.0f);
+      mesh->positions[i * 3] = (float) x;
+      mesh->positions[i * 3 + 1] = h;
+      mesh->positions[i * 3 + 2] = (float) y;
+      mesh->normals[i * 3] = -dx / len;
+      mesh->normals[i * 3 + 1] = 1.0f / len;
+      mesh->normals[i * 3 + 2] = -dy / len;
+      mesh->uvs[i * 2] = (float) x / (n - 1);
+      mesh->uvs[i * 2 + 1] = (float) y / (n - 1);
+    }
+  }
+  uint32_t *quad = indices;
+  for (uint32_t y = 0; y + 1 < n; y++)
+  {
+    for (uint32_t x = 0; x + 1 < n; x++)
+    {
+      uint32_t i = y * n + x;
+      uint32_t tris[6] = { i, i + n, i + 1, i + 1, i + n, i + n + 1 };
+      memcpy(quad, tris, sizeof(tris));
+      quad += 6;
+    }
+  }
+
+  if (!mesh_optimize_vertex_cache(mesh->indices, indices, index_count,
+                                  vertex_count, MESH_OPT_CACHE_SIZE, NULL,
+                                  NULL))
+  {
+    goto cleanup;
+  }
+  mesh_optimize_vertex_fetch(remap, mesh->indices, index_count,
+                             vertex_count);
+  for (size_t i = 0; i < index_count; i++)
+  {
+    mesh->indices[i] = remap[mesh->indices[i]];
+  }
+  float *streams[2] = { mesh->positions, mesh->normals };
+  for (int s = 0; s < 2; s++)
+  {
+    mesh_remap_vertices(scratch, streams[s], vertex_count,
+                        3 * sizeof(float), remap);
+    memcpy(streams[s], scratch, vertex_count * 3 * sizeof(float));
+  }
+  mesh_remap_vertices(scratch, mesh->uvs, vertex_count, 2 * sizeof(float),
+                      remap);
+  memcpy(mesh->uvs, scratch, vertex_count * 2 * sizeof(float));
+  result = true;
+
+cleanup:
+  MIUR_FREE(heights);
+  MIUR_FREE(indices);
+  MIUR_FREE(remap);
+  MIUR_FREE(scratch);
+  return result;
+}
+
+static bool alloc_mesh(BenchMesh *mesh, size_t index_count,
+                       size_t vertex_count)
+{
+  mesh->indices = MIUR_ARR(uint32_t, index_count);
+  mesh->positions = MIUR_ARR(float, vertex_count * 3);
+  mesh->normals = MIUR_ARR(float, vertex_count * 3);
+  mesh->uvs = MIUR_ARR(float, vertex_count * 2);
+  mesh->index_count = index_count;
+  mesh->vertex_count = vertex_count;
+  if (mesh->indices == NULL || mesh->positions == NULL ||
+      mesh->normals == NULL || mesh->uvs == NULL)
+  {
+    destroy_mesh(mesh);
+    return false;
+  }
+  return true;
+}
+
+static void destroy_mesh(BenchMesh *mesh)
+{
+  MIUR_FREE(mesh->indices);
+  MIUR_FREE(mesh->positions);
+  MIUR_FREE(mesh->normals);
+  MIUR_FREE(mesh->uvs);
+  memset(mesh, 0, sizeof(BenchMesh));
+}
@@ -0,0 +1,450 @@
+/* =====================
+ * tests/meshlet.c
+ * 10/18/2026
+ * Checks meshlet coverage, limits, bounds and cones.
+ * ====================
+ */
+
+/*
+ * Every mesh triangle is looked up by its winding preserving rotation and
+ * ticked off as meshlets use it, so a triangle that is missing, repeated or
+ * flipped fails on its own.  Meshes are the bundled funny-cube, read from
+ * the directory given as the first argument or "assets", a random soup,
+ * a random height field and a fan around one vertex with more triangles
+ * than fit in a meshlet.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <miur/mem.h>
+#include <miur/membuf.h>
+#include <miur/meshlet.h>
+
+#include "test.h"
+
+/* Layout of assets/funny-cube.bin, see funny-cube.gltf. */
+#define FUNNY_CUBE_INDEX_COUNT 1512
+#define FUNNY_CUBE_VERTEX_COUNT 706
+#define FUNNY_CUBE_POSITION_OFFSET 3024
+
+#define MESHLET_TEST_SEED 0x6D6573686C6574ULL
+#define MESHLET_TEST_SOUP_VERTICES 3000
+#define MESHLET_TEST_SOUP_TRIANGLES 8000
+#define MESHLET_TEST_GRID_SIZE 200
+#define MESHLET_TEST_FAN_TRIANGLES 300
+#define MESHLET_TEST_CAMERAS 64
+#define MESHLET_TEST_PATH_SIZE 1024
+
+typedef struct
+{
+  uint32_t *indices;
+  float *positions;
+  size_t index_count;
+  size_t vertex_count;
+} TestMesh;
+
+typedef struct
+{
+  uint32_t v[3];
+  uint32_t triangle;
+} TriangleRef;
+
+/* === PROTOTYPES === */
+
+static void check_mesh(const char *name, const TestMesh *mesh, TestRng *rng);
+static void check_coverage(const MeshletBuffer *buf, const TestMesh *mesh);
+static void check_bounds(const MeshletBuffer *buf, const TestMesh *mesh,
+                         TestRng *rng);
+static bool load_funny_cube(TestMesh *mesh, const char *dir);
+static bool create_soup(TestMesh *mesh, TestRng *rng);
+static bool create_grid(TestMesh *mesh, TestRng *rng);
+static bool create_fan(TestMesh *mesh);
+static bool alloc_mesh(TestMesh *mesh, size_t index_count,
+                       size_t vertex_count);
+static void destroy_mesh(TestMesh *mesh);
+static TriangleRef triangle_ref(uint32_t a, uint32_t b, uint32_t c,
+                                uint32_t triangle);
+static int compare_refs(const void *a, const void *b);
+static const float *position(const TestMesh *mesh, uint32_t v);
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(int argc, char **argv)
+{
+  const char *dir = argc > 1 ? argv[1] : "assets";
+  TestRng rng = test_rng(MESHLET_TEST_SEED);
+  TestMesh mesh;
+
+  if (TEST_CHECK(load_funny_cube(&mesh, dir)))
+  {
+    check_mesh("funny-cube", &mesh, &rng);
+    destroy_mesh(&mesh);
+  }
+  if (TEST_CHECK(create_soup(&mesh, &rng)))
+  {
+    check_mesh("random soup", &mesh, &rng);
+    destroy_mesh(&mesh);
+  }
+  if (TEST_CHECK(create_grid(&mesh, &rng)))
+  {
+    check_mesh("random height field", &mesh, &rng);
+    destroy_mesh(&mesh);
+  }
+  if (TEST_CHECK(create_fan(&mesh)))
+  {
+    check_mesh("fan", &mesh, &rng);
+    destroy_mesh(&mesh);
+  }
+
+  MeshletBuffer empty;
+  TEST_CHECK(meshlet_build(&empty, NULL, 0, NULL, 0) &&
+             empty.meshlet_count == 0 && empty.data == NULL);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void check_mesh(const char *name, const TestMesh *mesh, TestRng *rng)
+{
+  MeshletBuffer buf;
+  if (!TEST_CHECK(meshlet_build(&buf, mesh->indices, mesh->index_count,
+                                mesh->positions, mesh->vertex_count)))
+  {
+    return;
+  }
+  printf("%-20s %6zu triangles %5u meshlets %6.1f triangles each\n", name,
+         mesh->index_count / 3, buf.meshlet_count,
+         buf.meshlet_count > 0 ?
+         (double) (mesh->index_count / 3) / buf.meshlet_count : 0.0);
+
+  TEST_CHECK(buf.size == meshlet_buffer_size(buf.meshlet_count,
+                                             buf.vertex_count,
+                                             buf.triangle_size));
+  check_coverage(&buf, mesh);
+  check_bounds(&buf, mesh, rng);
+  TEST_CHECK(meshlet_validate(&buf, mesh->indices, mesh->index_count,
+                              mesh->vertex_count));
+  meshlet_buffer_destroy(&buf);
+}
+
+static void check_coverage(const MeshletBuffer *buf, const TestMesh *mesh)
+{
+  size_t triangle_count = mesh->index_count / 3;
+  TriangleRef *refs = MIUR_ARR(TriangleRef, triangle_count);
+  bool *used = MIUR_ARR(bool, triangle_count);
+  if (!TEST_CHECK(refs != NULL && used != NULL))
+  {
+    MIUR_FREE(refs);
+    MIUR_FREE(used);
+    return;
+  }
+  for (size_t t = 0; t < triangle_count; t++)
+  {
+    const uint32_t *tri = &mesh->indices[t * 3];
+    refs[t] = triangle_ref(tri[0], tri[1], tri[2], (uint32_t) t);
+  }
+  qsort(refs, triangle_count, sizeof(TriangleRef), compare_refs);
+
+  for (uint32_t i = 0; i < buf->meshlet_count; i++)
+  {
+    const Meshlet *m = &buf->meshlets[i];
+    TEST_CHECK(m->vertex_count > 0);
+    TEST_CHECK(m->vertex_count <= MESHLET_MAX_VERTICES);
+    TEST_CHECK(m->triangle_count > 0);
+    TEST_CHECK(m->triangle_count <= MESHLET_MAX_TRIANGLES);
+    TEST_CHECK(m->triangle_offset % 4 == 0);
+    if (!TEST_CHECK(m->vertex_offset + m->vertex_count <= buf->vertex_count &&
+                    m->triangle_offset + m->triangle_count * 3 <=
+                    buf->triangle_size))
+    {
+      continue;
+    }
+
+    const uint32_t *verts = buf->vertices + m->vertex_offset;
+    const uint8_t *tris = buf->triangles + m->triangle_offset;
+    for (uint32_t t = 0; t < m->triangle_count; t++)
+    {
+      const uint8_t *tri = &tris[t * 3];
+      if (!TEST_CHECK(tri[0] < m->vertex_count && tri[1] < m->vertex_count &&
+                      tri[2] < m->vertex_count))
+      {
+        continue;
+      }
+      TriangleRef key = triangle_ref(verts[tri[0]], verts[tri[1]],
+                                     verts[tri[2]], 0);
+      TriangleRef *match = bsearch(&key, refs, triangle_count,
+                                   sizeof(TriangleRef), compare_refs);
+      /* Mesh duplicates share a key, take the first one left. */
+      while (match != NULL && match > refs &&
+             compare_refs(match - 1, &key) == 0)
+      {
+        match--;
+      }
+      while (match != NULL && match < refs + triangle_count &&
+             compare_refs(match, &key) == 0 && used[match->triangle])
+      {
+        match++;
+      }
+      if (TEST_CHECK(match != NULL && match < refs + triangle_count &&
+                     compare_refs(match, &key) == 0))
+      {
+        used[match->triangle] = true;
+      }
+    }
+  }
+
+  for (size_t t = 0; t < triangle_count; t++)
+  {
+    if (!TEST_CHECK(used[t]))
+    {
+      break;
+    }
+  }
+  MIUR_FREE(refs);
+  MIUR_FREE(used);
+}
+
+/*
+ * Every vertex lies in its meshlet's sphere, and wherever the cone test
+ * culls a meshlet, each of its triangles faces away from the camera.
+ */
+static void check_bounds(const MeshletBuffer *buf, const TestMesh *mesh,
+                         TestRng *rng)
+{
+  for (uint32_t i = 0; i < buf->meshlet_count; i++)
+  {
+    const Meshlet *m = &buf->meshlets[i];
+    const uint32_t *verts = buf->vertices + m->vertex_offset;
+    for (uint32_t v = 0; v < m->vertex_count; v++)
+    {
+      const float *p = position(mesh, verts[v]);
+      float dx = p[0] - m->center[0], dy = p[1] - m->center[1];
+      float dz = p[2] - m->center[2];
+      TEST_CHECK(sqrtf(dx * dx + dy * dy + dz * dz) <=
+                 m->radius * 1.0001f + 1e-6f);
+    }
+
+    TEST_CHECK(m->cone_cutoff <= 1.0f);
+    if (m->cone_cutoff >= 1.0f)
+    {
+      continue;
+    }
+    /* Cameras behind the apex, where culling is most likely to apply. */
+    float reach = m->radius * 4.0f + 1e-3f;
+    for (int c = 0; c < MESHLET_TEST_CAMERAS; c++)
+    {
+      float camera[3], to_apex[3], len2 = 0.0f;
+      for (int k = 0; k < 3; k++)
+      {
+        camera[k] = m->cone_apex[k] - m->cone_axis[k] * reach +
+          test_rng_float(rng, -reach, reach);
+        to_apex[k] = m->cone_apex[k] - camera[k];
+        len2 += to_apex[k] * to_apex[k];
+      }
+      float len = sqrtf(len2);
+      float along = (to_apex[0] * m->cone_axis[0] +
+                     to_apex[1] * m->cone_axis[1] +
+                     to_apex[2] * m->cone_axis[2]) / len;
+      if (len == 0.0f || along < m->cone_cutoff)
+      {
+        continue;
+      }
+
+      const uint8_t *tris = buf->triangles + m->triangle_offset;
+      for (uint32_t t = 0; t < m->triangle_count; t++)
+      {
+        const float *a = position(mesh, verts[tris[t * 3]]);
+        const float *b = position(mesh, verts[tris[t * 3 + 1]]);
+        const float *d = position(mesh, verts[tris[t * 3 + 2]]);
+        float e0[3], e1[3], view[3];
+        for (int k = 0; k < 3; k++)
+        {
+          e0[k] = b[k] - a[k];
+          e1[k] = d[k] - a[k];
+          view[k] = a[k] - camera[k];
+        }
+        float n[3] = {
+          e0[1] * e1[2] - e0[2] * e1[1],
+          e0[2] * e1[0] - e0[0] * e1[2],
+          e0[0] * e1[1] - e0[1] * e1[0],
+        };
+        float n_len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        float view_len = sqrtf(view[0] * view[0] + view[1] * view[1] +
+                               view[2] * view[2]);
+        float facing = n[0] * view[0] + n[1] * view[1] + n[2] * view[2];
+        TEST_CHECK(facing >= -1e-4f * n_len * view_len);
+      }
+    }
+  }
+}
+
+static bool load_funny_cube(TestMesh *mesh, const char *dir)
+{
+  char path[MESHLET_TEST_PATH_SIZE];
+  snprintf(path, sizeof(path), "%s/funny-cube.bin", dir);
+  Membuf file;
+  if (!membuf_load_file(&file, path))
+  {
+    return false;
+  }
+  bool result = false;
+  if (file.size < FUNNY_CUBE_POSITION_OFFSET +
+      FUNNY_CUBE_VERTEX_COUNT * 3 * sizeof(float) ||
+      !alloc_mesh(mesh, FUNNY_CUBE_INDEX_COUNT, FUNNY_CUBE_VERTEX_COUNT))
+  {
+    goto cleanup;
+  }
+
+  for (size_t i = 0; i < mesh->index_count; i++)
+  {
+    uint16_t index;
+    memcpy(&index, file.data + i * sizeof(uint16_t), sizeof(uint16_t));
+    mesh->indices[i] = index;
+  }
+  memcpy(mesh->positions, file.data + FUNNY_CUBE_POSITION_OFFSET,
+         mesh->vertex_count * 3 * sizeof(float));
+  result = true;
+
+cleanup:
+  membuf_destroy(&file);
+  return result;
+}
+
+/* No locality at all, so meshlets fill up on vertices before triangles. */
+static bool create_soup(TestMesh *mesh, TestRng *rng)
+{
+  if (!alloc_mesh(mesh, MESHLET_TEST_SOUP_TRIANGLES * 3,
+                  MESHLET_TEST_SOUP_VERTICES))
+  {
+    return false;
+  }
+  for (size_t i = 0; i < mesh->vertex_count * 3; i++)
+  {
+    mesh->positions[i] = test_rng_float(rng, -1.0f, 1.0f);
+  }
+  for (size_t t = 0; t < MESHLET_TEST_SOUP_TRIANGLES; t++)
+  {
+    uint32_t *tri = &mesh->indices[t * 3];
+    tri[0] = test_rng_below(rng, MESHLET_TEST_SOUP_VERTICES);
+    do
+    {
+      tri[1] = test_rng_below(rng, MESHLET_TEST_SOUP_VERTICES);
+    } while (tri[1] == tri[0]);
+    do
+    {
+      tri[2] = test_rng_below(rng, MESHLET_TEST_SOUP_VERTICES);
+    } while (tri[2] == tri[0] || tri[2] == tri[1]);
+  }
+  return true;
+}
+
+static bool create_grid(TestMesh *mesh, TestRng *rng)
+{
+  const uint32_t n = MESHLET_TEST_GRID_SIZE;
+  if (!alloc_mesh(mesh, (size_t) (n - 1) * (n - 1) * 6, (size_t) n * n))
+  {
+    return false;
+  }
+  for (uint32_t y = 0; y < n; y++)
+  {
+    for (uint32_t x = 0; x < n; x++)
+    {
+      float *p = &mesh->positions[((size_t) y * n + x) * 3];
+      p[0] = (float) x;
+      p[1] = test_rng_float(rng, -2.0f, 2.0f);
+      p[2] = (float) y;
+    }
+  }
+  uint32_t *indices = mesh->indices;
+  for (uint32_t y = 0; y + 1 < n; y++)
+  {
+    for (uint32_t x = 0; x + 1 < n; x++)
+    {
+      uint32_t i = y * n + x;
+      uint32_t quad[6] = { i, i + n, i + 1, i + 1, i + n, i + n + 1 };
+      memcpy(indices, quad, sizeof(quad));
+      indices += 6;
+    }
+  }
+  return true;
+}
+
+/* Every triangle shares vertex 0, more of them than one meshlet holds. */
+static bool create_fan(TestMesh *mesh)
+{
+  const uint32_t count = MESHLET_TEST_FAN_TRIANGLES;
+  if (!alloc_mesh(mesh, (size_t) count * 3, count + 1))
+  {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; i++)
+  {
+    float angle = 6.2831853f * (float) i / count;
+    float *p = &mesh->positions[(size_t) (i + 1) * 3];
+    p[0] = cosf(angle);
+    p[1] = 0.0f;
+    p[2] = sinf(angle);
+    uint32_t *tri = &mesh->indices[(size_t) i * 3];
+    tri[0] = 0;
+    tri[1] = (i + 1) % count + 1;
+    tri[2] = i + 1;
+  }
+  return true;
+}
+
+static bool alloc_mesh(TestMesh *mesh, size_t index_count,
+                       size_t vertex_count)
+{
+  mesh->indices = MIUR_ARR(uint32_t, index_count);
+  mesh->positions = MIUR_ARR(float, vertex_count * 3);
+  mesh->index_count = index_count;
+  mesh->vertex_count = vertex_count;
+  if (mesh->indices == NULL || mesh->positions == NULL)
+  {
+    destroy_mesh(mesh);
+    return false;
+  }
+  return true;
+}
+
+static void destroy_mesh(TestMesh *mesh)
+{
+  MIUR_FREE(mesh->indices);
+  MIUR_FREE(mesh->positions);
+  memset(mesh, 0, sizeof(TestMesh));
+}
+
+/* Rotates the smallest index first, which keeps the winding. */
+static TriangleRef triangle_ref(uint32_t a, uint32_t b, uint32_t c,
+                                uint32_t triangle)
+{
+  if (b < a && b <= c)
+  {
+    return (TriangleRef) { { b, c, a }, triangle };
+  }
+  if (c < a && c < b)
+  {
+    return (TriangleRef) { { c, a, b }, triangle };
+  }
+  return (TriangleRef) { { a, b, c }, triangle };
+}
+
+/* Orders by vertices only, the triangle rides along. */
+static int compare_refs(const void *a, const void *b)
+{
+  const TriangleRef *ra = a, *rb = b;
+  for (int i = 0; i < 3; i++)
+  {
+    if (ra->v[i] != rb->v[i])
+    {
+      return ra->v[i] < rb->v[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+static const float *position(const TestMesh *mesh, uint32_t v)
+{
+  return &mesh->positions[(size_t) v * 3];
+}
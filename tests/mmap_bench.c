@@ -0,0 +1,173 @@
+/* =====================
+ * tests/mmap_bench.c
+ * 10/18/2026
+ * Times mapping a huge file against reading it into the heap.
+ * ====================
+ */
+
+/*
+ * Writes one file of the size in MB given as the second argument, 2 GB by
+ * default, to the directory given as the first, or the current one, and
+ * removes it afterwards.  Reading with membuf_load_file pays for the whole
+ * copy up front, while membuf_map_file returns at once and pays on first
+ * touch instead, so every mapped case is timed both for the call alone and
+ * with one read per page afterwards, which is what a loader walking the
+ * buffer ends up doing.  On Linux the cold runs drop the file from the page
+ * cache first, which is close to a first launch without needing to be root.
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <miur/mem.h>
+#include <miur/membuf.h>
+
+#include "test.h"
+
+#define MMAP_BENCH_DEFAULT_MB 2048
+#define MMAP_BENCH_CHUNK (16 << 20)
+#define MMAP_BENCH_RUNS 3
+#define MMAP_BENCH_SEED 0x6D6D617062656E63ULL
+#define MMAP_BENCH_PATH_SIZE 1024
+#define MMAP_BENCH_PAGE 4096
+
+typedef enum
+{
+  MMAP_BENCH_LOAD,
+  MMAP_BENCH_MAP,
+  MMAP_BENCH_MAP_SEQUENTIAL,
+  MMAP_BENCH_MAP_WILLNEED,
+  MMAP_BENCH_MODE_COUNT,
+} MmapBenchMode;
+
+/* === PROTOTYPES === */
+
+static bool create_file(const char *path, uint64_t size, TestRng *rng);
+static bool open_file(const char *path, MmapBenchMode mode, uint64_t size,
+                      bool cold, uint64_t *open_ns, uint64_t *touch_ns);
+
+/* === GLOBALS === */
+
+static const char *const mode_names[MMAP_BENCH_MODE_COUNT] = {
+  "load", "map", "map sequential", "map willneed",
+};
+
+static const MembufMapFlags mode_flags[MMAP_BENCH_MODE_COUNT] = {
+  0, 0, MEMBUF_MAP_SEQUENTIAL, MEMBUF_MAP_WILLNEED,
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(int argc, char **argv)
+{
+  const char *dir = argc > 1 ? argv[1] : ".";
+  uint64_t size = (uint64_t) (argc > 2 ? strtoul(argv[2], NULL, 10) :
+                              MMAP_BENCH_DEFAULT_MB) << 20;
+  char path[MMAP_BENCH_PATH_SIZE];
+  snprintf(path, sizeof(path), "%s/mmap-bench.bin", dir);
+  TestRng rng = test_rng(MMAP_BENCH_SEED);
+
+  if (TEST_CHECK(size > 0 && size <= SIZE_MAX) &&
+      TEST_CHECK(create_file(path, size, &rng)))
+  {
+    printf("%" PRIu64 " MB file\n", size >> 20);
+    char name[64];
+    for (int mode = 0; mode < MMAP_BENCH_MODE_COUNT; mode++)
+    {
+      for (int cold = 0; cold < 2; cold++)
+      {
+#ifndef __linux__
+        if (cold)
+        {
+          break;
+        }
+#endif
+        uint64_t best_open = UINT64_MAX, best_total = UINT64_MAX;
+        for (int run = 0; run < MMAP_BENCH_RUNS; run++)
+        {
+          uint64_t open_ns = 0, touch_ns = 0;
+          if (!TEST_CHECK(open_file(path, (MmapBenchMode) mode, size, cold,
+                                    &open_ns, &touch_ns)))
+          {
+            break;
+          }
+          best_open = open_ns < best_open ? open_ns : best_open;
+          best_total = open_ns + touch_ns < best_total ?
+            open_ns + touch_ns : best_total;
+        }
+        if (mode != MMAP_BENCH_LOAD)
+        {
+          snprintf(name, sizeof(name), "  %s %s", mode_names[mode],
+                   cold ? "cold" : "warm");
+          test_bench_report(name, size, best_open);
+        }
+        snprintf(name, sizeof(name), "  %s %s%s", mode_names[mode],
+                 cold ? "cold" : "warm",
+                 mode != MMAP_BENCH_LOAD ? " touched" : "");
+        test_bench_report(name, size, best_total);
+      }
+    }
+  }
+  remove(path);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static bool create_file(const char *path, uint64_t size, TestRng *rng)
+{
+  uint64_t *chunk = MIUR_ARR_UNINIT(uint64_t, MMAP_BENCH_CHUNK / 8);
+  FILE *file = fopen(path, "wb");
+  bool ok = chunk != NULL && file != NULL;
+  for (uint64_t written = 0; ok && written < size;)
+  {
+    for (size_t i = 0; i < MMAP_BENCH_CHUNK / 8; i++)
+    {
+      chunk[i] = test_rng_next(rng);
+    }
+    size_t part = size - written < MMAP_BENCH_CHUNK ?
+      (size_t) (size - written) : MMAP_BENCH_CHUNK;
+    ok = fwrite(chunk, 1, part, file) == part;
+    written += part;
+  }
+  if (file != NULL && fclose(file) != 0)
+  {
+    ok = false;
+  }
+  MIUR_FREE(chunk);
+  return ok;
+}
+
+/* Times the open and one read per page after it separately. */
+static bool open_file(const char *path, MmapBenchMode mode, uint64_t size,
+                      bool cold, uint64_t *open_ns, uint64_t *touch_ns)
+{
+  if (cold)
+  {
+    test_drop_cached(path);
+  }
+
+  Membuf file;
+  uint64_t start = thread_time_ns();
+  bool ok = mode == MMAP_BENCH_LOAD ? membuf_load_file(&file, path) :
+    membuf_map_file(&file, path, mode_flags[mode]);
+  uint64_t opened = thread_time_ns();
+  if (!ok)
+  {
+    return false;
+  }
+
+  uint64_t sum = 0;
+  for (size_t offset = 0; offset < file.size; offset += MMAP_BENCH_PAGE)
+  {
+    sum += file.data[offset];
+  }
+  uint64_t touched = thread_time_ns();
+
+  *open_ns = opened - start;
+  *touch_ns = touched - opened;
+  ok = file.size == size && sum > 0;
+  membuf_destroy(&file);
+  return ok;
+}
@@ -0,0 +1,208 @@
+/* =====================
+ * tests/scene.c
+ * 10/18/2026
+ * Checks incremental scene updates against a full recompute.
+ * ====================
+ */
+
+/*
+ * A random forest is added node by node, every parent before its children,
+ * so the handles are already in the order transform_compute_world wants
+ * and it recomputes every world matrix from scratch as the reference.
+ * Each frame changes a few random nodes, and after scene_update every world
+ * matrix has to match the reference exactly, since both multiply the same
+ * matrices in the same order, and the update has to report exactly the
+ * changed nodes and their subtrees within its slot range.  Nodes are added
+ * between frames too, which moves slots but not handles.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <miur/mem.h>
+#include <miur/scene.h>
+#include <miur/transform.h>
+
+#include "test.h"
+
+#define SCENE_TEST_SEED 0x7363656E65ULL
+#define SCENE_TEST_NODES 5000
+#define SCENE_TEST_ADDED 500
+#define SCENE_TEST_FRAMES 40
+#define SCENE_TEST_CHANGES 50
+
+typedef struct
+{
+  Scene scene;
+  /* By handle. */
+  float *local;
+  float *world;
+  int32_t *parents;
+  bool *changed;
+  bool *dirty;
+  uint32_t count;
+} SceneTest;
+
+/* === PROTOTYPES === */
+
+static bool add_nodes(SceneTest *test, uint32_t count, TestRng *rng);
+static void check_frame(SceneTest *test);
+static void random_local(float *out, TestRng *rng);
+static void destroy_test(SceneTest *test);
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(void)
+{
+  TestRng rng = test_rng(SCENE_TEST_SEED);
+  const uint32_t total = SCENE_TEST_NODES + SCENE_TEST_ADDED *
+    SCENE_TEST_FRAMES / 4;
+  SceneTest test = {
+    .local = MIUR_ARR(float, (size_t) total * 16),
+    .world = MIUR_ARR(float, (size_t) total * 16),
+    .parents = MIUR_ARR(int32_t, total),
+    .changed = MIUR_ARR(bool, total),
+    .dirty = MIUR_ARR(bool, total),
+  };
+  /* Starts small, so adding nodes grows it too. */
+  if (!TEST_CHECK(scene_create(&test.scene, 16)) ||
+      !TEST_CHECK(test.local != NULL && test.world != NULL &&
+                  test.parents != NULL && test.changed != NULL &&
+                  test.dirty != NULL))
+  {
+    destroy_test(&test);
+    return test_result();
+  }
+
+  TEST_CHECK(add_nodes(&test, SCENE_TEST_NODES, &rng));
+  check_frame(&test);
+  /* Nothing changed, nothing to do. */
+  check_frame(&test);
+
+  float local[16];
+  for (int frame = 0; frame < SCENE_TEST_FRAMES; frame++)
+  {
+    for (int i = 0; i < SCENE_TEST_CHANGES; i++)
+    {
+      uint32_t node = (uint32_t) test_rng_below(&rng, test.count);
+      random_local(local, &rng);
+      memcpy(&test.local[(size_t) node * 16], local, sizeof(local));
+      test.changed[node] = true;
+      scene_set_local(&test.scene, node, local);
+    }
+    if (frame % 4 == 3)
+    {
+      TEST_CHECK(add_nodes(&test, SCENE_TEST_ADDED, &rng));
+    }
+    check_frame(&test);
+  }
+
+  destroy_test(&test);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/* Roots now and then, otherwise under any earlier node. */
+static bool add_nodes(SceneTest *test, uint32_t count, TestRng *rng)
+{
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint32_t node = test->count;
+    int32_t parent = node == 0 || test_rng_below(rng, 50) == 0 ? -1 :
+      (int32_t) test_rng_below(rng, node);
+    random_local(&test->local[(size_t) node * 16], rng);
+    SceneNode handle = scene_add(&test->scene,
+                                 parent < 0 ? SCENE_NO_NODE :
+                                 (SceneNode) parent,
+                                 &test->local[(size_t) node * 16]);
+    if (handle != node)
+    {
+      return false;
+    }
+    test->parents[node] = parent;
+    test->changed[node] = true;
+    test->count++;
+  }
+  return true;
+}
+
+/*
+ * Adding nodes reorders the scene, which recomputes everything, otherwise
+ * only the changed nodes and everything under them.
+ */
+static void check_frame(SceneTest *test)
+{
+  bool reordered = test->scene.unordered;
+  uint32_t expected = 0;
+  for (uint32_t i = 0; i < test->count; i++)
+  {
+    int32_t parent = test->parents[i];
+    test->dirty[i] = reordered || test->changed[i] ||
+      (parent >= 0 && test->dirty[parent]);
+    expected += test->dirty[i];
+    test->changed[i] = false;
+  }
+  transform_compute_world(test->world, test->local, test->parents,
+                          test->count);
+
+  SceneUpdate update;
+  if (!TEST_CHECK(scene_update(&test->scene, &update)))
+  {
+    return;
+  }
+  TEST_CHECK(update.updated == expected);
+  TEST_CHECK(test->scene.count == test->count);
+
+  bool worlds_ok = true, range_ok = true, order_ok = true;
+  for (uint32_t i = 0; i < test->count; i++)
+  {
+    uint32_t slot = scene_slot(&test->scene, i);
+    const float *world = scene_world(&test->scene, i);
+    worlds_ok &= world == &test->scene.world[(size_t) slot * 16] &&
+      memcmp(world, &test->world[(size_t) i * 16], 16 * sizeof(float)) == 0;
+    range_ok &= !test->dirty[i] || (slot >= update.first && slot < update.end);
+    order_ok &= test->parents[i] < 0 ||
+      scene_slot(&test->scene, (SceneNode) test->parents[i]) < slot;
+  }
+  TEST_CHECK(worlds_ok);
+  TEST_CHECK(range_ok);
+  TEST_CHECK(order_ok);
+}
+
+static void random_local(float *out, TestRng *rng)
+{
+  float translation[3], rotation[4], scale[3];
+  float length = 0.0f;
+  for (int i = 0; i < 3; i++)
+  {
+    translation[i] = test_rng_float(rng, -10.0f, 10.0f);
+    scale[i] = test_rng_float(rng, 0.5f, 1.5f);
+  }
+  /* Kept away from zero so normalizing is well defined. */
+  do
+  {
+    length = 0.0f;
+    for (int i = 0; i < 4; i++)
+    {
+      rotation[i] = test_rng_float(rng, -1.0f, 1.0f);
+      length += rotation[i] * rotation[i];
+    }
+  } while (length < 0.01f);
+  length = 1.0f / sqrtf(length);
+  for (int i = 0; i < 4; i++)
+  {
+    rotation[i] *= length;
+  }
+  mat4_from_trs(out, translation, rotation, scale);
+}
+
+static void destroy_test(SceneTest *test)
+{
+  scene_destroy(&test->scene);
+  MIUR_FREE(test->local);
+  MIUR_FREE(test->world);
+  MIUR_FREE(test->parents);
+  MIUR_FREE(test->changed);
+  MIUR_FREE(test->dirty);
+}
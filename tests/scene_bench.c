@@ -0,0 +1,173 @@
+/* =====================
+ * tests/scene_bench.c
+ * 10/18/2026
+ * Times scene updates with a million nodes and 1% changing per frame.
+ * ====================
+ */
+
+/*
+ * The scene is 10000 models of 100 nodes each, every node under a random
+ * earlier one of its model, like imported glTF hierarchies.  Each frame
+ * sets new local matrices on 1% of the nodes, picked at random, and runs
+ * scene_update, then the same with 1% of the models moved by their roots
+ * instead, which recomputes about as many nodes but in whole subtrees.  The
+ * baseline is recomputing every world matrix with transform_compute_world,
+ * what a renderer without dirty tracking does each frame.  Times are the
+ * best frame of many, the nodes updated the average.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <miur/mem.h>
+#include <miur/scene.h>
+#include <miur/transform.h>
+
+#include "test.h"
+
+#define SCENE_BENCH_MODELS 10000
+#define SCENE_BENCH_MODEL_NODES 100
+#define SCENE_BENCH_NODES (SCENE_BENCH_MODELS * SCENE_BENCH_MODEL_NODES)
+#define SCENE_BENCH_CHANGES (SCENE_BENCH_NODES / 100)
+#define SCENE_BENCH_FRAMES 20
+#define SCENE_BENCH_SEED 0x7363656E6562ULL
+
+/* === PROTOTYPES === */
+
+static void bench_changes(Scene *scene, const char *name, bool roots,
+                          uint32_t count, const float *matrices,
+                          TestRng *rng);
+static void bench_full(const float *local, const int32_t *parents);
+static void report(const char *name, uint64_t ns, uint32_t updated);
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(void)
+{
+  TestRng rng = test_rng(SCENE_BENCH_SEED);
+  Scene scene;
+  float *local = MIUR_ARR(float, (size_t) SCENE_BENCH_NODES * 16);
+  int32_t *parents = MIUR_ARR(int32_t, SCENE_BENCH_NODES);
+  if (!TEST_CHECK(local != NULL && parents != NULL) ||
+      !TEST_CHECK(scene_create(&scene, SCENE_BENCH_NODES)))
+  {
+    MIUR_FREE(local);
+    MIUR_FREE(parents);
+    return test_result();
+  }
+
+  /* Small rotations and scales keep deep chains finite. */
+  for (uint32_t i = 0; i < SCENE_BENCH_NODES; i++)
+  {
+    uint32_t model_node = i % SCENE_BENCH_MODEL_NODES;
+    parents[i] = model_node == 0 ? -1 :
+      (int32_t) (i - model_node + test_rng_below(&rng, model_node));
+    float translation[3] = {
+      test_rng_float(&rng, -1.0f, 1.0f), test_rng_float(&rng, -1.0f, 1.0f),
+      test_rng_float(&rng, -1.0f, 1.0f),
+    };
+    float angle = test_rng_float(&rng, -0.1f, 0.1f);
+    float rotation[4] = { 0.0f, sinf(angle), 0.0f, cosf(angle) };
+    float scale[3] = { 1.0f, 1.0f, 1.0f };
+    mat4_from_trs(&local[(size_t) i * 16], translation, rotation, scale);
+    if (!TEST_CHECK(scene_add(&scene, parents[i] < 0 ? SCENE_NO_NODE :
+                              (SceneNode) parents[i],
+                              &local[(size_t) i * 16]) == i))
+    {
+      goto cleanup;
+    }
+  }
+
+  printf("%d nodes in %d models\n", SCENE_BENCH_NODES, SCENE_BENCH_MODELS);
+  SceneUpdate update;
+  uint64_t start = thread_time_ns();
+  bool ok = scene_update(&scene, &update);
+  if (!TEST_CHECK(ok))
+  {
+    goto cleanup;
+  }
+  report("  first update", thread_time_ns() - start, update.updated);
+
+  bench_full(local, parents);
+  bench_changes(&scene, "  1% of nodes", false, SCENE_BENCH_CHANGES, local,
+                &rng);
+  bench_changes(&scene, "  1% of models", true, SCENE_BENCH_MODELS / 100,
+                local, &rng);
+
+cleanup:
+  scene_destroy(&scene);
+  MIUR_FREE(local);
+  MIUR_FREE(parents);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/*
+ * The nodes to change are picked before each frame's timer starts, their
+ * new matrices are existing ones.
+ */
+static void bench_changes(Scene *scene, const char *name, bool roots,
+                          uint32_t count, const float *matrices,
+                          TestRng *rng)
+{
+  SceneNode *nodes = MIUR_ARR(SceneNode, count);
+  if (!TEST_CHECK(nodes != NULL))
+  {
+    return;
+  }
+  uint64_t best = UINT64_MAX;
+  uint64_t updated = 0;
+  for (int frame = 0; frame < SCENE_BENCH_FRAMES; frame++)
+  {
+    for (uint32_t i = 0; i < count; i++)
+    {
+      nodes[i] = roots ?
+        (SceneNode) (test_rng_below(rng, SCENE_BENCH_MODELS) *
+                     SCENE_BENCH_MODEL_NODES) :
+        (SceneNode) test_rng_below(rng, SCENE_BENCH_NODES);
+    }
+
+    SceneUpdate update;
+    uint64_t start = thread_time_ns();
+    for (uint32_t i = 0; i < count; i++)
+    {
+      scene_set_local(scene, nodes[i],
+                      &matrices[(size_t) nodes[(i + 1) % count] * 16]);
+    }
+    bool ok = scene_update(scene, &update);
+    uint64_t time = thread_time_ns() - start;
+    if (!TEST_CHECK(ok))
+    {
+      break;
+    }
+    best = time < best ? time : best;
+    updated += update.updated;
+  }
+  report(name, best, (uint32_t) (updated / SCENE_BENCH_FRAMES));
+  MIUR_FREE(nodes);
+}
+
+static void bench_full(const float *local, const int32_t *parents)
+{
+  float *world = MIUR_ARR(float, (size_t) SCENE_BENCH_NODES * 16);
+  if (!TEST_CHECK(world != NULL))
+  {
+    return;
+  }
+  uint64_t best = UINT64_MAX;
+  for (int frame = 0; frame < SCENE_BENCH_FRAMES; frame++)
+  {
+    uint64_t start = thread_time_ns();
+    transform_compute_world(world, local, parents, SCENE_BENCH_NODES);
+    uint64_t time = thread_time_ns() - start;
+    best = time < best ? time : best;
+  }
+  report("  full recompute", best, SCENE_BENCH_NODES);
+  MIUR_FREE(world);
+}
+
+static void report(const char *name, uint64_t ns, uint32_t updated)
+{
+  printf("%-32s %10.3f ms %10u nodes updated\n", name, ns / 1e6, updated);
+}
@@ -0,0 +1,260 @@
+/* =====================
+ * tests/simplify_bench.c
+ * 10/18/2026
+ * Times quadric simplification and LOD chains on a million triangles.
+ * ====================
+ */
+
+/*
+ * The input is a 708x708 terrain, just under a million triangles, with
+ * smoothed noise heights, normals and uvs.  mesh_simplify is timed halving
+ * it and down to a tenth, on positions alone and weighted by normals and
+ * uvs as the cook does, then static_mesh_build_lods builds the whole chain.
+ * Throughput is input triangles per second.  Every result is checked to
+ * hit its target, index only existing vertices and have no degenerate
+ * triangles, and the chain's levels to shrink while their errors grow.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <miur/mem.h>
+#include <miur/mesh_opt.h>
+#include <miur/simplify.h>
+
+#include "test.h"
+
+#define SIMPLIFY_BENCH_GRID 708
+#define SIMPLIFY_BENCH_RUNS 3
+#define SIMPLIFY_BENCH_SEED 0x73696D706C696679ULL
+
+typedef struct
+{
+  StaticMesh mesh;
+  float *attributes;           /* Normal and uv per vertex. */
+  uint32_t *dst;
+} SimplifyBench;
+
+/* === PROTOTYPES === */
+
+static void bench_simplify(SimplifyBench *bench, const char *name,
+                           float ratio, bool attributes);
+static void bench_lods(SimplifyBench *bench);
+static bool valid_triangles(const uint32_t *indices, size_t index_count,
+                            size_t vertex_count);
+static void report(const char *name, size_t triangles, uint64_t ns,
+                   size_t out_triangles, float error);
+static bool create_terrain(SimplifyBench *bench, TestRng *rng);
+static void destroy_terrain(SimplifyBench *bench);
+
+/* === GLOBALS === */
+
+/* The cook's, see static_mesh_build_lods. */
+static const float attribute_weights[] = { 0.5f, 0.5f, 0.5f, 1.0f, 1.0f };
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(void)
+{
+  TestRng rng = test_rng(SIMPLIFY_BENCH_SEED);
+  SimplifyBench bench;
+  if (TEST_CHECK(create_terrain(&bench, &rng)))
+  {
+    printf("%u vertices, %u triangles\n", bench.mesh.vert_count,
+           bench.mesh.index_count / 3);
+    printf("%-32s %10s %10s %10s %10s\n", "", "time", "Mtri/s", "triangles",
+           "error");
+    bench_simplify(&bench, "simplify 50%", 0.5f, false);
+    bench_simplify(&bench, "simplify 10%", 0.1f, false);
+    bench_simplify(&bench, "simplify 50% attributes", 0.5f, true);
+    bench_simplify(&bench, "simplify 10% attributes", 0.1f, true);
+    bench_lods(&bench);
+  }
+  destroy_terrain(&bench);
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+/* No error bound, so only the target count stops it. */
+static void bench_simplify(SimplifyBench *bench, const char *name,
+                           float ratio, bool attributes)
+{
+  const StaticMesh *mesh = &bench->mesh;
+  size_t triangles = mesh->index_count / 3;
+  MeshSimplifyDesc desc = {
+    .target_index_count = (size_t) (triangles * ratio) * 3,
+    .target_error = 1.0f,
+    .attributes = attributes ? bench->attributes : NULL,
+    .attribute_weights = attributes ? attribute_weights : NULL,
+    .attribute_count = attributes ? 5 : 0,
+  };
+
+  uint64_t best = UINT64_MAX;
+  size_t count = 0;
+  float error = 0.0f;
+  for (int run = 0; run < SIMPLIFY_BENCH_RUNS; run++)
+  {
+    uint64_t start = thread_time_ns();
+    bool ok = mesh_simplify(bench->dst, &count, &error, mesh->indices,
+                            mesh->index_count, mesh->verts_pos,
+                            mesh->vert_count, &desc);
+    uint64_t time = thread_time_ns() - start;
+    if (!TEST_CHECK(ok))
+    {
+      return;
+    }
+    best = time < best ? time : best;
+  }
+  TEST_CHECK(count > 0 && count <= desc.target_index_count);
+  TEST_CHECK(isfinite(error) && error >= 0.0f);
+  TEST_CHECK(valid_triangles(bench->dst, count, mesh->vert_count));
+  report(name, triangles, best, count / 3, error);
+}
+
+/* Builds on a copy every run, the chain is appended to the indices. */
+static void bench_lods(SimplifyBench *bench)
+{
+  const StaticMesh *source = &bench->mesh;
+  size_t index_size = source->index_count * sizeof(uint32_t);
+  uint64_t best = UINT64_MAX;
+  for (int run = 0; run < SIMPLIFY_BENCH_RUNS; run++)
+  {
+    StaticMesh mesh = *source;
+    mesh.indices = MIUR_ARR_UNINIT(uint32_t, source->index_count);
+    if (!TEST_CHECK(mesh.indices != NULL))
+    {
+      return;
+    }
+    memcpy(mesh.indices, source->indices, index_size);
+
+    uint64_t start = thread_time_ns();
+    bool ok = static_mesh_build_lods(&mesh);
+    uint64_t time = thread_time_ns() - start;
+    if (TEST_CHECK(ok) && run == 0)
+    {
+      TEST_CHECK(mesh.lod_count > 0);
+      uint32_t previous_count = mesh.index_count;
+      float previous_error = 0.0f;
+      for (uint32_t i = 0; i < mesh.lod_count; i++)
+      {
+        const MeshLod *lod = &mesh.lods[i];
+        TEST_CHECK(lod->index_count < previous_count);
+        TEST_CHECK(lod->error >= previous_error);
+        TEST_CHECK(valid_triangles(mesh.indices + lod->first_index,
+                                   lod->index_count, mesh.vert_count));
+        char name[64];
+        snprintf(name, sizeof(name), "  lod %u", i + 1);
+        printf("%-32s %10s %10s %10u %10.4f\n", name, "", "",
+               lod->index_count / 3, lod->error);
+        previous_count = lod->index_count;
+        previous_error = lod->error;
+      }
+    }
+    MIUR_FREE(mesh.indices);
+    best = time < best ? time : best;
+  }
+  report("lod chain", source->index_count / 3, best, 0, 0.0f);
+}
+
+static bool valid_triangles(const uint32_t *indices, size_t index_count,
+                            size_t vertex_count)
+{
+  for (size_t i = 0; i < index_count; i += 3)
+  {
+    uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+    if (a >= vertex_count || b >= vertex_count || c >= vertex_count ||
+        a == b || b == c || a == c)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void report(const char *name, size_t triangles, uint64_t ns,
+                   size_t out_triangles, float error)
+{
+  if (out_triangles > 0)
+  {
+    printf("%-32s %7.1f ms %10.3f %10zu %10.4f\n", name, ns / 1e6,
+           ns > 0 ? triangles * 1e3 / ns : 0.0, out_triangles, error);
+  }
+  else
+  {
+    printf("%-32s %7.1f ms %10.3f\n", name, ns / 1e6,
+           ns > 0 ? triangles * 1e3 / ns : 0.0);
+  }
+}
+
+static bool create_terrain(SimplifyBench *bench, TestRng *rng)
+{
+  const uint32_t n = SIMPLIFY_BENCH_GRID;
+  size_t vertex_count = (size_t) n * n;
+  size_t index_count = (size_t) (n - 1) * (n - 1) * 6;
+  memset(bench, 0, sizeof(SimplifyBench));
+  StaticMesh *mesh = &bench->mesh;
+  mesh->vert_count = (uint32_t) vertex_count;
+  mesh->index_count = (uint32_t) index_count;
+  mesh->verts_pos = MIUR_ARR(float, vertex_count * 3);
+  mesh->verts_norm = MIUR_ARR(float, vertex_count * 3);
+  mesh->verts_uv = MIUR_ARR(float, vertex_count * 2);
+  mesh->indices = MIUR_ARR(uint32_t, index_count);
+  bench->attributes = MIUR_ARR(float, vertex_count * 5);
+  bench->dst = MIUR_ARR(uint32_t, index_count);
+  if (mesh->verts_pos == NULL || mesh->verts_norm == NULL ||
+      mesh->verts_uv == NULL || mesh->indices == NULL ||
+      bench->attributes == NULL || bench->dst == NULL)
+  {
+    return false;
+  }
+
+  /* Smoothed noise, so normals vary like a terrain's. */
+  for (uint32_t y = 0; y < n; y++)
+  {
+    for (uint32_t x = 0; x < n; x++)
+    {
+      size_t i = (size_t) y * n + x;
+      float h = test_rng_float(rng, -1.0f, 1.0f) * 0.02f +
+        8.0f * sinf(x * 0.05f) * cosf(y * 0.07f);
+      float dx = 0.4f * cosf(x * 0.05f) * cosf(y * 0.07f);
+      float dy = -0.56f * sinf(x * 0.05f) * sinf(y * 0.07f);
+      float len = sqrtf(dx * dx + dy * dy + 1.0f);
+      float *pos = &mesh->verts_pos[i * 3];
+      float *norm = &mesh->verts_norm[i * 3];
+      float *uv = &mesh->verts_uv[i * 2];
+      pos[0] = (float) x;
+      pos[1] = h;
+      pos[2] = (float) y;
+      norm[0] = -dx / len;
+      norm[1] = 1.0f / len;
+      norm[2] = -dy / len;
+      uv[0] = (float) x / (n - 1);
+      uv[1] = (float) y / (n - 1);
+      memcpy(&bench->attributes[i * 5], norm, 3 * sizeof(float));
+      memcpy(&bench->attributes[i * 5 + 3], uv, 2 * sizeof(float));
+    }
+  }
+  uint32_t *quad = mesh->indices;
+  for (uint32_t y = 0; y + 1 < n; y++)
+  {
+    for (uint32_t x = 0; x + 1 < n; x++)
+    {
+      uint32_t i = y * n + x;
+      uint32_t tris[6] = { i, i + n, i + 1, i + 1, i + n, i + n + 1 };
+      memcpy(quad, tris, sizeof(tris));
+      quad += 6;
+    }
+  }
+  return true;
+}
+
+static void destroy_terrain(SimplifyBench *bench)
+{
+  MIUR_FREE(bench->mesh.verts_pos);
+  MIUR_FREE(bench->mesh.verts_norm);
+  MIUR_FREE(bench->mesh.verts_uv);
+  MIUR_FREE(bench->mesh.indices);
+  MIUR_FREE(bench->attributes);
+  MIUR_FREE(bench->dst);
+}
@@ -0,0 +1,131 @@
+/* =====================
+ * tests/test.h
+ * 10/18/2026
+ * Checks, random input and timing shared by the tests and benchmarks.
+ * ====================
+ */
+
+/*
+ * Each test is its own executable, run by `meson test`: checks report
+ * where they failed and carry on, and main returns test_result().
+ * Benchmarks are run by `meson test --benchmark` and print what they
+ * measured, timing each case as the best of several runs.
+ */
+
+#ifndef MIUR_TEST_H
+#define MIUR_TEST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <miur/thread.h>
+
+#define TEST_CHECK(cond) test_check((cond), #cond, __FILE__, __LINE__)
+
+/* Seeded, so a failure found on random input reproduces. */
+typedef struct
+{
+  uint64_t state;
+} TestRng;
+
+typedef void (*TestBenchFunction)(void *ud);
+
+static int test_failures;
+
+static inline bool test_check(bool ok, const char *expr,
+                              const char *file, int line)
+{
+  if (!ok)
+  {
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+    test_failures++;
+  }
+  return ok;
+}
+
+static inline int test_result(void)
+{
+  if (test_failures > 0)
+  {
+    fprintf(stderr, "%d checks failed\n", test_failures);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+static inline TestRng test_rng(uint64_t seed)
+{
+  TestRng rng = { seed != 0 ? seed : 1 };
+  return rng;
+}
+
+/* xorshift64*, plenty for generating inputs. */
+static inline uint64_t test_rng_next(TestRng *rng)
+{
+  rng->state ^= rng->state >> 12;
+  rng->state ^= rng->state << 25;
+  rng->state ^= rng->state >> 27;
+  return rng->state * 0x2545F4914F6CDD1DULL;
+}
+
+/* Uniform in [0, bound), `bound` must not be 0. */
+static inline uint32_t test_rng_below(TestRng *rng, uint32_t bound)
+{
+  return (uint32_t) ((test_rng_next(rng) >> 32) * bound >> 32);
+}
+
+static inline float test_rng_float(TestRng *rng, float min, float max)
+{
+  return min + (max - min) * (float) (test_rng_next(rng) >> 40) /
+    (float) (1 << 24);
+}
+
+/* The fastest of `runs` calls, the others only warm caches and clocks. */
+static inline uint64_t test_bench_best_ns(TestBenchFunction function,
+                                          void *ud, int runs)
+{
+  uint64_t best = UINT64_MAX;
+  for (int i = 0; i < runs; i++)
+  {
+    uint64_t start = thread_time_ns();
+    function(ud);
+    uint64_t time = thread_time_ns() - start;
+    best = time < best ? time : best;
+  }
+  return best;
+}
+
+static inline void test_bench_report(const char *name, uint64_t bytes,
+                                     uint64_t time_ns)
+{
+  printf("%-32s %10.3f ms %10.1f MB/s\n", name, time_ns / 1e6,
+         time_ns > 0 ? bytes * 1e3 / time_ns : 0.0);
+}
+
+/*
+ * Drops `path` from the page cache on Linux, which is close to a first
+ * launch without needing to be root.  Does nothing elsewhere.
+ */
+static inline void test_drop_cached(const char *path)
+{
+#ifdef __linux__
+  int fd = open(path, O_RDONLY);
+  if (fd >= 0)
+  {
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+#else
+  (void) path;
+#endif
+}
+
+#endif
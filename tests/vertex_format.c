@@ -0,0 +1,389 @@
+/* =====================
+ * tests/vertex_format.c
+ * 10/18/2026
+ * Checks vertex layouts and quantization round trips.
+ * ====================
+ */
+
+/*
+ * The sizes, offsets and strides are checked against the table in
+ * vertex_format.h.  Random vertices, plus axis aligned normals, a flat
+ * mesh and uvs that halves hold exactly, are then written in every format,
+ * separately and interleaved, for counts around the four vertex SSE2
+ * transpose.  Interleaved bytes have to match the separate ones, floats
+ * have to come back exactly, and quantized vertices are decoded the way the
+ * quantized shaders and Vulkan's SNORM and half float rules do and have to
+ * stay within the documented bounds, which vertex_quantization_measure has
+ * to agree with.
+ *
+ * Bandwidth and bind counts on the GPU are not covered, there is no device
+ * to run on here.
+ */
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include <miur/mem.h>
+#include <miur/vertex_format.h>
+
+#include "test.h"
+
+#define VERTEX_TEST_SEED 0x7665727466ULL
+#define VERTEX_TEST_COUNT 100000
+#define VERTEX_TEST_NORMAL_BOUND 1e-4f
+
+typedef struct
+{
+  float *positions;
+  float *normals;
+  float *uvs;
+  size_t count;
+} VertexTestMesh;
+
+/* === PROTOTYPES === */
+
+static void check_layouts(void);
+static void check_mesh(const VertexTestMesh *mesh);
+static void check_float(const VertexTestMesh *mesh, size_t count,
+                        const uint8_t *interleaved);
+static void check_quantized(const VertexTestMesh *mesh, size_t count,
+                            const uint8_t *interleaved,
+                            const VertexQuantization *quant);
+static bool same_as_separate(const VertexTestMesh *mesh, size_t count,
+                             VertexFormat format, const uint8_t *interleaved,
+                             const VertexQuantization *quant);
+static float snorm16(const uint8_t *p);
+static float half_to_float(const uint8_t *p);
+static bool create_mesh(VertexTestMesh *mesh, TestRng *rng, bool flat);
+static void random_unit(float *out, TestRng *rng);
+static void destroy_mesh(VertexTestMesh *mesh);
+
+/* === GLOBALS === */
+
+static const size_t test_counts[] = {
+  0, 1, 2, 3, 4, 5, 7, 8, 9, 63, VERTEX_TEST_COUNT,
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(void)
+{
+  TestRng rng = test_rng(VERTEX_TEST_SEED);
+  check_layouts();
+  for (int flat = 0; flat < 2; flat++)
+  {
+    VertexTestMesh mesh;
+    if (TEST_CHECK(create_mesh(&mesh, &rng, flat)))
+    {
+      check_mesh(&mesh);
+    }
+    destroy_mesh(&mesh);
+  }
+  return test_result();
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void check_layouts(void)
+{
+  static const uint32_t sizes[VERTEX_FORMAT_COUNT][VERTEX_ATTRIBUTE_COUNT] = {
+    [VERTEX_FORMAT_FLOAT] = { 12, 12, 8 },
+    [VERTEX_FORMAT_QUANTIZED] = { 8, 4, 4 },
+  };
+  static const VkFormat
+  formats[VERTEX_FORMAT_COUNT][VERTEX_ATTRIBUTE_COUNT] = {
+    [VERTEX_FORMAT_FLOAT] = {
+      VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT,
+      VK_FORMAT_R32G32_SFLOAT,
+    },
+    [VERTEX_FORMAT_QUANTIZED] = {
+      VK_FORMAT_R16G16B16A16_SNORM, VK_FORMAT_R16G16_SNORM,
+      VK_FORMAT_R16G16_SFLOAT,
+    },
+  };
+
+  TEST_CHECK(vertex_layout_binding_count(VERTEX_LAYOUT_SEPARATE) ==
+             VERTEX_ATTRIBUTE_COUNT);
+  TEST_CHECK(vertex_layout_binding_count(VERTEX_LAYOUT_INTERLEAVED) == 1);
+  for (int f = 0; f < VERTEX_FORMAT_COUNT; f++)
+  {
+    uint32_t offset = 0;
+    for (int a = 0; a < VERTEX_ATTRIBUTE_COUNT; a++)
+    {
+      VertexFormat format = (VertexFormat) f;
+      VertexAttribute attr = (VertexAttribute) a;
+      TEST_CHECK(vertex_attribute_size(format, attr) == sizes[f][a]);
+      TEST_CHECK(vertex_attribute_format(format, attr) == formats[f][a]);
+      TEST_CHECK(vertex_attribute_offset(format, attr) == offset);
+      TEST_CHECK(vertex_binding_stride(format, VERTEX_LAYOUT_SEPARATE,
+                                       (uint32_t) a) == sizes[f][a]);
+      /* Vulkan wants attribute offsets aligned to their components. */
+      TEST_CHECK(offset % (f == VERTEX_FORMAT_FLOAT ? 4 : 2) == 0);
+      offset += sizes[f][a];
+    }
+    TEST_CHECK(vertex_stride((VertexFormat) f) == offset);
+    TEST_CHECK(vertex_binding_stride((VertexFormat) f,
+                                     VERTEX_LAYOUT_INTERLEAVED, 0) == offset);
+  }
+  TEST_CHECK(vertex_stride(VERTEX_FORMAT_FLOAT) == 32);
+  TEST_CHECK(vertex_stride(VERTEX_FORMAT_QUANTIZED) == 16);
+}
+
+static void check_mesh(const VertexTestMesh *mesh)
+{
+  VertexQuantization quant;
+  vertex_quantization_fit(&quant, mesh->positions, mesh->count);
+  uint8_t *interleaved = MIUR_ARR(uint8_t, mesh->count *
+                                  vertex_stride(VERTEX_FORMAT_FLOAT));
+  if (!TEST_CHECK(interleaved != NULL))
+  {
+    return;
+  }
+  const float *const sources[VERTEX_ATTRIBUTE_COUNT] = {
+    mesh->positions, mesh->normals, mesh->uvs,
+  };
+  for (size_t c = 0; c < sizeof(test_counts) / sizeof(size_t); c++)
+  {
+    size_t count = test_counts[c];
+    vertex_interleave(interleaved, VERTEX_FORMAT_FLOAT, sources, count,
+                      &quant);
+    check_float(mesh, count, interleaved);
+    TEST_CHECK(same_as_separate(mesh, count, VERTEX_FORMAT_FLOAT,
+                                interleaved, &quant));
+  }
+
+  vertex_interleave(interleaved, VERTEX_FORMAT_QUANTIZED, sources,
+                    mesh->count, &quant);
+  check_quantized(mesh, mesh->count, interleaved, &quant);
+  TEST_CHECK(same_as_separate(mesh, mesh->count, VERTEX_FORMAT_QUANTIZED,
+                              interleaved, &quant));
+
+  /* A mesh without uvs gets zeros in their place. */
+  const float *const no_uvs[VERTEX_ATTRIBUTE_COUNT] = {
+    mesh->positions, mesh->normals, NULL,
+  };
+  bool zeros = true;
+  for (int f = 0; f < VERTEX_FORMAT_COUNT; f++)
+  {
+    VertexFormat format = (VertexFormat) f;
+    uint32_t stride = vertex_stride(format);
+    uint32_t offset = vertex_attribute_offset(format, VERTEX_ATTRIBUTE_UV);
+    uint32_t size = vertex_attribute_size(format, VERTEX_ATTRIBUTE_UV);
+    memset(interleaved, 0xAB, mesh->count * stride);
+    vertex_interleave(interleaved, format, no_uvs, 9, &quant);
+    for (size_t i = 0; i < 9; i++)
+    {
+      for (uint32_t b = 0; b < size; b++)
+      {
+        zeros &= interleaved[i * stride + offset + b] == 0;
+      }
+    }
+    zeros &= interleaved[9 * stride] == 0xAB;
+  }
+  TEST_CHECK(zeros);
+  MIUR_FREE(interleaved);
+}
+
+static void check_float(const VertexTestMesh *mesh, size_t count,
+                        const uint8_t *interleaved)
+{
+  bool ok = true;
+  for (size_t i = 0; i < count; i++)
+  {
+    const uint8_t *vertex = interleaved + i * 32;
+    ok &= memcmp(vertex, &mesh->positions[i * 3], 12) == 0 &&
+      memcmp(vertex + 12, &mesh->normals[i * 3], 12) == 0 &&
+      memcmp(vertex + 24, &mesh->uvs[i * 2], 8) == 0;
+  }
+  TEST_CHECK(ok);
+}
+
+/*
+ * Positions are decoded with the push constants as the shaders do, and
+ * the normals with their oct_decode.  The bounds get a few float roundings
+ * of slack on top.
+ */
+static void check_quantized(const VertexTestMesh *mesh, size_t count,
+                            const uint8_t *interleaved,
+                            const VertexQuantization *quant)
+{
+  VertexQuantizationError worst = { 0.0f, 0.0f, 0.0f };
+  bool positions_ok = true, normals_ok = true, uvs_ok = true;
+  for (size_t i = 0; i < count; i++)
+  {
+    const uint8_t *vertex = interleaved + i * 16;
+    for (int c = 0; c < 3; c++)
+    {
+      float p = mesh->positions[i * 3 + c];
+      float d = snorm16(vertex + c * 2) * quant->scale[c] + quant->offset[c];
+      float bound = quant->scale[c] / 65534.0f +
+        4.0f * FLT_EPSILON * (fabsf(quant->offset[c]) + quant->scale[c]);
+      positions_ok &= fabsf(d - p) <= bound;
+      worst.position = fmaxf(worst.position, fabsf(d - p));
+    }
+    positions_ok &= snorm16(vertex + 6) == 0.0f;
+
+    float x = snorm16(vertex + 8), y = snorm16(vertex + 10);
+    float z = 1.0f - fabsf(x) - fabsf(y);
+    float t = z < 0.0f ? -z : 0.0f;
+    x -= copysignf(t, x);
+    y -= copysignf(t, y);
+    const float *n = &mesh->normals[i * 3];
+    float cross[3] = {
+      n[1] * z - n[2] * y, n[2] * x - n[0] * z, n[0] * y - n[1] * x,
+    };
+    float angle = atan2f(sqrtf(cross[0] * cross[0] + cross[1] * cross[1] +
+                               cross[2] * cross[2]),
+                         n[0] * x + n[1] * y + n[2] * z);
+    normals_ok &= angle <= VERTEX_TEST_NORMAL_BOUND;
+    worst.normal = fmaxf(worst.normal, angle);
+
+    for (int c = 0; c < 2; c++)
+    {
+      float uv = mesh->uvs[i * 2 + c];
+      float d = half_to_float(vertex + 12 + c * 2);
+      float bound = fmaxf(fabsf(uv) / 2048.0f, ldexpf(1.0f, -25));
+      uvs_ok &= fabsf(d - uv) <= bound;
+      worst.uv = fmaxf(worst.uv, fabsf(d - uv));
+    }
+  }
+  TEST_CHECK(positions_ok);
+  TEST_CHECK(normals_ok);
+  TEST_CHECK(uvs_ok);
+
+  VertexQuantizationError error;
+  vertex_quantization_measure(&error, quant, mesh->positions, mesh->normals,
+                              mesh->uvs, count);
+  TEST_CHECK(fabsf(error.position - worst.position) <= 1e-6f);
+  TEST_CHECK(fabsf(error.normal - worst.normal) <= 1e-6f);
+  TEST_CHECK(error.uv == worst.uv);
+  printf("quantized errors: position %g, normal %g rad, uv %g\n",
+         error.position, error.normal, error.uv);
+}
+
+/* The separate layout writes each attribute packed on its own. */
+static bool same_as_separate(const VertexTestMesh *mesh, size_t count,
+                             VertexFormat format, const uint8_t *interleaved,
+                             const VertexQuantization *quant)
+{
+  const float *sources[VERTEX_ATTRIBUTE_COUNT] = {
+    mesh->positions, mesh->normals, mesh->uvs,
+  };
+  uint32_t stride = vertex_stride(format);
+  uint8_t *separate = MIUR_ARR(uint8_t, count * 12 + 1);
+  bool ok = separate != NULL;
+  for (int a = 0; ok && a < VERTEX_ATTRIBUTE_COUNT; a++)
+  {
+    VertexAttribute attr = (VertexAttribute) a;
+    uint32_t size = vertex_attribute_size(format, attr);
+    uint32_t offset = vertex_attribute_offset(format, attr);
+    vertex_attribute_write(separate, size, format, attr, sources[a], count,
+                           quant);
+    for (size_t i = 0; i < count; i++)
+    {
+      ok &= memcmp(separate + i * size, interleaved + i * stride + offset,
+                   size) == 0;
+    }
+  }
+  MIUR_FREE(separate);
+  return ok;
+}
+
+/* Vulkan's SNORM rule, -32768 clamps to -1. */
+static float snorm16(const uint8_t *p)
+{
+  int16_t v;
+  memcpy(&v, p, sizeof(v));
+  return fmaxf((float) v / 32767.0f, -1.0f);
+}
+
+static float half_to_float(const uint8_t *p)
+{
+  uint16_t h;
+  memcpy(&h, p, sizeof(h));
+  int exponent = (h >> 10) & 0x1F;
+  int mantissa = h & 0x3FF;
+  float value = exponent == 0 ? ldexpf((float) mantissa, -24) :
+    ldexpf((float) (mantissa | 0x400), exponent - 25);
+  return h & 0x8000 ? -value : value;
+}
+
+/*
+ * Positions in a random box, or flat along y, normals random or along an
+ * axis, uvs in [-2, 2] with some that halves hold exactly and some tiny.
+ */
+static bool create_mesh(VertexTestMesh *mesh, TestRng *rng, bool flat)
+{
+  mesh->count = VERTEX_TEST_COUNT;
+  mesh->positions = MIUR_ARR(float, mesh->count * 3);
+  mesh->normals = MIUR_ARR(float, mesh->count * 3);
+  mesh->uvs = MIUR_ARR(float, mesh->count * 2);
+  if (mesh->positions == NULL || mesh->normals == NULL || mesh->uvs == NULL)
+  {
+    return false;
+  }
+
+  float min[3], size[3];
+  for (int c = 0; c < 3; c++)
+  {
+    min[c] = test_rng_float(rng, -1000.0f, 1000.0f);
+    size[c] = test_rng_float(rng, 0.01f, 100.0f);
+  }
+  for (size_t i = 0; i < mesh->count; i++)
+  {
+    for (int c = 0; c < 3; c++)
+    {
+      mesh->positions[i * 3 + c] = flat && c == 1 ? min[c] :
+        min[c] + test_rng_float(rng, 0.0f, size[c]);
+    }
+
+    float *n = &mesh->normals[i * 3];
+    uint64_t kind = test_rng_below(rng, 10);
+    if (kind == 0)
+    {
+      n[0] = n[1] = n[2] = 0.0f;
+      n[test_rng_below(rng, 3)] = test_rng_below(rng, 2) ? 1.0f : -1.0f;
+    }
+    else
+    {
+      random_unit(n, rng);
+    }
+
+    for (int c = 0; c < 2; c++)
+    {
+      float *uv = &mesh->uvs[i * 2 + c];
+      kind = test_rng_below(rng, 10);
+      *uv = kind == 0 ? (float) test_rng_below(rng, 5) * 0.25f :
+        kind == 1 ? test_rng_float(rng, -1e-5f, 1e-5f) :
+        test_rng_float(rng, -2.0f, 2.0f);
+    }
+  }
+  return true;
+}
+
+static void random_unit(float *out, TestRng *rng)
+{
+  float length;
+  do
+  {
+    length = 0.0f;
+    for (int c = 0; c < 3; c++)
+    {
+      out[c] = test_rng_float(rng, -1.0f, 1.0f);
+      length += out[c] * out[c];
+    }
+  } while (length < 0.01f || length > 1.0f);
+  length = 1.0f / sqrtf(length);
+  for (int c = 0; c < 3; c++)
+  {
+    out[c] *= length;
+  }
+}
+
+static void destroy_mesh(VertexTestMesh *mesh)
+{
+  MIUR_FREE(mesh->positions);
+  MIUR_FREE(mesh->normals);
+  MIUR_FREE(mesh->uvs);
+}
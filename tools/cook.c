@@ -0,0 +1,1084 @@
+/* =====================
+ * tools/cook.c
+ * 10/18/2026
+ * Cooks assets and shaders into the files the runtime loads.
+ * ====================
+ */
+
+/*
+ * Walks the assets and shaders directories under a root and cooks, on
+ * every core:
+ *
+ *   *.vert, *.frag           SPIR-V, as <file>.spv
+ *   *.gltf, *.glb            mesh caches, see mesh_cache.h, optimized
+ *                            with their levels of detail and meshlets,
+ *                            vertices still as floats
+ *   assets/technique.json    material tables, see material_table.h
+ *   assets/effect.json
+ *   *.png, *.jpg, *.jpeg     BC7 KTX2, as <file>.ktx2, unless a model uses
+ *                            them and has them cooked into its cache
+ *
+ * Shaders and models cook first, then the tables that embed the shaders
+ * and the images no model took.  The asset database <root>/cook.miurdb
+ * records what each output was cooked from, outputs whose sources still
+ * hash the same are left as they are.  Technique files name shaders as the
+ * runtime opens them, relative to the directory it runs in, so the cook is
+ * run from there too with the root as seen from it, ".." by default.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <shaderc/shaderc.h>
+
+#include <miur/arena.h>
+#include <miur/asset_db.h>
+#include <miur/config.h>
+#include <miur/gltf.h>
+#include <miur/job.h>
+#include <miur/ktx.h>
+#include <miur/log.h>
+#include <miur/material_table.h>
+#include <miur/mem.h>
+#include <miur/membuf.h>
+#include <miur/mesh_cache.h>
+#include <miur/texture.h>
+#include <miur/texture_compress.h>
+#include <miur/thread.h>
+
+#ifdef MIUR_PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+/* Seeds every input hash, bumped when outputs change for the same input. */
+#define COOK_VERSION 1
+#define COOK_DEFAULT_ROOT ".."
+#define COOK_DB_NAME "cook" ASSET_DB_EXTENSION
+#define COOK_TECHNIQUE_FILE "assets/technique.json"
+#define COOK_EFFECT_FILE "assets/effect.json"
+#define COOK_SPIRV_EXTENSION ".spv"
+/* As gltf.c cooks the images of models. */
+#define COOK_MIP_FILTER MIP_FILTER_KAISER
+#define COOK_TEXTURE_QUALITY TEXTURE_QUALITY_NORMAL
+
+typedef enum
+{
+  COOK_SHADER,
+  COOK_MODEL,
+  COOK_TECHNIQUES,
+  COOK_EFFECTS,
+  COOK_TEXTURE,
+} CookKind;
+
+typedef enum
+{
+  COOK_STATUS_PENDING,
+  COOK_STATUS_CURRENT,
+  COOK_STATUS_COOKED,
+  COOK_STATUS_FAILED,
+  COOK_STATUS_SKIPPED,         /* An image cooked into a model instead. */
+} CookStatus;
+
+typedef struct Cook Cook;
+
+typedef struct
+{
+  Cook *cook;
+  CookKind kind;
+  CookStatus status;
+  char *source;
+  char *output;
+  char *dependencies;          /* NUL terminated, the source first. */
+  size_t dependencies_size;
+  size_t dependency_count;
+  uint64_t input_hash;
+  uint64_t start_ns;           /* Since the cook started. */
+  uint64_t time_ns;
+} CookArtifact;
+
+struct Cook
+{
+  JobSystem *jobs;
+  shaderc_compiler_t compiler;
+  bool force;
+  char *technique_path;
+  char *effect_path;
+  uint64_t start_ns;
+  CookArtifact *artifacts;
+  size_t count;
+  size_t capacity;
+};
+
+/* === PROTOTYPES === */
+
+static bool walk(Cook *cook, const char *dir);
+static bool add_source(Cook *cook, char *path);
+static bool has_extension(const char *path, const char *extension);
+static void check_current(Cook *cook, const AssetDb *db);
+static bool file_exists(const char *path);
+static bool run_phase(Cook *cook, uint32_t kinds);
+static void cook_job(void *ud);
+static bool cook_shader(CookArtifact *artifact);
+static bool cook_model(CookArtifact *artifact);
+static bool cook_techniques(CookArtifact *artifact);
+static bool add_table_shader(CookArtifact *artifact,
+                             MaterialTableShaderCode *shaders,
+                             Membuf *code, size_t *shader_count,
+                             String path, Arena *arena);
+static bool cook_effects(CookArtifact *artifact);
+static bool cook_texture(CookArtifact *artifact);
+static void skip_model_images(Cook *cook);
+static bool add_dependency(CookArtifact *artifact, const char *dir,
+                           size_t dir_len, const char *path);
+static const char *next_dependency(const CookArtifact *artifact,
+                                   const char *prev);
+static const char **dependency_array(const CookArtifact *artifact);
+static bool hash_inputs(CookArtifact *artifact);
+static bool record(Cook *cook, AssetDb *db);
+static void write_report(FILE *out, const Cook *cook, uint64_t wall_ns);
+static int compare_time(const void *a, const void *b);
+static size_t dir_len(const char *path);
+static char *join_path(const char *dir, const char *name);
+static char *append(const char *path, const char *extension);
+
+/* === GLOBALS === */
+
+static const char *const status_names[] = {
+  "pending", "current", "cooked", "FAILED", "skipped",
+};
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(int argc, char *argv[])
+{
+  uint32_t workers = 0;
+  const char *report_path = NULL;
+  Cook cook = { 0 };
+  int arg = 1;
+  for (; arg < argc && argv[arg][0] == '-'; arg++)
+  {
+    if (strcmp(argv[arg], "-f") == 0)
+    {
+      cook.force = true;
+    }
+    else if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc)
+    {
+      workers = (uint32_t) strtoul(argv[++arg], NULL, 10);
+    }
+    else if (strcmp(argv[arg], "-r") == 0 && arg + 1 < argc)
+    {
+      report_path = argv[++arg];
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  if (argc - arg > 1 || (arg < argc && argv[arg][0] == '-'))
+  {
+    fprintf(stderr, "usage: %s [-f] [-j workers] [-r report] [root]\n"
+            "Cooks <root>/assets and <root>/shaders, root defaults to "
+            "'%s'.  Run it from\nthe directory the runtime runs in.\n"
+            "-f cooks everything, whether or not it is up to date.\n"
+            "-j sets the worker threads, by default one per core.\n"
+            "-r also writes the report of what was cooked, and how long "
+            "it took, to\n`report`.\n",
+            argv[0], COOK_DEFAULT_ROOT);
+    return EXIT_FAILURE;
+  }
+  const char *root = arg < argc ? argv[arg] : COOK_DEFAULT_ROOT;
+
+  int result = EXIT_FAILURE;
+  AssetDb db;
+  bool db_open = false;
+  char *db_path = join_path(root, COOK_DB_NAME);
+  char *assets_dir = join_path(root, "assets");
+  char *shaders_dir = join_path(root, "shaders");
+  cook.technique_path = join_path(root, COOK_TECHNIQUE_FILE);
+  cook.effect_path = join_path(root, COOK_EFFECT_FILE);
+  if (db_path == NULL || assets_dir == NULL || shaders_dir == NULL ||
+      cook.technique_path == NULL || cook.effect_path == NULL)
+  {
+    goto cleanup;
+  }
+
+  if (!walk(&cook, shaders_dir) || !walk(&cook, assets_dir))
+  {
+    goto cleanup;
+  }
+  if (!asset_db_open(&db, db_path))
+  {
+    goto cleanup;
+  }
+  db_open = true;
+
+  cook.jobs = job_system_create(workers);
+  cook.compiler = shaderc_compiler_initialize();
+  if (cook.jobs == NULL || cook.compiler == NULL)
+  {
+    goto cleanup;
+  }
+
+  cook.start_ns = thread_time_ns();
+  check_current(&cook, &db);
+  bool ran = run_phase(&cook, 1u << COOK_SHADER | 1u << COOK_MODEL);
+  skip_model_images(&cook);
+  ran = run_phase(&cook, 1u << COOK_TECHNIQUES | 1u << COOK_EFFECTS |
+                  1u << COOK_TEXTURE) && ran;
+  uint64_t wall_ns = thread_time_ns() - cook.start_ns;
+
+  /* Whatever did cook is recorded, even if something else failed. */
+  bool recorded = record(&cook, &db) && asset_db_save(&db);
+  if (!recorded)
+  {
+    MIUR_LOG_ERR("Couldn't save '%s'", db_path);
+  }
+
+  write_report(stdout, &cook, wall_ns);
+  bool reported = true;
+  if (report_path != NULL)
+  {
+    FILE *report = fopen(report_path, "w");
+    if (report != NULL)
+    {
+      write_report(report, &cook, wall_ns);
+    }
+    reported = report != NULL && fclose(report) == 0;
+    if (!reported)
+    {
+      MIUR_LOG_ERR("Couldn't write '%s'", report_path);
+    }
+  }
+
+  bool failed = false;
+  for (size_t i = 0; i < cook.count; i++)
+  {
+    failed |= cook.artifacts[i].status == COOK_STATUS_FAILED;
+  }
+  result = ran && recorded && reported && !failed ? EXIT_SUCCESS :
+    EXIT_FAILURE;
+
+cleanup:
+  if (cook.compiler != NULL)
+  {
+    shaderc_compiler_release(cook.compiler);
+  }
+  if (cook.jobs != NULL)
+  {
+    job_system_destroy(cook.jobs);
+  }
+  if (db_open)
+  {
+    asset_db_close(&db);
+  }
+  for (size_t i = 0; i < cook.count; i++)
+  {
+    MIUR_FREE(cook.artifacts[i].source);
+    MIUR_FREE(cook.artifacts[i].output);
+    MIUR_FREE(cook.artifacts[i].dependencies);
+  }
+  MIUR_FREE(cook.artifacts);
+  MIUR_FREE(cook.technique_path);
+  MIUR_FREE(cook.effect_path);
+  MIUR_FREE(shaders_dir);
+  MIUR_FREE(assets_dir);
+  MIUR_FREE(db_path);
+  return result;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+#ifdef MIUR_PLATFORM_WINDOWS
+
+static bool walk(Cook *cook, const char *dir)
+{
+  char *pattern = join_path(dir, "*");
+  if (pattern == NULL)
+  {
+    return false;
+  }
+  WIN32_FIND_DATAA data;
+  HANDLE find = FindFirstFileA(pattern, &data);
+  MIUR_FREE(pattern);
+  if (find == INVALID_HANDLE_VALUE)
+  {
+    MIUR_LOG_ERR("Can't read directory '%s'", dir);
+    return false;
+  }
+
+  bool result = true;
+  do
+  {
+    /* Also skips "." and "..". */
+    if (data.cFileName[0] == '.')
+    {
+      continue;
+    }
+    char *path = join_path(dir, data.cFileName);
+    if (path == NULL)
+    {
+      result = false;
+    }
+    else if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+    {
+      result = walk(cook, path) && result;
+      MIUR_FREE(path);
+    }
+    else
+    {
+      result = add_source(cook, path) && result;
+    }
+  } while (FindNextFileA(find, &data));
+  FindClose(find);
+  return result;
+}
+
+#else
+
+static bool walk(Cook *cook, const char *dir)
+{
+  DIR *handle = opendir(dir);
+  if (handle == NULL)
+  {
+    MIUR_LOG_ERR("Can't read directory '%s'", dir);
+    return false;
+  }
+
+  bool result = true;
+  struct dirent *entry;
+  while ((entry = readdir(handle)) != NULL)
+  {
+    /* Also skips "." and "..". */
+    if (entry->d_name[0] == '.')
+    {
+      continue;
+    }
+    char *path = join_path(dir, entry->d_name);
+    struct stat st;
+    if (path == NULL || stat(path, &st) != 0)
+    {
+      MIUR_FREE(path);
+      result = false;
+    }
+    else if (S_ISDIR(st.st_mode))
+    {
+      result = walk(cook, path) && result;
+      MIUR_FREE(path);
+    }
+    else
+    {
+      result = add_source(cook, path) && result;
+    }
+  }
+  closedir(handle);
+  return result;
+}
+
+#endif
+
+/* Takes `path`, which is freed if nothing cooks from it. */
+static bool add_source(Cook *cook, char *path)
+{
+  CookKind kind;
+  const char *extension;
+  if (has_extension(path, ".vert") || has_extension(path, ".frag"))
+  {
+    kind = COOK_SHADER;
+    extension = COOK_SPIRV_EXTENSION;
+  }
+  else if (has_extension(path, ".gltf") || has_extension(path, ".glb"))
+  {
+    kind = COOK_MODEL;
+    extension = MESH_CACHE_EXTENSION;
+  }
+  else if (strcmp(path, cook->technique_path) == 0)
+  {
+    kind = COOK_TECHNIQUES;
+    extension = MATERIAL_TABLE_EXTENSION;
+  }
+  else if (strcmp(path, cook->effect_path) == 0)
+  {
+    kind = COOK_EFFECTS;
+    extension = MATERIAL_TABLE_EXTENSION;
+  }
+  else if (has_extension(path, ".png") || has_extension(path, ".jpg") ||
+           has_extension(path, ".jpeg"))
+  {
+    kind = COOK_TEXTURE;
+    extension = KTX_EXTENSION;
+  }
+  else
+  {
+    MIUR_FREE(path);
+    return true;
+  }
+
+  if (cook->count == cook->capacity)
+  {
+    size_t capacity = cook->capacity > 0 ? cook->capacity * 2 : 64;
+    CookArtifact *artifacts = MIUR_REALLOC(CookArtifact, cook->artifacts,
+                                           capacity);
+    if (artifacts == NULL)
+    {
+      MIUR_FREE(path);
+      return false;
+    }
+    cook->artifacts = artifacts;
+    cook->capacity = capacity;
+  }
+
+  char *output = append(path, extension);
+  if (output == NULL)
+  {
+    MIUR_FREE(path);
+    return false;
+  }
+  CookArtifact *artifact = &cook->artifacts[cook->count++];
+  memset(artifact, 0, sizeof(CookArtifact));
+  artifact->cook = cook;
+  artifact->kind = kind;
+  artifact->source = path;
+  artifact->output = output;
+  return true;
+}
+
+static bool has_extension(const char *path, const char *extension)
+{
+  size_t len = strlen(path), extension_len = strlen(extension);
+  return len > extension_len &&
+    strcmp(path + len - extension_len, extension) == 0;
+}
+
+/*
+ * Finds the outputs still current.  Every dependency of every output the
+ * database knows is hashed in one parallel batch.
+ */
+static void check_current(Cook *cook, const AssetDb *db)
+{
+  const AssetDbEntry **entries = MIUR_ARR(const AssetDbEntry *,
+                                          cook->count + 1);
+  if (entries == NULL || cook->force)
+  {
+    MIUR_FREE(entries);
+    return;
+  }
+
+  size_t total = 0;
+  for (size_t i = 0; i < cook->count; i++)
+  {
+    const CookArtifact *artifact = &cook->artifacts[i];
+    entries[i] = asset_db_find(db, artifact->output);
+    if (entries[i] != NULL && !file_exists(artifact->output))
+    {
+      entries[i] = NULL;
+    }
+    total += entries[i] != NULL ? entries[i]->dependency_count : 0;
+  }
+
+  const char **paths = MIUR_ARR(const char *, total + 1);
+  uint64_t *hashes = MIUR_ARR(uint64_t, total + 1);
+  if (paths == NULL || hashes == NULL)
+  {
+    goto cleanup;
+  }
+  size_t offset = 0;
+  for (size_t i = 0; i < cook->count; i++)
+  {
+    for (const char *dep = entries[i] == NULL ? NULL :
+           asset_db_next_dependency(db, entries[i], NULL);
+         dep != NULL; dep = asset_db_next_dependency(db, entries[i], dep))
+    {
+      paths[offset++] = dep;
+    }
+  }
+  /* Sources that are gone hash to 0, which never matches. */
+  asset_db_hash_files(cook->jobs, paths, total, hashes);
+
+  offset = 0;
+  for (size_t i = 0; i < cook->count; i++)
+  {
+    CookArtifact *artifact = &cook->artifacts[i];
+    if (entries[i] == NULL)
+    {
+      continue;
+    }
+    size_t count = entries[i]->dependency_count;
+    uint64_t input_hash = asset_db_input_hash(paths + offset,
+                                              hashes + offset, count,
+                                              COOK_VERSION);
+    if (input_hash == entries[i]->input_hash)
+    {
+      bool copied = true;
+      for (size_t j = 0; j < count; j++)
+      {
+        copied = copied && add_dependency(artifact, NULL, 0,
+                                          paths[offset + j]);
+      }
+      artifact->status = copied ? COOK_STATUS_CURRENT : COOK_STATUS_PENDING;
+      artifact->input_hash = input_hash;
+    }
+    offset += count;
+  }
+
+cleanup:
+  MIUR_FREE(hashes);
+  MIUR_FREE(paths);
+  MIUR_FREE(entries);
+}
+
+static bool file_exists(const char *path)
+{
+  FILE *file = fopen(path, "rb");
+  if (file != NULL)
+  {
+    fclose(file);
+  }
+  return file != NULL;
+}
+
+/* Cooks every pending artifact of the `kinds` given as bits, in parallel. */
+static bool run_phase(Cook *cook, uint32_t kinds)
+{
+  Job *descs = MIUR_ARR(Job, cook->count + 1);
+  if (descs == NULL)
+  {
+    return false;
+  }
+  size_t count = 0;
+  for (size_t i = 0; i < cook->count; i++)
+  {
+    CookArtifact *artifact = &cook->artifacts[i];
+    if (artifact->status == COOK_STATUS_PENDING &&
+        (kinds & 1u << artifact->kind))
+    {
+      descs[count].function = cook_job;
+      descs[count].ud = artifact;
+      count++;
+    }
+  }
+
+  JobCounter done = { 0 };
+  job_run(cook->jobs, descs, count, &done);
+  job_wait(cook->jobs, &done);
+  MIUR_FREE(descs);
+  return true;
+}
+
+/*
+ * The time taken is from start to finish on the worker, which includes
+ * other jobs it ran while waiting on a load or compression of its own.
+ */
+static void cook_job(void *ud)
+{
+  CookArtifact *artifact = (CookArtifact *) ud;
+  uint64_t start = thread_time_ns();
+  bool cooked = add_dependency(artifact, NULL, 0, artifact->source);
+  if (cooked)
+  {
+    switch (artifact->kind)
+    {
+    case COOK_SHADER:
+      cooked = cook_shader(artifact);
+      break;
+    case COOK_MODEL:
+      cooked = cook_model(artifact);
+      break;
+    case COOK_TECHNIQUES:
+      cooked = cook_techniques(artifact);
+      break;
+    case COOK_EFFECTS:
+      cooked = cook_effects(artifact);
+      break;
+    case COOK_TEXTURE:
+      cooked = cook_texture(artifact);
+      break;
+    }
+  }
+  cooked = cooked && hash_inputs(artifact);
+
+  uint64_t end = thread_time_ns();
+  artifact->status = cooked ? COOK_STATUS_COOKED : COOK_STATUS_FAILED;
+  artifact->start_ns = start - artifact->cook->start_ns;
+  artifact->time_ns = end - start;
+}
+
+static bool cook_shader(CookArtifact *artifact)
+{
+  Cook *cook = artifact->cook;
+  Membuf source;
+  if (!membuf_load_file(&source, artifact->source))
+  {
+    MIUR_LOG_ERR("Can't read '%s'", artifact->source);
+    return false;
+  }
+
+  uint32_t stage = material_shader_stage(string_from_cstr(artifact->source));
+  shaderc_shader_kind kind = stage == VK_SHADER_STAGE_VERTEX_BIT ?
+    shaderc_vertex_shader : shaderc_fragment_shader;
+  shaderc_compile_options_t options = shaderc_compile_options_initialize();
+  shaderc_compile_options_set_optimization_level(
+    options, shaderc_optimization_level_performance);
+  /* The compiler is safe to share, compiles run in parallel. */
+  shaderc_compilation_result_t compiled =
+    shaderc_compile_into_spv(cook->compiler, (const char *) source.data,
+                             source.size, kind, artifact->source, "main",
+                             options);
+  shaderc_compile_options_release(options);
+  membuf_destroy(&source);
+
+  bool result = false;
+  if (shaderc_result_get_compilation_status(compiled) !=
+      shaderc_compilation_status_success)
+  {
+    MIUR_LOG_ERR("Failed to compile shader file '%s'\n%s", artifact->source,
+                 shaderc_result_get_error_message(compiled));
+  }
+  else
+  {
+    Membuf code = {
+      .data = (const uint8_t *) shaderc_result_get_bytes(compiled),
+      .size = shaderc_result_get_length(compiled),
+      .kind = MEMBUF_VIEW,
+    };
+    result = membuf_replace_file(code, artifact->output);
+    if (!result)
+    {
+      MIUR_LOG_ERR("Can't write '%s'", artifact->output);
+    }
+  }
+  shaderc_result_release(compiled);
+  return result;
+}
+
+static bool cook_model(CookArtifact *artifact)
+{
+  Cook *cook = artifact->cook;
+  /* Loading writes the cache, unless it maps one that's current. */
+  if (cook->force)
+  {
+    remove(artifact->output);
+  }
+  StaticModel model;
+  GLTFLoad *load = gltf_load_async(&model, artifact->source, cook->jobs,
+                                   NULL);
+  if (load == NULL || !gltf_load_wait(load))
+  {
+    MIUR_LOG_ERR("Failed to load model '%s'", artifact->source);
+    return false;
+  }
+  gltf_model_destroy(&model);
+
+  MeshCache cache;
+  if (!mesh_cache_open(&cache, artifact->output))
+  {
+    MIUR_LOG_ERR("'%s' wasn't written", artifact->output);
+    return false;
+  }
+  /* Relative to the model, as the load resolves them. */
+  bool result = true;
+  size_t prefix_len = dir_len(artifact->source);
+  for (const char *dep = mesh_cache_next_dependency(&cache, NULL);
+       dep != NULL && result; dep = mesh_cache_next_dependency(&cache, dep))
+  {
+    result = add_dependency(artifact, artifact->source, prefix_len, dep);
+  }
+  mesh_cache_close(&cache);
+  return result;
+}
+
+static bool cook_techniques(CookArtifact *artifact)
+{
+  Membuf file;
+  if (!membuf_load_file(&file, artifact->source))
+  {
+    MIUR_LOG_ERR("Can't read '%s'", artifact->source);
+    return false;
+  }
+
+  bool result = false;
+  Arena arena;
+  ParseError error;
+  TechniqueDesc *descs;
+  size_t count;
+  size_t shader_count = 0;
+  MaterialTableShaderCode *shaders = NULL;
+  Membuf *code = NULL;
+  arena_create(&arena, 0);
+  if (!technique_file_parse(file, &arena, &descs, &count, &error))
+  {
+    MIUR_LOG_ERR("Error parsing technique config file '%s'\n%d:%d: %s",
+                 artifact->source, error.line, error.col, error.msg);
+    goto cleanup;
+  }
+
+  /* Every technique can name two shaders of its own. */
+  shaders = MIUR_ARR(MaterialTableShaderCode, count * 2 + 1);
+  code = MIUR_ARR(Membuf, count * 2 + 1);
+  if (shaders == NULL || code == NULL)
+  {
+    goto cleanup;
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    if (!add_table_shader(artifact, shaders, code, &shader_count,
+                          descs[i].vert, &arena) ||
+        !add_table_shader(artifact, shaders, code, &shader_count,
+                          descs[i].frag, &arena))
+    {
+      goto cleanup;
+    }
+  }
+  result = material_table_write(artifact->source, descs, count, NULL, 0,
+                                shaders, shader_count);
+
+cleanup:
+  for (size_t i = 0; i < shader_count; i++)
+  {
+    membuf_destroy(&code[i]);
+  }
+  MIUR_FREE(code);
+  MIUR_FREE(shaders);
+  arena_destroy(&arena);
+  membuf_destroy(&file);
+  return result;
+}
+
+/*
+ * Reads the SPIR-V of a shader a technique names, unless an earlier
+ * technique did.  The shader must have been cooked, or be current, in this
+ * run, so the table never takes code older than the GLSL it records.
+ */
+static bool add_table_shader(CookArtifact *artifact,
+                             MaterialTableShaderCode *shaders,
+                             Membuf *code, size_t *shader_count,
+                             String path, Arena *arena)
+{
+  for (size_t i = 0; i < *shader_count; i++)
+  {
+    if (string_eq(&shaders[i].path, &path))
+    {
+      return true;
+    }
+  }
+
+  char *glsl = (char *) arena_alloc(arena, path.size + 1);
+  if (glsl == NULL)
+  {
+    return false;
+  }
+  memcpy(glsl, path.data, path.size);
+  glsl[path.size] = '\0';
+
+  const Cook *cook = artifact->cook;
+  const CookArtifact *shader = NULL;
+  for (size_t i = 0; i < cook->count && shader == NULL; i++)
+  {
+    const CookArtifact *other = &cook->artifacts[i];
+    shader = other->kind == COOK_SHADER &&
+      strcmp(other->source, glsl) == 0 ? other : NULL;
+  }
+  if (shader == NULL)
+  {
+    MIUR_LOG_ERR("'%s' names '%s', which isn't under the shaders directory",
+                 artifact->source, glsl);
+    return false;
+  }
+  if (shader->status != COOK_STATUS_COOKED &&
+      shader->status != COOK_STATUS_CURRENT)
+  {
+    MIUR_LOG_ERR("'%s' needs '%s', which failed to cook", artifact->source,
+                 glsl);
+    return false;
+  }
+
+  Membuf *spirv = &code[*shader_count];
+  if (!membuf_load_file(spirv, shader->output))
+  {
+    MIUR_LOG_ERR("Can't read '%s'", shader->output);
+    return false;
+  }
+  shaders[*shader_count] = (MaterialTableShaderCode) {
+    .path = path,
+    .stage = material_shader_stage(path),
+    .code = spirv->data,
+    .size = spirv->size,
+  };
+  (*shader_count)++;
+  return add_dependency(artifact, NULL, 0, glsl);
+}
+
+static bool cook_effects(CookArtifact *artifact)
+{
+  Membuf file;
+  if (!membuf_load_file(&file, artifact->source))
+  {
+    MIUR_LOG_ERR("Can't read '%s'", artifact->source);
+    return false;
+  }
+
+  Arena arena;
+  ParseError error;
+  EffectDesc *descs;
+  size_t count;
+  arena_create(&arena, 0);
+  bool result = effect_file_parse(file, &arena, &descs, &count, &error);
+  if (!result)
+  {
+    MIUR_LOG_ERR("Error parsing effect config file '%s'\n%d:%d: %s",
+                 artifact->source, error.line, error.col, error.msg);
+  }
+  else
+  {
+    /* Techniques are looked up by name on load, from their own table. */
+    result = material_table_write(artifact->source, NULL, 0, descs, count,
+                                  NULL, 0);
+  }
+  arena_destroy(&arena);
+  membuf_destroy(&file);
+  return result;
+}
+
+static bool cook_texture(CookArtifact *artifact)
+{
+  Membuf file;
+  if (!membuf_load_file(&file, artifact->source))
+  {
+    MIUR_LOG_ERR("Can't read '%s'", artifact->source);
+    return false;
+  }
+
+  /* Images on their own are taken to be color. */
+  Texture decoded = { 0 };
+  Texture compressed = { 0 };
+  bool result =
+    texture_decode(&decoded, file.data, file.size, true, COOK_MIP_FILTER) &&
+    texture_compress(&compressed, &decoded, TEXTURE_FORMAT_BC7_SRGB,
+                     COOK_TEXTURE_QUALITY, artifact->cook->jobs) &&
+    ktx_write(&compressed, artifact->output);
+  if (!result)
+  {
+    MIUR_LOG_ERR("Failed to cook texture '%s'", artifact->source);
+  }
+  texture_destroy(&compressed);
+  texture_destroy(&decoded);
+  membuf_destroy(&file);
+  return result;
+}
+
+/* Images a model depends on are already in its cache. */
+static void skip_model_images(Cook *cook)
+{
+  for (size_t i = 0; i < cook->count; i++)
+  {
+    CookArtifact *image = &cook->artifacts[i];
+    if (image->kind != COOK_TEXTURE || image->status != COOK_STATUS_PENDING)
+    {
+      continue;
+    }
+    for (size_t j = 0; j < cook->count; j++)
+    {
+      const CookArtifact *model = &cook->artifacts[j];
+      if (model->kind != COOK_MODEL)
+      {
+        continue;
+      }
+      for (const char *dep = next_dependency(model, NULL); dep != NULL;
+           dep = next_dependency(model, dep))
+      {
+        if (strcmp(dep, image->source) == 0)
+        {
+          image->status = COOK_STATUS_SKIPPED;
+        }
+      }
+    }
+  }
+}
+
+/* Appends `path`, after the first `dir_len` bytes of `dir`. */
+static bool add_dependency(CookArtifact *artifact, const char *dir,
+                           size_t dir_len, const char *path)
+{
+  size_t path_len = strlen(path);
+  size_t size = artifact->dependencies_size + dir_len + path_len + 1;
+  char *dependencies = MIUR_REALLOC(char, artifact->dependencies, size);
+  if (dependencies == NULL)
+  {
+    return false;
+  }
+  char *dst = dependencies + artifact->dependencies_size;
+  if (dir_len > 0)
+  {
+    memcpy(dst, dir, dir_len);
+  }
+  memcpy(dst + dir_len, path, path_len + 1);
+  artifact->dependencies = dependencies;
+  artifact->dependencies_size = size;
+  artifact->dependency_count++;
+  return true;
+}
+
+static const char *next_dependency(const CookArtifact *artifact,
+                                   const char *prev)
+{
+  const char *end = artifact->dependencies + artifact->dependencies_size;
+  const char *next = prev == NULL ? artifact->dependencies :
+    prev + strlen(prev) + 1;
+  return next < end ? next : NULL;
+}
+
+static const char **dependency_array(const CookArtifact *artifact)
+{
+  const char **paths = MIUR_ARR(const char *,
+                                artifact->dependency_count + 1);
+  size_t i = 0;
+  for (const char *dep = next_dependency(artifact, NULL);
+       paths != NULL && dep != NULL; dep = next_dependency(artifact, dep))
+  {
+    paths[i++] = dep;
+  }
+  return paths;
+}
+
+/* Hashes the dependencies as read, on the worker that cooked them. */
+static bool hash_inputs(CookArtifact *artifact)
+{
+  const char **paths = dependency_array(artifact);
+  uint64_t *hashes = MIUR_ARR(uint64_t, artifact->dependency_count + 1);
+  bool result = paths != NULL && hashes != NULL &&
+    asset_db_hash_files(NULL, paths, artifact->dependency_count, hashes);
+  if (result)
+  {
+    artifact->input_hash = asset_db_input_hash(paths, hashes,
+                                               artifact->dependency_count,
+                                               COOK_VERSION);
+  }
+  else
+  {
+    MIUR_LOG_ERR("Can't hash the sources of '%s'", artifact->output);
+  }
+  MIUR_FREE(hashes);
+  MIUR_FREE(paths);
+  return result;
+}
+
+static bool record(Cook *cook, AssetDb *db)
+{
+  bool result = true;
+  for (size_t i = 0; i < cook->count && result; i++)
+  {
+    const CookArtifact *artifact = &cook->artifacts[i];
+    if (artifact->status != COOK_STATUS_COOKED)
+    {
+      continue;
+    }
+    const char **paths = dependency_array(artifact);
+    uint64_t time_us = artifact->time_ns / 1000;
+    result = paths != NULL &&
+      asset_db_record(db, artifact->output, artifact->input_hash, paths,
+                      artifact->dependency_count,
+                      time_us < UINT32_MAX ? (uint32_t) time_us : UINT32_MAX);
+    MIUR_FREE(paths);
+  }
+  return result;
+}
+
+/* One line per output, the slowest first, then the totals. */
+static void write_report(FILE *out, const Cook *cook, uint64_t wall_ns)
+{
+  const CookArtifact **sorted = MIUR_ARR(const CookArtifact *,
+                                         cook->count + 1);
+  if (sorted == NULL)
+  {
+    return;
+  }
+  size_t count = 0;
+  size_t totals[COOK_STATUS_SKIPPED + 1] = { 0 };
+  uint64_t busy_ns = 0;
+  for (size_t i = 0; i < cook->count; i++)
+  {
+    const CookArtifact *artifact = &cook->artifacts[i];
+    totals[artifact->status]++;
+    busy_ns += artifact->time_ns;
+    if (artifact->status != COOK_STATUS_SKIPPED)
+    {
+      sorted[count++] = artifact;
+    }
+  }
+  qsort(sorted, count, sizeof(const CookArtifact *), compare_time);
+
+  fprintf(out, "%-8s %10s %10s  %s\n", "status", "start ms", "ms", "output");
+  for (size_t i = 0; i < count; i++)
+  {
+    const CookArtifact *artifact = sorted[i];
+    if (artifact->status == COOK_STATUS_CURRENT)
+    {
+      fprintf(out, "%-8s %10s %10s  %s\n", status_names[artifact->status],
+              "-", "-", artifact->output);
+    }
+    else
+    {
+      fprintf(out, "%-8s %10.1f %10.1f  %s\n",
+              status_names[artifact->status], artifact->start_ns / 1e6,
+              artifact->time_ns / 1e6, artifact->output);
+    }
+  }
+  fprintf(out, "%zu cooked, %zu up to date, %zu failed, %zu images in "
+          "models\n", totals[COOK_STATUS_COOKED],
+          totals[COOK_STATUS_CURRENT], totals[COOK_STATUS_FAILED],
+          totals[COOK_STATUS_SKIPPED]);
+  fprintf(out, "wall %.1f ms, busy %.1f ms across %" PRIu32 " threads\n",
+          wall_ns / 1e6, busy_ns / 1e6, job_system_thread_count(cook->jobs));
+  MIUR_FREE(sorted);
+}
+
+static int compare_time(const void *a, const void *b)
+{
+  const CookArtifact *x = *(const CookArtifact *const *) a;
+  const CookArtifact *y = *(const CookArtifact *const *) b;
+  return (x->time_ns < y->time_ns) - (x->time_ns > y->time_ns);
+}
+
+/* Length of the directory part of `path`, with its separator. */
+static size_t dir_len(const char *path)
+{
+  size_t len = strlen(path);
+  while (len > 0 && path[len - 1] != '/' && path[len - 1] != '\\')
+  {
+    len--;
+  }
+  return len;
+}
+
+static char *join_path(const char *dir, const char *name)
+{
+  size_t dir_len = strlen(dir), name_len = strlen(name);
+  char *path = MIUR_ARR(char, dir_len + name_len + 2);
+  if (path == NULL)
+  {
+    return NULL;
+  }
+  memcpy(path, dir, dir_len);
+  path[dir_len] = '/';
+  memcpy(path + dir_len + 1, name, name_len + 1);
+  return path;
+}
+
+static char *append(const char *path, const char *extension)
+{
+  size_t path_len = strlen(path), extension_len = strlen(extension);
+  char *out = MIUR_ARR(char, path_len + extension_len + 1);
+  if (out == NULL)
+  {
+    return NULL;
+  }
+  memcpy(out, path, path_len);
+  memcpy(out + path_len, extension, extension_len + 1);
+  return out;
+}
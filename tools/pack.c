@@ -0,0 +1,91 @@
+/* =====================
+ * tools/pack.c
+ * 10/18/2026
+ * Packs files into an asset archive.
+ * ====================
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <miur/archive.h>
+#include <miur/log.h>
+#include <miur/mem.h>
+
+/* === PROTOTYPES === */
+
+static char *join_path(const char *dir, const char *name);
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(int argc, char *argv[])
+{
+  bool compress = argc > 1 && strcmp(argv[1], "-z") == 0;
+  int first_arg = compress ? 2 : 1;
+
+  if (argc - first_arg < 2)
+  {
+    fprintf(stderr, "usage: %s [-z] <archive> <root dir> <file>...\n"
+            "Files are named in the archive by their path under the root, "
+            "e.g.\n  %s miur.pak .. assets/cube.gltf shaders/tri.vert\n"
+            "-z compresses files that shrink.\n",
+            argv[0], argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const char *archive_name = argv[first_arg];
+  const char *root = argv[first_arg + 1];
+  char **names = argv + first_arg + 2;
+  size_t count = argc - first_arg - 2;
+  ArchiveInput *inputs = MIUR_ARR(ArchiveInput, count > 0 ? count : 1);
+  int result = EXIT_FAILURE;
+  size_t loaded = 0;
+
+  for (; loaded < count; loaded++)
+  {
+    const char *name = names[loaded];
+    char *path = join_path(root, name);
+    inputs[loaded].name = name;
+    inputs[loaded].compress = compress;
+    bool ok = membuf_map_file(&inputs[loaded].data, path,
+                              MEMBUF_MAP_SEQUENTIAL);
+    if (!ok)
+    {
+      MIUR_LOG_ERR("Can't open '%s'", path);
+    }
+    MIUR_FREE(path);
+    if (!ok)
+    {
+      goto cleanup;
+    }
+  }
+
+  if (!archive_write(archive_name, inputs, count))
+  {
+    goto cleanup;
+  }
+  printf("Packed %zu files into '%s'\n", count, archive_name);
+  result = EXIT_SUCCESS;
+
+cleanup:
+  for (size_t i = 0; i < loaded; i++)
+  {
+    membuf_destroy(&inputs[i].data);
+  }
+  MIUR_FREE(inputs);
+  return result;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static char *join_path(const char *dir, const char *name)
+{
+  size_t dir_len = strlen(dir), name_len = strlen(name);
+  char *path = MIUR_ARR(char, dir_len + name_len + 2);
+  memcpy(path, dir, dir_len);
+  path[dir_len] = '/';
+  memcpy(path + dir_len + 1, name, name_len + 1);
+  return path;
+}
@@ -0,0 +1,402 @@
+/* =====================
+ * tools/texbench.c
+ * 10/18/2026
+ * Times decoding, mipping and compressing textures, and loading KTX2.
+ * ====================
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <miur/job.h>
+#include <miur/ktx.h>
+#include <miur/log.h>
+#include <miur/mem.h>
+#include <miur/membuf.h>
+#include <miur/texture.h>
+#include <miur/texture_compress.h>
+#include <miur/thread.h>
+
+#define TEXBENCH_DEFAULT_COUNT 500
+#define TEXBENCH_PATH_SIZE 1024
+
+typedef struct
+{
+  const Membuf *file;
+  MipFilter filter;
+  Texture texture;
+  Texture compressed;
+  uint64_t time_ns;            /* Spent decoding, on whichever thread. */
+  const char *ktx_path;
+  uint8_t *staging;            /* Stands in for a mapped staging buffer. */
+  bool ktx_loaded;
+} TexbenchTask;
+
+typedef struct
+{
+  const char *name;
+  TextureFormat format;
+  uint32_t channels;           /* Compared for PSNR, from red up. */
+} TexbenchFormat;
+
+/* === PROTOTYPES === */
+
+static void decode_job(void *ud);
+static void ktx_job(void *ud);
+static bool load_all(TexbenchTask *tasks, Job *descs, size_t count,
+                     size_t file_count, const char *dir, uint64_t decode_ns,
+                     JobSystem *jobs);
+static bool compress_all(TexbenchTask *tasks, size_t count,
+                         const TexbenchFormat *format,
+                         TextureQuality quality, JobSystem *jobs);
+static bool level_error(const Texture *texture, const Texture *compressed,
+                        uint32_t channels, double *error, uint64_t *samples);
+
+/* === GLOBALS === */
+
+static const TexbenchFormat formats[] = {
+  { "bc1", TEXTURE_FORMAT_BC1_SRGB, 3 },
+  { "bc3", TEXTURE_FORMAT_BC3_SRGB, 4 },
+  { "bc5", TEXTURE_FORMAT_BC5, 2 },
+  { "bc7", TEXTURE_FORMAT_BC7_SRGB, 4 },
+};
+
+static const char *const qualities[] = { "fast", "normal", "high" };
+
+/* === PUBLIC FUNCTIONS === */
+
+int main(int argc, char *argv[])
+{
+  size_t count = TEXBENCH_DEFAULT_COUNT;
+  uint32_t workers = 0;
+  MipFilter filter = MIP_FILTER_BOX;
+  const TexbenchFormat *format = NULL;
+  TextureQuality quality = TEXTURE_QUALITY_NORMAL;
+  const char *ktx_dir = NULL;
+  bool usage = false;
+  int arg = 1;
+  for (; arg < argc && argv[arg][0] == '-'; arg++)
+  {
+    if (strcmp(argv[arg], "-k") == 0)
+    {
+      filter = MIP_FILTER_KAISER;
+    }
+    else if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc)
+    {
+      count = strtoul(argv[++arg], NULL, 10);
+    }
+    else if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc)
+    {
+      workers = (uint32_t) strtoul(argv[++arg], NULL, 10);
+    }
+    else if (strcmp(argv[arg], "-b") == 0 && arg + 1 < argc)
+    {
+      arg++;
+      format = NULL;
+      for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+      {
+        format = strcmp(argv[arg], formats[i].name) == 0 ? &formats[i] :
+          format;
+      }
+      usage |= format == NULL;
+    }
+    else if (strcmp(argv[arg], "-x") == 0 && arg + 1 < argc)
+    {
+      ktx_dir = argv[++arg];
+    }
+    else if (strcmp(argv[arg], "-q") == 0 && arg + 1 < argc)
+    {
+      arg++;
+      size_t i = 0;
+      while (i < 3 && strcmp(argv[arg], qualities[i]) != 0)
+      {
+        i++;
+      }
+      usage |= i == 3;
+      quality = (TextureQuality) i;
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  if (usage || arg == argc || count == 0)
+  {
+    fprintf(stderr, "usage: %s [-k] [-n count] [-j workers] "
+            "[-b bc1|bc3|bc5|bc7 [-q fast|normal|high]] [-x dir] "
+            "<image>...\n"
+            "Decodes `count` textures, default %d, cycling through the PNG "
+            "and JPEG\nimages given, and builds their mips on every core.\n"
+            "-k uses the Kaiser filter instead of a box.\n"
+            "-j sets the worker threads, by default one per core.\n"
+            "-b then compresses each texture in turn across the threads, "
+            "and reports\nthe PSNR of the top levels.\n"
+            "-x writes each image's mips, compressed with -b, as KTX2 into "
+            "`dir` and\ntimes loading them into staging memory against "
+            "decoding.\n",
+            argv[0], TEXBENCH_DEFAULT_COUNT);
+    return EXIT_FAILURE;
+  }
+
+  size_t file_count = argc - arg;
+  Membuf *files = MIUR_ARR(Membuf, file_count);
+  TexbenchTask *tasks = MIUR_ARR(TexbenchTask, count);
+  Job *descs = MIUR_ARR(Job, count);
+  JobSystem *jobs = NULL;
+  int result = EXIT_FAILURE;
+  size_t loaded = 0;
+  if (files == NULL || tasks == NULL || descs == NULL)
+  {
+    goto cleanup;
+  }
+
+  /* Read up front, only decoding is timed. */
+  for (; loaded < file_count; loaded++)
+  {
+    if (!membuf_load_file(&files[loaded], argv[arg + loaded]))
+    {
+      MIUR_LOG_ERR("Can't open '%s'", argv[arg + loaded]);
+      goto cleanup;
+    }
+  }
+
+  for (size_t i = 0; i < count; i++)
+  {
+    tasks[i].file = &files[i % file_count];
+    tasks[i].filter = filter;
+    descs[i].function = decode_job;
+    descs[i].ud = &tasks[i];
+  }
+
+  jobs = job_system_create(workers);
+  if (jobs == NULL)
+  {
+    goto cleanup;
+  }
+  JobCounter done = { 0 };
+  uint64_t start = thread_time_ns();
+  job_run(jobs, descs, count, &done);
+  job_wait(jobs, &done);
+  uint64_t wall_ns = thread_time_ns() - start;
+
+  uint64_t thread_ns = 0;
+  uint64_t pixels = 0;
+  uint64_t bytes = 0;
+  size_t failed = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    const Texture *texture = &tasks[i].texture;
+    thread_ns += tasks[i].time_ns;
+    pixels += (uint64_t) texture->width * texture->height;
+    bytes += texture->size;
+    failed += texture->data == NULL;
+  }
+
+  printf("%zu textures on %" PRIu32 " threads, %zu failed\n", count,
+         job_system_thread_count(jobs), failed);
+  printf("  wall %.1f ms, %.2f ms per texture, %.1f MPix/s\n",
+         wall_ns / 1e6, wall_ns / 1e6 / count,
+         wall_ns > 0 ? pixels * 1e3 / wall_ns : 0.0);
+  printf("  busy %.1f ms across threads, %.1f MB of mips\n",
+         thread_ns / 1e6, bytes / 1e6);
+  result = failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+  if (format != NULL && failed == 0 &&
+      !compress_all(tasks, count, format, quality, jobs))
+  {
+    result = EXIT_FAILURE;
+  }
+  if (ktx_dir != NULL && result == EXIT_SUCCESS &&
+      !load_all(tasks, descs, count, file_count, ktx_dir, wall_ns, jobs))
+  {
+    result = EXIT_FAILURE;
+  }
+
+cleanup:
+  if (jobs != NULL)
+  {
+    job_system_destroy(jobs);
+  }
+  for (size_t i = 0; tasks != NULL && i < count; i++)
+  {
+    texture_destroy(&tasks[i].texture);
+    texture_destroy(&tasks[i].compressed);
+    MIUR_FREE(tasks[i].staging);
+  }
+  for (size_t i = 0; i < loaded; i++)
+  {
+    membuf_destroy(&files[i]);
+  }
+  MIUR_FREE(files);
+  MIUR_FREE(tasks);
+  MIUR_FREE(descs);
+  return result;
+}
+
+/* === PRIVATE FUNCTIONS === */
+
+static void decode_job(void *ud)
+{
+  TexbenchTask *task = (TexbenchTask *) ud;
+  uint64_t start = thread_time_ns();
+  texture_decode(&task->texture, task->file->data, task->file->size, true,
+                 task->filter);
+  task->time_ns = thread_time_ns() - start;
+}
+
+/* All a load has to do with a KTX2 file: map it and copy out its mips. */
+static void ktx_job(void *ud)
+{
+  TexbenchTask *task = (TexbenchTask *) ud;
+  KtxTexture ktx;
+  if (ktx_open(&ktx, task->ktx_path))
+  {
+    memcpy(task->staging, ktx.texture.data, ktx.texture.size);
+    task->ktx_loaded = true;
+    ktx_close(&ktx);
+  }
+}
+
+/*
+ * Writes the first texture of each image as KTX2, then loads `count` of
+ * them on `jobs` as decode_job did, each into staging memory allocated up
+ * front as a renderer would have it mapped.
+ */
+static bool load_all(TexbenchTask *tasks, Job *descs, size_t count,
+                     size_t file_count, const char *dir, uint64_t decode_ns,
+                     JobSystem *jobs)
+{
+  bool result = false;
+  char *paths = MIUR_ARR(char, file_count * TEXBENCH_PATH_SIZE);
+  if (paths == NULL)
+  {
+    return false;
+  }
+  uint64_t bytes = 0;
+  for (size_t i = 0; i < file_count; i++)
+  {
+    const Texture *texture = tasks[i].compressed.data != NULL ?
+      &tasks[i].compressed : &tasks[i].texture;
+    char *path = paths + i * TEXBENCH_PATH_SIZE;
+    snprintf(path, TEXBENCH_PATH_SIZE, "%s/texbench%zu%s", dir, i,
+             KTX_EXTENSION);
+    if (!ktx_write(texture, path))
+    {
+      MIUR_LOG_ERR("Can't write '%s'", path);
+      goto cleanup;
+    }
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    const TexbenchTask *first = &tasks[i % file_count];
+    size_t size = first->compressed.data != NULL ? first->compressed.size :
+      first->texture.size;
+    tasks[i].ktx_path = paths + (i % file_count) * TEXBENCH_PATH_SIZE;
+    tasks[i].staging = MIUR_ARR_UNINIT(uint8_t, size);
+    if (tasks[i].staging == NULL)
+    {
+      goto cleanup;
+    }
+    /* Touched now, mapped device memory wouldn't fault on the copy. */
+    memset(tasks[i].staging, 0, size);
+    bytes += size;
+    descs[i].function = ktx_job;
+    descs[i].ud = &tasks[i];
+  }
+
+  JobCounter done = { 0 };
+  uint64_t start = thread_time_ns();
+  job_run(jobs, descs, count, &done);
+  job_wait(jobs, &done);
+  uint64_t wall_ns = thread_time_ns() - start;
+
+  size_t failed = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    failed += !tasks[i].ktx_loaded;
+  }
+  printf("ktx2: %zu textures, %zu failed\n", count, failed);
+  printf("  wall %.1f ms, %.3f ms per texture, %.1f MB into staging\n",
+         wall_ns / 1e6, wall_ns / 1e6 / count, bytes / 1e6);
+  printf("  %.1fx faster than decoding and building mips\n",
+         wall_ns > 0 ? (double) decode_ns / wall_ns : 0.0);
+  result = failed == 0;
+
+cleanup:
+  MIUR_FREE(paths);
+  return result;
+}
+
+/*
+ * One texture at a time, so the time is that of splitting a single
+ * texture's blocks across the threads, as the cook does.
+ */
+static bool compress_all(TexbenchTask *tasks, size_t count,
+                         const TexbenchFormat *format,
+                         TextureQuality quality, JobSystem *jobs)
+{
+  uint64_t texels = 0;
+  uint64_t start = thread_time_ns();
+  for (size_t i = 0; i < count; i++)
+  {
+    if (!texture_compress(&tasks[i].compressed, &tasks[i].texture,
+                          format->format, quality, jobs))
+    {
+      return false;
+    }
+    for (uint32_t m = 0; m < tasks[i].texture.mip_count; m++)
+    {
+      texels += (uint64_t) tasks[i].texture.mips[m].width *
+        tasks[i].texture.mips[m].height;
+    }
+  }
+  uint64_t wall_ns = thread_time_ns() - start;
+
+  double error = 0.0;
+  uint64_t samples = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    if (!level_error(&tasks[i].texture, &tasks[i].compressed,
+                     format->channels, &error, &samples))
+    {
+      return false;
+    }
+  }
+  double mse = error / (double) samples;
+  printf("%s %s: wall %.1f ms, %.1f MPix/s of mips\n", format->name,
+         qualities[quality], wall_ns / 1e6,
+         wall_ns > 0 ? texels * 1e3 / wall_ns : 0.0);
+  printf("  PSNR %.2f dB over %" PRIu32 " channels of the top levels\n",
+         mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : INFINITY,
+         format->channels);
+  return true;
+}
+
+/* Adds the squared error of the top level, decompressed, to `error`. */
+static bool level_error(const Texture *texture, const Texture *compressed,
+                        uint32_t channels, double *error, uint64_t *samples)
+{
+  Texture decoded;
+  if (!texture_decompress(&decoded, compressed))
+  {
+    return false;
+  }
+  size_t texels = (size_t) texture->width * texture->height;
+  uint64_t sum = 0;
+  for (size_t i = 0; i < texels; i++)
+  {
+    for (uint32_t c = 0; c < channels; c++)
+    {
+      int32_t d = texture->data[i * 4 + c] - decoded.data[i * 4 + c];
+      sum += (uint64_t) (d * d);
+    }
+  }
+  *error += (double) sum;
+  *samples += (uint64_t) texels * channels;
+  texture_destroy(&decoded);
+  return true;
+}